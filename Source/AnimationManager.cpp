@@ -0,0 +1,905 @@
+///////////////////////////////////////////////////////////////////////////////
+// animationmanager.cpp
+// ============
+// manage animated values - keyframed and procedural channels bound to objects
+//
+//  The scalar and SSE paths use the same steps in the same order, including
+//  a polynomial sine instead of the library one, so both give the same
+//  values to within rounding.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AnimationManager.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <random>
+
+// SSE2 is part of every x64 processor
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define ANIMATION_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// the kind of a channel is kept in the high bits of its handle
+	const int g_ChannelKindShift = 24;
+	const int g_ChannelIndexMask = (1 << g_ChannelKindShift) - 1;
+
+	const float g_Pi = 3.14159265358979f;
+	const float g_HalfPi = g_Pi * 0.5f;
+	const float g_TwoPi = g_Pi * 2.0f;
+	// Taylor coefficients of sine, accurate to a few millionths
+	// once the angle is folded into a quarter turn either side
+	const float g_Sine3 = -1.0f / 6.0f;
+	const float g_Sine5 = 1.0f / 120.0f;
+	const float g_Sine7 = -1.0f / 5040.0f;
+	const float g_Sine9 = 1.0f / 362880.0f;
+
+	int MakeChannel(AnimationManager::CHANNEL_KIND kind, int index)
+	{
+		return(((int)kind << g_ChannelKindShift) | index);
+	}
+
+	// take a slot from the free list, or add one to the arrays
+	int TakeSlot(std::vector<int>& freeSlots, size_t& slotCount)
+	{
+		if (freeSlots.empty() == false)
+		{
+			int slot = freeSlots.back();
+			freeSlots.pop_back();
+			return(slot);
+		}
+		return((int)slotCount++);
+	}
+
+	float LinearValue(float wrapped, float offset, float rate, float step, float inverseStep)
+	{
+		float stepped = (step > 0.0f) ? floorf(wrapped * inverseStep) * step : wrapped;
+		return(offset + rate * stepped);
+	}
+
+	// sine of a fraction of a turn in [0, 1)
+	float SineOfTurn(float fraction)
+	{
+		// sin(2 pi f) = -sin(2 pi f - pi), with the angle folded
+		// into [-pi/2, pi/2] where the polynomial is accurate
+		float x = fraction * g_TwoPi - g_Pi;
+		x = (x > g_HalfPi) ? (g_Pi - x) : x;
+		x = (x < -g_HalfPi) ? (-g_Pi - x) : x;
+		float x2 = x * x;
+		float polynomial = 1.0f + x2 * (g_Sine3 + x2 * (g_Sine5 + x2 * (g_Sine7 + x2 * g_Sine9)));
+		return(-(x * polynomial));
+	}
+
+	float Fraction(float turns)
+	{
+		return(turns - floorf(turns));
+	}
+
+#ifdef ANIMATION_USE_SSE
+	__m128 Floor4(__m128 x)
+	{
+		__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+		return(_mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, x), _mm_set1_ps(1.0f))));
+	}
+
+	__m128 Select4(__m128 mask, __m128 a, __m128 b)
+	{
+		return(_mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)));
+	}
+
+	__m128 SineOfTurn4(__m128 fraction)
+	{
+		__m128 pi = _mm_set1_ps(g_Pi);
+		__m128 halfPi = _mm_set1_ps(g_HalfPi);
+		__m128 x = _mm_sub_ps(_mm_mul_ps(fraction, _mm_set1_ps(g_TwoPi)), pi);
+		x = Select4(_mm_cmpgt_ps(x, halfPi), _mm_sub_ps(pi, x), x);
+		x = Select4(_mm_cmplt_ps(x, _mm_sub_ps(_mm_setzero_ps(), halfPi)), _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), pi), x), x);
+		__m128 x2 = _mm_mul_ps(x, x);
+		__m128 polynomial = _mm_add_ps(_mm_set1_ps(g_Sine7), _mm_mul_ps(x2, _mm_set1_ps(g_Sine9)));
+		polynomial = _mm_add_ps(_mm_set1_ps(g_Sine5), _mm_mul_ps(x2, polynomial));
+		polynomial = _mm_add_ps(_mm_set1_ps(g_Sine3), _mm_mul_ps(x2, polynomial));
+		polynomial = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, polynomial));
+		return(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(x, polynomial)));
+	}
+
+	__m128 Fraction4(__m128 turns)
+	{
+		return(_mm_sub_ps(turns, Floor4(turns)));
+	}
+#endif
+
+	double ElapsedMilliseconds(std::chrono::high_resolution_clock::time_point start)
+	{
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+		return(elapsed.count());
+	}
+}
+
+/***********************************************************
+ *  AnimationManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AnimationManager::AnimationManager()
+{
+	m_timeSource = GetTimeOfDay;
+	m_time = 0.0;
+#ifdef ANIMATION_USE_SSE
+	m_bUseSIMD = true;
+#else
+	m_bUseSIMD = false;
+#endif
+}
+
+/***********************************************************
+ *  ~AnimationManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AnimationManager::~AnimationManager()
+{
+}
+
+/***********************************************************
+ *  SetTimeSource()
+ *
+ *  This method is used for replacing the source of the
+ *  animation time, such as with a fixed frame clock for
+ *  rendering that must repeat exactly.
+ ***********************************************************/
+void AnimationManager::SetTimeSource(TIME_SOURCE timeSource)
+{
+	m_timeSource = timeSource;
+}
+
+/***********************************************************
+ *  GetTimeOfDay()
+ *
+ *  This method is used for getting the seconds since local
+ *  midnight, which keeps clocks showing the real time.
+ ***********************************************************/
+double AnimationManager::GetTimeOfDay()
+{
+	std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+	time_t seconds = std::chrono::system_clock::to_time_t(now);
+	tm timeinfo;
+	localtime_s(&timeinfo, &seconds);
+
+	std::chrono::duration<double> fraction = now - std::chrono::system_clock::from_time_t(seconds);
+	return(timeinfo.tm_hour * 3600.0 + timeinfo.tm_min * 60.0 + timeinfo.tm_sec + fraction.count());
+}
+
+/***********************************************************
+ *  SetSIMDEnabled()
+ *
+ *  This method is used for choosing between the SSE and
+ *  the scalar evaluation.  SSE is only used when the build
+ *  supports it.
+ ***********************************************************/
+void AnimationManager::SetSIMDEnabled(bool bEnabled)
+{
+#ifdef ANIMATION_USE_SSE
+	m_bUseSIMD = bEnabled;
+#else
+	m_bUseSIMD = false;
+#endif
+}
+
+/***********************************************************
+ *  AddLinearChannel()
+ *
+ *  This method is used for adding a channel that changes at
+ *  a steady rate, such as a clock hand.  A period of zero
+ *  never wraps, and a step of zero moves smoothly.
+ ***********************************************************/
+int AnimationManager::AddLinearChannel(float offset, float rate, float period, float step)
+{
+	size_t count = m_linearValue.size();
+	int index = TakeSlot(m_freeLinear, count);
+	if (count > m_linearValue.size())
+	{
+		m_linearOffset.resize(count);
+		m_linearRate.resize(count);
+		m_linearPeriod.resize(count);
+		m_linearTime.resize(count);
+		m_linearStep.resize(count);
+		m_linearInverseStep.resize(count);
+		m_linearValue.resize(count);
+	}
+
+	m_linearOffset[index] = offset;
+	m_linearRate[index] = rate;
+	m_linearPeriod[index] = period;
+	m_linearStep[index] = step;
+	m_linearInverseStep[index] = (step > 0.0f) ? 1.0f / step : 0.0f;
+	m_linearValue[index] = offset;
+	return(MakeChannel(CHANNEL_LINEAR, index));
+}
+
+/***********************************************************
+ *  AddSineChannel()
+ *
+ *  This method is used for adding a channel that swings
+ *  back and forth, such as a hanging lamp.  The phase is a
+ *  fraction of a cycle.
+ ***********************************************************/
+int AnimationManager::AddSineChannel(float offset, float amplitude, float frequency, float phase)
+{
+	size_t count = m_sineValue.size();
+	int index = TakeSlot(m_freeSine, count);
+	if (count > m_sineValue.size())
+	{
+		m_sineOffset.resize(count);
+		m_sineAmplitude.resize(count);
+		m_sineFrequency.resize(count);
+		m_sinePhase.resize(count);
+		m_sineTurns.resize(count);
+		m_sineValue.resize(count);
+	}
+
+	m_sineOffset[index] = offset;
+	m_sineAmplitude[index] = amplitude;
+	m_sineFrequency[index] = frequency;
+	m_sinePhase[index] = phase;
+	m_sineValue[index] = offset;
+	return(MakeChannel(CHANNEL_SINE, index));
+}
+
+/***********************************************************
+ *  AddKeyframeChannel()
+ *
+ *  This method is used for adding a channel that moves
+ *  between keyframes sorted by time.  A looping channel
+ *  starts again after the last keyframe, otherwise it holds
+ *  the first and last values.
+ ***********************************************************/
+int AnimationManager::AddKeyframeChannel(const std::vector<KEYFRAME>& keyframes, bool bLoop)
+{
+	size_t count = m_keyValue.size();
+	int index = TakeSlot(m_freeKeyframes, count);
+	if (count > m_keyValue.size())
+	{
+		m_keyframes.resize(count);
+		m_keyCursor.resize(count);
+		m_keyLoop.resize(count);
+		m_keyFrom.resize(count);
+		m_keyTo.resize(count);
+		m_keyWeight.resize(count);
+		m_keyValue.resize(count);
+	}
+
+	m_keyframes[index] = keyframes;
+	m_keyCursor[index] = 0;
+	m_keyLoop[index] = bLoop ? 1 : 0;
+	float firstValue = keyframes.empty() ? 0.0f : keyframes[0].value;
+	m_keyFrom[index] = firstValue;
+	m_keyTo[index] = firstValue;
+	m_keyWeight[index] = 0.0f;
+	m_keyValue[index] = firstValue;
+	return(MakeChannel(CHANNEL_KEYFRAMES, index));
+}
+
+/***********************************************************
+ *  RemoveChannel()
+ *
+ *  This method is used for freeing a channel.  The slot is
+ *  set to a constant zero, so it can still be evaluated
+ *  with the others until it is reused.
+ ***********************************************************/
+void AnimationManager::RemoveChannel(int channel)
+{
+	if (channel < 0)
+	{
+		return;
+	}
+
+	int index = channel & g_ChannelIndexMask;
+	switch (channel >> g_ChannelKindShift)
+	{
+	case CHANNEL_LINEAR:
+		m_linearOffset[index] = 0.0f;
+		m_linearRate[index] = 0.0f;
+		m_linearPeriod[index] = 0.0f;
+		m_linearStep[index] = 0.0f;
+		m_linearInverseStep[index] = 0.0f;
+		m_freeLinear.push_back(index);
+		break;
+	case CHANNEL_SINE:
+		m_sineOffset[index] = 0.0f;
+		m_sineAmplitude[index] = 0.0f;
+		m_sineFrequency[index] = 0.0f;
+		m_sinePhase[index] = 0.0f;
+		m_freeSine.push_back(index);
+		break;
+	case CHANNEL_KEYFRAMES:
+		m_keyframes[index].clear();
+		m_freeKeyframes.push_back(index);
+		break;
+	}
+}
+
+/***********************************************************
+ *  GetChannelValue()
+ *
+ *  This method is used for getting the value of a channel
+ *  at the last update.
+ ***********************************************************/
+float AnimationManager::GetChannelValue(int channel) const
+{
+	if (channel < 0)
+	{
+		return(0.0f);
+	}
+
+	int index = channel & g_ChannelIndexMask;
+	switch (channel >> g_ChannelKindShift)
+	{
+	case CHANNEL_LINEAR:
+		return(m_linearValue[index]);
+	case CHANNEL_SINE:
+		return(m_sineValue[index]);
+	case CHANNEL_KEYFRAMES:
+		return(m_keyValue[index]);
+	}
+	return(0.0f);
+}
+
+/***********************************************************
+ *  AddTransform()
+ *
+ *  This method is used for binding channels to a model
+ *  matrix.  The rotation turns the base model about the
+ *  pivot, then the translation moves it.
+ ***********************************************************/
+int AnimationManager::AddTransform(
+	const glm::mat4& baseModel,
+	glm::vec3 pivot,
+	glm::vec3 axis,
+	int rotationChannel,
+	int translationXChannel,
+	int translationYChannel,
+	int translationZChannel)
+{
+	size_t count = m_transformModel.size();
+	int index = TakeSlot(m_freeTransforms, count);
+	if (count > m_transformModel.size())
+	{
+		m_transformBase.resize(count);
+		m_transformPivot.resize(count);
+		m_transformAxis.resize(count);
+		m_transformChannels.resize(count);
+		m_transformTurns.resize(count);
+		m_transformSine.resize(count);
+		m_transformCosine.resize(count);
+		m_transformModel.resize(count);
+	}
+
+	// the base is moved so the pivot is at the origin, and the
+	// rotation and the move back are added each update
+	m_transformBase[index] = glm::translate(glm::mat4(1.0f), -pivot) * baseModel;
+	m_transformPivot[index] = pivot;
+	m_transformAxis[index] = glm::normalize(axis);
+	m_transformChannels[index].rotation = rotationChannel;
+	m_transformChannels[index].translation[0] = translationXChannel;
+	m_transformChannels[index].translation[1] = translationYChannel;
+	m_transformChannels[index].translation[2] = translationZChannel;
+	m_transformTurns[index] = 0.0f;
+	m_transformModel[index] = baseModel;
+	return(index);
+}
+
+/***********************************************************
+ *  RemoveTransform()
+ *
+ *  This method is used for freeing a transform.  Its
+ *  channels are not freed with it.
+ ***********************************************************/
+void AnimationManager::RemoveTransform(int transform)
+{
+	if (transform < 0 || transform >= (int)m_transformModel.size())
+	{
+		return;
+	}
+
+	m_transformChannels[transform].rotation = -1;
+	for (int i = 0; i < 3; i++)
+	{
+		m_transformChannels[transform].translation[i] = -1;
+	}
+	m_freeTransforms.push_back(transform);
+}
+
+/***********************************************************
+ *  GetTransform()
+ *
+ *  This method is used for getting the model matrix of a
+ *  transform at the last update.
+ ***********************************************************/
+const glm::mat4& AnimationManager::GetTransform(int transform) const
+{
+	return(m_transformModel[transform]);
+}
+
+/***********************************************************
+ *  AddVector()
+ *
+ *  This method is used for binding channels to a vector,
+ *  such as an object color or a light color scaled by an
+ *  intensity channel.
+ ***********************************************************/
+int AnimationManager::AddVector(
+	glm::vec4 baseValue,
+	int scaleChannel,
+	int xChannel,
+	int yChannel,
+	int zChannel,
+	int wChannel)
+{
+	size_t count = m_vectorValue.size();
+	int index = TakeSlot(m_freeVectors, count);
+	if (count > m_vectorValue.size())
+	{
+		m_vectorBase.resize(count);
+		m_vectorChannels.resize(count);
+		m_vectorValue.resize(count);
+	}
+
+	m_vectorBase[index] = baseValue;
+	m_vectorChannels[index].components[0] = xChannel;
+	m_vectorChannels[index].components[1] = yChannel;
+	m_vectorChannels[index].components[2] = zChannel;
+	m_vectorChannels[index].components[3] = wChannel;
+	m_vectorChannels[index].scale = scaleChannel;
+	m_vectorValue[index] = baseValue;
+	return(index);
+}
+
+/***********************************************************
+ *  RemoveVector()
+ *
+ *  This method is used for freeing a vector.  Its channels
+ *  are not freed with it.
+ ***********************************************************/
+void AnimationManager::RemoveVector(int vector)
+{
+	if (vector < 0 || vector >= (int)m_vectorValue.size())
+	{
+		return;
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		m_vectorChannels[vector].components[i] = -1;
+	}
+	m_vectorChannels[vector].scale = -1;
+	m_freeVectors.push_back(vector);
+}
+
+/***********************************************************
+ *  GetVector()
+ *
+ *  This method is used for getting the value of a vector
+ *  at the last update.
+ ***********************************************************/
+glm::vec4 AnimationManager::GetVector(int vector) const
+{
+	return(m_vectorValue[vector]);
+}
+
+/***********************************************************
+ *  EvaluateLinear()
+ *
+ *  This method is used for evaluating the linear channels.
+ *  The time of day runs to 86400 seconds, where a float
+ *  only steps by about 8 ms, so it is wrapped to each
+ *  period in double precision before it is narrowed.
+ ***********************************************************/
+void AnimationManager::EvaluateLinear(double time)
+{
+	int count = (int)m_linearValue.size();
+	for (int c = 0; c < count; c++)
+	{
+		double period = m_linearPeriod[c];
+		double wrapped = (period > 0.0) ? time - floor(time / period) * period : time;
+		m_linearTime[c] = (float)wrapped;
+	}
+
+	int i = 0;
+
+#ifdef ANIMATION_USE_SSE
+	if (m_bUseSIMD)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 step = _mm_loadu_ps(&m_linearStep[i]);
+			__m128 wrapped = _mm_loadu_ps(&m_linearTime[i]);
+			__m128 stepped = _mm_mul_ps(Floor4(_mm_mul_ps(wrapped, _mm_loadu_ps(&m_linearInverseStep[i]))), step);
+			stepped = Select4(_mm_cmpgt_ps(step, _mm_setzero_ps()), stepped, wrapped);
+			__m128 value = _mm_add_ps(_mm_loadu_ps(&m_linearOffset[i]), _mm_mul_ps(_mm_loadu_ps(&m_linearRate[i]), stepped));
+			_mm_storeu_ps(&m_linearValue[i], value);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		m_linearValue[i] = LinearValue(m_linearTime[i], m_linearOffset[i], m_linearRate[i],
+			m_linearStep[i], m_linearInverseStep[i]);
+	}
+}
+
+/***********************************************************
+ *  EvaluateSine()
+ *
+ *  This method is used for evaluating the sine channels.
+ *  Each channel's cycle is found in double precision, like
+ *  the wrap of the linear channels, so the swing stays
+ *  smooth late in the day.
+ ***********************************************************/
+void AnimationManager::EvaluateSine(double time)
+{
+	int count = (int)m_sineValue.size();
+	for (int c = 0; c < count; c++)
+	{
+		double turns = time * m_sineFrequency[c] + m_sinePhase[c];
+		m_sineTurns[c] = (float)(turns - floor(turns));
+	}
+
+	int i = 0;
+
+#ifdef ANIMATION_USE_SSE
+	if (m_bUseSIMD)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 sine = SineOfTurn4(_mm_loadu_ps(&m_sineTurns[i]));
+			__m128 value = _mm_add_ps(_mm_loadu_ps(&m_sineOffset[i]), _mm_mul_ps(_mm_loadu_ps(&m_sineAmplitude[i]), sine));
+			_mm_storeu_ps(&m_sineValue[i], value);
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		m_sineValue[i] = m_sineOffset[i] + m_sineAmplitude[i] * SineOfTurn(m_sineTurns[i]);
+	}
+}
+
+/***********************************************************
+ *  EvaluateKeyframes()
+ *
+ *  This method is used for evaluating the keyframed
+ *  channels.  The keys around the time are found one
+ *  channel at a time, starting from those of the last
+ *  frame, and then blended together.
+ ***********************************************************/
+void AnimationManager::EvaluateKeyframes(double time)
+{
+	int count = (int)m_keyValue.size();
+	for (int k = 0; k < count; k++)
+	{
+		const std::vector<KEYFRAME>& keys = m_keyframes[k];
+		if (keys.size() < 2)
+		{
+			float value = keys.empty() ? 0.0f : keys[0].value;
+			m_keyFrom[k] = value;
+			m_keyTo[k] = value;
+			m_keyWeight[k] = 0.0f;
+			continue;
+		}
+
+		// the wrap is done in double precision, since the time
+		// can be far larger than the length of the keys
+		double first = keys.front().time;
+		double length = keys.back().time - first;
+		double local = time;
+		if (m_keyLoop[k] && (length > 0.0))
+		{
+			local = first + (time - first) - floor((time - first) / length) * length;
+		}
+		float t = (float)std::min(std::max(local, first), first + length);
+
+		int cursor = m_keyCursor[k];
+		if ((cursor >= (int)keys.size() - 1) || (keys[cursor].time > t))
+		{
+			cursor = 0;
+		}
+		while ((cursor < (int)keys.size() - 2) && (keys[cursor + 1].time <= t))
+		{
+			cursor++;
+		}
+		m_keyCursor[k] = cursor;
+
+		const KEYFRAME& from = keys[cursor];
+		const KEYFRAME& to = keys[cursor + 1];
+		float span = to.time - from.time;
+		m_keyFrom[k] = from.value;
+		m_keyTo[k] = to.value;
+		m_keyWeight[k] = (span > 0.0f) ? std::min(std::max((t - from.time) / span, 0.0f), 1.0f) : 0.0f;
+	}
+
+	int i = 0;
+#ifdef ANIMATION_USE_SSE
+	if (m_bUseSIMD)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 from = _mm_loadu_ps(&m_keyFrom[i]);
+			__m128 to = _mm_loadu_ps(&m_keyTo[i]);
+			__m128 value = _mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(to, from), _mm_loadu_ps(&m_keyWeight[i])));
+			_mm_storeu_ps(&m_keyValue[i], value);
+		}
+	}
+#endif
+	for (; i < count; i++)
+	{
+		m_keyValue[i] = m_keyFrom[i] + (m_keyTo[i] - m_keyFrom[i]) * m_keyWeight[i];
+	}
+}
+
+/***********************************************************
+ *  EvaluateSineCosine()
+ *
+ *  This method is used for finding the sine and cosine of a
+ *  batch of angles given in turns.
+ ***********************************************************/
+void AnimationManager::EvaluateSineCosine(
+	const float* pTurns,
+	float* pSine,
+	float* pCosine,
+	int count)
+{
+	int i = 0;
+
+#ifdef ANIMATION_USE_SSE
+	if (m_bUseSIMD)
+	{
+		__m128 quarter = _mm_set1_ps(0.25f);
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 turns = _mm_loadu_ps(pTurns + i);
+			_mm_storeu_ps(pSine + i, SineOfTurn4(Fraction4(turns)));
+			_mm_storeu_ps(pCosine + i, SineOfTurn4(Fraction4(_mm_add_ps(turns, quarter))));
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		pSine[i] = SineOfTurn(Fraction(pTurns[i]));
+		pCosine[i] = SineOfTurn(Fraction(pTurns[i] + 0.25f));
+	}
+}
+
+/***********************************************************
+ *  EvaluateTransforms()
+ *
+ *  This method is used for building the model matrices of
+ *  the transforms from their channels.
+ ***********************************************************/
+void AnimationManager::EvaluateTransforms()
+{
+	int count = (int)m_transformModel.size();
+	if (count == 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		m_transformTurns[i] = GetChannelValue(m_transformChannels[i].rotation) * (1.0f / 360.0f);
+	}
+	EvaluateSineCosine(m_transformTurns.data(), m_transformSine.data(), m_transformCosine.data(), count);
+
+	for (int i = 0; i < count; i++)
+	{
+		const TRANSFORM_CHANNELS& channels = m_transformChannels[i];
+		const glm::vec3& axis = m_transformAxis[i];
+		float s = m_transformSine[i];
+		float c = m_transformCosine[i];
+		float t = 1.0f - c;
+
+		// rotation about the axis, the same matrix as glm::rotate
+		glm::mat4 model(1.0f);
+		model[0] = glm::vec4(c + t * axis.x * axis.x, t * axis.x * axis.y + s * axis.z, t * axis.x * axis.z - s * axis.y, 0.0f);
+		model[1] = glm::vec4(t * axis.x * axis.y - s * axis.z, c + t * axis.y * axis.y, t * axis.y * axis.z + s * axis.x, 0.0f);
+		model[2] = glm::vec4(t * axis.x * axis.z + s * axis.y, t * axis.y * axis.z - s * axis.x, c + t * axis.z * axis.z, 0.0f);
+
+		glm::vec3 position = m_transformPivot[i];
+		for (int j = 0; j < 3; j++)
+		{
+			if (channels.translation[j] >= 0)
+			{
+				position[j] += GetChannelValue(channels.translation[j]);
+			}
+		}
+		model[3] = glm::vec4(position, 1.0f);
+
+		m_transformModel[i] = model * m_transformBase[i];
+	}
+}
+
+/***********************************************************
+ *  EvaluateVectors()
+ *
+ *  This method is used for building the vectors from their
+ *  channels.
+ ***********************************************************/
+void AnimationManager::EvaluateVectors()
+{
+	int count = (int)m_vectorValue.size();
+	for (int i = 0; i < count; i++)
+	{
+		const VECTOR_CHANNELS& channels = m_vectorChannels[i];
+		glm::vec4 value = m_vectorBase[i];
+		for (int j = 0; j < 4; j++)
+		{
+			if (channels.components[j] >= 0)
+			{
+				value[j] = GetChannelValue(channels.components[j]);
+			}
+		}
+		if (channels.scale >= 0)
+		{
+			float scale = GetChannelValue(channels.scale);
+			value.x *= scale;
+			value.y *= scale;
+			value.z *= scale;
+		}
+		m_vectorValue[i] = value;
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for reading the time and evaluating
+ *  every channel, then the transforms and vectors bound to
+ *  them.
+ ***********************************************************/
+void AnimationManager::Update()
+{
+	m_time = m_timeSource ? m_timeSource() : 0.0;
+
+	EvaluateLinear(m_time);
+	EvaluateSine(m_time);
+	EvaluateKeyframes(m_time);
+	EvaluateTransforms();
+	EvaluateVectors();
+}
+
+/***********************************************************
+ *  GetTime()
+ *
+ *  This method is used for getting the animation time of
+ *  the last update.
+ ***********************************************************/
+double AnimationManager::GetTime() const
+{
+	return(m_time);
+}
+
+/***********************************************************
+ *  RunBenchmark()
+ *
+ *  This method is used for measuring the update cost of a
+ *  generated set of swinging lamps with flickering lights,
+ *  and clocks.  Both the scalar and SSE paths are timed on
+ *  the same frames and their results compared.
+ ***********************************************************/
+void AnimationManager::RunBenchmark(int objectCount, int frameCount)
+{
+	AnimationManager animation;
+	double frameTime = 0.0;
+	animation.SetTimeSource([&frameTime]() { return(frameTime); });
+
+	std::mt19937 random(330);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	std::vector<KEYFRAME> flicker;
+	flicker.push_back({ 0.0f, 0.8f });
+	flicker.push_back({ 0.4f, 1.0f });
+	flicker.push_back({ 1.1f, 0.7f });
+	flicker.push_back({ 2.0f, 0.8f });
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	std::vector<int> transforms;
+	std::vector<int> vectors;
+	int channelCount = 0;
+	for (int i = 0; i < objectCount; i++)
+	{
+		glm::vec3 center(position(random), position(random), position(random));
+		if (i % 4 == 3)
+		{
+			// a clock, with ticking second and minute hands
+			const float rates[3] = { -30.0f / 3600.0f, -0.1f, -6.0f };
+			const float periods[3] = { 43200.0f, 3600.0f, 60.0f };
+			const float steps[3] = { 60.0f, 60.0f, 1.0f };
+			for (int h = 0; h < 3; h++)
+			{
+				int channel = animation.AddLinearChannel(0.0f, rates[h], periods[h], steps[h]);
+				glm::mat4 base = glm::scale(glm::translate(glm::mat4(1.0f), center + glm::vec3(0.3f, 0.0f, 0.0f)), glm::vec3(0.6f, 0.03f, 0.01f));
+				transforms.push_back(animation.AddTransform(base, center, glm::vec3(0.0f, 0.0f, 1.0f), channel));
+				channelCount++;
+			}
+		}
+		else
+		{
+			// a lamp swinging from its cord, with a flickering light
+			int swing = animation.AddSineChannel(0.0f, 10.0f + unit(random) * 15.0f, 0.2f + unit(random) * 0.4f, unit(random));
+			int drift = animation.AddSineChannel(0.0f, 0.1f, 0.05f, unit(random));
+			int intensity = animation.AddKeyframeChannel(flicker, true);
+			glm::mat4 base = glm::translate(glm::mat4(1.0f), center);
+			transforms.push_back(animation.AddTransform(base, center + glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), swing, -1, drift));
+			vectors.push_back(animation.AddVector(glm::vec4(1.0f, 0.9f, 0.7f, 1.0f), intensity));
+			channelCount += 3;
+		}
+	}
+	double buildTime = ElapsedMilliseconds(start);
+
+	std::cout << "INFO: Animation benchmark - " << objectCount << " objects, "
+		<< channelCount << " channels, " << frameCount << " frames" << std::endl;
+	std::cout << "INFO:   build            " << buildTime << " ms" << std::endl;
+
+	// the same frames are timed on each path, starting late in the
+	// day so the clock times are large
+	const double firstFrameTime = 23.0 * 3600.0;
+	const double frameLength = 1.0 / 60.0;
+	std::vector<glm::mat4> scalarModels;
+	std::vector<glm::vec4> scalarVectors;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool bSIMD = (pass == 1);
+		animation.SetSIMDEnabled(bSIMD);
+		if (bSIMD && (animation.m_bUseSIMD == false))
+		{
+			std::cout << "INFO:   SSE is not available in this build" << std::endl;
+			break;
+		}
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < frameCount; frame++)
+		{
+			frameTime = firstFrameTime + frame * frameLength;
+			animation.Update();
+		}
+		double updateTime = ElapsedMilliseconds(start);
+
+		std::cout << "INFO:   " << (bSIMD ? "SSE update       " : "scalar update    ")
+			<< updateTime / frameCount << " ms/frame, "
+			<< (updateTime * 1.0e6) / ((double)frameCount * objectCount) << " ns/object" << std::endl;
+
+		if (bSIMD == false)
+		{
+			scalarModels = animation.m_transformModel;
+			scalarVectors = animation.m_vectorValue;
+		}
+		else
+		{
+			float largest = 0.0f;
+			for (size_t i = 0; i < scalarModels.size(); i++)
+			{
+				for (int c = 0; c < 4; c++)
+				{
+					glm::vec4 difference = glm::abs(scalarModels[i][c] - animation.m_transformModel[i][c]);
+					largest = std::max(largest, std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w)));
+				}
+			}
+			for (size_t i = 0; i < scalarVectors.size(); i++)
+			{
+				glm::vec4 difference = glm::abs(scalarVectors[i] - animation.m_vectorValue[i]);
+				largest = std::max(largest, std::max(std::max(difference.x, difference.y), std::max(difference.z, difference.w)));
+			}
+			std::cout << "INFO:   largest difference between the paths " << largest << std::endl;
+		}
+	}
+}
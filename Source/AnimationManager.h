@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+// animationmanager.h
+// ============
+// manage animated values - keyframed and procedural channels bound to objects
+//
+//  Every channel is one float, such as a rotation angle, a light intensity
+//  or one component of a color.  The channels of each kind are kept as
+//  arrays of their parameters and evaluated four at a time with SSE where it
+//  is available.  Time is read from a source that can be replaced, so the
+//  same time always gives the same pose.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+/***********************************************************
+ *  AnimationManager
+ *
+ *  This class contains the code for evaluating animation
+ *  channels and the transforms and vectors bound to them.
+ ***********************************************************/
+class AnimationManager
+{
+public:
+	// constructor
+	AnimationManager();
+	// destructor
+	~AnimationManager();
+
+	// returns the animation time in seconds
+	typedef std::function<double()> TIME_SOURCE;
+
+	// how a channel gets its value from the time
+	enum CHANNEL_KIND
+	{
+		CHANNEL_LINEAR,
+		CHANNEL_SINE,
+		CHANNEL_KEYFRAMES
+	};
+
+	struct KEYFRAME
+	{
+		float time;
+		float value;
+	};
+
+private:
+	// rotation about a pivot and a translation, applied in world
+	// space on top of a base model matrix
+	struct TRANSFORM_CHANNELS
+	{
+		int rotation;
+		int translation[3];
+	};
+
+	// channels replacing the components of a base vector, and one
+	// scaling its first three components
+	struct VECTOR_CHANNELS
+	{
+		int components[4];
+		int scale;
+	};
+
+	TIME_SOURCE m_timeSource;
+	double m_time;
+	bool m_bUseSIMD;
+
+	// linear channels, offset + rate * time, with the time wrapped
+	// to a period and rounded down to a step when those are set
+	std::vector<float> m_linearOffset;
+	std::vector<float> m_linearRate;
+	std::vector<float> m_linearPeriod;
+	// the time of each channel after the wrap
+	std::vector<float> m_linearTime;
+	std::vector<float> m_linearStep;
+	std::vector<float> m_linearInverseStep;
+	std::vector<float> m_linearValue;
+	std::vector<int> m_freeLinear;
+
+	// sine channels, offset + amplitude * sin(2 pi (time * frequency + phase))
+	std::vector<float> m_sineOffset;
+	std::vector<float> m_sineAmplitude;
+	std::vector<float> m_sineFrequency;
+	std::vector<float> m_sinePhase;
+	// the fraction of a cycle each channel is at
+	std::vector<float> m_sineTurns;
+	std::vector<float> m_sineValue;
+	std::vector<int> m_freeSine;
+
+	// keyframed channels, interpolated linearly between the keys
+	// found for the time, which are remembered for the next frame
+	std::vector<std::vector<KEYFRAME>> m_keyframes;
+	std::vector<int> m_keyCursor;
+	std::vector<unsigned char> m_keyLoop;
+	std::vector<float> m_keyFrom;
+	std::vector<float> m_keyTo;
+	std::vector<float> m_keyWeight;
+	std::vector<float> m_keyValue;
+	std::vector<int> m_freeKeyframes;
+
+	// transforms, with the base matrix moved to the pivot
+	std::vector<glm::mat4> m_transformBase;
+	std::vector<glm::vec3> m_transformPivot;
+	std::vector<glm::vec3> m_transformAxis;
+	std::vector<TRANSFORM_CHANNELS> m_transformChannels;
+	// rotation of each transform in turns, and its sine and cosine
+	std::vector<float> m_transformTurns;
+	std::vector<float> m_transformSine;
+	std::vector<float> m_transformCosine;
+	std::vector<glm::mat4> m_transformModel;
+	std::vector<int> m_freeTransforms;
+
+	// vectors, for colors and light intensities
+	std::vector<glm::vec4> m_vectorBase;
+	std::vector<VECTOR_CHANNELS> m_vectorChannels;
+	std::vector<glm::vec4> m_vectorValue;
+	std::vector<int> m_freeVectors;
+
+	// evaluate all the channels of one kind for a time
+	void EvaluateLinear(double time);
+	void EvaluateSine(double time);
+	void EvaluateKeyframes(double time);
+	// evaluate the bindings from the channel values
+	void EvaluateTransforms();
+	void EvaluateVectors();
+	// sine and cosine of angles given in turns
+	void EvaluateSineCosine(
+		const float* pTurns,
+		float* pSine,
+		float* pCosine,
+		int count);
+
+public:
+	// replace the source of the animation time
+	void SetTimeSource(TIME_SOURCE timeSource);
+	// seconds since local midnight, the default time source
+	static double GetTimeOfDay();
+	// evaluate with or without SSE, for comparing the two
+	void SetSIMDEnabled(bool bEnabled);
+
+	// add procedural and keyframed channels, returning their handles
+	int AddLinearChannel(float offset, float rate, float period, float step);
+	int AddSineChannel(float offset, float amplitude, float frequency, float phase);
+	int AddKeyframeChannel(const std::vector<KEYFRAME>& keyframes, bool bLoop);
+	void RemoveChannel(int channel);
+	// value of a channel at the last update
+	float GetChannelValue(int channel) const;
+
+	// add a transform rotating a base model matrix by a channel, in
+	// degrees about an axis through a pivot, and moving it by up to
+	// three channels, any of which may be -1
+	int AddTransform(
+		const glm::mat4& baseModel,
+		glm::vec3 pivot,
+		glm::vec3 axis,
+		int rotationChannel,
+		int translationXChannel = -1,
+		int translationYChannel = -1,
+		int translationZChannel = -1);
+	void RemoveTransform(int transform);
+	const glm::mat4& GetTransform(int transform) const;
+
+	// add a vector whose components and scale may be channels
+	int AddVector(
+		glm::vec4 baseValue,
+		int scaleChannel,
+		int xChannel = -1,
+		int yChannel = -1,
+		int zChannel = -1,
+		int wChannel = -1);
+	void RemoveVector(int vector);
+	glm::vec4 GetVector(int vector) const;
+
+	// read the time and evaluate every channel and binding
+	void Update();
+	// time of the last update, in seconds
+	double GetTime() const;
+
+	// measure the update cost for a number of animated objects
+	static void RunBenchmark(int objectCount, int frameCount);
+};
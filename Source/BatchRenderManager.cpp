@@ -0,0 +1,764 @@
+///////////////////////////////////////////////////////////////////////////////
+// batchrendermanager.cpp
+// ============
+// manage batch rendering - a camera path's frames shared out to worker processes
+//
+//  Frames are handed out one or two at a time instead of in fixed ranges,
+//  so a slow worker holds up only the frames it has, and the frames of a
+//  worker that fails are simply handed out again.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BatchRenderManager.h"
+#include "CaptureManager.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// mark the start of each message
+	const uint32_t g_HelloMagic = 0x4F4C4548;  // "HELO"
+	const uint32_t g_JobMagic = 0x424F4A42;    // "BJOB"
+	const uint32_t g_QuitMagic = 0x54495551;   // "QUIT"
+	const uint32_t g_FrameMagic = 0x4D524642;  // "BFRM"
+
+	// frames sent to a worker ahead of the one it is rendering,
+	// so it does not wait for the next one
+	const size_t g_FramesInFlightPerWorker = 2;
+	// time a worker has to load the scene and connect
+	const double g_WorkerStartupSeconds = 120.0;
+	// time a worker has to return a frame before it is stopped
+	const double g_WorkerFrameSeconds = 30.0;
+	// time to wait for the hello message of a new connection
+	const int g_HelloWaitMilliseconds = 5000;
+	// time a worker has to exit once told to quit
+	const int g_WorkerExitMilliseconds = 5000;
+	// times a worker is started again before giving up on it
+	const int g_MaxWorkerRestarts = 3;
+	// frame rate written into the video file
+	const int g_FramesPerSecond = 60;
+
+	// points the camera passes through, and the point it looks at
+	const glm::vec3 g_CameraPathPoints[] = {
+		glm::vec3(0.0f, 5.0f, 12.0f),
+		glm::vec3(12.0f, 6.0f, 8.0f),
+		glm::vec3(14.0f, 8.0f, -8.0f),
+		glm::vec3(-14.0f, 7.0f, -8.0f),
+		glm::vec3(-12.0f, 6.0f, 8.0f) };
+	const int g_CameraPathPointCount = 5;
+	const glm::vec3 g_CameraPathTarget(0.0f, 1.0f, 2.0f);
+
+	void PutU16(unsigned char*& pBytes, uint16_t value)
+	{
+		pBytes[0] = (unsigned char)value;
+		pBytes[1] = (unsigned char)(value >> 8);
+		pBytes += 2;
+	}
+
+	void PutU32(unsigned char*& pBytes, uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			pBytes[i] = (unsigned char)(value >> (i * 8));
+		}
+		pBytes += 4;
+	}
+
+	uint16_t GetU16(const unsigned char*& pBytes)
+	{
+		uint16_t value = (uint16_t)(pBytes[0] | (pBytes[1] << 8));
+		pBytes += 2;
+		return(value);
+	}
+
+	uint32_t GetU32(const unsigned char*& pBytes)
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			value |= (uint32_t)pBytes[i] << (i * 8);
+		}
+		pBytes += 4;
+		return(value);
+	}
+
+	double SecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return(elapsed.count());
+	}
+
+	// check whether a worker process has exited, without waiting,
+	// and get its exit code when it has
+	bool HasProcessExited(intptr_t& process, int& exitCode)
+	{
+		if (process == 0)
+		{
+			return(true);
+		}
+#ifdef _WIN32
+		if (WaitForSingleObject((HANDLE)process, 0) == WAIT_OBJECT_0)
+		{
+			DWORD code = 1;
+			GetExitCodeProcess((HANDLE)process, &code);
+			exitCode = (int)code;
+			return(true);
+		}
+		return(false);
+#else
+		int status = 0;
+		if (waitpid((pid_t)process, &status, WNOHANG) == (pid_t)process)
+		{
+			// the process has been reaped, so its id is no longer ours
+			process = 0;
+			exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+			return(true);
+		}
+		return(false);
+#endif
+	}
+}
+
+// definitions of the message sizes, for uses that need an address
+const int BatchRenderManager::HELLO_MESSAGE_SIZE;
+const int BatchRenderManager::JOB_MESSAGE_SIZE;
+const int BatchRenderManager::FRAME_HEADER_SIZE;
+
+/***********************************************************
+ *  BatchRenderManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BatchRenderManager::BatchRenderManager()
+{
+	m_port = 0;
+	m_frameCount = 0;
+	m_nextFrameToWrite = 0;
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  ~BatchRenderManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BatchRenderManager::~BatchRenderManager()
+{
+	for (WORKER& worker : m_workers)
+	{
+		StopWorker(worker, 0);
+	}
+	m_workers.clear();
+	m_listener.Close();
+}
+
+/***********************************************************
+ *  LaunchWorker()
+ *
+ *  This method is used for starting a copy of the program
+ *  as a worker, passing it the port to connect back to.
+ ***********************************************************/
+bool BatchRenderManager::LaunchWorker(WORKER& worker)
+{
+	std::vector<std::string> arguments;
+	arguments.push_back(m_executable);
+	arguments.insert(arguments.end(), m_workerArguments.begin(), m_workerArguments.end());
+	arguments.push_back("--batch-worker");
+	arguments.push_back(std::to_string(m_port));
+	arguments.push_back(std::to_string(worker.index));
+
+#ifdef _WIN32
+	std::string commandLine;
+	for (const std::string& argument : arguments)
+	{
+		commandLine += "\"" + argument + "\" ";
+	}
+
+	STARTUPINFOA startupInfo;
+	PROCESS_INFORMATION processInfo;
+	memset(&startupInfo, 0, sizeof(startupInfo));
+	memset(&processInfo, 0, sizeof(processInfo));
+	startupInfo.cb = sizeof(startupInfo);
+	if (!CreateProcessA(NULL, &commandLine[0], NULL, NULL, FALSE, 0, NULL, NULL, &startupInfo, &processInfo))
+	{
+		std::cout << "Could not start worker " << worker.index << std::endl;
+		return(false);
+	}
+	CloseHandle(processInfo.hThread);
+	worker.process = (intptr_t)processInfo.hProcess;
+#else
+	// the argument list is built before forking, so the child
+	// only has to call exec
+	std::vector<char*> argumentPointers;
+	for (std::string& argument : arguments)
+	{
+		argumentPointers.push_back(&argument[0]);
+	}
+	argumentPointers.push_back(NULL);
+
+	pid_t processId = fork();
+	if (processId == 0)
+	{
+		execv(argumentPointers[0], argumentPointers.data());
+		_exit(127);
+	}
+	if (processId < 0)
+	{
+		std::cout << "Could not start worker " << worker.index << std::endl;
+		return(false);
+	}
+	worker.process = (intptr_t)processId;
+#endif
+
+	worker.launchTime = std::chrono::steady_clock::now();
+	worker.lastActivity = worker.launchTime;
+	return(true);
+}
+
+/***********************************************************
+ *  StopWorker()
+ *
+ *  This method is used for closing the connection to a
+ *  worker and making sure its process has exited.  A worker
+ *  told to quit is given time to exit on its own.  Returns
+ *  true when it exited on its own and reported success.
+ ***********************************************************/
+bool BatchRenderManager::StopWorker(WORKER& worker, int graceMilliseconds)
+{
+	worker.pSocket.reset();
+	worker.frameBytesReceived = 0;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	int exitCode = 0;
+	bool bExited = HasProcessExited(worker.process, exitCode);
+	while (!bExited && (SecondsSince(start) * 1000.0 < graceMilliseconds))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		bExited = HasProcessExited(worker.process, exitCode);
+	}
+
+	if (worker.process != 0)
+	{
+#ifdef _WIN32
+		HANDLE process = (HANDLE)worker.process;
+		TerminateProcess(process, 1);
+		WaitForSingleObject(process, INFINITE);
+		CloseHandle(process);
+#else
+		kill((pid_t)worker.process, SIGKILL);
+		waitpid((pid_t)worker.process, NULL, 0);
+#endif
+		worker.process = 0;
+	}
+	return(bExited && (exitCode == 0));
+}
+
+/***********************************************************
+ *  FailWorker()
+ *
+ *  This method is used for recovering from a worker that
+ *  has exited or stopped answering.  Its frames go back to
+ *  the front of the queue, and it is started again.
+ ***********************************************************/
+void BatchRenderManager::FailWorker(WORKER& worker, const char* reason)
+{
+	std::cout << "INFO: Worker " << worker.index << " " << reason
+		<< ", " << worker.framesInFlight.size() << " frames are rendered again" << std::endl;
+
+	// the frames are the next ones needed, so they go first
+	for (std::deque<int>::reverse_iterator it = worker.framesInFlight.rbegin();
+		it != worker.framesInFlight.rend(); ++it)
+	{
+		m_pendingFrames.push_front(*it);
+	}
+	worker.framesInFlight.clear();
+
+	StopWorker(worker, 0);
+
+	worker.restarts++;
+	if ((worker.restarts > g_MaxWorkerRestarts) || !LaunchWorker(worker))
+	{
+		std::cout << "INFO: Worker " << worker.index << " is not started again" << std::endl;
+		worker.bRetired = true;
+	}
+}
+
+/***********************************************************
+ *  AcceptWorkers()
+ *
+ *  This method is used for accepting the connections of
+ *  workers that have loaded the scene.  Each one first says
+ *  which worker it is.
+ ***********************************************************/
+void BatchRenderManager::AcceptWorkers()
+{
+	std::unique_ptr<NetworkSocket> pClient(new NetworkSocket());
+	while (m_listener.Accept(*pClient))
+	{
+		unsigned char hello[HELLO_MESSAGE_SIZE];
+		if (!pClient->WaitReadable(g_HelloWaitMilliseconds) ||
+			!pClient->ReceiveAll(hello, sizeof(hello)))
+		{
+			pClient->Close();
+			continue;
+		}
+
+		const unsigned char* pBytes = hello;
+		uint32_t magic = GetU32(pBytes);
+		uint32_t index = GetU32(pBytes);
+		if ((magic != g_HelloMagic) || (index >= m_workers.size()) ||
+			m_workers[index].bRetired || m_workers[index].pSocket)
+		{
+			pClient->Close();
+			continue;
+		}
+
+		WORKER& worker = m_workers[index];
+		pClient->SetNoDelay();
+		worker.pSocket = std::move(pClient);
+		worker.lastActivity = std::chrono::steady_clock::now();
+		std::cout << "INFO: Worker " << index << " ready after "
+			<< SecondsSince(worker.launchTime) << " seconds" << std::endl;
+
+		pClient.reset(new NetworkSocket());
+	}
+}
+
+/***********************************************************
+ *  DispatchFrames()
+ *
+ *  This method is used for sending the next frames to a
+ *  worker until it has enough of them queued.
+ ***********************************************************/
+void BatchRenderManager::DispatchFrames(WORKER& worker)
+{
+	while ((worker.framesInFlight.size() < g_FramesInFlightPerWorker) && !m_pendingFrames.empty())
+	{
+		int frameIndex = m_pendingFrames.front();
+
+		unsigned char job[JOB_MESSAGE_SIZE];
+		unsigned char* pBytes = job;
+		PutU32(pBytes, g_JobMagic);
+		PutU32(pBytes, (uint32_t)frameIndex);
+		PutU32(pBytes, (uint32_t)m_frameCount);
+		if (!worker.pSocket->SendAll(job, sizeof(job)))
+		{
+			FailWorker(worker, "could not be sent a frame");
+			return;
+		}
+
+		// the wait for an answer starts when an idle worker is
+		// given a frame
+		if (worker.framesInFlight.empty())
+		{
+			worker.lastActivity = std::chrono::steady_clock::now();
+		}
+		m_pendingFrames.pop_front();
+		worker.framesInFlight.push_back(frameIndex);
+	}
+}
+
+/***********************************************************
+ *  ReceiveFrame()
+ *
+ *  This method is used for reading what a worker has sent
+ *  of its next frame, only as far as it can without waiting.
+ *  The header and pixels are gathered across calls, and the
+ *  frame is kept once all of it has arrived.  Returns false
+ *  when the connection has failed or the frame is not the
+ *  one expected.
+ ***********************************************************/
+bool BatchRenderManager::ReceiveFrame(WORKER& worker)
+{
+	while (worker.pSocket->WaitReadable(0))
+	{
+		int received = 0;
+		if (worker.frameBytesReceived < FRAME_HEADER_SIZE)
+		{
+			received = worker.pSocket->ReceiveSome(
+				worker.frameHeader + worker.frameBytesReceived,
+				FRAME_HEADER_SIZE - worker.frameBytesReceived);
+		}
+		else
+		{
+			size_t pixelBytes = worker.frameBytesReceived - FRAME_HEADER_SIZE;
+			received = worker.pSocket->ReceiveSome(
+				worker.framePixels.data() + pixelBytes,
+				worker.framePixels.size() - pixelBytes);
+		}
+		if (received <= 0)
+		{
+			return(false);
+		}
+		worker.frameBytesReceived += received;
+
+		const unsigned char* pBytes = worker.frameHeader;
+		uint32_t magic = GetU32(pBytes);
+		int frameIndex = (int)GetU32(pBytes);
+		int width = GetU16(pBytes);
+		int height = GetU16(pBytes);
+		uint32_t payloadSize = GetU32(pBytes);
+
+		if (worker.frameBytesReceived == FRAME_HEADER_SIZE)
+		{
+			// workers render their frames in the order they were sent
+			if ((magic != g_FrameMagic) ||
+				(frameIndex != worker.framesInFlight.front()) ||
+				(payloadSize != (uint32_t)width * height * 4))
+			{
+				return(false);
+			}
+
+			// the video takes the size of the first frame returned,
+			// and frames of another size cannot go in the same stream
+			if (m_width == 0)
+			{
+				m_width = width;
+				m_height = height;
+			}
+			if ((width != m_width) || (height != m_height))
+			{
+				std::cout << "Worker " << worker.index << " rendered a frame of another size" << std::endl;
+				return(false);
+			}
+			worker.framePixels.resize(payloadSize);
+		}
+
+		if (worker.frameBytesReceived == FRAME_HEADER_SIZE + (size_t)payloadSize)
+		{
+			worker.framesInFlight.pop_front();
+			worker.framesRendered++;
+			worker.lastActivity = std::chrono::steady_clock::now();
+			worker.frameBytesReceived = 0;
+			m_finishedFrames[frameIndex].swap(worker.framePixels);
+			return(true);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  WriteFinishedFrames()
+ *
+ *  This method is used for writing the finished frames to
+ *  the video file, as long as the next one in order is
+ *  among them.
+ ***********************************************************/
+void BatchRenderManager::WriteFinishedFrames()
+{
+	std::map<int, std::vector<unsigned char>>::iterator it = m_finishedFrames.find(m_nextFrameToWrite);
+	while (it != m_finishedFrames.end())
+	{
+		if (m_nextFrameToWrite == 0)
+		{
+			CaptureManager::WriteY4MHeader(m_output, m_width, m_height, g_FramesPerSecond);
+		}
+		CaptureManager::WriteY4MFrame(m_output, m_width, m_height, it->second);
+
+		m_finishedFrames.erase(it);
+		m_nextFrameToWrite++;
+		it = m_finishedFrames.find(m_nextFrameToWrite);
+	}
+}
+
+/***********************************************************
+ *  RunCoordinator()
+ *
+ *  This method is used for rendering the frames of the
+ *  camera path across a number of worker processes, and
+ *  reporting how fast they were rendered.
+ ***********************************************************/
+int BatchRenderManager::RunCoordinator(
+	const std::string& executable,
+	const std::vector<std::string>& workerArguments,
+	int frameCount,
+	int workerCount,
+	const std::string& outputFilename)
+{
+	if ((frameCount <= 0) || (workerCount <= 0))
+	{
+		std::cout << "A batch render needs at least one frame and one worker" << std::endl;
+		return(1);
+	}
+
+	m_output.open(outputFilename, std::ios::binary);
+	if (!m_output.is_open())
+	{
+		std::cout << "Could not open video file " << outputFilename << std::endl;
+		return(1);
+	}
+
+	// the system picks a free port, which is passed to the workers
+	if (!m_listener.Listen(0, true))
+	{
+		return(1);
+	}
+	m_port = m_listener.GetPort();
+
+	m_executable = executable;
+	m_workerArguments = workerArguments;
+	m_frameCount = frameCount;
+	m_nextFrameToWrite = 0;
+	m_pendingFrames.clear();
+	m_finishedFrames.clear();
+	for (int i = 0; i < frameCount; i++)
+	{
+		m_pendingFrames.push_back(i);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	m_workers.resize(workerCount);
+	for (int i = 0; i < workerCount; i++)
+	{
+		WORKER& worker = m_workers[i];
+		worker.index = i;
+		worker.process = 0;
+		worker.frameBytesReceived = 0;
+		worker.framesRendered = 0;
+		worker.restarts = 0;
+		worker.bRetired = !LaunchWorker(worker);
+	}
+
+	std::cout << "INFO: Rendering " << frameCount << " frames with "
+		<< workerCount << " workers on port " << m_port << std::endl;
+
+	bool bRenderStarted = false;
+	std::chrono::steady_clock::time_point renderStart = start;
+	int result = 0;
+	while (m_nextFrameToWrite < m_frameCount)
+	{
+		AcceptWorkers();
+
+		bool bReceived = false;
+		int runningWorkers = 0;
+		for (WORKER& worker : m_workers)
+		{
+			if (worker.bRetired)
+			{
+				continue;
+			}
+			runningWorkers++;
+
+			// a worker still loading the scene may have exited or
+			// be taking too long
+			if (!worker.pSocket)
+			{
+				int exitCode = 0;
+				if (HasProcessExited(worker.process, exitCode))
+				{
+					FailWorker(worker, "exited before it was ready");
+				}
+				else if (SecondsSince(worker.launchTime) > g_WorkerStartupSeconds)
+				{
+					FailWorker(worker, "took too long to start");
+				}
+				continue;
+			}
+
+			DispatchFrames(worker);
+			if (!worker.pSocket || worker.framesInFlight.empty())
+			{
+				continue;
+			}
+			if (!bRenderStarted)
+			{
+				bRenderStarted = true;
+				renderStart = std::chrono::steady_clock::now();
+			}
+
+			// a frame is read as far as it has arrived, and a worker
+			// that stops part way through a frame is caught by the
+			// same time limit as one that sends nothing
+			if (worker.pSocket->WaitReadable(0))
+			{
+				bReceived = true;
+				if (!ReceiveFrame(worker))
+				{
+					FailWorker(worker, "lost its connection");
+					continue;
+				}
+			}
+			if (!worker.framesInFlight.empty() &&
+				(SecondsSince(worker.lastActivity) > g_WorkerFrameSeconds))
+			{
+				FailWorker(worker, "stopped answering");
+			}
+		}
+
+		if (runningWorkers == 0)
+		{
+			std::cout << "All batch render workers failed, "
+				<< m_nextFrameToWrite << " of " << m_frameCount << " frames written" << std::endl;
+			result = 1;
+			break;
+		}
+
+		WriteFinishedFrames();
+
+		if (!bReceived)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	double totalSeconds = SecondsSince(start);
+	double renderSeconds = SecondsSince(renderStart);
+
+	// tell the connected workers to exit, the ones still loading
+	// or started again have no connection to be told on
+	std::vector<bool> quitSent(m_workers.size(), false);
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		WORKER& worker = m_workers[i];
+		if (worker.pSocket)
+		{
+			unsigned char quit[JOB_MESSAGE_SIZE];
+			unsigned char* pBytes = quit;
+			PutU32(pBytes, g_QuitMagic);
+			PutU32(pBytes, 0);
+			PutU32(pBytes, 0);
+			quitSent[i] = worker.pSocket->SendAll(quit, sizeof(quit));
+		}
+	}
+	// a worker that was told to quit but reports a failure, such
+	// as going over its memory budget, fails the batch, and the
+	// workers never told are stopped without waiting
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		WORKER& worker = m_workers[i];
+		if (!quitSent[i])
+		{
+			StopWorker(worker, 0);
+			continue;
+		}
+		if (!StopWorker(worker, g_WorkerExitMilliseconds) && !worker.bRetired)
+		{
+			std::cout << "Worker " << worker.index << " did not exit cleanly" << std::endl;
+			result = 1;
+		}
+	}
+	m_output.close();
+
+	std::cout << "INFO: Batch render wrote " << m_nextFrameToWrite << " frames to "
+		<< outputFilename << " in " << totalSeconds << " seconds" << std::endl;
+	std::cout << "INFO: Rendering took " << renderSeconds << " seconds after "
+		<< (totalSeconds - renderSeconds) << " seconds of startup, "
+		<< ((renderSeconds > 0.0) ? m_nextFrameToWrite / renderSeconds : 0.0)
+		<< " frames per second" << std::endl;
+	for (const WORKER& worker : m_workers)
+	{
+		std::cout << "INFO: Worker " << worker.index << " rendered " << worker.framesRendered
+			<< " frames and was restarted " << worker.restarts << " times" << std::endl;
+	}
+
+	return(result);
+}
+
+/***********************************************************
+ *  RunWorker()
+ *
+ *  This method is used for connecting to the coordinator,
+ *  once the scene is loaded, and rendering the frames it
+ *  sends until it says to quit.
+ ***********************************************************/
+int BatchRenderManager::RunWorker(int port, int workerIndex, FRAME_RENDERER renderer)
+{
+	NetworkSocket socket;
+	if (!socket.Connect("127.0.0.1", port))
+	{
+		return(1);
+	}
+	socket.SetNoDelay();
+
+	unsigned char hello[HELLO_MESSAGE_SIZE];
+	unsigned char* pHello = hello;
+	PutU32(pHello, g_HelloMagic);
+	PutU32(pHello, (uint32_t)workerIndex);
+	if (!socket.SendAll(hello, sizeof(hello)))
+	{
+		return(1);
+	}
+
+	std::vector<unsigned char> pixels;
+	while (true)
+	{
+		unsigned char job[JOB_MESSAGE_SIZE];
+		if (!socket.ReceiveAll(job, sizeof(job)))
+		{
+			// the coordinator has gone away
+			return(1);
+		}
+
+		const unsigned char* pBytes = job;
+		uint32_t magic = GetU32(pBytes);
+		int frameIndex = (int)GetU32(pBytes);
+		int frameCount = (int)GetU32(pBytes);
+		if (magic != g_JobMagic)
+		{
+			break;
+		}
+
+		int width = 0;
+		int height = 0;
+		if (!renderer(frameIndex, frameCount, pixels, width, height))
+		{
+			return(1);
+		}
+
+		unsigned char header[FRAME_HEADER_SIZE];
+		unsigned char* pHeader = header;
+		PutU32(pHeader, g_FrameMagic);
+		PutU32(pHeader, (uint32_t)frameIndex);
+		PutU16(pHeader, (uint16_t)width);
+		PutU16(pHeader, (uint16_t)height);
+		PutU32(pHeader, (uint32_t)pixels.size());
+		if (!socket.SendAll(header, sizeof(header)) ||
+			!socket.SendAll(pixels.data(), pixels.size()))
+		{
+			return(1);
+		}
+	}
+
+	return(0);
+}
+
+/***********************************************************
+ *  GetCameraPose()
+ *
+ *  This method is used for finding the camera position for
+ *  a frame of the path.  The path is a closed Catmull-Rom
+ *  spline through the path points, so it loops smoothly.
+ ***********************************************************/
+void BatchRenderManager::GetCameraPose(
+	int frameIndex,
+	int frameCount,
+	glm::vec3& position,
+	glm::vec3& target)
+{
+	float pathPosition = (float)frameIndex / (float)frameCount * g_CameraPathPointCount;
+	int segment = (int)pathPosition;
+	float t = pathPosition - segment;
+
+	const glm::vec3& p0 = g_CameraPathPoints[(segment + g_CameraPathPointCount - 1) % g_CameraPathPointCount];
+	const glm::vec3& p1 = g_CameraPathPoints[segment % g_CameraPathPointCount];
+	const glm::vec3& p2 = g_CameraPathPoints[(segment + 1) % g_CameraPathPointCount];
+	const glm::vec3& p3 = g_CameraPathPoints[(segment + 2) % g_CameraPathPointCount];
+
+	position = 0.5f * ((2.0f * p1) +
+		(p2 - p0) * t +
+		(2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t * t +
+		(3.0f * p1 - p0 - 3.0f * p2 + p3) * t * t * t);
+	target = g_CameraPathTarget;
+}
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// batchrendermanager.h
+// ============
+// manage batch rendering - a camera path's frames shared out to worker processes
+//
+//  The coordinator starts a number of copies of the program as workers,
+//  which load the scene once and render headlessly.  Frames are handed out
+//  over loopback sockets as the workers become free, gathered back, and
+//  written to a video file in order.  A worker that exits or stops answering
+//  is started again and its frames are rendered by the others.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "NetworkSocket.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  BatchRenderManager
+ *
+ *  This class contains the code for the coordinator of a
+ *  batch render, and for the worker side of its messages.
+ ***********************************************************/
+class BatchRenderManager
+{
+public:
+	// constructor
+	BatchRenderManager();
+	// destructor
+	~BatchRenderManager();
+
+	// renders one frame of the path into RGBA pixels, bottom row
+	// first, and returns false when it could not
+	typedef std::function<bool(
+		int frameIndex,
+		int frameCount,
+		std::vector<unsigned char>& pixels,
+		int& width,
+		int& height)> FRAME_RENDERER;
+
+	// sizes of the messages on the wire
+	static const int HELLO_MESSAGE_SIZE = 8;
+	static const int JOB_MESSAGE_SIZE = 12;
+	static const int FRAME_HEADER_SIZE = 16;
+
+private:
+	// one worker process and its connection
+	struct WORKER
+	{
+		int index;
+		// process handle or id, 0 when not running
+		intptr_t process;
+		std::unique_ptr<NetworkSocket> pSocket;
+		// frames sent to the worker and not yet returned, oldest first
+		std::deque<int> framesInFlight;
+		std::chrono::steady_clock::time_point launchTime;
+		std::chrono::steady_clock::time_point lastActivity;
+		// the frame being received, gathered across calls so a
+		// worker that stops part way through cannot block the others
+		unsigned char frameHeader[FRAME_HEADER_SIZE];
+		std::vector<unsigned char> framePixels;
+		size_t frameBytesReceived;
+		int framesRendered;
+		int restarts;
+		bool bRetired;
+	};
+
+	std::string m_executable;
+	std::vector<std::string> m_workerArguments;
+	NetworkSocket m_listener;
+	int m_port;
+	std::vector<WORKER> m_workers;
+
+	int m_frameCount;
+	// frames not yet handed to a worker, lowest first
+	std::deque<int> m_pendingFrames;
+	// frames received ahead of the next one to write
+	std::map<int, std::vector<unsigned char>> m_finishedFrames;
+	int m_nextFrameToWrite;
+
+	std::ofstream m_output;
+	int m_width;
+	int m_height;
+
+	// start a worker process connecting back to the listener
+	bool LaunchWorker(WORKER& worker);
+	// stop a worker process, giving it time to exit on its own,
+	// true when it exited by itself without an error
+	bool StopWorker(WORKER& worker, int graceMilliseconds);
+	// give the frames of a failed worker to the others and start
+	// it again, unless it has failed too often
+	void FailWorker(WORKER& worker, const char* reason);
+	// accept workers that have loaded the scene
+	void AcceptWorkers();
+	// send frames to a worker until it has enough queued
+	void DispatchFrames(WORKER& worker);
+	// read what a worker has sent of its next frame, without
+	// waiting for the rest
+	bool ReceiveFrame(WORKER& worker);
+	// write the finished frames that are next in order
+	void WriteFinishedFrames();
+
+public:
+	// render a number of frames of the camera path across worker
+	// processes, writing them in order to a Y4M video file
+	int RunCoordinator(
+		const std::string& executable,
+		const std::vector<std::string>& workerArguments,
+		int frameCount,
+		int workerCount,
+		const std::string& outputFilename);
+
+	// connect to the coordinator and render the frames it asks for,
+	// once the scene is loaded
+	static int RunWorker(int port, int workerIndex, FRAME_RENDERER renderer);
+
+	// position and look-at target of the camera for a frame of
+	// the closed path around the desk
+	static void GetCameraPose(
+		int frameIndex,
+		int frameCount,
+		glm::vec3& position,
+		glm::vec3& target);
+};
@@ -0,0 +1,673 @@
+///////////////////////////////////////////////////////////////////////////////
+// capturemanager.cpp
+// ============
+// manage the capture of rendered frames - screenshots and video recording
+//
+//  A readback is issued into a pixel pack buffer right after the frame is
+//  drawn and a fence is placed behind it.  Later frames poll the fence and
+//  only map the buffer once the copy has finished, which keeps glReadPixels
+//  from stalling the pipeline.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CaptureManager.h"
+#include "MemoryManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// number of frames that may be in flight between rendering
+	// and readback
+	const int g_ReadbackSlots = 3;
+	// video frames waiting for the writer before new ones are dropped
+	const int g_MaxQueuedFrames = 16;
+	// time the destructor waits for a readback to finish
+	const GLuint64 g_FinishTimeout = 1000000000;
+
+	// CRC of each byte value, built once by its constructor
+	struct CRC_TABLE
+	{
+		uint32_t entries[256];
+
+		CRC_TABLE()
+		{
+			for (uint32_t n = 0; n < 256; n++)
+			{
+				uint32_t c = n;
+				for (int k = 0; k < 8; k++)
+				{
+					c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+				}
+				entries[n] = c;
+			}
+		}
+	};
+
+	// running checksums used by the PNG and zlib formats
+	uint32_t UpdateCRC(uint32_t crc, const unsigned char* data, size_t length)
+	{
+		// the writer threads call this at once, and a function
+		// local static is built by the first of them while the
+		// others wait
+		static const CRC_TABLE table;
+
+		crc = ~crc;
+		for (size_t i = 0; i < length; i++)
+		{
+			crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return(~crc);
+	}
+
+	uint32_t UpdateAdler(uint32_t adler, const unsigned char* data, size_t length)
+	{
+		uint32_t a = adler & 0xFFFF;
+		uint32_t b = adler >> 16;
+		for (size_t i = 0; i < length; i++)
+		{
+			a = (a + data[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		return((b << 16) | a);
+	}
+
+	void AppendBigEndian(std::vector<unsigned char>& data, uint32_t value)
+	{
+		data.push_back((unsigned char)(value >> 24));
+		data.push_back((unsigned char)(value >> 16));
+		data.push_back((unsigned char)(value >> 8));
+		data.push_back((unsigned char)value);
+	}
+
+	void WriteChunk(std::ofstream& stream, const char* type, const std::vector<unsigned char>& data)
+	{
+		std::vector<unsigned char> header;
+		AppendBigEndian(header, (uint32_t)data.size());
+		header.insert(header.end(), type, type + 4);
+
+		uint32_t crc = UpdateCRC(0, header.data() + 4, 4);
+		crc = UpdateCRC(crc, data.data(), data.size());
+		std::vector<unsigned char> footer;
+		AppendBigEndian(footer, crc);
+
+		stream.write((const char*)header.data(), header.size());
+		stream.write((const char*)data.data(), data.size());
+		stream.write((const char*)footer.data(), footer.size());
+	}
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		return(elapsed.count());
+	}
+}
+
+/***********************************************************
+ *  CaptureManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CaptureManager::CaptureManager()
+{
+	m_oldestSlot = 0;
+	m_pendingSlots = 0;
+	m_bufferWidth = 0;
+	m_bufferHeight = 0;
+	m_bScreenshotRequested = false;
+	m_bRecording = false;
+	m_framesPerSecond = 60;
+	m_capturedFrames = 0;
+	m_droppedFrames = 0;
+	m_totalOverheadMilliseconds = 0.0;
+	m_maxOverheadMilliseconds = 0.0;
+	m_bStopWriter = false;
+	m_videoWidth = 0;
+	m_videoHeight = 0;
+
+	m_writer = std::thread(&CaptureManager::WriterLoop, this);
+}
+
+/***********************************************************
+ *  ~CaptureManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CaptureManager::~CaptureManager()
+{
+	// finish the frames already read back and close the video
+	StopVideo();
+	CollectReadbacks(true);
+
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		m_bStopWriter = true;
+	}
+	m_queueSignal.notify_one();
+	m_writer.join();
+
+	m_slots.clear();
+}
+
+/***********************************************************
+ *  RequestScreenshot()
+ *
+ *  This method is used for asking for the next captured
+ *  frame to be saved as a PNG image.
+ ***********************************************************/
+void CaptureManager::RequestScreenshot(const std::string& filename)
+{
+	m_bScreenshotRequested = true;
+	m_screenshotFilename = filename;
+}
+
+/***********************************************************
+ *  StartVideo()
+ *
+ *  This method is used for starting to record every frame
+ *  into a Y4M video file.
+ ***********************************************************/
+void CaptureManager::StartVideo(const std::string& filename, int framesPerSecond)
+{
+	if (m_bRecording)
+	{
+		StopVideo();
+	}
+
+	m_bRecording = true;
+	m_videoFilename = filename;
+	m_framesPerSecond = std::max(framesPerSecond, 1);
+	m_capturedFrames = 0;
+	m_droppedFrames = 0;
+	m_totalOverheadMilliseconds = 0.0;
+	m_maxOverheadMilliseconds = 0.0;
+
+	std::cout << "INFO: Recording video to " << filename << std::endl;
+}
+
+/***********************************************************
+ *  StopVideo()
+ *
+ *  This method is used for stopping the recording.  Frames
+ *  still being read back are written before the file is
+ *  closed.
+ ***********************************************************/
+void CaptureManager::StopVideo()
+{
+	if (!m_bRecording)
+	{
+		return;
+	}
+
+	CollectReadbacks(true);
+	m_bRecording = false;
+
+	CAPTURE_JOB job;
+	job.type = JOB_CLOSE_VIDEO;
+	job.width = 0;
+	job.height = 0;
+	job.framesPerSecond = m_framesPerSecond;
+	QueueJob(job, false);
+
+	std::cout << "INFO: Recorded " << m_capturedFrames << " frames, " << m_droppedFrames
+		<< " dropped, capture overhead " << GetAverageOverheadMilliseconds() << " ms per frame average, "
+		<< m_maxOverheadMilliseconds << " ms max" << std::endl;
+}
+
+/***********************************************************
+ *  IsRecording()
+ *
+ *  This method is used for checking whether a video is
+ *  being recorded.
+ ***********************************************************/
+bool CaptureManager::IsRecording() const
+{
+	return(m_bRecording);
+}
+
+/***********************************************************
+ *  GetAverageOverheadMilliseconds()
+ *
+ *  This method is used for getting the average time the
+ *  rendering thread spent on each captured frame.
+ ***********************************************************/
+double CaptureManager::GetAverageOverheadMilliseconds() const
+{
+	if (m_capturedFrames == 0)
+	{
+		return(0.0);
+	}
+	return(m_totalOverheadMilliseconds / m_capturedFrames);
+}
+
+/***********************************************************
+ *  ResizeBuffers()
+ *
+ *  This method is used for creating the ring of pixel pack
+ *  buffers for the passed frame size.
+ ***********************************************************/
+void CaptureManager::ResizeBuffers(int width, int height)
+{
+	// pending readbacks use the old buffers
+	CollectReadbacks(true);
+
+	m_slots.resize(g_ReadbackSlots);
+
+	// the old buffers are deleted once the GPU is done with them
+	for (READBACK_SLOT& slot : m_slots)
+	{
+		slot.buffer.Create("Capture");
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.Get());
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+		MemoryManager::TrackBuffer(slot.buffer.Get(), "Capture", "readback buffers", (size_t)width * height * 4);
+		slot.fence = NULL;
+		slot.bScreenshot = false;
+		slot.bVideoFrame = false;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	m_oldestSlot = 0;
+	m_pendingSlots = 0;
+	m_bufferWidth = width;
+	m_bufferHeight = height;
+}
+
+/***********************************************************
+ *  CaptureFrame()
+ *
+ *  This method is used for starting the readback of the
+ *  frame just drawn into the next free buffer, and handing
+ *  earlier readbacks that have finished to the writer.  A
+ *  video frame is dropped when every buffer is still busy.
+ ***********************************************************/
+void CaptureManager::CaptureFrame(int width, int height)
+{
+	if ((m_pendingSlots == 0) && !m_bScreenshotRequested && !m_bRecording)
+	{
+		return;
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// free the buffers whose readback has finished
+	CollectReadbacks(false);
+
+	if (!m_bScreenshotRequested && !m_bRecording)
+	{
+		return;
+	}
+
+	if ((width != m_bufferWidth) || (height != m_bufferHeight))
+	{
+		ResizeBuffers(width, height);
+	}
+
+	if (m_pendingSlots == (int)m_slots.size())
+	{
+		// a requested screenshot waits for the next frame
+		if (m_bRecording)
+		{
+			m_droppedFrames++;
+		}
+		return;
+	}
+
+	READBACK_SLOT& slot = m_slots[(m_oldestSlot + m_pendingSlots) % m_slots.size()];
+	slot.bScreenshot = m_bScreenshotRequested;
+	slot.bVideoFrame = m_bRecording;
+	slot.screenshotFilename = m_screenshotFilename;
+	m_bScreenshotRequested = false;
+
+	// the copy runs on the GPU, the fence tells when it is done
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.Get());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_pendingSlots++;
+
+	double overhead = MillisecondsSince(start);
+	if (m_bRecording)
+	{
+		m_capturedFrames++;
+		m_totalOverheadMilliseconds += overhead;
+		m_maxOverheadMilliseconds = std::max(m_maxOverheadMilliseconds, overhead);
+	}
+}
+
+/***********************************************************
+ *  CollectReadbacks()
+ *
+ *  This method is used for copying the finished readbacks
+ *  out of their buffers, oldest first, and queueing them
+ *  for the writer thread.  Without waiting, it stops at the
+ *  first readback the GPU has not finished.
+ ***********************************************************/
+void CaptureManager::CollectReadbacks(bool bWait)
+{
+	while (m_pendingSlots > 0)
+	{
+		READBACK_SLOT& slot = m_slots[m_oldestSlot];
+
+		GLenum status = glClientWaitSync(
+			slot.fence,
+			bWait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+			bWait ? g_FinishTimeout : 0);
+		if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED))
+		{
+			if (!bWait)
+			{
+				return;
+			}
+			std::cout << "Capture readback did not finish, frame skipped" << std::endl;
+		}
+		else
+		{
+			CAPTURE_JOB job;
+			job.width = m_bufferWidth;
+			job.height = m_bufferHeight;
+			job.framesPerSecond = m_framesPerSecond;
+			job.pixels.resize((size_t)m_bufferWidth * m_bufferHeight * 4);
+
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.Get());
+			void* pMapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, job.pixels.size(), GL_MAP_READ_BIT);
+			if (NULL != pMapped)
+			{
+				memcpy(job.pixels.data(), pMapped, job.pixels.size());
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+			if (NULL != pMapped)
+			{
+				if (slot.bScreenshot)
+				{
+					CAPTURE_JOB screenshot = job;
+					screenshot.type = JOB_SCREENSHOT;
+					screenshot.filename = slot.screenshotFilename;
+					QueueJob(screenshot, false);
+				}
+				if (slot.bVideoFrame)
+				{
+					job.type = JOB_VIDEO_FRAME;
+					job.filename = m_videoFilename;
+					if (!QueueJob(job, true))
+					{
+						m_droppedFrames++;
+					}
+				}
+			}
+		}
+
+		glDeleteSync(slot.fence);
+		slot.fence = NULL;
+		m_oldestSlot = (m_oldestSlot + 1) % m_slots.size();
+		m_pendingSlots--;
+	}
+}
+
+/***********************************************************
+ *  QueueJob()
+ *
+ *  This method is used for handing a job to the writer
+ *  thread.  When asked, the job is dropped instead if the
+ *  writer has fallen too far behind.
+ ***********************************************************/
+bool CaptureManager::QueueJob(CAPTURE_JOB& job, bool bDropWhenBusy)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		if (bDropWhenBusy && ((int)m_jobs.size() >= g_MaxQueuedFrames))
+		{
+			return(false);
+		}
+		m_jobs.push_back(std::move(job));
+	}
+	m_queueSignal.notify_one();
+	return(true);
+}
+
+/***********************************************************
+ *  WriterLoop()
+ *
+ *  This method is used for running the writer thread, which
+ *  writes the queued jobs in order until it is stopped and
+ *  the queue is empty.
+ ***********************************************************/
+void CaptureManager::WriterLoop()
+{
+	while (true)
+	{
+		CAPTURE_JOB job;
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_queueSignal.wait(lock, [this]() { return(m_bStopWriter || !m_jobs.empty()); });
+			if (m_jobs.empty())
+			{
+				break;
+			}
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		WriteJob(job);
+	}
+
+	if (m_videoStream.is_open())
+	{
+		m_videoStream.close();
+	}
+}
+
+/***********************************************************
+ *  WriteJob()
+ *
+ *  This method is used for converting and writing one job
+ *  on the writer thread.
+ ***********************************************************/
+void CaptureManager::WriteJob(CAPTURE_JOB& job)
+{
+	switch (job.type)
+	{
+	case JOB_SCREENSHOT:
+		if (WritePNG(job.filename, job.width, job.height, job.pixels))
+		{
+			std::cout << "INFO: Saved screenshot " << job.filename << std::endl;
+		}
+		else
+		{
+			std::cout << "Could not save screenshot " << job.filename << std::endl;
+		}
+		break;
+
+	case JOB_VIDEO_FRAME:
+		if (!m_videoStream.is_open())
+		{
+			// the stream header takes the size of the first frame
+			m_videoStream.open(job.filename, std::ios::binary);
+			if (!m_videoStream.is_open())
+			{
+				std::cout << "Could not open video file " << job.filename << std::endl;
+				break;
+			}
+			m_videoWidth = job.width;
+			m_videoHeight = job.height;
+			WriteY4MHeader(m_videoStream, m_videoWidth, m_videoHeight, job.framesPerSecond);
+		}
+		// frames of another size cannot go in the same stream
+		if ((job.width == m_videoWidth) && (job.height == m_videoHeight))
+		{
+			WriteY4MFrame(m_videoStream, job.width, job.height, job.pixels);
+		}
+		break;
+
+	case JOB_CLOSE_VIDEO:
+		if (m_videoStream.is_open())
+		{
+			m_videoStream.close();
+		}
+		break;
+	}
+}
+
+/***********************************************************
+ *  WritePNG()
+ *
+ *  This method is used for saving RGBA pixels as an RGB PNG
+ *  image.  The image data is stored without compression,
+ *  which is quick to write and needs no extra library.
+ ***********************************************************/
+bool CaptureManager::WritePNG(
+	const std::string& filename,
+	int width,
+	int height,
+	const std::vector<unsigned char>& pixels)
+{
+	std::ofstream stream(filename, std::ios::binary);
+	if (!stream.is_open())
+	{
+		return(false);
+	}
+
+	// each row starts with a filter type of none, and rows are
+	// stored top first while OpenGL reads them bottom first
+	size_t rowSize = (size_t)width * 3 + 1;
+	std::vector<unsigned char> raw(rowSize * height);
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* source = &pixels[(size_t)(height - 1 - y) * width * 4];
+		unsigned char* row = &raw[rowSize * y];
+		row[0] = 0;
+		for (int x = 0; x < width; x++)
+		{
+			row[1 + x * 3] = source[x * 4];
+			row[2 + x * 3] = source[x * 4 + 1];
+			row[3 + x * 3] = source[x * 4 + 2];
+		}
+	}
+
+	// zlib stream made of stored deflate blocks
+	std::vector<unsigned char> compressed;
+	compressed.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+	compressed.push_back(0x78);
+	compressed.push_back(0x01);
+	size_t offset = 0;
+	do
+	{
+		size_t blockSize = std::min(raw.size() - offset, (size_t)65535);
+		bool bFinal = (offset + blockSize == raw.size());
+		compressed.push_back(bFinal ? 1 : 0);
+		compressed.push_back((unsigned char)(blockSize & 0xFF));
+		compressed.push_back((unsigned char)(blockSize >> 8));
+		compressed.push_back((unsigned char)(~blockSize & 0xFF));
+		compressed.push_back((unsigned char)((~blockSize >> 8) & 0xFF));
+		compressed.insert(compressed.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+		offset += blockSize;
+	} while (offset < raw.size());
+	AppendBigEndian(compressed, UpdateAdler(1, raw.data(), raw.size()));
+
+	std::vector<unsigned char> header;
+	AppendBigEndian(header, (uint32_t)width);
+	AppendBigEndian(header, (uint32_t)height);
+	header.push_back(8);  // bits per channel
+	header.push_back(2);  // RGB color
+	header.push_back(0);  // deflate compression
+	header.push_back(0);  // adaptive filtering
+	header.push_back(0);  // no interlace
+
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	stream.write((const char*)signature, sizeof(signature));
+	WriteChunk(stream, "IHDR", header);
+	WriteChunk(stream, "IDAT", compressed);
+	WriteChunk(stream, "IEND", std::vector<unsigned char>());
+
+	return(stream.good());
+}
+
+/***********************************************************
+ *  WriteY4MHeader()
+ *
+ *  This method is used for writing the header at the start
+ *  of a Y4M stream, giving the frame size and rate, and that
+ *  the samples use the full 0 to 255 range.
+ ***********************************************************/
+void CaptureManager::WriteY4MHeader(
+	std::ofstream& stream,
+	int width,
+	int height,
+	int framesPerSecond)
+{
+	stream << "YUV4MPEG2 W" << width << " H" << height
+		<< " F" << framesPerSecond << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+}
+
+/***********************************************************
+ *  WriteY4MFrame()
+ *
+ *  This method is used for converting RGBA pixels to full
+ *  range YCbCr with the color averaged over 2x2 blocks, and
+ *  writing them as one frame of a Y4M stream.
+ ***********************************************************/
+void CaptureManager::WriteY4MFrame(
+	std::ofstream& stream,
+	int width,
+	int height,
+	const std::vector<unsigned char>& pixels)
+{
+	int chromaWidth = (width + 1) / 2;
+	int chromaHeight = (height + 1) / 2;
+	std::vector<unsigned char> luma((size_t)width * height);
+	std::vector<unsigned char> blue((size_t)chromaWidth * chromaHeight);
+	std::vector<unsigned char> red((size_t)chromaWidth * chromaHeight);
+
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* source = &pixels[(size_t)(height - 1 - y) * width * 4];
+		for (int x = 0; x < width; x++)
+		{
+			float r = source[x * 4];
+			float g = source[x * 4 + 1];
+			float b = source[x * 4 + 2];
+			luma[(size_t)y * width + x] = (unsigned char)std::min(255.0f, 0.299f * r + 0.587f * g + 0.114f * b + 0.5f);
+		}
+	}
+
+	for (int cy = 0; cy < chromaHeight; cy++)
+	{
+		for (int cx = 0; cx < chromaWidth; cx++)
+		{
+			float r = 0.0f;
+			float g = 0.0f;
+			float b = 0.0f;
+			int count = 0;
+			for (int y = cy * 2; y < std::min(cy * 2 + 2, height); y++)
+			{
+				const unsigned char* source = &pixels[(size_t)(height - 1 - y) * width * 4];
+				for (int x = cx * 2; x < std::min(cx * 2 + 2, width); x++)
+				{
+					r += source[x * 4];
+					g += source[x * 4 + 1];
+					b += source[x * 4 + 2];
+					count++;
+				}
+			}
+			r /= count;
+			g /= count;
+			b /= count;
+
+			float cb = 128.0f - 0.168736f * r - 0.331264f * g + 0.5f * b;
+			float cr = 128.0f + 0.5f * r - 0.418688f * g - 0.081312f * b;
+			blue[(size_t)cy * chromaWidth + cx] = (unsigned char)std::min(std::max(cb + 0.5f, 0.0f), 255.0f);
+			red[(size_t)cy * chromaWidth + cx] = (unsigned char)std::min(std::max(cr + 0.5f, 0.0f), 255.0f);
+		}
+	}
+
+	stream << "FRAME\n";
+	stream.write((const char*)luma.data(), luma.size());
+	stream.write((const char*)blue.data(), blue.size());
+	stream.write((const char*)red.data(), red.size());
+}
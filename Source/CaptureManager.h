@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// capturemanager.h
+// ============
+// manage the capture of rendered frames - screenshots and video recording
+//
+//  Frames are read back through a ring of pixel pack buffers guarded by
+//  fences, so the rendering thread never waits for the GPU.  Finished frames
+//  are converted and written to disk by a writer thread.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceManager.h"
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  CaptureManager
+ *
+ *  This class contains the code for reading back rendered
+ *  frames without stalling and saving them as PNG images
+ *  or as a Y4M video stream.
+ ***********************************************************/
+class CaptureManager
+{
+public:
+	// constructor
+	CaptureManager();
+	// destructor
+	~CaptureManager();
+
+	enum CAPTURE_JOB_TYPE
+	{
+		JOB_SCREENSHOT,
+		JOB_VIDEO_FRAME,
+		JOB_CLOSE_VIDEO
+	};
+
+	// work handed to the writer thread
+	struct CAPTURE_JOB
+	{
+		CAPTURE_JOB_TYPE type;
+		std::string filename;
+		int width;
+		int height;
+		int framesPerSecond;
+		// RGBA rows, bottom row first as read from OpenGL
+		std::vector<unsigned char> pixels;
+	};
+
+private:
+	// pixel pack buffer and the fence of its pending readback
+	struct READBACK_SLOT
+	{
+		GLBuffer buffer;
+		GLsync fence;
+		bool bScreenshot;
+		bool bVideoFrame;
+		std::string screenshotFilename;
+	};
+
+	// ring of readback buffers, oldest pending readback first
+	std::vector<READBACK_SLOT> m_slots;
+	int m_oldestSlot;
+	int m_pendingSlots;
+	int m_bufferWidth;
+	int m_bufferHeight;
+
+	// requests from the rendering thread
+	bool m_bScreenshotRequested;
+	std::string m_screenshotFilename;
+	bool m_bRecording;
+	std::string m_videoFilename;
+	int m_framesPerSecond;
+
+	// capture statistics, reported when a recording stops
+	int m_capturedFrames;
+	int m_droppedFrames;
+	double m_totalOverheadMilliseconds;
+	double m_maxOverheadMilliseconds;
+
+	// writer thread and the jobs waiting for it
+	std::thread m_writer;
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueSignal;
+	std::deque<CAPTURE_JOB> m_jobs;
+	bool m_bStopWriter;
+	// video stream, only touched by the writer thread
+	std::ofstream m_videoStream;
+	int m_videoWidth;
+	int m_videoHeight;
+
+	// create the readback buffers for a frame size
+	void ResizeBuffers(int width, int height);
+	// hand the finished readbacks to the writer thread
+	void CollectReadbacks(bool bWait);
+	// queue a job for the writer thread
+	bool QueueJob(CAPTURE_JOB& job, bool bDropWhenBusy);
+	// writer thread loop
+	void WriterLoop();
+	// convert and write a job, on the writer thread
+	void WriteJob(CAPTURE_JOB& job);
+
+public:
+	// save the next captured frame as a PNG image
+	void RequestScreenshot(const std::string& filename);
+	// start and stop recording every frame to a Y4M video file
+	void StartVideo(const std::string& filename, int framesPerSecond);
+	void StopVideo();
+	bool IsRecording() const;
+
+	// read back the frame just rendered when it has been asked for,
+	// called after drawing and before swapping the buffers
+	void CaptureFrame(int width, int height);
+
+	// average time spent by the rendering thread on capture
+	double GetAverageOverheadMilliseconds() const;
+
+	// encode RGBA pixels, bottom row first, as an image or video frame
+	static bool WritePNG(
+		const std::string& filename,
+		int width,
+		int height,
+		const std::vector<unsigned char>& pixels);
+	static void WriteY4MHeader(
+		std::ofstream& stream,
+		int width,
+		int height,
+		int framesPerSecond);
+	static void WriteY4MFrame(
+		std::ofstream& stream,
+		int width,
+		int height,
+		const std::vector<unsigned char>& pixels);
+};
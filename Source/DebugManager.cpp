@@ -0,0 +1,336 @@
+///////////////////////////////////////////////////////////////////////////////
+// debugmanager.cpp
+// ============
+// capture OpenGL debug messages - driver performance warnings by scope
+//
+//  Messages are delivered synchronously, on the thread making the OpenGL
+//  call, so the scope stack at the time of the callback is the scope that
+//  caused the message.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DebugManager.h"
+
+#ifdef GL_DEBUG_LAYER
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// what a message says is wrong, found from its type and text
+	enum MESSAGE_KIND
+	{
+		KIND_IMPLICIT_SYNC,
+		KIND_RECOMPILE,
+		KIND_SLOW_PATH,
+		KIND_PERFORMANCE,
+		KIND_ERROR,
+		KIND_UNDEFINED_BEHAVIOR,
+		KIND_COUNT
+	};
+
+	const char* g_KindNames[KIND_COUNT] =
+	{
+		"implicit sync",
+		"shader recompile",
+		"slow path",
+		"performance",
+		"error",
+		"undefined behavior"
+	};
+
+	// one kind of message from one scope, however often it came
+	struct MESSAGE_RECORD
+	{
+		MESSAGE_KIND kind;
+		std::string scope;
+		// text of the first message, later ones may differ in
+		// the object names they mention
+		std::string text;
+		int totalCount;
+		int frameCount;
+		int framesSeen;
+		int maxPerFrame;
+		unsigned int firstFrame;
+	};
+
+	bool g_bEnabled = false;
+	// names of the open scopes, outermost first
+	std::vector<const char*> g_Scopes;
+	std::vector<MESSAGE_RECORD> g_Records;
+	std::map<std::string, int> g_RecordIndex;
+	// records with messages in the current frame
+	std::vector<int> g_FrameRecords;
+	unsigned int g_FrameNumber = 0;
+	int g_FramesWithMessages = 0;
+
+	// longest message text printed
+	const size_t g_MaxPrintedText = 200;
+
+	MESSAGE_KIND ClassifyMessage(GLenum type, const std::string& text)
+	{
+		if (type == GL_DEBUG_TYPE_ERROR)
+		{
+			return(KIND_ERROR);
+		}
+		if (type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR)
+		{
+			return(KIND_UNDEFINED_BEHAVIOR);
+		}
+
+		// drivers word their warnings differently, so they are
+		// sorted by the words they have in common
+		std::string lower = text;
+		std::transform(lower.begin(), lower.end(), lower.begin(),
+			[](unsigned char c) { return((char)std::tolower(c)); });
+		if (lower.find("recompil") != std::string::npos)
+		{
+			return(KIND_RECOMPILE);
+		}
+		if ((lower.find("stall") != std::string::npos) ||
+			(lower.find("sync") != std::string::npos) ||
+			(lower.find("wait") != std::string::npos) ||
+			(lower.find("flush") != std::string::npos))
+		{
+			return(KIND_IMPLICIT_SYNC);
+		}
+		if ((lower.find("slow") != std::string::npos) ||
+			(lower.find("software") != std::string::npos) ||
+			(lower.find("fallback") != std::string::npos) ||
+			(lower.find("conver") != std::string::npos) ||
+			(lower.find("cpu") != std::string::npos))
+		{
+			return(KIND_SLOW_PATH);
+		}
+		return(KIND_PERFORMANCE);
+	}
+
+	std::string GetScopePath()
+	{
+		if (g_Scopes.empty())
+		{
+			return("(no scope)");
+		}
+
+		std::string path = g_Scopes[0];
+		for (size_t i = 1; i < g_Scopes.size(); i++)
+		{
+			path += "/";
+			path += g_Scopes[i];
+		}
+		return(path);
+	}
+
+	std::string ShortenText(const std::string& text)
+	{
+		std::string shortText = text.substr(0, g_MaxPrintedText);
+		while (!shortText.empty() && std::isspace((unsigned char)shortText.back()))
+		{
+			shortText.pop_back();
+		}
+		return(shortText);
+	}
+}
+
+/***********************************************************
+ *  SCOPE()
+ *
+ *  The constructor for the class, opening a scope
+ ***********************************************************/
+DebugManager::SCOPE::SCOPE(const char* name)
+{
+	g_Scopes.push_back(name);
+}
+
+/***********************************************************
+ *  ~SCOPE()
+ *
+ *  The destructor for the class, closing the scope
+ ***********************************************************/
+DebugManager::SCOPE::~SCOPE()
+{
+	g_Scopes.pop_back();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for installing the debug message
+ *  callback, keeping only the performance warnings, errors
+ *  and undefined behavior reports.
+ ***********************************************************/
+bool DebugManager::Initialize()
+{
+	if (!(GLEW_VERSION_4_3 || GLEW_KHR_debug))
+	{
+		std::cout << "INFO: GL debug layer is off, KHR_debug is not supported" << std::endl;
+		return(false);
+	}
+
+	// most drivers only report performance warnings to a debug context
+	GLint flags = 0;
+	glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+	if ((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+	{
+		std::cout << "INFO: GL debug layer is running without a debug context, "
+			<< "fewer warnings may be reported" << std::endl;
+	}
+
+	glEnable(GL_DEBUG_OUTPUT);
+	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	glDebugMessageCallback(ReceiveMessage, NULL);
+	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, NULL, GL_FALSE);
+	glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PERFORMANCE, GL_DONT_CARE, 0, NULL, GL_TRUE);
+	glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, NULL, GL_TRUE);
+	glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR, GL_DONT_CARE, 0, NULL, GL_TRUE);
+
+	g_bEnabled = true;
+	std::cout << "INFO: GL debug layer is capturing performance warnings" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  ReceiveMessage()
+ *
+ *  This method is called by the driver for each message.
+ *  The first message of a kind from a scope is printed, and
+ *  the rest are only counted.
+ ***********************************************************/
+void GLAPIENTRY DebugManager::ReceiveMessage(
+	GLenum source,
+	GLenum type,
+	GLuint id,
+	GLenum severity,
+	GLsizei length,
+	const GLchar* message,
+	const void* userParam)
+{
+	std::string text = (length >= 0) ? std::string(message, length) : std::string(message);
+	std::string scope = GetScopePath();
+
+	// messages are told apart by their ID, or by their text when
+	// the driver gives them all the same ID
+	std::string key = scope + "|" + std::to_string(source) + ":" + std::to_string(id);
+	if (id == 0)
+	{
+		key += "|" + text;
+	}
+
+	std::map<std::string, int>::iterator found = g_RecordIndex.find(key);
+	int recordIndex = 0;
+	if (found == g_RecordIndex.end())
+	{
+		MESSAGE_RECORD record;
+		record.kind = ClassifyMessage(type, text);
+		record.scope = scope;
+		record.text = text;
+		record.totalCount = 0;
+		record.frameCount = 0;
+		record.framesSeen = 0;
+		record.maxPerFrame = 0;
+		record.firstFrame = g_FrameNumber;
+		recordIndex = (int)g_Records.size();
+		g_Records.push_back(record);
+		g_RecordIndex[key] = recordIndex;
+
+		std::cout << "INFO: GL " << g_KindNames[record.kind] << " in " << scope
+			<< " (frame " << g_FrameNumber << "): " << ShortenText(text) << std::endl;
+	}
+	else
+	{
+		recordIndex = found->second;
+	}
+
+	MESSAGE_RECORD& record = g_Records[recordIndex];
+	if (record.frameCount == 0)
+	{
+		g_FrameRecords.push_back(recordIndex);
+	}
+	record.totalCount++;
+	record.frameCount++;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for adding the counts of the frame
+ *  just drawn to the per frame statistics.
+ ***********************************************************/
+void DebugManager::EndFrame()
+{
+	if (!g_FrameRecords.empty())
+	{
+		for (int recordIndex : g_FrameRecords)
+		{
+			MESSAGE_RECORD& record = g_Records[recordIndex];
+			record.framesSeen++;
+			record.maxPerFrame = std::max(record.maxPerFrame, record.frameCount);
+			record.frameCount = 0;
+		}
+		g_FrameRecords.clear();
+		g_FramesWithMessages++;
+	}
+	g_FrameNumber++;
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing every kind of message
+ *  received, most frequent first.
+ ***********************************************************/
+void DebugManager::Report()
+{
+	if (!g_bEnabled)
+	{
+		return;
+	}
+	// messages after the last frame count as one more frame
+	if (!g_FrameRecords.empty())
+	{
+		EndFrame();
+	}
+
+	if (g_Records.empty())
+	{
+		std::cout << "INFO: GL debug - no performance warnings in " << g_FrameNumber << " frames" << std::endl;
+		return;
+	}
+
+	std::vector<int> order(g_Records.size());
+	int kindCounts[KIND_COUNT] = { 0 };
+	for (int i = 0; i < (int)g_Records.size(); i++)
+	{
+		order[i] = i;
+		kindCounts[g_Records[i].kind] += g_Records[i].totalCount;
+	}
+	std::sort(order.begin(), order.end(), [](int a, int b)
+		{
+			return(g_Records[a].totalCount > g_Records[b].totalCount);
+		});
+
+	std::cout << "INFO: GL debug - " << g_Records.size() << " kinds of messages in "
+		<< g_FramesWithMessages << " of " << g_FrameNumber << " frames" << std::endl;
+	for (int kind = 0; kind < KIND_COUNT; kind++)
+	{
+		if (kindCounts[kind] > 0)
+		{
+			std::cout << "    " << g_KindNames[kind] << ": " << kindCounts[kind] << std::endl;
+		}
+	}
+	for (int recordIndex : order)
+	{
+		const MESSAGE_RECORD& record = g_Records[recordIndex];
+		std::cout << "    " << record.totalCount << " x " << g_KindNames[record.kind]
+			<< " in " << record.scope << ", " << record.framesSeen << " frames from frame "
+			<< record.firstFrame << ", at most " << record.maxPerFrame << " per frame\n"
+			<< "        " << ShortenText(record.text) << std::endl;
+	}
+}
+
+#endif
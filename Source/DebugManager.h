@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// debugmanager.h
+// ============
+// capture OpenGL debug messages - driver performance warnings by scope
+//
+//  The driver reports implicit syncs, shader recompiles and slow paths
+//  through KHR_debug.  Each message is tied to the scope being drawn when
+//  it arrived, such as "RenderScene/book pages", counted once per kind,
+//  and summarized when the program exits.  The layer is only built into
+//  debug builds, and its macros compile to nothing in release builds.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// debug builds get the layer unless it is turned off with
+// NO_GL_DEBUG_LAYER, and release builds can add it with GL_DEBUG_LAYER
+#if !defined(NDEBUG) && !defined(NO_GL_DEBUG_LAYER) && !defined(GL_DEBUG_LAYER)
+#define GL_DEBUG_LAYER 1
+#endif
+
+#ifdef GL_DEBUG_LAYER
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  DebugManager
+ *
+ *  This class contains the code for receiving the OpenGL
+ *  debug messages and the scopes they are charged to.
+ *  There is one OpenGL context, so everything is static.
+ ***********************************************************/
+class DebugManager
+{
+public:
+	// names the work between its construction and destruction,
+	// the name must stay valid until then
+	class SCOPE
+	{
+	public:
+		explicit SCOPE(const char* name);
+		~SCOPE();
+
+	private:
+		SCOPE(const SCOPE&);
+		SCOPE& operator=(const SCOPE&);
+	};
+
+	// install the message callback, once the context is current
+	static bool Initialize();
+	// close the per frame counts
+	static void EndFrame();
+	// print the messages received since Initialize
+	static void Report();
+
+private:
+	static void GLAPIENTRY ReceiveMessage(
+		GLenum source,
+		GLenum type,
+		GLuint id,
+		GLenum severity,
+		GLsizei length,
+		const GLchar* message,
+		const void* userParam);
+};
+
+#define DEBUG_SCOPE_JOIN(name, line) name##line
+#define DEBUG_SCOPE_VARIABLE(line) DEBUG_SCOPE_JOIN(debugScope, line)
+#define DEBUG_SCOPE(name) DebugManager::SCOPE DEBUG_SCOPE_VARIABLE(__LINE__)(name)
+#define DEBUG_INITIALIZE() DebugManager::Initialize()
+#define DEBUG_END_FRAME() DebugManager::EndFrame()
+#define DEBUG_REPORT() DebugManager::Report()
+
+#else
+
+// the scope name is not evaluated, so building it costs nothing
+#define DEBUG_SCOPE(name) ((void)0)
+#define DEBUG_INITIALIZE() ((void)0)
+#define DEBUG_END_FRAME() ((void)0)
+#define DEBUG_REPORT() ((void)0)
+
+#endif
@@ -0,0 +1,456 @@
+///////////////////////////////////////////////////////////////////////////////
+// glrenderbackend.cpp
+// ============
+// draw through OpenGL - the scene shader's uniforms, written when they change
+//
+//  Uniform values belong to the program, so the kept values stay right
+//  while other programs are drawn with in between.  They are forgotten at
+//  the start of each pass and whenever the scene program is replaced.
+//  Sampler and texture bindings belong to the context, and are forgotten
+//  with them.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLRenderBackend.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+// declaration of global variables
+namespace
+{
+	// names of the uniforms in the order of GLRenderBackend::UNIFORM
+	const char* g_UniformNames[] =
+	{
+		"model",
+		"objectColor",
+		"bUseTexture",
+		"objectTexture",
+		"UVscale",
+		"material.diffuseColor",
+		"material.specularColor",
+		"material.shininess",
+		"bUseProceduralTexture",
+		"procedural.type",
+		"procedural.lightColor",
+		"procedural.darkColor",
+		"procedural.frequency",
+		"procedural.octaves",
+		"procedural.turbulence",
+		"procedural.bands",
+		"procedural.seed",
+		"bUseVirtualTexture",
+		"vtTextureSize",
+		"vtMaxLevel",
+		"vtTextureIndex",
+		"bUseReflection"
+	};
+}
+
+/***********************************************************
+ *  GLRenderBackend()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLRenderBackend::GLRenderBackend(ShaderManager* pShaderManager, const SamplerManager::SAMPLER_DESC& defaultSampler)
+{
+	m_pShaderManager = pShaderManager;
+	m_defaultSamplerDesc = defaultSampler;
+	m_defaultSampler = 0;
+	m_program = 0;
+	for (int i = 0; i < UNIFORM_COUNT; i++)
+	{
+		m_locations[i] = -1;
+	}
+	m_bStateKnown = false;
+	m_bTextureStateKnown = false;
+	m_model = glm::mat4(1.0f);
+	m_color = glm::vec4(1.0f);
+	m_UVscale = glm::vec2(1.0f);
+	m_bUseTexture = false;
+	m_textureUnit = -1;
+	m_material = -1;
+	m_sampler = 0;
+	m_bUsePattern = false;
+	m_pattern = -1;
+	m_bUseVirtualTexture = false;
+	m_virtualTexture = -1;
+	m_bReflect = false;
+	ResetStatistics();
+}
+
+/***********************************************************
+ *  ~GLRenderBackend()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLRenderBackend::~GLRenderBackend()
+{
+	m_pShaderManager = NULL;
+}
+
+/***********************************************************
+ *  GetName()
+ *
+ *  This method is used for getting the name of the backend.
+ ***********************************************************/
+const char* GLRenderBackend::GetName() const
+{
+	return("OpenGL");
+}
+
+/***********************************************************
+ *  CreateMaterial()
+ *
+ *  This method is used for adding a material.  OpenGL has
+ *  nothing to make for it, so the values are kept until a
+ *  draw uses them.
+ ***********************************************************/
+int GLRenderBackend::CreateMaterial(const MATERIAL& material)
+{
+	m_materials.push_back(material);
+	m_materialSamplers.push_back(0);
+	return((int)m_materials.size() - 1);
+}
+
+/***********************************************************
+ *  UpdateMaterial()
+ *
+ *  This method is used for changing the values of a
+ *  material.  When the last draw used it, the next draw
+ *  writes it again.
+ ***********************************************************/
+void GLRenderBackend::UpdateMaterial(int index, const MATERIAL& material)
+{
+	if ((index < 0) || (index >= (int)m_materials.size()))
+	{
+		return;
+	}
+
+	m_materials[index] = material;
+	// the sampler object is found again at the next draw
+	m_materialSamplers[index] = 0;
+	if (index == m_material)
+	{
+		m_material = -1;
+	}
+}
+
+/***********************************************************
+ *  CreatePattern()
+ *
+ *  This method is used for adding a pattern drawn by the
+ *  shader, kept until a draw uses it.
+ ***********************************************************/
+int GLRenderBackend::CreatePattern(const PATTERN& pattern)
+{
+	m_patterns.push_back(pattern);
+	return((int)m_patterns.size() - 1);
+}
+
+/***********************************************************
+ *  CreateVirtualTexture()
+ *
+ *  This method is used for adding a virtual texture, kept
+ *  until a draw uses it.
+ ***********************************************************/
+int GLRenderBackend::CreateVirtualTexture(const VIRTUAL_TEXTURE& texture)
+{
+	m_virtualTextures.push_back(texture);
+	return((int)m_virtualTextures.size() - 1);
+}
+
+/***********************************************************
+ *  GetMaterialSampler()
+ *
+ *  This method is used for getting the sampler object a
+ *  material filters its textures with, or the default one
+ *  for draws without a material.
+ ***********************************************************/
+GLuint GLRenderBackend::GetMaterialSampler(int material)
+{
+	if ((material < 0) || (material >= (int)m_materials.size()))
+	{
+		if (0 == m_defaultSampler)
+		{
+			m_defaultSampler = SamplerManager::GetSampler(m_defaultSamplerDesc);
+		}
+		return(m_defaultSampler);
+	}
+
+	if (0 == m_materialSamplers[material])
+	{
+		m_materialSamplers[material] = SamplerManager::GetSampler(m_materials[material].sampler);
+	}
+	return(m_materialSamplers[material]);
+}
+
+/***********************************************************
+ *  UpdateProgram()
+ *
+ *  This method is used for looking up the uniform
+ *  locations when the scene program has changed, such as
+ *  when it replaces the fallback program after compiling.
+ ***********************************************************/
+void GLRenderBackend::UpdateProgram()
+{
+	m_program = m_pShaderManager->m_programID;
+	for (int i = 0; i < UNIFORM_COUNT; i++)
+	{
+		m_locations[i] = glGetUniformLocation(m_program, g_UniformNames[i]);
+	}
+	m_bStateKnown = false;
+	m_bTextureStateKnown = false;
+}
+
+/***********************************************************
+ *  BeginPass()
+ *
+ *  This method is used for starting a pass of draws.  The
+ *  scene and other code write the same uniforms by name
+ *  between passes, so every value is written again once.
+ ***********************************************************/
+void GLRenderBackend::BeginPass()
+{
+	m_bStateKnown = false;
+	m_bTextureStateKnown = false;
+}
+
+/***********************************************************
+ *  SetDrawData()
+ *
+ *  This method is used for writing the values of the next
+ *  draw that differ from those of the draw before it.
+ ***********************************************************/
+void GLRenderBackend::SetDrawData(const DRAW_DATA& draw)
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+	if (m_pShaderManager->m_programID != m_program)
+	{
+		UpdateProgram();
+	}
+	m_statistics.draws++;
+
+	// the values of the last draw count only when they are known
+	bool bKnown = m_bStateKnown;
+	m_bStateKnown = true;
+
+	if (!bKnown || (draw.model != m_model))
+	{
+		glUniformMatrix4fv(m_locations[MODEL_UNIFORM], 1, GL_FALSE, glm::value_ptr(draw.model));
+		m_model = draw.model;
+		m_statistics.stateChanges++;
+	}
+	else
+	{
+		m_statistics.skippedChanges++;
+	}
+
+	if (!bKnown || (draw.bUseTexture != m_bUseTexture))
+	{
+		glUniform1i(m_locations[USE_TEXTURE_UNIFORM], draw.bUseTexture ? 1 : 0);
+		m_bUseTexture = draw.bUseTexture;
+		m_statistics.stateChanges++;
+	}
+	else
+	{
+		m_statistics.skippedChanges++;
+	}
+
+	if (draw.bUseTexture)
+	{
+		SetTextureData(draw);
+		if (!bKnown || (draw.UVscale != m_UVscale))
+		{
+			glUniform2fv(m_locations[UV_SCALE_UNIFORM], 1, glm::value_ptr(draw.UVscale));
+			m_UVscale = draw.UVscale;
+			m_statistics.stateChanges++;
+		}
+		else
+		{
+			m_statistics.skippedChanges++;
+		}
+	}
+	else
+	{
+		if (!bKnown || (draw.color != m_color))
+		{
+			glUniform4fv(m_locations[COLOR_UNIFORM], 1, glm::value_ptr(draw.color));
+			m_color = draw.color;
+			m_statistics.stateChanges++;
+		}
+		else
+		{
+			m_statistics.skippedChanges++;
+		}
+	}
+
+	if ((draw.material >= 0) && (draw.material < (int)m_materials.size()))
+	{
+		if (!bKnown || (draw.material != m_material))
+		{
+			const MATERIAL& material = m_materials[draw.material];
+			glUniform3fv(m_locations[DIFFUSE_COLOR_UNIFORM], 1, glm::value_ptr(material.diffuseColor));
+			glUniform3fv(m_locations[SPECULAR_COLOR_UNIFORM], 1, glm::value_ptr(material.specularColor));
+			glUniform1f(m_locations[SHININESS_UNIFORM], material.shininess);
+			m_material = draw.material;
+			m_statistics.stateChanges++;
+		}
+		else
+		{
+			m_statistics.skippedChanges++;
+		}
+	}
+	else if (!bKnown)
+	{
+		// the material left in the program is not known
+		m_material = -1;
+	}
+
+	SetFlag(USE_REFLECTION_UNIFORM, draw.bReflect, m_bReflect, bKnown);
+}
+
+/***********************************************************
+ *  SetTextureData()
+ *
+ *  This method is used for writing where a textured draw
+ *  reads its texels, a texture unit with the sampler of its
+ *  material, a pattern or a virtual texture, when it differs
+ *  from the last textured draw.
+ ***********************************************************/
+void GLRenderBackend::SetTextureData(const DRAW_DATA& draw)
+{
+	// colored draws leave the texture values alone, so they are
+	// known apart from the others
+	bool bKnown = m_bTextureStateKnown;
+	m_bTextureStateKnown = true;
+	if (!bKnown)
+	{
+		m_textureUnit = -1;
+		m_pattern = -1;
+		m_virtualTexture = -1;
+		m_sampler = 0;
+	}
+
+	SetFlag(USE_PATTERN_UNIFORM, draw.textureSource == TEXTURE_PATTERN, m_bUsePattern, bKnown);
+	SetFlag(USE_VIRTUAL_TEXTURE_UNIFORM, draw.textureSource == TEXTURE_VIRTUAL, m_bUseVirtualTexture, bKnown);
+
+	if (draw.textureSource == TEXTURE_PATTERN)
+	{
+		if ((draw.texture < 0) || (draw.texture >= (int)m_patterns.size()))
+		{
+			return;
+		}
+		if (!bKnown || (draw.texture != m_pattern))
+		{
+			const PATTERN& pattern = m_patterns[draw.texture];
+			glUniform1i(m_locations[PATTERN_TYPE_UNIFORM], pattern.type);
+			glUniform3fv(m_locations[PATTERN_LIGHT_COLOR_UNIFORM], 1, glm::value_ptr(pattern.lightColor));
+			glUniform3fv(m_locations[PATTERN_DARK_COLOR_UNIFORM], 1, glm::value_ptr(pattern.darkColor));
+			glUniform2fv(m_locations[PATTERN_FREQUENCY_UNIFORM], 1, glm::value_ptr(pattern.frequency));
+			glUniform1i(m_locations[PATTERN_OCTAVES_UNIFORM], pattern.octaves);
+			glUniform1f(m_locations[PATTERN_TURBULENCE_UNIFORM], pattern.turbulence);
+			glUniform1f(m_locations[PATTERN_BANDS_UNIFORM], pattern.bands);
+			glUniform1i(m_locations[PATTERN_SEED_UNIFORM], pattern.seed);
+			m_pattern = draw.texture;
+			m_statistics.stateChanges++;
+		}
+		else
+		{
+			m_statistics.skippedChanges++;
+		}
+	}
+	else if (draw.textureSource == TEXTURE_VIRTUAL)
+	{
+		if ((draw.texture < 0) || (draw.texture >= (int)m_virtualTextures.size()))
+		{
+			return;
+		}
+		if (!bKnown || (draw.texture != m_virtualTexture))
+		{
+			const VIRTUAL_TEXTURE& texture = m_virtualTextures[draw.texture];
+			glUniform2fv(m_locations[VIRTUAL_TEXTURE_SIZE_UNIFORM], 1, glm::value_ptr(texture.size));
+			glUniform1f(m_locations[VIRTUAL_MAX_LEVEL_UNIFORM], texture.maxLevel);
+			glUniform1f(m_locations[VIRTUAL_TEXTURE_INDEX_UNIFORM], (float)texture.cacheIndex);
+			glActiveTexture(GL_TEXTURE0 + texture.indirectionUnit);
+			glBindTexture(GL_TEXTURE_2D, texture.indirectionTexture);
+			glActiveTexture(GL_TEXTURE0);
+			m_virtualTexture = draw.texture;
+			m_statistics.stateChanges++;
+		}
+		else
+		{
+			m_statistics.skippedChanges++;
+		}
+	}
+	else if (draw.texture >= 0)
+	{
+		if (!bKnown || (draw.texture != m_textureUnit))
+		{
+			glUniform1i(m_locations[TEXTURE_UNIFORM], draw.texture);
+			m_statistics.stateChanges++;
+		}
+		else
+		{
+			m_statistics.skippedChanges++;
+		}
+
+		// the material decides how the texture is filtered
+		GLuint sampler = GetMaterialSampler(draw.material);
+		if (!bKnown || (draw.texture != m_textureUnit) || (sampler != m_sampler))
+		{
+			SamplerManager::BindSampler(draw.texture, sampler);
+			m_sampler = sampler;
+			m_statistics.stateChanges++;
+		}
+		else
+		{
+			m_statistics.skippedChanges++;
+		}
+		m_textureUnit = draw.texture;
+	}
+}
+
+/***********************************************************
+ *  SetFlag()
+ *
+ *  This method is used for writing a flag of the scene
+ *  shader when it differs from the last one written.
+ ***********************************************************/
+void GLRenderBackend::SetFlag(UNIFORM uniform, bool bValue, bool& bLastValue, bool bKnown)
+{
+	if (!bKnown || (bValue != bLastValue))
+	{
+		glUniform1i(m_locations[uniform], bValue ? 1 : 0);
+		bLastValue = bValue;
+		m_statistics.stateChanges++;
+	}
+	else
+	{
+		m_statistics.skippedChanges++;
+	}
+}
+
+/***********************************************************
+ *  GetStatistics()
+ *
+ *  This method is used for getting the draws and the
+ *  uniform writes since the last reset.
+ ***********************************************************/
+RenderBackend::STATISTICS GLRenderBackend::GetStatistics() const
+{
+	return(m_statistics);
+}
+
+/***********************************************************
+ *  ResetStatistics()
+ *
+ *  This method is used for starting the counts again.
+ ***********************************************************/
+void GLRenderBackend::ResetStatistics()
+{
+	m_statistics.draws = 0;
+	m_statistics.stateChanges = 0;
+	m_statistics.skippedChanges = 0;
+}
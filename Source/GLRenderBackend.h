@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// glrenderbackend.h
+// ============
+// draw through OpenGL - the scene shader's uniforms, written when they change
+//
+//  Setting a uniform by name looks its location up in the driver every
+//  time, which costs more than the value itself.  The locations are looked
+//  up once per program, and the values last written are kept, so a draw
+//  only writes what differs from the draw before it.  The samplers of the
+//  materials and the indirection textures of virtual textures are bound
+//  the same way.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderBackend.h"
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  GLRenderBackend
+ *
+ *  This class contains the code for setting the per object
+ *  values of the scene shader with OpenGL.
+ ***********************************************************/
+class GLRenderBackend : public RenderBackend
+{
+public:
+	// constructor, with the sampler for textures drawn without a
+	// material
+	GLRenderBackend(ShaderManager* pShaderManager, const SamplerManager::SAMPLER_DESC& defaultSampler);
+	// destructor
+	virtual ~GLRenderBackend();
+
+private:
+	// uniforms of the scene shader set for each draw
+	enum UNIFORM
+	{
+		MODEL_UNIFORM,
+		COLOR_UNIFORM,
+		USE_TEXTURE_UNIFORM,
+		TEXTURE_UNIFORM,
+		UV_SCALE_UNIFORM,
+		DIFFUSE_COLOR_UNIFORM,
+		SPECULAR_COLOR_UNIFORM,
+		SHININESS_UNIFORM,
+		USE_PATTERN_UNIFORM,
+		PATTERN_TYPE_UNIFORM,
+		PATTERN_LIGHT_COLOR_UNIFORM,
+		PATTERN_DARK_COLOR_UNIFORM,
+		PATTERN_FREQUENCY_UNIFORM,
+		PATTERN_OCTAVES_UNIFORM,
+		PATTERN_TURBULENCE_UNIFORM,
+		PATTERN_BANDS_UNIFORM,
+		PATTERN_SEED_UNIFORM,
+		USE_VIRTUAL_TEXTURE_UNIFORM,
+		VIRTUAL_TEXTURE_SIZE_UNIFORM,
+		VIRTUAL_MAX_LEVEL_UNIFORM,
+		VIRTUAL_TEXTURE_INDEX_UNIFORM,
+		USE_REFLECTION_UNIFORM,
+		UNIFORM_COUNT
+	};
+
+	ShaderManager* m_pShaderManager;
+	// program the locations were looked up in
+	GLuint m_program;
+	GLint m_locations[UNIFORM_COUNT];
+	std::vector<MATERIAL> m_materials;
+	// sampler objects of the materials, 0 until a draw uses them
+	std::vector<GLuint> m_materialSamplers;
+	SamplerManager::SAMPLER_DESC m_defaultSamplerDesc;
+	GLuint m_defaultSampler;
+	std::vector<PATTERN> m_patterns;
+	std::vector<VIRTUAL_TEXTURE> m_virtualTextures;
+
+	// values last written, known only since the pass began
+	bool m_bStateKnown;
+	bool m_bTextureStateKnown;
+	glm::mat4 m_model;
+	glm::vec4 m_color;
+	glm::vec2 m_UVscale;
+	bool m_bUseTexture;
+	int m_textureUnit;
+	int m_material;
+	GLuint m_sampler;
+	bool m_bUsePattern;
+	int m_pattern;
+	bool m_bUseVirtualTexture;
+	int m_virtualTexture;
+	bool m_bReflect;
+
+	STATISTICS m_statistics;
+
+	// look the locations up again when the program has changed
+	void UpdateProgram();
+	// the sampler object of a material, or the default sampler
+	GLuint GetMaterialSampler(int material);
+	// write the texture values of a draw that differ from the
+	// last textured draw's
+	void SetTextureData(const DRAW_DATA& draw);
+	// write a flag when it differs from the last one written
+	void SetFlag(UNIFORM uniform, bool bValue, bool& bLastValue, bool bKnown);
+
+public:
+	virtual const char* GetName() const;
+	virtual int CreateMaterial(const MATERIAL& material);
+	virtual void UpdateMaterial(int index, const MATERIAL& material);
+	virtual int CreatePattern(const PATTERN& pattern);
+	virtual int CreateVirtualTexture(const VIRTUAL_TEXTURE& texture);
+	virtual void BeginPass();
+	virtual void SetDrawData(const DRAW_DATA& draw);
+	virtual STATISTICS GetStatistics() const;
+	virtual void ResetStatistics();
+};
@@ -0,0 +1,271 @@
+///////////////////////////////////////////////////////////////////////////////
+// glresourcemanager.cpp
+// ============
+// own the OpenGL objects - handles freed once the GPU is done with them
+//
+//  Objects given back during a frame are collected in a batch, and the
+//  batch gets a fence at the end of the frame.  Each frame the oldest
+//  batches are checked without waiting, and deleted once their fence has
+//  signalled, which also returns the memory tracked for their textures and
+//  buffers.  Live objects are kept by name with their owner for the report.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLResourceManager.h"
+#include "MemoryManager.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	const char* g_TypeNames[GLResourceManager::RESOURCE_TYPE_COUNT] =
+	{
+		"texture",
+		"buffer",
+		"vertex array",
+		"program",
+		"framebuffer",
+		"render buffer"
+	};
+
+	// longest wait for the last fences at shutdown
+	const GLuint64 g_ShutdownWaitNanoseconds = 1000000000;
+
+	// an object given back and waiting to be deleted
+	struct PENDING_DELETE
+	{
+		GLResourceManager::RESOURCE_TYPE type;
+		GLuint name;
+	};
+
+	// the objects given back in one frame, and the fence after it
+	struct FENCED_BATCH
+	{
+		GLsync fence;
+		unsigned int frame;
+		std::vector<PENDING_DELETE> objects;
+	};
+
+	// live objects by name, with the owner that made them
+	std::map<GLuint, std::string> g_LiveObjects[GLResourceManager::RESOURCE_TYPE_COUNT];
+	std::vector<PENDING_DELETE> g_FrameDeletes;
+	std::deque<FENCED_BATCH> g_FencedBatches;
+	unsigned int g_FrameNumber = 0;
+
+	// statistics, printed at shutdown
+	int g_DeletedObjects = 0;
+	unsigned int g_MostFramesWaited = 0;
+
+	// delete an object now, returning its tracked memory
+	void DeleteObject(const PENDING_DELETE& object)
+	{
+		switch (object.type)
+		{
+		case GLResourceManager::RESOURCE_TEXTURE:
+			MemoryManager::ReleaseTexture(object.name);
+			glDeleteTextures(1, &object.name);
+			break;
+		case GLResourceManager::RESOURCE_BUFFER:
+			MemoryManager::ReleaseBuffer(object.name);
+			glDeleteBuffers(1, &object.name);
+			break;
+		case GLResourceManager::RESOURCE_VERTEX_ARRAY:
+			glDeleteVertexArrays(1, &object.name);
+			break;
+		case GLResourceManager::RESOURCE_PROGRAM:
+			glDeleteProgram(object.name);
+			break;
+		case GLResourceManager::RESOURCE_FRAMEBUFFER:
+			glDeleteFramebuffers(1, &object.name);
+			break;
+		case GLResourceManager::RESOURCE_RENDERBUFFER:
+			glDeleteRenderbuffers(1, &object.name);
+			break;
+		default:
+			break;
+		}
+		g_DeletedObjects++;
+	}
+
+	// delete the objects of a batch and its fence
+	void DeleteBatch(FENCED_BATCH& batch)
+	{
+		for (const PENDING_DELETE& object : batch.objects)
+		{
+			DeleteObject(object);
+		}
+		if (NULL != batch.fence)
+		{
+			glDeleteSync(batch.fence);
+		}
+		g_MostFramesWaited = std::max(g_MostFramesWaited, g_FrameNumber - batch.frame);
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for making an OpenGL object of a
+ *  type and charging it to an owner.
+ ***********************************************************/
+GLuint GLResourceManager::Create(RESOURCE_TYPE type, const char* owner)
+{
+	GLuint name = 0;
+	switch (type)
+	{
+	case RESOURCE_TEXTURE:
+		glGenTextures(1, &name);
+		break;
+	case RESOURCE_BUFFER:
+		glGenBuffers(1, &name);
+		break;
+	case RESOURCE_VERTEX_ARRAY:
+		glGenVertexArrays(1, &name);
+		break;
+	case RESOURCE_PROGRAM:
+		name = glCreateProgram();
+		break;
+	case RESOURCE_FRAMEBUFFER:
+		glGenFramebuffers(1, &name);
+		break;
+	case RESOURCE_RENDERBUFFER:
+		glGenRenderbuffers(1, &name);
+		break;
+	default:
+		break;
+	}
+
+	if (name != 0)
+	{
+		Adopt(type, name, owner);
+	}
+	return(name);
+}
+
+/***********************************************************
+ *  Adopt()
+ *
+ *  This method is used for charging an object made outside
+ *  the manager to an owner, so it is deleted and reported
+ *  like the others.
+ ***********************************************************/
+void GLResourceManager::Adopt(RESOURCE_TYPE type, GLuint name, const char* owner)
+{
+	g_LiveObjects[type][name] = owner;
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for giving back an object.  It is
+ *  deleted once the GPU has passed the fence at the end of
+ *  the frame, so draws still in flight can use it.
+ ***********************************************************/
+void GLResourceManager::Destroy(RESOURCE_TYPE type, GLuint name)
+{
+	if (name == 0)
+	{
+		return;
+	}
+
+	g_LiveObjects[type].erase(name);
+
+	PENDING_DELETE object;
+	object.type = type;
+	object.name = name;
+	g_FrameDeletes.push_back(object);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for fencing the objects given back
+ *  during the frame, and deleting the batches whose fence
+ *  the GPU has passed.  The fences are only polled, so the
+ *  frame never waits for the GPU.
+ ***********************************************************/
+void GLResourceManager::EndFrame()
+{
+	if (!g_FrameDeletes.empty())
+	{
+		FENCED_BATCH batch;
+		batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		batch.frame = g_FrameNumber;
+		batch.objects.swap(g_FrameDeletes);
+		g_FencedBatches.push_back(batch);
+	}
+
+	// fences signal in order, so the oldest batches go first
+	while (!g_FencedBatches.empty())
+	{
+		FENCED_BATCH& batch = g_FencedBatches.front();
+		if (NULL != batch.fence)
+		{
+			GLenum status = glClientWaitSync(batch.fence, 0, 0);
+			if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED))
+			{
+				break;
+			}
+		}
+		DeleteBatch(batch);
+		g_FencedBatches.pop_front();
+	}
+
+	g_FrameNumber++;
+}
+
+/***********************************************************
+ *  Shutdown()
+ *
+ *  This method is used for waiting for the last fences,
+ *  deleting what is left, and listing the objects that
+ *  were made but never given back.
+ ***********************************************************/
+void GLResourceManager::Shutdown()
+{
+	if (!g_FrameDeletes.empty())
+	{
+		FENCED_BATCH batch;
+		batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		batch.frame = g_FrameNumber;
+		batch.objects.swap(g_FrameDeletes);
+		g_FencedBatches.push_back(batch);
+	}
+	for (FENCED_BATCH& batch : g_FencedBatches)
+	{
+		if (NULL != batch.fence)
+		{
+			glClientWaitSync(batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_ShutdownWaitNanoseconds);
+		}
+		DeleteBatch(batch);
+	}
+	g_FencedBatches.clear();
+
+	std::cout << "INFO: GL objects - " << g_DeletedObjects << " deleted behind fences, "
+		<< "waiting at most " << g_MostFramesWaited << " frames" << std::endl;
+
+	int leaked = 0;
+	for (int type = 0; type < RESOURCE_TYPE_COUNT; type++)
+	{
+		for (const std::pair<const GLuint, std::string>& object : g_LiveObjects[type])
+		{
+			std::cout << "Leaked GL " << g_TypeNames[type] << " " << object.first
+				<< " made by " << object.second << std::endl;
+			leaked++;
+		}
+		g_LiveObjects[type].clear();
+	}
+	if (leaked > 0)
+	{
+		std::cout << leaked << " GL objects were never given back" << std::endl;
+	}
+	else
+	{
+		std::cout << "INFO: No GL objects leaked" << std::endl;
+	}
+}
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// glresourcemanager.h
+// ============
+// own the OpenGL objects - handles freed once the GPU is done with them
+//
+//  Textures, buffers, vertex arrays, programs, framebuffers and render
+//  buffers are held in handles that give their object back when they are
+//  reset or destroyed.  The deletions of a frame wait behind a fence, and
+//  are made only once the GPU has passed it, so an object is never deleted
+//  while draws still in flight use it, and no frame waits for the GPU to
+//  finish.  Objects never given back are listed at shutdown.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <utility>
+
+/***********************************************************
+ *  GLResourceManager
+ *
+ *  This class contains the code for creating OpenGL objects
+ *  and deleting them behind fences.  Objects are only made
+ *  and deleted on the rendering thread, with its context,
+ *  so everything is static.
+ ***********************************************************/
+class GLResourceManager
+{
+public:
+	enum RESOURCE_TYPE
+	{
+		RESOURCE_TEXTURE,
+		RESOURCE_BUFFER,
+		RESOURCE_VERTEX_ARRAY,
+		RESOURCE_PROGRAM,
+		RESOURCE_FRAMEBUFFER,
+		RESOURCE_RENDERBUFFER,
+		RESOURCE_TYPE_COUNT
+	};
+
+	// make an object, charged to an owner for the leak report
+	static GLuint Create(RESOURCE_TYPE type, const char* owner);
+	// charge an object made elsewhere, such as a linked program
+	static void Adopt(RESOURCE_TYPE type, GLuint name, const char* owner);
+	// delete an object once the GPU is done with the frames that
+	// may still use it, returning its tracked memory then
+	static void Destroy(RESOURCE_TYPE type, GLuint name);
+
+	// fence the deletions of the frame, and make those whose
+	// fence the GPU has passed, called once per frame
+	static void EndFrame();
+	// wait for every fence, make the deletions left and list the
+	// objects never given back, called before the context goes
+	static void Shutdown();
+};
+
+/***********************************************************
+ *  GLHandle
+ *
+ *  This class template holds one OpenGL object of a type,
+ *  giving it back to the resource manager when reset or
+ *  destroyed.  Handles can be moved but not copied, so each
+ *  object has a single owner.
+ ***********************************************************/
+template <GLResourceManager::RESOURCE_TYPE TYPE>
+class GLHandle
+{
+public:
+	GLHandle() : m_name(0) {}
+	~GLHandle() { Reset(); }
+
+	GLHandle(GLHandle&& other) noexcept : m_name(other.m_name) { other.m_name = 0; }
+	GLHandle& operator=(GLHandle&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+			std::swap(m_name, other.m_name);
+		}
+		return(*this);
+	}
+	GLHandle(const GLHandle&) = delete;
+	GLHandle& operator=(const GLHandle&) = delete;
+
+	// make a new object, giving back the one held
+	void Create(const char* owner)
+	{
+		Reset();
+		m_name = GLResourceManager::Create(TYPE, owner);
+	}
+	// hold an object made elsewhere, giving back the one held
+	void Adopt(GLuint name, const char* owner)
+	{
+		Reset();
+		m_name = name;
+		if (m_name != 0)
+		{
+			GLResourceManager::Adopt(TYPE, m_name, owner);
+		}
+	}
+	// give the object back, to be deleted behind a fence
+	void Reset()
+	{
+		if (m_name != 0)
+		{
+			GLResourceManager::Destroy(TYPE, m_name);
+			m_name = 0;
+		}
+	}
+
+	GLuint Get() const { return(m_name); }
+	bool IsValid() const { return(m_name != 0); }
+
+private:
+	GLuint m_name;
+};
+
+typedef GLHandle<GLResourceManager::RESOURCE_TEXTURE> GLTexture;
+typedef GLHandle<GLResourceManager::RESOURCE_BUFFER> GLBuffer;
+typedef GLHandle<GLResourceManager::RESOURCE_VERTEX_ARRAY> GLVertexArray;
+typedef GLHandle<GLResourceManager::RESOURCE_PROGRAM> GLProgram;
+typedef GLHandle<GLResourceManager::RESOURCE_FRAMEBUFFER> GLFramebuffer;
+typedef GLHandle<GLResourceManager::RESOURCE_RENDERBUFFER> GLRenderbuffer;
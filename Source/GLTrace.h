@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////////////
+// gltrace.h
+// ============
+// route the OpenGL calls through the trace manager - included ahead of all
+//
+//  The project includes this header ahead of every source file, the shape
+//  meshes and shader manager included, so each traced OpenGL function name
+//  becomes a call to the trace manager, which makes the OpenGL call and
+//  writes it down while a capture runs.  The trace manager and the replayer
+//  are built with GL_TRACE_REAL_CALLS, so they reach OpenGL itself.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GLTraceManager.h"
+
+#ifndef GL_TRACE_REAL_CALLS
+
+#undef glActiveTexture
+#define glActiveTexture(...) GLTraceManager::ActiveTexture(__VA_ARGS__)
+#undef glAttachShader
+#define glAttachShader(...) GLTraceManager::AttachShader(__VA_ARGS__)
+#undef glBeginConditionalRender
+#define glBeginConditionalRender(...) GLTraceManager::BeginConditionalRender(__VA_ARGS__)
+#undef glBeginQuery
+#define glBeginQuery(...) GLTraceManager::BeginQuery(__VA_ARGS__)
+#undef glBindBuffer
+#define glBindBuffer(...) GLTraceManager::BindBuffer(__VA_ARGS__)
+#undef glBindBufferBase
+#define glBindBufferBase(...) GLTraceManager::BindBufferBase(__VA_ARGS__)
+#undef glBindFramebuffer
+#define glBindFramebuffer(...) GLTraceManager::BindFramebuffer(__VA_ARGS__)
+#undef glBindImageTexture
+#define glBindImageTexture(...) GLTraceManager::BindImageTexture(__VA_ARGS__)
+#undef glBindRenderbuffer
+#define glBindRenderbuffer(...) GLTraceManager::BindRenderbuffer(__VA_ARGS__)
+#undef glBindSampler
+#define glBindSampler(...) GLTraceManager::BindSampler(__VA_ARGS__)
+#undef glBindTexture
+#define glBindTexture(...) GLTraceManager::BindTexture(__VA_ARGS__)
+#undef glBindVertexArray
+#define glBindVertexArray(...) GLTraceManager::BindVertexArray(__VA_ARGS__)
+#undef glBlendFunc
+#define glBlendFunc(...) GLTraceManager::BlendFunc(__VA_ARGS__)
+#undef glBufferData
+#define glBufferData(...) GLTraceManager::BufferData(__VA_ARGS__)
+#undef glBufferSubData
+#define glBufferSubData(...) GLTraceManager::BufferSubData(__VA_ARGS__)
+#undef glClear
+#define glClear(...) GLTraceManager::Clear(__VA_ARGS__)
+#undef glClearColor
+#define glClearColor(...) GLTraceManager::ClearColor(__VA_ARGS__)
+#undef glColorMask
+#define glColorMask(...) GLTraceManager::ColorMask(__VA_ARGS__)
+#undef glCompileShader
+#define glCompileShader(...) GLTraceManager::CompileShader(__VA_ARGS__)
+#undef glCopyBufferSubData
+#define glCopyBufferSubData(...) GLTraceManager::CopyBufferSubData(__VA_ARGS__)
+#undef glCreateProgram
+#define glCreateProgram(...) GLTraceManager::CreateProgram(__VA_ARGS__)
+#undef glCreateShader
+#define glCreateShader(...) GLTraceManager::CreateShader(__VA_ARGS__)
+#undef glCullFace
+#define glCullFace(...) GLTraceManager::CullFace(__VA_ARGS__)
+#undef glDeleteBuffers
+#define glDeleteBuffers(...) GLTraceManager::DeleteBuffers(__VA_ARGS__)
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers(...) GLTraceManager::DeleteFramebuffers(__VA_ARGS__)
+#undef glDeleteProgram
+#define glDeleteProgram(...) GLTraceManager::DeleteProgram(__VA_ARGS__)
+#undef glDeleteQueries
+#define glDeleteQueries(...) GLTraceManager::DeleteQueries(__VA_ARGS__)
+#undef glDeleteRenderbuffers
+#define glDeleteRenderbuffers(...) GLTraceManager::DeleteRenderbuffers(__VA_ARGS__)
+#undef glDeleteSamplers
+#define glDeleteSamplers(...) GLTraceManager::DeleteSamplers(__VA_ARGS__)
+#undef glDeleteShader
+#define glDeleteShader(...) GLTraceManager::DeleteShader(__VA_ARGS__)
+#undef glDeleteTextures
+#define glDeleteTextures(...) GLTraceManager::DeleteTextures(__VA_ARGS__)
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays(...) GLTraceManager::DeleteVertexArrays(__VA_ARGS__)
+#undef glDepthFunc
+#define glDepthFunc(...) GLTraceManager::DepthFunc(__VA_ARGS__)
+#undef glDepthMask
+#define glDepthMask(...) GLTraceManager::DepthMask(__VA_ARGS__)
+#undef glDetachShader
+#define glDetachShader(...) GLTraceManager::DetachShader(__VA_ARGS__)
+#undef glDisable
+#define glDisable(...) GLTraceManager::Disable(__VA_ARGS__)
+#undef glDisableVertexAttribArray
+#define glDisableVertexAttribArray(...) GLTraceManager::DisableVertexAttribArray(__VA_ARGS__)
+#undef glDispatchCompute
+#define glDispatchCompute(...) GLTraceManager::DispatchCompute(__VA_ARGS__)
+#undef glDrawArrays
+#define glDrawArrays(...) GLTraceManager::DrawArrays(__VA_ARGS__)
+#undef glDrawArraysIndirect
+#define glDrawArraysIndirect(...) GLTraceManager::DrawArraysIndirect(__VA_ARGS__)
+#undef glDrawArraysInstanced
+#define glDrawArraysInstanced(...) GLTraceManager::DrawArraysInstanced(__VA_ARGS__)
+#undef glDrawElements
+#define glDrawElements(...) GLTraceManager::DrawElements(__VA_ARGS__)
+#undef glDrawElementsInstanced
+#define glDrawElementsInstanced(...) GLTraceManager::DrawElementsInstanced(__VA_ARGS__)
+#undef glEnable
+#define glEnable(...) GLTraceManager::Enable(__VA_ARGS__)
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray(...) GLTraceManager::EnableVertexAttribArray(__VA_ARGS__)
+#undef glEndConditionalRender
+#define glEndConditionalRender(...) GLTraceManager::EndConditionalRender(__VA_ARGS__)
+#undef glEndQuery
+#define glEndQuery(...) GLTraceManager::EndQuery(__VA_ARGS__)
+#undef glFinish
+#define glFinish(...) GLTraceManager::Finish(__VA_ARGS__)
+#undef glFlush
+#define glFlush(...) GLTraceManager::Flush(__VA_ARGS__)
+#undef glFramebufferRenderbuffer
+#define glFramebufferRenderbuffer(...) GLTraceManager::FramebufferRenderbuffer(__VA_ARGS__)
+#undef glFramebufferTexture2D
+#define glFramebufferTexture2D(...) GLTraceManager::FramebufferTexture2D(__VA_ARGS__)
+#undef glGenBuffers
+#define glGenBuffers(...) GLTraceManager::GenBuffers(__VA_ARGS__)
+#undef glGenFramebuffers
+#define glGenFramebuffers(...) GLTraceManager::GenFramebuffers(__VA_ARGS__)
+#undef glGenQueries
+#define glGenQueries(...) GLTraceManager::GenQueries(__VA_ARGS__)
+#undef glGenRenderbuffers
+#define glGenRenderbuffers(...) GLTraceManager::GenRenderbuffers(__VA_ARGS__)
+#undef glGenSamplers
+#define glGenSamplers(...) GLTraceManager::GenSamplers(__VA_ARGS__)
+#undef glGenTextures
+#define glGenTextures(...) GLTraceManager::GenTextures(__VA_ARGS__)
+#undef glGenVertexArrays
+#define glGenVertexArrays(...) GLTraceManager::GenVertexArrays(__VA_ARGS__)
+#undef glGenerateMipmap
+#define glGenerateMipmap(...) GLTraceManager::GenerateMipmap(__VA_ARGS__)
+#undef glGetUniformLocation
+#define glGetUniformLocation(...) GLTraceManager::GetUniformLocation(__VA_ARGS__)
+#undef glLinkProgram
+#define glLinkProgram(...) GLTraceManager::LinkProgram(__VA_ARGS__)
+#undef glMapBufferRange
+#define glMapBufferRange(...) GLTraceManager::MapBufferRange(__VA_ARGS__)
+#undef glMemoryBarrier
+#define glMemoryBarrier(...) GLTraceManager::IssueMemoryBarrier(__VA_ARGS__)
+#undef glPixelStorei
+#define glPixelStorei(...) GLTraceManager::PixelStorei(__VA_ARGS__)
+#undef glPolygonMode
+#define glPolygonMode(...) GLTraceManager::PolygonMode(__VA_ARGS__)
+#undef glQueryCounter
+#define glQueryCounter(...) GLTraceManager::QueryCounter(__VA_ARGS__)
+#undef glReadPixels
+#define glReadPixels(...) GLTraceManager::ReadPixels(__VA_ARGS__)
+#undef glRenderbufferStorage
+#define glRenderbufferStorage(...) GLTraceManager::RenderbufferStorage(__VA_ARGS__)
+#undef glSamplerParameterf
+#define glSamplerParameterf(...) GLTraceManager::SamplerParameterf(__VA_ARGS__)
+#undef glSamplerParameteri
+#define glSamplerParameteri(...) GLTraceManager::SamplerParameteri(__VA_ARGS__)
+#undef glShaderSource
+#define glShaderSource(...) GLTraceManager::ShaderSource(__VA_ARGS__)
+#undef glTexImage2D
+#define glTexImage2D(...) GLTraceManager::TexImage2D(__VA_ARGS__)
+#undef glTexParameteri
+#define glTexParameteri(...) GLTraceManager::TexParameteri(__VA_ARGS__)
+#undef glTexParameteriv
+#define glTexParameteriv(...) GLTraceManager::TexParameteriv(__VA_ARGS__)
+#undef glTexStorage2D
+#define glTexStorage2D(...) GLTraceManager::TexStorage2D(__VA_ARGS__)
+#undef glTexSubImage2D
+#define glTexSubImage2D(...) GLTraceManager::TexSubImage2D(__VA_ARGS__)
+#undef glUniform1f
+#define glUniform1f(...) GLTraceManager::Uniform1f(__VA_ARGS__)
+#undef glUniform2f
+#define glUniform2f(...) GLTraceManager::Uniform2f(__VA_ARGS__)
+#undef glUniform3f
+#define glUniform3f(...) GLTraceManager::Uniform3f(__VA_ARGS__)
+#undef glUniform4f
+#define glUniform4f(...) GLTraceManager::Uniform4f(__VA_ARGS__)
+#undef glUniform2fv
+#define glUniform2fv(...) GLTraceManager::Uniform2fv(__VA_ARGS__)
+#undef glUniform3fv
+#define glUniform3fv(...) GLTraceManager::Uniform3fv(__VA_ARGS__)
+#undef glUniform4fv
+#define glUniform4fv(...) GLTraceManager::Uniform4fv(__VA_ARGS__)
+#undef glUniform1i
+#define glUniform1i(...) GLTraceManager::Uniform1i(__VA_ARGS__)
+#undef glUniform1ui
+#define glUniform1ui(...) GLTraceManager::Uniform1ui(__VA_ARGS__)
+#undef glUniformMatrix3fv
+#define glUniformMatrix3fv(...) GLTraceManager::UniformMatrix3fv(__VA_ARGS__)
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv(...) GLTraceManager::UniformMatrix4fv(__VA_ARGS__)
+#undef glUnmapBuffer
+#define glUnmapBuffer(...) GLTraceManager::UnmapBuffer(__VA_ARGS__)
+#undef glUseProgram
+#define glUseProgram(...) GLTraceManager::UseProgram(__VA_ARGS__)
+#undef glVertexAttribDivisor
+#define glVertexAttribDivisor(...) GLTraceManager::VertexAttribDivisor(__VA_ARGS__)
+#undef glVertexAttribPointer
+#define glVertexAttribPointer(...) GLTraceManager::VertexAttribPointer(__VA_ARGS__)
+#undef glViewport
+#define glViewport(...) GLTraceManager::Viewport(__VA_ARGS__)
+
+#endif
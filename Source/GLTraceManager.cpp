@@ -0,0 +1,1608 @@
+///////////////////////////////////////////////////////////////////////////////
+// gltracemanager.cpp
+// ============
+// capture the OpenGL calls of the renderer - command stream for replay
+//
+//  Each traced entry point makes its OpenGL call first, so the names and
+//  locations OpenGL hands back are written with the call that made them,
+//  and the replayer maps them to its own.  Pointers OpenGL reads from are
+//  written as their data, sized from the call and the pixel store state,
+//  except when a pixel buffer is bound and the pointer is an offset into
+//  it.  Data written into a mapped buffer is written out at the unmap.
+//  This file is built with GL_TRACE_REAL_CALLS, so it calls OpenGL itself.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLTraceManager.h"
+
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	const char* g_CommandNames[GLTraceManager::TRACE_COMMAND_COUNT] =
+	{
+		"frame end",
+		"glActiveTexture",
+		"glAttachShader",
+		"glBeginConditionalRender",
+		"glBeginQuery",
+		"glBindBuffer",
+		"glBindBufferBase",
+		"glBindFramebuffer",
+		"glBindImageTexture",
+		"glBindRenderbuffer",
+		"glBindSampler",
+		"glBindTexture",
+		"glBindVertexArray",
+		"glBlendFunc",
+		"glBufferData",
+		"glBufferSubData",
+		"glClear",
+		"glClearColor",
+		"glColorMask",
+		"glCompileShader",
+		"glCopyBufferSubData",
+		"glCreateProgram",
+		"glCreateShader",
+		"glCullFace",
+		"glDeleteBuffers",
+		"glDeleteFramebuffers",
+		"glDeleteProgram",
+		"glDeleteQueries",
+		"glDeleteRenderbuffers",
+		"glDeleteSamplers",
+		"glDeleteShader",
+		"glDeleteTextures",
+		"glDeleteVertexArrays",
+		"glDepthFunc",
+		"glDepthMask",
+		"glDetachShader",
+		"glDisable",
+		"glDisableVertexAttribArray",
+		"glDispatchCompute",
+		"glDrawArrays",
+		"glDrawArraysIndirect",
+		"glDrawArraysInstanced",
+		"glDrawElements",
+		"glDrawElementsInstanced",
+		"glEnable",
+		"glEnableVertexAttribArray",
+		"glEndConditionalRender",
+		"glEndQuery",
+		"glFinish",
+		"glFlush",
+		"glFramebufferRenderbuffer",
+		"glFramebufferTexture2D",
+		"glGenBuffers",
+		"glGenFramebuffers",
+		"glGenQueries",
+		"glGenRenderbuffers",
+		"glGenSamplers",
+		"glGenTextures",
+		"glGenVertexArrays",
+		"glGenerateMipmap",
+		"glGetUniformLocation",
+		"glLinkProgram",
+		"glMapBufferRange",
+		"glMemoryBarrier",
+		"glPixelStorei",
+		"glPolygonMode",
+		"glQueryCounter",
+		"glReadPixels",
+		"glRenderbufferStorage",
+		"glSamplerParameterf",
+		"glSamplerParameteri",
+		"glShaderSource",
+		"glTexImage2D",
+		"glTexParameteri",
+		"glTexParameteriv",
+		"glTexStorage2D",
+		"glTexSubImage2D",
+		"glUniform*f",
+		"glUniform*fv",
+		"glUniform1i",
+		"glUniform1ui",
+		"glUniformMatrix*fv",
+		"glUnmapBuffer",
+		"glUseProgram",
+		"glVertexAttribDivisor",
+		"glVertexAttribPointer",
+		"glViewport"
+	};
+
+	std::ofstream g_TraceFile;
+	std::string g_TraceFilename;
+	bool g_bCapturing = false;
+	GLTraceManager::FILE_HEADER g_Header;
+	int g_FramesLeft = 0;
+
+	// the command being put together
+	GLTraceManager::TRACE_COMMAND g_Command = GLTraceManager::TRACE_FRAME_END;
+	std::vector<unsigned char> g_Payload;
+	unsigned long long g_BytesWritten = 0;
+
+	// pointers are offsets into the buffers bound to these
+	GLuint g_PackBuffer = 0;
+	GLuint g_UnpackBuffer = 0;
+	GLuint g_IndirectBuffer = 0;
+	// pixel store state, which sizes the images read from memory
+	GLint g_UnpackAlignment = 4;
+	GLint g_UnpackRowLength = 0;
+	GLint g_PackAlignment = 4;
+	GLint g_PackRowLength = 0;
+
+	// buffer ranges mapped by their target, written out at unmap
+	struct MAPPED_RANGE
+	{
+		void* pData;
+		GLsizeiptr length;
+		GLbitfield access;
+	};
+	std::map<GLenum, MAPPED_RANGE> g_MappedRanges;
+
+	void BeginCommand(GLTraceManager::TRACE_COMMAND command)
+	{
+		g_Command = command;
+		g_Payload.clear();
+	}
+
+	void PutWord(unsigned int word)
+	{
+		unsigned char bytes[4];
+		memcpy(bytes, &word, sizeof(bytes));
+		g_Payload.insert(g_Payload.end(), bytes, bytes + sizeof(bytes));
+	}
+
+	void PutFloat(float value)
+	{
+		unsigned int word = 0;
+		memcpy(&word, &value, sizeof(word));
+		PutWord(word);
+	}
+
+	// sizes and offsets are written as 64 bits on every platform
+	void PutLong(unsigned long long value)
+	{
+		PutWord((unsigned int)(value & 0xFFFFFFFFu));
+		PutWord((unsigned int)(value >> 32));
+	}
+
+	void PutData(const void* pData, size_t size)
+	{
+		PutWord((unsigned int)size);
+		const unsigned char* pBytes = (const unsigned char*)pData;
+		g_Payload.insert(g_Payload.end(), pBytes, pBytes + size);
+	}
+
+	void PutNames(GLsizei n, const GLuint* pNames)
+	{
+		PutWord((unsigned int)n);
+		for (GLsizei i = 0; i < n; i++)
+		{
+			PutWord(pNames[i]);
+		}
+	}
+
+	void EndCommand()
+	{
+		unsigned short command = (unsigned short)g_Command;
+		unsigned int size = (unsigned int)g_Payload.size();
+		g_TraceFile.write((const char*)&command, sizeof(command));
+		g_TraceFile.write((const char*)&size, sizeof(size));
+		if (size > 0)
+		{
+			g_TraceFile.write((const char*)g_Payload.data(), size);
+		}
+		g_BytesWritten += sizeof(command) + sizeof(size) + size;
+		g_Header.commandCount++;
+	}
+
+	// write a command whose arguments are all 32 bit words
+	void WriteWords(GLTraceManager::TRACE_COMMAND command, std::initializer_list<unsigned int> words)
+	{
+		BeginCommand(command);
+		for (unsigned int word : words)
+		{
+			PutWord(word);
+		}
+		EndCommand();
+	}
+
+	// write the data of a pixel call, or its offset into the
+	// bound pixel buffer
+	void PutPixels(const void* pixels, size_t size, bool bInBuffer)
+	{
+		PutWord(bInBuffer ? 1 : 0);
+		if (bInBuffer)
+		{
+			PutLong((unsigned long long)(size_t)pixels);
+		}
+		else if (NULL == pixels)
+		{
+			PutData(NULL, 0);
+		}
+		else
+		{
+			PutData(pixels, size);
+		}
+	}
+
+	void PutUniformValues(const GLfloat* pValues, size_t valueCount)
+	{
+		for (size_t i = 0; i < valueCount; i++)
+		{
+			PutFloat(pValues[i]);
+		}
+	}
+}
+
+/***********************************************************
+ *  StartCapture()
+ *
+ *  This method is used for opening the trace file and
+ *  writing down the state set before the capture started,
+ *  so the replay begins where the capture did.
+ ***********************************************************/
+bool GLTraceManager::StartCapture(const char* filename, int frameCount, int width, int height)
+{
+	if (g_bCapturing)
+	{
+		return(false);
+	}
+
+	g_TraceFile.open(filename, std::ios::binary | std::ios::trunc);
+	if (!g_TraceFile.is_open())
+	{
+		std::cout << "Could not create the GL trace file " << filename << std::endl;
+		return(false);
+	}
+
+	g_TraceFilename = filename;
+	g_Header.magic = FILE_MAGIC;
+	g_Header.version = FILE_VERSION;
+	g_Header.width = width;
+	g_Header.height = height;
+	g_Header.frameCount = 0;
+	g_Header.commandCount = 0;
+	g_TraceFile.write((const char*)&g_Header, sizeof(g_Header));
+	g_BytesWritten = sizeof(g_Header);
+	g_FramesLeft = frameCount;
+	g_bCapturing = true;
+
+	// the window set some state before anything was traced
+	const GLenum capabilities[] = { GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE };
+	for (GLenum capability : capabilities)
+	{
+		WriteWords(glIsEnabled(capability) ? TRACE_ENABLE : TRACE_DISABLE, { capability });
+	}
+	GLint blendSource = GL_ONE;
+	GLint blendDestination = GL_ZERO;
+	glGetIntegerv(GL_BLEND_SRC_RGB, &blendSource);
+	glGetIntegerv(GL_BLEND_DST_RGB, &blendDestination);
+	WriteWords(TRACE_BLEND_FUNC, { (unsigned int)blendSource, (unsigned int)blendDestination });
+	GLint viewport[4] = { 0, 0, width, height };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	WriteWords(TRACE_VIEWPORT,
+		{ (unsigned int)viewport[0], (unsigned int)viewport[1], (unsigned int)viewport[2], (unsigned int)viewport[3] });
+
+	std::cout << "INFO: Capturing the GL calls of " << frameCount << " frames into " << filename << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  IsCapturing()
+ *
+ *  This method is used for checking whether the calls are
+ *  being written.
+ ***********************************************************/
+bool GLTraceManager::IsCapturing()
+{
+	return(g_bCapturing);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for marking the end of a frame in
+ *  the trace, and finishing the file after the last one.
+ ***********************************************************/
+void GLTraceManager::EndFrame()
+{
+	if (!g_bCapturing)
+	{
+		return;
+	}
+
+	WriteWords(TRACE_FRAME_END, {});
+	g_Header.frameCount++;
+	g_FramesLeft--;
+	if (g_FramesLeft <= 0)
+	{
+		StopCapture();
+	}
+}
+
+/***********************************************************
+ *  StopCapture()
+ *
+ *  This method is used for writing the final frame and
+ *  command counts into the header and closing the file.
+ ***********************************************************/
+void GLTraceManager::StopCapture()
+{
+	if (!g_bCapturing)
+	{
+		return;
+	}
+
+	g_bCapturing = false;
+	g_TraceFile.seekp(0);
+	g_TraceFile.write((const char*)&g_Header, sizeof(g_Header));
+	bool bWritten = g_TraceFile.good();
+	g_TraceFile.close();
+	g_MappedRanges.clear();
+
+	if (bWritten)
+	{
+		std::cout << "INFO: GL trace " << g_TraceFilename << " holds " << g_Header.frameCount << " frames, "
+			<< g_Header.commandCount << " calls, " << g_BytesWritten / (1024 * 1024) << " MB" << std::endl;
+	}
+	else
+	{
+		std::cout << "Could not write the GL trace file " << g_TraceFilename << std::endl;
+	}
+}
+
+/***********************************************************
+ *  GetCommandName()
+ *
+ *  This method is used for getting the OpenGL function
+ *  name of a trace command.
+ ***********************************************************/
+const char* GLTraceManager::GetCommandName(int command)
+{
+	if ((command < 0) || (command >= TRACE_COMMAND_COUNT))
+	{
+		return("unknown");
+	}
+	return(g_CommandNames[command]);
+}
+
+/***********************************************************
+ *  GetImageBytes()
+ *
+ *  This method is used for finding how many bytes OpenGL
+ *  reads or writes for an image, from its size, format and
+ *  the pixel store alignment and row length.
+ ***********************************************************/
+size_t GLTraceManager::GetImageBytes(
+	GLsizei width,
+	GLsizei height,
+	GLenum format,
+	GLenum type,
+	GLint alignment,
+	GLint rowLength)
+{
+	if ((width <= 0) || (height <= 0))
+	{
+		return(0);
+	}
+
+	size_t components = 4;
+	switch (format)
+	{
+	case GL_RED:
+	case GL_RED_INTEGER:
+	case GL_DEPTH_COMPONENT:
+	case GL_STENCIL_INDEX:
+		components = 1;
+		break;
+	case GL_RG:
+	case GL_RG_INTEGER:
+	case GL_DEPTH_STENCIL:
+		components = 2;
+		break;
+	case GL_RGB:
+	case GL_BGR:
+	case GL_RGB_INTEGER:
+		components = 3;
+		break;
+	default:
+		break;
+	}
+
+	size_t pixelBytes = components;
+	switch (type)
+	{
+	case GL_UNSIGNED_SHORT:
+	case GL_SHORT:
+	case GL_HALF_FLOAT:
+		pixelBytes = components * 2;
+		break;
+	case GL_UNSIGNED_INT:
+	case GL_INT:
+	case GL_FLOAT:
+		pixelBytes = components * 4;
+		break;
+	// packed types hold a whole pixel
+	case GL_UNSIGNED_SHORT_5_6_5:
+	case GL_UNSIGNED_SHORT_5_6_5_REV:
+	case GL_UNSIGNED_SHORT_4_4_4_4:
+	case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+		pixelBytes = 2;
+		break;
+	case GL_UNSIGNED_INT_8_8_8_8:
+	case GL_UNSIGNED_INT_8_8_8_8_REV:
+	case GL_UNSIGNED_INT_10_10_10_2:
+	case GL_UNSIGNED_INT_2_10_10_10_REV:
+	case GL_UNSIGNED_INT_24_8:
+	case GL_UNSIGNED_INT_10F_11F_11F_REV:
+	case GL_UNSIGNED_INT_5_9_9_9_REV:
+		pixelBytes = 4;
+		break;
+	case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+		pixelBytes = 8;
+		break;
+	default:
+		break;
+	}
+
+	size_t rowPixels = (rowLength > 0) ? (size_t)rowLength : (size_t)width;
+	size_t rowAlignment = (alignment > 0) ? (size_t)alignment : 1;
+	size_t rowBytes = (rowPixels * pixelBytes + rowAlignment - 1) / rowAlignment * rowAlignment;
+	return(rowBytes * (height - 1) + width * pixelBytes);
+}
+
+/***********************************************************
+ *  The traced entry points
+ *
+ *  Each one makes its OpenGL call, and writes it down while
+ *  a capture runs.
+ ***********************************************************/
+void GLTraceManager::ActiveTexture(GLenum texture)
+{
+	glActiveTexture(texture);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_ACTIVE_TEXTURE, { texture });
+	}
+}
+
+void GLTraceManager::AttachShader(GLuint program, GLuint shader)
+{
+	glAttachShader(program, shader);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_ATTACH_SHADER, { program, shader });
+	}
+}
+
+void GLTraceManager::BeginConditionalRender(GLuint id, GLenum mode)
+{
+	glBeginConditionalRender(id, mode);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BEGIN_CONDITIONAL_RENDER, { id, mode });
+	}
+}
+
+void GLTraceManager::BeginQuery(GLenum target, GLuint id)
+{
+	glBeginQuery(target, id);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BEGIN_QUERY, { target, id });
+	}
+}
+
+void GLTraceManager::BindBuffer(GLenum target, GLuint buffer)
+{
+	glBindBuffer(target, buffer);
+	switch (target)
+	{
+	case GL_PIXEL_PACK_BUFFER:
+		g_PackBuffer = buffer;
+		break;
+	case GL_PIXEL_UNPACK_BUFFER:
+		g_UnpackBuffer = buffer;
+		break;
+	case GL_DRAW_INDIRECT_BUFFER:
+		g_IndirectBuffer = buffer;
+		break;
+	default:
+		break;
+	}
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BIND_BUFFER, { target, buffer });
+	}
+}
+
+void GLTraceManager::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	glBindBufferBase(target, index, buffer);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BIND_BUFFER_BASE, { target, index, buffer });
+	}
+}
+
+void GLTraceManager::BindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	glBindFramebuffer(target, framebuffer);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BIND_FRAMEBUFFER, { target, framebuffer });
+	}
+}
+
+void GLTraceManager::BindImageTexture(
+	GLuint unit,
+	GLuint texture,
+	GLint level,
+	GLboolean layered,
+	GLint layer,
+	GLenum access,
+	GLenum format)
+{
+	glBindImageTexture(unit, texture, level, layered, layer, access, format);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BIND_IMAGE_TEXTURE,
+			{ unit, texture, (unsigned int)level, layered, (unsigned int)layer, access, format });
+	}
+}
+
+void GLTraceManager::BindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+	glBindRenderbuffer(target, renderbuffer);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BIND_RENDERBUFFER, { target, renderbuffer });
+	}
+}
+
+void GLTraceManager::BindSampler(GLuint unit, GLuint sampler)
+{
+	glBindSampler(unit, sampler);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BIND_SAMPLER, { unit, sampler });
+	}
+}
+
+void GLTraceManager::BindTexture(GLenum target, GLuint texture)
+{
+	glBindTexture(target, texture);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BIND_TEXTURE, { target, texture });
+	}
+}
+
+void GLTraceManager::BindVertexArray(GLuint array)
+{
+	glBindVertexArray(array);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BIND_VERTEX_ARRAY, { array });
+	}
+}
+
+void GLTraceManager::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	glBlendFunc(sfactor, dfactor);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_BLEND_FUNC, { sfactor, dfactor });
+	}
+}
+
+void GLTraceManager::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	glBufferData(target, size, data, usage);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_BUFFER_DATA);
+		PutWord(target);
+		PutLong((unsigned long long)size);
+		PutWord(usage);
+		PutData(data, (NULL != data) ? (size_t)size : 0);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	glBufferSubData(target, offset, size, data);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_BUFFER_SUB_DATA);
+		PutWord(target);
+		PutLong((unsigned long long)offset);
+		PutData(data, (size_t)size);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Clear(GLbitfield mask)
+{
+	glClear(mask);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_CLEAR, { mask });
+	}
+}
+
+void GLTraceManager::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	glClearColor(red, green, blue, alpha);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_CLEAR_COLOR);
+		PutFloat(red);
+		PutFloat(green);
+		PutFloat(blue);
+		PutFloat(alpha);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+	glColorMask(red, green, blue, alpha);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_COLOR_MASK, { red, green, blue, alpha });
+	}
+}
+
+void GLTraceManager::CompileShader(GLuint shader)
+{
+	glCompileShader(shader);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_COMPILE_SHADER, { shader });
+	}
+}
+
+void GLTraceManager::CopyBufferSubData(
+	GLenum readTarget,
+	GLenum writeTarget,
+	GLintptr readOffset,
+	GLintptr writeOffset,
+	GLsizeiptr size)
+{
+	glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_COPY_BUFFER_SUB_DATA);
+		PutWord(readTarget);
+		PutWord(writeTarget);
+		PutLong((unsigned long long)readOffset);
+		PutLong((unsigned long long)writeOffset);
+		PutLong((unsigned long long)size);
+		EndCommand();
+	}
+}
+
+GLuint GLTraceManager::CreateProgram()
+{
+	GLuint program = glCreateProgram();
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_CREATE_PROGRAM, { program });
+	}
+	return(program);
+}
+
+GLuint GLTraceManager::CreateShader(GLenum type)
+{
+	GLuint shader = glCreateShader(type);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_CREATE_SHADER, { type, shader });
+	}
+	return(shader);
+}
+
+void GLTraceManager::CullFace(GLenum mode)
+{
+	glCullFace(mode);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_CULL_FACE, { mode });
+	}
+}
+
+void GLTraceManager::DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	glDeleteBuffers(n, buffers);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_DELETE_BUFFERS);
+		PutNames(n, buffers);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+	glDeleteFramebuffers(n, framebuffers);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_DELETE_FRAMEBUFFERS);
+		PutNames(n, framebuffers);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DeleteProgram(GLuint program)
+{
+	glDeleteProgram(program);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DELETE_PROGRAM, { program });
+	}
+}
+
+void GLTraceManager::DeleteQueries(GLsizei n, const GLuint* ids)
+{
+	glDeleteQueries(n, ids);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_DELETE_QUERIES);
+		PutNames(n, ids);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
+{
+	glDeleteRenderbuffers(n, renderbuffers);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_DELETE_RENDERBUFFERS);
+		PutNames(n, renderbuffers);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DeleteSamplers(GLsizei n, const GLuint* samplers)
+{
+	glDeleteSamplers(n, samplers);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_DELETE_SAMPLERS);
+		PutNames(n, samplers);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DeleteShader(GLuint shader)
+{
+	glDeleteShader(shader);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DELETE_SHADER, { shader });
+	}
+}
+
+void GLTraceManager::DeleteTextures(GLsizei n, const GLuint* textures)
+{
+	glDeleteTextures(n, textures);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_DELETE_TEXTURES);
+		PutNames(n, textures);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+	glDeleteVertexArrays(n, arrays);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_DELETE_VERTEX_ARRAYS);
+		PutNames(n, arrays);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DepthFunc(GLenum func)
+{
+	glDepthFunc(func);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DEPTH_FUNC, { func });
+	}
+}
+
+void GLTraceManager::DepthMask(GLboolean flag)
+{
+	glDepthMask(flag);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DEPTH_MASK, { flag });
+	}
+}
+
+void GLTraceManager::DetachShader(GLuint program, GLuint shader)
+{
+	glDetachShader(program, shader);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DETACH_SHADER, { program, shader });
+	}
+}
+
+void GLTraceManager::Disable(GLenum cap)
+{
+	glDisable(cap);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DISABLE, { cap });
+	}
+}
+
+void GLTraceManager::DisableVertexAttribArray(GLuint index)
+{
+	glDisableVertexAttribArray(index);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DISABLE_VERTEX_ATTRIB_ARRAY, { index });
+	}
+}
+
+void GLTraceManager::DispatchCompute(GLuint groupsX, GLuint groupsY, GLuint groupsZ)
+{
+	glDispatchCompute(groupsX, groupsY, groupsZ);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DISPATCH_COMPUTE, { groupsX, groupsY, groupsZ });
+	}
+}
+
+void GLTraceManager::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+	glDrawArrays(mode, first, count);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DRAW_ARRAYS, { mode, (unsigned int)first, (unsigned int)count });
+	}
+}
+
+void GLTraceManager::DrawArraysIndirect(GLenum mode, const void* indirect)
+{
+	glDrawArraysIndirect(mode, indirect);
+	if (g_bCapturing)
+	{
+		// the commands are read from the bound indirect buffer
+		BeginCommand(TRACE_DRAW_ARRAYS_INDIRECT);
+		PutWord(mode);
+		PutLong((unsigned long long)(size_t)indirect);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+{
+	glDrawArraysInstanced(mode, first, count, instanceCount);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_DRAW_ARRAYS_INSTANCED,
+			{ mode, (unsigned int)first, (unsigned int)count, (unsigned int)instanceCount });
+	}
+}
+
+void GLTraceManager::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+	glDrawElements(mode, count, type, indices);
+	if (g_bCapturing)
+	{
+		// the core profile reads indices from the bound element
+		// buffer, so the pointer is an offset
+		BeginCommand(TRACE_DRAW_ELEMENTS);
+		PutWord(mode);
+		PutWord((unsigned int)count);
+		PutWord(type);
+		PutLong((unsigned long long)(size_t)indices);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::DrawElementsInstanced(
+	GLenum mode,
+	GLsizei count,
+	GLenum type,
+	const void* indices,
+	GLsizei instanceCount)
+{
+	glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_DRAW_ELEMENTS_INSTANCED);
+		PutWord(mode);
+		PutWord((unsigned int)count);
+		PutWord(type);
+		PutLong((unsigned long long)(size_t)indices);
+		PutWord((unsigned int)instanceCount);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Enable(GLenum cap)
+{
+	glEnable(cap);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_ENABLE, { cap });
+	}
+}
+
+void GLTraceManager::EnableVertexAttribArray(GLuint index)
+{
+	glEnableVertexAttribArray(index);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_ENABLE_VERTEX_ATTRIB_ARRAY, { index });
+	}
+}
+
+void GLTraceManager::EndConditionalRender()
+{
+	glEndConditionalRender();
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_END_CONDITIONAL_RENDER, {});
+	}
+}
+
+void GLTraceManager::EndQuery(GLenum target)
+{
+	glEndQuery(target);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_END_QUERY, { target });
+	}
+}
+
+void GLTraceManager::Finish()
+{
+	glFinish();
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_FINISH, {});
+	}
+}
+
+void GLTraceManager::Flush()
+{
+	glFlush();
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_FLUSH, {});
+	}
+}
+
+void GLTraceManager::FramebufferRenderbuffer(
+	GLenum target,
+	GLenum attachment,
+	GLenum renderbufferTarget,
+	GLuint renderbuffer)
+{
+	glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_FRAMEBUFFER_RENDERBUFFER, { target, attachment, renderbufferTarget, renderbuffer });
+	}
+}
+
+void GLTraceManager::FramebufferTexture2D(
+	GLenum target,
+	GLenum attachment,
+	GLenum textureTarget,
+	GLuint texture,
+	GLint level)
+{
+	glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_FRAMEBUFFER_TEXTURE_2D, { target, attachment, textureTarget, texture, (unsigned int)level });
+	}
+}
+
+void GLTraceManager::GenBuffers(GLsizei n, GLuint* buffers)
+{
+	glGenBuffers(n, buffers);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_GEN_BUFFERS);
+		PutNames(n, buffers);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::GenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+	glGenFramebuffers(n, framebuffers);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_GEN_FRAMEBUFFERS);
+		PutNames(n, framebuffers);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::GenQueries(GLsizei n, GLuint* ids)
+{
+	glGenQueries(n, ids);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_GEN_QUERIES);
+		PutNames(n, ids);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::GenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+{
+	glGenRenderbuffers(n, renderbuffers);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_GEN_RENDERBUFFERS);
+		PutNames(n, renderbuffers);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::GenSamplers(GLsizei n, GLuint* samplers)
+{
+	glGenSamplers(n, samplers);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_GEN_SAMPLERS);
+		PutNames(n, samplers);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::GenTextures(GLsizei n, GLuint* textures)
+{
+	glGenTextures(n, textures);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_GEN_TEXTURES);
+		PutNames(n, textures);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::GenVertexArrays(GLsizei n, GLuint* arrays)
+{
+	glGenVertexArrays(n, arrays);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_GEN_VERTEX_ARRAYS);
+		PutNames(n, arrays);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::GenerateMipmap(GLenum target)
+{
+	glGenerateMipmap(target);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_GENERATE_MIPMAP, { target });
+	}
+}
+
+GLint GLTraceManager::GetUniformLocation(GLuint program, const GLchar* name)
+{
+	GLint location = glGetUniformLocation(program, name);
+	if (g_bCapturing)
+	{
+		// the replay finds its own location by the same name
+		BeginCommand(TRACE_GET_UNIFORM_LOCATION);
+		PutWord(program);
+		PutWord((unsigned int)location);
+		PutData(name, strlen(name));
+		EndCommand();
+	}
+	return(location);
+}
+
+void GLTraceManager::LinkProgram(GLuint program)
+{
+	glLinkProgram(program);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_LINK_PROGRAM, { program });
+	}
+}
+
+void* GLTraceManager::MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+	void* pData = glMapBufferRange(target, offset, length, access);
+	if (NULL != pData)
+	{
+		MAPPED_RANGE range;
+		range.pData = pData;
+		range.length = length;
+		range.access = access;
+		g_MappedRanges[target] = range;
+	}
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_MAP_BUFFER_RANGE);
+		PutWord(target);
+		PutLong((unsigned long long)offset);
+		PutLong((unsigned long long)length);
+		PutWord(access);
+		EndCommand();
+	}
+	return(pData);
+}
+
+void GLTraceManager::IssueMemoryBarrier(GLbitfield barriers)
+{
+	glMemoryBarrier(barriers);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_MEMORY_BARRIER, { barriers });
+	}
+}
+
+void GLTraceManager::PixelStorei(GLenum pname, GLint param)
+{
+	glPixelStorei(pname, param);
+	switch (pname)
+	{
+	case GL_UNPACK_ALIGNMENT:
+		g_UnpackAlignment = param;
+		break;
+	case GL_UNPACK_ROW_LENGTH:
+		g_UnpackRowLength = param;
+		break;
+	case GL_PACK_ALIGNMENT:
+		g_PackAlignment = param;
+		break;
+	case GL_PACK_ROW_LENGTH:
+		g_PackRowLength = param;
+		break;
+	default:
+		break;
+	}
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_PIXEL_STORE, { pname, (unsigned int)param });
+	}
+}
+
+void GLTraceManager::PolygonMode(GLenum face, GLenum mode)
+{
+	glPolygonMode(face, mode);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_POLYGON_MODE, { face, mode });
+	}
+}
+
+void GLTraceManager::QueryCounter(GLuint id, GLenum target)
+{
+	glQueryCounter(id, target);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_QUERY_COUNTER, { id, target });
+	}
+}
+
+void GLTraceManager::ReadPixels(
+	GLint x,
+	GLint y,
+	GLsizei width,
+	GLsizei height,
+	GLenum format,
+	GLenum type,
+	void* pixels)
+{
+	glReadPixels(x, y, width, height, format, type, pixels);
+	if (g_bCapturing)
+	{
+		// what is read back is not needed, only where it goes
+		// and how much there is
+		BeginCommand(TRACE_READ_PIXELS);
+		PutWord((unsigned int)x);
+		PutWord((unsigned int)y);
+		PutWord((unsigned int)width);
+		PutWord((unsigned int)height);
+		PutWord(format);
+		PutWord(type);
+		PutWord((g_PackBuffer != 0) ? 1 : 0);
+		PutLong((g_PackBuffer != 0) ? (unsigned long long)(size_t)pixels :
+			(unsigned long long)GetImageBytes(width, height, format, type, g_PackAlignment, g_PackRowLength));
+		EndCommand();
+	}
+}
+
+void GLTraceManager::RenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+	glRenderbufferStorage(target, internalFormat, width, height);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_RENDERBUFFER_STORAGE, { target, internalFormat, (unsigned int)width, (unsigned int)height });
+	}
+}
+
+void GLTraceManager::SamplerParameterf(GLuint sampler, GLenum pname, GLfloat param)
+{
+	glSamplerParameterf(sampler, pname, param);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_SAMPLER_PARAMETER_F);
+		PutWord(sampler);
+		PutWord(pname);
+		PutFloat(param);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::SamplerParameteri(GLuint sampler, GLenum pname, GLint param)
+{
+	glSamplerParameteri(sampler, pname, param);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_SAMPLER_PARAMETER_I, { sampler, pname, (unsigned int)param });
+	}
+}
+
+void GLTraceManager::ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+	glShaderSource(shader, count, strings, lengths);
+	if (g_bCapturing)
+	{
+		// the pieces are joined into one source
+		std::string source;
+		for (GLsizei i = 0; i < count; i++)
+		{
+			if ((NULL != lengths) && (lengths[i] >= 0))
+			{
+				source.append(strings[i], lengths[i]);
+			}
+			else
+			{
+				source.append(strings[i]);
+			}
+		}
+		BeginCommand(TRACE_SHADER_SOURCE);
+		PutWord(shader);
+		PutData(source.data(), source.size());
+		EndCommand();
+	}
+}
+
+void GLTraceManager::TexImage2D(
+	GLenum target,
+	GLint level,
+	GLint internalFormat,
+	GLsizei width,
+	GLsizei height,
+	GLint border,
+	GLenum format,
+	GLenum type,
+	const void* pixels)
+{
+	glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_TEX_IMAGE_2D);
+		PutWord(target);
+		PutWord((unsigned int)level);
+		PutWord((unsigned int)internalFormat);
+		PutWord((unsigned int)width);
+		PutWord((unsigned int)height);
+		PutWord((unsigned int)border);
+		PutWord(format);
+		PutWord(type);
+		PutPixels(pixels, GetImageBytes(width, height, format, type, g_UnpackAlignment, g_UnpackRowLength),
+			g_UnpackBuffer != 0);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::TexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	glTexParameteri(target, pname, param);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_TEX_PARAMETER_I, { target, pname, (unsigned int)param });
+	}
+}
+
+void GLTraceManager::TexParameteriv(GLenum target, GLenum pname, const GLint* params)
+{
+	glTexParameteriv(target, pname, params);
+	if (g_bCapturing)
+	{
+		int valueCount = ((pname == GL_TEXTURE_SWIZZLE_RGBA) || (pname == GL_TEXTURE_BORDER_COLOR)) ? 4 : 1;
+		BeginCommand(TRACE_TEX_PARAMETER_IV);
+		PutWord(target);
+		PutWord(pname);
+		PutWord((unsigned int)valueCount);
+		for (int i = 0; i < valueCount; i++)
+		{
+			PutWord((unsigned int)params[i]);
+		}
+		EndCommand();
+	}
+}
+
+void GLTraceManager::TexStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+	glTexStorage2D(target, levels, internalFormat, width, height);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_TEX_STORAGE_2D,
+			{ target, (unsigned int)levels, internalFormat, (unsigned int)width, (unsigned int)height });
+	}
+}
+
+void GLTraceManager::TexSubImage2D(
+	GLenum target,
+	GLint level,
+	GLint xoffset,
+	GLint yoffset,
+	GLsizei width,
+	GLsizei height,
+	GLenum format,
+	GLenum type,
+	const void* pixels)
+{
+	glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_TEX_SUB_IMAGE_2D);
+		PutWord(target);
+		PutWord((unsigned int)level);
+		PutWord((unsigned int)xoffset);
+		PutWord((unsigned int)yoffset);
+		PutWord((unsigned int)width);
+		PutWord((unsigned int)height);
+		PutWord(format);
+		PutWord(type);
+		PutPixels(pixels, GetImageBytes(width, height, format, type, g_UnpackAlignment, g_UnpackRowLength),
+			g_UnpackBuffer != 0);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Uniform1f(GLint location, GLfloat v0)
+{
+	glUniform1f(location, v0);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_F);
+		PutWord((unsigned int)location);
+		PutWord(1);
+		PutFloat(v0);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Uniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+	glUniform2f(location, v0, v1);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_F);
+		PutWord((unsigned int)location);
+		PutWord(2);
+		PutFloat(v0);
+		PutFloat(v1);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+	glUniform3f(location, v0, v1, v2);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_F);
+		PutWord((unsigned int)location);
+		PutWord(3);
+		PutFloat(v0);
+		PutFloat(v1);
+		PutFloat(v2);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+	glUniform4f(location, v0, v1, v2, v3);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_F);
+		PutWord((unsigned int)location);
+		PutWord(4);
+		PutFloat(v0);
+		PutFloat(v1);
+		PutFloat(v2);
+		PutFloat(v3);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Uniform2fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	glUniform2fv(location, count, value);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_FV);
+		PutWord((unsigned int)location);
+		PutWord(2);
+		PutWord((unsigned int)count);
+		PutUniformValues(value, (size_t)count * 2);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Uniform3fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	glUniform3fv(location, count, value);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_FV);
+		PutWord((unsigned int)location);
+		PutWord(3);
+		PutWord((unsigned int)count);
+		PutUniformValues(value, (size_t)count * 3);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Uniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+	glUniform4fv(location, count, value);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_FV);
+		PutWord((unsigned int)location);
+		PutWord(4);
+		PutWord((unsigned int)count);
+		PutUniformValues(value, (size_t)count * 4);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Uniform1i(GLint location, GLint v0)
+{
+	glUniform1i(location, v0);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_UNIFORM_I, { (unsigned int)location, (unsigned int)v0 });
+	}
+}
+
+void GLTraceManager::Uniform1ui(GLint location, GLuint v0)
+{
+	glUniform1ui(location, v0);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_UNIFORM_UI, { (unsigned int)location, v0 });
+	}
+}
+
+void GLTraceManager::UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	glUniformMatrix3fv(location, count, transpose, value);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_MATRIX);
+		PutWord((unsigned int)location);
+		PutWord(3);
+		PutWord((unsigned int)count);
+		PutWord(transpose);
+		PutUniformValues(value, (size_t)count * 9);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	glUniformMatrix4fv(location, count, transpose, value);
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNIFORM_MATRIX);
+		PutWord((unsigned int)location);
+		PutWord(4);
+		PutWord((unsigned int)count);
+		PutWord(transpose);
+		PutUniformValues(value, (size_t)count * 16);
+		EndCommand();
+	}
+}
+
+GLboolean GLTraceManager::UnmapBuffer(GLenum target)
+{
+	// what was written into the range is taken before it goes
+	if (g_bCapturing)
+	{
+		BeginCommand(TRACE_UNMAP_BUFFER);
+		PutWord(target);
+		std::map<GLenum, MAPPED_RANGE>::iterator found = g_MappedRanges.find(target);
+		if ((found != g_MappedRanges.end()) && (found->second.access & GL_MAP_WRITE_BIT))
+		{
+			PutData(found->second.pData, (size_t)found->second.length);
+		}
+		else
+		{
+			PutData(NULL, 0);
+		}
+		EndCommand();
+	}
+	g_MappedRanges.erase(target);
+
+	return(glUnmapBuffer(target));
+}
+
+void GLTraceManager::UseProgram(GLuint program)
+{
+	glUseProgram(program);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_USE_PROGRAM, { program });
+	}
+}
+
+void GLTraceManager::VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	glVertexAttribDivisor(index, divisor);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_VERTEX_ATTRIB_DIVISOR, { index, divisor });
+	}
+}
+
+void GLTraceManager::VertexAttribPointer(
+	GLuint index,
+	GLint size,
+	GLenum type,
+	GLboolean normalized,
+	GLsizei stride,
+	const void* pointer)
+{
+	glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+	if (g_bCapturing)
+	{
+		// vertex data comes from the bound array buffer
+		BeginCommand(TRACE_VERTEX_ATTRIB_POINTER);
+		PutWord(index);
+		PutWord((unsigned int)size);
+		PutWord(type);
+		PutWord(normalized);
+		PutWord((unsigned int)stride);
+		PutLong((unsigned long long)(size_t)pointer);
+		EndCommand();
+	}
+}
+
+void GLTraceManager::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	glViewport(x, y, width, height);
+	if (g_bCapturing)
+	{
+		WriteWords(TRACE_VIEWPORT, { (unsigned int)x, (unsigned int)y, (unsigned int)width, (unsigned int)height });
+	}
+}
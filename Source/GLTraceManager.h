@@ -0,0 +1,312 @@
+///////////////////////////////////////////////////////////////////////////////
+// gltracemanager.h
+// ============
+// capture the OpenGL calls of the renderer - command stream for replay
+//
+//  Every OpenGL call that changes what is drawn goes through a traced
+//  entry point, brought in by the macros of GLTrace.h, which the project
+//  includes ahead of every source file.  While a capture runs, each call
+//  is written to a file with its arguments, and with the data it hands to
+//  OpenGL, such as buffer and texture contents and shader sources, so the
+//  stream can be replayed without the scene, the textures or the shaders
+//  on disk.  Calls that only read state back are not written, since the
+//  calls made from what they returned are.  The capture starts with the
+//  context, so every object the frames use is made inside it.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  GLTraceManager
+ *
+ *  This class contains the code for writing the OpenGL calls
+ *  to a trace file.  There is one OpenGL context, so
+ *  everything is static.
+ ***********************************************************/
+class GLTraceManager
+{
+public:
+	// commands of the trace file, by the number written, so
+	// new commands are only added before the count
+	enum TRACE_COMMAND
+	{
+		TRACE_FRAME_END,
+		TRACE_ACTIVE_TEXTURE,
+		TRACE_ATTACH_SHADER,
+		TRACE_BEGIN_CONDITIONAL_RENDER,
+		TRACE_BEGIN_QUERY,
+		TRACE_BIND_BUFFER,
+		TRACE_BIND_BUFFER_BASE,
+		TRACE_BIND_FRAMEBUFFER,
+		TRACE_BIND_IMAGE_TEXTURE,
+		TRACE_BIND_RENDERBUFFER,
+		TRACE_BIND_SAMPLER,
+		TRACE_BIND_TEXTURE,
+		TRACE_BIND_VERTEX_ARRAY,
+		TRACE_BLEND_FUNC,
+		TRACE_BUFFER_DATA,
+		TRACE_BUFFER_SUB_DATA,
+		TRACE_CLEAR,
+		TRACE_CLEAR_COLOR,
+		TRACE_COLOR_MASK,
+		TRACE_COMPILE_SHADER,
+		TRACE_COPY_BUFFER_SUB_DATA,
+		TRACE_CREATE_PROGRAM,
+		TRACE_CREATE_SHADER,
+		TRACE_CULL_FACE,
+		TRACE_DELETE_BUFFERS,
+		TRACE_DELETE_FRAMEBUFFERS,
+		TRACE_DELETE_PROGRAM,
+		TRACE_DELETE_QUERIES,
+		TRACE_DELETE_RENDERBUFFERS,
+		TRACE_DELETE_SAMPLERS,
+		TRACE_DELETE_SHADER,
+		TRACE_DELETE_TEXTURES,
+		TRACE_DELETE_VERTEX_ARRAYS,
+		TRACE_DEPTH_FUNC,
+		TRACE_DEPTH_MASK,
+		TRACE_DETACH_SHADER,
+		TRACE_DISABLE,
+		TRACE_DISABLE_VERTEX_ATTRIB_ARRAY,
+		TRACE_DISPATCH_COMPUTE,
+		TRACE_DRAW_ARRAYS,
+		TRACE_DRAW_ARRAYS_INDIRECT,
+		TRACE_DRAW_ARRAYS_INSTANCED,
+		TRACE_DRAW_ELEMENTS,
+		TRACE_DRAW_ELEMENTS_INSTANCED,
+		TRACE_ENABLE,
+		TRACE_ENABLE_VERTEX_ATTRIB_ARRAY,
+		TRACE_END_CONDITIONAL_RENDER,
+		TRACE_END_QUERY,
+		TRACE_FINISH,
+		TRACE_FLUSH,
+		TRACE_FRAMEBUFFER_RENDERBUFFER,
+		TRACE_FRAMEBUFFER_TEXTURE_2D,
+		TRACE_GEN_BUFFERS,
+		TRACE_GEN_FRAMEBUFFERS,
+		TRACE_GEN_QUERIES,
+		TRACE_GEN_RENDERBUFFERS,
+		TRACE_GEN_SAMPLERS,
+		TRACE_GEN_TEXTURES,
+		TRACE_GEN_VERTEX_ARRAYS,
+		TRACE_GENERATE_MIPMAP,
+		TRACE_GET_UNIFORM_LOCATION,
+		TRACE_LINK_PROGRAM,
+		TRACE_MAP_BUFFER_RANGE,
+		TRACE_MEMORY_BARRIER,
+		TRACE_PIXEL_STORE,
+		TRACE_POLYGON_MODE,
+		TRACE_QUERY_COUNTER,
+		TRACE_READ_PIXELS,
+		TRACE_RENDERBUFFER_STORAGE,
+		TRACE_SAMPLER_PARAMETER_F,
+		TRACE_SAMPLER_PARAMETER_I,
+		TRACE_SHADER_SOURCE,
+		TRACE_TEX_IMAGE_2D,
+		TRACE_TEX_PARAMETER_I,
+		TRACE_TEX_PARAMETER_IV,
+		TRACE_TEX_STORAGE_2D,
+		TRACE_TEX_SUB_IMAGE_2D,
+		TRACE_UNIFORM_F,
+		TRACE_UNIFORM_FV,
+		TRACE_UNIFORM_I,
+		TRACE_UNIFORM_UI,
+		TRACE_UNIFORM_MATRIX,
+		TRACE_UNMAP_BUFFER,
+		TRACE_USE_PROGRAM,
+		TRACE_VERTEX_ATTRIB_DIVISOR,
+		TRACE_VERTEX_ATTRIB_POINTER,
+		TRACE_VIEWPORT,
+		TRACE_COMMAND_COUNT
+	};
+
+	// start of a trace file, followed by its commands, each a 16
+	// bit command number, a 32 bit size and that many bytes
+	struct FILE_HEADER
+	{
+		unsigned int magic;
+		unsigned int version;
+		int width;
+		int height;
+		int frameCount;
+		unsigned int commandCount;
+	};
+	static const unsigned int FILE_MAGIC = 0x52544C47;
+	static const unsigned int FILE_VERSION = 1;
+
+	// start writing the calls to a file, for a number of frames
+	// drawn into a default frame of a size, once OpenGL is ready
+	static bool StartCapture(const char* filename, int frameCount, int width, int height);
+	static bool IsCapturing();
+	// mark the end of a frame, and stop after the last one
+	static void EndFrame();
+	// finish the file, when the frames were not all drawn
+	static void StopCapture();
+
+	// name of a command, for the replay report
+	static const char* GetCommandName(int command);
+	// bytes of an image of a size and format, with the rows
+	// padded to an alignment
+	static size_t GetImageBytes(
+		GLsizei width,
+		GLsizei height,
+		GLenum format,
+		GLenum type,
+		GLint alignment,
+		GLint rowLength);
+
+	// the traced entry points, called in place of the OpenGL
+	// functions of the same name
+	static void ActiveTexture(GLenum texture);
+	static void AttachShader(GLuint program, GLuint shader);
+	static void BeginConditionalRender(GLuint id, GLenum mode);
+	static void BeginQuery(GLenum target, GLuint id);
+	static void BindBuffer(GLenum target, GLuint buffer);
+	static void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	static void BindFramebuffer(GLenum target, GLuint framebuffer);
+	static void BindImageTexture(
+		GLuint unit,
+		GLuint texture,
+		GLint level,
+		GLboolean layered,
+		GLint layer,
+		GLenum access,
+		GLenum format);
+	static void BindRenderbuffer(GLenum target, GLuint renderbuffer);
+	static void BindSampler(GLuint unit, GLuint sampler);
+	static void BindTexture(GLenum target, GLuint texture);
+	static void BindVertexArray(GLuint array);
+	static void BlendFunc(GLenum sfactor, GLenum dfactor);
+	static void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+	static void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+	static void Clear(GLbitfield mask);
+	static void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+	static void ColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
+	static void CompileShader(GLuint shader);
+	static void CopyBufferSubData(
+		GLenum readTarget,
+		GLenum writeTarget,
+		GLintptr readOffset,
+		GLintptr writeOffset,
+		GLsizeiptr size);
+	static GLuint CreateProgram();
+	static GLuint CreateShader(GLenum type);
+	static void CullFace(GLenum mode);
+	static void DeleteBuffers(GLsizei n, const GLuint* buffers);
+	static void DeleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+	static void DeleteProgram(GLuint program);
+	static void DeleteQueries(GLsizei n, const GLuint* ids);
+	static void DeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers);
+	static void DeleteSamplers(GLsizei n, const GLuint* samplers);
+	static void DeleteShader(GLuint shader);
+	static void DeleteTextures(GLsizei n, const GLuint* textures);
+	static void DeleteVertexArrays(GLsizei n, const GLuint* arrays);
+	static void DepthFunc(GLenum func);
+	static void DepthMask(GLboolean flag);
+	static void DetachShader(GLuint program, GLuint shader);
+	static void Disable(GLenum cap);
+	static void DisableVertexAttribArray(GLuint index);
+	static void DispatchCompute(GLuint groupsX, GLuint groupsY, GLuint groupsZ);
+	static void DrawArrays(GLenum mode, GLint first, GLsizei count);
+	static void DrawArraysIndirect(GLenum mode, const void* indirect);
+	static void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount);
+	static void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+	static void DrawElementsInstanced(
+		GLenum mode,
+		GLsizei count,
+		GLenum type,
+		const void* indices,
+		GLsizei instanceCount);
+	static void Enable(GLenum cap);
+	static void EnableVertexAttribArray(GLuint index);
+	static void EndConditionalRender();
+	static void EndQuery(GLenum target);
+	static void Finish();
+	static void Flush();
+	static void FramebufferRenderbuffer(
+		GLenum target,
+		GLenum attachment,
+		GLenum renderbufferTarget,
+		GLuint renderbuffer);
+	static void FramebufferTexture2D(
+		GLenum target,
+		GLenum attachment,
+		GLenum textureTarget,
+		GLuint texture,
+		GLint level);
+	static void GenBuffers(GLsizei n, GLuint* buffers);
+	static void GenFramebuffers(GLsizei n, GLuint* framebuffers);
+	static void GenQueries(GLsizei n, GLuint* ids);
+	static void GenRenderbuffers(GLsizei n, GLuint* renderbuffers);
+	static void GenSamplers(GLsizei n, GLuint* samplers);
+	static void GenTextures(GLsizei n, GLuint* textures);
+	static void GenVertexArrays(GLsizei n, GLuint* arrays);
+	static void GenerateMipmap(GLenum target);
+	static GLint GetUniformLocation(GLuint program, const GLchar* name);
+	static void LinkProgram(GLuint program);
+	static void* MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+	// named apart from the MemoryBarrier macro of the Windows headers
+	static void IssueMemoryBarrier(GLbitfield barriers);
+	static void PixelStorei(GLenum pname, GLint param);
+	static void PolygonMode(GLenum face, GLenum mode);
+	static void QueryCounter(GLuint id, GLenum target);
+	static void ReadPixels(
+		GLint x,
+		GLint y,
+		GLsizei width,
+		GLsizei height,
+		GLenum format,
+		GLenum type,
+		void* pixels);
+	static void RenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height);
+	static void SamplerParameterf(GLuint sampler, GLenum pname, GLfloat param);
+	static void SamplerParameteri(GLuint sampler, GLenum pname, GLint param);
+	static void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths);
+	static void TexImage2D(
+		GLenum target,
+		GLint level,
+		GLint internalFormat,
+		GLsizei width,
+		GLsizei height,
+		GLint border,
+		GLenum format,
+		GLenum type,
+		const void* pixels);
+	static void TexParameteri(GLenum target, GLenum pname, GLint param);
+	static void TexParameteriv(GLenum target, GLenum pname, const GLint* params);
+	static void TexStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height);
+	static void TexSubImage2D(
+		GLenum target,
+		GLint level,
+		GLint xoffset,
+		GLint yoffset,
+		GLsizei width,
+		GLsizei height,
+		GLenum format,
+		GLenum type,
+		const void* pixels);
+	static void Uniform1f(GLint location, GLfloat v0);
+	static void Uniform2f(GLint location, GLfloat v0, GLfloat v1);
+	static void Uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+	static void Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+	static void Uniform2fv(GLint location, GLsizei count, const GLfloat* value);
+	static void Uniform3fv(GLint location, GLsizei count, const GLfloat* value);
+	static void Uniform4fv(GLint location, GLsizei count, const GLfloat* value);
+	static void Uniform1i(GLint location, GLint v0);
+	static void Uniform1ui(GLint location, GLuint v0);
+	static void UniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+	static void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+	static GLboolean UnmapBuffer(GLenum target);
+	static void UseProgram(GLuint program);
+	static void VertexAttribDivisor(GLuint index, GLuint divisor);
+	static void VertexAttribPointer(
+		GLuint index,
+		GLint size,
+		GLenum type,
+		GLboolean normalized,
+		GLsizei stride,
+		const void* pointer);
+	static void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+};
@@ -0,0 +1,1387 @@
+///////////////////////////////////////////////////////////////////////////////
+// gltracereplayer.cpp
+// ============
+// replay a captured OpenGL command stream - headless timing and bisecting
+//
+//  This file is built with GL_TRACE_REAL_CALLS, so the replayed calls go
+//  straight to OpenGL.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLTraceReplayer.h"
+
+#include "GLFW/glfw3.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// context versions tried for the replay, newest first
+	const int g_ContextVersions[][2] = { { 4, 6 }, { 4, 5 }, { 4, 3 }, { 3, 3 } };
+	const int g_ContextVersionCount = 4;
+
+	// lines of the slowest frames and calls in the report
+	const int g_SlowestFrameCount = 5;
+
+	// whether the context has the entry point a command calls,
+	// which the calls newer than OpenGL 3.3 may not
+	bool HasEntryPoint(int command)
+	{
+		switch (command)
+		{
+		case GLTraceManager::TRACE_BIND_IMAGE_TEXTURE:
+			return(NULL != glBindImageTexture);
+		case GLTraceManager::TRACE_DISPATCH_COMPUTE:
+			return(NULL != glDispatchCompute);
+		case GLTraceManager::TRACE_DRAW_ARRAYS_INDIRECT:
+			return(NULL != glDrawArraysIndirect);
+		case GLTraceManager::TRACE_MEMORY_BARRIER:
+			return(NULL != glMemoryBarrier);
+		case GLTraceManager::TRACE_TEX_STORAGE_2D:
+			return(NULL != glTexStorage2D);
+		default:
+			return(true);
+		}
+	}
+	const int g_SlowestCallCount = 20;
+
+	bool IsDraw(int command)
+	{
+		switch (command)
+		{
+		case GLTraceManager::TRACE_DRAW_ARRAYS:
+		case GLTraceManager::TRACE_DRAW_ARRAYS_INDIRECT:
+		case GLTraceManager::TRACE_DRAW_ARRAYS_INSTANCED:
+		case GLTraceManager::TRACE_DRAW_ELEMENTS:
+		case GLTraceManager::TRACE_DRAW_ELEMENTS_INSTANCED:
+			return(true);
+		default:
+			return(false);
+		}
+	}
+
+	// the calls that give the GPU work of their own, which are
+	// timed with a pair of timestamps
+	bool IsGPUTimed(int command)
+	{
+		switch (command)
+		{
+		case GLTraceManager::TRACE_CLEAR:
+		case GLTraceManager::TRACE_COPY_BUFFER_SUB_DATA:
+		case GLTraceManager::TRACE_DISPATCH_COMPUTE:
+		case GLTraceManager::TRACE_GENERATE_MIPMAP:
+		case GLTraceManager::TRACE_READ_PIXELS:
+			return(true);
+		default:
+			return(IsDraw(command));
+		}
+	}
+
+	// the slower of the CPU and GPU time of a call
+	double GetCallMicroseconds(double cpuMicroseconds, double gpuMicroseconds)
+	{
+		return(std::max(cpuMicroseconds, gpuMicroseconds));
+	}
+}
+
+/***********************************************************
+ *  GLTraceReplayer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLTraceReplayer::GLTraceReplayer()
+{
+	m_pWindow = NULL;
+	memset(&m_header, 0, sizeof(m_header));
+	m_readOffset = 0;
+	m_bPayloadShort = false;
+	m_currentProgram = 0;
+	m_frameQueries[0] = 0;
+	m_frameQueries[1] = 0;
+}
+
+/***********************************************************
+ *  ~GLTraceReplayer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLTraceReplayer::~GLTraceReplayer()
+{
+	Release();
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running the calls of a trace
+ *  file frame by frame, timing the frames asked for, and
+ *  reporting what they cost.
+ ***********************************************************/
+int GLTraceReplayer::Run(const std::string& filename, int firstFrame, int lastFrame, const std::string& csvFilename)
+{
+	m_file.open(filename.c_str(), std::ios::binary);
+	if (!m_file.is_open())
+	{
+		std::cout << "Could not open the GL trace file " << filename << std::endl;
+		return(1);
+	}
+	m_file.read((char*)&m_header, sizeof(m_header));
+	if (!m_file.good() || (m_header.magic != GLTraceManager::FILE_MAGIC))
+	{
+		std::cout << filename << " is not a GL trace file" << std::endl;
+		return(1);
+	}
+	if (m_header.version != GLTraceManager::FILE_VERSION)
+	{
+		std::cout << "GL trace file " << filename << " has version " << m_header.version
+			<< ", the replayer reads version " << GLTraceManager::FILE_VERSION << std::endl;
+		return(1);
+	}
+	if ((lastFrame < 0) || (lastFrame >= m_header.frameCount))
+	{
+		lastFrame = m_header.frameCount - 1;
+	}
+	firstFrame = std::max(firstFrame, 0);
+	if (firstFrame > lastFrame)
+	{
+		std::cout << "GL trace file " << filename << " has no frames from " << firstFrame << std::endl;
+		return(1);
+	}
+
+	if (!CreateReplayWindow())
+	{
+		return(1);
+	}
+	std::cout << "INFO: Replaying " << filename << ", " << m_header.frameCount << " frames of "
+		<< m_header.width << "x" << m_header.height << ", timing frames " << firstFrame << " to "
+		<< lastFrame << std::endl;
+
+	COMMAND_COST noCost = { 0, 0.0, 0, 0.0 };
+	m_commandCosts.assign(GLTraceManager::TRACE_COMMAND_COUNT, noCost);
+	FindAvailableCommands();
+	glGenQueries(2, m_frameQueries);
+
+	int frame = 0;
+	bool bFrameStarted = false;
+	FRAME_COST frameCost = { 0, 0, 0, 0.0, 0.0, false };
+	std::chrono::steady_clock::time_point frameStart;
+	unsigned short command = 0;
+	unsigned int size = 0;
+	while (frame <= lastFrame)
+	{
+		m_file.read((char*)&command, sizeof(command));
+		m_file.read((char*)&size, sizeof(size));
+		m_payload.resize(size);
+		if (size > 0)
+		{
+			m_file.read((char*)m_payload.data(), size);
+		}
+		if (!m_file.good() || (command >= GLTraceManager::TRACE_COMMAND_COUNT))
+		{
+			std::cout << "GL trace file " << filename << " ends inside frame " << frame << std::endl;
+			break;
+		}
+		m_readOffset = 0;
+		m_bPayloadShort = false;
+
+		bool bTimed = (frame >= firstFrame);
+		if (bTimed && !bFrameStarted)
+		{
+			bFrameStarted = true;
+			frameCost.frame = frame;
+			frameCost.calls = 0;
+			frameCost.draws = 0;
+			frameCost.cpuMilliseconds = 0.0;
+			frameCost.gpuMilliseconds = 0.0;
+			frameCost.bError = false;
+			m_frameCalls.clear();
+			m_gpuTimings.clear();
+			glQueryCounter(m_frameQueries[0], GL_TIMESTAMP);
+			frameStart = std::chrono::steady_clock::now();
+		}
+
+		if (command == GLTraceManager::TRACE_FRAME_END)
+		{
+			if (bTimed)
+			{
+				glQueryCounter(m_frameQueries[1], GL_TIMESTAMP);
+				std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - frameStart;
+				frameCost.cpuMilliseconds = cpuTime.count();
+			}
+			glfwSwapBuffers(m_pWindow);
+			glfwPollEvents();
+			if (bTimed)
+			{
+				while (glGetError() != GL_NO_ERROR)
+				{
+					frameCost.bError = true;
+				}
+				ReadGPUTimes(frameCost);
+				m_frameCosts.push_back(frameCost);
+				bFrameStarted = false;
+			}
+			frame++;
+			continue;
+		}
+
+		// a call the context cannot make would crash the replay
+		if (!m_commandAvailable[command])
+		{
+			m_skippedCalls[command]++;
+			continue;
+		}
+
+		if (!bTimed)
+		{
+			Execute(command);
+			continue;
+		}
+
+		// time the call, with timestamps on both sides when it
+		// gives the GPU work
+		bool bGPUTimed = IsGPUTimed(command);
+		if (bGPUTimed)
+		{
+			size_t queryCount = (m_gpuTimings.size() + 1) * 2;
+			if (m_timerQueries.size() < queryCount)
+			{
+				size_t oldCount = m_timerQueries.size();
+				m_timerQueries.resize(std::max(queryCount, oldCount * 2));
+				glGenQueries((GLsizei)(m_timerQueries.size() - oldCount), m_timerQueries.data() + oldCount);
+			}
+			GPU_TIMING timing;
+			timing.call = (int)m_frameCalls.size();
+			timing.command = command;
+			timing.query = (int)m_gpuTimings.size() * 2;
+			m_gpuTimings.push_back(timing);
+			glQueryCounter(m_timerQueries[timing.query], GL_TIMESTAMP);
+		}
+		std::chrono::steady_clock::time_point callStart = std::chrono::steady_clock::now();
+		Execute(command);
+		std::chrono::duration<double, std::micro> callTime = std::chrono::steady_clock::now() - callStart;
+		if (bGPUTimed)
+		{
+			glQueryCounter(m_timerQueries[m_gpuTimings.back().query + 1], GL_TIMESTAMP);
+		}
+
+		CALL_COST call;
+		call.frame = frame;
+		call.call = frameCost.calls;
+		call.command = command;
+		call.cpuMicroseconds = callTime.count();
+		call.gpuMicroseconds = 0.0;
+		m_frameCalls.push_back(call);
+		m_commandCosts[command].calls++;
+		m_commandCosts[command].cpuMicroseconds += call.cpuMicroseconds;
+		frameCost.calls++;
+		if (IsDraw(command))
+		{
+			frameCost.draws++;
+		}
+	}
+
+	Report(csvFilename);
+	Release();
+	return(m_frameCosts.empty() ? 1 : 0);
+}
+
+/***********************************************************
+ *  CreateReplayWindow()
+ *
+ *  This method is used for opening a hidden window of the
+ *  size of the captured frames, with the newest OpenGL
+ *  context it can get.
+ ***********************************************************/
+bool GLTraceReplayer::CreateReplayWindow()
+{
+	if (glfwInit() == GLFW_FALSE)
+	{
+		std::cout << "Failed to initialize GLFW for the GL trace replay" << std::endl;
+		return(false);
+	}
+
+	for (int i = 0; (i < g_ContextVersionCount) && (NULL == m_pWindow); i++)
+	{
+		glfwDefaultWindowHints();
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, g_ContextVersions[i][0]);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, g_ContextVersions[i][1]);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+		glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		m_pWindow = glfwCreateWindow(
+			std::max(m_header.width, 1), std::max(m_header.height, 1), "GL trace replay", NULL, NULL);
+	}
+	if (NULL == m_pWindow)
+	{
+		std::cout << "Failed to create an OpenGL context for the GL trace replay" << std::endl;
+		glfwTerminate();
+		return(false);
+	}
+	glfwMakeContextCurrent(m_pWindow);
+
+	GLenum result = glewInit();
+	if (GLEW_OK != result)
+	{
+		std::cout << glewGetErrorString(result) << std::endl;
+		return(false);
+	}
+	// the frames are replayed as fast as they go
+	glfwSwapInterval(0);
+	// clear the error glewInit leaves in core contexts
+	while (glGetError() != GL_NO_ERROR)
+	{
+	}
+
+	std::cout << "INFO: GL trace replay on " << (const char*)glGetString(GL_RENDERER) << ", OpenGL "
+		<< (const char*)glGetString(GL_VERSION) << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  FindAvailableCommands()
+ *
+ *  This method is used for finding the commands whose
+ *  entry points the replay context has.  A context older
+ *  than the one the trace was taken with lacks some of
+ *  them, such as compute before OpenGL 4.3.
+ ***********************************************************/
+void GLTraceReplayer::FindAvailableCommands()
+{
+	m_commandAvailable.assign(GLTraceManager::TRACE_COMMAND_COUNT, true);
+	m_skippedCalls.assign(GLTraceManager::TRACE_COMMAND_COUNT, 0);
+	for (int command = 0; command < GLTraceManager::TRACE_COMMAND_COUNT; command++)
+	{
+		if (!HasEntryPoint(command))
+		{
+			m_commandAvailable[command] = false;
+			std::cout << "INFO: The replay context has no " << GLTraceManager::GetCommandName(command)
+				<< ", its calls are skipped" << std::endl;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetWord(), GetInt(), GetFloat(), GetLong()
+ *
+ *  These methods are used for reading the arguments of the
+ *  command being run, in the order they were written.
+ ***********************************************************/
+unsigned int GLTraceReplayer::GetWord()
+{
+	unsigned int word = 0;
+	if (m_readOffset + sizeof(word) > m_payload.size())
+	{
+		m_bPayloadShort = true;
+		return(0);
+	}
+	memcpy(&word, m_payload.data() + m_readOffset, sizeof(word));
+	m_readOffset += sizeof(word);
+	return(word);
+}
+
+GLint GLTraceReplayer::GetInt()
+{
+	return((GLint)GetWord());
+}
+
+GLfloat GLTraceReplayer::GetFloat()
+{
+	unsigned int word = GetWord();
+	GLfloat value = 0.0f;
+	memcpy(&value, &word, sizeof(value));
+	return(value);
+}
+
+unsigned long long GLTraceReplayer::GetLong()
+{
+	unsigned long long low = GetWord();
+	unsigned long long high = GetWord();
+	return(low | (high << 32));
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method is used for reading data written with its
+ *  size in front.
+ ***********************************************************/
+const void* GLTraceReplayer::GetData(size_t& size)
+{
+	size = GetWord();
+	if ((size == 0) || (m_readOffset + size > m_payload.size()))
+	{
+		m_bPayloadShort = m_bPayloadShort || (size > 0);
+		size = 0;
+		return(NULL);
+	}
+	const void* pData = m_payload.data() + m_readOffset;
+	m_readOffset += size;
+	return(pData);
+}
+
+/***********************************************************
+ *  GetPixels()
+ *
+ *  This method is used for reading the pixels of a texture
+ *  call, which are data, or an offset into the bound pixel
+ *  buffer.
+ ***********************************************************/
+const void* GLTraceReplayer::GetPixels()
+{
+	if (GetWord() != 0)
+	{
+		return((const void*)(size_t)GetLong());
+	}
+	size_t size = 0;
+	return(GetData(size));
+}
+
+/***********************************************************
+ *  MapName()
+ *
+ *  This method is used for finding the name made on replay
+ *  for a name in the trace.  Zero, and names made before
+ *  the capture, are passed as they are.
+ ***********************************************************/
+GLuint GLTraceReplayer::MapName(const std::map<GLuint, GLuint>& names, GLuint name)
+{
+	std::map<GLuint, GLuint>::const_iterator found = names.find(name);
+	if (found == names.end())
+	{
+		return(name);
+	}
+	return(found->second);
+}
+
+/***********************************************************
+ *  MapLocation()
+ *
+ *  This method is used for finding the uniform location on
+ *  replay for a location in the trace, in the program in
+ *  use.
+ ***********************************************************/
+GLint GLTraceReplayer::MapLocation(GLint location)
+{
+	if (location < 0)
+	{
+		return(location);
+	}
+	std::map<std::pair<GLuint, GLint>, GLint>::const_iterator found =
+		m_uniformLocations.find(std::make_pair(m_currentProgram, location));
+	if (found == m_uniformLocations.end())
+	{
+		return(location);
+	}
+	return(found->second);
+}
+
+/***********************************************************
+ *  GetNames()
+ *
+ *  This method is used for reading a list of names written
+ *  with their count in front.
+ ***********************************************************/
+void GLTraceReplayer::GetNames(std::vector<GLuint>& names)
+{
+	names.resize(GetWord());
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		names[i] = GetWord();
+	}
+	if (m_bPayloadShort)
+	{
+		names.clear();
+	}
+}
+
+/***********************************************************
+ *  AddNames()
+ *
+ *  This method is used for mapping the names in the trace
+ *  to the names made for them on replay.
+ ***********************************************************/
+void GLTraceReplayer::AddNames(
+	std::map<GLuint, GLuint>& names,
+	const std::vector<GLuint>& tracedNames,
+	const std::vector<GLuint>& madeNames)
+{
+	for (size_t i = 0; (i < tracedNames.size()) && (i < madeNames.size()); i++)
+	{
+		names[tracedNames[i]] = madeNames[i];
+	}
+}
+
+/***********************************************************
+ *  RemoveNames()
+ *
+ *  This method is used for swapping names in the trace for
+ *  the names made on replay, and forgetting them, since the
+ *  trace may use the names again once they are deleted.
+ ***********************************************************/
+void GLTraceReplayer::RemoveNames(std::map<GLuint, GLuint>& names, std::vector<GLuint>& tracedNames)
+{
+	for (size_t i = 0; i < tracedNames.size(); i++)
+	{
+		GLuint name = tracedNames[i];
+		tracedNames[i] = MapName(names, name);
+		names.erase(name);
+	}
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  This method is used for making the OpenGL call of the
+ *  command read into the payload.
+ ***********************************************************/
+void GLTraceReplayer::Execute(int command)
+{
+	std::vector<GLuint> names;
+	std::vector<GLuint> madeNames;
+	size_t size = 0;
+
+	switch (command)
+	{
+	case GLTraceManager::TRACE_ACTIVE_TEXTURE:
+		glActiveTexture(GetWord());
+		break;
+	case GLTraceManager::TRACE_ATTACH_SHADER:
+	{
+		GLuint program = MapName(m_programs, GetWord());
+		glAttachShader(program, MapName(m_shaders, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_BEGIN_CONDITIONAL_RENDER:
+	{
+		GLuint query = MapName(m_queries, GetWord());
+		glBeginConditionalRender(query, GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_BEGIN_QUERY:
+	{
+		GLenum target = GetWord();
+		glBeginQuery(target, MapName(m_queries, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_BIND_BUFFER:
+	{
+		GLenum target = GetWord();
+		glBindBuffer(target, MapName(m_buffers, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_BIND_BUFFER_BASE:
+	{
+		GLenum target = GetWord();
+		GLuint index = GetWord();
+		glBindBufferBase(target, index, MapName(m_buffers, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_BIND_FRAMEBUFFER:
+	{
+		GLenum target = GetWord();
+		glBindFramebuffer(target, MapName(m_framebuffers, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_BIND_IMAGE_TEXTURE:
+	{
+		GLuint unit = GetWord();
+		GLuint texture = MapName(m_textures, GetWord());
+		GLint level = GetInt();
+		GLboolean layered = (GLboolean)GetWord();
+		GLint layer = GetInt();
+		GLenum access = GetWord();
+		glBindImageTexture(unit, texture, level, layered, layer, access, GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_BIND_RENDERBUFFER:
+	{
+		GLenum target = GetWord();
+		glBindRenderbuffer(target, MapName(m_renderbuffers, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_BIND_SAMPLER:
+	{
+		GLuint unit = GetWord();
+		glBindSampler(unit, MapName(m_samplers, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_BIND_TEXTURE:
+	{
+		GLenum target = GetWord();
+		glBindTexture(target, MapName(m_textures, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_BIND_VERTEX_ARRAY:
+		glBindVertexArray(MapName(m_vertexArrays, GetWord()));
+		break;
+	case GLTraceManager::TRACE_BLEND_FUNC:
+	{
+		GLenum sourceFactor = GetWord();
+		glBlendFunc(sourceFactor, GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_BUFFER_DATA:
+	{
+		GLenum target = GetWord();
+		GLsizeiptr bufferSize = (GLsizeiptr)GetLong();
+		GLenum usage = GetWord();
+		glBufferData(target, bufferSize, GetData(size), usage);
+		break;
+	}
+	case GLTraceManager::TRACE_BUFFER_SUB_DATA:
+	{
+		GLenum target = GetWord();
+		GLintptr offset = (GLintptr)GetLong();
+		const void* pData = GetData(size);
+		if (NULL != pData)
+		{
+			glBufferSubData(target, offset, (GLsizeiptr)size, pData);
+		}
+		break;
+	}
+	case GLTraceManager::TRACE_CLEAR:
+		glClear(GetWord());
+		break;
+	case GLTraceManager::TRACE_CLEAR_COLOR:
+	{
+		GLfloat red = GetFloat();
+		GLfloat green = GetFloat();
+		GLfloat blue = GetFloat();
+		glClearColor(red, green, blue, GetFloat());
+		break;
+	}
+	case GLTraceManager::TRACE_COLOR_MASK:
+	{
+		GLboolean red = (GLboolean)GetWord();
+		GLboolean green = (GLboolean)GetWord();
+		GLboolean blue = (GLboolean)GetWord();
+		glColorMask(red, green, blue, (GLboolean)GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_COMPILE_SHADER:
+		glCompileShader(MapName(m_shaders, GetWord()));
+		break;
+	case GLTraceManager::TRACE_COPY_BUFFER_SUB_DATA:
+	{
+		GLenum readTarget = GetWord();
+		GLenum writeTarget = GetWord();
+		GLintptr readOffset = (GLintptr)GetLong();
+		GLintptr writeOffset = (GLintptr)GetLong();
+		glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, (GLsizeiptr)GetLong());
+		break;
+	}
+	case GLTraceManager::TRACE_CREATE_PROGRAM:
+		m_programs[GetWord()] = glCreateProgram();
+		break;
+	case GLTraceManager::TRACE_CREATE_SHADER:
+	{
+		GLenum type = GetWord();
+		m_shaders[GetWord()] = glCreateShader(type);
+		break;
+	}
+	case GLTraceManager::TRACE_CULL_FACE:
+		glCullFace(GetWord());
+		break;
+	case GLTraceManager::TRACE_DELETE_BUFFERS:
+		GetNames(names);
+		RemoveNames(m_buffers, names);
+		glDeleteBuffers((GLsizei)names.size(), names.data());
+		break;
+	case GLTraceManager::TRACE_DELETE_FRAMEBUFFERS:
+		GetNames(names);
+		RemoveNames(m_framebuffers, names);
+		glDeleteFramebuffers((GLsizei)names.size(), names.data());
+		break;
+	case GLTraceManager::TRACE_DELETE_PROGRAM:
+	{
+		GLuint program = GetWord();
+		glDeleteProgram(MapName(m_programs, program));
+		m_programs.erase(program);
+		m_uniformLocations.erase(
+			m_uniformLocations.lower_bound(std::make_pair(program, (GLint)INT_MIN)),
+			m_uniformLocations.upper_bound(std::make_pair(program, (GLint)INT_MAX)));
+		break;
+	}
+	case GLTraceManager::TRACE_DELETE_QUERIES:
+		GetNames(names);
+		RemoveNames(m_queries, names);
+		glDeleteQueries((GLsizei)names.size(), names.data());
+		break;
+	case GLTraceManager::TRACE_DELETE_RENDERBUFFERS:
+		GetNames(names);
+		RemoveNames(m_renderbuffers, names);
+		glDeleteRenderbuffers((GLsizei)names.size(), names.data());
+		break;
+	case GLTraceManager::TRACE_DELETE_SAMPLERS:
+		GetNames(names);
+		RemoveNames(m_samplers, names);
+		glDeleteSamplers((GLsizei)names.size(), names.data());
+		break;
+	case GLTraceManager::TRACE_DELETE_SHADER:
+	{
+		GLuint shader = GetWord();
+		glDeleteShader(MapName(m_shaders, shader));
+		m_shaders.erase(shader);
+		break;
+	}
+	case GLTraceManager::TRACE_DELETE_TEXTURES:
+		GetNames(names);
+		RemoveNames(m_textures, names);
+		glDeleteTextures((GLsizei)names.size(), names.data());
+		break;
+	case GLTraceManager::TRACE_DELETE_VERTEX_ARRAYS:
+		GetNames(names);
+		RemoveNames(m_vertexArrays, names);
+		glDeleteVertexArrays((GLsizei)names.size(), names.data());
+		break;
+	case GLTraceManager::TRACE_DEPTH_FUNC:
+		glDepthFunc(GetWord());
+		break;
+	case GLTraceManager::TRACE_DEPTH_MASK:
+		glDepthMask((GLboolean)GetWord());
+		break;
+	case GLTraceManager::TRACE_DETACH_SHADER:
+	{
+		GLuint program = MapName(m_programs, GetWord());
+		glDetachShader(program, MapName(m_shaders, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_DISABLE:
+		glDisable(GetWord());
+		break;
+	case GLTraceManager::TRACE_DISABLE_VERTEX_ATTRIB_ARRAY:
+		glDisableVertexAttribArray(GetWord());
+		break;
+	case GLTraceManager::TRACE_DISPATCH_COMPUTE:
+	{
+		GLuint groupsX = GetWord();
+		GLuint groupsY = GetWord();
+		glDispatchCompute(groupsX, groupsY, GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_DRAW_ARRAYS:
+	{
+		GLenum mode = GetWord();
+		GLint first = GetInt();
+		glDrawArrays(mode, first, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_DRAW_ARRAYS_INDIRECT:
+	{
+		GLenum mode = GetWord();
+		glDrawArraysIndirect(mode, (const void*)(size_t)GetLong());
+		break;
+	}
+	case GLTraceManager::TRACE_DRAW_ARRAYS_INSTANCED:
+	{
+		GLenum mode = GetWord();
+		GLint first = GetInt();
+		GLsizei count = GetInt();
+		glDrawArraysInstanced(mode, first, count, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_DRAW_ELEMENTS:
+	{
+		GLenum mode = GetWord();
+		GLsizei count = GetInt();
+		GLenum type = GetWord();
+		glDrawElements(mode, count, type, (const void*)(size_t)GetLong());
+		break;
+	}
+	case GLTraceManager::TRACE_DRAW_ELEMENTS_INSTANCED:
+	{
+		GLenum mode = GetWord();
+		GLsizei count = GetInt();
+		GLenum type = GetWord();
+		const void* indices = (const void*)(size_t)GetLong();
+		glDrawElementsInstanced(mode, count, type, indices, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_ENABLE:
+		glEnable(GetWord());
+		break;
+	case GLTraceManager::TRACE_ENABLE_VERTEX_ATTRIB_ARRAY:
+		glEnableVertexAttribArray(GetWord());
+		break;
+	case GLTraceManager::TRACE_END_CONDITIONAL_RENDER:
+		glEndConditionalRender();
+		break;
+	case GLTraceManager::TRACE_END_QUERY:
+		glEndQuery(GetWord());
+		break;
+	case GLTraceManager::TRACE_FINISH:
+		glFinish();
+		break;
+	case GLTraceManager::TRACE_FLUSH:
+		glFlush();
+		break;
+	case GLTraceManager::TRACE_FRAMEBUFFER_RENDERBUFFER:
+	{
+		GLenum target = GetWord();
+		GLenum attachment = GetWord();
+		GLenum renderbufferTarget = GetWord();
+		glFramebufferRenderbuffer(target, attachment, renderbufferTarget, MapName(m_renderbuffers, GetWord()));
+		break;
+	}
+	case GLTraceManager::TRACE_FRAMEBUFFER_TEXTURE_2D:
+	{
+		GLenum target = GetWord();
+		GLenum attachment = GetWord();
+		GLenum textureTarget = GetWord();
+		GLuint texture = MapName(m_textures, GetWord());
+		glFramebufferTexture2D(target, attachment, textureTarget, texture, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_GEN_BUFFERS:
+		GetNames(names);
+		madeNames.resize(names.size());
+		glGenBuffers((GLsizei)madeNames.size(), madeNames.data());
+		AddNames(m_buffers, names, madeNames);
+		break;
+	case GLTraceManager::TRACE_GEN_FRAMEBUFFERS:
+		GetNames(names);
+		madeNames.resize(names.size());
+		glGenFramebuffers((GLsizei)madeNames.size(), madeNames.data());
+		AddNames(m_framebuffers, names, madeNames);
+		break;
+	case GLTraceManager::TRACE_GEN_QUERIES:
+		GetNames(names);
+		madeNames.resize(names.size());
+		glGenQueries((GLsizei)madeNames.size(), madeNames.data());
+		AddNames(m_queries, names, madeNames);
+		break;
+	case GLTraceManager::TRACE_GEN_RENDERBUFFERS:
+		GetNames(names);
+		madeNames.resize(names.size());
+		glGenRenderbuffers((GLsizei)madeNames.size(), madeNames.data());
+		AddNames(m_renderbuffers, names, madeNames);
+		break;
+	case GLTraceManager::TRACE_GEN_SAMPLERS:
+		GetNames(names);
+		madeNames.resize(names.size());
+		glGenSamplers((GLsizei)madeNames.size(), madeNames.data());
+		AddNames(m_samplers, names, madeNames);
+		break;
+	case GLTraceManager::TRACE_GEN_TEXTURES:
+		GetNames(names);
+		madeNames.resize(names.size());
+		glGenTextures((GLsizei)madeNames.size(), madeNames.data());
+		AddNames(m_textures, names, madeNames);
+		break;
+	case GLTraceManager::TRACE_GEN_VERTEX_ARRAYS:
+		GetNames(names);
+		madeNames.resize(names.size());
+		glGenVertexArrays((GLsizei)madeNames.size(), madeNames.data());
+		AddNames(m_vertexArrays, names, madeNames);
+		break;
+	case GLTraceManager::TRACE_GENERATE_MIPMAP:
+		glGenerateMipmap(GetWord());
+		break;
+	case GLTraceManager::TRACE_GET_UNIFORM_LOCATION:
+	{
+		// the driver may place the uniform elsewhere
+		GLuint program = GetWord();
+		GLint location = GetInt();
+		const char* pName = (const char*)GetData(size);
+		if ((NULL != pName) && (location >= 0))
+		{
+			std::string name(pName, size);
+			m_uniformLocations[std::make_pair(program, location)] =
+				glGetUniformLocation(MapName(m_programs, program), name.c_str());
+		}
+		break;
+	}
+	case GLTraceManager::TRACE_LINK_PROGRAM:
+		glLinkProgram(MapName(m_programs, GetWord()));
+		break;
+	case GLTraceManager::TRACE_MAP_BUFFER_RANGE:
+	{
+		// the flushes of explicit ranges are not in the trace,
+		// the whole range is written at the unmap
+		GLenum target = GetWord();
+		GLintptr offset = (GLintptr)GetLong();
+		GLsizeiptr length = (GLsizeiptr)GetLong();
+		GLbitfield access = GetWord() & ~GL_MAP_FLUSH_EXPLICIT_BIT;
+		m_mappedRanges[target] = glMapBufferRange(target, offset, length, access);
+		break;
+	}
+	case GLTraceManager::TRACE_MEMORY_BARRIER:
+		glMemoryBarrier(GetWord());
+		break;
+	case GLTraceManager::TRACE_PIXEL_STORE:
+	{
+		GLenum pname = GetWord();
+		glPixelStorei(pname, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_POLYGON_MODE:
+	{
+		GLenum face = GetWord();
+		glPolygonMode(face, GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_QUERY_COUNTER:
+	{
+		GLuint query = MapName(m_queries, GetWord());
+		glQueryCounter(query, GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_READ_PIXELS:
+	{
+		GLint x = GetInt();
+		GLint y = GetInt();
+		GLsizei width = GetInt();
+		GLsizei height = GetInt();
+		GLenum format = GetWord();
+		GLenum type = GetWord();
+		bool bInBuffer = (GetWord() != 0);
+		unsigned long long offsetOrSize = GetLong();
+		if (bInBuffer)
+		{
+			glReadPixels(x, y, width, height, format, type, (void*)(size_t)offsetOrSize);
+		}
+		else
+		{
+			m_readPixels.resize((size_t)offsetOrSize);
+			glReadPixels(x, y, width, height, format, type, m_readPixels.data());
+		}
+		break;
+	}
+	case GLTraceManager::TRACE_RENDERBUFFER_STORAGE:
+	{
+		GLenum target = GetWord();
+		GLenum internalFormat = GetWord();
+		GLsizei width = GetInt();
+		glRenderbufferStorage(target, internalFormat, width, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_SAMPLER_PARAMETER_F:
+	{
+		GLuint sampler = MapName(m_samplers, GetWord());
+		GLenum pname = GetWord();
+		glSamplerParameterf(sampler, pname, GetFloat());
+		break;
+	}
+	case GLTraceManager::TRACE_SAMPLER_PARAMETER_I:
+	{
+		GLuint sampler = MapName(m_samplers, GetWord());
+		GLenum pname = GetWord();
+		glSamplerParameteri(sampler, pname, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_SHADER_SOURCE:
+	{
+		GLuint shader = MapName(m_shaders, GetWord());
+		const GLchar* pSource = (const GLchar*)GetData(size);
+		GLint length = (GLint)size;
+		if (NULL != pSource)
+		{
+			glShaderSource(shader, 1, &pSource, &length);
+		}
+		break;
+	}
+	case GLTraceManager::TRACE_TEX_IMAGE_2D:
+	{
+		GLenum target = GetWord();
+		GLint level = GetInt();
+		GLint internalFormat = GetInt();
+		GLsizei width = GetInt();
+		GLsizei height = GetInt();
+		GLint border = GetInt();
+		GLenum format = GetWord();
+		GLenum type = GetWord();
+		glTexImage2D(target, level, internalFormat, width, height, border, format, type, GetPixels());
+		break;
+	}
+	case GLTraceManager::TRACE_TEX_PARAMETER_I:
+	{
+		GLenum target = GetWord();
+		GLenum pname = GetWord();
+		glTexParameteri(target, pname, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_TEX_PARAMETER_IV:
+	{
+		GLenum target = GetWord();
+		GLenum pname = GetWord();
+		GLint params[4] = { 0, 0, 0, 0 };
+		unsigned int valueCount = std::min(GetWord(), 4u);
+		for (unsigned int i = 0; i < valueCount; i++)
+		{
+			params[i] = GetInt();
+		}
+		glTexParameteriv(target, pname, params);
+		break;
+	}
+	case GLTraceManager::TRACE_TEX_STORAGE_2D:
+	{
+		GLenum target = GetWord();
+		GLsizei levels = GetInt();
+		GLenum internalFormat = GetWord();
+		GLsizei width = GetInt();
+		glTexStorage2D(target, levels, internalFormat, width, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_TEX_SUB_IMAGE_2D:
+	{
+		GLenum target = GetWord();
+		GLint level = GetInt();
+		GLint xoffset = GetInt();
+		GLint yoffset = GetInt();
+		GLsizei width = GetInt();
+		GLsizei height = GetInt();
+		GLenum format = GetWord();
+		GLenum type = GetWord();
+		glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, GetPixels());
+		break;
+	}
+	case GLTraceManager::TRACE_UNIFORM_F:
+	{
+		GLint location = MapLocation(GetInt());
+		unsigned int valueCount = GetWord();
+		GLfloat values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (unsigned int i = 0; (i < valueCount) && (i < 4); i++)
+		{
+			values[i] = GetFloat();
+		}
+		switch (valueCount)
+		{
+		case 1:
+			glUniform1f(location, values[0]);
+			break;
+		case 2:
+			glUniform2f(location, values[0], values[1]);
+			break;
+		case 3:
+			glUniform3f(location, values[0], values[1], values[2]);
+			break;
+		default:
+			glUniform4f(location, values[0], values[1], values[2], values[3]);
+			break;
+		}
+		break;
+	}
+	case GLTraceManager::TRACE_UNIFORM_FV:
+	case GLTraceManager::TRACE_UNIFORM_MATRIX:
+	{
+		GLint location = MapLocation(GetInt());
+		unsigned int columns = GetWord();
+		GLsizei count = GetInt();
+		GLboolean transpose = GL_FALSE;
+		if (command == GLTraceManager::TRACE_UNIFORM_MATRIX)
+		{
+			transpose = (GLboolean)GetWord();
+		}
+		// the values follow as they were written
+		const GLfloat* pValues = (const GLfloat*)(m_payload.data() + m_readOffset);
+		size_t valueCount = (size_t)count * columns;
+		if (command == GLTraceManager::TRACE_UNIFORM_MATRIX)
+		{
+			valueCount *= columns;
+		}
+		if (m_bPayloadShort || (m_readOffset + valueCount * sizeof(GLfloat) > m_payload.size()))
+		{
+			break;
+		}
+		if (command == GLTraceManager::TRACE_UNIFORM_MATRIX)
+		{
+			if (columns == 3)
+			{
+				glUniformMatrix3fv(location, count, transpose, pValues);
+			}
+			else
+			{
+				glUniformMatrix4fv(location, count, transpose, pValues);
+			}
+		}
+		else if (columns == 2)
+		{
+			glUniform2fv(location, count, pValues);
+		}
+		else if (columns == 3)
+		{
+			glUniform3fv(location, count, pValues);
+		}
+		else
+		{
+			glUniform4fv(location, count, pValues);
+		}
+		break;
+	}
+	case GLTraceManager::TRACE_UNIFORM_I:
+	{
+		GLint location = MapLocation(GetInt());
+		glUniform1i(location, GetInt());
+		break;
+	}
+	case GLTraceManager::TRACE_UNIFORM_UI:
+	{
+		GLint location = MapLocation(GetInt());
+		glUniform1ui(location, GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_UNMAP_BUFFER:
+	{
+		// write what the renderer wrote into the range
+		GLenum target = GetWord();
+		const void* pData = GetData(size);
+		std::map<GLenum, void*>::iterator found = m_mappedRanges.find(target);
+		if (found != m_mappedRanges.end())
+		{
+			if ((NULL != found->second) && (NULL != pData))
+			{
+				memcpy(found->second, pData, size);
+			}
+			m_mappedRanges.erase(found);
+		}
+		glUnmapBuffer(target);
+		break;
+	}
+	case GLTraceManager::TRACE_USE_PROGRAM:
+		m_currentProgram = GetWord();
+		glUseProgram(MapName(m_programs, m_currentProgram));
+		break;
+	case GLTraceManager::TRACE_VERTEX_ATTRIB_DIVISOR:
+	{
+		GLuint index = GetWord();
+		glVertexAttribDivisor(index, GetWord());
+		break;
+	}
+	case GLTraceManager::TRACE_VERTEX_ATTRIB_POINTER:
+	{
+		GLuint index = GetWord();
+		GLint components = GetInt();
+		GLenum type = GetWord();
+		GLboolean normalized = (GLboolean)GetWord();
+		GLsizei stride = GetInt();
+		glVertexAttribPointer(index, components, type, normalized, stride, (const void*)(size_t)GetLong());
+		break;
+	}
+	case GLTraceManager::TRACE_VIEWPORT:
+	{
+		GLint x = GetInt();
+		GLint y = GetInt();
+		GLsizei width = GetInt();
+		glViewport(x, y, width, GetInt());
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  ReadGPUTimes()
+ *
+ *  This method is used for reading the timestamps of a
+ *  frame once it is swapped, adding them to the costs, and
+ *  keeping the slowest calls of the frame.
+ ***********************************************************/
+void GLTraceReplayer::ReadGPUTimes(FRAME_COST& frame)
+{
+	GLuint64 frameBegin = 0;
+	GLuint64 frameEnd = 0;
+	glGetQueryObjectui64v(m_frameQueries[0], GL_QUERY_RESULT, &frameBegin);
+	glGetQueryObjectui64v(m_frameQueries[1], GL_QUERY_RESULT, &frameEnd);
+	frame.gpuMilliseconds = (frameEnd > frameBegin) ? (double)(frameEnd - frameBegin) / 1.0e6 : 0.0;
+
+	for (const GPU_TIMING& timing : m_gpuTimings)
+	{
+		GLuint64 callBegin = 0;
+		GLuint64 callEnd = 0;
+		glGetQueryObjectui64v(m_timerQueries[timing.query], GL_QUERY_RESULT, &callBegin);
+		glGetQueryObjectui64v(m_timerQueries[timing.query + 1], GL_QUERY_RESULT, &callEnd);
+		double microseconds = (callEnd > callBegin) ? (double)(callEnd - callBegin) / 1.0e3 : 0.0;
+		m_frameCalls[timing.call].gpuMicroseconds = microseconds;
+		m_commandCosts[timing.command].gpuCalls++;
+		m_commandCosts[timing.command].gpuMicroseconds += microseconds;
+	}
+
+	// keep the slowest calls seen so far
+	m_slowestCalls.insert(m_slowestCalls.end(), m_frameCalls.begin(), m_frameCalls.end());
+	size_t keptCount = std::min(m_slowestCalls.size(), (size_t)g_SlowestCallCount);
+	std::partial_sort(m_slowestCalls.begin(), m_slowestCalls.begin() + keptCount, m_slowestCalls.end(),
+		[](const CALL_COST& a, const CALL_COST& b)
+		{
+			return(GetCallMicroseconds(a.cpuMicroseconds, a.gpuMicroseconds) >
+				GetCallMicroseconds(b.cpuMicroseconds, b.gpuMicroseconds));
+		});
+	m_slowestCalls.resize(keptCount);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the frame times, the
+ *  cost of each command, and the slowest frames and calls,
+ *  by their frame and call number, which is where to look
+ *  first when two replays of the trace part ways.
+ ***********************************************************/
+void GLTraceReplayer::Report(const std::string& csvFilename)
+{
+	if (m_frameCosts.empty())
+	{
+		std::cout << "INFO: No frames of the GL trace were replayed" << std::endl;
+		return;
+	}
+
+	double totalCPU = 0.0;
+	double totalGPU = 0.0;
+	double minCPU = m_frameCosts[0].cpuMilliseconds;
+	double maxCPU = 0.0;
+	double minGPU = m_frameCosts[0].gpuMilliseconds;
+	double maxGPU = 0.0;
+	int firstErrorFrame = -1;
+	int errorFrames = 0;
+	for (const FRAME_COST& frame : m_frameCosts)
+	{
+		totalCPU += frame.cpuMilliseconds;
+		totalGPU += frame.gpuMilliseconds;
+		minCPU = std::min(minCPU, frame.cpuMilliseconds);
+		maxCPU = std::max(maxCPU, frame.cpuMilliseconds);
+		minGPU = std::min(minGPU, frame.gpuMilliseconds);
+		maxGPU = std::max(maxGPU, frame.gpuMilliseconds);
+		if (frame.bError)
+		{
+			errorFrames++;
+			if (firstErrorFrame < 0)
+			{
+				firstErrorFrame = frame.frame;
+			}
+		}
+	}
+	double frameCount = (double)m_frameCosts.size();
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "INFO: GL trace replay of " << m_frameCosts.size() << " frames, milliseconds per frame" << std::endl;
+	std::cout << "    CPU average " << totalCPU / frameCount << ", min " << minCPU << ", max " << maxCPU << std::endl;
+	std::cout << "    GPU average " << totalGPU / frameCount << ", min " << minGPU << ", max " << maxGPU << std::endl;
+	if (firstErrorFrame >= 0)
+	{
+		std::cout << "    OpenGL errors in " << errorFrames << " frames, first in frame " << firstErrorFrame << std::endl;
+	}
+	// frames with skipped calls are not drawn as they were captured
+	for (int command = 0; command < (int)m_skippedCalls.size(); command++)
+	{
+		if (m_skippedCalls[command] > 0)
+		{
+			std::cout << "    Skipped " << m_skippedCalls[command] << " calls of "
+				<< GLTraceManager::GetCommandName(command) << ", which the replay context has no entry point for" << std::endl;
+		}
+	}
+
+	// the commands by the time they take each frame
+	std::vector<int> commands;
+	for (int i = 0; i < (int)m_commandCosts.size(); i++)
+	{
+		if (m_commandCosts[i].calls > 0)
+		{
+			commands.push_back(i);
+		}
+	}
+	std::sort(commands.begin(), commands.end(),
+		[this](int a, int b)
+		{
+			return(GetCallMicroseconds(m_commandCosts[a].cpuMicroseconds, m_commandCosts[a].gpuMicroseconds) >
+				GetCallMicroseconds(m_commandCosts[b].cpuMicroseconds, m_commandCosts[b].gpuMicroseconds));
+		});
+	std::cout << "INFO: GL trace cost per command, microseconds" << std::endl;
+	std::cout << "    " << std::left << std::setw(28) << "command" << std::right << std::setw(12) << "calls/frame"
+		<< std::setw(12) << "CPU/call" << std::setw(12) << "CPU/frame" << std::setw(12) << "GPU/call"
+		<< std::setw(12) << "GPU/frame" << std::endl;
+	for (int command : commands)
+	{
+		const COMMAND_COST& cost = m_commandCosts[command];
+		std::cout << "    " << std::left << std::setw(28) << GLTraceManager::GetCommandName(command) << std::right
+			<< std::setw(12) << cost.calls / frameCount
+			<< std::setw(12) << cost.cpuMicroseconds / cost.calls
+			<< std::setw(12) << cost.cpuMicroseconds / frameCount;
+		if (cost.gpuCalls > 0)
+		{
+			std::cout << std::setw(12) << cost.gpuMicroseconds / cost.gpuCalls
+				<< std::setw(12) << cost.gpuMicroseconds / frameCount;
+		}
+		std::cout << std::endl;
+	}
+
+	std::vector<FRAME_COST> slowestFrames = m_frameCosts;
+	size_t frameLines = std::min(slowestFrames.size(), (size_t)g_SlowestFrameCount);
+	std::partial_sort(slowestFrames.begin(), slowestFrames.begin() + frameLines, slowestFrames.end(),
+		[](const FRAME_COST& a, const FRAME_COST& b)
+		{
+			return(std::max(a.cpuMilliseconds, a.gpuMilliseconds) > std::max(b.cpuMilliseconds, b.gpuMilliseconds));
+		});
+	std::cout << "INFO: Slowest frames, milliseconds" << std::endl;
+	for (size_t i = 0; i < frameLines; i++)
+	{
+		std::cout << "    frame " << std::setw(6) << slowestFrames[i].frame << "  CPU " << std::setw(9)
+			<< slowestFrames[i].cpuMilliseconds << "  GPU " << std::setw(9) << slowestFrames[i].gpuMilliseconds
+			<< "  " << slowestFrames[i].calls << " calls, " << slowestFrames[i].draws << " draws" << std::endl;
+	}
+
+	std::cout << "INFO: Slowest calls, microseconds" << std::endl;
+	for (const CALL_COST& call : m_slowestCalls)
+	{
+		std::cout << "    frame " << std::setw(6) << call.frame << "  call " << std::setw(6) << call.call << "  "
+			<< std::left << std::setw(28) << GLTraceManager::GetCommandName(call.command) << std::right
+			<< "CPU " << std::setw(10) << call.cpuMicroseconds << "  GPU " << std::setw(10) << call.gpuMicroseconds
+			<< std::endl;
+	}
+	std::cout << std::defaultfloat;
+
+	if (!csvFilename.empty())
+	{
+		std::ofstream file(csvFilename.c_str());
+		if (!file.is_open())
+		{
+			std::cout << "Could not write GL trace replay results to " << csvFilename << std::endl;
+			return;
+		}
+		file << "frame,calls,draws,cpu_ms,gpu_ms,gl_error\n";
+		for (const FRAME_COST& frame : m_frameCosts)
+		{
+			file << frame.frame << "," << frame.calls << "," << frame.draws << "," << frame.cpuMilliseconds << ","
+				<< frame.gpuMilliseconds << "," << (frame.bError ? 1 : 0) << "\n";
+		}
+		std::cout << "INFO: Wrote the GL trace replay frame times to " << csvFilename << std::endl;
+	}
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for closing the window, which takes
+ *  the replayed objects with its context.
+ ***********************************************************/
+void GLTraceReplayer::Release()
+{
+	if (m_file.is_open())
+	{
+		m_file.close();
+	}
+	if (NULL != m_pWindow)
+	{
+		glfwDestroyWindow(m_pWindow);
+		m_pWindow = NULL;
+		glfwTerminate();
+	}
+	m_buffers.clear();
+	m_framebuffers.clear();
+	m_programs.clear();
+	m_queries.clear();
+	m_renderbuffers.clear();
+	m_samplers.clear();
+	m_shaders.clear();
+	m_textures.clear();
+	m_vertexArrays.clear();
+	m_uniformLocations.clear();
+	m_mappedRanges.clear();
+	m_timerQueries.clear();
+}
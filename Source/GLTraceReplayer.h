@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// gltracereplayer.h
+// ============
+// replay a captured OpenGL command stream - headless timing and bisecting
+//
+//  The replayer opens a hidden window the size of the captured frames, with
+//  the newest OpenGL it is given, so a trace taken on one machine can be
+//  run on a software OpenGL without the scene files.  The names and uniform
+//  locations the trace recorded are mapped to the ones made on replay.
+//  Each call is timed on the CPU, and the draws, dispatches, clears and
+//  copies are also timed on the GPU with timestamps, so the report can
+//  point at the frame and call where the time goes, or where two drivers
+//  part ways when their runs are compared.  Calls whose entry point the
+//  context does not have, such as compute on an OpenGL 3.3 driver, are
+//  skipped and counted, and the report lists them.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLTraceManager.h"
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct GLFWwindow;
+
+/***********************************************************
+ *  GLTraceReplayer
+ *
+ *  This class contains the code for running the calls of a
+ *  trace file and reporting what each one cost.
+ ***********************************************************/
+class GLTraceReplayer
+{
+public:
+	// constructor
+	GLTraceReplayer();
+	// destructor
+	~GLTraceReplayer();
+
+private:
+	// what the calls of one command cost over the timed frames
+	struct COMMAND_COST
+	{
+		int calls;
+		double cpuMicroseconds;
+		int gpuCalls;
+		double gpuMicroseconds;
+	};
+
+	// what one frame cost
+	struct FRAME_COST
+	{
+		int frame;
+		int calls;
+		int draws;
+		double cpuMilliseconds;
+		double gpuMilliseconds;
+		bool bError;
+	};
+
+	// a call, by where it is in the trace
+	struct CALL_COST
+	{
+		int frame;
+		int call;
+		int command;
+		double cpuMicroseconds;
+		double gpuMicroseconds;
+	};
+
+	// a call timed on the GPU, by its pair of timestamps
+	struct GPU_TIMING
+	{
+		int call;
+		int command;
+		int query;
+	};
+
+	GLFWwindow* m_pWindow;
+	std::ifstream m_file;
+	GLTraceManager::FILE_HEADER m_header;
+
+	// the command being run
+	std::vector<unsigned char> m_payload;
+	size_t m_readOffset;
+	bool m_bPayloadShort;
+
+	// names in the trace mapped to the names made on replay
+	std::map<GLuint, GLuint> m_buffers;
+	std::map<GLuint, GLuint> m_framebuffers;
+	std::map<GLuint, GLuint> m_programs;
+	std::map<GLuint, GLuint> m_queries;
+	std::map<GLuint, GLuint> m_renderbuffers;
+	std::map<GLuint, GLuint> m_samplers;
+	std::map<GLuint, GLuint> m_shaders;
+	std::map<GLuint, GLuint> m_textures;
+	std::map<GLuint, GLuint> m_vertexArrays;
+	// uniform locations by the program and location in the trace
+	std::map<std::pair<GLuint, GLint>, GLint> m_uniformLocations;
+	GLuint m_currentProgram;
+	// ranges mapped on replay by their target
+	std::map<GLenum, void*> m_mappedRanges;
+	// pixels read back into memory, which nothing uses
+	std::vector<unsigned char> m_readPixels;
+
+	// timestamp queries, a pair for each call timed in a frame
+	std::vector<GLuint> m_timerQueries;
+	std::vector<GPU_TIMING> m_gpuTimings;
+	GLuint m_frameQueries[2];
+
+	// whether the context has the entry point of each command,
+	// and the calls skipped for the lack of it
+	std::vector<bool> m_commandAvailable;
+	std::vector<int> m_skippedCalls;
+
+	std::vector<COMMAND_COST> m_commandCosts;
+	std::vector<FRAME_COST> m_frameCosts;
+	// calls of the frame being run, and the slowest calls of
+	// the timed frames
+	std::vector<CALL_COST> m_frameCalls;
+	std::vector<CALL_COST> m_slowestCalls;
+
+	// read the arguments of the command being run
+	unsigned int GetWord();
+	GLint GetInt();
+	GLfloat GetFloat();
+	unsigned long long GetLong();
+	// data with its size in front, NULL when it is empty
+	const void* GetData(size_t& size);
+	// data or an offset into a bound buffer, as the pixel
+	// calls write it
+	const void* GetPixels();
+
+	// find the name made on replay for a name in the trace
+	static GLuint MapName(const std::map<GLuint, GLuint>& names, GLuint name);
+	GLint MapLocation(GLint location);
+	// read a list of names in the trace
+	void GetNames(std::vector<GLuint>& names);
+	// map the names in the trace to names made on replay
+	static void AddNames(
+		std::map<GLuint, GLuint>& names,
+		const std::vector<GLuint>& tracedNames,
+		const std::vector<GLuint>& madeNames);
+	// swap a list of names in the trace for the replay names,
+	// forgetting them, before they are deleted
+	static void RemoveNames(std::map<GLuint, GLuint>& names, std::vector<GLuint>& tracedNames);
+
+	// open a hidden window with a context for the trace
+	bool CreateReplayWindow();
+	// find the commands whose entry points the context has
+	void FindAvailableCommands();
+	// run the command in the payload
+	void Execute(int command);
+	// read the GPU times of the calls of a frame, and keep
+	// its slowest calls
+	void ReadGPUTimes(FRAME_COST& frame);
+	// print the costs, and write the frames to a CSV file
+	void Report(const std::string& csvFilename);
+	// delete the replayed objects and the window
+	void Release();
+
+public:
+	// replay a trace, timing the frames from first to last, or
+	// all of them when last is below zero
+	int Run(const std::string& filename, int firstFrame, int lastFrame, const std::string& csvFilename);
+};
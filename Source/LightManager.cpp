@@ -0,0 +1,713 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmanager.cpp
+// ============
+// manage the point and spot lights of the scene - importance and light LOD
+//
+//  A light is scored by its brightness after the falloff to the camera, so
+//  a bright lamp across the room beats a dim one close by, and scored zero
+//  when the sphere it reaches is outside the view frustum.  Lights already
+//  in a shader slot keep it while they fade out, and a newly chosen light
+//  only takes a slot once one is free, so the budget holds at every frame.
+//  A folded light adds its ambient and a share of its diffuse color, as
+//  seen at the camera and spread over its cone, to the ambient term.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightManager.h"
+#include "PortalManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_PointLightsName = "pointLights";
+	const char* g_SpotLightsName = "spotLights";
+	const char* g_FoldedAmbientName = "foldedAmbient";
+
+	// the lights of the current and the neighboring rooms fit
+	const int g_DefaultBudget = 6;
+	const float g_DefaultFadeSeconds = 0.5f;
+	// color level below which a light adds nothing worth shading,
+	// which sets how far each light reaches
+	const float g_LightCutoff = 0.05f;
+	// range of a light with no falloff
+	const float g_UnboundedRange = 1.0e6f;
+	// share of the diffuse color of a folded light that reaches
+	// the surfaces around the camera, facing it or not
+	const float g_FoldedDiffuseShare = 0.25f;
+	// the folded term is kept under the ambient of a lit room
+	const float g_MaxFoldedAmbient = 0.3f;
+	// smallest change in the folded term that is set again
+	const float g_FoldedTolerance = 1.0e-3f;
+
+	const double g_ReportSeconds = 5.0;
+
+	// brightest channel a light adds at its source
+	float GetBrightness(const LightManager::LIGHT_SOURCE& light)
+	{
+		glm::vec3 color = light.ambient + light.diffuse + light.specular;
+		return(std::max(color.r, std::max(color.g, color.b)));
+	}
+
+	// falloff of a light at a distance
+	float GetAttenuation(const LightManager::LIGHT_SOURCE& light, float distance)
+	{
+		float falloff = light.constant + light.linear * distance + light.quadratic * distance * distance;
+		return((falloff > 0.0f) ? (1.0f / falloff) : 1.0f);
+	}
+
+	// share of the directions around a light that a spot lights
+	float GetConeShare(const LightManager::LIGHT_SOURCE& light)
+	{
+		if (light.type != LightManager::LIGHT_SPOT)
+		{
+			return(1.0f);
+		}
+		return(std::min(std::max((1.0f - light.outerCutOff) * 0.5f, 0.0f), 1.0f));
+	}
+
+	// whether a sphere is at least partly inside frustum planes
+	bool SphereInFrustum(glm::vec3 center, float radius, const std::vector<glm::vec4>& planes)
+	{
+		for (const glm::vec4& plane : planes)
+		{
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+			{
+				return(false);
+			}
+		}
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  LightManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightManager::LightManager()
+{
+	m_budget = g_DefaultBudget;
+	m_fadeSeconds = g_DefaultFadeSeconds;
+	m_pointSlots.assign(POINT_LIGHT_SLOTS, -1);
+	m_spotSlots.assign(SPOT_LIGHT_SLOTS, -1);
+	m_foldedAmbient = glm::vec3(0.0f);
+	m_bUploadValid = false;
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_updates = 0;
+	m_candidateLights = 0;
+	m_shadedLights = 0;
+	m_foldedLights = 0;
+	m_culledLights = 0;
+	m_selectionChanges = 0;
+}
+
+/***********************************************************
+ *  ~LightManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightManager::~LightManager()
+{
+	m_lights.clear();
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light.  The slot of a
+ *  removed light is reused.  The light takes its place in
+ *  the selection at the next update without a fade.
+ ***********************************************************/
+int LightManager::AddLight(const LIGHT_SOURCE& light)
+{
+	int lightIndex = -1;
+	for (int i = 0; i < (int)m_lights.size(); i++)
+	{
+		if (!m_lights[i].bActive)
+		{
+			lightIndex = i;
+			break;
+		}
+	}
+	if (lightIndex == -1)
+	{
+		m_lights.push_back(LIGHT_SLOT());
+		lightIndex = (int)m_lights.size() - 1;
+	}
+
+	LIGHT_SLOT& slot = m_lights[lightIndex];
+	slot.light = light;
+	slot.bActive = true;
+	slot.range = GetLightRange(light);
+	slot.score = 0.0f;
+	// below zero until the first update sets it outright
+	slot.weight = -1.0f;
+	slot.bSelected = false;
+
+	return(lightIndex);
+}
+
+/***********************************************************
+ *  RemoveLight()
+ *
+ *  This method is used for removing a light.  It leaves its
+ *  shader slot at once, which only happens for the lights
+ *  of rooms far out of view.
+ ***********************************************************/
+void LightManager::RemoveLight(int lightIndex)
+{
+	if (lightIndex < 0 || lightIndex >= (int)m_lights.size())
+	{
+		return;
+	}
+
+	m_lights[lightIndex].bActive = false;
+	m_lights[lightIndex].weight = 0.0f;
+	m_lights[lightIndex].bSelected = false;
+	std::replace(m_pointSlots.begin(), m_pointSlots.end(), lightIndex, -1);
+	std::replace(m_spotSlots.begin(), m_spotSlots.end(), lightIndex, -1);
+}
+
+/***********************************************************
+ *  SetLight()
+ *
+ *  This method is used for changing the values of a light.
+ ***********************************************************/
+void LightManager::SetLight(int lightIndex, const LIGHT_SOURCE& light)
+{
+	if (lightIndex < 0 || lightIndex >= (int)m_lights.size() || !m_lights[lightIndex].bActive)
+	{
+		return;
+	}
+
+	m_lights[lightIndex].light = light;
+	m_lights[lightIndex].range = GetLightRange(light);
+}
+
+/***********************************************************
+ *  GetLight()
+ *
+ *  This method is used for getting the values of a light,
+ *  NULL when there is no such light.
+ ***********************************************************/
+const LightManager::LIGHT_SOURCE* LightManager::GetLight(int lightIndex) const
+{
+	if (lightIndex < 0 || lightIndex >= (int)m_lights.size() || !m_lights[lightIndex].bActive)
+	{
+		return(NULL);
+	}
+	return(&m_lights[lightIndex].light);
+}
+
+/***********************************************************
+ *  SetBudget()
+ *
+ *  This method is used for setting the most lights shaded
+ *  at once, which is never more than the shader has slots.
+ ***********************************************************/
+void LightManager::SetBudget(int lightCount)
+{
+	m_budget = std::min(std::max(lightCount, 0), POINT_LIGHT_SLOTS + SPOT_LIGHT_SLOTS);
+}
+
+/***********************************************************
+ *  GetBudget()
+ *
+ *  This method is used for getting the most lights shaded
+ *  at once.
+ ***********************************************************/
+int LightManager::GetBudget() const
+{
+	return(m_budget);
+}
+
+/***********************************************************
+ *  SetFadeSeconds()
+ *
+ *  This method is used for setting how long a light takes
+ *  to fade in or out, where zero switches lights at once.
+ ***********************************************************/
+void LightManager::SetFadeSeconds(float seconds)
+{
+	m_fadeSeconds = std::max(seconds, 0.0f);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for scoring the lights for a view,
+ *  choosing the ones shaded within the budget, giving them
+ *  shader slots and moving every fade by the time passed.
+ *  Returns true when the lighting changed.
+ ***********************************************************/
+bool LightManager::Update(
+	const glm::mat4& viewProjection,
+	glm::vec3 cameraPosition,
+	bool bHasView,
+	float deltaSeconds)
+{
+	std::vector<glm::vec4> frustum;
+	if (bHasView)
+	{
+		PortalManager::ExtractFrustumPlanes(viewProjection, frustum);
+	}
+
+	// score every light, the ones out of view are culled
+	std::vector<int> ranked;
+	int culled = 0;
+	for (int i = 0; i < (int)m_lights.size(); i++)
+	{
+		LIGHT_SLOT& slot = m_lights[i];
+		slot.score = 0.0f;
+		if (!slot.bActive)
+		{
+			continue;
+		}
+		if (slot.light.bEnabled && (slot.range > 0.0f) &&
+			SphereInFrustum(slot.light.position, slot.range, frustum))
+		{
+			float distance = glm::length(slot.light.position - cameraPosition);
+			slot.score = GetBrightness(slot.light) * GetAttenuation(slot.light, distance);
+			ranked.push_back(i);
+		}
+		else
+		{
+			culled++;
+		}
+	}
+	std::sort(ranked.begin(), ranked.end(), [this](int a, int b)
+		{
+			return(m_lights[a].score > m_lights[b].score);
+		});
+
+	// choose the best lights, as many of each type as it has slots
+	int selectionChanges = 0;
+	int chosenPoints = 0;
+	int chosenSpots = 0;
+	std::vector<bool> chosen(m_lights.size(), false);
+	for (int lightIndex : ranked)
+	{
+		if (chosenPoints + chosenSpots >= m_budget)
+		{
+			break;
+		}
+		bool bSpot = (m_lights[lightIndex].light.type == LIGHT_SPOT);
+		int& typeCount = bSpot ? chosenSpots : chosenPoints;
+		if (typeCount < (bSpot ? SPOT_LIGHT_SLOTS : POINT_LIGHT_SLOTS))
+		{
+			chosen[lightIndex] = true;
+			typeCount++;
+		}
+	}
+	for (int i = 0; i < (int)m_lights.size(); i++)
+	{
+		LIGHT_SLOT& slot = m_lights[i];
+		if (slot.bActive && (slot.bSelected != chosen[i]))
+		{
+			selectionChanges++;
+		}
+		slot.bSelected = chosen[i];
+		// a new light starts where the selection puts it
+		if (slot.bActive && (slot.weight < 0.0f))
+		{
+			slot.weight = slot.bSelected ? 1.0f : 0.0f;
+		}
+	}
+
+	// lights still fading keep their slots, chosen lights first
+	// and then the brightest fading out, and the lights that no
+	// longer fit the budget leave at once
+	std::vector<int> shaded;
+	for (int i = 0; i < (int)m_lights.size(); i++)
+	{
+		if (m_lights[i].bActive && (m_lights[i].weight > 0.0f))
+		{
+			shaded.push_back(i);
+		}
+	}
+	std::sort(shaded.begin(), shaded.end(), [this](int a, int b)
+		{
+			if (m_lights[a].bSelected != m_lights[b].bSelected)
+			{
+				return(m_lights[a].bSelected);
+			}
+			return(m_lights[a].weight * m_lights[a].score > m_lights[b].weight * m_lights[b].score);
+		});
+	std::vector<int> keep;
+	int keptPoints = 0;
+	int keptSpots = 0;
+	for (int lightIndex : shaded)
+	{
+		bool bSpot = (m_lights[lightIndex].light.type == LIGHT_SPOT);
+		int& typeCount = bSpot ? keptSpots : keptPoints;
+		if ((keptPoints + keptSpots < m_budget) &&
+			(typeCount < (bSpot ? SPOT_LIGHT_SLOTS : POINT_LIGHT_SLOTS)))
+		{
+			keep.push_back(lightIndex);
+			typeCount++;
+		}
+		else
+		{
+			m_lights[lightIndex].weight = 0.0f;
+		}
+	}
+	// chosen lights not yet shaded fade in while there is room
+	for (int lightIndex : ranked)
+	{
+		LIGHT_SLOT& slot = m_lights[lightIndex];
+		if (!slot.bSelected || (slot.weight > 0.0f))
+		{
+			continue;
+		}
+		bool bSpot = (slot.light.type == LIGHT_SPOT);
+		int& typeCount = bSpot ? keptSpots : keptPoints;
+		if ((keptPoints + keptSpots < m_budget) &&
+			(typeCount < (bSpot ? SPOT_LIGHT_SLOTS : POINT_LIGHT_SLOTS)))
+		{
+			keep.push_back(lightIndex);
+			typeCount++;
+		}
+	}
+
+	// move the fades of the lights kept
+	bool bChanged = (selectionChanges > 0);
+	float step = (m_fadeSeconds > 0.0f) ? (std::max(deltaSeconds, 0.0f) / m_fadeSeconds) : 1.0f;
+	std::vector<bool> kept(m_lights.size(), false);
+	for (int lightIndex : keep)
+	{
+		LIGHT_SLOT& slot = m_lights[lightIndex];
+		float target = slot.bSelected ? 1.0f : 0.0f;
+		float weight = (target > slot.weight) ? std::min(slot.weight + step, target) : std::max(slot.weight - step, target);
+		// the light fading in holds a little weight from the start,
+		// so it keeps its slot until it has faded
+		if (slot.bSelected && (weight <= 0.0f))
+		{
+			weight = std::min(step, 1.0f);
+		}
+		bChanged = bChanged || (weight != slot.weight);
+		slot.weight = weight;
+		kept[lightIndex] = (weight > 0.0f);
+	}
+
+	// lights keep their shader slot while they are shaded, and
+	// the others take the slots left free
+	for (int s = 0; s < POINT_LIGHT_SLOTS; s++)
+	{
+		if ((m_pointSlots[s] >= 0) && !kept[m_pointSlots[s]])
+		{
+			m_pointSlots[s] = -1;
+		}
+	}
+	for (int s = 0; s < SPOT_LIGHT_SLOTS; s++)
+	{
+		if ((m_spotSlots[s] >= 0) && !kept[m_spotSlots[s]])
+		{
+			m_spotSlots[s] = -1;
+		}
+	}
+	for (int lightIndex : keep)
+	{
+		if (!kept[lightIndex])
+		{
+			continue;
+		}
+		std::vector<int>& slots = (m_lights[lightIndex].light.type == LIGHT_SPOT) ? m_spotSlots : m_pointSlots;
+		if (std::find(slots.begin(), slots.end(), lightIndex) == slots.end())
+		{
+			std::vector<int>::iterator freeSlot = std::find(slots.begin(), slots.end(), -1);
+			if (freeSlot != slots.end())
+			{
+				*freeSlot = lightIndex;
+			}
+		}
+	}
+
+	// what is not shaded of the lights in view becomes ambient
+	glm::vec3 folded = glm::vec3(0.0f);
+	int foldedLights = 0;
+	for (int lightIndex : ranked)
+	{
+		const LIGHT_SLOT& slot = m_lights[lightIndex];
+		float share = 1.0f - (kept[lightIndex] ? slot.weight : 0.0f);
+		if (share <= 0.0f)
+		{
+			continue;
+		}
+		float distance = glm::length(slot.light.position - cameraPosition);
+		glm::vec3 color = slot.light.ambient + slot.light.diffuse * g_FoldedDiffuseShare;
+		folded += color * (GetAttenuation(slot.light, distance) * GetConeShare(slot.light) * share);
+		foldedLights++;
+	}
+	folded = glm::min(folded, glm::vec3(g_MaxFoldedAmbient));
+	if (glm::length(folded - m_foldedAmbient) > g_FoldedTolerance)
+	{
+		m_foldedAmbient = folded;
+		bChanged = true;
+	}
+
+	m_updates++;
+	m_candidateLights += (int)ranked.size() + culled;
+	m_shadedLights += (int)std::count(kept.begin(), kept.end(), true);
+	m_foldedLights += foldedLights;
+	m_culledLights += culled;
+	m_selectionChanges += selectionChanges;
+	ReportStatistics();
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  MakeShaded()
+ *
+ *  This method is used for getting the values a light is
+ *  shaded with, its colors scaled by its fade.
+ ***********************************************************/
+LightManager::LIGHT_SOURCE LightManager::MakeShaded(const LIGHT_SLOT& slot)
+{
+	LIGHT_SOURCE shaded = slot.light;
+	float weight = std::min(std::max(slot.weight, 0.0f), 1.0f);
+	shaded.ambient *= weight;
+	shaded.diffuse *= weight;
+	shaded.specular *= weight;
+	return(shaded);
+}
+
+/***********************************************************
+ *  IsSameLight()
+ *
+ *  This method is used for comparing the shader values of
+ *  two lights.
+ ***********************************************************/
+bool LightManager::IsSameLight(const LIGHT_SOURCE& a, const LIGHT_SOURCE& b)
+{
+	return((a.type == b.type) && (a.bEnabled == b.bEnabled) &&
+		(a.position == b.position) && (a.direction == b.direction) &&
+		(a.cutOff == b.cutOff) && (a.outerCutOff == b.outerCutOff) &&
+		(a.constant == b.constant) && (a.linear == b.linear) && (a.quadratic == b.quadratic) &&
+		(a.ambient == b.ambient) && (a.diffuse == b.diffuse) && (a.specular == b.specular));
+}
+
+/***********************************************************
+ *  SetShaderLight()
+ *
+ *  This method is used for setting the values of one light
+ *  slot of the shader, or switching it off.
+ ***********************************************************/
+void LightManager::SetShaderLight(
+	ShaderManager* pShaderManager,
+	const char* arrayName,
+	int slot,
+	const LIGHT_SOURCE* pLight)
+{
+	std::string prefix = std::string(arrayName) + "[" + std::to_string(slot) + "].";
+	if (NULL == pLight)
+	{
+		pShaderManager->setBoolValue(prefix + "bActive", false);
+		return;
+	}
+
+	pShaderManager->setBoolValue(prefix + "bActive", pLight->bEnabled);
+	pShaderManager->setVec3Value(prefix + "position", pLight->position);
+	pShaderManager->setFloatValue(prefix + "constant", pLight->constant);
+	pShaderManager->setFloatValue(prefix + "linear", pLight->linear);
+	pShaderManager->setFloatValue(prefix + "quadratic", pLight->quadratic);
+	pShaderManager->setVec3Value(prefix + "ambient", pLight->ambient);
+	pShaderManager->setVec3Value(prefix + "diffuse", pLight->diffuse);
+	pShaderManager->setVec3Value(prefix + "specular", pLight->specular);
+	if (pLight->type == LIGHT_SPOT)
+	{
+		pShaderManager->setVec3Value(prefix + "direction", pLight->direction);
+		pShaderManager->setFloatValue(prefix + "cutOff", pLight->cutOff);
+		pShaderManager->setFloatValue(prefix + "outerCutOff", pLight->outerCutOff);
+	}
+}
+
+/***********************************************************
+ *  Apply()
+ *
+ *  This method is used for setting the shaded lights and
+ *  the folded ambient term into the scene shader.  Slots
+ *  are only set again when their values changed.
+ ***********************************************************/
+void LightManager::Apply(ShaderManager* pShaderManager)
+{
+	if (NULL == pShaderManager)
+	{
+		return;
+	}
+
+	for (int s = 0; s < POINT_LIGHT_SLOTS; s++)
+	{
+		bool bUsed = (m_pointSlots[s] >= 0);
+		LIGHT_SOURCE shaded;
+		if (bUsed)
+		{
+			shaded = MakeShaded(m_lights[m_pointSlots[s]]);
+		}
+		if (m_bUploadValid && (bUsed == m_bUploadedPoints[s]) &&
+			(!bUsed || IsSameLight(shaded, m_uploadedPoints[s])))
+		{
+			continue;
+		}
+		SetShaderLight(pShaderManager, g_PointLightsName, s, bUsed ? &shaded : NULL);
+		m_bUploadedPoints[s] = bUsed;
+		m_uploadedPoints[s] = shaded;
+	}
+	for (int s = 0; s < SPOT_LIGHT_SLOTS; s++)
+	{
+		bool bUsed = (m_spotSlots[s] >= 0);
+		LIGHT_SOURCE shaded;
+		if (bUsed)
+		{
+			shaded = MakeShaded(m_lights[m_spotSlots[s]]);
+		}
+		if (m_bUploadValid && (bUsed == m_bUploadedSpots[s]) &&
+			(!bUsed || IsSameLight(shaded, m_uploadedSpots[s])))
+		{
+			continue;
+		}
+		SetShaderLight(pShaderManager, g_SpotLightsName, s, bUsed ? &shaded : NULL);
+		m_bUploadedSpots[s] = bUsed;
+		m_uploadedSpots[s] = shaded;
+	}
+	pShaderManager->setVec3Value(g_FoldedAmbientName, m_foldedAmbient);
+
+	m_bUploadValid = true;
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for setting every slot again at the
+ *  next apply, after something else has set the uniforms.
+ ***********************************************************/
+void LightManager::Invalidate()
+{
+	m_bUploadValid = false;
+}
+
+/***********************************************************
+ *  SetLightValue()
+ *
+ *  This method is used for changing one value of a light by
+ *  the name it has in the shader.  Single values are read
+ *  from the first component.
+ ***********************************************************/
+bool LightManager::SetLightValue(LIGHT_SOURCE& light, const std::string& name, glm::vec3 value)
+{
+	if (name == "bActive")
+	{
+		light.bEnabled = (value.x != 0.0f);
+	}
+	else if (name == "position")
+	{
+		light.position = value;
+	}
+	else if ((name == "direction") && (light.type == LIGHT_SPOT))
+	{
+		light.direction = value;
+	}
+	else if ((name == "cutOff") && (light.type == LIGHT_SPOT))
+	{
+		light.cutOff = value.x;
+	}
+	else if ((name == "outerCutOff") && (light.type == LIGHT_SPOT))
+	{
+		light.outerCutOff = value.x;
+	}
+	else if (name == "constant")
+	{
+		light.constant = value.x;
+	}
+	else if (name == "linear")
+	{
+		light.linear = value.x;
+	}
+	else if (name == "quadratic")
+	{
+		light.quadratic = value.x;
+	}
+	else if (name == "ambient")
+	{
+		light.ambient = value;
+	}
+	else if (name == "diffuse")
+	{
+		light.diffuse = value;
+	}
+	else if (name == "specular")
+	{
+		light.specular = value;
+	}
+	else
+	{
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  GetLightRange()
+ *
+ *  This method is used for finding the distance at which a
+ *  light falls off below the cutoff level, by solving its
+ *  falloff for the distance.
+ ***********************************************************/
+float LightManager::GetLightRange(const LIGHT_SOURCE& light)
+{
+	// the falloff at which the light reaches the cutoff
+	float limit = GetBrightness(light) / g_LightCutoff;
+	if (limit <= light.constant)
+	{
+		return(0.0f);
+	}
+
+	if (light.quadratic > 0.0f)
+	{
+		float b = light.linear;
+		float c = light.constant - limit;
+		return((-b + std::sqrt(b * b - 4.0f * light.quadratic * c)) / (2.0f * light.quadratic));
+	}
+	if (light.linear > 0.0f)
+	{
+		return((limit - light.constant) / light.linear);
+	}
+	return(g_UnboundedRange);
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing how many lights were in
+ *  view, shaded and folded per frame, every few seconds.
+ ***********************************************************/
+void LightManager::ReportStatistics()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+	if (elapsed.count() < g_ReportSeconds)
+	{
+		return;
+	}
+
+	if (m_updates > 0)
+	{
+		double updates = (double)m_updates;
+		std::cout << "INFO: Lights per frame - " << m_candidateLights / updates << " in the scene, "
+			<< m_culledLights / updates << " out of view, " << m_shadedLights / updates
+			<< " shaded of a budget of " << m_budget << ", " << m_foldedLights / updates
+			<< " folded into ambient, " << m_selectionChanges << " selection changes" << std::endl;
+	}
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_updates = 0;
+	m_candidateLights = 0;
+	m_shadedLights = 0;
+	m_foldedLights = 0;
+	m_culledLights = 0;
+	m_selectionChanges = 0;
+}
@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmanager.h
+// ============
+// manage the point and spot lights of the scene - importance and light LOD
+//
+//  Every lamp of every loaded room is a light, but the scene shader only
+//  has a few light slots, and each one costs every fragment.  Each frame
+//  the lights are scored by how much they can add to the view, from their
+//  brightness, their falloff and how far they are from the camera, with
+//  lights whose reach misses the view frustum scored zero.  The best lights
+//  within a budget are shaded, the minor ones left over are folded into a
+//  flat ambient term, and lights fade between the two over a short time so
+//  a change of selection does not pop.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  LightManager
+ *
+ *  This class contains the code for scoring the lights of
+ *  the scene and setting the chosen ones into the light
+ *  slots of the scene shader.
+ ***********************************************************/
+class LightManager
+{
+public:
+	// constructor
+	LightManager();
+	// destructor
+	~LightManager();
+
+	// light slots of the scene shader, matching fragmentShader.glsl
+	static const int POINT_LIGHT_SLOTS = 5;
+	static const int SPOT_LIGHT_SLOTS = 4;
+
+	enum LIGHT_TYPE
+	{
+		LIGHT_POINT,
+		LIGHT_SPOT
+	};
+
+	// a light with the values the shader lights it with
+	struct LIGHT_SOURCE
+	{
+		LIGHT_TYPE type;
+		bool bEnabled;
+		glm::vec3 position;
+		// spot lights only, the cone edges as cosines
+		glm::vec3 direction;
+		float cutOff;
+		float outerCutOff;
+		// falloff over distance
+		float constant;
+		float linear;
+		float quadratic;
+		glm::vec3 ambient;
+		glm::vec3 diffuse;
+		glm::vec3 specular;
+	};
+
+private:
+	struct LIGHT_SLOT
+	{
+		LIGHT_SOURCE light;
+		bool bActive;
+		// distance past which the light adds too little to see
+		float range;
+		// importance in the last update, zero when out of view
+		float score;
+		// share of the light shaded, the rest is folded into the
+		// ambient term while it fades
+		float weight;
+		bool bSelected;
+	};
+
+	std::vector<LIGHT_SLOT> m_lights;
+	// largest number of lights shaded at once
+	int m_budget;
+	// seconds a light takes to fade in or out
+	float m_fadeSeconds;
+
+	// the lights in the shader slots, in slot order, and the
+	// folded ambient term, as last set into the shader
+	std::vector<int> m_pointSlots;
+	std::vector<int> m_spotSlots;
+	glm::vec3 m_foldedAmbient;
+	// light values as last set into each shader slot, so only
+	// the slots that changed are set again
+	LIGHT_SOURCE m_uploadedPoints[POINT_LIGHT_SLOTS];
+	LIGHT_SOURCE m_uploadedSpots[SPOT_LIGHT_SLOTS];
+	bool m_bUploadedPoints[POINT_LIGHT_SLOTS];
+	bool m_bUploadedSpots[SPOT_LIGHT_SLOTS];
+	bool m_bUploadValid;
+
+	// statistics, reported every few seconds
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	int m_updates;
+	int m_candidateLights;
+	int m_shadedLights;
+	int m_foldedLights;
+	int m_culledLights;
+	int m_selectionChanges;
+
+	// the light values for a slot, scaled by the share shaded
+	static LIGHT_SOURCE MakeShaded(const LIGHT_SLOT& slot);
+	static bool IsSameLight(const LIGHT_SOURCE& a, const LIGHT_SOURCE& b);
+	// set one shader slot, or switch it off when the light is NULL
+	void SetShaderLight(
+		ShaderManager* pShaderManager,
+		const char* arrayName,
+		int slot,
+		const LIGHT_SOURCE* pLight);
+
+	void ReportStatistics();
+
+public:
+	// add a light and return its index, it is shaded or folded
+	// from the next update without a fade
+	int AddLight(const LIGHT_SOURCE& light);
+	// remove a light, its index may be given to a later light
+	void RemoveLight(int lightIndex);
+	// change the values of a light
+	void SetLight(int lightIndex, const LIGHT_SOURCE& light);
+	const LIGHT_SOURCE* GetLight(int lightIndex) const;
+
+	// set the most lights shaded at once, up to the shader slots
+	void SetBudget(int lightCount);
+	int GetBudget() const;
+	void SetFadeSeconds(float seconds);
+
+	// score the lights for a view, choose the ones shaded and
+	// move their fades by the time passed.  Without a view every
+	// light counts as in view.  Returns true when the lighting
+	// changed since the last update
+	bool Update(
+		const glm::mat4& viewProjection,
+		glm::vec3 cameraPosition,
+		bool bHasView,
+		float deltaSeconds);
+	// set the chosen lights and the folded ambient term into the
+	// scene shader, only the slots changed since the last call
+	void Apply(ShaderManager* pShaderManager);
+	// set every slot again at the next apply, such as after the
+	// shader program or the active scene changed
+	void Invalidate();
+
+	// change one value of a light by its shader name, such as
+	// diffuse or quadratic, returns false for an unknown name
+	static bool SetLightValue(LIGHT_SOURCE& light, const std::string& name, glm::vec3 value);
+	// distance at which a light adds less than a cutoff level
+	static float GetLightRange(const LIGHT_SOURCE& light);
+};
@@ -1,187 +1,989 @@
-///////////////////////////////////////////////////////////////////////////////
-// maincode.cpp
-// ============
-// gets called when application is launched - initializes GLEW, GLFW
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
-
-#include <GL/glew.h>        // GLEW library
-#include "GLFW/glfw3.h"     // GLFW library
-
-// GLM Math Header inclusions
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
-
-#include "SceneManager.h"
-#include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
-
-// Namespace for declaring global variables
-namespace
-{
-	// Macro for window title
-	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
-
-	// Main GLFW window
-	GLFWwindow* g_Window = nullptr;
-
-	// scene manager object for managing the 3D scene prepare and render
-	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
-	// view manager object for managing the 3D view setup and projection to 2D
-	ViewManager* g_ViewManager = nullptr;
-}
-
-// Function declarations - all functions that are called manually
-// need to be pre-declared at the beginning of the source code.
-bool InitializeGLFW();
-bool InitializeGLEW();
-
-
-/***********************************************************
- *  main(int, char*)
- *
- *  This function gets called after the application has been
- *  launched.
- ***********************************************************/
-int main(int argc, char* argv[])
-{
-	// if GLFW fails initialization, then terminate the application
-	if (InitializeGLFW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
-	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
-
-	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
-
-	// if GLEW fails initialization, then terminate the application
-	if (InitializeGLEW() == false)
-	{
-		return(EXIT_FAILURE);
-	}
-
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
-
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
-	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
-
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
-
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
-
-
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
-
-		// query the latest GLFW events
-		glfwPollEvents();
-	}
-
-	// clear the allocated manager objects from memory
-	if (NULL != g_SceneManager)
-	{
-		delete g_SceneManager;
-		g_SceneManager = NULL;
-	}
-	if (NULL != g_ViewManager)
-	{
-		delete g_ViewManager;
-		g_ViewManager = NULL;
-	}
-	if (NULL != g_ShaderManager)
-	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
-	}
-
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
-}
-
-/***********************************************************
- *	InitializeGLFW()
- * 
- *  This function is used to initialize the GLFW library.   
- ***********************************************************/
-bool InitializeGLFW()
-{
-	// GLFW: initialize and configure library
-	// --------------------------------------
-	glfwInit();
-
-#ifdef __APPLE__
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#else
-	// set the version of OpenGL and profile to use
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-#endif
-	// GLFW: end -------------------------------
-
-	return(true);
-}
-
-/***********************************************************
- *	InitializeGLEW()
- *
- *  This function is used to initialize the GLEW library.
- ***********************************************************/
-bool InitializeGLEW()
-{
-	// GLEW: initialize
-	// -----------------------------------------
-	GLenum GLEWInitResult = GLEW_OK;
-
-	// try to initialize the GLEW library
-	GLEWInitResult = glewInit();
-	if (GLEW_OK != GLEWInitResult)
-	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
-		return false;
-	}
-	// GLEW: end -------------------------------
-
-	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
-
-	return(true);
+///////////////////////////////////////////////////////////////////////////////
+// maincode.cpp
+// ============
+// gets called when application is launched - initializes GLEW, GLFW
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>         // error handling and output
+#include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <cstdio>           // sscanf
+#include <ctime>            // capture file names
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>        // GLEW library
+#include "GLFW/glfw3.h"     // GLFW library
+
+// GLM Math Header inclusions
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "AnimationManager.h"
+#include "BatchRenderManager.h"
+#include "CaptureManager.h"
+#include "DebugManager.h"
+#include "GLResourceManager.h"
+#include "GLTraceManager.h"
+#include "GLTraceReplayer.h"
+#include "MemoryManager.h"
+#include "NetworkSocket.h"
+#include "PostProcessManager.h"
+#include "RemoteManager.h"
+#include "RemoteViewer.h"
+#include "RenderTarget.h"
+#include "SamplerManager.h"
+#include "SceneEditManager.h"
+#include "SceneManager.h"
+#include "ShaderBenchmark.h"
+#include "ShaderCompiler.h"
+#include "SpatialManager.h"
+#include "SubmissionBenchmark.h"
+#include "ViewManager.h"
+#include "ShapeMeshes.h"
+#include "ShaderManager.h"
+
+// Namespace for declaring global variables
+namespace
+{
+	// Macro for window title
+	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
+
+	// Main GLFW window
+	GLFWwindow* g_Window = nullptr;
+
+	// scene manager object for managing the 3D scene prepare and render
+	SceneManager* g_SceneManager = nullptr;
+	// shader manager object for dynamic interaction with the shader code
+	ShaderManager* g_ShaderManager = nullptr;
+	// shader compiler object for building the shader programs without
+	// stalling the first frames, and the scene program it builds
+	ShaderCompiler* g_ShaderCompiler = nullptr;
+	int g_SceneProgram = -1;
+	// view manager object for managing the 3D view setup and projection to 2D
+	ViewManager* g_ViewManager = nullptr;
+
+	// scene being prepared in the background before switching to it
+	SceneManager* g_PendingScene = nullptr;
+	// scenes no longer drawn, releasing their resources
+	std::vector<SceneManager*> g_RetiredScenes;
+	// building sizes of the scenes cycled through with the N key
+	const int g_SceneBuildingSizes[][2] = { { 1, 1 }, { 2, 2 }, { 4, 4 } };
+	const int g_SceneBuildingSizeCount = 3;
+	int g_NextSceneIndex = 1;
+	// time per frame given to preparing and releasing scenes
+	const double g_ScenePrepareBudgetMilliseconds = 4.0;
+	const double g_SceneReleaseBudgetMilliseconds = 2.0;
+
+	// capture manager object for saving screenshots and video
+	CaptureManager* g_CaptureManager = nullptr;
+	// frame rate written into recorded video files
+	const int g_VideoFramesPerSecond = 60;
+
+	// remote manager object for streaming frames in server mode
+	RemoteManager* g_RemoteManager = nullptr;
+
+	// scene edit manager object for applying the patches an editing
+	// tool sends to the port set with --edit-port
+	SceneEditManager* g_SceneEditManager = nullptr;
+
+	// offscreen framebuffer the frames of a batch worker are drawn into
+	RenderTarget* g_BatchRenderTarget = nullptr;
+	// animation time of the batch frame being drawn, starting at
+	// ten o'clock and advancing one video frame per frame
+	double g_BatchAnimationSeconds = 0.0;
+	const double g_BatchStartSeconds = 10.0 * 3600.0;
+	const double g_BatchFrameSeconds = 1.0 / 60.0;
+
+	// dust particles per lamp, set with --particles count, and
+	// whether they are kept off the compute shader with --particles-cpu
+	int g_DustParticles = 16384;
+	bool g_bDustOnGPU = true;
+
+	// stream the scene textures a page at a time, set with
+	// --virtual-textures
+	bool g_bVirtualTextures = false;
+
+	// make the wood and marble from patterns, baked at a size with
+	// --procedural-textures size, or drawn by the shader with
+	// --procedural-textures shader
+	SceneManager::PROCEDURAL_MODE g_ProceduralMode = SceneManager::PROCEDURAL_OFF;
+	int g_ProceduralTextureSize = 0;
+
+	// 8 bit levels a texel may change by when its texture is stored
+	// in a smaller format, set with --texture-tolerance levels, where
+	// below zero keeps the textures as decoded and 4 or more allows
+	// 16 bit color
+	int g_TextureFormatTolerance = 3;
+
+	// reflect the rooms in the marble floor, at a fraction of the
+	// frame size set with --reflections scale, and only drawn again
+	// when the camera moves unless every frame must stand alone
+	bool g_bReflections = false;
+	float g_ReflectionScale = 0.5f;
+	bool g_bThrottleReflections = true;
+
+	// most room lights shaded at once, set with --light-budget
+	// count, the rest folded into the ambient light, and the time
+	// lights take to fade in and out as the camera moves
+	int g_LightBudget = 6;
+	float g_LightFadeSeconds = 0.5f;
+
+	// skip the lamps, books and clocks hidden behind the walls with
+	// occlusion queries, set with --occlusion-queries
+	bool g_bOcclusionQueries = false;
+
+	// time a number of the scene draws each frame, set with
+	// --profile-objects count, and print the objects ranked by
+	// GPU cost when the scene is released
+	bool g_bProfileObjects = false;
+	int g_ProfileSamplesPerFrame = 16;
+
+	// write the OpenGL calls of a number of frames to a trace file
+	// for --replay-gl, set with --capture-gl file.gltrace frames
+	std::string g_GLTraceFilename;
+	int g_GLTraceFrames = 300;
+
+	// memory budget in megabytes checked on exit, set with
+	// --memory-budget, and the file the per frame memory use is
+	// written to, set with --memory-series
+	double g_MemoryBudgetMegabytes = 0.0;
+	std::string g_MemorySeriesFilename;
+
+	// draw the scene in HDR and add bloom, tone mapping and color
+	// grading to the frame, set with --post-process
+	bool g_bPostProcess = false;
+	PostProcessManager* g_PostProcessManager = nullptr;
+}
+
+// Function declarations - all functions that are called manually
+// need to be pre-declared at the beginning of the source code.
+bool InitializeGLFW();
+bool InitializeGLEW();
+void UpdateSceneSwitching();
+void UpdateShaderPrograms();
+void UpdateCapture();
+std::string MakeCaptureFilename(const char* prefix, const char* extension);
+bool RenderBatchFrame(int frameIndex, int frameCount, std::vector<unsigned char>& pixels, int& width, int& height);
+
+
+/***********************************************************
+ *  main(int, char*)
+ *
+ *  This function gets called after the application has been
+ *  launched.
+ ***********************************************************/
+int main(int argc, char* argv[])
+{
+	// measure the spatial query throughput instead of
+	// displaying the 3D scene
+	if ((argc > 1) && (strcmp(argv[1], "--bench-spatial") == 0))
+	{
+		SpatialManager::RunBenchmark(10000, 100000);
+		return(EXIT_SUCCESS);
+	}
+
+	// measure the animation update cost instead of displaying
+	// the 3D scene
+	if ((argc > 1) && (strcmp(argv[1], "--bench-animation") == 0))
+	{
+		AnimationManager::RunBenchmark(5000, 1000);
+		return(EXIT_SUCCESS);
+	}
+
+	// show the frames of a remote rendering server instead of
+	// rendering, with --viewer host port [frames [token]]
+	if ((argc > 3) && (strcmp(argv[1], "--viewer") == 0))
+	{
+		if (NetworkSocket::Initialize() == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		RemoteViewer viewer;
+		int result = viewer.Run(
+			argv[2],
+			atoi(argv[3]),
+			(argc > 4) ? atoi(argv[4]) : 0,
+			(argc > 5) ? argv[5] : "");
+		NetworkSocket::Shutdown();
+		return((result == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// run the OpenGL calls written with --capture-gl in a hidden
+	// window and time them instead of rendering, with
+	// --replay-gl file.gltrace [first last [file.csv]]
+	if ((argc > 2) && (strcmp(argv[1], "--replay-gl") == 0))
+	{
+		GLTraceReplayer replayer;
+		int result = replayer.Run(
+			argv[2],
+			(argc > 3) ? atoi(argv[3]) : 0,
+			(argc > 4) ? atoi(argv[4]) : -1,
+			(argc > 5) ? argv[5] : "");
+		return((result == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// render the frames of the camera path across worker processes
+	// into a video file, with --batch-render frames workers file.y4m,
+	// passing the other arguments on to the workers
+	if ((argc > 4) && (strcmp(argv[1], "--batch-render") == 0))
+	{
+		if (NetworkSocket::Initialize() == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		std::vector<std::string> workerArguments(argv + 5, argv + argc);
+		int result = 0;
+		{
+			BatchRenderManager batchRenderManager;
+			result = batchRenderManager.RunCoordinator(
+				argv[0], workerArguments, atoi(argv[2]), atoi(argv[3]), argv[4]);
+		}
+		NetworkSocket::Shutdown();
+		return((result == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// render without showing a window and stream the frames to a
+	// remote viewer, with --server port, to viewers on this machine
+	// unless --server-token token lets in viewers that send it
+	int serverPort = 0;
+	std::string serverToken;
+	// apply scene patches from an editing tool, with --edit-port port
+	int editPort = 0;
+	// render frames for a batch coordinator, with the hidden
+	// --batch-worker port index arguments it starts workers with
+	int batchPort = 0;
+	int batchWorkerIndex = 0;
+	// time the scene shader variants instead of displaying the 3D
+	// scene, with --bench-shaders [file.csv]
+	bool bBenchShaders = false;
+	std::string benchShadersFilename;
+	// time the CPU cost of submitting the scene draws instead, with
+	// --bench-submission [file.csv]
+	bool bBenchSubmission = false;
+	std::string benchSubmissionFilename;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bench-shaders") == 0)
+		{
+			bBenchShaders = true;
+			if ((i < argc - 1) && (strncmp(argv[i + 1], "--", 2) != 0))
+			{
+				benchShadersFilename = argv[i + 1];
+			}
+		}
+		if (strcmp(argv[i], "--bench-submission") == 0)
+		{
+			bBenchSubmission = true;
+			if ((i < argc - 1) && (strncmp(argv[i + 1], "--", 2) != 0))
+			{
+				benchSubmissionFilename = argv[i + 1];
+			}
+		}
+	}
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], "--server") == 0)
+		{
+			serverPort = atoi(argv[i + 1]);
+		}
+		if (strcmp(argv[i], "--server-token") == 0)
+		{
+			serverToken = argv[i + 1];
+		}
+		if (strcmp(argv[i], "--edit-port") == 0)
+		{
+			editPort = atoi(argv[i + 1]);
+		}
+		if (strcmp(argv[i], "--capture-gl") == 0)
+		{
+			g_GLTraceFilename = argv[i + 1];
+			if ((i < argc - 2) && (strncmp(argv[i + 2], "--", 2) != 0))
+			{
+				g_GLTraceFrames = atoi(argv[i + 2]);
+			}
+		}
+		if ((strcmp(argv[i], "--batch-worker") == 0) && (i < argc - 2))
+		{
+			batchPort = atoi(argv[i + 1]);
+			batchWorkerIndex = atoi(argv[i + 2]);
+		}
+	}
+
+	// if GLFW fails initialization, then terminate the application
+	if (InitializeGLFW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// the server, batch workers and benchmarks draw offscreen,
+	// so their window stays hidden
+	if ((serverPort > 0) || (batchPort > 0) || bBenchShaders || bBenchSubmission)
+	{
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	}
+
+	// try to create a new shader manager object
+	g_ShaderManager = new ShaderManager();
+	// try to create a new view manager object
+	g_ViewManager = new ViewManager(
+		g_ShaderManager);
+
+	// try to create the main display window
+	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+
+	// if GLEW fails initialization, then terminate the application
+	if (InitializeGLEW() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	// capture driver performance warnings in debug builds
+	DEBUG_INITIALIZE();
+	// start writing the OpenGL calls before any object is made,
+	// so the trace holds everything its frames use
+	if (!g_GLTraceFilename.empty())
+	{
+		int width = 0;
+		int height = 0;
+		glfwGetFramebufferSize(g_Window, &width, &height);
+		GLTraceManager::StartCapture(g_GLTraceFilename.c_str(), g_GLTraceFrames, width, height);
+	}
+
+	// start compiling the shader code from the external GLSL files,
+	// drawing with the fallback program until it is ready, or load
+	// it the slow way when the fallback program does not compile
+	g_ShaderCompiler = new ShaderCompiler();
+	if (g_ShaderCompiler->Initialize())
+	{
+		g_SceneProgram = g_ShaderCompiler->AddProgram(
+			"scene",
+			"shaders/vertexShader.glsl",
+			"shaders/fragmentShader.glsl");
+	}
+	if (g_SceneProgram < 0)
+	{
+		g_ShaderManager->LoadShaders(
+			"shaders/vertexShader.glsl",
+			"shaders/fragmentShader.glsl");
+	}
+	else
+	{
+		// the benchmarks and batch workers measure and render
+		// the scene shader itself, so they wait for it
+		if (bBenchShaders || bBenchSubmission || (batchPort > 0))
+		{
+			g_ShaderCompiler->WaitForPrograms();
+		}
+		g_ShaderManager->m_programID = g_ShaderCompiler->GetProgram(g_SceneProgram);
+	}
+	g_ShaderManager->use();
+
+	if (bBenchShaders || bBenchSubmission)
+	{
+		int result = 0;
+		if (bBenchShaders)
+		{
+			result = ShaderBenchmark::Run(g_ShaderManager, benchShadersFilename);
+		}
+		if (bBenchSubmission && (result == 0))
+		{
+			result = SubmissionBenchmark::Run(g_ShaderManager, benchSubmissionFilename);
+		}
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+		delete g_ShaderCompiler;
+		g_ShaderCompiler = NULL;
+		glfwTerminate();
+		return((result == 0) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// try to create a new remote manager object in server mode
+	if (serverPort > 0)
+	{
+		g_RemoteManager = new RemoteManager(g_ViewManager);
+		if ((NetworkSocket::Initialize() == false) || (g_RemoteManager->Start(serverPort, serverToken) == false))
+		{
+			return(EXIT_FAILURE);
+		}
+	}
+
+	// try to create a new scene edit manager object for the
+	// editing tool
+	if (editPort > 0)
+	{
+		g_SceneEditManager = new SceneEditManager();
+		if ((NetworkSocket::Initialize() == false) || (g_SceneEditManager->Start(editPort) == false))
+		{
+			return(EXIT_FAILURE);
+		}
+	}
+
+	// try to create a new capture manager object, recording from
+	// the first frame with --record file.y4m
+	g_CaptureManager = new CaptureManager();
+	for (int i = 1; i < argc - 1; i++)
+	{
+		if (strcmp(argv[i], "--record") == 0)
+		{
+			g_CaptureManager->StartVideo(argv[i + 1], g_VideoFramesPerSecond);
+		}
+	}
+
+	// try to create a new scene manager object and prepare the 3D scene
+	g_SceneManager = new SceneManager(g_ShaderManager);
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--particles") == 0) && (i < argc - 1))
+		{
+			g_DustParticles = atoi(argv[i + 1]);
+		}
+		if (strcmp(argv[i], "--particles-cpu") == 0)
+		{
+			g_bDustOnGPU = false;
+		}
+		if (strcmp(argv[i], "--virtual-textures") == 0)
+		{
+			g_bVirtualTextures = true;
+		}
+		if ((strcmp(argv[i], "--procedural-textures") == 0) && (i < argc - 1))
+		{
+			if (strcmp(argv[i + 1], "shader") == 0)
+			{
+				g_ProceduralMode = SceneManager::PROCEDURAL_SHADER;
+			}
+			else
+			{
+				g_ProceduralMode = SceneManager::PROCEDURAL_BAKED;
+				g_ProceduralTextureSize = atoi(argv[i + 1]);
+			}
+		}
+		if ((strcmp(argv[i], "--texture-tolerance") == 0) && (i < argc - 1))
+		{
+			g_TextureFormatTolerance = atoi(argv[i + 1]);
+		}
+		if ((strcmp(argv[i], "--memory-budget") == 0) && (i < argc - 1))
+		{
+			g_MemoryBudgetMegabytes = atof(argv[i + 1]);
+		}
+		if ((strcmp(argv[i], "--memory-series") == 0) && (i < argc - 1))
+		{
+			g_MemorySeriesFilename = argv[i + 1];
+		}
+		if (strcmp(argv[i], "--post-process") == 0)
+		{
+			g_bPostProcess = true;
+		}
+		if ((strcmp(argv[i], "--light-budget") == 0) && (i < argc - 1))
+		{
+			g_LightBudget = atoi(argv[i + 1]);
+		}
+		if (strcmp(argv[i], "--occlusion-queries") == 0)
+		{
+			g_bOcclusionQueries = true;
+		}
+		if (strcmp(argv[i], "--profile-objects") == 0)
+		{
+			g_bProfileObjects = true;
+			if ((i < argc - 1) && (strncmp(argv[i + 1], "--", 2) != 0))
+			{
+				g_ProfileSamplesPerFrame = atoi(argv[i + 1]);
+			}
+		}
+		if (strcmp(argv[i], "--reflections") == 0)
+		{
+			g_bReflections = true;
+			if ((i < argc - 1) && (strncmp(argv[i + 1], "--", 2) != 0))
+			{
+				g_ReflectionScale = (float)atof(argv[i + 1]);
+			}
+		}
+	}
+	// the dust moves from frame to frame, and virtual texture pages
+	// stream in over several frames, so batch frames rendered by
+	// different workers would not match, and both are left out.
+	// A kept reflection or a light fade would also carry over from
+	// the frame before, so the reflection is drawn for every frame
+	// and lights switch at once.  Occlusion answers lag a frame
+	// behind, so they are not used either
+	if (batchPort > 0)
+	{
+		g_DustParticles = 0;
+		g_bVirtualTextures = false;
+		g_bThrottleReflections = false;
+		g_LightFadeSeconds = 0.0f;
+		g_bOcclusionQueries = false;
+	}
+	g_SceneManager->SetDustParticles(g_DustParticles, g_bDustOnGPU);
+	g_SceneManager->SetVirtualTextures(g_bVirtualTextures);
+	g_SceneManager->SetProceduralTextures(g_ProceduralMode, g_ProceduralTextureSize);
+	g_SceneManager->SetTextureFormatTolerance(g_TextureFormatTolerance);
+	g_SceneManager->SetReflections(g_bReflections, g_ReflectionScale, g_bThrottleReflections);
+	g_SceneManager->SetLightBudget(g_LightBudget, g_LightFadeSeconds);
+	g_SceneManager->SetOcclusionQueries(g_bOcclusionQueries);
+	g_SceneManager->SetObjectProfiling(g_bProfileObjects, g_ProfileSamplesPerFrame);
+	// build a grid of rooms, such as --building 4x3
+	for (int i = 1; i < argc - 1; i++)
+	{
+		int width = 1;
+		int depth = 1;
+		if ((strcmp(argv[i], "--building") == 0) &&
+			(sscanf(argv[i + 1], "%dx%d", &width, &depth) == 2))
+		{
+			g_SceneManager->SetBuildingSize(width, depth);
+		}
+	}
+	g_SceneManager->PrepareScene();
+
+	// try to create a new post process manager object, drawing
+	// without it when its shaders do not compile
+	if (g_bPostProcess)
+	{
+		g_PostProcessManager = new PostProcessManager();
+		if (!g_PostProcessManager->Initialize())
+		{
+			delete g_PostProcessManager;
+			g_PostProcessManager = NULL;
+		}
+	}
+
+	// the camera collides with and picks from the scene objects
+	g_ViewManager->SetSpatialManager(g_SceneManager->GetSpatialManager());
+
+	// the run fails when a batch worker fails or the memory
+	// budget is exceeded
+	int runResult = 0;
+	// a batch worker renders the frames it is sent, with the scene
+	// loaded once, and then skips the interactive loop
+	if (batchPort > 0)
+	{
+		g_SceneManager->SetAnimationTimeSource([]() { return(g_BatchAnimationSeconds); });
+		g_BatchRenderTarget = new RenderTarget();
+		if (NetworkSocket::Initialize())
+		{
+			runResult = BatchRenderManager::RunWorker(batchPort, batchWorkerIndex, RenderBatchFrame);
+			NetworkSocket::Shutdown();
+		}
+		else
+		{
+			runResult = 1;
+		}
+		glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+	}
+
+	// loop will keep running until the application is closed 
+	// or until an error has occurred
+	while (!glfwWindowShouldClose(g_Window))
+	{
+		// switch to the scene program once it has compiled
+		UpdateShaderPrograms();
+
+		// prepare the next scene a step at a time, switching to
+		// it between frames once it is ready
+		UpdateSceneSwitching();
+
+		// apply the scene patches received since the last frame
+		if (NULL != g_SceneEditManager)
+		{
+			g_SceneEditManager->Update(g_SceneManager);
+		}
+
+		// draw into the offscreen frame sent to the remote viewer
+		if (NULL != g_RemoteManager)
+		{
+			int width = 0;
+			int height = 0;
+			glfwGetFramebufferSize(g_Window, &width, &height);
+			g_RemoteManager->BeginFrame(width, height);
+		}
+
+		// draw the scene into the HDR target, the finished frame
+		// goes where it would have been drawn
+		if (NULL != g_PostProcessManager)
+		{
+			int width = 0;
+			int height = 0;
+			glfwGetFramebufferSize(g_Window, &width, &height);
+			g_PostProcessManager->BeginFrame(width, height);
+		}
+
+		// Enable z-depth
+		glEnable(GL_DEPTH_TEST);
+
+		// Clear the frame and z buffers
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// convert from 3D object space to 2D view
+		g_ViewManager->PrepareSceneView();
+		// the scene culls and streams rooms from the same view
+		g_SceneManager->SetCameraView(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetCameraPosition());
+
+		// refresh the 3D scene
+		g_SceneManager->RenderScene();
+
+		// add the bloom, tone map and grade the frame
+		if (NULL != g_PostProcessManager)
+		{
+			g_PostProcessManager->EndFrame();
+		}
+
+		// read back the frame for screenshots and video
+		UpdateCapture();
+
+		// send the changed parts of the frame to the remote viewer
+		if (NULL != g_RemoteManager)
+		{
+			g_RemoteManager->EndFrame();
+		}
+
+		// Flips the the back buffer with the front buffer every frame.
+		glfwSwapBuffers(g_Window);
+
+		// query the latest GLFW events
+		glfwPollEvents();
+
+		DEBUG_END_FRAME();
+		MemoryManager::EndFrame();
+		GLResourceManager::EndFrame();
+		GLTraceManager::EndFrame();
+	}
+
+	// finish the trace when the window closed before its frames
+	GLTraceManager::StopCapture();
+
+	// print the driver warnings seen while running
+	DEBUG_REPORT();
+
+	// print where the memory went, and fail the run when it
+	// went over the budget
+	MemoryManager::Report();
+	if (!g_MemorySeriesFilename.empty())
+	{
+		MemoryManager::WriteTimeSeries(g_MemorySeriesFilename);
+	}
+	if ((g_MemoryBudgetMegabytes > 0.0) && !MemoryManager::CheckBudget(g_MemoryBudgetMegabytes))
+	{
+		runResult = 1;
+	}
+
+	// clear the allocated manager objects from memory
+	if (NULL != g_PostProcessManager)
+	{
+		delete g_PostProcessManager;
+		g_PostProcessManager = NULL;
+	}
+	if (NULL != g_BatchRenderTarget)
+	{
+		delete g_BatchRenderTarget;
+		g_BatchRenderTarget = NULL;
+	}
+	if (NULL != g_RemoteManager)
+	{
+		delete g_RemoteManager;
+		g_RemoteManager = NULL;
+		NetworkSocket::Shutdown();
+	}
+	if (NULL != g_SceneEditManager)
+	{
+		delete g_SceneEditManager;
+		g_SceneEditManager = NULL;
+		NetworkSocket::Shutdown();
+	}
+	if (NULL != g_CaptureManager)
+	{
+		delete g_CaptureManager;
+		g_CaptureManager = NULL;
+	}
+	if (NULL != g_PendingScene)
+	{
+		delete g_PendingScene;
+		g_PendingScene = NULL;
+	}
+	for (SceneManager* pScene : g_RetiredScenes)
+	{
+		delete pScene;
+	}
+	g_RetiredScenes.clear();
+	if (NULL != g_SceneManager)
+	{
+		delete g_SceneManager;
+		g_SceneManager = NULL;
+	}
+	if (NULL != g_ViewManager)
+	{
+		delete g_ViewManager;
+		g_ViewManager = NULL;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+	if (NULL != g_ShaderCompiler)
+	{
+		delete g_ShaderCompiler;
+		g_ShaderCompiler = NULL;
+	}
+	SamplerManager::Release();
+
+	// delete the GL objects given back on the way out, and list
+	// those never given back
+	GLResourceManager::Shutdown();
+
+	// Terminates the program successfully
+	exit((runResult == 0) ? EXIT_SUCCESS : EXIT_FAILURE); 
+}
+
+/***********************************************************
+ *	UpdateShaderPrograms()
+ *
+ *  This function is used to check on the shader programs
+ *  being compiled, and to switch the scene from the
+ *  fallback program to its own once it has linked.  The
+ *  uniforms belong to the program, so the scene sets its
+ *  lights and textures again.
+ ***********************************************************/
+void UpdateShaderPrograms()
+{
+	if ((NULL == g_ShaderCompiler) || (g_SceneProgram < 0))
+	{
+		return;
+	}
+
+	g_ShaderCompiler->Update();
+	GLuint program = g_ShaderCompiler->GetProgram(g_SceneProgram);
+	if (program != g_ShaderManager->m_programID)
+	{
+		g_ShaderManager->m_programID = program;
+		g_ShaderManager->use();
+		if (NULL != g_SceneManager)
+		{
+			g_SceneManager->ActivateScene();
+		}
+	}
+}
+
+/***********************************************************
+ *	UpdateSceneSwitching()
+ *
+ *  This function is used to prepare the next scene while
+ *  the current one keeps rendering.  The OpenGL work of
+ *  preparing and releasing scenes is limited per frame, and
+ *  the switch itself happens before a frame is drawn.
+ ***********************************************************/
+void UpdateSceneSwitching()
+{
+	DEBUG_SCOPE("SceneSwitching");
+
+	// start preparing the next scene when asked
+	if (g_ViewManager->ConsumeSceneSwitchRequest() && (NULL == g_PendingScene))
+	{
+		const int* size = g_SceneBuildingSizes[g_NextSceneIndex];
+		std::cout << "INFO: Preparing scene with a " << size[0] << "x" << size[1] << " building" << std::endl;
+
+		g_PendingScene = new SceneManager(g_ShaderManager);
+		g_PendingScene->SetBuildingSize(size[0], size[1]);
+		g_PendingScene->SetDustParticles(g_DustParticles, g_bDustOnGPU);
+		g_PendingScene->SetVirtualTextures(g_bVirtualTextures);
+		g_PendingScene->SetProceduralTextures(g_ProceduralMode, g_ProceduralTextureSize);
+		g_PendingScene->SetTextureFormatTolerance(g_TextureFormatTolerance);
+		g_PendingScene->SetReflections(g_bReflections, g_ReflectionScale, g_bThrottleReflections);
+		g_PendingScene->SetLightBudget(g_LightBudget, g_LightFadeSeconds);
+		g_PendingScene->SetOcclusionQueries(g_bOcclusionQueries);
+		g_PendingScene->SetObjectProfiling(g_bProfileObjects, g_ProfileSamplesPerFrame);
+		g_PendingScene->BeginPrepareScene();
+		g_NextSceneIndex = (g_NextSceneIndex + 1) % g_SceneBuildingSizeCount;
+	}
+
+	// switch once the next scene is ready
+	if ((NULL != g_PendingScene) &&
+		g_PendingScene->ContinuePrepareScene(g_ScenePrepareBudgetMilliseconds))
+	{
+		g_RetiredScenes.push_back(g_SceneManager);
+		g_SceneManager = g_PendingScene;
+		g_PendingScene = NULL;
+
+		g_SceneManager->ActivateScene();
+		g_ViewManager->SetSpatialManager(g_SceneManager->GetSpatialManager());
+		std::cout << "INFO: Switched scene" << std::endl;
+	}
+
+	// release the old scenes a little each frame
+	for (int i = (int)g_RetiredScenes.size() - 1; i >= 0; i--)
+	{
+		if (g_RetiredScenes[i]->ReleaseScene(g_SceneReleaseBudgetMilliseconds))
+		{
+			delete g_RetiredScenes[i];
+			g_RetiredScenes.erase(g_RetiredScenes.begin() + i);
+		}
+	}
+}
+
+/***********************************************************
+ *	UpdateCapture()
+ *
+ *  This function is used to start the captures asked for
+ *  with the keyboard and to read back the rendered frame.
+ ***********************************************************/
+void UpdateCapture()
+{
+	DEBUG_SCOPE("Capture");
+
+	if (g_ViewManager->ConsumeScreenshotRequest())
+	{
+		g_CaptureManager->RequestScreenshot(MakeCaptureFilename("screenshot", ".png"));
+	}
+	if (g_ViewManager->ConsumeRecordToggleRequest())
+	{
+		if (g_CaptureManager->IsRecording())
+		{
+			g_CaptureManager->StopVideo();
+		}
+		else
+		{
+			g_CaptureManager->StartVideo(MakeCaptureFilename("capture", ".y4m"), g_VideoFramesPerSecond);
+		}
+	}
+
+	int width = 0;
+	int height = 0;
+	glfwGetFramebufferSize(g_Window, &width, &height);
+	g_CaptureManager->CaptureFrame(width, height);
+}
+
+/***********************************************************
+ *	RenderBatchFrame()
+ *
+ *  This function is used to render one frame of the camera
+ *  path for a batch coordinator.  Every room near the camera
+ *  is loaded first and the animation follows the frame
+ *  number, so the frame is the same whichever worker
+ *  renders it.
+ ***********************************************************/
+bool RenderBatchFrame(int frameIndex, int frameCount, std::vector<unsigned char>& pixels, int& width, int& height)
+{
+	glm::vec3 position;
+	glm::vec3 target;
+	BatchRenderManager::GetCameraPose(frameIndex, frameCount, position, target);
+	g_ViewManager->SetCameraPose(position, target);
+	g_BatchAnimationSeconds = g_BatchStartSeconds + frameIndex * g_BatchFrameSeconds;
+
+	glfwGetFramebufferSize(g_Window, &width, &height);
+	g_BatchRenderTarget->Resize(width, height);
+	g_BatchRenderTarget->Bind();
+	if (NULL != g_PostProcessManager)
+	{
+		g_PostProcessManager->BeginFrame(width, height);
+	}
+
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	g_ViewManager->PrepareSceneView();
+	g_SceneManager->SetCameraView(
+		g_ViewManager->GetViewMatrix(),
+		g_ViewManager->GetProjectionMatrix(),
+		g_ViewManager->GetCameraPosition());
+	g_SceneManager->FinishRoomStreaming();
+	g_SceneManager->RenderScene();
+	if (NULL != g_PostProcessManager)
+	{
+		g_PostProcessManager->EndFrame();
+	}
+
+	g_BatchRenderTarget->ReadPixels(pixels);
+	g_BatchRenderTarget->Unbind();
+	DEBUG_END_FRAME();
+	MemoryManager::EndFrame();
+	GLResourceManager::EndFrame();
+	return((width > 0) && (height > 0));
+}
+
+/***********************************************************
+ *	MakeCaptureFilename()
+ *
+ *  This function is used to build a capture file name from
+ *  the current date and time.
+ ***********************************************************/
+std::string MakeCaptureFilename(const char* prefix, const char* extension)
+{
+	time_t now = time(0);
+	tm timeinfo;
+	localtime_s(&timeinfo, &now);
+
+	char stamp[32];
+	strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &timeinfo);
+	return(std::string(prefix) + "_" + stamp + extension);
+}
+
+/***********************************************************
+ *	InitializeGLFW()
+ * 
+ *  This function is used to initialize the GLFW library.   
+ ***********************************************************/
+bool InitializeGLFW()
+{
+	// GLFW: initialize and configure library
+	// --------------------------------------
+	glfwInit();
+
+#ifdef __APPLE__
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#else
+	// set the version of OpenGL and profile to use
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+#ifdef GL_DEBUG_LAYER
+	// drivers give the most detailed warnings to debug contexts
+	glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+	// GLFW: end -------------------------------
+
+	return(true);
+}
+
+/***********************************************************
+ *	InitializeGLEW()
+ *
+ *  This function is used to initialize the GLEW library.
+ ***********************************************************/
+bool InitializeGLEW()
+{
+	// GLEW: initialize
+	// -----------------------------------------
+	GLenum GLEWInitResult = GLEW_OK;
+
+	// try to initialize the GLEW library
+	GLEWInitResult = glewInit();
+	if (GLEW_OK != GLEWInitResult)
+	{
+		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		return false;
+	}
+	// GLEW: end -------------------------------
+
+	// Displays a successful OpenGL initialization message
+	std::cout << "INFO: OpenGL Successfully Initialized\n";
+	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+
+	return(true);
 }
\ No newline at end of file
@@ -0,0 +1,419 @@
+///////////////////////////////////////////////////////////////////////////////
+// memorymanager.cpp
+// ============
+// account for memory use - CPU allocations, GL buffers and textures by owner
+//
+//  Accounts are found by subsystem and asset name the first time they are
+//  charged and kept after they drop to zero, so the report still shows the
+//  peak of assets that have been released.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MemoryManager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	const char* g_KindNames[MemoryManager::MEMORY_KIND_COUNT] =
+	{
+		"CPU",
+		"GPU buffers",
+		"GPU textures"
+	};
+
+	// memory charged to one asset of a subsystem
+	struct MEMORY_ACCOUNT
+	{
+		std::string subsystem;
+		std::string asset;
+		size_t bytes[MemoryManager::MEMORY_KIND_COUNT];
+		// most memory the asset held at once, of all kinds
+		size_t peakBytes;
+	};
+
+	// a GL buffer or texture and the account it is charged to
+	struct GL_OBJECT
+	{
+		int account;
+		size_t bytes;
+	};
+
+	// totals at the end of a frame
+	struct MEMORY_SAMPLE
+	{
+		unsigned int frame;
+		size_t bytes[MemoryManager::MEMORY_KIND_COUNT];
+	};
+
+	std::mutex g_MemoryMutex;
+	std::vector<MEMORY_ACCOUNT> g_Accounts;
+	std::map<std::string, int> g_AccountIndex;
+	std::map<GLuint, GL_OBJECT> g_Buffers;
+	std::map<GLuint, GL_OBJECT> g_Textures;
+	size_t g_CurrentBytes[MemoryManager::MEMORY_KIND_COUNT] = { 0 };
+	size_t g_PeakKindBytes[MemoryManager::MEMORY_KIND_COUNT] = { 0 };
+	size_t g_PeakBytes = 0;
+	unsigned int g_PeakFrame = 0;
+	std::vector<MEMORY_SAMPLE> g_Samples;
+	unsigned int g_FrameNumber = 0;
+
+	// accounts listed in the report, the rest are summed up
+	const int g_ReportedAccounts = 40;
+
+	// finds or creates an account, with the lock held
+	int FindAccount(const char* subsystem, const std::string& asset)
+	{
+		std::string key = std::string(subsystem) + "/" + asset;
+		std::map<std::string, int>::iterator found = g_AccountIndex.find(key);
+		if (found != g_AccountIndex.end())
+		{
+			return(found->second);
+		}
+
+		MEMORY_ACCOUNT account;
+		account.subsystem = subsystem;
+		account.asset = asset;
+		for (int kind = 0; kind < MemoryManager::MEMORY_KIND_COUNT; kind++)
+		{
+			account.bytes[kind] = 0;
+		}
+		account.peakBytes = 0;
+		g_Accounts.push_back(account);
+		g_AccountIndex[key] = (int)g_Accounts.size() - 1;
+		return((int)g_Accounts.size() - 1);
+	}
+
+	// moves the memory of an account to a new size, with the lock held
+	void SetAccountBytes(int accountIndex, MemoryManager::MEMORY_KIND kind, size_t bytes)
+	{
+		MEMORY_ACCOUNT& account = g_Accounts[accountIndex];
+		g_CurrentBytes[kind] = g_CurrentBytes[kind] - account.bytes[kind] + bytes;
+		account.bytes[kind] = bytes;
+
+		size_t accountTotal = 0;
+		size_t total = 0;
+		for (int k = 0; k < MemoryManager::MEMORY_KIND_COUNT; k++)
+		{
+			accountTotal += account.bytes[k];
+			total += g_CurrentBytes[k];
+		}
+		account.peakBytes = std::max(account.peakBytes, accountTotal);
+		g_PeakKindBytes[kind] = std::max(g_PeakKindBytes[kind], g_CurrentBytes[kind]);
+		if (total > g_PeakBytes)
+		{
+			g_PeakBytes = total;
+			g_PeakFrame = g_FrameNumber;
+		}
+	}
+
+	void TrackObject(
+		std::map<GLuint, GL_OBJECT>& objects,
+		MemoryManager::MEMORY_KIND kind,
+		GLuint name,
+		const char* subsystem,
+		const std::string& asset,
+		size_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(g_MemoryMutex);
+		std::map<GLuint, GL_OBJECT>::iterator found = objects.find(name);
+		if (found != objects.end())
+		{
+			GL_OBJECT& object = found->second;
+			SetAccountBytes(object.account, kind, g_Accounts[object.account].bytes[kind] - object.bytes);
+		}
+
+		GL_OBJECT object;
+		object.account = FindAccount(subsystem, asset);
+		object.bytes = bytes;
+		SetAccountBytes(object.account, kind, g_Accounts[object.account].bytes[kind] + bytes);
+		objects[name] = object;
+	}
+
+	void ReleaseObject(std::map<GLuint, GL_OBJECT>& objects, MemoryManager::MEMORY_KIND kind, GLuint name)
+	{
+		std::lock_guard<std::mutex> lock(g_MemoryMutex);
+		std::map<GLuint, GL_OBJECT>::iterator found = objects.find(name);
+		if (found != objects.end())
+		{
+			GL_OBJECT& object = found->second;
+			SetAccountBytes(object.account, kind, g_Accounts[object.account].bytes[kind] - object.bytes);
+			objects.erase(found);
+		}
+	}
+
+	std::string FormatBytes(size_t bytes)
+	{
+		std::ostringstream text;
+		text << std::fixed << std::setprecision(2);
+		if (bytes >= 1024 * 1024)
+		{
+			text << bytes / (1024.0 * 1024.0) << " MB";
+		}
+		else
+		{
+			text << bytes / 1024.0 << " KB";
+		}
+		return(text.str());
+	}
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for charging memory to an asset.
+ ***********************************************************/
+void MemoryManager::Allocate(const char* subsystem, const std::string& asset, MEMORY_KIND kind, size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(g_MemoryMutex);
+	int accountIndex = FindAccount(subsystem, asset);
+	SetAccountBytes(accountIndex, kind, g_Accounts[accountIndex].bytes[kind] + bytes);
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for returning memory charged to an
+ *  asset.  More than was charged is never returned.
+ ***********************************************************/
+void MemoryManager::Release(const char* subsystem, const std::string& asset, MEMORY_KIND kind, size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(g_MemoryMutex);
+	int accountIndex = FindAccount(subsystem, asset);
+	size_t current = g_Accounts[accountIndex].bytes[kind];
+	SetAccountBytes(accountIndex, kind, current - std::min(current, bytes));
+}
+
+/***********************************************************
+ *  SetUsage()
+ *
+ *  This method is used for setting the memory of an asset
+ *  to its current size.
+ ***********************************************************/
+void MemoryManager::SetUsage(const char* subsystem, const std::string& asset, MEMORY_KIND kind, size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(g_MemoryMutex);
+	SetAccountBytes(FindAccount(subsystem, asset), kind, bytes);
+}
+
+/***********************************************************
+ *  TrackBuffer()
+ *
+ *  This method is used for charging the storage of a GL
+ *  buffer, again each time its storage is replaced.
+ ***********************************************************/
+void MemoryManager::TrackBuffer(GLuint buffer, const char* subsystem, const std::string& asset, size_t bytes)
+{
+	TrackObject(g_Buffers, GPU_BUFFER, buffer, subsystem, asset, bytes);
+}
+
+/***********************************************************
+ *  ReleaseBuffer()
+ *
+ *  This method is used for returning the storage of a GL
+ *  buffer about to be deleted.
+ ***********************************************************/
+void MemoryManager::ReleaseBuffer(GLuint buffer)
+{
+	ReleaseObject(g_Buffers, GPU_BUFFER, buffer);
+}
+
+/***********************************************************
+ *  TrackTexture()
+ *
+ *  This method is used for charging the storage of a GL
+ *  texture by its name.
+ ***********************************************************/
+void MemoryManager::TrackTexture(GLuint texture, const char* subsystem, const std::string& asset, size_t bytes)
+{
+	TrackObject(g_Textures, GPU_TEXTURE, texture, subsystem, asset, bytes);
+}
+
+/***********************************************************
+ *  ReleaseTexture()
+ *
+ *  This method is used for returning the storage of a GL
+ *  texture about to be deleted.
+ ***********************************************************/
+void MemoryManager::ReleaseTexture(GLuint texture)
+{
+	ReleaseObject(g_Textures, GPU_TEXTURE, texture);
+}
+
+/***********************************************************
+ *  GetTextureBytes()
+ *
+ *  This method is used for working out the storage of a 2D
+ *  texture, adding each mipmap level when it has them.
+ ***********************************************************/
+size_t MemoryManager::GetTextureBytes(int width, int height, int bytesPerTexel, bool bMipmaps)
+{
+	size_t bytes = 0;
+	while ((width > 0) && (height > 0))
+	{
+		bytes += (size_t)width * height * bytesPerTexel;
+		if (!bMipmaps || ((width == 1) && (height == 1)))
+		{
+			break;
+		}
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+	return(bytes);
+}
+
+/***********************************************************
+ *  GetCurrentBytes()
+ *
+ *  This method is used for getting the memory in use of
+ *  one kind.
+ ***********************************************************/
+size_t MemoryManager::GetCurrentBytes(MEMORY_KIND kind)
+{
+	std::lock_guard<std::mutex> lock(g_MemoryMutex);
+	return(g_CurrentBytes[kind]);
+}
+
+/***********************************************************
+ *  GetPeakBytes()
+ *
+ *  This method is used for getting the most memory of all
+ *  kinds in use at once.
+ ***********************************************************/
+size_t MemoryManager::GetPeakBytes()
+{
+	std::lock_guard<std::mutex> lock(g_MemoryMutex);
+	return(g_PeakBytes);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for adding the totals at the end of
+ *  a frame to the time series.
+ ***********************************************************/
+void MemoryManager::EndFrame()
+{
+	std::lock_guard<std::mutex> lock(g_MemoryMutex);
+	MEMORY_SAMPLE sample;
+	sample.frame = g_FrameNumber;
+	for (int kind = 0; kind < MEMORY_KIND_COUNT; kind++)
+	{
+		sample.bytes[kind] = g_CurrentBytes[kind];
+	}
+	g_Samples.push_back(sample);
+	g_FrameNumber++;
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the totals and the
+ *  assets using the most memory, then those that peaked
+ *  highest among the rest.
+ ***********************************************************/
+void MemoryManager::Report()
+{
+	std::lock_guard<std::mutex> lock(g_MemoryMutex);
+
+	std::cout << "INFO: Memory - peak " << FormatBytes(g_PeakBytes) << " at frame " << g_PeakFrame << std::endl;
+	for (int kind = 0; kind < MEMORY_KIND_COUNT; kind++)
+	{
+		std::cout << "    " << std::left << std::setw(14) << g_KindNames[kind] << std::right
+			<< " current " << FormatBytes(g_CurrentBytes[kind])
+			<< ", peak " << FormatBytes(g_PeakKindBytes[kind]) << std::endl;
+	}
+
+	std::vector<int> order(g_Accounts.size());
+	for (int i = 0; i < (int)order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [](int a, int b)
+		{
+			const MEMORY_ACCOUNT& first = g_Accounts[a];
+			const MEMORY_ACCOUNT& second = g_Accounts[b];
+			size_t firstTotal = first.bytes[0] + first.bytes[1] + first.bytes[2];
+			size_t secondTotal = second.bytes[0] + second.bytes[1] + second.bytes[2];
+			if (firstTotal != secondTotal)
+			{
+				return(firstTotal > secondTotal);
+			}
+			return(first.peakBytes > second.peakBytes);
+		});
+
+	int listed = std::min((int)order.size(), g_ReportedAccounts);
+	for (int i = 0; i < listed; i++)
+	{
+		const MEMORY_ACCOUNT& account = g_Accounts[order[i]];
+		std::cout << "    " << account.subsystem << "/" << account.asset << ":";
+		bool bReleased = true;
+		for (int kind = 0; kind < MEMORY_KIND_COUNT; kind++)
+		{
+			if (account.bytes[kind] > 0)
+			{
+				std::cout << " " << g_KindNames[kind] << " " << FormatBytes(account.bytes[kind]);
+				bReleased = false;
+			}
+		}
+		if (bReleased)
+		{
+			std::cout << " released";
+		}
+		std::cout << " (peak " << FormatBytes(account.peakBytes) << ")" << std::endl;
+	}
+	if ((int)order.size() > listed)
+	{
+		std::cout << "    and " << order.size() - listed << " smaller assets" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  WriteTimeSeries()
+ *
+ *  This method is used for writing the totals of every
+ *  frame to a CSV file, one frame per line.
+ ***********************************************************/
+bool MemoryManager::WriteTimeSeries(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(g_MemoryMutex);
+
+	std::ofstream file(filename.c_str());
+	if (!file.is_open())
+	{
+		std::cout << "Could not write memory time series " << filename << std::endl;
+		return(false);
+	}
+
+	file << "frame,cpu_bytes,gpu_buffer_bytes,gpu_texture_bytes,total_bytes\n";
+	for (const MEMORY_SAMPLE& sample : g_Samples)
+	{
+		file << sample.frame << "," << sample.bytes[CPU_MEMORY] << "," << sample.bytes[GPU_BUFFER]
+			<< "," << sample.bytes[GPU_TEXTURE] << ","
+			<< sample.bytes[CPU_MEMORY] + sample.bytes[GPU_BUFFER] + sample.bytes[GPU_TEXTURE] << "\n";
+	}
+	std::cout << "INFO: Memory time series of " << g_Samples.size() << " frames written to " << filename << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  CheckBudget()
+ *
+ *  This method is used for checking that the peak memory
+ *  stayed within a budget.
+ ***********************************************************/
+bool MemoryManager::CheckBudget(double budgetMegabytes)
+{
+	size_t peakBytes = GetPeakBytes();
+	bool bWithinBudget = (peakBytes <= (size_t)(budgetMegabytes * 1024.0 * 1024.0));
+	std::cout << (bWithinBudget ? "INFO: Memory peak " : "Memory peak ") << FormatBytes(peakBytes)
+		<< (bWithinBudget ? " is within the " : " is over the ") << budgetMegabytes << " MB budget" << std::endl;
+	return(bWithinBudget);
+}
@@ -0,0 +1,66 @@
+///////////////////////////////////////////////////////////////////////////////
+// memorymanager.h
+// ============
+// account for memory use - CPU allocations, GL buffers and textures by owner
+//
+//  Every tracked allocation is charged to a subsystem, such as "Textures",
+//  and an asset in it, such as the image file.  Current and peak use are
+//  kept per asset and in total, a sample of the totals is taken each frame,
+//  and a sorted report is printed on exit.  A memory budget given on the
+//  command line turns the report into a pass or fail for automated runs.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <string>
+
+/***********************************************************
+ *  MemoryManager
+ *
+ *  This class contains the code for the memory accounts.
+ *  Allocations come from many places, including worker
+ *  threads, so everything is static and locked.
+ ***********************************************************/
+class MemoryManager
+{
+public:
+	// where the memory lives
+	enum MEMORY_KIND
+	{
+		CPU_MEMORY,
+		GPU_BUFFER,
+		GPU_TEXTURE,
+		MEMORY_KIND_COUNT
+	};
+
+	// add and remove memory charged to an asset
+	static void Allocate(const char* subsystem, const std::string& asset, MEMORY_KIND kind, size_t bytes);
+	static void Release(const char* subsystem, const std::string& asset, MEMORY_KIND kind, size_t bytes);
+	// set the memory of an asset, for containers that grow and shrink
+	static void SetUsage(const char* subsystem, const std::string& asset, MEMORY_KIND kind, size_t bytes);
+
+	// charge a GL buffer or texture by its name, replacing what it was
+	// charged before, so only the name is needed to release it
+	static void TrackBuffer(GLuint buffer, const char* subsystem, const std::string& asset, size_t bytes);
+	static void ReleaseBuffer(GLuint buffer);
+	static void TrackTexture(GLuint texture, const char* subsystem, const std::string& asset, size_t bytes);
+	static void ReleaseTexture(GLuint texture);
+	// size of a 2D texture, with its mipmaps when it has them
+	static size_t GetTextureBytes(int width, int height, int bytesPerTexel, bool bMipmaps);
+
+	// current and peak use, of one kind or of all of them
+	static size_t GetCurrentBytes(MEMORY_KIND kind);
+	static size_t GetPeakBytes();
+
+	// take a sample of the totals for the time series
+	static void EndFrame();
+	// print the assets using the most memory first
+	static void Report();
+	// write the per frame totals as CSV
+	static bool WriteTimeSeries(const std::string& filename);
+	// check the peak against a budget, printing the result
+	static bool CheckBudget(double budgetMegabytes);
+};
@@ -0,0 +1,388 @@
+///////////////////////////////////////////////////////////////////////////////
+// networksocket.cpp
+// ============
+// wrap a TCP socket - listening, connecting, sending and receiving
+///////////////////////////////////////////////////////////////////////////////
+
+#include "NetworkSocket.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+typedef SOCKET NATIVE_SOCKET;
+typedef int SOCKET_LENGTH;
+#define CloseNativeSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NATIVE_SOCKET;
+typedef socklen_t SOCKET_LENGTH;
+#define INVALID_SOCKET (-1)
+#define CloseNativeSocket close
+#endif
+
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// number of connections that may wait to be accepted
+	const int g_ListenBacklog = 4;
+	// a peer closing the connection is reported as an error
+	// instead of a signal that ends the process
+#ifdef MSG_NOSIGNAL
+	const int g_SendFlags = MSG_NOSIGNAL;
+#else
+	const int g_SendFlags = 0;
+#endif
+
+	NATIVE_SOCKET ToNative(intptr_t handle)
+	{
+		return((NATIVE_SOCKET)handle);
+	}
+}
+
+/***********************************************************
+ *  NetworkSocket()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+NetworkSocket::NetworkSocket()
+{
+	m_handle = -1;
+}
+
+/***********************************************************
+ *  ~NetworkSocket()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+NetworkSocket::~NetworkSocket()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for starting the socket library
+ *  before any socket is used.
+ ***********************************************************/
+bool NetworkSocket::Initialize()
+{
+#ifdef _WIN32
+	WSADATA data;
+	if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+	{
+		std::cout << "Could not start Winsock" << std::endl;
+		return(false);
+	}
+#endif
+	return(true);
+}
+
+/***********************************************************
+ *  Shutdown()
+ *
+ *  This method is used for stopping the socket library once
+ *  all sockets are closed.
+ ***********************************************************/
+void NetworkSocket::Shutdown()
+{
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+/***********************************************************
+ *  Listen()
+ *
+ *  This method is used for listening for connections on a
+ *  TCP port.
+ ***********************************************************/
+bool NetworkSocket::Listen(int port, bool bLoopbackOnly)
+{
+	Close();
+
+	NATIVE_SOCKET handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (handle == INVALID_SOCKET)
+	{
+		return(false);
+	}
+
+	// allow the port to be reused right after a restart
+	int reuse = 1;
+	setsockopt(handle, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons((unsigned short)port);
+	address.sin_addr.s_addr = htonl(bLoopbackOnly ? INADDR_LOOPBACK : INADDR_ANY);
+
+	if ((bind(handle, (sockaddr*)&address, sizeof(address)) != 0) ||
+		(listen(handle, g_ListenBacklog) != 0))
+	{
+		std::cout << "Could not listen on port " << port << std::endl;
+		CloseNativeSocket(handle);
+		return(false);
+	}
+
+	m_handle = (intptr_t)handle;
+	return(true);
+}
+
+/***********************************************************
+ *  Accept()
+ *
+ *  This method is used for accepting a connection that is
+ *  waiting, without blocking when there is none.
+ ***********************************************************/
+bool NetworkSocket::Accept(NetworkSocket& client)
+{
+	if (!IsOpen() || !WaitReadable(0))
+	{
+		return(false);
+	}
+
+	NATIVE_SOCKET handle = accept(ToNative(m_handle), NULL, NULL);
+	if (handle == INVALID_SOCKET)
+	{
+		return(false);
+	}
+
+	client.Close();
+	client.m_handle = (intptr_t)handle;
+	return(true);
+}
+
+/***********************************************************
+ *  Connect()
+ *
+ *  This method is used for connecting to a listening socket
+ *  by host name or address.
+ ***********************************************************/
+bool NetworkSocket::Connect(const std::string& host, int port)
+{
+	Close();
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	addrinfo* pResults = NULL;
+	std::string service = std::to_string(port);
+	if (getaddrinfo(host.c_str(), service.c_str(), &hints, &pResults) != 0)
+	{
+		std::cout << "Could not resolve host " << host << std::endl;
+		return(false);
+	}
+
+	for (addrinfo* pResult = pResults; pResult != NULL; pResult = pResult->ai_next)
+	{
+		NATIVE_SOCKET handle = socket(pResult->ai_family, pResult->ai_socktype, pResult->ai_protocol);
+		if (handle == INVALID_SOCKET)
+		{
+			continue;
+		}
+		if (connect(handle, pResult->ai_addr, (SOCKET_LENGTH)pResult->ai_addrlen) == 0)
+		{
+			m_handle = (intptr_t)handle;
+			break;
+		}
+		CloseNativeSocket(handle);
+	}
+	freeaddrinfo(pResults);
+
+	if (!IsOpen())
+	{
+		std::cout << "Could not connect to " << host << ":" << port << std::endl;
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for closing the socket.
+ ***********************************************************/
+void NetworkSocket::Close()
+{
+	if (IsOpen())
+	{
+		CloseNativeSocket(ToNative(m_handle));
+		m_handle = -1;
+	}
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method is used for checking whether the socket is
+ *  open.
+ ***********************************************************/
+bool NetworkSocket::IsOpen() const
+{
+	return(m_handle != -1);
+}
+
+/***********************************************************
+ *  GetPort()
+ *
+ *  This method is used for getting the local port of the
+ *  socket, which the system picks when listening on port 0.
+ ***********************************************************/
+int NetworkSocket::GetPort() const
+{
+	sockaddr_in address;
+	SOCKET_LENGTH length = sizeof(address);
+	memset(&address, 0, sizeof(address));
+	if (getsockname(ToNative(m_handle), (sockaddr*)&address, &length) != 0)
+	{
+		return(0);
+	}
+	return(ntohs(address.sin_port));
+}
+
+/***********************************************************
+ *  SendAll()
+ *
+ *  This method is used for sending all of the passed bytes,
+ *  blocking until the last one is sent.
+ ***********************************************************/
+bool NetworkSocket::SendAll(const void* data, size_t size)
+{
+	const char* pBytes = (const char*)data;
+	while (size > 0)
+	{
+		int sent = (int)send(ToNative(m_handle), pBytes, (int)size, g_SendFlags);
+		if (sent <= 0)
+		{
+			return(false);
+		}
+		pBytes += sent;
+		size -= sent;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  SendSome()
+ *
+ *  This method is used for sending as many of the passed
+ *  bytes as fit in the send buffer, on a socket that does
+ *  not block.  Returns the number sent, 0 when the buffer
+ *  is full and -1 on error.
+ ***********************************************************/
+int NetworkSocket::SendSome(const void* data, size_t size)
+{
+	int sent = (int)send(ToNative(m_handle), (const char*)data, (int)size, g_SendFlags);
+	if (sent < 0)
+	{
+#ifdef _WIN32
+		bool bWouldBlock = (WSAGetLastError() == WSAEWOULDBLOCK);
+#else
+		bool bWouldBlock = ((errno == EAGAIN) || (errno == EWOULDBLOCK));
+#endif
+		return(bWouldBlock ? 0 : -1);
+	}
+	return(sent);
+}
+
+/***********************************************************
+ *  ReceiveAll()
+ *
+ *  This method is used for receiving exactly the passed
+ *  number of bytes, blocking until they have arrived.
+ ***********************************************************/
+bool NetworkSocket::ReceiveAll(void* data, size_t size)
+{
+	char* pBytes = (char*)data;
+	while (size > 0)
+	{
+		int received = ReceiveSome(pBytes, size);
+		if (received <= 0)
+		{
+			return(false);
+		}
+		pBytes += received;
+		size -= received;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  ReceiveSome()
+ *
+ *  This method is used for receiving the bytes available,
+ *  up to the passed size.  Returns the number received,
+ *  0 when the peer has closed and -1 on error.
+ ***********************************************************/
+int NetworkSocket::ReceiveSome(void* data, size_t size)
+{
+	int received = (int)recv(ToNative(m_handle), (char*)data, (int)size, 0);
+	return((received < 0) ? -1 : received);
+}
+
+/***********************************************************
+ *  WaitReadable()
+ *
+ *  This method is used for waiting until the socket has data
+ *  to read, or a connection to accept.  A timeout of zero
+ *  only checks.
+ ***********************************************************/
+bool NetworkSocket::WaitReadable(int timeoutMilliseconds)
+{
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET(ToNative(m_handle), &readSet);
+
+	timeval timeout;
+	timeout.tv_sec = timeoutMilliseconds / 1000;
+	timeout.tv_usec = (timeoutMilliseconds % 1000) * 1000;
+
+	int ready = select((int)ToNative(m_handle) + 1, &readSet, NULL, NULL, &timeout);
+	return(ready > 0);
+}
+
+/***********************************************************
+ *  SetNoDelay()
+ *
+ *  This method is used for turning off the batching of
+ *  small messages, which would add latency to input events.
+ ***********************************************************/
+void NetworkSocket::SetNoDelay()
+{
+	int noDelay = 1;
+	setsockopt(ToNative(m_handle), IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+}
+
+/***********************************************************
+ *  SetNonBlocking()
+ *
+ *  This method is used for making sends and receives return
+ *  right away instead of waiting, so a slow peer cannot hold
+ *  up the caller.
+ ***********************************************************/
+void NetworkSocket::SetNonBlocking()
+{
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	ioctlsocket(ToNative(m_handle), FIONBIO, &nonBlocking);
+#else
+	int flags = fcntl(ToNative(m_handle), F_GETFL, 0);
+	fcntl(ToNative(m_handle), F_SETFL, flags | O_NONBLOCK);
+#endif
+}
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// networksocket.h
+// ============
+// wrap a TCP socket - listening, connecting, sending and receiving
+//
+//  Winsock is used on Windows and BSD sockets elsewhere, behind the same
+//  small interface, so the remote modes work the same on both.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/***********************************************************
+ *  NetworkSocket
+ *
+ *  This class contains the code for one TCP socket, either
+ *  listening for connections or connected to a peer.
+ ***********************************************************/
+class NetworkSocket
+{
+public:
+	// constructor
+	NetworkSocket();
+	// destructor
+	~NetworkSocket();
+
+	// start and stop the socket library, once per process
+	static bool Initialize();
+	static void Shutdown();
+
+private:
+	// native socket handle, -1 when closed
+	intptr_t m_handle;
+
+	// sockets own their handle and cannot be copied
+	NetworkSocket(const NetworkSocket&);
+	NetworkSocket& operator=(const NetworkSocket&);
+
+public:
+	// listen for connections on a port, on the loopback address only
+	// unless asked otherwise
+	bool Listen(int port, bool bLoopbackOnly);
+	// accept a waiting connection without blocking
+	bool Accept(NetworkSocket& client);
+	// connect to a listening socket
+	bool Connect(const std::string& host, int port);
+	// close the socket
+	void Close();
+	bool IsOpen() const;
+	// port the socket is bound to, useful after listening on port 0
+	int GetPort() const;
+
+	// send all of the passed bytes, blocking until they are sent
+	bool SendAll(const void* data, size_t size);
+	// send what fits without waiting, returns 0 when nothing fits
+	// and -1 on error, for sockets that do not block
+	int SendSome(const void* data, size_t size);
+	// receive exactly the passed number of bytes
+	bool ReceiveAll(void* data, size_t size);
+	// receive what is available, returns 0 when closed and -1 on error
+	int ReceiveSome(void* data, size_t size);
+	// wait until data can be read, true when it can
+	bool WaitReadable(int timeoutMilliseconds);
+	// send small messages right away instead of batching them
+	void SetNoDelay();
+	// make sends return instead of waiting for room to send
+	void SetNonBlocking();
+};
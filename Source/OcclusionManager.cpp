@@ -0,0 +1,558 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionmanager.cpp
+// ============
+// skip hidden groups of objects with GPU occlusion queries - conditional render
+//
+//  Each assembly has a small ring of queries, one per frame, so a query is
+//  never issued again while its answer may still be on the way.  Answers
+//  are only read once OpenGL reports them available.  An assembly known to
+//  be hidden is drawn under conditional render on the query issued in the
+//  frame before, without waiting, so the GPU draws it when that answer is
+//  not in yet and the frame is never wrong for longer than the one frame
+//  the query lags.  A camera inside a box sees the box clipped away, so an
+//  assembly the camera stands in is always drawn.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "OcclusionManager.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_OcclusionVertexShader = "shaders/occlusionVertex.glsl";
+	const char* g_OcclusionFragmentShader = "shaders/occlusionFragment.glsl";
+
+	// vertices of the twelve triangles of a box
+	const int g_BoxVertices = 36;
+	// the boxes are grown a little, so the objects inside never
+	// cover their own box
+	const float g_BoxMargin = 0.05f;
+	// an assembly is drawn without a query while the camera is
+	// this close to its box, where the near plane would cut it
+	const float g_NearMargin = 0.5f;
+	// frames an assembly found visible is drawn before it is
+	// queried again
+	const int g_VisibleQueryInterval = 8;
+
+	const double g_ReportSeconds = 5.0;
+}
+
+/***********************************************************
+ *  OcclusionManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+OcclusionManager::OcclusionManager()
+{
+	m_bInitialized = false;
+	m_viewProjectionLocation = -1;
+	m_boxCenterLocation = -1;
+	m_boxSizeLocation = -1;
+	m_frame = 0;
+	m_cameraPosition = glm::vec3(0.0f);
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_frames = 0;
+	m_assembliesDrawn = 0;
+	m_queriesIssued = 0;
+	m_queriesSaved = 0;
+	m_conditionalDraws = 0;
+	m_drawsSkipped = 0;
+	m_resultsLate = 0;
+}
+
+/***********************************************************
+ *  ~OcclusionManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+OcclusionManager::~OcclusionManager()
+{
+	Release();
+}
+
+/***********************************************************
+ *  CompileShaderFile()
+ *
+ *  This method is used for reading and compiling a shader
+ *  file.  Returns 0 when it could not be compiled.
+ ***********************************************************/
+GLuint OcclusionManager::CompileShaderFile(GLenum type, const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open shader file " << filename << std::endl;
+		return(0);
+	}
+	std::stringstream source;
+	source << file.rdbuf();
+	std::string text = source.str();
+	const char* pText = text.c_str();
+
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &pText, NULL);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		std::cout << "Could not compile shader file " << filename << "\n" << log << std::endl;
+		glDeleteShader(shader);
+		return(0);
+	}
+	return(shader);
+}
+
+/***********************************************************
+ *  LinkProgram()
+ *
+ *  This method is used for linking compiled shaders into a
+ *  program.  The shaders are freed, and 0 is returned when
+ *  the program could not be linked.
+ ***********************************************************/
+GLuint OcclusionManager::LinkProgram(GLuint firstShader, GLuint secondShader)
+{
+	if ((firstShader == 0) || (secondShader == 0))
+	{
+		glDeleteShader(firstShader);
+		glDeleteShader(secondShader);
+		return(0);
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, firstShader);
+	glAttachShader(program, secondShader);
+	glLinkProgram(program);
+	glDeleteShader(firstShader);
+	glDeleteShader(secondShader);
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		glGetProgramInfoLog(program, sizeof(log), NULL, log);
+		std::cout << "Could not link occlusion program\n" << log << std::endl;
+		glDeleteProgram(program);
+		return(0);
+	}
+	return(program);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for compiling the box program and
+ *  creating the queries of the assemblies added so far.
+ *  Returns false when the program does not compile.
+ ***********************************************************/
+bool OcclusionManager::Initialize()
+{
+	if (m_bInitialized)
+	{
+		return(true);
+	}
+
+	m_boxProgram.Adopt(LinkProgram(
+		CompileShaderFile(GL_VERTEX_SHADER, g_OcclusionVertexShader),
+		CompileShaderFile(GL_FRAGMENT_SHADER, g_OcclusionFragmentShader)), "Occlusion");
+	if (!m_boxProgram.IsValid())
+	{
+		return(false);
+	}
+	m_viewProjectionLocation = glGetUniformLocation(m_boxProgram.Get(), "viewProjection");
+	m_boxCenterLocation = glGetUniformLocation(m_boxProgram.Get(), "boxCenter");
+	m_boxSizeLocation = glGetUniformLocation(m_boxProgram.Get(), "boxSize");
+	m_boxArray.Create("Occlusion");
+
+	for (ASSEMBLY& assembly : m_assemblies)
+	{
+		glGenQueries(QUERY_FRAMES, assembly.queries);
+	}
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_bInitialized = true;
+
+	std::cout << "INFO: Hidden lamps, books and clocks are skipped with occlusion queries" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  IsInitialized()
+ *
+ *  This method is used for checking whether the box program
+ *  was made.
+ ***********************************************************/
+bool OcclusionManager::IsInitialized() const
+{
+	return(m_bInitialized);
+}
+
+/***********************************************************
+ *  AddAssembly()
+ *
+ *  This method is used for adding an assembly with its
+ *  world space bounds.  The slot and queries of a removed
+ *  assembly are reused.
+ ***********************************************************/
+int OcclusionManager::AddAssembly(const SpatialManager::AABB& bounds)
+{
+	int assemblyIndex = -1;
+	for (int i = 0; i < (int)m_assemblies.size(); i++)
+	{
+		if (!m_assemblies[i].bActive)
+		{
+			assemblyIndex = i;
+			break;
+		}
+	}
+	if (assemblyIndex == -1)
+	{
+		ASSEMBLY assembly;
+		for (int q = 0; q < QUERY_FRAMES; q++)
+		{
+			assembly.queries[q] = 0;
+		}
+		if (m_bInitialized)
+		{
+			glGenQueries(QUERY_FRAMES, assembly.queries);
+		}
+		m_assemblies.push_back(assembly);
+		assemblyIndex = (int)m_assemblies.size() - 1;
+	}
+
+	ASSEMBLY& assembly = m_assemblies[assemblyIndex];
+	assembly.bounds = bounds;
+	assembly.bActive = true;
+	for (int q = 0; q < QUERY_FRAMES; q++)
+	{
+		assembly.queryFrames[q] = -1;
+		assembly.bQueryUsed[q] = false;
+	}
+	assembly.lastQuery = -1;
+	assembly.lastQueryFrame = -1;
+	assembly.bVisible = true;
+	assembly.resultFrame = -1;
+	assembly.bQueryDue = false;
+	assembly.bConditional = false;
+
+	return(assemblyIndex);
+}
+
+/***********************************************************
+ *  RemoveAssembly()
+ *
+ *  This method is used for removing an assembly.  Answers
+ *  still on the way for its queries are dropped.
+ ***********************************************************/
+void OcclusionManager::RemoveAssembly(int assemblyIndex)
+{
+	if (assemblyIndex < 0 || assemblyIndex >= (int)m_assemblies.size())
+	{
+		return;
+	}
+
+	m_assemblies[assemblyIndex].bActive = false;
+	m_assemblies[assemblyIndex].bQueryDue = false;
+}
+
+/***********************************************************
+ *  SetAssemblyBounds()
+ *
+ *  This method is used for changing the bounds of an
+ *  assembly whose objects moved.
+ ***********************************************************/
+void OcclusionManager::SetAssemblyBounds(int assemblyIndex, const SpatialManager::AABB& bounds)
+{
+	if (assemblyIndex < 0 || assemblyIndex >= (int)m_assemblies.size())
+	{
+		return;
+	}
+
+	m_assemblies[assemblyIndex].bounds = bounds;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for reading the query answers that
+ *  have arrived, and starting a frame seen from a camera.
+ ***********************************************************/
+void OcclusionManager::BeginFrame(glm::vec3 cameraPosition)
+{
+	ReportStatistics();
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	CollectResults();
+	m_frame++;
+	m_frames++;
+	m_cameraPosition = cameraPosition;
+}
+
+/***********************************************************
+ *  CollectResults()
+ *
+ *  This method is used for reading the answers OpenGL has
+ *  ready, without waiting for the others.  The newest one
+ *  read decides whether an assembly is visible.
+ ***********************************************************/
+void OcclusionManager::CollectResults()
+{
+	for (ASSEMBLY& assembly : m_assemblies)
+	{
+		if (!assembly.bActive)
+		{
+			continue;
+		}
+
+		for (int q = 0; q < QUERY_FRAMES; q++)
+		{
+			if (assembly.queryFrames[q] < 0)
+			{
+				continue;
+			}
+
+			GLuint available = 0;
+			glGetQueryObjectuiv(assembly.queries[q], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+			{
+				continue;
+			}
+
+			GLuint anySamples = 0;
+			glGetQueryObjectuiv(assembly.queries[q], GL_QUERY_RESULT, &anySamples);
+			if (assembly.queryFrames[q] > assembly.resultFrame)
+			{
+				assembly.bVisible = (anySamples != 0);
+				assembly.resultFrame = assembly.queryFrames[q];
+			}
+			// a draw made conditional on a hidden answer was skipped
+			if (assembly.bQueryUsed[q] && (anySamples == 0))
+			{
+				m_drawsSkipped++;
+			}
+			assembly.queryFrames[q] = -1;
+			assembly.bQueryUsed[q] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  BeginAssembly()
+ *
+ *  This method is used for starting the draws of an
+ *  assembly.  An assembly last seen hidden is drawn under
+ *  conditional render on its newest query, and one last
+ *  seen visible is drawn as it is, queried again only
+ *  every few frames.
+ ***********************************************************/
+void OcclusionManager::BeginAssembly(int assemblyIndex)
+{
+	if (assemblyIndex < 0 || assemblyIndex >= (int)m_assemblies.size())
+	{
+		return;
+	}
+
+	ASSEMBLY& assembly = m_assemblies[assemblyIndex];
+	assembly.bConditional = false;
+	assembly.bQueryDue = false;
+	m_assembliesDrawn++;
+	if (!m_bInitialized || !assembly.bActive)
+	{
+		return;
+	}
+
+	// the camera in or at the box would see the box clipped away
+	glm::vec3 nearest = glm::clamp(m_cameraPosition, assembly.bounds.min, assembly.bounds.max);
+	if (glm::length(m_cameraPosition - nearest) <= g_NearMargin)
+	{
+		assembly.bVisible = true;
+		return;
+	}
+
+	if (assembly.bVisible && (assembly.resultFrame >= 0) &&
+		(m_frame - assembly.lastQueryFrame < g_VisibleQueryInterval))
+	{
+		m_queriesSaved++;
+		return;
+	}
+
+	assembly.bQueryDue = true;
+	// only the query of the frame before is close enough to trust
+	if (!assembly.bVisible && (assembly.lastQuery >= 0) && (assembly.lastQueryFrame >= m_frame - 1))
+	{
+		glBeginConditionalRender(assembly.queries[assembly.lastQuery], GL_QUERY_NO_WAIT);
+		assembly.bQueryUsed[assembly.lastQuery] = true;
+		assembly.bConditional = true;
+		m_conditionalDraws++;
+	}
+}
+
+/***********************************************************
+ *  EndAssembly()
+ *
+ *  This method is used for ending the draws of an assembly.
+ ***********************************************************/
+void OcclusionManager::EndAssembly(int assemblyIndex)
+{
+	if (assemblyIndex < 0 || assemblyIndex >= (int)m_assemblies.size())
+	{
+		return;
+	}
+
+	if (m_assemblies[assemblyIndex].bConditional)
+	{
+		glEndConditionalRender();
+		m_assemblies[assemblyIndex].bConditional = false;
+	}
+}
+
+/***********************************************************
+ *  IssueQueries()
+ *
+ *  This method is used for drawing the box of each assembly
+ *  due a query inside its query, against the depth of the
+ *  frame, with color and depth writes off.  The program and
+ *  state of the caller are put back afterwards.
+ ***********************************************************/
+void OcclusionManager::IssueQueries(const glm::mat4& viewProjection)
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	bool bAnyDue = false;
+	for (const ASSEMBLY& assembly : m_assemblies)
+	{
+		bAnyDue = bAnyDue || (assembly.bActive && assembly.bQueryDue);
+	}
+	if (!bAnyDue)
+	{
+		return;
+	}
+
+	GLint program = 0;
+	GLint vertexArray = 0;
+	GLboolean bDepthMask = GL_TRUE;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+	glGetBooleanv(GL_DEPTH_WRITEMASK, &bDepthMask);
+
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	glDepthMask(GL_FALSE);
+	glUseProgram(m_boxProgram.Get());
+	glBindVertexArray(m_boxArray.Get());
+	glUniformMatrix4fv(m_viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+
+	int slot = m_frame % QUERY_FRAMES;
+	for (ASSEMBLY& assembly : m_assemblies)
+	{
+		if (!assembly.bActive || !assembly.bQueryDue)
+		{
+			continue;
+		}
+
+		// the answer of the frames before was never read in time
+		if (assembly.queryFrames[slot] >= 0)
+		{
+			m_resultsLate++;
+		}
+
+		glm::vec3 center = (assembly.bounds.min + assembly.bounds.max) * 0.5f;
+		glm::vec3 size = (assembly.bounds.max - assembly.bounds.min) + glm::vec3(2.0f * g_BoxMargin);
+		glUniform3fv(m_boxCenterLocation, 1, glm::value_ptr(center));
+		glUniform3fv(m_boxSizeLocation, 1, glm::value_ptr(size));
+
+		glBeginQuery(GL_ANY_SAMPLES_PASSED, assembly.queries[slot]);
+		glDrawArrays(GL_TRIANGLES, 0, g_BoxVertices);
+		glEndQuery(GL_ANY_SAMPLES_PASSED);
+
+		assembly.queryFrames[slot] = m_frame;
+		assembly.bQueryUsed[slot] = false;
+		assembly.lastQuery = slot;
+		assembly.lastQueryFrame = m_frame;
+		assembly.bQueryDue = false;
+		m_queriesIssued++;
+	}
+
+	glBindVertexArray(vertexArray);
+	glUseProgram(program);
+	glDepthMask(bDepthMask);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing how many queries were
+ *  issued and how many draws they skipped, every few
+ *  seconds.
+ ***********************************************************/
+void OcclusionManager::ReportStatistics()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+	if (elapsed.count() < g_ReportSeconds)
+	{
+		return;
+	}
+
+	if (m_frames > 0)
+	{
+		double frames = (double)m_frames;
+		std::cout << "INFO: Occlusion per frame - " << m_assembliesDrawn / frames << " assemblies, "
+			<< m_queriesIssued / frames << " queries issued, " << m_queriesSaved / frames
+			<< " saved while visible, " << m_conditionalDraws / frames << " conditional draws, "
+			<< m_drawsSkipped / frames << " skipped by the GPU, " << m_resultsLate
+			<< " answers not read in time" << std::endl;
+	}
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_frames = 0;
+	m_assembliesDrawn = 0;
+	m_queriesIssued = 0;
+	m_queriesSaved = 0;
+	m_conditionalDraws = 0;
+	m_drawsSkipped = 0;
+	m_resultsLate = 0;
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for deleting the queries and the box
+ *  program.
+ ***********************************************************/
+void OcclusionManager::Release()
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	for (ASSEMBLY& assembly : m_assemblies)
+	{
+		glDeleteQueries(QUERY_FRAMES, assembly.queries);
+		for (int q = 0; q < QUERY_FRAMES; q++)
+		{
+			assembly.queries[q] = 0;
+			assembly.queryFrames[q] = -1;
+		}
+	}
+	m_assemblies.clear();
+	m_boxProgram.Reset();
+	m_boxArray.Reset();
+	m_bInitialized = false;
+}
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+// occlusionmanager.h
+// ============
+// skip hidden groups of objects with GPU occlusion queries - conditional render
+//
+//  Groups of objects that are costly to draw, such as a lamp, a book or a
+//  clock, are assemblies with one bounding box.  After the frame is drawn
+//  the boxes of the assemblies are drawn into the depth buffer inside
+//  occlusion queries, without writing anything, and in the next frame an
+//  assembly found hidden is drawn under conditional rendering on its query,
+//  so the GPU skips it without the CPU waiting for the answer.  Assemblies
+//  found visible are drawn as they are and only queried again now and then,
+//  since what was seen in one frame is nearly always seen in the next.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceManager.h"
+#include "SpatialManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <vector>
+
+/***********************************************************
+ *  OcclusionManager
+ *
+ *  This class contains the code for the occlusion queries of
+ *  the assemblies and drawing them under conditional render.
+ ***********************************************************/
+class OcclusionManager
+{
+public:
+	// constructor
+	OcclusionManager();
+	// destructor
+	~OcclusionManager();
+
+private:
+	// queries of an assembly, a few frames deep so reading them
+	// never waits
+	static const int QUERY_FRAMES = 3;
+
+	struct ASSEMBLY
+	{
+		SpatialManager::AABB bounds;
+		bool bActive;
+		GLuint queries[QUERY_FRAMES];
+		// frame each query was issued in, -1 once it was read, and
+		// whether a draw was made conditional on it
+		int queryFrames[QUERY_FRAMES];
+		bool bQueryUsed[QUERY_FRAMES];
+		// query issued last and its frame, -1 when there is none
+		int lastQuery;
+		int lastQueryFrame;
+		// answer of the newest query read, and its frame
+		bool bVisible;
+		int resultFrame;
+		// whether the assembly is queried after this frame, and
+		// whether it is drawn under conditional render
+		bool bQueryDue;
+		bool bConditional;
+	};
+
+	bool m_bInitialized;
+	// program drawing the boxes, made from the vertex number
+	// with an empty vertex array, and nothing written
+	GLProgram m_boxProgram;
+	GLVertexArray m_boxArray;
+	GLint m_viewProjectionLocation;
+	GLint m_boxCenterLocation;
+	GLint m_boxSizeLocation;
+
+	std::vector<ASSEMBLY> m_assemblies;
+	int m_frame;
+	glm::vec3 m_cameraPosition;
+
+	// statistics, reported every few seconds
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	int m_frames;
+	int m_assembliesDrawn;
+	int m_queriesIssued;
+	int m_queriesSaved;
+	int m_conditionalDraws;
+	int m_drawsSkipped;
+	int m_resultsLate;
+
+	// compile a shader file and link programs
+	static GLuint CompileShaderFile(GLenum type, const char* filename);
+	static GLuint LinkProgram(GLuint firstShader, GLuint secondShader);
+
+	// read the query answers that have arrived
+	void CollectResults();
+	void ReportStatistics();
+
+public:
+	// compile the box program and make the queries ready
+	bool Initialize();
+	bool IsInitialized() const;
+
+	// add an assembly with its world space bounds and return its
+	// index, it is drawn as it is until its first query answers
+	int AddAssembly(const SpatialManager::AABB& bounds);
+	// remove an assembly, its queries are kept for a later one
+	void RemoveAssembly(int assemblyIndex);
+	// change the bounds of an assembly whose objects moved
+	void SetAssemblyBounds(int assemblyIndex, const SpatialManager::AABB& bounds);
+
+	// read the answers that have arrived and start a frame seen
+	// from a camera position
+	void BeginFrame(glm::vec3 cameraPosition);
+	// start drawing an assembly, under conditional render when
+	// its last query found it hidden
+	void BeginAssembly(int assemblyIndex);
+	void EndAssembly(int assemblyIndex);
+	// draw the boxes of the assemblies due a query against the
+	// depth of the frame, after everything else was drawn
+	void IssueQueries(const glm::mat4& viewProjection);
+
+	// delete the queries and the box program
+	void Release();
+};
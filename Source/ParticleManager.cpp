@@ -0,0 +1,910 @@
+///////////////////////////////////////////////////////////////////////////////
+// particlemanager.cpp
+// ============
+// manage particle effects - simulated on the GPU and drawn as billboards
+//
+//  The CPU update follows the compute shader step for step, using the same
+//  integer hash for its random numbers, so both paths move the particles
+//  the same way.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ParticleManager.h"
+#include "MemoryManager.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// SSE2 is part of every x64 processor
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PARTICLE_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const char* g_ParticleVertexShader = "shaders/particleVertex.glsl";
+	const char* g_ParticleFragmentShader = "shaders/particleFragment.glsl";
+	const char* g_ParticleComputeShader = "shaders/particleCompute.glsl";
+
+	// position and life, then velocity and emitter, per particle
+	const int g_ParticleFloats = 8;
+	const int g_ParticleStateBytes = g_ParticleFloats * sizeof(float);
+	// particles moved by one compute shader work group
+	const int g_ComputeGroupSize = 256;
+	// uniform buffer binding point of the emitters, shared by the
+	// compute and draw programs
+	const char* g_EmitterBlockName = "Emitters";
+	const GLuint g_EmitterBlockBinding = 0;
+
+	// random push and drag applied to every particle, and how fast
+	// they settle toward the floor
+	const float g_ParticleJitter = 0.3f;
+	const float g_ParticleDamping = 0.5f;
+	const float g_ParticleSettle = 0.002f;
+
+	// time between statistics reports
+	const double g_ReportSeconds = 5.0;
+
+	const float g_TwoPi = 6.2831853f;
+
+	// names of the uniforms in the order of ParticleManager::UNIFORM,
+	// for both programs, each of which uses some of them
+	const char* g_UniformNames[] =
+	{
+		"particleCount",
+		"frameNumber",
+		"deltaTime",
+		"jitter",
+		"damping",
+		"view",
+		"projection"
+	};
+
+	// look up the uniforms of a program once, after it links, -1
+	// for those it does not use, and point its emitter block at
+	// the emitter buffer
+	void FindUniformLocations(GLuint program, int count, GLint* pLocations)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			pLocations[i] = (program != 0) ? glGetUniformLocation(program, g_UniformNames[i]) : -1;
+		}
+		if (program != 0)
+		{
+			GLuint blockIndex = glGetUniformBlockIndex(program, g_EmitterBlockName);
+			if (blockIndex != GL_INVALID_INDEX)
+			{
+				glUniformBlockBinding(program, blockIndex, g_EmitterBlockBinding);
+			}
+		}
+	}
+
+	// the same integer hash as the compute shader
+	uint32_t Hash(uint32_t x)
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352dU;
+		x ^= x >> 15;
+		x *= 0x846ca68bU;
+		x ^= x >> 16;
+		return(x);
+	}
+
+	float Random(uint32_t& state)
+	{
+		state = Hash(state);
+		return((float)(state >> 8) * (1.0f / 16777216.0f));
+	}
+
+#ifdef PARTICLE_USE_SSE
+	// SSE2 has no 32 bit multiply, so the even and odd lanes are
+	// multiplied as 64 bit values and put back together
+	__m128i Multiply4(__m128i a, __m128i b)
+	{
+		__m128i even = _mm_mul_epu32(a, b);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+		return(_mm_unpacklo_epi32(
+			_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+			_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0))));
+	}
+
+	__m128i Hash4(__m128i x)
+	{
+		x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+		x = Multiply4(x, _mm_set1_epi32(0x7feb352d));
+		x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+		x = Multiply4(x, _mm_set1_epi32((int)0x846ca68bU));
+		x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+		return(x);
+	}
+
+	__m128 Random4(__m128i& state)
+	{
+		state = Hash4(state);
+		return(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(state, 8)), _mm_set1_ps(1.0f / 16777216.0f)));
+	}
+#endif
+}
+
+/***********************************************************
+ *  ParticleManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ParticleManager::ParticleManager()
+{
+	m_particleCount = 0;
+	m_particleCapacity = 0;
+	m_bEmittersChanged = false;
+	m_frameNumber = 0;
+	m_bInitialized = false;
+	m_bUseCompute = false;
+	m_currentBuffer = 0;
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		m_timerQueries[f][0] = 0;
+		m_timerQueries[f][1] = 0;
+		m_bTimerPending[f][0] = false;
+		m_bTimerPending[f][1] = false;
+	}
+	m_timerFrame = 0;
+	FindUniformLocations(0, UNIFORM_COUNT, m_renderLocations);
+	FindUniformLocations(0, UNIFORM_COUNT, m_computeLocations);
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_updateMilliseconds = 0.0;
+	m_renderMilliseconds = 0.0;
+	m_updateSamples = 0;
+	m_renderSamples = 0;
+	m_cpuMemoryBytes = 0;
+}
+
+/***********************************************************
+ *  ~ParticleManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ParticleManager::~ParticleManager()
+{
+	if (m_bInitialized)
+	{
+		glDeleteQueries(TIMER_FRAMES * 2, &m_timerQueries[0][0]);
+	}
+	MemoryManager::Release("Particles", "CPU state", MemoryManager::CPU_MEMORY, m_cpuMemoryBytes);
+}
+
+/***********************************************************
+ *  CompileShaderFile()
+ *
+ *  This method is used for reading and compiling a shader
+ *  file.  Returns 0 when it could not be compiled.
+ ***********************************************************/
+GLuint ParticleManager::CompileShaderFile(GLenum type, const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open shader file " << filename << std::endl;
+		return(0);
+	}
+	std::stringstream source;
+	source << file.rdbuf();
+	std::string text = source.str();
+	const char* pText = text.c_str();
+
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &pText, NULL);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		std::cout << "Could not compile shader file " << filename << "\n" << log << std::endl;
+		glDeleteShader(shader);
+		return(0);
+	}
+	return(shader);
+}
+
+/***********************************************************
+ *  LinkProgram()
+ *
+ *  This method is used for linking compiled shaders into a
+ *  program.  The shaders are freed, and 0 is returned when
+ *  the program could not be linked.
+ ***********************************************************/
+GLuint ParticleManager::LinkProgram(GLuint firstShader, GLuint secondShader)
+{
+	if (firstShader == 0)
+	{
+		return(0);
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, firstShader);
+	if (secondShader != 0)
+	{
+		glAttachShader(program, secondShader);
+	}
+	glLinkProgram(program);
+	glDeleteShader(firstShader);
+	if (secondShader != 0)
+	{
+		glDeleteShader(secondShader);
+	}
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		glGetProgramInfoLog(program, sizeof(log), NULL, log);
+		std::cout << "Could not link particle program\n" << log << std::endl;
+		glDeleteProgram(program);
+		return(0);
+	}
+	return(program);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for compiling the particle programs
+ *  and creating the buffers.  The compute update is used
+ *  when OpenGL 4.3 is available and it compiles.
+ ***********************************************************/
+bool ParticleManager::Initialize(bool bAllowCompute)
+{
+	if (m_bInitialized)
+	{
+		return(true);
+	}
+
+	GLuint vertexShader = CompileShaderFile(GL_VERTEX_SHADER, g_ParticleVertexShader);
+	GLuint fragmentShader = CompileShaderFile(GL_FRAGMENT_SHADER, g_ParticleFragmentShader);
+	if ((vertexShader == 0) || (fragmentShader == 0))
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return(false);
+	}
+	m_renderProgram.Adopt(LinkProgram(vertexShader, fragmentShader), "Particles");
+	if (!m_renderProgram.IsValid())
+	{
+		return(false);
+	}
+	FindUniformLocations(m_renderProgram.Get(), UNIFORM_COUNT, m_renderLocations);
+
+	m_bUseCompute = bAllowCompute && (GLEW_VERSION_4_3 || GLEW_ARB_compute_shader);
+	if (m_bUseCompute)
+	{
+		m_computeProgram.Adopt(LinkProgram(CompileShaderFile(GL_COMPUTE_SHADER, g_ParticleComputeShader), 0), "Particles");
+		m_bUseCompute = m_computeProgram.IsValid();
+		FindUniformLocations(m_computeProgram.Get(), UNIFORM_COUNT, m_computeLocations);
+	}
+
+	m_vertexArrays[0].Create("Particles");
+	m_vertexArrays[1].Create("Particles");
+	m_indirectBuffer.Create("Particles");
+	m_emitterBuffer.Create("Particles");
+	glBindBuffer(GL_UNIFORM_BUFFER, m_emitterBuffer.Get());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(EMITTER_BLOCK), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	MemoryManager::TrackBuffer(m_emitterBuffer.Get(), "Particles", "emitter buffer", sizeof(EMITTER_BLOCK));
+	glGenQueries(TIMER_FRAMES * 2, &m_timerQueries[0][0]);
+
+	m_bInitialized = true;
+	m_bEmittersChanged = true;
+	std::cout << "INFO: Particles are moved on the " << (m_bUseCompute ? "GPU" : "CPU") << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  IsUsingCompute()
+ *
+ *  This method is used for checking whether the particles
+ *  are moved by the compute shader.
+ ***********************************************************/
+bool ParticleManager::IsUsingCompute() const
+{
+	return(m_bUseCompute);
+}
+
+/***********************************************************
+ *  AddEmitter()
+ *
+ *  This method is used for adding an emitter.  The slot and
+ *  particles of a removed emitter of the same size are
+ *  reused.  Returns -1 when there is no free slot.
+ ***********************************************************/
+int ParticleManager::AddEmitter(const EMITTER& emitter)
+{
+	int emitterIndex = -1;
+	for (int i = 0; i < (int)m_emitters.size(); i++)
+	{
+		if (!m_emitters[i].bActive && (m_emitters[i].emitter.particleCount == emitter.particleCount))
+		{
+			emitterIndex = i;
+			break;
+		}
+	}
+
+	if (emitterIndex == -1)
+	{
+		if ((int)m_emitters.size() >= MAX_EMITTERS)
+		{
+			std::cout << "Could not add particle emitter, all " << MAX_EMITTERS << " are in use" << std::endl;
+			return(-1);
+		}
+		EMITTER_SLOT slot;
+		slot.firstParticle = m_particleCount;
+		m_emitters.push_back(slot);
+		emitterIndex = (int)m_emitters.size() - 1;
+		m_particleCount += emitter.particleCount;
+	}
+
+	EMITTER_SLOT& slot = m_emitters[emitterIndex];
+	slot.emitter = emitter;
+	slot.emitter.direction = glm::normalize(emitter.direction);
+	slot.bActive = true;
+	slot.bReset = true;
+	m_bEmittersChanged = true;
+	return(emitterIndex);
+}
+
+/***********************************************************
+ *  RemoveEmitter()
+ *
+ *  This method is used for removing an emitter.  Its
+ *  particles stop being drawn and are kept for the next
+ *  emitter of the same size.
+ ***********************************************************/
+void ParticleManager::RemoveEmitter(int emitterIndex)
+{
+	if (emitterIndex < 0 || emitterIndex >= (int)m_emitters.size())
+	{
+		return;
+	}
+
+	m_emitters[emitterIndex].bActive = false;
+	m_bEmittersChanged = true;
+}
+
+/***********************************************************
+ *  GetParticleCount()
+ *
+ *  This method is used for getting the number of particles
+ *  of the emitters in use.
+ ***********************************************************/
+int ParticleManager::GetParticleCount() const
+{
+	int count = 0;
+	for (const EMITTER_SLOT& slot : m_emitters)
+	{
+		count += slot.bActive ? slot.emitter.particleCount : 0;
+	}
+	return(count);
+}
+
+/***********************************************************
+ *  UpdateBuffers()
+ *
+ *  This method is used for growing the state buffers when
+ *  emitters are added, and writing the starting state of
+ *  the new particles.
+ ***********************************************************/
+void ParticleManager::UpdateBuffers()
+{
+	if (m_particleCount > m_particleCapacity)
+	{
+		int capacity = std::max(m_particleCount, m_particleCapacity * 2);
+		for (int b = 0; b < 2; b++)
+		{
+			GLBuffer buffer;
+			buffer.Create("Particles");
+			glBindBuffer(GL_COPY_WRITE_BUFFER, buffer.Get());
+			glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity * g_ParticleStateBytes, NULL,
+				m_bUseCompute ? GL_DYNAMIC_COPY : GL_STREAM_DRAW);
+
+			// the particles already moving on the GPU are kept
+			if (m_bUseCompute && (m_particleCapacity > 0))
+			{
+				glBindBuffer(GL_COPY_READ_BUFFER, m_stateBuffers[b].Get());
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+					(GLsizeiptr)m_particleCapacity * g_ParticleStateBytes);
+			}
+			// the old buffer is deleted once the frames drawn from it
+			// are done
+			MemoryManager::TrackBuffer(buffer.Get(), "Particles", "state buffers", (size_t)capacity * g_ParticleStateBytes);
+			m_stateBuffers[b] = std::move(buffer);
+
+			// each particle is one instance of the quad
+			glBindVertexArray(m_vertexArrays[b].Get());
+			glBindBuffer(GL_ARRAY_BUFFER, m_stateBuffers[b].Get());
+			glEnableVertexAttribArray(0);
+			glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, g_ParticleStateBytes, (void*)0);
+			glVertexAttribDivisor(0, 1);
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, g_ParticleStateBytes, (void*)(4 * sizeof(float)));
+			glVertexAttribDivisor(1, 1);
+			glBindVertexArray(0);
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		m_particleCapacity = capacity;
+	}
+
+	if (!m_bUseCompute)
+	{
+		m_positionX.resize(m_particleCount);
+		m_positionY.resize(m_particleCount);
+		m_positionZ.resize(m_particleCount);
+		m_life.resize(m_particleCount, -1.0f);
+		m_velocityX.resize(m_particleCount);
+		m_velocityY.resize(m_particleCount);
+		m_velocityZ.resize(m_particleCount);
+		m_emitterIndex.resize(m_particleCount);
+		m_uploadState.resize((size_t)m_particleCount * g_ParticleFloats);
+
+		// eight arrays of one value and the interleaved copy
+		size_t cpuMemoryBytes = (m_positionX.capacity() + m_positionY.capacity() + m_positionZ.capacity() +
+			m_life.capacity() + m_velocityX.capacity() + m_velocityY.capacity() + m_velocityZ.capacity() +
+			m_emitterIndex.capacity() + m_uploadState.capacity()) * sizeof(float);
+		MemoryManager::Release("Particles", "CPU state", MemoryManager::CPU_MEMORY, m_cpuMemoryBytes);
+		MemoryManager::Allocate("Particles", "CPU state", MemoryManager::CPU_MEMORY, cpuMemoryBytes);
+		m_cpuMemoryBytes = cpuMemoryBytes;
+	}
+
+	for (int e = 0; e < (int)m_emitters.size(); e++)
+	{
+		if (m_emitters[e].bReset)
+		{
+			ResetParticles(e);
+			m_emitters[e].bReset = false;
+		}
+	}
+
+	// the draw command lives in a buffer, so the particle count
+	// is only written when it changes
+	if (m_bUseCompute)
+	{
+		GLuint command[4] = { 4, (GLuint)m_particleCount, 0, 0 };
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer.Get());
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), command, GL_STATIC_DRAW);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+	UpdateEmitterBuffer();
+	m_bEmittersChanged = false;
+}
+
+/***********************************************************
+ *  ResetParticles()
+ *
+ *  This method is used for writing the starting state of
+ *  the particles of an emitter.  They have no life left, so
+ *  they spawn on the next update.
+ ***********************************************************/
+void ParticleManager::ResetParticles(int emitterIndex)
+{
+	const EMITTER_SLOT& slot = m_emitters[emitterIndex];
+	int first = slot.firstParticle;
+	int count = slot.emitter.particleCount;
+	glm::vec3 apex = slot.emitter.position;
+
+	if (m_bUseCompute)
+	{
+		std::vector<float> state((size_t)count * g_ParticleFloats, 0.0f);
+		for (int i = 0; i < count; i++)
+		{
+			float* pState = &state[(size_t)i * g_ParticleFloats];
+			pState[0] = apex.x;
+			pState[1] = apex.y;
+			pState[2] = apex.z;
+			pState[7] = (float)emitterIndex;
+		}
+		for (int b = 0; b < 2; b++)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_stateBuffers[b].Get());
+			glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)first * g_ParticleStateBytes,
+				(GLsizeiptr)count * g_ParticleStateBytes, state.data());
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	else
+	{
+		for (int i = first; i < first + count; i++)
+		{
+			m_positionX[i] = apex.x;
+			m_positionY[i] = apex.y;
+			m_positionZ[i] = apex.z;
+			m_life[i] = 0.0f;
+			m_velocityX[i] = 0.0f;
+			m_velocityY[i] = 0.0f;
+			m_velocityZ[i] = 0.0f;
+			m_emitterIndex[i] = (float)emitterIndex;
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateEmitterBuffer()
+ *
+ *  This method is used for writing the emitters into the
+ *  uniform buffer both programs read them from.  It only
+ *  runs when an emitter is added or removed.
+ ***********************************************************/
+void ParticleManager::UpdateEmitterBuffer()
+{
+	EMITTER_BLOCK block;
+
+	for (int e = 0; e < MAX_EMITTERS; e++)
+	{
+		block.positionLength[e] = block.directionSpread[e] = block.spawn[e] = glm::vec4(0.0f);
+		block.positionSize[e] = block.directionCone[e] = block.colorLifetime[e] = block.light[e] = glm::vec4(0.0f);
+		if (e >= (int)m_emitters.size())
+		{
+			continue;
+		}
+
+		const EMITTER& emitter = m_emitters[e].emitter;
+		float active = m_emitters[e].bActive ? 1.0f : 0.0f;
+		block.positionLength[e] = glm::vec4(emitter.position, emitter.length);
+		block.directionSpread[e] = glm::vec4(emitter.direction, tanf(glm::radians(emitter.spawnAngleDegrees)));
+		block.spawn[e] = glm::vec4(emitter.lifetimeSeconds, active, 0.0f, 0.0f);
+		block.positionSize[e] = glm::vec4(emitter.position, emitter.size);
+		block.directionCone[e] = glm::vec4(emitter.direction, cosf(glm::radians(emitter.outerAngleDegrees)));
+		block.colorLifetime[e] = glm::vec4(emitter.color, emitter.lifetimeSeconds);
+		block.light[e] = glm::vec4(cosf(glm::radians(emitter.innerAngleDegrees)), active, 0.0f, 0.0f);
+	}
+
+	glBindBuffer(GL_UNIFORM_BUFFER, m_emitterBuffer.Get());
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdateOnGPU()
+ *
+ *  This method is used for moving the particles with the
+ *  compute shader, from the current state buffer into the
+ *  other one.
+ ***********************************************************/
+void ParticleManager::UpdateOnGPU(float deltaSeconds)
+{
+	glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_timerFrame][0]);
+
+	glUseProgram(m_computeProgram.Get());
+	glUniform1ui(m_computeLocations[PARTICLE_COUNT_UNIFORM], (GLuint)m_particleCount);
+	glUniform1ui(m_computeLocations[FRAME_NUMBER_UNIFORM], m_frameNumber);
+	glUniform1f(m_computeLocations[DELTA_TIME_UNIFORM], deltaSeconds);
+	glUniform1f(m_computeLocations[JITTER_UNIFORM], g_ParticleJitter);
+	glUniform1f(m_computeLocations[DAMPING_UNIFORM], g_ParticleDamping);
+	glBindBufferBase(GL_UNIFORM_BUFFER, g_EmitterBlockBinding, m_emitterBuffer.Get());
+
+	int nextBuffer = 1 - m_currentBuffer;
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_stateBuffers[m_currentBuffer].Get());
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_stateBuffers[nextBuffer].Get());
+	glDispatchCompute((m_particleCount + g_ComputeGroupSize - 1) / g_ComputeGroupSize, 1, 1);
+	// the written state is read next as vertex attributes
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+	m_currentBuffer = nextBuffer;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_bTimerPending[m_timerFrame][0] = true;
+}
+
+/***********************************************************
+ *  SpawnParticle()
+ *
+ *  This method is used for placing a particle somewhere in
+ *  the cone of its emitter, the same way as the compute
+ *  shader does.
+ ***********************************************************/
+void ParticleManager::SpawnParticle(int index)
+{
+	const EMITTER_SLOT& slot = m_emitters[(int)m_emitterIndex[index]];
+	if (!slot.bActive)
+	{
+		m_life[index] = -1.0f;
+		return;
+	}
+
+	const EMITTER& emitter = slot.emitter;
+	uint32_t state = Hash((uint32_t)index * 1973U + m_frameNumber * 9277U);
+
+	glm::vec3 axis = emitter.direction;
+	glm::vec3 side = glm::normalize((fabsf(axis.y) < 0.99f) ?
+		glm::cross(axis, glm::vec3(0.0f, 1.0f, 0.0f)) : glm::cross(axis, glm::vec3(1.0f, 0.0f, 0.0f)));
+	glm::vec3 other = glm::cross(axis, side);
+	float along = emitter.length * powf(Random(state), 1.0f / 3.0f);
+	float radius = along * tanf(glm::radians(emitter.spawnAngleDegrees)) * sqrtf(Random(state));
+	float angle = Random(state) * g_TwoPi;
+	glm::vec3 position = emitter.position + axis * along + (side * cosf(angle) + other * sinf(angle)) * radius;
+
+	m_positionX[index] = position.x;
+	m_positionY[index] = position.y;
+	m_positionZ[index] = position.z;
+	m_velocityX[index] = 0.0f;
+	m_velocityY[index] = 0.0f;
+	m_velocityZ[index] = 0.0f;
+	m_life[index] = emitter.lifetimeSeconds * (0.5f + 0.5f * Random(state));
+}
+
+/***********************************************************
+ *  UpdateParticle()
+ *
+ *  This method is used for moving one particle on the CPU.
+ ***********************************************************/
+void ParticleManager::UpdateParticle(int index, float deltaSeconds)
+{
+	float life = m_life[index] - deltaSeconds;
+	if (life <= 0.0f)
+	{
+		SpawnParticle(index);
+		return;
+	}
+
+	uint32_t state = Hash((uint32_t)index * 1973U + m_frameNumber * 9277U);
+	float pushX = Random(state) - 0.5f;
+	float pushY = Random(state) - 0.5f;
+	float pushZ = Random(state) - 0.5f;
+
+	m_velocityX[index] += (pushX * g_ParticleJitter - m_velocityX[index] * g_ParticleDamping) * deltaSeconds;
+	m_velocityY[index] += (pushY * g_ParticleJitter - m_velocityY[index] * g_ParticleDamping) * deltaSeconds;
+	m_velocityZ[index] += (pushZ * g_ParticleJitter - m_velocityZ[index] * g_ParticleDamping) * deltaSeconds;
+	m_velocityY[index] -= g_ParticleSettle * deltaSeconds;
+	m_positionX[index] += m_velocityX[index] * deltaSeconds;
+	m_positionY[index] += m_velocityY[index] * deltaSeconds;
+	m_positionZ[index] += m_velocityZ[index] * deltaSeconds;
+	m_life[index] = life;
+}
+
+/***********************************************************
+ *  UpdateOnCPU()
+ *
+ *  This method is used for moving the particles on the CPU,
+ *  four at a time with SSE, and uploading them into the
+ *  state buffer not drawn last.
+ ***********************************************************/
+void ParticleManager::UpdateOnCPU(float deltaSeconds)
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	int count = m_particleCount;
+	int i = 0;
+
+#ifdef PARTICLE_USE_SSE
+	__m128 delta = _mm_set1_ps(deltaSeconds);
+	__m128 jitter = _mm_set1_ps(g_ParticleJitter);
+	__m128 damping = _mm_set1_ps(g_ParticleDamping);
+	__m128 settle = _mm_set1_ps(g_ParticleSettle * deltaSeconds);
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+	__m128i frameSeed = _mm_set1_epi32((int)(m_frameNumber * 9277U));
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 life = _mm_sub_ps(_mm_loadu_ps(&m_life[i]), delta);
+
+		__m128i index = _mm_add_epi32(_mm_set1_epi32(i), lanes);
+		__m128i state = Hash4(_mm_add_epi32(Multiply4(index, _mm_set1_epi32(1973)), frameSeed));
+		__m128 pushX = _mm_sub_ps(Random4(state), half);
+		__m128 pushY = _mm_sub_ps(Random4(state), half);
+		__m128 pushZ = _mm_sub_ps(Random4(state), half);
+
+		__m128 velocityX = _mm_loadu_ps(&m_velocityX[i]);
+		__m128 velocityY = _mm_loadu_ps(&m_velocityY[i]);
+		__m128 velocityZ = _mm_loadu_ps(&m_velocityZ[i]);
+		velocityX = _mm_add_ps(velocityX, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(pushX, jitter), _mm_mul_ps(velocityX, damping)), delta));
+		velocityY = _mm_add_ps(velocityY, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(pushY, jitter), _mm_mul_ps(velocityY, damping)), delta));
+		velocityZ = _mm_add_ps(velocityZ, _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(pushZ, jitter), _mm_mul_ps(velocityZ, damping)), delta));
+		velocityY = _mm_sub_ps(velocityY, settle);
+
+		_mm_storeu_ps(&m_positionX[i], _mm_add_ps(_mm_loadu_ps(&m_positionX[i]), _mm_mul_ps(velocityX, delta)));
+		_mm_storeu_ps(&m_positionY[i], _mm_add_ps(_mm_loadu_ps(&m_positionY[i]), _mm_mul_ps(velocityY, delta)));
+		_mm_storeu_ps(&m_positionZ[i], _mm_add_ps(_mm_loadu_ps(&m_positionZ[i]), _mm_mul_ps(velocityZ, delta)));
+		_mm_storeu_ps(&m_velocityX[i], velocityX);
+		_mm_storeu_ps(&m_velocityY[i], velocityY);
+		_mm_storeu_ps(&m_velocityZ[i], velocityZ);
+		_mm_storeu_ps(&m_life[i], life);
+
+		// the few particles that ran out of life spawn again
+		int spawnMask = _mm_movemask_ps(_mm_cmple_ps(life, _mm_setzero_ps()));
+		for (int lane = 0; spawnMask != 0; lane++, spawnMask >>= 1)
+		{
+			if (spawnMask & 1)
+			{
+				SpawnParticle(i + lane);
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		UpdateParticle(i, deltaSeconds);
+	}
+
+	for (int p = 0; p < count; p++)
+	{
+		float* pState = &m_uploadState[(size_t)p * g_ParticleFloats];
+		pState[0] = m_positionX[p];
+		pState[1] = m_positionY[p];
+		pState[2] = m_positionZ[p];
+		pState[3] = m_life[p];
+		pState[4] = m_velocityX[p];
+		pState[5] = m_velocityY[p];
+		pState[6] = m_velocityZ[p];
+		pState[7] = m_emitterIndex[p];
+	}
+
+	// the other buffer may still be in use by the last draw
+	int nextBuffer = 1 - m_currentBuffer;
+	glBindBuffer(GL_ARRAY_BUFFER, m_stateBuffers[nextBuffer].Get());
+	glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)count * g_ParticleStateBytes, m_uploadState.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	m_currentBuffer = nextBuffer;
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	m_updateMilliseconds += elapsed.count();
+	m_updateSamples++;
+}
+
+/***********************************************************
+ *  CollectTimers()
+ *
+ *  This method is used for adding the GPU timers that have
+ *  finished to the statistics, without waiting for any.
+ ***********************************************************/
+void ParticleManager::CollectTimers()
+{
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		for (int k = 0; k < 2; k++)
+		{
+			if (!m_bTimerPending[f][k])
+			{
+				continue;
+			}
+
+			GLuint available = 0;
+			glGetQueryObjectuiv(m_timerQueries[f][k], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available)
+			{
+				GLuint64 nanoseconds = 0;
+				glGetQueryObjectui64v(m_timerQueries[f][k], GL_QUERY_RESULT, &nanoseconds);
+				if (k == 0)
+				{
+					m_updateMilliseconds += nanoseconds / 1.0e6;
+					m_updateSamples++;
+				}
+				else
+				{
+					m_renderMilliseconds += nanoseconds / 1.0e6;
+					m_renderSamples++;
+				}
+				m_bTimerPending[f][k] = false;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing the average update and
+ *  draw times every few seconds.
+ ***********************************************************/
+void ParticleManager::ReportStatistics()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+	if (elapsed.count() < g_ReportSeconds)
+	{
+		return;
+	}
+
+	int emitterCount = 0;
+	for (const EMITTER_SLOT& slot : m_emitters)
+	{
+		emitterCount += slot.bActive ? 1 : 0;
+	}
+
+	std::cout << "INFO: Particles - " << GetParticleCount() << " in " << emitterCount
+		<< " emitters moved on the " << (m_bUseCompute ? "GPU" : "CPU")
+		<< ", update " << ((m_updateSamples > 0) ? m_updateMilliseconds / m_updateSamples : 0.0)
+		<< " ms, draw " << ((m_renderSamples > 0) ? m_renderMilliseconds / m_renderSamples : 0.0)
+		<< " ms per frame" << std::endl;
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_updateMilliseconds = 0.0;
+	m_renderMilliseconds = 0.0;
+	m_updateSamples = 0;
+	m_renderSamples = 0;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for moving the particles forward in
+ *  time, once per frame before they are drawn.
+ ***********************************************************/
+void ParticleManager::Update(float deltaSeconds)
+{
+	if (!m_bInitialized || (m_particleCount == 0))
+	{
+		return;
+	}
+
+	if (m_bEmittersChanged)
+	{
+		UpdateBuffers();
+	}
+	CollectTimers();
+
+	m_frameNumber++;
+	if (m_bUseCompute)
+	{
+		UpdateOnGPU(deltaSeconds);
+	}
+	else
+	{
+		UpdateOnCPU(deltaSeconds);
+	}
+
+	ReportStatistics();
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for drawing every particle with one
+ *  instanced draw.  The particles are added to the colors
+ *  behind them and do not hide each other.
+ ***********************************************************/
+void ParticleManager::Render(const glm::mat4& view, const glm::mat4& projection)
+{
+	if (!m_bInitialized || (m_particleCount == 0) || (m_particleCapacity == 0))
+	{
+		return;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_timerFrame][1]);
+
+	glUseProgram(m_renderProgram.Get());
+	glUniformMatrix4fv(m_renderLocations[VIEW_UNIFORM], 1, GL_FALSE, glm::value_ptr(view));
+	glUniformMatrix4fv(m_renderLocations[PROJECTION_UNIFORM], 1, GL_FALSE, glm::value_ptr(projection));
+	glBindBufferBase(GL_UNIFORM_BUFFER, g_EmitterBlockBinding, m_emitterBuffer.Get());
+
+	glDepthMask(GL_FALSE);
+	glBlendFunc(GL_ONE, GL_ONE);
+	glBindVertexArray(m_vertexArrays[m_currentBuffer].Get());
+	if (m_bUseCompute)
+	{
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer.Get());
+		glDrawArraysIndirect(GL_TRIANGLE_STRIP, (void*)0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	else
+	{
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, m_particleCount);
+	}
+	glBindVertexArray(0);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glDepthMask(GL_TRUE);
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_bTimerPending[m_timerFrame][1] = true;
+	m_timerFrame = (m_timerFrame + 1) % TIMER_FRAMES;
+}
@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// particlemanager.h
+// ============
+// manage particle effects - simulated on the GPU and drawn as billboards
+//
+//  Particles are kept in two buffers, one read and one written each update,
+//  and drawn straight from the last one written with one instanced draw.
+//  A compute shader moves them when OpenGL 4.3 is available, otherwise they
+//  are moved on the CPU with SSE and uploaded.  The emitters are passed to
+//  both programs in one uniform buffer, written when they change.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  ParticleManager
+ *
+ *  This class contains the code for simulating and drawing
+ *  particles spawned by cone shaped emitters.
+ ***********************************************************/
+class ParticleManager
+{
+public:
+	// constructor
+	ParticleManager();
+	// destructor
+	~ParticleManager();
+
+	// a cone the particles spawn in, lit like a spotlight
+	struct EMITTER
+	{
+		// apex and direction of the cone, and its length
+		glm::vec3 position;
+		glm::vec3 direction;
+		float length;
+		// half angle of the cone particles spawn in
+		float spawnAngleDegrees;
+		// particles are brightest inside the inner cone and fade
+		// out toward the outer cone
+		float innerAngleDegrees;
+		float outerAngleDegrees;
+		glm::vec3 color;
+		float size;
+		float lifetimeSeconds;
+		int particleCount;
+	};
+
+	// most emitters in use at once, enough for a lamp in every
+	// room a building keeps loaded, which is at most 32
+	static const int MAX_EMITTERS = 64;
+
+private:
+	// one emitter slot and the particles it owns
+	struct EMITTER_SLOT
+	{
+		EMITTER emitter;
+		int firstParticle;
+		bool bActive;
+		// the particles are written again on the next update
+		bool bReset;
+	};
+
+	std::vector<EMITTER_SLOT> m_emitters;
+	// particles in use, including those of removed emitters
+	int m_particleCount;
+	// particles the buffers have room for
+	int m_particleCapacity;
+	bool m_bEmittersChanged;
+	uint32_t m_frameNumber;
+
+	bool m_bInitialized;
+	bool m_bUseCompute;
+	// uniforms of the compute and draw programs, each of which
+	// uses some of them
+	enum UNIFORM
+	{
+		PARTICLE_COUNT_UNIFORM,
+		FRAME_NUMBER_UNIFORM,
+		DELTA_TIME_UNIFORM,
+		JITTER_UNIFORM,
+		DAMPING_UNIFORM,
+		VIEW_UNIFORM,
+		PROJECTION_UNIFORM,
+		UNIFORM_COUNT
+	};
+
+	// the emitters as the uniform block of both programs lays
+	// them out, one array of vec4 per value
+	struct EMITTER_BLOCK
+	{
+		glm::vec4 positionLength[MAX_EMITTERS];
+		glm::vec4 directionSpread[MAX_EMITTERS];
+		glm::vec4 spawn[MAX_EMITTERS];
+		glm::vec4 positionSize[MAX_EMITTERS];
+		glm::vec4 directionCone[MAX_EMITTERS];
+		glm::vec4 colorLifetime[MAX_EMITTERS];
+		glm::vec4 light[MAX_EMITTERS];
+	};
+
+	GLProgram m_renderProgram;
+	GLProgram m_computeProgram;
+	// uniform locations of the programs, found once after they link
+	GLint m_renderLocations[UNIFORM_COUNT];
+	GLint m_computeLocations[UNIFORM_COUNT];
+	// state buffers, read and written in turn
+	GLBuffer m_stateBuffers[2];
+	GLVertexArray m_vertexArrays[2];
+	int m_currentBuffer;
+	GLBuffer m_indirectBuffer;
+	// uniform buffer holding the emitters
+	GLBuffer m_emitterBuffer;
+
+	// particle state for the CPU update, one array per value
+	std::vector<float> m_positionX;
+	std::vector<float> m_positionY;
+	std::vector<float> m_positionZ;
+	std::vector<float> m_life;
+	std::vector<float> m_velocityX;
+	std::vector<float> m_velocityY;
+	std::vector<float> m_velocityZ;
+	std::vector<float> m_emitterIndex;
+	// interleaved copy uploaded for drawing
+	std::vector<float> m_uploadState;
+
+	// GPU timers for the update and the draw, a few frames deep so
+	// reading them never waits
+	static const int TIMER_FRAMES = 3;
+	GLuint m_timerQueries[TIMER_FRAMES][2];
+	bool m_bTimerPending[TIMER_FRAMES][2];
+	int m_timerFrame;
+
+	// statistics, reported every few seconds
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	double m_updateMilliseconds;
+	double m_renderMilliseconds;
+	int m_updateSamples;
+	int m_renderSamples;
+	// memory of the CPU state charged to the memory accounts
+	size_t m_cpuMemoryBytes;
+
+	// compile a shader file and link programs
+	static GLuint CompileShaderFile(GLenum type, const char* filename);
+	static GLuint LinkProgram(GLuint firstShader, GLuint secondShader);
+
+	// grow the buffers and write the state of new emitters
+	void UpdateBuffers();
+	// set the particles of an emitter to spawn on the next update
+	void ResetParticles(int emitterIndex);
+	// write the emitters into their uniform buffer
+	void UpdateEmitterBuffer();
+	// move the particles on the GPU or the CPU
+	void UpdateOnGPU(float deltaSeconds);
+	void UpdateOnCPU(float deltaSeconds);
+	void UpdateParticle(int index, float deltaSeconds);
+	void SpawnParticle(int index);
+	// add finished GPU timers to the statistics
+	void CollectTimers();
+	void ReportStatistics();
+
+public:
+	// compile the programs and pick the compute or CPU update,
+	// the CPU update is used when compute is not allowed
+	bool Initialize(bool bAllowCompute);
+	bool IsUsingCompute() const;
+
+	// add and remove emitters, returning the emitter index
+	int AddEmitter(const EMITTER& emitter);
+	void RemoveEmitter(int emitterIndex);
+	int GetParticleCount() const;
+
+	// move the particles forward in time
+	void Update(float deltaSeconds);
+	// draw the particles over the scene already drawn
+	void Render(const glm::mat4& view, const glm::mat4& projection);
+};
@@ -0,0 +1,470 @@
+///////////////////////////////////////////////////////////////////////////////
+// portalmanager.cpp
+// ============
+// manage the cells and portals of a building - visibility and distances
+//
+//  Each portal seen from the current cell is clipped against the current
+//  frustum.  What survives defines a narrower frustum through which the
+//  next cell is visited, until no portal opening remains in view.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PortalManager.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// deepest chain of portals followed by a visibility query
+	const int g_MaxPortalDepth = 16;
+	// distance from a portal at which the camera counts as
+	// standing in the opening
+	const float g_PortalStandingDistance = 0.25f;
+
+	// clip a convex polygon against a plane, keeping the
+	// part on the inner side (Sutherland-Hodgman)
+	void ClipPolygon(
+		const std::vector<glm::vec3>& input,
+		const glm::vec4& plane,
+		std::vector<glm::vec3>& output)
+	{
+		output.clear();
+		int count = (int)input.size();
+		for (int i = 0; i < count; i++)
+		{
+			glm::vec3 a = input[i];
+			glm::vec3 b = input[(i + 1) % count];
+			float distanceA = glm::dot(glm::vec3(plane), a) + plane.w;
+			float distanceB = glm::dot(glm::vec3(plane), b) + plane.w;
+
+			if (distanceA >= 0.0f)
+			{
+				output.push_back(a);
+			}
+			if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+			{
+				float t = distanceA / (distanceA - distanceB);
+				output.push_back(a + (b - a) * t);
+			}
+		}
+	}
+
+	glm::vec4 NormalizePlane(glm::vec4 plane)
+	{
+		float length = glm::length(glm::vec3(plane));
+		return(plane / length);
+	}
+
+	float DistanceToBox(glm::vec3 point, const SpatialManager::AABB& box)
+	{
+		glm::vec3 closest = glm::clamp(point, box.min, box.max);
+		return(glm::length(point - closest));
+	}
+}
+
+/***********************************************************
+ *  PortalManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PortalManager::PortalManager()
+{
+	m_portalsTested = 0;
+	m_portalsPassed = 0;
+}
+
+/***********************************************************
+ *  ~PortalManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PortalManager::~PortalManager()
+{
+	Clear();
+}
+
+/***********************************************************
+ *  AddCell()
+ *
+ *  This method is used for adding a cell to the graph.
+ ***********************************************************/
+int PortalManager::AddCell(const SpatialManager::AABB& bounds)
+{
+	CELL cell;
+	cell.bounds = bounds;
+	m_cells.push_back(cell);
+
+	return((int)m_cells.size() - 1);
+}
+
+/***********************************************************
+ *  AddPortal()
+ *
+ *  This method is used for joining two cells with a portal.
+ ***********************************************************/
+int PortalManager::AddPortal(int cellA, int cellB, const glm::vec3 corners[4])
+{
+	PORTAL portal;
+	portal.cells[0] = cellA;
+	portal.cells[1] = cellB;
+	portal.center = glm::vec3(0.0f);
+	for (int i = 0; i < 4; i++)
+	{
+		portal.corners[i] = corners[i];
+		portal.center += corners[i] * 0.25f;
+	}
+
+	int portalIndex = (int)m_portals.size();
+	m_portals.push_back(portal);
+	m_cells[cellA].portals.push_back(portalIndex);
+	m_cells[cellB].portals.push_back(portalIndex);
+
+	return(portalIndex);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all cells and portals.
+ ***********************************************************/
+void PortalManager::Clear()
+{
+	m_cells.clear();
+	m_portals.clear();
+}
+
+/***********************************************************
+ *  FindCell()
+ *
+ *  This method is used for finding the cell that contains
+ *  the passed in point.
+ ***********************************************************/
+int PortalManager::FindCell(glm::vec3 point) const
+{
+	for (int i = 0; i < (int)m_cells.size(); i++)
+	{
+		const SpatialManager::AABB& box = m_cells[i].bounds;
+		if (point.x >= box.min.x && point.x <= box.max.x &&
+			point.y >= box.min.y && point.y <= box.max.y &&
+			point.z >= box.min.z && point.z <= box.max.z)
+		{
+			return(i);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  VisitCell()
+ *
+ *  This method is used for marking a cell visible and then
+ *  following each of its portals that is still inside the
+ *  frustum, with the frustum narrowed to the portal opening.
+ ***********************************************************/
+void PortalManager::VisitCell(
+	int cell,
+	const std::vector<glm::vec4>& frustum,
+	glm::vec3 eye,
+	std::vector<int>& path,
+	std::vector<bool>& visible)
+{
+	visible[cell] = true;
+	if ((int)path.size() >= g_MaxPortalDepth)
+	{
+		return;
+	}
+	path.push_back(cell);
+
+	std::vector<glm::vec3> polygon;
+	std::vector<glm::vec3> clipped;
+	for (int portalIndex : m_cells[cell].portals)
+	{
+		const PORTAL& portal = m_portals[portalIndex];
+		int nextCell = (portal.cells[0] == cell) ? portal.cells[1] : portal.cells[0];
+
+		// never walk back into a cell on the current path
+		if (std::find(path.begin(), path.end(), nextCell) != path.end())
+		{
+			continue;
+		}
+		m_portalsTested++;
+
+		glm::vec3 portalNormal = glm::normalize(glm::cross(
+			portal.corners[1] - portal.corners[0],
+			portal.corners[2] - portal.corners[0]));
+		float eyeDistance = glm::dot(eye - portal.center, portalNormal);
+
+		// when the camera stands in the opening, clipping would
+		// degenerate, so look through with the current frustum
+		if (std::fabs(eyeDistance) < g_PortalStandingDistance)
+		{
+			m_portalsPassed++;
+			VisitCell(nextCell, frustum, eye, path, visible);
+			continue;
+		}
+
+		// clip the portal opening against the current frustum
+		polygon.assign(portal.corners, portal.corners + 4);
+		for (const glm::vec4& plane : frustum)
+		{
+			ClipPolygon(polygon, plane, clipped);
+			polygon.swap(clipped);
+			if (polygon.size() < 3)
+			{
+				break;
+			}
+		}
+		if (polygon.size() < 3)
+		{
+			continue;
+		}
+		m_portalsPassed++;
+
+		// build the frustum from the eye through the clipped opening
+		glm::vec3 centroid = glm::vec3(0.0f);
+		for (const glm::vec3& point : polygon)
+		{
+			centroid += point / (float)polygon.size();
+		}
+		std::vector<glm::vec4> portalFrustum;
+		for (int i = 0; i < (int)polygon.size(); i++)
+		{
+			glm::vec3 a = polygon[i];
+			glm::vec3 b = polygon[(i + 1) % polygon.size()];
+			glm::vec3 normal = glm::cross(a - eye, b - eye);
+			if (glm::length(normal) < 1e-6f)
+			{
+				continue;
+			}
+			normal = glm::normalize(normal);
+			glm::vec4 plane = glm::vec4(normal, -glm::dot(normal, eye));
+			if (glm::dot(normal, centroid) + plane.w < 0.0f)
+			{
+				plane = -plane;
+			}
+			portalFrustum.push_back(plane);
+		}
+		// nothing behind the portal opening is in front of it
+		glm::vec4 portalPlane = glm::vec4(portalNormal, -glm::dot(portalNormal, portal.center));
+		if (eyeDistance > 0.0f)
+		{
+			portalPlane = -portalPlane;
+		}
+		portalFrustum.push_back(portalPlane);
+		// keep the far plane of the camera frustum
+		portalFrustum.push_back(frustum.back());
+
+		VisitCell(nextCell, portalFrustum, eye, path, visible);
+	}
+
+	path.pop_back();
+}
+
+/***********************************************************
+ *  FindVisibleCells()
+ *
+ *  This method is used for finding the cells visible from
+ *  the eye.  When the eye is outside every cell, the cells
+ *  inside the view frustum are returned instead.
+ ***********************************************************/
+void PortalManager::FindVisibleCells(
+	const glm::mat4& viewProjection,
+	glm::vec3 eye,
+	std::vector<int>& visibleCells)
+{
+	std::vector<glm::vec4> frustum;
+	ExtractFrustumPlanes(viewProjection, frustum);
+
+	m_portalsTested = 0;
+	m_portalsPassed = 0;
+	visibleCells.clear();
+
+	int startCell = FindCell(eye);
+	if (startCell == -1)
+	{
+		for (int i = 0; i < (int)m_cells.size(); i++)
+		{
+			if (BoxInFrustum(m_cells[i].bounds, frustum))
+			{
+				visibleCells.push_back(i);
+			}
+		}
+		return;
+	}
+
+	std::vector<bool> visible(m_cells.size(), false);
+	std::vector<int> path;
+	VisitCell(startCell, frustum, eye, path, visible);
+
+	for (int i = 0; i < (int)m_cells.size(); i++)
+	{
+		if (visible[i])
+		{
+			visibleCells.push_back(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  FindCellDistances()
+ *
+ *  This method is used for finding how far the eye has to
+ *  walk to reach each cell, passing through portal centers.
+ *  Cells that cannot be reached through portals are given
+ *  their straight line distance.
+ ***********************************************************/
+void PortalManager::FindCellDistances(
+	glm::vec3 eye,
+	std::vector<float>& distances) const
+{
+	int cellCount = (int)m_cells.size();
+	distances.assign(cellCount, FLT_MAX);
+	std::vector<glm::vec3> entryPoints(cellCount, eye);
+	std::vector<bool> done(cellCount, false);
+
+	int startCell = FindCell(eye);
+	if (startCell == -1)
+	{
+		for (int i = 0; i < cellCount; i++)
+		{
+			distances[i] = DistanceToBox(eye, m_cells[i].bounds);
+		}
+		return;
+	}
+	distances[startCell] = 0.0f;
+
+	// Dijkstra over the cells, entering each through the
+	// portal center that reaches it first
+	for (int step = 0; step < cellCount; step++)
+	{
+		int current = -1;
+		for (int i = 0; i < cellCount; i++)
+		{
+			if (!done[i] && distances[i] < FLT_MAX && (current == -1 || distances[i] < distances[current]))
+			{
+				current = i;
+			}
+		}
+		if (current == -1)
+		{
+			break;
+		}
+		done[current] = true;
+
+		for (int portalIndex : m_cells[current].portals)
+		{
+			const PORTAL& portal = m_portals[portalIndex];
+			int nextCell = (portal.cells[0] == current) ? portal.cells[1] : portal.cells[0];
+			float distance = distances[current] + glm::length(portal.center - entryPoints[current]);
+			if (distance < distances[nextCell])
+			{
+				distances[nextCell] = distance;
+				entryPoints[nextCell] = portal.center;
+			}
+		}
+	}
+
+	for (int i = 0; i < cellCount; i++)
+	{
+		if (distances[i] == FLT_MAX)
+		{
+			distances[i] = DistanceToBox(eye, m_cells[i].bounds);
+		}
+	}
+}
+
+/***********************************************************
+ *  GetCellCount()
+ *
+ *  This method is used for getting the number of cells.
+ ***********************************************************/
+int PortalManager::GetCellCount() const
+{
+	return((int)m_cells.size());
+}
+
+/***********************************************************
+ *  GetPortalCount()
+ *
+ *  This method is used for getting the number of portals.
+ ***********************************************************/
+int PortalManager::GetPortalCount() const
+{
+	return((int)m_portals.size());
+}
+
+/***********************************************************
+ *  GetPortalsTested()
+ *
+ *  This method is used for getting the number of portals
+ *  clipped during the last visibility query.
+ ***********************************************************/
+int PortalManager::GetPortalsTested() const
+{
+	return(m_portalsTested);
+}
+
+/***********************************************************
+ *  GetPortalsPassed()
+ *
+ *  This method is used for getting the number of portals
+ *  seen through during the last visibility query.
+ ***********************************************************/
+int PortalManager::GetPortalsPassed() const
+{
+	return(m_portalsPassed);
+}
+
+/***********************************************************
+ *  ExtractFrustumPlanes()
+ *
+ *  This method is used for extracting the six planes of the
+ *  view frustum from the combined view projection matrix,
+ *  in the order left, right, bottom, top, near, far.
+ ***********************************************************/
+void PortalManager::ExtractFrustumPlanes(
+	const glm::mat4& viewProjection,
+	std::vector<glm::vec4>& planes)
+{
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	}
+
+	planes.clear();
+	planes.push_back(NormalizePlane(rows[3] + rows[0]));
+	planes.push_back(NormalizePlane(rows[3] - rows[0]));
+	planes.push_back(NormalizePlane(rows[3] + rows[1]));
+	planes.push_back(NormalizePlane(rows[3] - rows[1]));
+	planes.push_back(NormalizePlane(rows[3] + rows[2]));
+	planes.push_back(NormalizePlane(rows[3] - rows[2]));
+}
+
+/***********************************************************
+ *  BoxInFrustum()
+ *
+ *  This method is used for testing a box against frustum
+ *  planes, using the corner farthest along each plane.
+ ***********************************************************/
+bool PortalManager::BoxInFrustum(
+	const SpatialManager::AABB& box,
+	const std::vector<glm::vec4>& planes)
+{
+	for (const glm::vec4& plane : planes)
+	{
+		glm::vec3 corner(
+			(plane.x >= 0.0f) ? box.max.x : box.min.x,
+			(plane.y >= 0.0f) ? box.max.y : box.min.y,
+			(plane.z >= 0.0f) ? box.max.z : box.min.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
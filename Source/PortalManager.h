@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+// portalmanager.h
+// ============
+// manage the cells and portals of a building - visibility and distances
+//
+//  Rooms are cells connected through portals such as doorways.  Visible
+//  cells are found by clipping the view frustum through each portal in
+//  turn, so only the rooms that can actually be seen are drawn.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SpatialManager.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/***********************************************************
+ *  PortalManager
+ *
+ *  This class contains the code for the cell and portal
+ *  graph of a building and the visibility queries on it.
+ ***********************************************************/
+class PortalManager
+{
+public:
+	// constructor
+	PortalManager();
+	// destructor
+	~PortalManager();
+
+	struct PORTAL
+	{
+		// the two cells joined by the portal
+		int cells[2];
+		// corners of the portal opening, in winding order
+		glm::vec3 corners[4];
+		glm::vec3 center;
+	};
+
+	struct CELL
+	{
+		SpatialManager::AABB bounds;
+		std::vector<int> portals;
+	};
+
+private:
+	std::vector<CELL> m_cells;
+	std::vector<PORTAL> m_portals;
+
+	// statistics from the last visibility query
+	int m_portalsTested;
+	int m_portalsPassed;
+
+	// recursively visit the cells seen through the portals of a cell
+	void VisitCell(
+		int cell,
+		const std::vector<glm::vec4>& frustum,
+		glm::vec3 eye,
+		std::vector<int>& path,
+		std::vector<bool>& visible);
+
+public:
+	// add a cell and return its index
+	int AddCell(const SpatialManager::AABB& bounds);
+	// add a portal between two cells and return its index
+	int AddPortal(int cellA, int cellB, const glm::vec3 corners[4]);
+	// remove all cells and portals
+	void Clear();
+
+	// find the cell containing a point, -1 when outside all cells
+	int FindCell(glm::vec3 point) const;
+	// find the cells visible from the eye through the portals
+	void FindVisibleCells(
+		const glm::mat4& viewProjection,
+		glm::vec3 eye,
+		std::vector<int>& visibleCells);
+	// find the walking distance from the eye to every cell,
+	// travelling through the portal openings
+	void FindCellDistances(
+		glm::vec3 eye,
+		std::vector<float>& distances) const;
+
+	int GetCellCount() const;
+	int GetPortalCount() const;
+	int GetPortalsTested() const;
+	int GetPortalsPassed() const;
+
+	// extract the planes of a view frustum, facing inward
+	static void ExtractFrustumPlanes(
+		const glm::mat4& viewProjection,
+		std::vector<glm::vec4>& planes);
+	// test whether a box is at least partly inside a frustum
+	static bool BoxInFrustum(
+		const SpatialManager::AABB& box,
+		const std::vector<glm::vec4>& planes);
+};
@@ -0,0 +1,704 @@
+///////////////////////////////////////////////////////////////////////////////
+// postprocessmanager.cpp
+// ============
+// process the finished frame - HDR, bloom, tone mapping and color grading
+//
+//  The bloom levels are kept as the mipmaps of one texture, so a step reads
+//  one level through a sampler and writes the next as an image.  The first
+//  step reads the scene itself and keeps only what is brighter than the
+//  threshold.  Each stage is timed with GPU timestamps, which do not clash
+//  with the elapsed time queries of the particles drawn inside the scene.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PostProcessManager.h"
+#include "MemoryManager.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	const char* g_DownsampleShader = "shaders/bloomDownsample.glsl";
+	const char* g_UpsampleShader = "shaders/bloomUpsample.glsl";
+	const char* g_CompositeVertexShader = "shaders/postProcessVertex.glsl";
+	const char* g_CompositeFragmentShader = "shaders/postProcessFragment.glsl";
+
+	// texture units of the HDR scene and the bloom, clear of the
+	// scene textures and the virtual texture cache
+	const int g_SceneTextureUnit = 12;
+	const int g_BloomTextureUnit = 13;
+
+	// pixels across a compute group, matching the shaders
+	const int g_ComputeGroupSize = 8;
+	// the bloom levels stop before they get smaller than this
+	const int g_MinBloomSize = 8;
+	// half float RGBA
+	const int g_HDRBytesPerTexel = 8;
+	const int g_DepthBytesPerTexel = 4;
+
+	// names of the uniforms in the order of the UNIFORM enums of
+	// PostProcessManager
+	const char* g_DownsampleUniformNames[] =
+	{
+		"threshold",
+		"knee",
+		"sourceTexture",
+		"sourceLevel",
+		"sourceTexelSize",
+		"targetSize",
+		"bPrefilter"
+	};
+	const char* g_UpsampleUniformNames[] =
+	{
+		"sourceTexture",
+		"radius",
+		"sourceLevel",
+		"sourceTexelSize",
+		"targetSize"
+	};
+	const char* g_CompositeUniformNames[] =
+	{
+		"sceneTexture",
+		"bloomTexture",
+		"bUseBloom",
+		"bloomStrength",
+		"exposure",
+		"colorBalance",
+		"contrast",
+		"saturation",
+		"lift"
+	};
+
+	// look up the uniforms of a program once, after it links
+	void FindUniformLocations(GLuint program, const char* const* names, int count, GLint* pLocations)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			pLocations[i] = (program != 0) ? glGetUniformLocation(program, names[i]) : -1;
+		}
+	}
+
+	const double g_ReportSeconds = 5.0;
+	const char* g_StageNames[] =
+	{
+		"scene",
+		"bloom down",
+		"bloom up",
+		"tone map"
+	};
+
+	// a glow around the brightest lights, with slightly warm,
+	// punchier colors than plain tone mapping
+	const PostProcessManager::SETTINGS g_DefaultSettings =
+	{
+		1.0f, 0.5f, 0.06f, 1.0f,
+		1.0f, glm::vec3(1.0f, 0.98f, 0.94f), 1.05f, 1.05f, glm::vec3(0.0f)
+	};
+
+	int GetGroupCount(int size)
+	{
+		return((size + g_ComputeGroupSize - 1) / g_ComputeGroupSize);
+	}
+}
+
+/***********************************************************
+ *  PostProcessManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PostProcessManager::PostProcessManager()
+{
+	m_bInitialized = false;
+	m_bUseBloom = false;
+	m_settings = g_DefaultSettings;
+	m_width = 0;
+	m_height = 0;
+	m_bloomLevels = 0;
+	m_bloomBytes = 0;
+	m_outputFramebuffer = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_outputViewport[i] = 0;
+	}
+	m_bFrameStarted = false;
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		for (int s = 0; s <= STAGE_COUNT; s++)
+		{
+			m_timestampQueries[f][s] = 0;
+		}
+		m_bTimerPending[f] = false;
+	}
+	m_timerFrame = 0;
+	FindUniformLocations(0, g_DownsampleUniformNames, DOWNSAMPLE_UNIFORM_COUNT, m_downsampleLocations);
+	FindUniformLocations(0, g_UpsampleUniformNames, UPSAMPLE_UNIFORM_COUNT, m_upsampleLocations);
+	FindUniformLocations(0, g_CompositeUniformNames, COMPOSITE_UNIFORM_COUNT, m_compositeLocations);
+	m_statisticsStart = std::chrono::steady_clock::now();
+	for (int s = 0; s < STAGE_COUNT; s++)
+	{
+		m_stageMilliseconds[s] = 0.0;
+	}
+	m_timerSamples = 0;
+}
+
+/***********************************************************
+ *  ~PostProcessManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PostProcessManager::~PostProcessManager()
+{
+	Release();
+}
+
+/***********************************************************
+ *  CompileShaderFile()
+ *
+ *  This method is used for reading and compiling a shader
+ *  file.  Returns 0 when it could not be compiled.
+ ***********************************************************/
+GLuint PostProcessManager::CompileShaderFile(GLenum type, const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open shader file " << filename << std::endl;
+		return(0);
+	}
+	std::stringstream source;
+	source << file.rdbuf();
+	std::string text = source.str();
+	const char* pText = text.c_str();
+
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &pText, NULL);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		std::cout << "Could not compile shader file " << filename << "\n" << log << std::endl;
+		glDeleteShader(shader);
+		return(0);
+	}
+	return(shader);
+}
+
+/***********************************************************
+ *  LinkProgram()
+ *
+ *  This method is used for linking compiled shaders into a
+ *  program.  The shaders are freed, and 0 is returned when
+ *  the program could not be linked.
+ ***********************************************************/
+GLuint PostProcessManager::LinkProgram(GLuint firstShader, GLuint secondShader)
+{
+	if (firstShader == 0)
+	{
+		glDeleteShader(secondShader);
+		return(0);
+	}
+
+	GLuint program = glCreateProgram();
+	glAttachShader(program, firstShader);
+	if (secondShader != 0)
+	{
+		glAttachShader(program, secondShader);
+	}
+	glLinkProgram(program);
+	glDeleteShader(firstShader);
+	if (secondShader != 0)
+	{
+		glDeleteShader(secondShader);
+	}
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		glGetProgramInfoLog(program, sizeof(log), NULL, log);
+		std::cout << "Could not link post processing program\n" << log << std::endl;
+		glDeleteProgram(program);
+		return(0);
+	}
+	return(program);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for compiling the programs.  The
+ *  bloom is made with compute shaders, used when OpenGL 4.3
+ *  is available and they compile.
+ ***********************************************************/
+bool PostProcessManager::Initialize()
+{
+	if (m_bInitialized)
+	{
+		return(true);
+	}
+
+	GLuint vertexShader = CompileShaderFile(GL_VERTEX_SHADER, g_CompositeVertexShader);
+	GLuint fragmentShader = CompileShaderFile(GL_FRAGMENT_SHADER, g_CompositeFragmentShader);
+	if ((vertexShader == 0) || (fragmentShader == 0))
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return(false);
+	}
+	m_compositeProgram.Adopt(LinkProgram(vertexShader, fragmentShader), "PostProcess");
+	if (!m_compositeProgram.IsValid())
+	{
+		return(false);
+	}
+	FindUniformLocations(m_compositeProgram.Get(), g_CompositeUniformNames, COMPOSITE_UNIFORM_COUNT, m_compositeLocations);
+
+	m_bUseBloom = GLEW_VERSION_4_3 || GLEW_ARB_compute_shader;
+	if (m_bUseBloom)
+	{
+		m_downsampleProgram.Adopt(LinkProgram(CompileShaderFile(GL_COMPUTE_SHADER, g_DownsampleShader), 0), "PostProcess");
+		m_upsampleProgram.Adopt(LinkProgram(CompileShaderFile(GL_COMPUTE_SHADER, g_UpsampleShader), 0), "PostProcess");
+		if (!m_downsampleProgram.IsValid() || !m_upsampleProgram.IsValid())
+		{
+			m_downsampleProgram.Reset();
+			m_upsampleProgram.Reset();
+			m_bUseBloom = false;
+		}
+		FindUniformLocations(m_downsampleProgram.Get(), g_DownsampleUniformNames, DOWNSAMPLE_UNIFORM_COUNT, m_downsampleLocations);
+		FindUniformLocations(m_upsampleProgram.Get(), g_UpsampleUniformNames, UPSAMPLE_UNIFORM_COUNT, m_upsampleLocations);
+	}
+
+	// the full screen triangle is made from the vertex number, but
+	// a core context still needs a vertex array bound
+	m_emptyVertexArray.Create("PostProcess");
+	glGenQueries(TIMER_FRAMES * (STAGE_COUNT + 1), &m_timestampQueries[0][0]);
+
+	std::cout << "INFO: Post processing in HDR, "
+		<< (m_bUseBloom ? "bloom made with compute shaders" : "no bloom without compute shaders") << std::endl;
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_bInitialized = true;
+	return(true);
+}
+
+/***********************************************************
+ *  IsInitialized()
+ *
+ *  This method is used for checking whether the programs
+ *  were compiled.
+ ***********************************************************/
+bool PostProcessManager::IsInitialized() const
+{
+	return(m_bInitialized);
+}
+
+/***********************************************************
+ *  SetSettings()
+ *
+ *  This method is used for changing the bloom and grading.
+ ***********************************************************/
+void PostProcessManager::SetSettings(const SETTINGS& settings)
+{
+	m_settings = settings;
+}
+
+/***********************************************************
+ *  GetSettings()
+ *
+ *  This method is used for getting the bloom and grading.
+ ***********************************************************/
+const PostProcessManager::SETTINGS& PostProcessManager::GetSettings() const
+{
+	return(m_settings);
+}
+
+/***********************************************************
+ *  ResizeTargets()
+ *
+ *  This method is used for creating the HDR target and the
+ *  bloom levels when the frame size changes.  The bloom
+ *  starts at half size and halves until it is a few texels
+ *  across.
+ ***********************************************************/
+void PostProcessManager::ResizeTargets(int width, int height)
+{
+	DestroyTargets();
+
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+
+	m_colorTexture.Create("PostProcess");
+	glBindTexture(GL_TEXTURE_2D, m_colorTexture.Get());
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	MemoryManager::TrackTexture(m_colorTexture.Get(), "PostProcess", "HDR color",
+		(size_t)width * height * g_HDRBytesPerTexel);
+
+	m_depthBuffer.Create("PostProcess");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	MemoryManager::Allocate("PostProcess", "HDR depth", MemoryManager::GPU_TEXTURE,
+		(size_t)width * height * g_DepthBytesPerTexel);
+
+	m_framebuffer.Create("PostProcess");
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture.Get(), 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer.Get());
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "HDR framebuffer is not complete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, m_outputFramebuffer);
+
+	if (m_bUseBloom)
+	{
+		int bloomWidth = std::max(width / 2, 1);
+		int bloomHeight = std::max(height / 2, 1);
+		m_bloomLevels = 1;
+		while ((m_bloomLevels < MAX_BLOOM_LEVELS) &&
+			(std::min(bloomWidth >> m_bloomLevels, bloomHeight >> m_bloomLevels) >= g_MinBloomSize))
+		{
+			m_bloomLevels++;
+		}
+
+		m_bloomTexture.Create("PostProcess");
+		glBindTexture(GL_TEXTURE_2D, m_bloomTexture.Get());
+		glTexStorage2D(GL_TEXTURE_2D, m_bloomLevels, GL_RGBA16F, bloomWidth, bloomHeight);
+		// each level is read on its own, blended within it
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		m_bloomBytes = MemoryManager::GetTextureBytes(bloomWidth, bloomHeight, g_HDRBytesPerTexel, m_bloomLevels > 1);
+		MemoryManager::TrackTexture(m_bloomTexture.Get(), "PostProcess", "bloom levels", m_bloomBytes);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	m_width = width;
+	m_height = height;
+}
+
+/***********************************************************
+ *  DestroyTargets()
+ *
+ *  This method is used for freeing the HDR target and the
+ *  bloom levels.
+ ***********************************************************/
+void PostProcessManager::DestroyTargets()
+{
+	if (m_framebuffer.IsValid())
+	{
+		MemoryManager::Release("PostProcess", "HDR depth", MemoryManager::GPU_TEXTURE,
+			(size_t)m_width * m_height * g_DepthBytesPerTexel);
+		m_framebuffer.Reset();
+		m_colorTexture.Reset();
+		m_depthBuffer.Reset();
+	}
+	if (m_bloomTexture.IsValid())
+	{
+		m_bloomTexture.Reset();
+		m_bloomLevels = 0;
+		m_bloomBytes = 0;
+	}
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for remembering where the frame is
+ *  to be written and drawing the scene into the HDR target
+ *  instead.
+ ***********************************************************/
+void PostProcessManager::BeginFrame(int width, int height)
+{
+	m_bFrameStarted = false;
+	if (!m_bInitialized || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	CollectTimers();
+	ReportStatistics();
+
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_outputFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_outputViewport);
+	if ((width != m_width) || (height != m_height))
+	{
+		ResizeTargets(width, height);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	glViewport(0, 0, m_width, m_height);
+	glQueryCounter(m_timestampQueries[m_timerFrame][STAGE_SCENE], GL_TIMESTAMP);
+	m_bFrameStarted = true;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for making the bloom from the scene
+ *  just drawn and writing the finished frame.  The program,
+ *  texture unit and depth and blend settings the scene uses
+ *  are put back afterwards.
+ ***********************************************************/
+void PostProcessManager::EndFrame()
+{
+	if (!m_bFrameStarted)
+	{
+		return;
+	}
+	m_bFrameStarted = false;
+
+	GLint previousProgram = 0;
+	GLint previousActiveTexture = GL_TEXTURE0;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
+	GLboolean bDepthTest = glIsEnabled(GL_DEPTH_TEST);
+	GLboolean bBlend = glIsEnabled(GL_BLEND);
+
+	GLuint* pQueries = m_timestampQueries[m_timerFrame];
+	glQueryCounter(pQueries[STAGE_BLOOM_DOWNSAMPLE], GL_TIMESTAMP);
+	if (m_bUseBloom)
+	{
+		DownsampleBloom();
+	}
+	glQueryCounter(pQueries[STAGE_BLOOM_UPSAMPLE], GL_TIMESTAMP);
+	if (m_bUseBloom)
+	{
+		UpsampleBloom();
+	}
+	glQueryCounter(pQueries[STAGE_COMPOSITE], GL_TIMESTAMP);
+	Composite();
+	glQueryCounter(pQueries[STAGE_COUNT], GL_TIMESTAMP);
+	m_bTimerPending[m_timerFrame] = true;
+	m_timerFrame = (m_timerFrame + 1) % TIMER_FRAMES;
+
+	glUseProgram(previousProgram);
+	glActiveTexture(previousActiveTexture);
+	if (bDepthTest)
+	{
+		glEnable(GL_DEPTH_TEST);
+	}
+	if (bBlend)
+	{
+		glEnable(GL_BLEND);
+	}
+}
+
+/***********************************************************
+ *  DownsampleBloom()
+ *
+ *  This method is used for halving the scene into the first
+ *  bloom level, keeping only its bright parts, and each
+ *  level into the next.
+ ***********************************************************/
+void PostProcessManager::DownsampleBloom()
+{
+	glUseProgram(m_downsampleProgram.Get());
+	glActiveTexture(GL_TEXTURE0 + g_SceneTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, m_colorTexture.Get());
+	glActiveTexture(GL_TEXTURE0 + g_BloomTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, m_bloomTexture.Get());
+	glUniform1f(m_downsampleLocations[DOWNSAMPLE_THRESHOLD], m_settings.bloomThreshold);
+	glUniform1f(m_downsampleLocations[DOWNSAMPLE_KNEE], std::max(m_settings.bloomKnee, 0.0001f));
+
+	int bloomWidth = std::max(m_width / 2, 1);
+	int bloomHeight = std::max(m_height / 2, 1);
+	for (int level = 0; level < m_bloomLevels; level++)
+	{
+		bool bPrefilter = (level == 0);
+		int sourceWidth = bPrefilter ? m_width : std::max(bloomWidth >> (level - 1), 1);
+		int sourceHeight = bPrefilter ? m_height : std::max(bloomHeight >> (level - 1), 1);
+		int targetWidth = std::max(bloomWidth >> level, 1);
+		int targetHeight = std::max(bloomHeight >> level, 1);
+
+		glUniform1i(m_downsampleLocations[DOWNSAMPLE_SOURCE_TEXTURE],
+			bPrefilter ? g_SceneTextureUnit : g_BloomTextureUnit);
+		glUniform1f(m_downsampleLocations[DOWNSAMPLE_SOURCE_LEVEL], bPrefilter ? 0.0f : (float)(level - 1));
+		glUniform2f(m_downsampleLocations[DOWNSAMPLE_SOURCE_TEXEL_SIZE],
+			1.0f / sourceWidth, 1.0f / sourceHeight);
+		glUniform2f(m_downsampleLocations[DOWNSAMPLE_TARGET_SIZE], (float)targetWidth, (float)targetHeight);
+		glUniform1i(m_downsampleLocations[DOWNSAMPLE_PREFILTER], bPrefilter ? 1 : 0);
+
+		glBindImageTexture(0, m_bloomTexture.Get(), level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+		glDispatchCompute(GetGroupCount(targetWidth), GetGroupCount(targetHeight), 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+}
+
+/***********************************************************
+ *  UpsampleBloom()
+ *
+ *  This method is used for blurring each bloom level into
+ *  the one above it, from the smallest up, so the first
+ *  level ends up holding every size of glow.
+ ***********************************************************/
+void PostProcessManager::UpsampleBloom()
+{
+	glUseProgram(m_upsampleProgram.Get());
+	glActiveTexture(GL_TEXTURE0 + g_BloomTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, m_bloomTexture.Get());
+	glUniform1i(m_upsampleLocations[UPSAMPLE_SOURCE_TEXTURE], g_BloomTextureUnit);
+	glUniform1f(m_upsampleLocations[UPSAMPLE_RADIUS], m_settings.bloomRadius);
+
+	int bloomWidth = std::max(m_width / 2, 1);
+	int bloomHeight = std::max(m_height / 2, 1);
+	for (int level = m_bloomLevels - 2; level >= 0; level--)
+	{
+		int sourceWidth = std::max(bloomWidth >> (level + 1), 1);
+		int sourceHeight = std::max(bloomHeight >> (level + 1), 1);
+		int targetWidth = std::max(bloomWidth >> level, 1);
+		int targetHeight = std::max(bloomHeight >> level, 1);
+
+		glUniform1f(m_upsampleLocations[UPSAMPLE_SOURCE_LEVEL], (float)(level + 1));
+		glUniform2f(m_upsampleLocations[UPSAMPLE_SOURCE_TEXEL_SIZE],
+			1.0f / sourceWidth, 1.0f / sourceHeight);
+		glUniform2f(m_upsampleLocations[UPSAMPLE_TARGET_SIZE], (float)targetWidth, (float)targetHeight);
+
+		glBindImageTexture(0, m_bloomTexture.Get(), level, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+		glDispatchCompute(GetGroupCount(targetWidth), GetGroupCount(targetHeight), 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+}
+
+/***********************************************************
+ *  Composite()
+ *
+ *  This method is used for writing the finished frame, in
+ *  one full screen pass that adds the bloom, tone maps and
+ *  grades the scene.
+ ***********************************************************/
+void PostProcessManager::Composite()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_outputFramebuffer);
+	glViewport(m_outputViewport[0], m_outputViewport[1], m_outputViewport[2], m_outputViewport[3]);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	glUseProgram(m_compositeProgram.Get());
+	glActiveTexture(GL_TEXTURE0 + g_SceneTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, m_colorTexture.Get());
+	glActiveTexture(GL_TEXTURE0 + g_BloomTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, m_bloomTexture.Get());
+
+	glUniform1i(m_compositeLocations[COMPOSITE_SCENE_TEXTURE], g_SceneTextureUnit);
+	glUniform1i(m_compositeLocations[COMPOSITE_BLOOM_TEXTURE], g_BloomTextureUnit);
+	glUniform1i(m_compositeLocations[COMPOSITE_USE_BLOOM], m_bUseBloom ? 1 : 0);
+	glUniform1f(m_compositeLocations[COMPOSITE_BLOOM_STRENGTH], m_settings.bloomStrength);
+	glUniform1f(m_compositeLocations[COMPOSITE_EXPOSURE], m_settings.exposure);
+	glUniform3fv(m_compositeLocations[COMPOSITE_COLOR_BALANCE], 1, &m_settings.colorBalance.x);
+	glUniform1f(m_compositeLocations[COMPOSITE_CONTRAST], m_settings.contrast);
+	glUniform1f(m_compositeLocations[COMPOSITE_SATURATION], m_settings.saturation);
+	glUniform3fv(m_compositeLocations[COMPOSITE_LIFT], 1, &m_settings.lift.x);
+
+	glBindVertexArray(m_emptyVertexArray.Get());
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	glBindVertexArray(0);
+}
+
+/***********************************************************
+ *  CollectTimers()
+ *
+ *  This method is used for adding the stage times of the
+ *  frames the GPU has finished, without waiting for any.
+ ***********************************************************/
+void PostProcessManager::CollectTimers()
+{
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		if (!m_bTimerPending[f])
+		{
+			continue;
+		}
+
+		GLuint available = 0;
+		glGetQueryObjectuiv(m_timestampQueries[f][STAGE_COUNT], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			continue;
+		}
+
+		GLuint64 timestamps[STAGE_COUNT + 1];
+		for (int s = 0; s <= STAGE_COUNT; s++)
+		{
+			glGetQueryObjectui64v(m_timestampQueries[f][s], GL_QUERY_RESULT, &timestamps[s]);
+		}
+		for (int s = 0; s < STAGE_COUNT; s++)
+		{
+			m_stageMilliseconds[s] += (timestamps[s + 1] - timestamps[s]) / 1.0e6;
+		}
+		m_timerSamples++;
+		m_bTimerPending[f] = false;
+	}
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing the average time of
+ *  each stage every few seconds.
+ ***********************************************************/
+void PostProcessManager::ReportStatistics()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+	if (elapsed.count() < g_ReportSeconds)
+	{
+		return;
+	}
+
+	if (m_timerSamples > 0)
+	{
+		std::cout << "INFO: Post processing at " << m_width << "x" << m_height
+			<< " with " << m_bloomLevels << " bloom levels -";
+		for (int s = 0; s < STAGE_COUNT; s++)
+		{
+			std::cout << " " << g_StageNames[s] << " " << m_stageMilliseconds[s] / m_timerSamples << " ms"
+				<< ((s < STAGE_COUNT - 1) ? "," : "");
+		}
+		std::cout << " per frame" << std::endl;
+	}
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	for (int s = 0; s < STAGE_COUNT; s++)
+	{
+		m_stageMilliseconds[s] = 0.0;
+	}
+	m_timerSamples = 0;
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for freeing the programs, targets
+ *  and timers.
+ ***********************************************************/
+void PostProcessManager::Release()
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	DestroyTargets();
+	m_downsampleProgram.Reset();
+	m_upsampleProgram.Reset();
+	m_compositeProgram.Reset();
+	m_emptyVertexArray.Reset();
+	glDeleteQueries(TIMER_FRAMES * (STAGE_COUNT + 1), &m_timestampQueries[0][0]);
+	m_bInitialized = false;
+}
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// postprocessmanager.h
+// ============
+// process the finished frame - HDR, bloom, tone mapping and color grading
+//
+//  The scene is drawn into a half float target, so the spotlight can be
+//  brighter than white.  The bright parts are halved again and again by
+//  compute shaders starting at half resolution, then added back up, which
+//  makes a wide glow for the cost of a few small images.  Adding the glow,
+//  tone mapping, grading and writing the frame are one full screen pass.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+
+/***********************************************************
+ *  PostProcessManager
+ *
+ *  This class contains the code for the HDR target of the
+ *  scene and the passes that turn it into the frame shown.
+ ***********************************************************/
+class PostProcessManager
+{
+public:
+	// constructor
+	PostProcessManager();
+	// destructor
+	~PostProcessManager();
+
+	// how the bloom is made and the colors are graded
+	struct SETTINGS
+	{
+		// brightness where the glow starts, and the range it fades
+		// in over
+		float bloomThreshold;
+		float bloomKnee;
+		float bloomStrength;
+		// blur of each upsampling step, in texels
+		float bloomRadius;
+		float exposure;
+		glm::vec3 colorBalance;
+		float contrast;
+		float saturation;
+		glm::vec3 lift;
+	};
+
+	// most times the bloom image is halved
+	static const int MAX_BLOOM_LEVELS = 6;
+
+private:
+	// timed parts of a frame
+	enum STAGE
+	{
+		STAGE_SCENE,
+		STAGE_BLOOM_DOWNSAMPLE,
+		STAGE_BLOOM_UPSAMPLE,
+		STAGE_COMPOSITE,
+		STAGE_COUNT
+	};
+
+	bool m_bInitialized;
+	// the bloom needs compute shaders, without them only the
+	// tone mapping and grading are done
+	bool m_bUseBloom;
+	SETTINGS m_settings;
+
+	// uniforms of the programs, looked up once after they link
+	enum DOWNSAMPLE_UNIFORM
+	{
+		DOWNSAMPLE_THRESHOLD,
+		DOWNSAMPLE_KNEE,
+		DOWNSAMPLE_SOURCE_TEXTURE,
+		DOWNSAMPLE_SOURCE_LEVEL,
+		DOWNSAMPLE_SOURCE_TEXEL_SIZE,
+		DOWNSAMPLE_TARGET_SIZE,
+		DOWNSAMPLE_PREFILTER,
+		DOWNSAMPLE_UNIFORM_COUNT
+	};
+	enum UPSAMPLE_UNIFORM
+	{
+		UPSAMPLE_SOURCE_TEXTURE,
+		UPSAMPLE_RADIUS,
+		UPSAMPLE_SOURCE_LEVEL,
+		UPSAMPLE_SOURCE_TEXEL_SIZE,
+		UPSAMPLE_TARGET_SIZE,
+		UPSAMPLE_UNIFORM_COUNT
+	};
+	enum COMPOSITE_UNIFORM
+	{
+		COMPOSITE_SCENE_TEXTURE,
+		COMPOSITE_BLOOM_TEXTURE,
+		COMPOSITE_USE_BLOOM,
+		COMPOSITE_BLOOM_STRENGTH,
+		COMPOSITE_EXPOSURE,
+		COMPOSITE_COLOR_BALANCE,
+		COMPOSITE_CONTRAST,
+		COMPOSITE_SATURATION,
+		COMPOSITE_LIFT,
+		COMPOSITE_UNIFORM_COUNT
+	};
+
+	GLProgram m_downsampleProgram;
+	GLProgram m_upsampleProgram;
+	GLProgram m_compositeProgram;
+	GLint m_downsampleLocations[DOWNSAMPLE_UNIFORM_COUNT];
+	GLint m_upsampleLocations[UPSAMPLE_UNIFORM_COUNT];
+	GLint m_compositeLocations[COMPOSITE_UNIFORM_COUNT];
+	GLVertexArray m_emptyVertexArray;
+
+	// HDR target of the scene
+	GLFramebuffer m_framebuffer;
+	GLTexture m_colorTexture;
+	GLRenderbuffer m_depthBuffer;
+	int m_width;
+	int m_height;
+	// the bloom images, one level per halving from half size
+	GLTexture m_bloomTexture;
+	int m_bloomLevels;
+	size_t m_bloomBytes;
+
+	// framebuffer and viewport the frame is written to
+	GLint m_outputFramebuffer;
+	GLint m_outputViewport[4];
+	bool m_bFrameStarted;
+
+	// GPU timestamps between the stages, a few frames deep so
+	// reading them never waits
+	static const int TIMER_FRAMES = 3;
+	GLuint m_timestampQueries[TIMER_FRAMES][STAGE_COUNT + 1];
+	bool m_bTimerPending[TIMER_FRAMES];
+	int m_timerFrame;
+
+	// statistics, reported every few seconds
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	double m_stageMilliseconds[STAGE_COUNT];
+	int m_timerSamples;
+
+	// compile a shader file and link programs
+	static GLuint CompileShaderFile(GLenum type, const char* filename);
+	static GLuint LinkProgram(GLuint firstShader, GLuint secondShader);
+
+	// create the HDR target and bloom images for a frame size
+	void ResizeTargets(int width, int height);
+	void DestroyTargets();
+
+	// halve the bright parts of the scene down the bloom levels,
+	// then add each level back into the one above it
+	void DownsampleBloom();
+	void UpsampleBloom();
+	// add the bloom, tone map, grade and write the frame
+	void Composite();
+
+	// add the finished GPU timers to the statistics
+	void CollectTimers();
+	void ReportStatistics();
+
+public:
+	// compile the programs, the bloom when compute shaders are
+	// available
+	bool Initialize();
+	bool IsInitialized() const;
+
+	void SetSettings(const SETTINGS& settings);
+	const SETTINGS& GetSettings() const;
+
+	// draw the scene into the HDR target between these calls, the
+	// frame is written to the framebuffer bound at BeginFrame
+	void BeginFrame(int width, int height);
+	void EndFrame();
+
+	// free the OpenGL objects
+	void Release();
+};
@@ -0,0 +1,480 @@
+///////////////////////////////////////////////////////////////////////////////
+// proceduraltexturemanager.cpp
+// ============
+// generate material textures - wood and marble from noise and a few numbers
+//
+//  The noise lattice wraps at its frequency, so every octave, and the
+//  pattern built from them, repeats once across the texture.  Baking does
+//  four pixels of a row at a time with SSE2, which matches the scalar code
+//  used for the pixels left over at the end of a row.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProceduralTextureManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <thread>
+#include <vector>
+
+// SSE2 is part of every x64 processor
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PROCEDURAL_USE_SSE 1
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// seed offset of the wood grain, and how much finer it is than
+	// the noise bending the rings
+	const uint32_t g_GrainSeed = 101;
+	const int g_GrainScaleU = 2;
+	const int g_GrainScaleV = 16;
+	// share of the ring profile and the grain in the wood shade
+	const float g_WoodRingShare = 0.75f;
+	// share of the noise in the marble shade between the veins
+	const float g_MarbleCloudShare = 0.15f;
+	// fewest rows baked by one worker
+	const int g_MinRowsPerWorker = 16;
+
+	// the same integer hash as the scene shader
+	uint32_t Hash(uint32_t x)
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352dU;
+		x ^= x >> 15;
+		x *= 0x846ca68bU;
+		x ^= x >> 16;
+		return(x);
+	}
+
+	uint32_t HashLattice(int x, int y, uint32_t seed)
+	{
+		return(Hash((uint32_t)x ^ Hash((uint32_t)y ^ seed)));
+	}
+
+	int WrapCell(int cell, int period)
+	{
+		int wrapped = cell % period;
+		return((wrapped < 0) ? wrapped + period : wrapped);
+	}
+
+	float Fade(float t)
+	{
+		return(t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f));
+	}
+
+	float Mix(float a, float b, float t)
+	{
+		return(a + (b - a) * t);
+	}
+
+	// one of four diagonal gradients, picked by the hash
+	float Gradient(uint32_t hash, float dx, float dy)
+	{
+		return(((hash & 1) ? -dx : dx) + ((hash & 2) ? -dy : dy));
+	}
+
+	// gradient noise repeating every period cells, about -1 to 1
+	float GradientNoise(float x, float y, int periodX, int periodY, uint32_t seed)
+	{
+		float cellX = std::floor(x);
+		float cellY = std::floor(y);
+		float dx = x - cellX;
+		float dy = y - cellY;
+		int x0 = WrapCell((int)cellX, periodX);
+		int y0 = WrapCell((int)cellY, periodY);
+		int x1 = WrapCell(x0 + 1, periodX);
+		int y1 = WrapCell(y0 + 1, periodY);
+
+		float n00 = Gradient(HashLattice(x0, y0, seed), dx, dy);
+		float n10 = Gradient(HashLattice(x1, y0, seed), dx - 1.0f, dy);
+		float n01 = Gradient(HashLattice(x0, y1, seed), dx, dy - 1.0f);
+		float n11 = Gradient(HashLattice(x1, y1, seed), dx - 1.0f, dy - 1.0f);
+		float fadeX = Fade(dx);
+		return(Mix(Mix(n00, n10, fadeX), Mix(n01, n11, fadeX), Fade(dy)));
+	}
+
+	// value noise repeating every period cells, 0 to 1
+	float ValueNoise(float x, float y, int periodX, int periodY, uint32_t seed)
+	{
+		float cellX = std::floor(x);
+		float cellY = std::floor(y);
+		int x0 = WrapCell((int)cellX, periodX);
+		int y0 = WrapCell((int)cellY, periodY);
+		int x1 = WrapCell(x0 + 1, periodX);
+		int y1 = WrapCell(y0 + 1, periodY);
+
+		const float scale = 1.0f / 16777216.0f;
+		float v00 = (float)(HashLattice(x0, y0, seed) >> 8) * scale;
+		float v10 = (float)(HashLattice(x1, y0, seed) >> 8) * scale;
+		float v01 = (float)(HashLattice(x0, y1, seed) >> 8) * scale;
+		float v11 = (float)(HashLattice(x1, y1, seed) >> 8) * scale;
+		float fadeX = Fade(x - cellX);
+		return(Mix(Mix(v00, v10, fadeX), Mix(v01, v11, fadeX), Fade(y - cellY)));
+	}
+
+	// octaves of gradient noise, each twice as fine and half as strong
+	float Turbulence(const ProceduralTextureManager::PATTERN& pattern, float u, float v)
+	{
+		float sum = 0.0f;
+		float total = 0.0f;
+		float amplitude = 1.0f;
+		int frequencyU = pattern.frequencyU;
+		int frequencyV = pattern.frequencyV;
+		for (int octave = 0; octave < pattern.octaves; octave++)
+		{
+			sum += amplitude * GradientNoise(u * frequencyU, v * frequencyV, frequencyU, frequencyV, pattern.seed + octave);
+			total += amplitude;
+			amplitude *= 0.5f;
+			frequencyU *= 2;
+			frequencyV *= 2;
+		}
+		return((total > 0.0f) ? sum / total : 0.0f);
+	}
+
+	// 0 at whole numbers rising to 1 halfway between them
+	float Triangle(float t)
+	{
+		return(1.0f - std::fabs(2.0f * (t - std::floor(t)) - 1.0f));
+	}
+
+	// shade of the pattern from dark at 0 to light at 1
+	float Shade(const ProceduralTextureManager::PATTERN& pattern, float u, float v)
+	{
+		float noise = Turbulence(pattern, u, v);
+		float shade = 0.0f;
+		if (pattern.type == ProceduralTextureManager::WOOD_PATTERN)
+		{
+			float ring = Triangle(v * pattern.bands + pattern.turbulence * noise);
+			float profile = ring * ring * (3.0f - 2.0f * ring);
+			int grainU = pattern.frequencyU * g_GrainScaleU;
+			int grainV = pattern.frequencyV * g_GrainScaleV;
+			float grain = ValueNoise(u * grainU, v * grainV, grainU, grainV, pattern.seed + g_GrainSeed);
+			shade = g_WoodRingShare * profile + (1.0f - g_WoodRingShare) * grain;
+		}
+		else
+		{
+			float vein = Triangle(u * pattern.bands + pattern.turbulence * noise);
+			vein *= vein;
+			vein *= vein;
+			vein *= vein;
+			shade = (1.0f - vein) * ((1.0f - g_MarbleCloudShare) + g_MarbleCloudShare * noise);
+		}
+		return(std::min(std::max(shade, 0.0f), 1.0f));
+	}
+
+	unsigned char ToByte(float value)
+	{
+		return((unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f));
+	}
+
+#ifdef PROCEDURAL_USE_SSE
+	// SSE2 has no 32 bit multiply, so the even and odd lanes are
+	// multiplied as 64 bit values and put back together
+	__m128i Multiply4(__m128i a, __m128i b)
+	{
+		__m128i even = _mm_mul_epu32(a, b);
+		__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+		return(_mm_unpacklo_epi32(
+			_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+			_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0))));
+	}
+
+	__m128i Hash4(__m128i x)
+	{
+		x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+		x = Multiply4(x, _mm_set1_epi32(0x7feb352d));
+		x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+		x = Multiply4(x, _mm_set1_epi32((int)0x846ca68bU));
+		x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+		return(x);
+	}
+
+	__m128i HashLattice4(__m128i x, __m128i y, __m128i seed)
+	{
+		return(Hash4(_mm_xor_si128(x, Hash4(_mm_xor_si128(y, seed)))));
+	}
+
+	// SSE2 only truncates, so values below their truncation step down
+	__m128 Floor4(__m128 x)
+	{
+		__m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+		return(_mm_sub_ps(truncated, _mm_and_ps(_mm_cmplt_ps(x, truncated), _mm_set1_ps(1.0f))));
+	}
+
+	// cells are at most one period outside the lattice here
+	__m128i WrapCell4(__m128i cell, __m128i period)
+	{
+		cell = _mm_add_epi32(cell, _mm_and_si128(_mm_cmplt_epi32(cell, _mm_setzero_si128()), period));
+		__m128i outside = _mm_cmpgt_epi32(cell, _mm_sub_epi32(period, _mm_set1_epi32(1)));
+		return(_mm_sub_epi32(cell, _mm_and_si128(outside, period)));
+	}
+
+	__m128 Fade4(__m128 t)
+	{
+		__m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))), _mm_set1_ps(10.0f));
+		return(_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner));
+	}
+
+	__m128 Mix4(__m128 a, __m128 b, __m128 t)
+	{
+		return(_mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+	}
+
+	// the low hash bits flip the signs of the offsets
+	__m128 Gradient4(__m128i hash, __m128 dx, __m128 dy)
+	{
+		__m128 signX = _mm_castsi128_ps(_mm_slli_epi32(hash, 31));
+		__m128 signY = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(hash, 1), 31));
+		return(_mm_add_ps(_mm_xor_ps(dx, signX), _mm_xor_ps(dy, signY)));
+	}
+
+	__m128 GradientNoise4(__m128 x, __m128 y, int periodX, int periodY, uint32_t seed)
+	{
+		__m128 cellX = Floor4(x);
+		__m128 cellY = Floor4(y);
+		__m128 dx = _mm_sub_ps(x, cellX);
+		__m128 dy = _mm_sub_ps(y, cellY);
+		__m128i periodsX = _mm_set1_epi32(periodX);
+		__m128i periodsY = _mm_set1_epi32(periodY);
+		__m128i one = _mm_set1_epi32(1);
+		__m128i x0 = WrapCell4(_mm_cvttps_epi32(cellX), periodsX);
+		__m128i y0 = WrapCell4(_mm_cvttps_epi32(cellY), periodsY);
+		__m128i x1 = WrapCell4(_mm_add_epi32(x0, one), periodsX);
+		__m128i y1 = WrapCell4(_mm_add_epi32(y0, one), periodsY);
+		__m128i seeds = _mm_set1_epi32((int)seed);
+		__m128 oneFloat = _mm_set1_ps(1.0f);
+		__m128 dx1 = _mm_sub_ps(dx, oneFloat);
+		__m128 dy1 = _mm_sub_ps(dy, oneFloat);
+
+		__m128 n00 = Gradient4(HashLattice4(x0, y0, seeds), dx, dy);
+		__m128 n10 = Gradient4(HashLattice4(x1, y0, seeds), dx1, dy);
+		__m128 n01 = Gradient4(HashLattice4(x0, y1, seeds), dx, dy1);
+		__m128 n11 = Gradient4(HashLattice4(x1, y1, seeds), dx1, dy1);
+		__m128 fadeX = Fade4(dx);
+		return(Mix4(Mix4(n00, n10, fadeX), Mix4(n01, n11, fadeX), Fade4(dy)));
+	}
+
+	__m128 ValueNoise4(__m128 x, __m128 y, int periodX, int periodY, uint32_t seed)
+	{
+		__m128 cellX = Floor4(x);
+		__m128 cellY = Floor4(y);
+		__m128i periodsX = _mm_set1_epi32(periodX);
+		__m128i periodsY = _mm_set1_epi32(periodY);
+		__m128i one = _mm_set1_epi32(1);
+		__m128i x0 = WrapCell4(_mm_cvttps_epi32(cellX), periodsX);
+		__m128i y0 = WrapCell4(_mm_cvttps_epi32(cellY), periodsY);
+		__m128i x1 = WrapCell4(_mm_add_epi32(x0, one), periodsX);
+		__m128i y1 = WrapCell4(_mm_add_epi32(y0, one), periodsY);
+		__m128i seeds = _mm_set1_epi32((int)seed);
+		__m128 scale = _mm_set1_ps(1.0f / 16777216.0f);
+
+		__m128 v00 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(HashLattice4(x0, y0, seeds), 8)), scale);
+		__m128 v10 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(HashLattice4(x1, y0, seeds), 8)), scale);
+		__m128 v01 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(HashLattice4(x0, y1, seeds), 8)), scale);
+		__m128 v11 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(HashLattice4(x1, y1, seeds), 8)), scale);
+		__m128 fadeX = Fade4(_mm_sub_ps(x, cellX));
+		return(Mix4(Mix4(v00, v10, fadeX), Mix4(v01, v11, fadeX), Fade4(_mm_sub_ps(y, cellY))));
+	}
+
+	__m128 Turbulence4(const ProceduralTextureManager::PATTERN& pattern, __m128 u, __m128 v)
+	{
+		__m128 sum = _mm_setzero_ps();
+		float total = 0.0f;
+		float amplitude = 1.0f;
+		int frequencyU = pattern.frequencyU;
+		int frequencyV = pattern.frequencyV;
+		for (int octave = 0; octave < pattern.octaves; octave++)
+		{
+			__m128 noise = GradientNoise4(
+				_mm_mul_ps(u, _mm_set1_ps((float)frequencyU)),
+				_mm_mul_ps(v, _mm_set1_ps((float)frequencyV)),
+				frequencyU, frequencyV, pattern.seed + octave);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(amplitude), noise));
+			total += amplitude;
+			amplitude *= 0.5f;
+			frequencyU *= 2;
+			frequencyV *= 2;
+		}
+		return((total > 0.0f) ? _mm_div_ps(sum, _mm_set1_ps(total)) : sum);
+	}
+
+	__m128 Triangle4(__m128 t)
+	{
+		__m128 wave = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(2.0f), _mm_sub_ps(t, Floor4(t))), _mm_set1_ps(1.0f));
+		__m128 absolute = _mm_andnot_ps(_mm_set1_ps(-0.0f), wave);
+		return(_mm_sub_ps(_mm_set1_ps(1.0f), absolute));
+	}
+
+	__m128 Shade4(const ProceduralTextureManager::PATTERN& pattern, __m128 u, __m128 v)
+	{
+		__m128 noise = Turbulence4(pattern, u, v);
+		__m128 turbulence = _mm_mul_ps(_mm_set1_ps(pattern.turbulence), noise);
+		__m128 bands = _mm_set1_ps((float)pattern.bands);
+		__m128 one = _mm_set1_ps(1.0f);
+		__m128 shade;
+		if (pattern.type == ProceduralTextureManager::WOOD_PATTERN)
+		{
+			__m128 ring = Triangle4(_mm_add_ps(_mm_mul_ps(v, bands), turbulence));
+			__m128 profile = _mm_mul_ps(_mm_mul_ps(ring, ring), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_add_ps(ring, ring)));
+			int grainU = pattern.frequencyU * g_GrainScaleU;
+			int grainV = pattern.frequencyV * g_GrainScaleV;
+			__m128 grain = ValueNoise4(
+				_mm_mul_ps(u, _mm_set1_ps((float)grainU)),
+				_mm_mul_ps(v, _mm_set1_ps((float)grainV)),
+				grainU, grainV, pattern.seed + g_GrainSeed);
+			shade = _mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(g_WoodRingShare), profile),
+				_mm_mul_ps(_mm_set1_ps(1.0f - g_WoodRingShare), grain));
+		}
+		else
+		{
+			__m128 vein = Triangle4(_mm_add_ps(_mm_mul_ps(u, bands), turbulence));
+			vein = _mm_mul_ps(vein, vein);
+			vein = _mm_mul_ps(vein, vein);
+			vein = _mm_mul_ps(vein, vein);
+			__m128 cloud = _mm_add_ps(_mm_set1_ps(1.0f - g_MarbleCloudShare), _mm_mul_ps(_mm_set1_ps(g_MarbleCloudShare), noise));
+			shade = _mm_mul_ps(_mm_sub_ps(one, vein), cloud);
+		}
+		return(_mm_min_ps(_mm_max_ps(shade, _mm_setzero_ps()), one));
+	}
+#endif
+
+	// bake a band of rows of the pattern
+	void GenerateRows(
+		const ProceduralTextureManager::PATTERN& pattern,
+		int width,
+		int height,
+		int firstRow,
+		int lastRow,
+		unsigned char* pPixels)
+	{
+		for (int y = firstRow; y < lastRow; y++)
+		{
+			float v = (y + 0.5f) / height;
+			unsigned char* pRow = pPixels + (size_t)y * width * 4;
+			int x = 0;
+#ifdef PROCEDURAL_USE_SSE
+			__m128 rowV = _mm_set1_ps(v);
+			__m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			__m128 inverseWidth = _mm_set1_ps(1.0f / width);
+			for (; x + 4 <= width; x += 4)
+			{
+				__m128 u = _mm_mul_ps(_mm_add_ps(_mm_set1_ps((float)x), lanes), inverseWidth);
+				float shades[4];
+				_mm_storeu_ps(shades, Shade4(pattern, u, rowV));
+				for (int lane = 0; lane < 4; lane++)
+				{
+					glm::vec3 color = glm::mix(pattern.darkColor, pattern.lightColor, shades[lane]);
+					unsigned char* pPixel = pRow + (size_t)(x + lane) * 4;
+					pPixel[0] = ToByte(color.r);
+					pPixel[1] = ToByte(color.g);
+					pPixel[2] = ToByte(color.b);
+					pPixel[3] = 255;
+				}
+			}
+#endif
+			for (; x < width; x++)
+			{
+				glm::vec3 color = ProceduralTextureManager::Evaluate(pattern, (x + 0.5f) / width, v);
+				unsigned char* pPixel = pRow + (size_t)x * 4;
+				pPixel[0] = ToByte(color.r);
+				pPixel[1] = ToByte(color.g);
+				pPixel[2] = ToByte(color.b);
+				pPixel[3] = 255;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  Evaluate()
+ *
+ *  This method is used for getting the color of a pattern
+ *  at a texture coordinate, one pixel at a time.
+ ***********************************************************/
+glm::vec3 ProceduralTextureManager::Evaluate(const PATTERN& pattern, float u, float v)
+{
+	return(glm::mix(pattern.darkColor, pattern.lightColor, Shade(pattern, u, v)));
+}
+
+/***********************************************************
+ *  Generate()
+ *
+ *  This method is used for baking a pattern into RGBA
+ *  pixels.  The rows are split into bands baked on worker
+ *  threads, one per processor core.
+ ***********************************************************/
+void ProceduralTextureManager::Generate(const PATTERN& pattern, int width, int height, unsigned char* pPixels)
+{
+	if ((NULL == pPixels) || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	int workers = std::max((int)std::thread::hardware_concurrency(), 1);
+	workers = std::max(std::min(workers, height / g_MinRowsPerWorker), 1);
+	int rowsPerWorker = (height + workers - 1) / workers;
+
+	std::vector<std::future<void>> bands;
+	for (int firstRow = rowsPerWorker; firstRow < height; firstRow += rowsPerWorker)
+	{
+		int lastRow = std::min(firstRow + rowsPerWorker, height);
+		bands.push_back(std::async(std::launch::async, GenerateRows,
+			std::cref(pattern), width, height, firstRow, lastRow, pPixels));
+	}
+	// the first band is baked on this thread
+	GenerateRows(pattern, width, height, 0, std::min(rowsPerWorker, height), pPixels);
+	for (std::future<void>& band : bands)
+	{
+		band.wait();
+	}
+}
+
+/***********************************************************
+ *  SetShaderPattern()
+ *
+ *  This method is used for setting the shader values that
+ *  draw a pattern in the scene shader instead of reading a
+ *  texture.
+ ***********************************************************/
+void ProceduralTextureManager::SetShaderPattern(ShaderManager* pShaderManager, const PATTERN& pattern)
+{
+	if (NULL == pShaderManager)
+	{
+		return;
+	}
+
+	pShaderManager->setBoolValue("bUseProceduralTexture", true);
+	pShaderManager->setIntValue("procedural.type", (int)pattern.type);
+	pShaderManager->setVec3Value("procedural.lightColor", pattern.lightColor);
+	pShaderManager->setVec3Value("procedural.darkColor", pattern.darkColor);
+	pShaderManager->setVec2Value("procedural.frequency", glm::vec2((float)pattern.frequencyU, (float)pattern.frequencyV));
+	pShaderManager->setIntValue("procedural.octaves", std::min(pattern.octaves, (int)MAX_OCTAVES));
+	pShaderManager->setFloatValue("procedural.turbulence", pattern.turbulence);
+	pShaderManager->setFloatValue("procedural.bands", (float)pattern.bands);
+	pShaderManager->setIntValue("procedural.seed", (int)pattern.seed);
+}
+
+/***********************************************************
+ *  GetBackendPattern()
+ *
+ *  This method is used for getting the values of a pattern
+ *  in the form the render backend writes them, the same
+ *  values SetShaderPattern() sets.
+ ***********************************************************/
+RenderBackend::PATTERN ProceduralTextureManager::GetBackendPattern(const PATTERN& pattern)
+{
+	RenderBackend::PATTERN backendPattern;
+	backendPattern.type = (int)pattern.type;
+	backendPattern.lightColor = pattern.lightColor;
+	backendPattern.darkColor = pattern.darkColor;
+	backendPattern.frequency = glm::vec2((float)pattern.frequencyU, (float)pattern.frequencyV);
+	backendPattern.octaves = std::min(pattern.octaves, (int)MAX_OCTAVES);
+	backendPattern.turbulence = pattern.turbulence;
+	backendPattern.bands = (float)pattern.bands;
+	backendPattern.seed = (int)pattern.seed;
+	return(backendPattern);
+}
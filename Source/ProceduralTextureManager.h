@@ -0,0 +1,68 @@
+///////////////////////////////////////////////////////////////////////////////
+// proceduraltexturemanager.h
+// ============
+// generate material textures - wood and marble from noise and a few numbers
+//
+//  A pattern is described by its colors, noise frequencies and band count,
+//  and repeats seamlessly across the texture.  It can be baked into pixels
+//  of any size, with SSE and on worker threads, or drawn straight from the
+//  scene shader, which uses the same hash and noise so both look the same.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderBackend.h"
+#include "ShaderManager.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+/***********************************************************
+ *  ProceduralTextureManager
+ *
+ *  This class contains the code for evaluating the wood and
+ *  marble patterns.  Patterns hold no OpenGL objects, so
+ *  everything is static.
+ ***********************************************************/
+class ProceduralTextureManager
+{
+public:
+	enum PATTERN_TYPE
+	{
+		// rings across the V direction, bent by noise, with fine
+		// grain along U
+		WOOD_PATTERN,
+		// dark veins across the U direction, bent by noise
+		MARBLE_PATTERN
+	};
+
+	struct PATTERN
+	{
+		PATTERN_TYPE type;
+		glm::vec3 lightColor;
+		glm::vec3 darkColor;
+		// noise cells across U and V, whole numbers so the pattern
+		// repeats, doubled for each octave
+		int frequencyU;
+		int frequencyV;
+		int octaves;
+		// how far the noise bends the rings or veins
+		float turbulence;
+		// rings or veins across the texture, a whole number
+		int bands;
+		uint32_t seed;
+	};
+
+	// most octaves the shader evaluates
+	static const int MAX_OCTAVES = 8;
+
+	// bake a pattern into RGBA pixels, rows split over worker threads
+	static void Generate(const PATTERN& pattern, int width, int height, unsigned char* pPixels);
+	// color of a pattern at a texture coordinate, without SSE
+	static glm::vec3 Evaluate(const PATTERN& pattern, float u, float v);
+	// set the shader values for drawing a pattern in the scene shader
+	static void SetShaderPattern(ShaderManager* pShaderManager, const PATTERN& pattern);
+	// the values the render backend draws a pattern with
+	static RenderBackend::PATTERN GetBackendPattern(const PATTERN& pattern);
+};
@@ -0,0 +1,432 @@
+///////////////////////////////////////////////////////////////////////////////
+// profilemanager.cpp
+// ============
+// sample the GPU cost of the scene objects - rotating per draw timer queries
+//
+//  The draws of a frame are numbered as they are made.  The draws timed
+//  are the next few after those timed in the frame before, counted round
+//  the number of draws that frame had, so the timed share walks over the
+//  whole scene.  Timer queries cannot nest, so only one draw is timed at
+//  a time, and the times of a frame are read when its queries are about
+//  to be used again, a few frames later, without waiting.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ProfileManager.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// draws timed in each frame unless set otherwise
+	const int g_DefaultSamplesPerFrame = 16;
+	// objects listed in the report, the materials are all listed
+	const int g_ReportedObjects = 20;
+	const int g_ReportedMaterials = 1000;
+}
+
+/***********************************************************
+ *  ProfileManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ProfileManager::ProfileManager()
+{
+	m_bInitialized = false;
+	m_samplesPerFrame = g_DefaultSamplesPerFrame;
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		for (int s = 0; s < MAX_SAMPLES; s++)
+		{
+			m_frames[f].queries[s] = 0;
+		}
+		m_frames[f].sampleCount = 0;
+		m_frames[f].drawCount = 0;
+		m_frames[f].bPending = false;
+	}
+	m_frame = 0;
+	m_bFrameStarted = false;
+	m_drawIndex = 0;
+	m_firstSample = 0;
+	m_lastDrawCount = 0;
+	m_openSample = -1;
+	m_framesRead = 0;
+	m_framesLate = 0;
+}
+
+/***********************************************************
+ *  ~ProfileManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ProfileManager::~ProfileManager()
+{
+	Release();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the timer queries.
+ ***********************************************************/
+bool ProfileManager::Initialize()
+{
+	if (m_bInitialized)
+	{
+		return(true);
+	}
+
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		glGenQueries(MAX_SAMPLES, m_frames[f].queries);
+		m_frames[f].sampleCount = 0;
+		m_frames[f].bPending = false;
+	}
+	m_bInitialized = true;
+
+	std::cout << "INFO: Timing " << m_samplesPerFrame << " draws a frame to rank the objects by GPU cost" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  IsInitialized()
+ *
+ *  This method is used for checking whether the timer
+ *  queries were made.
+ ***********************************************************/
+bool ProfileManager::IsInitialized() const
+{
+	return(m_bInitialized);
+}
+
+/***********************************************************
+ *  SetSamplesPerFrame()
+ *
+ *  This method is used for setting how many draws are
+ *  timed in each frame.  More draws cover the scene in
+ *  fewer frames, at the cost of more queries.
+ ***********************************************************/
+void ProfileManager::SetSamplesPerFrame(int sampleCount)
+{
+	m_samplesPerFrame = std::min(std::max(sampleCount, 1), (int)MAX_SAMPLES);
+}
+
+/***********************************************************
+ *  FindEntry()
+ *
+ *  This method is used for finding the cost entry of an
+ *  object tag or material, adding one the first time.
+ ***********************************************************/
+int ProfileManager::FindEntry(
+	std::vector<COST_ENTRY>& costs,
+	std::map<std::string, int>& entries,
+	const std::string& name)
+{
+	std::map<std::string, int>::iterator found = entries.find(name);
+	if (found != entries.end())
+	{
+		return(found->second);
+	}
+
+	COST_ENTRY entry;
+	entry.name = name;
+	entry.samples = 0;
+	entry.totalMicroseconds = 0.0;
+	entry.maxMicroseconds = 0.0;
+	entry.estimatedMicroseconds = 0.0;
+	costs.push_back(entry);
+	entries[name] = (int)costs.size() - 1;
+	return((int)costs.size() - 1);
+}
+
+/***********************************************************
+ *  CloseFrame()
+ *
+ *  This method is used for ending the frame drawn since it
+ *  was begun, and moving the timed share past its draws.
+ ***********************************************************/
+void ProfileManager::CloseFrame()
+{
+	if (!m_bFrameStarted)
+	{
+		return;
+	}
+
+	FRAME_SAMPLES& frame = m_frames[m_frame];
+	frame.drawCount = m_drawIndex;
+	frame.bPending = (frame.sampleCount > 0);
+	if (m_drawIndex > 0)
+	{
+		m_firstSample = (m_firstSample + m_samplesPerFrame) % m_drawIndex;
+	}
+	m_lastDrawCount = m_drawIndex;
+	m_frame = (m_frame + 1) % TIMER_FRAMES;
+	m_bFrameStarted = false;
+}
+
+/***********************************************************
+ *  ReadFrame()
+ *
+ *  This method is used for charging the times of a frame to
+ *  the objects and materials drawn.  Without waiting, false
+ *  is returned when the times are not ready yet.
+ ***********************************************************/
+bool ProfileManager::ReadFrame(FRAME_SAMPLES& frame, bool bWait)
+{
+	if (!frame.bPending)
+	{
+		return(true);
+	}
+
+	// queries finish in order, so the last one ready means all are
+	if (!bWait)
+	{
+		GLuint available = 0;
+		glGetQueryObjectuiv(frame.queries[frame.sampleCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			return(false);
+		}
+	}
+
+	// each timed draw stands for the untimed draws of its frame
+	double weight = std::max((double)frame.drawCount / frame.sampleCount, 1.0);
+	for (int s = 0; s < frame.sampleCount; s++)
+	{
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(frame.queries[s], GL_QUERY_RESULT, &nanoseconds);
+		double microseconds = nanoseconds / 1.0e3;
+
+		COST_ENTRY* pEntries[2] =
+		{
+			&m_objectCosts[frame.samples[s].objectEntry],
+			&m_materialCosts[frame.samples[s].materialEntry]
+		};
+		for (COST_ENTRY* pEntry : pEntries)
+		{
+			pEntry->samples++;
+			pEntry->totalMicroseconds += microseconds;
+			pEntry->maxMicroseconds = std::max(pEntry->maxMicroseconds, microseconds);
+			pEntry->estimatedMicroseconds += microseconds * weight;
+		}
+	}
+
+	frame.bPending = false;
+	m_framesRead++;
+	return(true);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for ending the frame before, reading
+ *  the times of the frame whose queries are used next, and
+ *  starting to count the draws of a new frame.
+ ***********************************************************/
+void ProfileManager::BeginFrame()
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	CloseFrame();
+
+	// times still not ready are dropped rather than waited for
+	FRAME_SAMPLES& frame = m_frames[m_frame];
+	if (!ReadFrame(frame, false))
+	{
+		frame.bPending = false;
+		m_framesLate++;
+	}
+
+	frame.sampleCount = 0;
+	frame.drawCount = 0;
+	m_drawIndex = 0;
+	m_openSample = -1;
+	m_bFrameStarted = true;
+}
+
+/***********************************************************
+ *  BeginDraw()
+ *
+ *  This method is used for counting a draw, and starting a
+ *  timer query around it when it is in the share timed this
+ *  frame.  Returns the sample to end, or -1.
+ ***********************************************************/
+int ProfileManager::BeginDraw(const std::string& objectTag, const std::string& materialTag)
+{
+	int drawIndex = m_drawIndex;
+	m_drawIndex++;
+	if (!m_bFrameStarted || (m_openSample >= 0))
+	{
+		return(-1);
+	}
+
+	FRAME_SAMPLES& frame = m_frames[m_frame];
+	if (frame.sampleCount >= m_samplesPerFrame)
+	{
+		return(-1);
+	}
+
+	// the turn counts round the draws of the frame before, so the
+	// share wraps to the first draws after the last ones
+	int turn = drawIndex - m_firstSample;
+	if (m_lastDrawCount > 0)
+	{
+		turn = ((turn % m_lastDrawCount) + m_lastDrawCount) % m_lastDrawCount;
+	}
+	if ((turn < 0) || (turn >= m_samplesPerFrame))
+	{
+		return(-1);
+	}
+
+	int sample = frame.sampleCount;
+	frame.sampleCount++;
+	frame.samples[sample].objectEntry = FindEntry(m_objectCosts, m_objectEntries, objectTag);
+	frame.samples[sample].materialEntry = FindEntry(m_materialCosts, m_materialEntries, materialTag);
+	glBeginQuery(GL_TIME_ELAPSED, frame.queries[sample]);
+	m_openSample = sample;
+
+	return(sample);
+}
+
+/***********************************************************
+ *  EndDraw()
+ *
+ *  This method is used for ending the timer query of a
+ *  timed draw.
+ ***********************************************************/
+void ProfileManager::EndDraw(int sample)
+{
+	if ((sample < 0) || (sample != m_openSample))
+	{
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_openSample = -1;
+}
+
+/***********************************************************
+ *  ReportCosts()
+ *
+ *  This method is used for printing cost entries ranked by
+ *  their estimated time per frame.
+ ***********************************************************/
+void ProfileManager::ReportCosts(const char* title, const std::vector<COST_ENTRY>& costs, int mostLines)
+{
+	std::vector<int> order(costs.size());
+	double totalMicroseconds = 0.0;
+	for (int i = 0; i < (int)costs.size(); i++)
+	{
+		order[i] = i;
+		totalMicroseconds += costs[i].estimatedMicroseconds;
+	}
+	std::sort(order.begin(), order.end(), [&costs](int a, int b)
+		{
+			return(costs[a].estimatedMicroseconds > costs[b].estimatedMicroseconds);
+		});
+
+	double frames = (double)std::max(m_framesRead, 1);
+	std::cout << "INFO: GPU cost by " << title << ", " << std::fixed << std::setprecision(3)
+		<< totalMicroseconds / frames / 1.0e3 << " ms per frame over " << m_framesRead << " frames" << std::endl;
+	std::cout << "    " << std::left << std::setw(28) << title << std::right << std::setw(10) << "ms/frame"
+		<< std::setw(9) << "share" << std::setw(12) << "us/draw" << std::setw(12) << "max us"
+		<< std::setw(10) << "samples" << std::endl;
+	for (int line = 0; (line < mostLines) && (line < (int)order.size()); line++)
+	{
+		const COST_ENTRY& entry = costs[order[line]];
+		double average = (entry.samples > 0) ? entry.totalMicroseconds / entry.samples : 0.0;
+		double share = (totalMicroseconds > 0.0) ? entry.estimatedMicroseconds / totalMicroseconds * 100.0 : 0.0;
+		std::cout << "    " << std::left << std::setw(28) << (entry.name.empty() ? "(none)" : entry.name)
+			<< std::right << std::setprecision(3) << std::setw(10) << entry.estimatedMicroseconds / frames / 1.0e3
+			<< std::setprecision(1) << std::setw(8) << share << "%"
+			<< std::setprecision(2) << std::setw(12) << average
+			<< std::setw(12) << entry.maxMicroseconds << std::setw(10) << entry.samples << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout << std::setprecision(6);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the objects and the
+ *  materials ranked by their GPU cost per frame.
+ ***********************************************************/
+void ProfileManager::Report()
+{
+	if (m_framesRead == 0)
+	{
+		std::cout << "INFO: No draws were timed for the GPU cost report" << std::endl;
+		return;
+	}
+
+	// software renderers without timer queries report zero
+	double totalMicroseconds = 0.0;
+	for (const COST_ENTRY& entry : m_objectCosts)
+	{
+		totalMicroseconds += entry.totalMicroseconds;
+	}
+	if (totalMicroseconds <= 0.0)
+	{
+		std::cout << "INFO: GPU timer queries returned no times, the objects cannot be ranked" << std::endl;
+		return;
+	}
+
+	ReportCosts("object", m_objectCosts, g_ReportedObjects);
+	ReportCosts("material", m_materialCosts, g_ReportedMaterials);
+	if (m_framesLate > 0)
+	{
+		std::cout << "INFO: " << m_framesLate << " frames of times were dropped, not ready in time" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for waiting for the times still on
+ *  the way, printing the report, and deleting the queries.
+ ***********************************************************/
+void ProfileManager::Release()
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	if (m_openSample >= 0)
+	{
+		EndDraw(m_openSample);
+	}
+	CloseFrame();
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		ReadFrame(m_frames[f], true);
+	}
+	Report();
+
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		glDeleteQueries(MAX_SAMPLES, m_frames[f].queries);
+		for (int s = 0; s < MAX_SAMPLES; s++)
+		{
+			m_frames[f].queries[s] = 0;
+		}
+		m_frames[f].sampleCount = 0;
+		m_frames[f].bPending = false;
+	}
+	m_objectCosts.clear();
+	m_materialCosts.clear();
+	m_objectEntries.clear();
+	m_materialEntries.clear();
+	m_framesRead = 0;
+	m_framesLate = 0;
+	m_drawIndex = 0;
+	m_firstSample = 0;
+	m_lastDrawCount = 0;
+	m_bInitialized = false;
+}
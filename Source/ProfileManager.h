@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// profilemanager.h
+// ============
+// sample the GPU cost of the scene objects - rotating per draw timer queries
+//
+//  Timing a whole pass tells what the scene costs, but not which objects
+//  cost it.  Each frame a few of the draws of the scene pass are wrapped in
+//  timer queries, starting where the frame before stopped, so over a few
+//  frames every draw is timed.  Each time read is charged to the tag of the
+//  object and to its material, weighted by how many draws of its frame
+//  went untimed, and the totals are ranked in a report when the scene is
+//  released.  Draws overlap on the GPU, so the times rank the objects
+//  against each other more than they add up to the frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ProfileManager
+ *
+ *  This class contains the code for timing a rotating share
+ *  of the draws of each frame and ranking the objects and
+ *  materials by what they cost.
+ ***********************************************************/
+class ProfileManager
+{
+public:
+	// constructor
+	ProfileManager();
+	// destructor
+	~ProfileManager();
+
+	// most draws timed in one frame
+	static const int MAX_SAMPLES = 64;
+
+private:
+	// frames of queries in flight, so reading them never waits
+	static const int TIMER_FRAMES = 3;
+
+	// a timed draw, by its cost entries
+	struct SAMPLE
+	{
+		int objectEntry;
+		int materialEntry;
+	};
+
+	// the draws timed in one frame
+	struct FRAME_SAMPLES
+	{
+		GLuint queries[MAX_SAMPLES];
+		SAMPLE samples[MAX_SAMPLES];
+		int sampleCount;
+		// draws in the frame, timed or not
+		int drawCount;
+		bool bPending;
+	};
+
+	// what the draws of one object tag or material cost
+	struct COST_ENTRY
+	{
+		std::string name;
+		int samples;
+		double totalMicroseconds;
+		double maxMicroseconds;
+		// time spread over the untimed draws of the same frames
+		double estimatedMicroseconds;
+	};
+
+	bool m_bInitialized;
+	int m_samplesPerFrame;
+
+	FRAME_SAMPLES m_frames[TIMER_FRAMES];
+	int m_frame;
+	bool m_bFrameStarted;
+	// draw of the current frame, the first one timed, and the
+	// draws of the frame before
+	int m_drawIndex;
+	int m_firstSample;
+	int m_lastDrawCount;
+	// draw being timed, -1 when there is none
+	int m_openSample;
+
+	std::vector<COST_ENTRY> m_objectCosts;
+	std::vector<COST_ENTRY> m_materialCosts;
+	std::map<std::string, int> m_objectEntries;
+	std::map<std::string, int> m_materialEntries;
+	// frames whose times were read, and frames dropped because
+	// their times were not ready in time
+	int m_framesRead;
+	int m_framesLate;
+
+	// find or add the cost entry of a name
+	static int FindEntry(
+		std::vector<COST_ENTRY>& costs,
+		std::map<std::string, int>& entries,
+		const std::string& name);
+	// end the frame drawn since BeginFrame
+	void CloseFrame();
+	// read the times of a frame, waiting for them when asked
+	bool ReadFrame(FRAME_SAMPLES& frame, bool bWait);
+	// print the entries ranked by their cost per frame
+	void ReportCosts(const char* title, const std::vector<COST_ENTRY>& costs, int mostLines);
+
+public:
+	// make the timer queries, once the context is current
+	bool Initialize();
+	bool IsInitialized() const;
+
+	// set how many draws are timed in each frame
+	void SetSamplesPerFrame(int sampleCount);
+
+	// read the times of an earlier frame and start timing the
+	// draws of a new one
+	void BeginFrame();
+	// time a draw when it is its turn, returning the sample to
+	// end, or -1 when it is not timed
+	int BeginDraw(const std::string& objectTag, const std::string& materialTag);
+	void EndDraw(int sample);
+
+	// print the objects and materials ranked by cost
+	void Report();
+	// print the report and delete the queries
+	void Release();
+};
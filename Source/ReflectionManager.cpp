@@ -0,0 +1,593 @@
+///////////////////////////////////////////////////////////////////////////////
+// reflectionmanager.cpp
+// ============
+// reflect the scene in a flat mirror surface - the polished marble floor
+//
+//  The mirrored camera sits as far under the plane as the camera is above
+//  it.  Its near plane is tilted onto the mirror plane, so nothing under
+//  the floor is drawn into the reflection, without a clip distance in the
+//  scene shader.  Objects are culled against the mirrored view without the
+//  tilt, which would stretch its far plane.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ReflectionManager.h"
+#include "MemoryManager.h"
+#include "PortalManager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ReflectionTextureName = "reflectionTexture";
+	const char* g_ReflectionMatrixName = "reflectionViewProjection";
+	const char* g_ReflectionStrengthName = "reflectionStrength";
+	const char* g_ReflectionDistortionName = "reflectionDistortion";
+	const char* g_UseReflectionName = "bUseReflection";
+
+	// half the frame width and height by default, a quarter of
+	// the pixels
+	const float g_DefaultResolutionScale = 0.5f;
+	// the clip plane sits just under the mirror, so objects
+	// standing on it keep their feet
+	const float g_ClipOffset = 0.02f;
+	// largest change in the view matrix that still counts as the
+	// camera standing still
+	const float g_ViewTolerance = 1.0e-4f;
+	// the clock hands still move while the camera stands still,
+	// so the texture catches up with them once a second
+	const double g_StaticRefreshSeconds = 1.0;
+	// objects narrower than this angle from the mirrored camera,
+	// in radians, cover only a few texels and are not drawn
+	const float g_DetailAngle = 0.008f;
+	// share of the light reflected looking straight down, rising
+	// toward a mirror at grazing angles
+	const float g_ReflectionStrength = 0.08f;
+	// texture coordinates the reflection moves per unit of slope
+	// in the floor pattern
+	const float g_ReflectionDistortion = 0.04f;
+	// the reflection keeps colors brighter than white, in four
+	// bytes per texel
+	const int g_ColorBytesPerTexel = 4;
+	const int g_DepthBytesPerTexel = 4;
+
+	const double g_ReportSeconds = 5.0;
+
+	float Sign(float value)
+	{
+		return((value > 0.0f) ? 1.0f : ((value < 0.0f) ? -1.0f : 0.0f));
+	}
+
+	// move the near plane of a projection onto a view space plane,
+	// keeping the side the plane faces
+	glm::mat4 MakeObliqueProjection(const glm::mat4& projection, glm::vec4 clipPlane)
+	{
+		glm::vec4 corner = glm::inverse(projection) *
+			glm::vec4(Sign(clipPlane.x), Sign(clipPlane.y), 1.0f, 1.0f);
+		glm::vec4 scaled = clipPlane * (2.0f / glm::dot(clipPlane, corner));
+
+		glm::mat4 oblique = projection;
+		for (int i = 0; i < 4; i++)
+		{
+			oblique[i][2] = scaled[i] - projection[i][3];
+		}
+		return(oblique);
+	}
+}
+
+/***********************************************************
+ *  ReflectionManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ReflectionManager::ReflectionManager()
+{
+	m_bInitialized = false;
+	m_resolutionScale = g_DefaultResolutionScale;
+	m_bThrottle = true;
+	m_width = 0;
+	m_height = 0;
+	m_bHasImage = false;
+	m_bDirty = true;
+	m_updatedView = glm::mat4(1.0f);
+	m_updatedProjection = glm::mat4(1.0f);
+	m_updatedPlaneHeight = 0.0f;
+	m_updatedTime = std::chrono::steady_clock::now();
+	m_mirroredView = glm::mat4(1.0f);
+	m_mirroredProjection = glm::mat4(1.0f);
+	m_mirroredPosition = glm::vec3(0.0f);
+	m_planeHeight = 0.0f;
+	m_textureViewProjection = glm::mat4(1.0f);
+	m_outputFramebuffer = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		m_outputViewport[i] = 0;
+	}
+	m_bUpdating = false;
+	m_updateStart = std::chrono::steady_clock::now();
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		m_timerQueries[f] = 0;
+		m_bTimerPending[f] = false;
+	}
+	m_timerFrame = 0;
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_frames = 0;
+	m_updates = 0;
+	m_objectsDrawn = 0;
+	m_objectsCulled = 0;
+	m_objectsTooSmall = 0;
+	m_cpuMilliseconds = 0.0;
+	m_gpuMilliseconds = 0.0;
+	m_gpuSamples = 0;
+}
+
+/***********************************************************
+ *  ~ReflectionManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ReflectionManager::~ReflectionManager()
+{
+	Release();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the GPU timers.  The
+ *  texture is made at the first update, once the frame size
+ *  is known.
+ ***********************************************************/
+bool ReflectionManager::Initialize()
+{
+	if (m_bInitialized)
+	{
+		return(true);
+	}
+
+	glGenQueries(TIMER_FRAMES, m_timerQueries);
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_bInitialized = true;
+
+	std::cout << "INFO: Floor reflection drawn at " << (int)(m_resolutionScale * 100.0f)
+		<< "% of the frame size" << (m_bThrottle ? ", kept while the camera stands still" : "") << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  IsInitialized()
+ *
+ *  This method is used for checking whether the timers were
+ *  created.
+ ***********************************************************/
+bool ReflectionManager::IsInitialized() const
+{
+	return(m_bInitialized);
+}
+
+/***********************************************************
+ *  SetResolutionScale()
+ *
+ *  This method is used for setting the fraction of the
+ *  frame width and height the reflection is drawn at.
+ ***********************************************************/
+void ReflectionManager::SetResolutionScale(float scale)
+{
+	m_resolutionScale = std::min(std::max(scale, 0.05f), 1.0f);
+	m_bDirty = true;
+}
+
+/***********************************************************
+ *  SetThrottle()
+ *
+ *  This method is used for choosing whether the texture is
+ *  kept while the camera stands still, or drawn every frame
+ *  so a frame never depends on the frames before it.
+ ***********************************************************/
+void ReflectionManager::SetThrottle(bool bThrottle)
+{
+	m_bThrottle = bThrottle;
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for drawing the texture again at the
+ *  next update, when the scene changed under a still camera.
+ ***********************************************************/
+void ReflectionManager::Invalidate()
+{
+	m_bDirty = true;
+}
+
+/***********************************************************
+ *  ResizeTarget()
+ *
+ *  This method is used for creating the reflection texture
+ *  and its depth buffer for a size.
+ ***********************************************************/
+void ReflectionManager::ResizeTarget(int width, int height)
+{
+	DestroyTarget();
+
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+
+	m_colorTexture.Create("Reflection");
+	glBindTexture(GL_TEXTURE_2D, m_colorTexture.Get());
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	MemoryManager::TrackTexture(m_colorTexture.Get(), "Reflection", "floor reflection",
+		(size_t)width * height * g_ColorBytesPerTexel);
+
+	m_depthBuffer.Create("Reflection");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	MemoryManager::Allocate("Reflection", "floor reflection depth", MemoryManager::GPU_TEXTURE,
+		(size_t)width * height * g_DepthBytesPerTexel);
+
+	GLint previousFramebuffer = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+	m_framebuffer.Create("Reflection");
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTexture.Get(), 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer.Get());
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Reflection framebuffer is not complete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+	m_width = width;
+	m_height = height;
+	m_bHasImage = false;
+}
+
+/***********************************************************
+ *  DestroyTarget()
+ *
+ *  This method is used for freeing the reflection texture
+ *  and its depth buffer.
+ ***********************************************************/
+void ReflectionManager::DestroyTarget()
+{
+	if (m_framebuffer.IsValid())
+	{
+		MemoryManager::Release("Reflection", "floor reflection depth", MemoryManager::GPU_TEXTURE,
+			(size_t)m_width * m_height * g_DepthBytesPerTexel);
+		m_framebuffer.Reset();
+		m_colorTexture.Reset();
+		m_depthBuffer.Reset();
+	}
+	m_width = 0;
+	m_height = 0;
+	m_bHasImage = false;
+}
+
+/***********************************************************
+ *  HasCameraMoved()
+ *
+ *  This method is used for checking whether the camera or
+ *  the mirror moved since the texture was last drawn.
+ ***********************************************************/
+bool ReflectionManager::HasCameraMoved(const glm::mat4& view, const glm::mat4& projection, float planeHeight) const
+{
+	if ((projection != m_updatedProjection) || (planeHeight != m_updatedPlaneHeight))
+	{
+		return(true);
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			if (std::fabs(view[i][j] - m_updatedView[i][j]) > g_ViewTolerance)
+			{
+				return(true);
+			}
+		}
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  BeginUpdate()
+ *
+ *  This method is used for starting to draw the mirrored
+ *  view into the texture.  The texture is kept, and false
+ *  returned, while the camera stands still, unless the
+ *  scene changed or a second has passed.
+ ***********************************************************/
+bool ReflectionManager::BeginUpdate(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	glm::vec3 cameraPosition,
+	float planeHeight)
+{
+	CollectTimers();
+	ReportStatistics();
+	if (!m_bInitialized)
+	{
+		return(false);
+	}
+	m_frames++;
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	int width = std::max((int)(viewport[2] * m_resolutionScale), 1);
+	int height = std::max((int)(viewport[3] * m_resolutionScale), 1);
+	bool bResized = (width != m_width) || (height != m_height);
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	if (m_bThrottle && m_bHasImage && !m_bDirty && !bResized &&
+		!HasCameraMoved(view, projection, planeHeight))
+	{
+		std::chrono::duration<double> sinceUpdate = now - m_updatedTime;
+		if (sinceUpdate.count() < g_StaticRefreshSeconds)
+		{
+			return(false);
+		}
+	}
+	m_updateStart = now;
+
+	if (bResized)
+	{
+		ResizeTarget(width, height);
+	}
+
+	// mirror the world through the plane, and the camera with it
+	glm::mat4 mirror = glm::mat4(1.0f);
+	mirror[1][1] = -1.0f;
+	mirror[3][1] = 2.0f * planeHeight;
+	m_mirroredView = view * mirror;
+	m_mirroredPosition = glm::vec3(cameraPosition.x, 2.0f * planeHeight - cameraPosition.y, cameraPosition.z);
+	m_planeHeight = planeHeight;
+
+	PortalManager::ExtractFrustumPlanes(projection * m_mirroredView, m_frustumPlanes);
+
+	// keep what is above the plane, seen from the mirrored camera
+	glm::vec4 worldPlane = glm::vec4(0.0f, 1.0f, 0.0f, -(planeHeight - g_ClipOffset));
+	glm::vec4 viewPlane = glm::transpose(glm::inverse(m_mirroredView)) * worldPlane;
+	m_mirroredProjection = MakeObliqueProjection(projection, viewPlane);
+	m_textureViewProjection = m_mirroredProjection * m_mirroredView;
+
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_outputFramebuffer);
+	for (int i = 0; i < 4; i++)
+	{
+		m_outputViewport[i] = viewport[i];
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	glViewport(0, 0, m_width, m_height);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_timerFrame]);
+
+	m_updatedView = view;
+	m_updatedProjection = projection;
+	m_updatedPlaneHeight = planeHeight;
+	m_bUpdating = true;
+	return(true);
+}
+
+/***********************************************************
+ *  IsObjectVisible()
+ *
+ *  This method is used for testing whether an object is
+ *  drawn into the reflection.  Objects under the plane, out
+ *  of the mirrored view, or so small and far that they
+ *  would cover a few texels are left out.
+ ***********************************************************/
+bool ReflectionManager::IsObjectVisible(const SpatialManager::AABB& bounds)
+{
+	if ((bounds.max.y <= m_planeHeight) || !PortalManager::BoxInFrustum(bounds, m_frustumPlanes))
+	{
+		m_objectsCulled++;
+		return(false);
+	}
+
+	glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+	float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+	float distance = glm::length(center - m_mirroredPosition);
+	if ((distance > radius) && (radius < distance * g_DetailAngle))
+	{
+		m_objectsTooSmall++;
+		return(false);
+	}
+
+	m_objectsDrawn++;
+	return(true);
+}
+
+/***********************************************************
+ *  EndUpdate()
+ *
+ *  This method is used for finishing the reflection and
+ *  going back to the framebuffer and viewport of the frame.
+ ***********************************************************/
+void ReflectionManager::EndUpdate()
+{
+	if (!m_bUpdating)
+	{
+		return;
+	}
+	m_bUpdating = false;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_bTimerPending[m_timerFrame] = true;
+	m_timerFrame = (m_timerFrame + 1) % TIMER_FRAMES;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_outputFramebuffer);
+	glViewport(m_outputViewport[0], m_outputViewport[1], m_outputViewport[2], m_outputViewport[3]);
+
+	m_updatedTime = std::chrono::steady_clock::now();
+	std::chrono::duration<double, std::milli> elapsed = m_updatedTime - m_updateStart;
+	m_cpuMilliseconds += elapsed.count();
+	m_updates++;
+	m_bHasImage = true;
+	m_bDirty = false;
+}
+
+/***********************************************************
+ *  GetView()
+ *
+ *  This method is used for getting the view matrix of the
+ *  mirrored camera.
+ ***********************************************************/
+const glm::mat4& ReflectionManager::GetView() const
+{
+	return(m_mirroredView);
+}
+
+/***********************************************************
+ *  GetProjection()
+ *
+ *  This method is used for getting the projection of the
+ *  mirrored camera, clipped at the plane.
+ ***********************************************************/
+const glm::mat4& ReflectionManager::GetProjection() const
+{
+	return(m_mirroredProjection);
+}
+
+/***********************************************************
+ *  GetCameraPosition()
+ *
+ *  This method is used for getting the position of the
+ *  mirrored camera, for the highlights seen in the mirror.
+ ***********************************************************/
+glm::vec3 ReflectionManager::GetCameraPosition() const
+{
+	return(m_mirroredPosition);
+}
+
+/***********************************************************
+ *  IsReady()
+ *
+ *  This method is used for checking whether the texture
+ *  holds a reflection.
+ ***********************************************************/
+bool ReflectionManager::IsReady() const
+{
+	return(m_bInitialized && m_bHasImage);
+}
+
+/***********************************************************
+ *  BindShaderReflection()
+ *
+ *  This method is used for binding the reflection texture
+ *  and setting the shader values shared by the mirror
+ *  surfaces.  Each surface turns the reflection on for its
+ *  own draw.
+ ***********************************************************/
+void ReflectionManager::BindShaderReflection(ShaderManager* pShaderManager)
+{
+	if (!IsReady() || (NULL == pShaderManager))
+	{
+		return;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + REFLECTION_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_colorTexture.Get());
+	glActiveTexture(GL_TEXTURE0);
+
+	pShaderManager->setSampler2DValue(g_ReflectionTextureName, REFLECTION_TEXTURE_UNIT);
+	pShaderManager->setMat4Value(g_ReflectionMatrixName, m_textureViewProjection);
+	pShaderManager->setFloatValue(g_ReflectionStrengthName, g_ReflectionStrength);
+	pShaderManager->setFloatValue(g_ReflectionDistortionName, g_ReflectionDistortion);
+	pShaderManager->setBoolValue(g_UseReflectionName, false);
+}
+
+/***********************************************************
+ *  CollectTimers()
+ *
+ *  This method is used for adding the GPU timers that have
+ *  finished to the statistics, without waiting for any.
+ ***********************************************************/
+void ReflectionManager::CollectTimers()
+{
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		if (!m_bTimerPending[f])
+		{
+			continue;
+		}
+
+		GLuint available = 0;
+		glGetQueryObjectuiv(m_timerQueries[f], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(m_timerQueries[f], GL_QUERY_RESULT, &nanoseconds);
+			m_gpuMilliseconds += nanoseconds / 1.0e6;
+			m_gpuSamples++;
+			m_bTimerPending[f] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing how often the texture
+ *  was drawn and what each update cost, every few seconds.
+ ***********************************************************/
+void ReflectionManager::ReportStatistics()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+	if (elapsed.count() < g_ReportSeconds)
+	{
+		return;
+	}
+
+	if (m_frames > 0)
+	{
+		int updates = std::max(m_updates, 1);
+		std::cout << "INFO: Floor reflection at " << m_width << "x" << m_height
+			<< " - drawn in " << m_updates << " of " << m_frames << " frames, "
+			<< m_objectsDrawn / updates << " objects drawn, "
+			<< m_objectsCulled / updates << " out of view and "
+			<< m_objectsTooSmall / updates << " too small per update, "
+			<< ((m_gpuSamples > 0) ? m_gpuMilliseconds / m_gpuSamples : 0.0) << " ms GPU and "
+			<< m_cpuMilliseconds / updates << " ms CPU per update" << std::endl;
+	}
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_frames = 0;
+	m_updates = 0;
+	m_objectsDrawn = 0;
+	m_objectsCulled = 0;
+	m_objectsTooSmall = 0;
+	m_cpuMilliseconds = 0.0;
+	m_gpuMilliseconds = 0.0;
+	m_gpuSamples = 0;
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for freeing the texture and timers.
+ ***********************************************************/
+void ReflectionManager::Release()
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	DestroyTarget();
+	glDeleteQueries(TIMER_FRAMES, m_timerQueries);
+	for (int f = 0; f < TIMER_FRAMES; f++)
+	{
+		m_timerQueries[f] = 0;
+		m_bTimerPending[f] = false;
+	}
+	m_bInitialized = false;
+}
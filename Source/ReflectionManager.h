@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+// reflectionmanager.h
+// ============
+// reflect the scene in a flat mirror surface - the polished marble floor
+//
+//  The scene is drawn a second time from the camera mirrored under the
+//  floor, into a texture a fraction of the frame size, and the floor reads
+//  it back where each of its pixels lands.  Only the rooms in view are
+//  drawn, objects outside the mirrored view or too small to matter in the
+//  smaller image are skipped, and the texture is kept while the camera
+//  stands still.  The floor bends its lookups by the slope of its veins.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceManager.h"
+#include "ShaderManager.h"
+#include "SpatialManager.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <vector>
+
+/***********************************************************
+ *  ReflectionManager
+ *
+ *  This class contains the code for the mirrored view of a
+ *  horizontal plane and the texture it is drawn into.
+ ***********************************************************/
+class ReflectionManager
+{
+public:
+	// constructor
+	ReflectionManager();
+	// destructor
+	~ReflectionManager();
+
+	// texture unit the reflection is read from, clear of the
+	// scene textures, the post processing and the page cache
+	static const int REFLECTION_TEXTURE_UNIT = 11;
+
+private:
+	bool m_bInitialized;
+	// fraction of the frame width and height drawn
+	float m_resolutionScale;
+	// skip the drawing while the camera stands still
+	bool m_bThrottle;
+
+	// the reflection texture and its depth
+	GLFramebuffer m_framebuffer;
+	GLTexture m_colorTexture;
+	GLRenderbuffer m_depthBuffer;
+	int m_width;
+	int m_height;
+	// whether the texture holds a reflection yet
+	bool m_bHasImage;
+	// the scene changed, so the texture is drawn again
+	bool m_bDirty;
+
+	// the camera the texture was last drawn from
+	glm::mat4 m_updatedView;
+	glm::mat4 m_updatedProjection;
+	float m_updatedPlaneHeight;
+	std::chrono::steady_clock::time_point m_updatedTime;
+
+	// the mirrored camera of the update being drawn, and the
+	// planes of its view
+	glm::mat4 m_mirroredView;
+	glm::mat4 m_mirroredProjection;
+	glm::vec3 m_mirroredPosition;
+	float m_planeHeight;
+	std::vector<glm::vec4> m_frustumPlanes;
+	// projection from the world into the texture, for the shader
+	glm::mat4 m_textureViewProjection;
+
+	// framebuffer and viewport the frame is drawn into
+	GLint m_outputFramebuffer;
+	GLint m_outputViewport[4];
+	bool m_bUpdating;
+	std::chrono::steady_clock::time_point m_updateStart;
+
+	// GPU timers of the updates, a few frames deep so reading
+	// them never waits
+	static const int TIMER_FRAMES = 3;
+	GLuint m_timerQueries[TIMER_FRAMES];
+	bool m_bTimerPending[TIMER_FRAMES];
+	int m_timerFrame;
+
+	// statistics, reported every few seconds
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	int m_frames;
+	int m_updates;
+	int m_objectsDrawn;
+	int m_objectsCulled;
+	int m_objectsTooSmall;
+	double m_cpuMilliseconds;
+	double m_gpuMilliseconds;
+	int m_gpuSamples;
+
+	// create the texture for a frame size
+	void ResizeTarget(int width, int height);
+	void DestroyTarget();
+	// whether the camera moved enough since the last update
+	bool HasCameraMoved(const glm::mat4& view, const glm::mat4& projection, float planeHeight) const;
+
+	// add the finished GPU timers to the statistics
+	void CollectTimers();
+	void ReportStatistics();
+
+public:
+	// create the timers, the texture is made at the first update
+	bool Initialize();
+	bool IsInitialized() const;
+
+	// set the fraction of the frame size drawn, and whether the
+	// texture is kept while the camera stands still
+	void SetResolutionScale(float scale);
+	void SetThrottle(bool bThrottle);
+	// draw the texture again at the next update, such as when
+	// rooms were loaded or unloaded
+	void Invalidate();
+
+	// start drawing the mirrored view of a plane at a height into
+	// the texture, returns false when the texture is kept
+	bool BeginUpdate(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		glm::vec3 cameraPosition,
+		float planeHeight);
+	// test whether an object is drawn into the reflection, false
+	// when it is outside the mirrored view, under the plane or too
+	// small to see
+	bool IsObjectVisible(const SpatialManager::AABB& bounds);
+	// finish drawing and go back to the frame
+	void EndUpdate();
+
+	// mirrored camera of the update being drawn
+	const glm::mat4& GetView() const;
+	const glm::mat4& GetProjection() const;
+	glm::vec3 GetCameraPosition() const;
+
+	// whether the texture holds a reflection the shader can use
+	bool IsReady() const;
+	// bind the texture and set the shader values shared by the
+	// mirror surfaces
+	void BindShaderReflection(ShaderManager* pShaderManager);
+
+	// free the OpenGL objects
+	void Release();
+};
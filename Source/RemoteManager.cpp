@@ -0,0 +1,661 @@
+///////////////////////////////////////////////////////////////////////////////
+// remotemanager.cpp
+// ============
+// manage the remote rendering server - offscreen frames streamed over TCP
+//
+//  The scene is mostly static, so after the first frame only a few tiles
+//  change from one frame to the next unless the camera moves.  Frames are
+//  read back right after drawing, which keeps the latency to one frame.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RemoteManager.h"
+#include "DebugManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// marks the start of every frame message
+	const uint32_t g_FrameMagic = 0x454D5246;  // "FRME"
+	// marks the hello a viewer starts with
+	const uint32_t g_HelloMagic = 0x4C454852;  // "RHEL"
+	// time a new viewer has to send its hello
+	const double g_HelloSeconds = 5.0;
+	// shortest time between frames sent to the viewer
+	const std::chrono::microseconds g_MinFrameInterval(16667);
+	// time between statistics reports
+	const double g_ReportSeconds = 5.0;
+
+	void PutU16(unsigned char*& pBytes, uint16_t value)
+	{
+		pBytes[0] = (unsigned char)value;
+		pBytes[1] = (unsigned char)(value >> 8);
+		pBytes += 2;
+	}
+
+	void PutU32(unsigned char*& pBytes, uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			pBytes[i] = (unsigned char)(value >> (i * 8));
+		}
+		pBytes += 4;
+	}
+
+	void PutU64(unsigned char*& pBytes, uint64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			pBytes[i] = (unsigned char)(value >> (i * 8));
+		}
+		pBytes += 8;
+	}
+
+	uint16_t GetU16(const unsigned char*& pBytes)
+	{
+		uint16_t value = (uint16_t)(pBytes[0] | (pBytes[1] << 8));
+		pBytes += 2;
+		return(value);
+	}
+
+	uint32_t GetU32(const unsigned char*& pBytes)
+	{
+		uint32_t value = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			value |= (uint32_t)pBytes[i] << (i * 8);
+		}
+		pBytes += 4;
+		return(value);
+	}
+
+	uint64_t GetU64(const unsigned char*& pBytes)
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < 8; i++)
+		{
+			value |= (uint64_t)pBytes[i] << (i * 8);
+		}
+		pBytes += 8;
+		return(value);
+	}
+}
+
+// sizes are used as values, so they need a definition
+const int RemoteManager::HELLO_MESSAGE_SIZE;
+const int RemoteManager::MAX_TOKEN_LENGTH;
+const int RemoteManager::INPUT_MESSAGE_SIZE;
+const int RemoteManager::FRAME_HEADER_SIZE;
+const int RemoteManager::TILE_SIZE;
+
+/***********************************************************
+ *  RemoteManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RemoteManager::RemoteManager(ViewManager* pViewManager)
+{
+	m_pViewManager = pViewManager;
+	m_bClientAccepted = false;
+	m_width = 0;
+	m_height = 0;
+	m_frameNumber = 0;
+	m_inputSequence = 0;
+	m_inputMicroseconds = 0;
+	m_lastFrameTime = std::chrono::steady_clock::now();
+	m_statisticsStart = m_lastFrameTime;
+	m_messageBytesSent = 0;
+	m_bytesSent = 0;
+	m_framesSent = 0;
+	m_framesSkipped = 0;
+	m_tilesSent = 0;
+	m_tilesTotal = 0;
+	m_encodeMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~RemoteManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RemoteManager::~RemoteManager()
+{
+	m_client.Close();
+	m_listener.Close();
+	m_pViewManager = NULL;
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for listening for a viewer on the
+ *  passed TCP port.  Without a token only viewers on this
+ *  machine can connect, since a viewer drives the camera.
+ ***********************************************************/
+bool RemoteManager::Start(int port, const std::string& token)
+{
+	if (token.size() > MAX_TOKEN_LENGTH)
+	{
+		std::cout << "Remote server tokens are at most " << MAX_TOKEN_LENGTH << " characters" << std::endl;
+		return(false);
+	}
+	m_token = token;
+
+	bool bLoopbackOnly = m_token.empty();
+	if (!m_listener.Listen(port, bLoopbackOnly))
+	{
+		return(false);
+	}
+
+	std::cout << "INFO: Remote rendering server listening on port " << port
+		<< (bLoopbackOnly ? " on the loopback address" : " on all addresses, with a token") << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for accepting a waiting viewer,
+ *  applying its input, and binding the offscreen framebuffer
+ *  for the frame about to be drawn.
+ ***********************************************************/
+void RemoteManager::BeginFrame(int width, int height)
+{
+	if (!m_client.IsOpen() && m_listener.Accept(m_client))
+	{
+		m_client.SetNoDelay();
+		m_client.SetNonBlocking();
+		m_message.clear();
+		m_messageBytesSent = 0;
+		m_previousFrame.clear();
+		m_inputBytes.clear();
+		m_inputSequence = 0;
+		m_inputMicroseconds = 0;
+		m_bClientAccepted = false;
+		m_connectTime = std::chrono::steady_clock::now();
+	}
+
+	ProcessInput();
+
+	// the offscreen framebuffer is drawn into instead of the
+	// hidden window
+	if (m_renderTarget.Resize(width, height))
+	{
+		m_width = width;
+		m_height = height;
+		m_currentFrame.assign((size_t)width * height * 4, 0);
+		// the next frame is sent whole
+		m_previousFrame.clear();
+	}
+	m_renderTarget.Bind();
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for reading back the frame just
+ *  drawn and sending the tiles that changed to the viewer.
+ *  Only one frame is queued for the viewer, so while the
+ *  last one is still being sent this one is skipped, and
+ *  a slow viewer never holds up the rendering.
+ ***********************************************************/
+void RemoteManager::EndFrame()
+{
+	DEBUG_SCOPE("RemoteFrame");
+
+	if (m_bClientAccepted && !SendPendingFrame())
+	{
+		DisconnectClient();
+	}
+
+	if (m_bClientAccepted && (m_messageBytesSent < m_message.size()))
+	{
+		m_framesSkipped++;
+	}
+	else if (m_bClientAccepted)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		m_renderTarget.ReadPixels(m_currentFrame);
+
+		m_message.resize(FRAME_HEADER_SIZE);
+		int tileCount = EncodeTiles(m_currentFrame, m_previousFrame, m_width, m_height, m_message);
+
+		FRAME_HEADER header;
+		header.frameNumber = m_frameNumber++;
+		header.width = (uint16_t)m_width;
+		header.height = (uint16_t)m_height;
+		header.tileSize = TILE_SIZE;
+		header.tileCount = tileCount;
+		header.inputSequence = m_inputSequence;
+		header.inputMicroseconds = m_inputMicroseconds;
+		header.payloadSize = (uint32_t)(m_message.size() - FRAME_HEADER_SIZE);
+		WriteFrameHeader(header, m_message.data());
+
+		std::chrono::duration<double, std::milli> encodeTime = std::chrono::steady_clock::now() - start;
+		m_encodeMilliseconds += encodeTime.count();
+
+		// the queued frame will reach the viewer whole, so the
+		// next one is encoded against it
+		m_messageBytesSent = 0;
+		m_previousFrame.swap(m_currentFrame);
+		if (m_currentFrame.size() != m_previousFrame.size())
+		{
+			m_currentFrame.resize(m_previousFrame.size());
+		}
+		m_bytesSent += m_message.size();
+		m_framesSent++;
+		m_tilesSent += tileCount;
+		m_tilesTotal += (int64_t)((m_width + TILE_SIZE - 1) / TILE_SIZE) * ((m_height + TILE_SIZE - 1) / TILE_SIZE);
+
+		if (!SendPendingFrame())
+		{
+			DisconnectClient();
+		}
+	}
+
+	m_renderTarget.Unbind();
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::chrono::duration<double> reportTime = now - m_statisticsStart;
+	if (reportTime.count() >= g_ReportSeconds)
+	{
+		ReportStatistics();
+	}
+
+	// nothing is shown locally, so the frame rate is held here
+	std::chrono::steady_clock::time_point nextFrame = m_lastFrameTime + g_MinFrameInterval;
+	if (now < nextFrame)
+	{
+		std::this_thread::sleep_until(nextFrame);
+	}
+	m_lastFrameTime = std::chrono::steady_clock::now();
+}
+
+/***********************************************************
+ *  ProcessInput()
+ *
+ *  This method is used for reading the input events waiting
+ *  on the socket, without blocking, and applying them to
+ *  the view.
+ ***********************************************************/
+void RemoteManager::ProcessInput()
+{
+	unsigned char buffer[1024];
+
+	while (m_client.IsOpen() && m_client.WaitReadable(0))
+	{
+		int received = m_client.ReceiveSome(buffer, sizeof(buffer));
+		if (received <= 0)
+		{
+			DisconnectClient();
+			return;
+		}
+		m_inputBytes.insert(m_inputBytes.end(), buffer, buffer + received);
+	}
+
+	if (m_client.IsOpen() && !m_bClientAccepted && !ProcessHello())
+	{
+		DisconnectClient();
+		return;
+	}
+	if (!m_bClientAccepted)
+	{
+		return;
+	}
+
+	size_t offset = 0;
+	while (m_inputBytes.size() - offset >= INPUT_MESSAGE_SIZE)
+	{
+		REMOTE_INPUT input;
+		ReadInput(&m_inputBytes[offset], input);
+		offset += INPUT_MESSAGE_SIZE;
+
+		switch (input.type)
+		{
+		case INPUT_KEY:
+			m_pViewManager->SetRemoteKey(input.code, input.value != 0);
+			break;
+		case INPUT_MOUSE_MOVE:
+			m_pViewManager->ProcessRemoteMouseMovement((float)input.value, (float)input.value2);
+			break;
+		case INPUT_SCROLL:
+			m_pViewManager->ProcessRemoteScroll((float)input.value);
+			break;
+		}
+
+		m_inputSequence = input.sequence;
+		m_inputMicroseconds = input.sentMicroseconds;
+	}
+	m_inputBytes.erase(m_inputBytes.begin(), m_inputBytes.begin() + offset);
+}
+
+/***********************************************************
+ *  ProcessHello()
+ *
+ *  This method is used for checking the hello a new viewer
+ *  starts with, once it has arrived.  The viewer is refused
+ *  when the token does not match or the hello is too slow.
+ ***********************************************************/
+bool RemoteManager::ProcessHello()
+{
+	if (m_inputBytes.size() < HELLO_MESSAGE_SIZE)
+	{
+		std::chrono::duration<double> waited = std::chrono::steady_clock::now() - m_connectTime;
+		if (waited.count() > g_HelloSeconds)
+		{
+			std::cout << "INFO: Remote viewer did not say hello in time" << std::endl;
+			return(false);
+		}
+		return(true);
+	}
+
+	unsigned char expected[HELLO_MESSAGE_SIZE];
+	WriteHello(m_token, expected);
+
+	// every byte is compared, so the time taken does not tell
+	// how much of a guessed token was right
+	unsigned char difference = 0;
+	for (int i = 0; i < HELLO_MESSAGE_SIZE; i++)
+	{
+		difference |= (unsigned char)(m_inputBytes[i] ^ expected[i]);
+	}
+	m_inputBytes.erase(m_inputBytes.begin(), m_inputBytes.begin() + HELLO_MESSAGE_SIZE);
+	if (difference != 0)
+	{
+		std::cout << "INFO: Remote viewer refused, its token does not match" << std::endl;
+		return(false);
+	}
+
+	m_bClientAccepted = true;
+	std::cout << "INFO: Remote viewer connected" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  SendPendingFrame()
+ *
+ *  This method is used for sending as much of the queued
+ *  frame message as the socket takes without waiting.
+ *  Returns false when the connection has failed.
+ ***********************************************************/
+bool RemoteManager::SendPendingFrame()
+{
+	while (m_messageBytesSent < m_message.size())
+	{
+		int sent = m_client.SendSome(
+			m_message.data() + m_messageBytesSent,
+			m_message.size() - m_messageBytesSent);
+		if (sent < 0)
+		{
+			return(false);
+		}
+		if (sent == 0)
+		{
+			break;
+		}
+		m_messageBytesSent += sent;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  DisconnectClient()
+ *
+ *  This method is used for dropping the viewer connection
+ *  and releasing the keys it was holding.
+ ***********************************************************/
+void RemoteManager::DisconnectClient()
+{
+	bool bWasAccepted = m_bClientAccepted;
+	m_client.Close();
+	m_bClientAccepted = false;
+	m_pViewManager->ClearRemoteInput();
+	m_message.clear();
+	m_messageBytesSent = 0;
+	m_previousFrame.clear();
+	m_inputBytes.clear();
+	if (bWasAccepted)
+	{
+		std::cout << "INFO: Remote viewer disconnected" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing the frame rate, the
+ *  bandwidth used and the share of tiles sent since the
+ *  last report.
+ ***********************************************************/
+void RemoteManager::ReportStatistics()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+
+	if (m_framesSent > 0)
+	{
+		double seconds = elapsed.count();
+		std::cout << "INFO: Remote server sent " << (m_framesSent / seconds) << " frames/s, "
+			<< (m_bytesSent / 1024.0 / seconds) << " KB/s, "
+			<< (100.0 * m_tilesSent / std::max<int64_t>(m_tilesTotal, 1)) << "% of tiles, "
+			<< (m_encodeMilliseconds / m_framesSent) << " ms readback and encode per frame, "
+			<< m_framesSkipped << " frames skipped for a slow viewer" << std::endl;
+	}
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_bytesSent = 0;
+	m_framesSent = 0;
+	m_framesSkipped = 0;
+	m_tilesSent = 0;
+	m_tilesTotal = 0;
+	m_encodeMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  WriteHello()
+ *
+ *  This method is used for packing the hello a viewer
+ *  starts with into its HELLO_MESSAGE_SIZE bytes, the token
+ *  padded with zeros.
+ ***********************************************************/
+void RemoteManager::WriteHello(const std::string& token, unsigned char* pBytes)
+{
+	PutU32(pBytes, g_HelloMagic);
+	memset(pBytes, 0, MAX_TOKEN_LENGTH);
+	memcpy(pBytes, token.data(), std::min<size_t>(token.size(), MAX_TOKEN_LENGTH));
+}
+
+/***********************************************************
+ *  WriteInput()
+ *
+ *  This method is used for packing an input event into its
+ *  INPUT_MESSAGE_SIZE bytes.
+ ***********************************************************/
+void RemoteManager::WriteInput(const REMOTE_INPUT& input, unsigned char* pBytes)
+{
+	PutU32(pBytes, input.type);
+	PutU32(pBytes, input.sequence);
+	PutU64(pBytes, input.sentMicroseconds);
+	PutU32(pBytes, (uint32_t)input.code);
+	PutU32(pBytes, (uint32_t)input.value);
+	PutU32(pBytes, (uint32_t)input.value2);
+}
+
+/***********************************************************
+ *  ReadInput()
+ *
+ *  This method is used for unpacking an input event.
+ ***********************************************************/
+void RemoteManager::ReadInput(const unsigned char* pBytes, REMOTE_INPUT& input)
+{
+	input.type = GetU32(pBytes);
+	input.sequence = GetU32(pBytes);
+	input.sentMicroseconds = GetU64(pBytes);
+	input.code = (int32_t)GetU32(pBytes);
+	input.value = (int32_t)GetU32(pBytes);
+	input.value2 = (int32_t)GetU32(pBytes);
+}
+
+/***********************************************************
+ *  WriteFrameHeader()
+ *
+ *  This method is used for packing a frame header into its
+ *  FRAME_HEADER_SIZE bytes.
+ ***********************************************************/
+void RemoteManager::WriteFrameHeader(const FRAME_HEADER& header, unsigned char* pBytes)
+{
+	PutU32(pBytes, g_FrameMagic);
+	PutU32(pBytes, header.frameNumber);
+	PutU16(pBytes, header.width);
+	PutU16(pBytes, header.height);
+	PutU16(pBytes, header.tileSize);
+	PutU32(pBytes, header.tileCount);
+	PutU32(pBytes, header.inputSequence);
+	PutU64(pBytes, header.inputMicroseconds);
+	PutU32(pBytes, header.payloadSize);
+}
+
+/***********************************************************
+ *  ReadFrameHeader()
+ *
+ *  This method is used for unpacking a frame header.  The
+ *  payload size is zero when the header is not valid.
+ ***********************************************************/
+void RemoteManager::ReadFrameHeader(const unsigned char* pBytes, FRAME_HEADER& header)
+{
+	uint32_t magic = GetU32(pBytes);
+	header.frameNumber = GetU32(pBytes);
+	header.width = GetU16(pBytes);
+	header.height = GetU16(pBytes);
+	header.tileSize = GetU16(pBytes);
+	header.tileCount = GetU32(pBytes);
+	header.inputSequence = GetU32(pBytes);
+	header.inputMicroseconds = GetU64(pBytes);
+	header.payloadSize = GetU32(pBytes);
+
+	if ((magic != g_FrameMagic) || (header.tileSize != TILE_SIZE))
+	{
+		header.tileCount = 0;
+		header.payloadSize = 0;
+	}
+}
+
+/***********************************************************
+ *  EncodeTiles()
+ *
+ *  This method is used for appending the tiles of a frame
+ *  that differ from the previous one.  Each tile is its
+ *  position followed by its RGB rows, bottom row first.
+ ***********************************************************/
+int RemoteManager::EncodeTiles(
+	const std::vector<unsigned char>& current,
+	const std::vector<unsigned char>& previous,
+	int width,
+	int height,
+	std::vector<unsigned char>& payload)
+{
+	bool bKeyFrame = (previous.size() != current.size());
+	int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	int tileCount = 0;
+
+	for (int ty = 0; ty < tilesY; ty++)
+	{
+		for (int tx = 0; tx < tilesX; tx++)
+		{
+			int x0 = tx * TILE_SIZE;
+			int y0 = ty * TILE_SIZE;
+			int tileWidth = std::min(TILE_SIZE, width - x0);
+			int tileHeight = std::min(TILE_SIZE, height - y0);
+
+			bool bChanged = bKeyFrame;
+			for (int y = y0; (y < y0 + tileHeight) && !bChanged; y++)
+			{
+				size_t offset = ((size_t)y * width + x0) * 4;
+				bChanged = (memcmp(&current[offset], &previous[offset], (size_t)tileWidth * 4) != 0);
+			}
+			if (!bChanged)
+			{
+				continue;
+			}
+
+			size_t start = payload.size();
+			payload.resize(start + 4 + (size_t)tileWidth * tileHeight * 3);
+			unsigned char* pBytes = &payload[start];
+			PutU16(pBytes, (uint16_t)tx);
+			PutU16(pBytes, (uint16_t)ty);
+			for (int y = y0; y < y0 + tileHeight; y++)
+			{
+				const unsigned char* pSource = &current[((size_t)y * width + x0) * 4];
+				for (int x = 0; x < tileWidth; x++)
+				{
+					*pBytes++ = pSource[x * 4];
+					*pBytes++ = pSource[x * 4 + 1];
+					*pBytes++ = pSource[x * 4 + 2];
+				}
+			}
+			tileCount++;
+		}
+	}
+
+	return(tileCount);
+}
+
+/***********************************************************
+ *  DecodeTiles()
+ *
+ *  This method is used for writing received tiles into an
+ *  RGBA frame, which keeps the tiles that did not change.
+ ***********************************************************/
+bool RemoteManager::DecodeTiles(
+	const unsigned char* pPayload,
+	size_t payloadSize,
+	int tileCount,
+	int width,
+	int height,
+	std::vector<unsigned char>& frame)
+{
+	if (frame.size() != (size_t)width * height * 4)
+	{
+		frame.assign((size_t)width * height * 4, 255);
+	}
+
+	const unsigned char* pEnd = pPayload + payloadSize;
+	for (int i = 0; i < tileCount; i++)
+	{
+		if (pEnd - pPayload < 4)
+		{
+			return(false);
+		}
+		int x0 = GetU16(pPayload) * TILE_SIZE;
+		int y0 = GetU16(pPayload) * TILE_SIZE;
+		if ((x0 >= width) || (y0 >= height))
+		{
+			return(false);
+		}
+		int tileWidth = std::min(TILE_SIZE, width - x0);
+		int tileHeight = std::min(TILE_SIZE, height - y0);
+		if (pEnd - pPayload < (ptrdiff_t)tileWidth * tileHeight * 3)
+		{
+			return(false);
+		}
+
+		for (int y = y0; y < y0 + tileHeight; y++)
+		{
+			unsigned char* pTarget = &frame[((size_t)y * width + x0) * 4];
+			for (int x = 0; x < tileWidth; x++)
+			{
+				pTarget[x * 4] = *pPayload++;
+				pTarget[x * 4 + 1] = *pPayload++;
+				pTarget[x * 4 + 2] = *pPayload++;
+				pTarget[x * 4 + 3] = 255;
+			}
+		}
+	}
+
+	return(pPayload == pEnd);
+}
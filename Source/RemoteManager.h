@@ -0,0 +1,174 @@
+///////////////////////////////////////////////////////////////////////////////
+// remotemanager.h
+// ============
+// manage the remote rendering server - offscreen frames streamed over TCP
+//
+//  Frames are drawn into an offscreen framebuffer, split into tiles, and only
+//  the tiles that changed since the last frame are sent to the viewer.  Input
+//  events sent back by the viewer drive the camera as if typed locally.
+//  Frames are sent without blocking, one at a time, and a frame drawn while
+//  the viewer is still taking the last one is skipped.  The server listens
+//  on the loopback address unless given a token, which the viewer must
+//  send in its hello before it is shown frames or can move the camera.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "NetworkSocket.h"
+#include "RenderTarget.h"
+#include "ViewManager.h"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  RemoteManager
+ *
+ *  This class contains the code for the server side of
+ *  remote rendering, and the message format it shares with
+ *  the remote viewer.
+ ***********************************************************/
+class RemoteManager
+{
+public:
+	// constructor
+	RemoteManager(ViewManager* pViewManager);
+	// destructor
+	~RemoteManager();
+
+	// kinds of input events sent by the viewer
+	enum REMOTE_INPUT_TYPE
+	{
+		INPUT_KEY = 1,
+		INPUT_MOUSE_MOVE = 2,
+		INPUT_SCROLL = 3
+	};
+
+	// input event sent from the viewer to the server
+	struct REMOTE_INPUT
+	{
+		uint32_t type;
+		uint32_t sequence;
+		// viewer clock when the event was sent, echoed back with
+		// the first frame drawn after it, to measure latency
+		uint64_t sentMicroseconds;
+		// key code, or unused for mouse events
+		int32_t code;
+		// key state, or the mouse and scroll offsets
+		int32_t value;
+		int32_t value2;
+	};
+
+	// header sent ahead of the tiles of each frame
+	struct FRAME_HEADER
+	{
+		uint32_t frameNumber;
+		uint16_t width;
+		uint16_t height;
+		uint16_t tileSize;
+		uint32_t tileCount;
+		// latest input event applied before the frame was drawn
+		uint32_t inputSequence;
+		uint64_t inputMicroseconds;
+		uint32_t payloadSize;
+	};
+
+	// sizes of the messages on the wire
+	static const int HELLO_MESSAGE_SIZE = 36;
+	static const int MAX_TOKEN_LENGTH = 32;
+	static const int INPUT_MESSAGE_SIZE = 28;
+	static const int FRAME_HEADER_SIZE = 34;
+	static const int TILE_SIZE = 32;
+
+private:
+	// view manager receiving the input of the viewer
+	ViewManager* m_pViewManager;
+	NetworkSocket m_listener;
+	NetworkSocket m_client;
+	// token the viewer has to send, empty on the loopback address
+	std::string m_token;
+	// whether the viewer has sent a valid hello, and when it
+	// connected, as it has only a short time to send one
+	bool m_bClientAccepted;
+	std::chrono::steady_clock::time_point m_connectTime;
+
+	// offscreen framebuffer the frames are drawn into
+	RenderTarget m_renderTarget;
+	int m_width;
+	int m_height;
+
+	// frames read back, RGBA with the bottom row first
+	std::vector<unsigned char> m_currentFrame;
+	std::vector<unsigned char> m_previousFrame;
+	// the frame message being sent, and how much of it has gone
+	std::vector<unsigned char> m_message;
+	size_t m_messageBytesSent;
+	// input bytes received but not yet a whole message
+	std::vector<unsigned char> m_inputBytes;
+
+	uint32_t m_frameNumber;
+	uint32_t m_inputSequence;
+	uint64_t m_inputMicroseconds;
+	std::chrono::steady_clock::time_point m_lastFrameTime;
+
+	// statistics, reported every few seconds
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	uint64_t m_bytesSent;
+	int m_framesSent;
+	int m_framesSkipped;
+	int64_t m_tilesSent;
+	int64_t m_tilesTotal;
+	double m_encodeMilliseconds;
+
+	// check the hello of a new viewer, false when it is refused
+	bool ProcessHello();
+	// read and apply the input events waiting on the socket
+	void ProcessInput();
+	// send what fits of the frame message without waiting
+	bool SendPendingFrame();
+	// drop the viewer connection
+	void DisconnectClient();
+	// print and reset the statistics
+	void ReportStatistics();
+
+public:
+	// listen for a viewer on a TCP port, on the loopback address
+	// only unless a token is passed for viewers to send
+	bool Start(int port, const std::string& token);
+
+	// accept a viewer, apply its input and bind the offscreen
+	// framebuffer, called before the frame is drawn
+	void BeginFrame(int width, int height);
+	// read back the frame and send its changed tiles, called
+	// after the frame is drawn
+	void EndFrame();
+
+	// pack and unpack the messages, little endian on the wire
+	static void WriteHello(const std::string& token, unsigned char* pBytes);
+	static void WriteInput(const REMOTE_INPUT& input, unsigned char* pBytes);
+	static void ReadInput(const unsigned char* pBytes, REMOTE_INPUT& input);
+	static void WriteFrameHeader(const FRAME_HEADER& header, unsigned char* pBytes);
+	static void ReadFrameHeader(const unsigned char* pBytes, FRAME_HEADER& header);
+
+	// append the tiles that differ from the previous frame as
+	// RGB data, all tiles when there is no previous frame, and
+	// return the number of tiles written
+	static int EncodeTiles(
+		const std::vector<unsigned char>& current,
+		const std::vector<unsigned char>& previous,
+		int width,
+		int height,
+		std::vector<unsigned char>& payload);
+	// write the received tiles into an RGBA frame
+	static bool DecodeTiles(
+		const unsigned char* pPayload,
+		size_t payloadSize,
+		int tileCount,
+		int width,
+		int height,
+		std::vector<unsigned char>& frame);
+};
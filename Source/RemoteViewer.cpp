@@ -0,0 +1,488 @@
+///////////////////////////////////////////////////////////////////////////////
+// remoteviewer.cpp
+// ============
+// show the frames streamed by a remote rendering server - thin client
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RemoteViewer.h"
+#include "CaptureManager.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#include <algorithm>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// time between statistics reports
+	const double g_ReportSeconds = 5.0;
+	// file the last frame is saved to after a limited run
+	const char* g_LastFrameFilename = "viewer_frame.png";
+	// key codes shared with GLFW, which uses the ASCII letters
+	const int g_ScriptedKey = 'D';
+
+#ifdef _WIN32
+	const char* g_WindowClassName = "RemoteViewerWindow";
+
+	// the server reads key codes as GLFW's, which match the
+	// Windows ones only for letters, digits and space, so the
+	// others are translated, and -1 is returned for keys the
+	// server has no use for
+	int GetGLFWKey(WPARAM virtualKey)
+	{
+		if (((virtualKey >= 'A') && (virtualKey <= 'Z')) ||
+			((virtualKey >= '0') && (virtualKey <= '9')) ||
+			(virtualKey == VK_SPACE))
+		{
+			return((int)virtualKey);
+		}
+		if ((virtualKey >= VK_F1) && (virtualKey <= VK_F24))
+		{
+			return(GLFW_KEY_F1 + (int)(virtualKey - VK_F1));
+		}
+		if ((virtualKey >= VK_NUMPAD0) && (virtualKey <= VK_NUMPAD9))
+		{
+			return(GLFW_KEY_KP_0 + (int)(virtualKey - VK_NUMPAD0));
+		}
+
+		switch (virtualKey)
+		{
+		case VK_RETURN:
+			return(GLFW_KEY_ENTER);
+		case VK_TAB:
+			return(GLFW_KEY_TAB);
+		case VK_BACK:
+			return(GLFW_KEY_BACKSPACE);
+		case VK_INSERT:
+			return(GLFW_KEY_INSERT);
+		case VK_DELETE:
+			return(GLFW_KEY_DELETE);
+		case VK_RIGHT:
+			return(GLFW_KEY_RIGHT);
+		case VK_LEFT:
+			return(GLFW_KEY_LEFT);
+		case VK_DOWN:
+			return(GLFW_KEY_DOWN);
+		case VK_UP:
+			return(GLFW_KEY_UP);
+		case VK_PRIOR:
+			return(GLFW_KEY_PAGE_UP);
+		case VK_NEXT:
+			return(GLFW_KEY_PAGE_DOWN);
+		case VK_HOME:
+			return(GLFW_KEY_HOME);
+		case VK_END:
+			return(GLFW_KEY_END);
+		case VK_SHIFT:
+			return(GLFW_KEY_LEFT_SHIFT);
+		case VK_CONTROL:
+			return(GLFW_KEY_LEFT_CONTROL);
+		case VK_MENU:
+			return(GLFW_KEY_LEFT_ALT);
+		}
+		return(GLFW_KEY_UNKNOWN);
+	}
+
+	LRESULT CALLBACK ViewerWindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+	{
+		RemoteViewer* pViewer = (RemoteViewer*)GetWindowLongPtr(hWnd, GWLP_USERDATA);
+		if (NULL != pViewer)
+		{
+			pViewer->HandleWindowMessage(message, wParam, lParam);
+		}
+		// F10 would otherwise put the window in menu mode
+		if ((message == WM_CLOSE) ||
+			(((message == WM_SYSKEYDOWN) || (message == WM_SYSKEYUP)) && (wParam == VK_F10)))
+		{
+			return(0);
+		}
+		return(DefWindowProc(hWnd, message, wParam, lParam));
+	}
+#endif
+}
+
+/***********************************************************
+ *  RemoteViewer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RemoteViewer::RemoteViewer()
+{
+	m_width = 0;
+	m_height = 0;
+	m_pWindow = NULL;
+	m_bQuit = false;
+	m_lastMouseX = 0;
+	m_lastMouseY = 0;
+	m_bDragging = false;
+	m_inputSequence = 0;
+	m_measuredSequence = 0;
+	m_clockStart = std::chrono::steady_clock::now();
+	m_statisticsStart = m_clockStart;
+	m_bytesReceived = 0;
+	m_framesReceived = 0;
+	m_latencySamples = 0;
+	m_totalLatencyMilliseconds = 0.0;
+	m_maxLatencyMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~RemoteViewer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RemoteViewer::~RemoteViewer()
+{
+#ifdef _WIN32
+	if (NULL != m_pWindow)
+	{
+		DestroyWindow((HWND)m_pWindow);
+		m_pWindow = NULL;
+	}
+#endif
+	m_socket.Close();
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for connecting to the server and
+ *  showing its frames, sending the input back, until the
+ *  viewer is closed or the frame limit is reached.
+ ***********************************************************/
+int RemoteViewer::Run(const std::string& host, int port, int frameLimit, const std::string& token)
+{
+	if (token.size() > RemoteManager::MAX_TOKEN_LENGTH)
+	{
+		std::cout << "Remote server tokens are at most " << RemoteManager::MAX_TOKEN_LENGTH << " characters" << std::endl;
+		return(1);
+	}
+	if (!m_socket.Connect(host, port))
+	{
+		return(1);
+	}
+	m_socket.SetNoDelay();
+
+	// the server shows nothing until it has checked the hello
+	unsigned char hello[RemoteManager::HELLO_MESSAGE_SIZE];
+	RemoteManager::WriteHello(token, hello);
+	if (!m_socket.SendAll(hello, sizeof(hello)))
+	{
+		return(1);
+	}
+	std::cout << "INFO: Remote viewer connected to " << host << ":" << port << std::endl;
+
+	// a limited run is a test, so it needs no window
+	if (frameLimit <= 0)
+	{
+		CreateViewerWindow();
+	}
+
+	int frameIndex = 0;
+	while (!m_bQuit && ((frameLimit <= 0) || (frameIndex < frameLimit)))
+	{
+		ProcessWindowEvents(frameIndex);
+		if (!ReceiveFrame())
+		{
+			std::cout << "INFO: Remote server closed the connection" << std::endl;
+			break;
+		}
+		PresentFrame();
+		frameIndex++;
+
+		std::chrono::duration<double> reportTime = std::chrono::steady_clock::now() - m_statisticsStart;
+		if (reportTime.count() >= g_ReportSeconds)
+		{
+			ReportStatistics();
+		}
+	}
+	ReportStatistics();
+
+	if ((frameLimit > 0) && (m_width > 0))
+	{
+		CaptureManager::WritePNG(g_LastFrameFilename, m_width, m_height, m_frame);
+		std::cout << "INFO: Saved the last frame to " << g_LastFrameFilename << std::endl;
+	}
+
+	m_socket.Close();
+	return(0);
+}
+
+/***********************************************************
+ *  GetMicroseconds()
+ *
+ *  This method is used for reading the viewer clock.  Only
+ *  the viewer compares these times, so the clocks of the two
+ *  machines do not need to agree.
+ ***********************************************************/
+uint64_t RemoteViewer::GetMicroseconds() const
+{
+	return((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - m_clockStart).count());
+}
+
+/***********************************************************
+ *  SendInput()
+ *
+ *  This method is used for sending one input event, stamped
+ *  with the viewer clock, to the server.
+ ***********************************************************/
+void RemoteViewer::SendInput(uint32_t type, int32_t code, int32_t value, int32_t value2)
+{
+	RemoteManager::REMOTE_INPUT input;
+	input.type = type;
+	input.sequence = ++m_inputSequence;
+	// zero means no input has been applied yet
+	input.sentMicroseconds = std::max<uint64_t>(GetMicroseconds(), 1);
+	input.code = code;
+	input.value = value;
+	input.value2 = value2;
+
+	unsigned char bytes[RemoteManager::INPUT_MESSAGE_SIZE];
+	RemoteManager::WriteInput(input, bytes);
+	if (!m_socket.SendAll(bytes, sizeof(bytes)))
+	{
+		m_bQuit = true;
+	}
+}
+
+/***********************************************************
+ *  ReceiveFrame()
+ *
+ *  This method is used for receiving the next frame and
+ *  applying its tiles.  The input echoed in the header
+ *  gives the time from an input event to the first frame
+ *  that shows it.
+ ***********************************************************/
+bool RemoteViewer::ReceiveFrame()
+{
+	unsigned char headerBytes[RemoteManager::FRAME_HEADER_SIZE];
+	if (!m_socket.ReceiveAll(headerBytes, sizeof(headerBytes)))
+	{
+		return(false);
+	}
+
+	RemoteManager::FRAME_HEADER header;
+	RemoteManager::ReadFrameHeader(headerBytes, header);
+	m_payload.resize(header.payloadSize);
+	if ((header.payloadSize > 0) && !m_socket.ReceiveAll(m_payload.data(), m_payload.size()))
+	{
+		return(false);
+	}
+
+	m_width = header.width;
+	m_height = header.height;
+	if (!RemoteManager::DecodeTiles(m_payload.data(), m_payload.size(), header.tileCount, m_width, m_height, m_frame))
+	{
+		std::cout << "Remote frame " << header.frameNumber << " could not be decoded" << std::endl;
+	}
+
+	if ((header.inputSequence > m_measuredSequence) && (header.inputMicroseconds > 0))
+	{
+		double latency = (GetMicroseconds() - header.inputMicroseconds) / 1000.0;
+		m_totalLatencyMilliseconds += latency;
+		m_maxLatencyMilliseconds = std::max(m_maxLatencyMilliseconds, latency);
+		m_latencySamples++;
+		m_measuredSequence = header.inputSequence;
+	}
+
+	m_bytesReceived += RemoteManager::FRAME_HEADER_SIZE + header.payloadSize;
+	m_framesReceived++;
+	return(true);
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing the frame rate, the
+ *  bandwidth and the input to frame latency since the last
+ *  report.
+ ***********************************************************/
+void RemoteViewer::ReportStatistics()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+	double seconds = std::max(elapsed.count(), 0.001);
+
+	std::cout << "INFO: Remote viewer received " << (m_framesReceived / seconds) << " frames/s, "
+		<< (m_bytesReceived / 1024.0 / seconds) << " KB/s, latency "
+		<< ((m_latencySamples > 0) ? m_totalLatencyMilliseconds / m_latencySamples : 0.0) << " ms average, "
+		<< m_maxLatencyMilliseconds << " ms max" << std::endl;
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_bytesReceived = 0;
+	m_framesReceived = 0;
+	m_latencySamples = 0;
+	m_totalLatencyMilliseconds = 0.0;
+	m_maxLatencyMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  CreateViewerWindow()
+ *
+ *  This method is used for creating the window the frames
+ *  are shown in.  Only Windows has one; elsewhere the
+ *  viewer runs without a window.
+ ***********************************************************/
+void RemoteViewer::CreateViewerWindow()
+{
+#ifdef _WIN32
+	WNDCLASSA windowClass;
+	ZeroMemory(&windowClass, sizeof(windowClass));
+	windowClass.lpfnWndProc = ViewerWindowProc;
+	windowClass.hInstance = GetModuleHandle(NULL);
+	windowClass.hCursor = LoadCursor(NULL, IDC_ARROW);
+	windowClass.lpszClassName = g_WindowClassName;
+	RegisterClassA(&windowClass);
+
+	HWND hWnd = CreateWindowA(g_WindowClassName, "Remote Viewer", WS_OVERLAPPEDWINDOW,
+		CW_USEDEFAULT, CW_USEDEFAULT, 1000, 800, NULL, NULL, windowClass.hInstance, NULL);
+	if (NULL != hWnd)
+	{
+		SetWindowLongPtr(hWnd, GWLP_USERDATA, (LONG_PTR)this);
+		ShowWindow(hWnd, SW_SHOW);
+		m_pWindow = hWnd;
+	}
+#endif
+}
+
+/***********************************************************
+ *  ProcessWindowEvents()
+ *
+ *  This method is used for handling the window events,
+ *  which send the input to the server.  Without a window,
+ *  the camera is turned and moved by a fixed script so the
+ *  frames keep changing.
+ ***********************************************************/
+void RemoteViewer::ProcessWindowEvents(int frameIndex)
+{
+	if (NULL == m_pWindow)
+	{
+		SendInput(RemoteManager::INPUT_MOUSE_MOVE, 0, 2, 0);
+		if (frameIndex % 60 == 0)
+		{
+			SendInput(RemoteManager::INPUT_KEY, g_ScriptedKey, (frameIndex / 60) % 2 == 0, 0);
+		}
+		return;
+	}
+
+#ifdef _WIN32
+	MSG message;
+	while (PeekMessage(&message, NULL, 0, 0, PM_REMOVE))
+	{
+		TranslateMessage(&message);
+		DispatchMessage(&message);
+	}
+#endif
+}
+
+/***********************************************************
+ *  HandleWindowMessage()
+ *
+ *  This method is used for turning window messages into
+ *  input events for the server.  The camera turns while the
+ *  left mouse button is held.
+ ***********************************************************/
+void RemoteViewer::HandleWindowMessage(unsigned int message, uintptr_t wParam, intptr_t lParam)
+{
+#ifdef _WIN32
+	int x = (short)LOWORD(lParam);
+	int y = (short)HIWORD(lParam);
+
+	switch (message)
+	{
+	case WM_CLOSE:
+		m_bQuit = true;
+		break;
+	case WM_KEYDOWN:
+	case WM_KEYUP:
+	// F10 and keys held with Alt come as system keys
+	case WM_SYSKEYDOWN:
+	case WM_SYSKEYUP:
+		if (wParam == VK_ESCAPE)
+		{
+			m_bQuit = true;
+		}
+		// skip the repeats of a key held down
+		else if ((message == WM_KEYUP) || (message == WM_SYSKEYUP) || ((lParam & (1 << 30)) == 0))
+		{
+			int key = GetGLFWKey(wParam);
+			if (key != GLFW_KEY_UNKNOWN)
+			{
+				bool bPressed = (message == WM_KEYDOWN) || (message == WM_SYSKEYDOWN);
+				SendInput(RemoteManager::INPUT_KEY, key, bPressed, 0);
+			}
+		}
+		break;
+	case WM_LBUTTONDOWN:
+		m_bDragging = true;
+		m_lastMouseX = x;
+		m_lastMouseY = y;
+		SetCapture((HWND)m_pWindow);
+		break;
+	case WM_LBUTTONUP:
+		m_bDragging = false;
+		ReleaseCapture();
+		break;
+	case WM_MOUSEMOVE:
+		if (m_bDragging)
+		{
+			// reversed since y-coordinates go from bottom to top
+			SendInput(RemoteManager::INPUT_MOUSE_MOVE, 0, x - m_lastMouseX, m_lastMouseY - y);
+			m_lastMouseX = x;
+			m_lastMouseY = y;
+		}
+		break;
+	case WM_MOUSEWHEEL:
+		SendInput(RemoteManager::INPUT_SCROLL, 0, GET_WHEEL_DELTA_WPARAM(wParam) / WHEEL_DELTA, 0);
+		break;
+	}
+#endif
+}
+
+/***********************************************************
+ *  PresentFrame()
+ *
+ *  This method is used for drawing the current frame into
+ *  the window.
+ ***********************************************************/
+void RemoteViewer::PresentFrame()
+{
+#ifdef _WIN32
+	if ((NULL == m_pWindow) || (m_width == 0))
+	{
+		return;
+	}
+
+	// bottom up 32 bit bitmaps store blue first
+	std::vector<unsigned char>& pixels = m_displayPixels;
+	pixels.resize(m_frame.size());
+	for (size_t i = 0; i < m_frame.size(); i += 4)
+	{
+		pixels[i] = m_frame[i + 2];
+		pixels[i + 1] = m_frame[i + 1];
+		pixels[i + 2] = m_frame[i];
+		pixels[i + 3] = 255;
+	}
+
+	BITMAPINFO info;
+	ZeroMemory(&info, sizeof(info));
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = m_width;
+	info.bmiHeader.biHeight = m_height;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	HWND hWnd = (HWND)m_pWindow;
+	RECT client;
+	GetClientRect(hWnd, &client);
+	HDC hDC = GetDC(hWnd);
+	StretchDIBits(hDC, 0, 0, client.right, client.bottom, 0, 0, m_width, m_height,
+		pixels.data(), &info, DIB_RGB_COLORS, SRCCOPY);
+	ReleaseDC(hWnd, hDC);
+#endif
+}
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// remoteviewer.h
+// ============
+// show the frames streamed by a remote rendering server - thin client
+//
+//  The viewer needs no OpenGL.  It rebuilds each frame from the tiles sent
+//  by the server, shows it in a plain window on Windows, and sends the
+//  keyboard and mouse input back.  Without a window it drives the camera
+//  with scripted input, which is enough to test on localhost.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "NetworkSocket.h"
+#include "RemoteManager.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  RemoteViewer
+ *
+ *  This class contains the code for the client side of
+ *  remote rendering.
+ ***********************************************************/
+class RemoteViewer
+{
+public:
+	// constructor
+	RemoteViewer();
+	// destructor
+	~RemoteViewer();
+
+private:
+	NetworkSocket m_socket;
+	// frame rebuilt from the received tiles, RGBA bottom row first
+	std::vector<unsigned char> m_frame;
+	std::vector<unsigned char> m_payload;
+	// frame converted for the window
+	std::vector<unsigned char> m_displayPixels;
+	int m_width;
+	int m_height;
+	// native window handle, NULL when running without a window
+	void* m_pWindow;
+	bool m_bQuit;
+	// last mouse position while dragging in the window
+	int m_lastMouseX;
+	int m_lastMouseY;
+	bool m_bDragging;
+
+	uint32_t m_inputSequence;
+	uint32_t m_measuredSequence;
+	std::chrono::steady_clock::time_point m_clockStart;
+
+	// statistics, reported every few seconds and at the end
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	uint64_t m_bytesReceived;
+	int m_framesReceived;
+	int m_latencySamples;
+	double m_totalLatencyMilliseconds;
+	double m_maxLatencyMilliseconds;
+
+	// microseconds on the viewer clock
+	uint64_t GetMicroseconds() const;
+	// send one input event to the server
+	void SendInput(uint32_t type, int32_t code, int32_t value, int32_t value2);
+	// receive and decode the next frame, blocking until it arrives
+	bool ReceiveFrame();
+	// create the window and handle its events, or script the input
+	void CreateViewerWindow();
+	void ProcessWindowEvents(int frameIndex);
+	// show the current frame in the window
+	void PresentFrame();
+	// print and reset the statistics
+	void ReportStatistics();
+
+public:
+	// connect to a server and show its frames until the window is
+	// closed, or until the passed number of frames when positive,
+	// with the token the server was started with, if any
+	int Run(const std::string& host, int port, int frameLimit, const std::string& token);
+
+	// handle a message sent to the viewer window
+	void HandleWindowMessage(unsigned int message, uintptr_t wParam, intptr_t lParam);
+};
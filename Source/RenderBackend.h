@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderbackend.h
+// ============
+// draw through a graphics API - the per object state of the scene
+//
+//  The scene describes each draw by a small block of values, its transform,
+//  color or texture and material, and the backend decides how they reach
+//  the GPU.  Materials, shader patterns and virtual textures are made once
+//  and used by index, the scene finds the indices when an object is added,
+//  and the per draw block stays small.  OpenGL is the only backend, and it
+//  writes only the uniforms that changed since the last draw.  There is no
+//  Vulkan backend, as the project does not build against the Vulkan SDK
+//  and loader.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SamplerManager.h"
+
+#include <glm/glm.hpp>
+
+/***********************************************************
+ *  RenderBackend
+ *
+ *  This class is the interface the scene draws its objects
+ *  through.  The meshes are drawn by the scene after the
+ *  draw values are set.
+ ***********************************************************/
+class RenderBackend
+{
+public:
+	// destructor
+	virtual ~RenderBackend() {}
+
+	// a material, made once and used by its index, with the
+	// sampler its textures are filtered with
+	struct MATERIAL
+	{
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		SamplerManager::SAMPLER_DESC sampler;
+	};
+
+	// where a textured object reads its texels
+	enum TEXTURE_SOURCE
+	{
+		// a texture bound to a texture unit
+		TEXTURE_UNIT,
+		// a pattern drawn by the shader
+		TEXTURE_PATTERN,
+		// a virtual texture read a page at a time
+		TEXTURE_VIRTUAL
+	};
+
+	// a pattern drawn by the shader in place of a texture
+	struct PATTERN
+	{
+		int type;
+		glm::vec3 lightColor;
+		glm::vec3 darkColor;
+		glm::vec2 frequency;
+		int octaves;
+		float turbulence;
+		float bands;
+		int seed;
+	};
+
+	// a virtual texture, by its index in the page cache and the
+	// texture that finds its pages
+	struct VIRTUAL_TEXTURE
+	{
+		int cacheIndex;
+		glm::vec2 size;
+		float maxLevel;
+		unsigned int indirectionTexture;
+		int indirectionUnit;
+	};
+
+	// values that change with every draw
+	struct DRAW_DATA
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		glm::vec2 UVscale;
+		// textured objects draw from a texture unit, a pattern or a
+		// virtual texture, by its index, and other objects draw the
+		// color
+		bool bUseTexture;
+		TEXTURE_SOURCE textureSource;
+		int texture;
+		// material index, or -1 to keep the last values, with
+		// textures filtered by the default sampler
+		int material;
+		// mirror objects show the reflection drawn before them
+		bool bReflect;
+	};
+
+	// work done since the statistics were last reset
+	struct STATISTICS
+	{
+		int draws;
+		// values written to the GPU, and those skipped because
+		// they had not changed
+		int stateChanges;
+		int skippedChanges;
+	};
+
+	virtual const char* GetName() const = 0;
+
+	// add a material, returning its index
+	virtual int CreateMaterial(const MATERIAL& material) = 0;
+	// change the values of a material made earlier
+	virtual void UpdateMaterial(int index, const MATERIAL& material) = 0;
+	// add a pattern or a virtual texture, returning its index
+	virtual int CreatePattern(const PATTERN& pattern) = 0;
+	virtual int CreateVirtualTexture(const VIRTUAL_TEXTURE& texture) = 0;
+
+	// start a pass of draws, forgetting what the GPU was last
+	// given, since other code may have changed it in between
+	virtual void BeginPass() = 0;
+	// set the values of the next draw
+	virtual void SetDrawData(const DRAW_DATA& draw) = 0;
+
+	virtual STATISTICS GetStatistics() const = 0;
+	virtual void ResetStatistics() = 0;
+};
@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendertarget.cpp
+// ============
+// manage an offscreen framebuffer - color and depth for headless rendering
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderTarget.h"
+#include "MemoryManager.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// RGBA8 color and 24 bit depth with 8 bit stencil
+	const int g_RenderTargetBytesPerPixel = 8;
+}
+
+/***********************************************************
+ *  RenderTarget()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderTarget::RenderTarget()
+{
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  ~RenderTarget()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderTarget::~RenderTarget()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the framebuffer and its
+ *  render buffers.
+ ***********************************************************/
+void RenderTarget::Destroy()
+{
+	if (m_framebuffer.IsValid())
+	{
+		MemoryManager::Release("RenderTarget", "offscreen frames", MemoryManager::GPU_TEXTURE,
+			(size_t)m_width * m_height * g_RenderTargetBytesPerPixel);
+		m_framebuffer.Reset();
+		m_colorBuffer.Reset();
+		m_depthBuffer.Reset();
+	}
+	m_width = 0;
+	m_height = 0;
+}
+
+/***********************************************************
+ *  Resize()
+ *
+ *  This method is used for creating the color and depth
+ *  buffers of the target when the frame size changes.
+ ***********************************************************/
+bool RenderTarget::Resize(int width, int height)
+{
+	if (m_framebuffer.IsValid() && (width == m_width) && (height == m_height))
+	{
+		return(false);
+	}
+
+	Destroy();
+
+	m_colorBuffer.Create("RenderTarget");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	m_depthBuffer.Create("RenderTarget");
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer.Get());
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	MemoryManager::Allocate("RenderTarget", "offscreen frames", MemoryManager::GPU_TEXTURE,
+		(size_t)width * height * g_RenderTargetBytesPerPixel);
+
+	m_framebuffer.Create("RenderTarget");
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colorBuffer.Get());
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer.Get());
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Offscreen framebuffer is not complete" << std::endl;
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	m_width = width;
+	m_height = height;
+	return(true);
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for drawing into the target.
+ ***********************************************************/
+void RenderTarget::Bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.Get());
+	glViewport(0, 0, m_width, m_height);
+}
+
+/***********************************************************
+ *  Unbind()
+ *
+ *  This method is used for drawing into the window again.
+ ***********************************************************/
+void RenderTarget::Unbind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/***********************************************************
+ *  ReadPixels()
+ *
+ *  This method is used for reading the pixels of the target
+ *  into memory.  It waits for the frame to finish drawing.
+ ***********************************************************/
+void RenderTarget::ReadPixels(std::vector<unsigned char>& pixels)
+{
+	pixels.resize((size_t)m_width * m_height * 4);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer.Get());
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, m_width, m_height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+}
+
+/***********************************************************
+ *  GetWidth()
+ *
+ *  This method is used for getting the width of the target.
+ ***********************************************************/
+int RenderTarget::GetWidth() const
+{
+	return(m_width);
+}
+
+/***********************************************************
+ *  GetHeight()
+ *
+ *  This method is used for getting the height of the target.
+ ***********************************************************/
+int RenderTarget::GetHeight() const
+{
+	return(m_height);
+}
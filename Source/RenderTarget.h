@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////
+// rendertarget.h
+// ============
+// manage an offscreen framebuffer - color and depth for headless rendering
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceManager.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  RenderTarget
+ *
+ *  This class contains the code for a framebuffer that is
+ *  drawn into instead of the window, and read back.
+ ***********************************************************/
+class RenderTarget
+{
+public:
+	// constructor
+	RenderTarget();
+	// destructor
+	~RenderTarget();
+
+private:
+	GLFramebuffer m_framebuffer;
+	GLRenderbuffer m_colorBuffer;
+	GLRenderbuffer m_depthBuffer;
+	int m_width;
+	int m_height;
+
+	// free the OpenGL objects
+	void Destroy();
+
+public:
+	// create the buffers for a frame size, returns true when they
+	// were created again
+	bool Resize(int width, int height);
+	// draw into the target, or back into the window
+	void Bind();
+	void Unbind();
+	// read the pixels of the target, RGBA with the bottom row first
+	void ReadPixels(std::vector<unsigned char>& pixels);
+
+	int GetWidth() const;
+	int GetHeight() const;
+};
@@ -0,0 +1,188 @@
+///////////////////////////////////////////////////////////////////////////////
+// samplermanager.cpp
+// ============
+// share sampler objects - how textures are filtered, wrapped and biased
+//
+//  There are only a handful of descriptions in use, so they are kept in a
+//  short list searched in order.  A sampler bound to a unit overrides the
+//  filtering set on the texture itself, so textures keep sensible
+//  parameters of their own for units no sampler is bound to.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SamplerManager.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	struct SAMPLER_ENTRY
+	{
+		SamplerManager::SAMPLER_DESC desc;
+		GLuint sampler;
+	};
+
+	std::vector<SAMPLER_ENTRY> g_Samplers;
+	// sampler bound to each texture unit
+	GLuint g_BoundSamplers[SamplerManager::MAX_TEXTURE_UNITS] = { 0 };
+	// largest anisotropy, read from the driver on first use
+	float g_MaxAnisotropy = 0.0f;
+
+	bool IsSameDesc(const SamplerManager::SAMPLER_DESC& first, const SamplerManager::SAMPLER_DESC& second)
+	{
+		return((first.filter == second.filter) &&
+			(first.anisotropy == second.anisotropy) &&
+			(first.bClamp == second.bClamp) &&
+			(first.lodBias == second.lodBias));
+	}
+}
+
+/***********************************************************
+ *  MakeDesc()
+ *
+ *  This method is used for filling in a sampler
+ *  description.
+ ***********************************************************/
+SamplerManager::SAMPLER_DESC SamplerManager::MakeDesc(
+	FILTER_MODE filter,
+	float anisotropy,
+	bool bClamp,
+	float lodBias)
+{
+	SAMPLER_DESC desc;
+	desc.filter = filter;
+	desc.anisotropy = anisotropy;
+	desc.bClamp = bClamp;
+	desc.lodBias = lodBias;
+	return(desc);
+}
+
+/***********************************************************
+ *  GetMaxAnisotropy()
+ *
+ *  This method is used for getting the largest anisotropy
+ *  the driver supports.
+ ***********************************************************/
+float SamplerManager::GetMaxAnisotropy()
+{
+	if (g_MaxAnisotropy == 0.0f)
+	{
+		g_MaxAnisotropy = 1.0f;
+		if (GLEW_ARB_texture_filter_anisotropic || GLEW_EXT_texture_filter_anisotropic)
+		{
+			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &g_MaxAnisotropy);
+			g_MaxAnisotropy = std::max(g_MaxAnisotropy, 1.0f);
+		}
+	}
+	return(g_MaxAnisotropy);
+}
+
+/***********************************************************
+ *  GetSampler()
+ *
+ *  This method is used for getting the sampler object of a
+ *  description, making it the first time it is asked for.
+ ***********************************************************/
+GLuint SamplerManager::GetSampler(const SAMPLER_DESC& desc)
+{
+	for (const SAMPLER_ENTRY& entry : g_Samplers)
+	{
+		if (IsSameDesc(entry.desc, desc))
+		{
+			return(entry.sampler);
+		}
+	}
+
+	SAMPLER_ENTRY entry;
+	entry.desc = desc;
+	glGenSamplers(1, &entry.sampler);
+
+	GLint wrap = desc.bClamp ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+	glSamplerParameteri(entry.sampler, GL_TEXTURE_WRAP_S, wrap);
+	glSamplerParameteri(entry.sampler, GL_TEXTURE_WRAP_T, wrap);
+
+	GLint minFilter = GL_LINEAR_MIPMAP_LINEAR;
+	GLint magFilter = GL_LINEAR;
+	switch (desc.filter)
+	{
+	case FILTER_NEAREST:
+		minFilter = GL_NEAREST;
+		magFilter = GL_NEAREST;
+		break;
+	case FILTER_LINEAR:
+		minFilter = GL_LINEAR;
+		break;
+	case FILTER_BILINEAR:
+		minFilter = GL_LINEAR_MIPMAP_NEAREST;
+		break;
+	case FILTER_TRILINEAR:
+		minFilter = GL_LINEAR_MIPMAP_LINEAR;
+		break;
+	}
+	glSamplerParameteri(entry.sampler, GL_TEXTURE_MIN_FILTER, minFilter);
+	glSamplerParameteri(entry.sampler, GL_TEXTURE_MAG_FILTER, magFilter);
+	glSamplerParameterf(entry.sampler, GL_TEXTURE_LOD_BIAS, desc.lodBias);
+
+	// anisotropy reads the mipmaps, so it is left off without them
+	float maxAnisotropy = GetMaxAnisotropy();
+	if ((maxAnisotropy > 1.0f) && (desc.anisotropy > 1.0f) &&
+		((desc.filter == FILTER_BILINEAR) || (desc.filter == FILTER_TRILINEAR)))
+	{
+		glSamplerParameterf(entry.sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT,
+			std::min(desc.anisotropy, maxAnisotropy));
+	}
+
+	g_Samplers.push_back(entry);
+	return(entry.sampler);
+}
+
+/***********************************************************
+ *  BindSampler()
+ *
+ *  This method is used for binding a sampler to a texture
+ *  unit, when another one is bound to it.
+ ***********************************************************/
+void SamplerManager::BindSampler(int textureUnit, GLuint sampler)
+{
+	if ((textureUnit < 0) || (textureUnit >= MAX_TEXTURE_UNITS))
+	{
+		return;
+	}
+	if (g_BoundSamplers[textureUnit] != sampler)
+	{
+		glBindSampler(textureUnit, sampler);
+		g_BoundSamplers[textureUnit] = sampler;
+	}
+}
+
+/***********************************************************
+ *  GetSamplerCount()
+ *
+ *  This method is used for getting the number of sampler
+ *  objects made so far.
+ ***********************************************************/
+int SamplerManager::GetSamplerCount()
+{
+	return((int)g_Samplers.size());
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for unbinding and freeing every
+ *  sampler object.
+ ***********************************************************/
+void SamplerManager::Release()
+{
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+	{
+		BindSampler(unit, 0);
+	}
+	for (SAMPLER_ENTRY& entry : g_Samplers)
+	{
+		glDeleteSamplers(1, &entry.sampler);
+	}
+	g_Samplers.clear();
+}
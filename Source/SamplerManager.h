@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// samplermanager.h
+// ============
+// share sampler objects - how textures are filtered, wrapped and biased
+//
+//  A sampler is described by its filter, anisotropy, wrapping and level of
+//  detail bias, and each description is made into one GL sampler object the
+//  first time it is asked for.  Materials name the description they want,
+//  and the sampler is bound to the texture unit of the object's texture,
+//  skipping binds that would not change anything.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  SamplerManager
+ *
+ *  This class contains the code for the sampler cache.  The
+ *  samplers and texture units are shared by every scene, so
+ *  everything is static.
+ ***********************************************************/
+class SamplerManager
+{
+public:
+	enum FILTER_MODE
+	{
+		// the nearest texel of the first level
+		FILTER_NEAREST,
+		// the first level blended, the mipmaps are never read
+		FILTER_LINEAR,
+		// blended within the nearest mipmap
+		FILTER_BILINEAR,
+		// blended within and between the two nearest mipmaps
+		FILTER_TRILINEAR
+	};
+
+	struct SAMPLER_DESC
+	{
+		FILTER_MODE filter;
+		// samples along the direction the texture is stretched, 1 for
+		// none, limited to what the driver supports
+		float anisotropy;
+		// clamp to the edge instead of repeating
+		bool bClamp;
+		// added to the mipmap level, negative for sharper textures
+		float lodBias;
+	};
+
+	// most texture units a sampler binding is kept for
+	static const int MAX_TEXTURE_UNITS = 16;
+
+	static SAMPLER_DESC MakeDesc(
+		FILTER_MODE filter,
+		float anisotropy = 1.0f,
+		bool bClamp = false,
+		float lodBias = 0.0f);
+
+	// the sampler object for a description, made on first use
+	static GLuint GetSampler(const SAMPLER_DESC& desc);
+	// bind a sampler to a texture unit, 0 to use the texture's own
+	// parameters again
+	static void BindSampler(int textureUnit, GLuint sampler);
+
+	// largest anisotropy the driver supports, 1 without the extension
+	static float GetMaxAnisotropy();
+	static int GetSamplerCount();
+
+	// unbind and free the sampler objects
+	static void Release();
+};
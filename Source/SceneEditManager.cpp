@@ -0,0 +1,481 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneeditmanager.cpp
+// ============
+// edit the running scene from another program - patches over a local socket
+//
+//  The protocol is plain text, so a patch can be typed into any TCP client
+//  as well as sent by a tool.  Each patch is answered on its own line, with
+//  "ok" and its latencies in microseconds, or "error" and the reason.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneEditManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// longest patch line, longer lines drop the connection
+	const size_t g_MaxLineLength = 4096;
+	// time between statistics reports
+	const double g_ReportSeconds = 5.0;
+
+	struct MESH_NAME
+	{
+		const char* name;
+		SceneManager::MESH_TYPE mesh;
+	};
+
+	const MESH_NAME g_MeshNames[] =
+	{
+		{ "box", SceneManager::BOX_MESH },
+		{ "cone", SceneManager::CONE_MESH },
+		{ "cylinder", SceneManager::CYLINDER_MESH },
+		{ "plane", SceneManager::PLANE_MESH },
+		{ "sphere", SceneManager::SPHERE_MESH },
+		{ "tapered", SceneManager::TAPERED_CYLINDER_MESH }
+	};
+	const int g_MeshNameCount = sizeof(g_MeshNames) / sizeof(g_MeshNames[0]);
+
+	// shader names of the light values that may be edited
+	const char* g_LightPrefixes[] = { "directionalLight.", "pointLights[", "spotLight." };
+	const int g_LightPrefixCount = sizeof(g_LightPrefixes) / sizeof(g_LightPrefixes[0]);
+
+	bool ReadVec2(std::istringstream& stream, glm::vec2& value)
+	{
+		return((bool)(stream >> value.x >> value.y));
+	}
+
+	bool ReadVec3(std::istringstream& stream, glm::vec3& value)
+	{
+		return((bool)(stream >> value.x >> value.y >> value.z));
+	}
+
+	bool ReadVec4(std::istringstream& stream, glm::vec4& value)
+	{
+		return((bool)(stream >> value.x >> value.y >> value.z >> value.w));
+	}
+
+	// read an optional UV scale, leaving the stream where it was
+	// when the next word is not a number
+	glm::vec2 ReadOptionalUVScale(std::istringstream& stream)
+	{
+		glm::vec2 UVscale = glm::vec2(1.0f, 1.0f);
+		std::streampos position = stream.tellg();
+		if (!ReadVec2(stream, UVscale))
+		{
+			stream.clear();
+			stream.seekg(position);
+			UVscale = glm::vec2(1.0f, 1.0f);
+		}
+		return(UVscale);
+	}
+
+	// read the fields of a modify patch up to the end of the line
+	bool ReadObjectFields(std::istringstream& stream, SceneManager::SCENE_EDIT& edit, std::string& error)
+	{
+		std::string field;
+		while (stream >> field)
+		{
+			if ((field == "transform") && ReadVec3(stream, edit.scaleXYZ) &&
+				ReadVec3(stream, edit.rotationXYZ) && ReadVec3(stream, edit.positionXYZ))
+			{
+				edit.fields |= SceneManager::EDIT_FIELD_TRANSFORM;
+			}
+			else if ((field == "color") && ReadVec4(stream, edit.color))
+			{
+				edit.fields |= SceneManager::EDIT_FIELD_COLOR;
+			}
+			else if ((field == "texture") && (stream >> edit.textureTag))
+			{
+				edit.UVscale = ReadOptionalUVScale(stream);
+				edit.fields |= SceneManager::EDIT_FIELD_TEXTURE;
+			}
+			else if ((field == "material") && (stream >> edit.materialTag))
+			{
+				edit.fields |= SceneManager::EDIT_FIELD_MATERIAL;
+			}
+			else
+			{
+				error = "bad '" + field + "' values";
+				return(false);
+			}
+		}
+		if (edit.fields == 0)
+		{
+			error = "nothing to modify";
+			return(false);
+		}
+		return(true);
+	}
+}
+
+/***********************************************************
+ *  SceneEditManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneEditManager::SceneEditManager()
+{
+	m_sequence = 0;
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_editsApplied = 0;
+	m_editsFailed = 0;
+	m_applyMicroseconds = 0.0;
+	m_maxApplyMicroseconds = 0.0;
+	m_waitMicroseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~SceneEditManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneEditManager::~SceneEditManager()
+{
+	m_client.Close();
+	m_listener.Close();
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for listening for an editing tool on
+ *  the passed TCP port.
+ ***********************************************************/
+bool SceneEditManager::Start(int port)
+{
+	// the scene may only be edited from this machine
+	if (!m_listener.Listen(port, true))
+	{
+		return(false);
+	}
+
+	std::cout << "INFO: Scene editing listening on port " << port << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for accepting a waiting tool and
+ *  applying the patches received since the last frame, in
+ *  the order they were sent.
+ ***********************************************************/
+void SceneEditManager::Update(SceneManager* pSceneManager)
+{
+	if (!m_client.IsOpen() && m_listener.Accept(m_client))
+	{
+		m_client.SetNoDelay();
+		m_receivedText.clear();
+		std::cout << "INFO: Scene editing tool connected" << std::endl;
+	}
+
+	ReceiveEdits();
+
+	for (const PENDING_EDIT& pending : m_pendingEdits)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::chrono::duration<double, std::micro> waited = start - pending.receivedTime;
+
+		SceneManager::SCENE_EDIT edit;
+		std::string error;
+		bool bApplied = ParseEdit(pending.line, edit, error) &&
+			(NULL != pSceneManager) && pSceneManager->ApplySceneEdit(edit, error);
+
+		std::chrono::duration<double, std::micro> applied = std::chrono::steady_clock::now() - start;
+		std::ostringstream reply;
+		if (bApplied)
+		{
+			reply << "ok " << pending.sequence << " applied " << applied.count()
+				<< " us waited " << waited.count() << " us\n";
+			std::cout << "INFO: Scene edit " << pending.sequence << " '" << pending.line << "' applied in "
+				<< applied.count() << " us after waiting " << waited.count() << " us for the frame" << std::endl;
+			m_editsApplied++;
+			m_applyMicroseconds += applied.count();
+			m_maxApplyMicroseconds = std::max(m_maxApplyMicroseconds, applied.count());
+			m_waitMicroseconds += waited.count();
+		}
+		else
+		{
+			reply << "error " << pending.sequence << " " << error << "\n";
+			std::cout << "Scene edit " << pending.sequence << " '" << pending.line << "' failed: " << error << std::endl;
+			m_editsFailed++;
+		}
+		SendReply(reply.str());
+	}
+	m_pendingEdits.clear();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+	if (elapsed.count() >= g_ReportSeconds)
+	{
+		ReportStatistics();
+	}
+}
+
+/***********************************************************
+ *  ReceiveEdits()
+ *
+ *  This method is used for reading the text waiting on the
+ *  socket, without blocking, and queuing each whole line as
+ *  a patch.  Empty lines and lines starting with # are
+ *  skipped.
+ ***********************************************************/
+void SceneEditManager::ReceiveEdits()
+{
+	char buffer[1024];
+
+	while (m_client.IsOpen() && m_client.WaitReadable(0))
+	{
+		int received = m_client.ReceiveSome(buffer, sizeof(buffer));
+		if (received <= 0)
+		{
+			DisconnectClient();
+			return;
+		}
+		m_receivedText.append(buffer, received);
+
+		size_t lineEnd = 0;
+		while ((lineEnd = m_receivedText.find('\n')) != std::string::npos)
+		{
+			std::string line = m_receivedText.substr(0, lineEnd);
+			m_receivedText.erase(0, lineEnd + 1);
+			if (!line.empty() && (line[line.size() - 1] == '\r'))
+			{
+				line.erase(line.size() - 1);
+			}
+			if (line.empty() || (line[0] == '#'))
+			{
+				continue;
+			}
+
+			PENDING_EDIT pending;
+			pending.sequence = ++m_sequence;
+			pending.line = line;
+			pending.receivedTime = std::chrono::steady_clock::now();
+			m_pendingEdits.push_back(pending);
+		}
+
+		if (m_receivedText.size() > g_MaxLineLength)
+		{
+			std::cout << "Scene edit line too long, dropping the editing tool" << std::endl;
+			DisconnectClient();
+			return;
+		}
+	}
+}
+
+/***********************************************************
+ *  DisconnectClient()
+ *
+ *  This method is used for dropping the tool connection.
+ *  Patches already received are still applied.
+ ***********************************************************/
+void SceneEditManager::DisconnectClient()
+{
+	m_client.Close();
+	m_receivedText.clear();
+	std::cout << "INFO: Scene editing tool disconnected" << std::endl;
+}
+
+/***********************************************************
+ *  SendReply()
+ *
+ *  This method is used for answering a patch, when the tool
+ *  is still connected.
+ ***********************************************************/
+void SceneEditManager::SendReply(const std::string& reply)
+{
+	if (m_client.IsOpen() && !m_client.SendAll(reply.data(), reply.size()))
+	{
+		DisconnectClient();
+	}
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing the patches applied and
+ *  their latencies since the last report.
+ ***********************************************************/
+void SceneEditManager::ReportStatistics()
+{
+	if ((m_editsApplied > 0) || (m_editsFailed > 0))
+	{
+		int applied = std::max(m_editsApplied, 1);
+		std::cout << "INFO: Scene editing applied " << m_editsApplied << " patches, " << m_editsFailed
+			<< " failed, " << (m_applyMicroseconds / applied) << " us to apply on average, "
+			<< m_maxApplyMicroseconds << " us at most, " << (m_waitMicroseconds / applied)
+			<< " us waiting for the frame" << std::endl;
+	}
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_editsApplied = 0;
+	m_editsFailed = 0;
+	m_applyMicroseconds = 0.0;
+	m_maxApplyMicroseconds = 0.0;
+	m_waitMicroseconds = 0.0;
+}
+
+/***********************************************************
+ *  ParseEdit()
+ *
+ *  This method is used for reading a patch line into a
+ *  scene edit.  Returns false with the reason when the line
+ *  is not a valid patch.
+ ***********************************************************/
+bool SceneEditManager::ParseEdit(const std::string& line, SceneManager::SCENE_EDIT& edit, std::string& error)
+{
+	std::istringstream stream(line);
+	std::string command;
+	stream >> command;
+
+	edit.room = 0;
+	edit.fields = 0;
+	edit.mesh = SceneManager::BOX_MESH;
+	edit.scaleXYZ = glm::vec3(1.0f);
+	edit.rotationXYZ = glm::vec3(0.0f);
+	edit.positionXYZ = glm::vec3(0.0f);
+	edit.color = glm::vec4(1.0f);
+	edit.UVscale = glm::vec2(1.0f, 1.0f);
+	edit.diffuseColor = glm::vec3(1.0f);
+	edit.specularColor = glm::vec3(0.0f);
+	edit.shininess = 1.0f;
+	edit.lightType = SceneManager::LIGHT_FLOAT;
+	edit.lightValue = glm::vec3(0.0f);
+
+	if (command == "add")
+	{
+		std::string meshName;
+		std::string kind;
+		edit.type = SceneManager::EDIT_ADD_OBJECT;
+		if (!(stream >> edit.room >> edit.tag >> meshName) || !ReadVec3(stream, edit.scaleXYZ) ||
+			!ReadVec3(stream, edit.rotationXYZ) || !ReadVec3(stream, edit.positionXYZ) || !(stream >> kind))
+		{
+			error = "expected add <room> <tag> <mesh> <scale xyz> <rotation xyz> <position xyz> texture|color ...";
+			return(false);
+		}
+
+		int meshIndex = 0;
+		while ((meshIndex < g_MeshNameCount) && (meshName != g_MeshNames[meshIndex].name))
+		{
+			meshIndex++;
+		}
+		if (meshIndex == g_MeshNameCount)
+		{
+			error = "no mesh '" + meshName + "'";
+			return(false);
+		}
+		edit.mesh = g_MeshNames[meshIndex].mesh;
+
+		if ((kind == "texture") && (stream >> edit.textureTag >> edit.materialTag))
+		{
+			edit.UVscale = ReadOptionalUVScale(stream);
+			edit.fields = SceneManager::EDIT_FIELD_TRANSFORM | SceneManager::EDIT_FIELD_TEXTURE |
+				SceneManager::EDIT_FIELD_MATERIAL;
+		}
+		else if ((kind == "color") && ReadVec4(stream, edit.color) && (stream >> edit.materialTag))
+		{
+			edit.fields = SceneManager::EDIT_FIELD_TRANSFORM | SceneManager::EDIT_FIELD_COLOR |
+				SceneManager::EDIT_FIELD_MATERIAL;
+		}
+		else
+		{
+			error = "expected texture <texture> <material> [u v] or color <r g b a> <material>";
+			return(false);
+		}
+	}
+	else if (command == "remove")
+	{
+		edit.type = SceneManager::EDIT_REMOVE_OBJECT;
+		if (!(stream >> edit.room >> edit.tag))
+		{
+			error = "expected remove <room> <tag>";
+			return(false);
+		}
+	}
+	else if (command == "modify")
+	{
+		edit.type = SceneManager::EDIT_MODIFY_OBJECT;
+		if (!(stream >> edit.room >> edit.tag))
+		{
+			error = "expected modify <room> <tag> ...";
+			return(false);
+		}
+		if (!ReadObjectFields(stream, edit, error))
+		{
+			return(false);
+		}
+	}
+	else if (command == "material")
+	{
+		edit.type = SceneManager::EDIT_SET_MATERIAL;
+		if (!(stream >> edit.tag) || !ReadVec3(stream, edit.diffuseColor) ||
+			!ReadVec3(stream, edit.specularColor) || !(stream >> edit.shininess))
+		{
+			error = "expected material <tag> <diffuse rgb> <specular rgb> <shininess>";
+			return(false);
+		}
+	}
+	else if (command == "light")
+	{
+		std::string typeName;
+		edit.type = SceneManager::EDIT_SET_LIGHT;
+		if (!(stream >> edit.tag >> typeName))
+		{
+			error = "expected light <name> bool|float|vec3 <values>";
+			return(false);
+		}
+
+		int prefix = 0;
+		while ((prefix < g_LightPrefixCount) &&
+			(edit.tag.compare(0, strlen(g_LightPrefixes[prefix]), g_LightPrefixes[prefix]) != 0))
+		{
+			prefix++;
+		}
+		if (prefix == g_LightPrefixCount)
+		{
+			error = "'" + edit.tag + "' is not a light value";
+			return(false);
+		}
+
+		bool bRead = false;
+		if (typeName == "bool")
+		{
+			edit.lightType = SceneManager::LIGHT_BOOL;
+			bRead = (bool)(stream >> edit.lightValue.x);
+		}
+		else if (typeName == "float")
+		{
+			edit.lightType = SceneManager::LIGHT_FLOAT;
+			bRead = (bool)(stream >> edit.lightValue.x);
+		}
+		else if (typeName == "vec3")
+		{
+			edit.lightType = SceneManager::LIGHT_VEC3;
+			bRead = ReadVec3(stream, edit.lightValue);
+		}
+		if (!bRead)
+		{
+			error = "expected bool, float or vec3 values for '" + edit.tag + "'";
+			return(false);
+		}
+	}
+	else
+	{
+		error = "unknown patch '" + command + "'";
+		return(false);
+	}
+
+	// anything left over is a mistake in the patch
+	std::string extra;
+	if (stream >> extra)
+	{
+		error = "unexpected '" + extra + "'";
+		return(false);
+	}
+	return(true);
+}
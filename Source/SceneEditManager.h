@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// sceneeditmanager.h
+// ============
+// edit the running scene from another program - patches over a local socket
+//
+//  An editing tool connects to a port on the loopback address and sends one
+//  patch per line, adding, removing or changing an object, a material or a
+//  light value.  The patches are applied between frames, each touching only
+//  what it edits, and every patch is answered with how long it waited for
+//  the frame to end and how long it took to apply.
+//
+//  add <room> <tag> <mesh> <scale xyz> <rotation xyz> <position xyz>
+//      texture <texture> <material> [u v] | color <r g b a> <material>
+//  remove <room> <tag>
+//  modify <room> <tag> [transform <scale xyz> <rotation xyz> <position xyz>]
+//      [color <r g b a>] [texture <texture> [u v]] [material <material>]
+//  material <tag> <diffuse rgb> <specular rgb> <shininess>
+//  light <name> bool|float|vec3 <values>
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "NetworkSocket.h"
+#include "SceneManager.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneEditManager
+ *
+ *  This class contains the code for receiving scene patches
+ *  from an editing tool and applying them between frames.
+ ***********************************************************/
+class SceneEditManager
+{
+public:
+	// constructor
+	SceneEditManager();
+	// destructor
+	~SceneEditManager();
+
+private:
+	// a patch received and waiting for the frame to end
+	struct PENDING_EDIT
+	{
+		uint32_t sequence;
+		std::string line;
+		std::chrono::steady_clock::time_point receivedTime;
+	};
+
+	NetworkSocket m_listener;
+	NetworkSocket m_client;
+	// text received but not yet a whole line
+	std::string m_receivedText;
+	std::vector<PENDING_EDIT> m_pendingEdits;
+	uint32_t m_sequence;
+
+	// statistics, reported every few seconds
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	int m_editsApplied;
+	int m_editsFailed;
+	double m_applyMicroseconds;
+	double m_maxApplyMicroseconds;
+	double m_waitMicroseconds;
+
+	// read the patches waiting on the socket without blocking
+	void ReceiveEdits();
+	// drop the tool connection
+	void DisconnectClient();
+	// answer a patch
+	void SendReply(const std::string& reply);
+	// print and reset the statistics
+	void ReportStatistics();
+
+public:
+	// listen for an editing tool on a TCP port
+	bool Start(int port);
+
+	// accept a tool and apply the patches it sent since the last
+	// frame, called between frames
+	void Update(SceneManager* pSceneManager);
+
+	// read one patch line, returns false with the reason when it
+	// is not a valid patch
+	static bool ParseEdit(const std::string& line, SceneManager::SCENE_EDIT& edit, std::string& error);
+};
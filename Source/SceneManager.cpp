@@ -1,958 +1,3257 @@
-///////////////////////////////////////////////////////////////////////////////
-// scenemanager.cpp
-// ================
-// This file contains the implementation of the `SceneManager` class, which is 
-// responsible for managing the preparation and rendering of 3D scenes. It 
-// handles textures, materials, lighting configurations, and object rendering.
-//
-// AUTHOR: Brian Battersby
-// INSTITUTION: Southern New Hampshire University (SNHU)
-// COURSE: CS-330 Computational Graphics and Visualization
-//
-// INITIAL VERSION: November 1, 2023
-// LAST REVISED: December 1, 2024
-//
-// RESPONSIBILITIES:
-// - Load, bind, and manage textures in OpenGL.
-// - Define materials and lighting properties for 3D objects.
-// - Manage transformations and shader configurations.
-// - Render complex 3D scenes using basic meshes.
-//
-// NOTE: This implementation leverages external libraries like `stb_image` for 
-// texture loading and GLM for matrix and vector operations.
-///////////////////////////////////////////////////////////////////////////////
-
-#include "SceneManager.h"
-#ifndef STB_IMAGE_IMPLEMENTATION
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
-#endif
-
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/transform.hpp>
-#include <ctime>
-
-// declaration of global variables
-namespace
-{
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
-}
-
-/***********************************************************
- *  SceneManager()
- *
- *  The constructor for the class
- ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
-{
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-	m_basicMeshes->DrawPlaneMesh();
-}
-
-/***********************************************************
- *  ~SceneManager()
- *
- *  The destructor for the class
- ***********************************************************/
-SceneManager::~SceneManager()
-{
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
-}
-
-/***********************************************************
- *  CreateGLTexture()
- *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
- ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
-{
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
-	}
-
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
-}
-
-/***********************************************************
- *  BindGLTextures()
- *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
- ***********************************************************/
-void SceneManager::BindGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  DestroyGLTextures()
- *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
- ***********************************************************/
-void SceneManager::DestroyGLTextures()
-{
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
-}
-
-/***********************************************************
- *  FindTextureID()
- *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
-{
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
-}
-
-/***********************************************************
- *  FindTextureSlot()
- *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
- ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
-{
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureSlot);
-}
-
-/***********************************************************
- *  FindMaterial()
- *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
- ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
-{
-	if (m_objectMaterials.size() == 0)
-	{
-		return(false);
-	}
-
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
-	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
-	}
-
-	return(true);
-}
-
-/***********************************************************
- *  SetTransformations()
- *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
- ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
-{
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationZ * rotationY * rotationX * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
-}
-
-/***********************************************************
- *  SetShaderColor()
- *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
- ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
-{
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
-}
-
-/***********************************************************
- *  SetShaderTexture()
- *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
- ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
-}
-
-/***********************************************************
- *  SetTextureUVScale()
- *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
- ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
-{
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
-}
-
-/***********************************************************
- *  SetShaderMaterial()
- *
- *  This method is used for passing the material values
- *  into the shader.
- ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
-{
-	if (m_objectMaterials.size() > 0)
-	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
-
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
-		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
-		}
-	}
-}
-
-/**************************************************************/
-/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
-/*** preparing and rendering their own 3D replicated scenes.***/
-/*** Please refer to the code in the OpenGL sample project  ***/
-/*** for assistance.                                        ***/
-/**************************************************************/
-
-void SceneManager::LoadSceneTextures()
-{
-	bool bReturn = false;
-
-	std::cout << "[DEBUG] Calling CreateGLTexture()..." << std::endl;
-	bReturn = CreateGLTexture(
-		"textures/Wood_table.png",
-		"desk");
-	bReturn = CreateGLTexture(
-		"textures/lamp_body.jpg",
-		"bronze");
-	bReturn = CreateGLTexture(
-		"textures/metal_head.jpg",
-		"crome");
-	bReturn = CreateGLTexture(
-		"textures/rubber_holds.jpg",
-		"rubber");
-	bReturn = CreateGLTexture(
-		"textures/book_cover.jpg",
-		"cover");
-	bReturn = CreateGLTexture(
-		"textures/book_fabric.jpg",
-		"fabric");
-	bReturn = CreateGLTexture(
-		"textures/fabric_black.jpg",
-		"fabricB");
-	bReturn = CreateGLTexture(
-		"textures/clock_face.jpg",
-		"clockF");
-	bReturn = CreateGLTexture(
-		"textures/ceiling.jpg",
-		"ceilingT");
-	bReturn = CreateGLTexture(
-		"textures/planks.jpg",
-		"planksW");
-	bReturn = CreateGLTexture(
-		"textures/marble.jpg",
-		"marble_floor");
-
-	if (!bReturn) {
-		std::cout << "Failed to load 'desk' texture!" << std::endl;
-	}
-	BindGLTextures();
-}
-void SceneManager::SetupSceneLights()
-{
-	// allows the shader to use lighting
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
-	// sets the position of the camera
-	m_pShaderManager->setVec3Value("viewPosition", glm::vec3(0.0f, -10.0f, 10.0f));
-
-	 // Enable the directional light
-	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
-
-	// sets the directional light color and direction
-	m_pShaderManager->setVec3Value("directionalLight.direction", glm::vec3(-0.3f, -1.0f, -0.3));
-	// sets the color of the light
-	m_pShaderManager->setVec3Value("directionalLight.ambient", glm::vec3(0.2f)); // Dim ambient light
-	// sets the main color of the light
-	m_pShaderManager->setVec3Value("directionalLight.diffuse", glm::vec3(0.6f));
-	// bright highlights
-	m_pShaderManager->setVec3Value("directionalLight.specular", glm::vec3(1.0f)); //shiny spot
-
-	m_pShaderManager->setBoolValue("pointLights[0].bActive", true);
-	// sets the position of the point light
-	m_pShaderManager->setVec3Value("pointLights[0].position", glm::vec3(-5.0f, 6.5f, -5.0f));
-	m_pShaderManager->setVec3Value("pointLights[0].ambient", glm::vec3(0.05f, 0.05f, 0.5f));
-	m_pShaderManager->setVec3Value("pointLights[0].diffuse", glm::vec3(0.2f, 0.2f, 0.2f));
-	m_pShaderManager->setVec3Value("pointLights[0].specular", glm::vec3(0.4f, 0.3f, 0.3f));
-
-	// Turn on spotlight
-	m_pShaderManager->setBoolValue("spotLight.bActive", true);
-
-	// light at the tip of lamp head
-	m_pShaderManager->setVec3Value("spotLight.position", glm::vec3(-2.2f, 6.5f, 2.5)); 
-
-	// Pointed in the direction lamp head is facing
-	m_pShaderManager->setVec3Value("spotLight.direction", glm::vec3(-0.7f, -1.5f, 1.0f)); // adjust as needed
-
-	// Spotlight cutoff
-	m_pShaderManager->setFloatValue("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-	m_pShaderManager->setFloatValue("spotLight.outerCutOff", glm::cos(glm::radians(35.5f)));
-
-	// Light color values
-	m_pShaderManager->setVec3Value("spotLight.ambient", glm::vec3(0.001f));
-	m_pShaderManager->setVec3Value("spotLight.diffuse", glm::vec3(4.0f, 4.4f, 4.0f));   // warm light
-	m_pShaderManager->setVec3Value("spotLight.specular", glm::vec3(3.0f));
-
-	// controls how far the light goes
-	m_pShaderManager->setFloatValue("spotLight.constant", 1.0f);
-	m_pShaderManager->setFloatValue("spotLight.linear", 0.09f);
-	m_pShaderManager->setFloatValue("spotLight.quadratic", 0.032f);
-
-}
-/***********************************************************
- *  PrepareScene()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void SceneManager::PrepareScene()
-{
-	SetupSceneLights();
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
-	// define the materials for objects in the scene
-	SceneManager::OBJECT_MATERIAL material;
-
-	// Desk
-	material.tag = "desk";
-	material.diffuseColor = glm::vec3(0.8f, 0.5f, 0.2f);
-	material.specularColor = glm::vec3(0.5f);
-	material.shininess = 32.0f;
-	m_objectMaterials.push_back(material);
-	// Lamp
-	material.tag = "lamp";
-	material.diffuseColor = glm::vec3(0.8f);
-	material.specularColor = glm::vec3(0.5f);
-	material.shininess = 64.0f;
-	m_objectMaterials.push_back(material);
-	// Lamp Head
-	material.tag = "lamp_head";
-	material.diffuseColor = glm::vec3(0.5f);
-	material.specularColor = glm::vec3(0.8f);
-	material.shininess = 32.0f;
-	m_objectMaterials.push_back(material);
-	// Lamp Base
-	material.tag = "lamp_base";
-	material.diffuseColor = glm::vec3(0.7f);
-	material.specularColor = glm::vec3(0.4f);
-	material.shininess = 16.0f;
-	m_objectMaterials.push_back(material);
-	// hinges
-	material.tag = "rubber";
-	material.diffuseColor = glm::vec3(0.6f);
-	material.specularColor = glm::vec3(0.3f);
-	material.shininess = 16.0f;
-	m_objectMaterials.push_back(material);
-	// book cover
-	material.tag = "cover";
-	material.diffuseColor = glm::vec3(0.5f);              
-	material.specularColor = glm::vec3(0.1f, 0.1f, 0.2f);   // low reflection
-	material.shininess = 1.0f;                             
-	m_objectMaterials.push_back(material);
-	//book fabric
-	material.tag = "fabric";
-	material.diffuseColor = glm::vec3(0.5f);
-	material.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);   // low reflection
-	material.shininess = 1.0f;                             
-	m_objectMaterials.push_back(material);
-
-	material.tag = "fabricB";
-	material.diffuseColor = glm::vec3(1.0f);
-	material.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);   // low reflection
-	material.shininess = 0.4f;                             // wide, soft highlight
-	m_objectMaterials.push_back(material);
-	// clock face
-	material.tag = "clockF";
-	material.diffuseColor = glm::vec3(1.0f);
-	material.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);   // low reflection
-	material.shininess = 0.4f;                             // wide, soft highlight
-	m_objectMaterials.push_back(material);
-	// floor
-	material.tag = "marbleF";
-	material.diffuseColor = glm::vec3(0.8f, 0.5f, 0.2f);
-	material.specularColor = glm::vec3(1.0f);
-	material.shininess = 64.0f;
-	m_objectMaterials.push_back(material);
-	// walls
-	material.tag = "planksW";
-	material.diffuseColor = glm::vec3(0.8f, 0.5f, 0.2f);
-	material.specularColor = glm::vec3(0.5f);
-	material.shininess = 0.5f;
-	m_objectMaterials.push_back(material);
-	// ceiling
-	material.tag = "ceilingT";
-	material.diffuseColor = glm::vec3(0.8f, 0.5f, 0.2f);
-	material.specularColor = glm::vec3(0.5f);
-	material.shininess = 5.0f;
-	m_objectMaterials.push_back(material);
-
-/*************************************************************
-/***
-/*** 
-/***
-****************************8*********************************/
-	// load the textures into OpenGL memory
-	LoadSceneTextures();
-    
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadConeMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
-}
-
-/***********************************************************
- *  RenderScene()
- *
- *  This method is used for rendering the 3D scene by 
- *  transforming and drawing the basic 3D shapes
- ***********************************************************/
-void SceneManager::RenderScene()
-{
-	time_t now = time(0);
-	tm timeinfo;
-	localtime_s(&timeinfo, &now);
-	
-
-	float hourAngle = -((timeinfo.tm_hour % 12) + timeinfo.tm_min / 60.0f) * 30.0f;
-	float minuteAngle = -timeinfo.tm_min * 6.0f;
-	float secondAngle = -timeinfo.tm_sec * 6.0f;
-
-	// declare the variables for the transformations
-	glm::vec3 scaleXYZ;
-	float XrotationDegrees = 0.0f;
-	float YrotationDegrees = 0.0f;
-	float ZrotationDegrees = 0.0f;
-	glm::vec3 positionXYZ;
-
-	
-	/*** Set needed transformations before drawing the basic mesh.  ***/
-	/*** This same ordering of code should be used for transforming ***/
-	/*** and drawing all the basic 3D shapes.						***/
-	/******************************************************************/
-	// set the XYZ scale for the mesh
-	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
-
-	// set the XYZ rotation for the mesh
-	XrotationDegrees = 0.0f;
-	YrotationDegrees = 0.0f;
-	ZrotationDegrees = 0.0f;
-
-	// set the XYZ position for the mesh
-	positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
-
-	// set the transformations into memory to be used on the drawn meshes
-	SetTransformations(
-		scaleXYZ,
-		XrotationDegrees,
-		YrotationDegrees,
-		ZrotationDegrees,
-		positionXYZ);
-
-	/****************************************************************/
-	/***                                                          ***/
-	/***                        Desk setup                        ***/
-	/***                                                          ***/
-	/****************************************************************/
-
-	/****************************************************************/
-	/*** desk (top)                                               ***/
-	/****************************************************************/
-	// set the color for the mesh
-	SetShaderTexture("desk");
-	SetShaderMaterial("desk");
-	// set the UV scale for the texture mapping to 4x4 tiling
-	m_pShaderManager->setVec2Value("UVscale", glm::vec2(4.0f, 4.0f));
-	scaleXYZ = glm::vec3(25.0f, 0.5f, 12.0f);  // width, thickness, depth
-	positionXYZ = glm::vec3(0.0f, -0.3f, 2.0f);  // lift it so top surface stays visible
-	SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-	// Desk part 2
-	scaleXYZ = glm::vec3(20.0f, 0.3f, 11.0f);  // width, thickness, depth
-	positionXYZ = glm::vec3(0.0f, -0.3f, 2.0f);  
-	SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-	m_basicMeshes->DrawBoxMesh();
-	
-	glm::vec3 legScale = glm::vec3(0.5f, 5.0f, 0.5f);  // thin, tall leg
-	float deskHeight = -0.3f;  
-	float legOffsetX = 9.0f;  
-	float legOffsetZ = 3.5f;   
-	float legY = deskHeight - (legScale.y / 2.1f); 
-
-	/****************************************************************/
-	/*** desk legs                                                ***/
-	/****************************************************************/
-	// Front-left leg
-	SetTransformations(legScale, 0, 0, 0, glm::vec3(-legOffsetX, legY, legOffsetZ));
-	SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);  // dark metal or wood
-	m_basicMeshes->DrawBoxMesh();
-
-	// Front-right leg
-	SetTransformations(legScale, 0, 0, 0, glm::vec3(legOffsetX, legY, legOffsetZ));
-	m_basicMeshes->DrawBoxMesh();
-
-	// Back-left leg
-	SetTransformations(legScale, 0, 0, 0, glm::vec3(-legOffsetX, legY, -legOffsetZ));
-	m_basicMeshes->DrawBoxMesh();
-
-	// Back-right leg
-	SetTransformations(legScale, 0, 0, 0, glm::vec3(legOffsetX, legY, -legOffsetZ));
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************************************************************/
-	/***                                                          ***/
-	/***                        Lamp setup                        ***/
-	/***                                                          ***/
-	/****************************************************************/
-
-	/****************************************************************/
-	/*** Lamp Base (bottom part)                                  ***/
-	/****************************************************************/
-	scaleXYZ = glm::vec3(2.5f, 0.8f, 2.5f); // Wide and flat
-	positionXYZ = glm::vec3(0.0f, 0.05f, 0.0f); // Touching the floor
-	SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-	// SetShaderColor(0.55f, 0.27f, 0.05f, 1.0f);
-	SetShaderTexture("bronze");
-	SetShaderMaterial("lamp_base");
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-	m_basicMeshes->DrawCylinderMesh(); 
-
-	/****************************************************************/
-	/*** Bottom Vertical Stand (lamp pole)                        ***/
-	/****************************************************************/
-	scaleXYZ = glm::vec3(0.3f, 6.6f, 0.3f); // Tall, thin cylinder
-	positionXYZ = glm::vec3(0.0f, 0.7f, 0.0f); // On top of base
-	SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-	// SetShaderColor
-	SetShaderTexture("bronze");
-	SetShaderMaterial("lamp");
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-	m_basicMeshes->DrawCylinderMesh();
-
-	/****************************************************************/
-	/*** Top Vertical Stand (lamp pole)                           ***/
-	/****************************************************************/
-	scaleXYZ = glm::vec3(0.3f, 2.0f, 0.3f); // Thin cylinder
-	positionXYZ = glm::vec3(0.0f, 7.5f, 0.0f); // On top of bottom hinge
-	SetTransformations(scaleXYZ, 75.0f, -45.0f, 0.0f, positionXYZ);
-	// setShaderColor
-	SetShaderTexture("bronze");
-	SetShaderMaterial("lamp");
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-	m_basicMeshes->DrawCylinderMesh();
-
-	/****************************************************************/
-	/*** Bottom Hinge (sphere)                                    ***/
-	/****************************************************************/
-	scaleXYZ = glm::vec3(0.5f, 0.5f, 0.5f);
-	positionXYZ = glm::vec3(0.0f, 7.5f, 0.0f); 
-	SetTransformations(scaleXYZ, 0.0f, 45.0f, 0.0f, positionXYZ);
-	// SetShaderColor
-	SetShaderTexture("rubber");
-	SetShaderMaterial("rubber");
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-	m_basicMeshes->DrawSphereMesh(); 
-
-	/****************************************************************/
-	/*** Top Hinge (sphere)                                       ***/
-	/****************************************************************/
-	scaleXYZ = glm::vec3(0.5f, 0.5f, 0.5f);
-	positionXYZ = glm::vec3(-1.5f, 8.1f, 1.5f); 
-	SetTransformations(scaleXYZ, 0.0f, 45.0f, 0.0f, positionXYZ);
-	// SetShaderColor
-	SetShaderTexture("rubber");
-	SetShaderMaterial("rubber");
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-	m_basicMeshes->DrawSphereMesh();
-
-	/****************************************************************/
-	/*** Lamp Head (angled downward)                              ***/
-	/****************************************************************/
-	scaleXYZ = glm::vec3(1.5f, 2.0f, 1.5f); // Taller taper lamp
-	positionXYZ = glm::vec3(-2.2f, 6.5f, 2.5f); // Offset above connector
-	SetTransformations(scaleXYZ, 35.0f, 145.0f, 0.0f, positionXYZ); // Tilted out and to the side
-	// SetShaderColor
-	SetShaderTexture("crome");
-	SetShaderMaterial("lamp_head");
-	//SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);
-	m_basicMeshes->DrawConeMesh(); 
-	/****************************************************************/
-	/***                                                          ***/
-	/***                        Book setup                        ***/
-	/***                                                          ***/
-	/****************************************************************/
-
-	/****************************************************************/
-	/*** Bottom Cover (flat rectangle)                            ***/
-	/****************************************************************/
-	scaleXYZ = glm::vec3(4.7f, 0.2f, 3.8f);
-	positionXYZ = glm::vec3(-3.0f, 0.1f, 6.0f);
-	SetTransformations(scaleXYZ, 0, 0, 0, positionXYZ);
-	SetShaderTexture("fabricB");
-	SetShaderMaterial("fabricB");
-	SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************************************************************/
-	/*** Book Pages                                               ***/
-	/****************************************************************/
-	for (int i = 0; i < 8; ++i)
-	{
-		scaleXYZ = glm::vec3(4.65f, 0.04f, 3.7f);
-		positionXYZ = glm::vec3(-3.03f, 0.21f + i * 0.045f, 6.0f);
-		SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-		SetShaderColor(1.0f, 1.0f, 0.9f, 1.0f);  // Cream paper
-		m_basicMeshes->DrawBoxMesh();
-	}
-	/****************************************************************/
-	/*** Top Cover                                                ***/
-	/****************************************************************/
-	scaleXYZ = glm::vec3(4.7f, 0.2f, 3.8f);
-	positionXYZ = glm::vec3(-3.0f, 0.64f, 6.0f);  // slightly higher
-	SetTransformations(scaleXYZ, 0, 0, 0, positionXYZ);
-	SetShaderTexture("fabricB");
-	SetShaderMaterial("fabricB");
-	SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************************************************************/
-	/***  Page Crease Setup                                       ***/
-	/****************************************************************/
-	// Page crease strip (left side vertical edge)
-	scaleXYZ = glm::vec3(0.2f, 0.74f, 3.8f);  // Very thin wall, same height as pages
-	positionXYZ = glm::vec3(-5.45f, 0.370f, 6.0f);  // Push left along X axis
-	SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-	SetShaderTexture("fabricB");
-	SetShaderMaterial("fabricB");
-	SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
-	
-	/****************************************************************/
-	/***Book Cover Photo Setup                                    ***/
-	/****************************************************************/
-	SetShaderTexture("cover");
-	m_pShaderManager->setVec2Value("UVscale", glm::vec2(1.0f, 1.0f));
-	scaleXYZ = glm::vec3(1.90f, 0.01f, 2.35f);            
-	positionXYZ = glm::vec3(-3.0f, 0.742f, 6.0f);         
-	SetTransformations(scaleXYZ, 0, 90, 0, positionXYZ);
-	m_basicMeshes->DrawPlaneMesh();
-
-	/****************************************************************/
-	/***                                                          ***/
-	/***                        Room                              ***/
-	/***                                                          ***/
-	/****************************************************************/
-
-	// Back wall
-	scaleXYZ = glm::vec3(40.0f, 20.0f, 0.5f);       
-	positionXYZ = glm::vec3(0.0f, 5.0f, -20.0f);  
-	SetTransformations(scaleXYZ, 0, 0, 0, positionXYZ);
-	SetShaderTexture("planksW");
-	SetShaderMaterial("planksW");
-	m_basicMeshes->DrawBoxMesh();
-
-	// left
-	scaleXYZ = glm::vec3(0.5f, 20.0f, 40.0f);
-	positionXYZ = glm::vec3(-20.0f, 5.0f, 0.0f);
-	SetTransformations(scaleXYZ, 0, 0, 0, positionXYZ);
-	SetShaderTexture("planksW");
-	SetShaderMaterial("planksW");
-	m_basicMeshes->DrawBoxMesh();
-	
-	// right 
-	scaleXYZ = glm::vec3(0.5f, 20.0f, 40.0f);
-	positionXYZ = glm::vec3(20.0f, 5.0f, 0.0f);
-	SetTransformations(scaleXYZ, 0, 0, 0, positionXYZ);
-	SetShaderTexture("planksW");
-	SetShaderMaterial("planksW");
-	m_basicMeshes->DrawBoxMesh();
-
-	// floor
-	scaleXYZ = glm::vec3(40.0f, 0.3f, 40.0f);
-	positionXYZ = glm::vec3(0.0f, -5.0f, 0.0f);
-	SetTransformations(scaleXYZ, 0, 0, 0, positionXYZ);
-	SetShaderTexture("marble_floor");
-	SetShaderMaterial("marbleF");
-	m_basicMeshes->DrawBoxMesh();
-
-	// door
-	scaleXYZ = glm::vec3(9.0f, 16.0f, 0.2f);  
-	positionXYZ = glm::vec3(7.0f, 2.5f, -19.75f);  
-	SetTransformations(scaleXYZ, 0, 0, 0, positionXYZ);
-	SetShaderColor(0.3f, 0.2f, 0.1f, 1.0f);  // Dark wood
-	m_basicMeshes->DrawBoxMesh();
-
-	// ceiling
-	scaleXYZ = glm::vec3(40.0f, 0.3f, 40.0f);
-	positionXYZ = glm::vec3(0.0f, 15.0f, 0.0f);  
-	SetTransformations(scaleXYZ, 0, 0, 0, positionXYZ);
-	SetShaderTexture("ceilingT");
-	SetShaderMaterial("ceilingT");
-	m_basicMeshes->DrawBoxMesh();
-
-	/****************************************************************/
-	/***                                                          ***/
-	/***                        Clock setup                       ***/
-	/***                                                          ***/
-	/****************************************************************/
-
-	// Clock face
-	SetShaderTexture("");
-	SetShaderTexture("clockF");
-	SetShaderMaterial("clockF");
-	scaleXYZ = glm::vec3(1.0f, 0.1f, 1.0f);
-	positionXYZ = glm::vec3(6.0f, 1.0f, 2.0f); // placed on the desk
-	SetTransformations(scaleXYZ, 90.0f, 180.0f, 180.0f, positionXYZ);
-	//SetShaderColor(0.9f, 0.9f, 0.9f, 1.0f);
-	m_basicMeshes->DrawCylinderMesh();
-
-	// Clock Base
-	scaleXYZ = glm::vec3(0.4f, 1.0f, 0.4f);
-	positionXYZ = glm::vec3(6.0f, 0.3f, 1.7f);
-	SetTransformations(scaleXYZ, 0.0f, 0.0f, 0.0f, positionXYZ);
-	SetShaderColor(0.3f, 0.3f, 0.3f, 1.0f); // dark gray
-	m_basicMeshes->DrawBoxMesh();
-
-	// Clock Stand
-	glm::vec3 scaleBall = glm::vec3(0.4f); // uniform
-	glm::vec3 ballPos = glm::vec3(6.0f, 1.0f, 1.65f);  // same X, slightly lower and behind clock
-	SetTransformations(scaleBall, 90.0f, 0.0f, 0.0f, ballPos); // rotated to look like a wedge
-	SetShaderColor(0.3f, 0.3f, 0.3f, 1.0f); // match base color
-	m_basicMeshes->DrawSphereMesh();
-
-	// Hour Hand
-	scaleXYZ = glm::vec3(0.4f, 0.03f, 0.01f);  // long length
-	// Position at the center of the clock face
-	glm::vec3 hourBasePos = glm::vec3(6.0f, 1.05f, 2.008f);
-	glm::mat4 hourModel = glm::mat4(1.0f);
-	// Step 1: move to the clock center
-	hourModel = glm::translate(hourModel, hourBasePos);
-	// Step 2: rotate around Z axis to spin like a clock
-	hourModel = glm::rotate(hourModel, glm::radians(hourAngle), glm::vec3(0.0f, 0.0f, 1.0f)); // spin like clock
-	// Step 3: move hand forward along X by half its length
-	hourModel = glm::translate(hourModel, glm::vec3(scaleXYZ.x * 0.5f, 0.0f, 0.0f));           // move hand to start at center
-	// Step 4: scale to final hand shape
-	hourModel = glm::scale(hourModel, scaleXYZ);
-	m_pShaderManager->setMat4Value("model", hourModel);
-	SetShaderColor(0.2f, 0.2f, 0.2f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
-
-	// Minute Hand
-	scaleXYZ = glm::vec3(0.7f, 0.03f, 0.01f);  // medium length
-	// Position at the center of the clock face	
-	glm::mat4 minuteModel = glm::mat4(1.0f);
-	glm::vec3 minuteBasePos = glm::vec3(6.0f, 1.05f, 2.01f);
-	// Step 1: move to the clock center
-	minuteModel = glm::translate(minuteModel, minuteBasePos);
-	// Step 2: rotate around Z axis to spin like a clock
-	minuteModel = glm::rotate(minuteModel, glm::radians(minuteAngle), glm::vec3(0.0f, 0.0f, 1.0f));
-	// Step 3: move hand forward along X by half its length
-	minuteModel = glm::translate(minuteModel, glm::vec3(scaleXYZ.x * 0.5f, 0.0f, 0.0f));
-	// Step 4: scale to final hand shape
-	minuteModel = glm::scale(minuteModel, scaleXYZ);
-	// Apply to shader
-	m_pShaderManager->setMat4Value("model", minuteModel);
-	SetShaderColor(0.1f, 0.1f, 0.1f, 1.0f);  // darker gray
-	m_basicMeshes->DrawBoxMesh();
-
-	// Second Hand
-	scaleXYZ = glm::vec3(0.8f, 0.02f, 0.01f); // long along X
-	// Position at the center of the clock face
-	glm::vec3 basePos = glm::vec3(6.0f, 1.05f, 2.015f);
-	glm::mat4 model = glm::mat4(1.0f);
-	// Step 1: move to the clock center
-	model = glm::translate(model, basePos);
-	// Step 2: rotate around Z axis to spin like a clock
-	model = glm::rotate(model, glm::radians(secondAngle), glm::vec3(0.0f, 0.0f, 1.0f));
-	// Step 3: move hand forward along X by half its length
-	model = glm::translate(model, glm::vec3(scaleXYZ.x * 0.5f, 0.0f, 0.0f));
-	// Step 4: scale to final hand shape
-	model = glm::scale(model, scaleXYZ);
-	// Apply to shader
-	m_pShaderManager->setMat4Value("model", model);
-	SetShaderColor(1.0f, 0.0f, 0.0f, 1.0f);
-	m_basicMeshes->DrawBoxMesh();
+///////////////////////////////////////////////////////////////////////////////
+// scenemanager.cpp
+// ================
+// This file contains the implementation of the `SceneManager` class, which is 
+// responsible for managing the preparation and rendering of 3D scenes. It 
+// handles textures, materials, lighting configurations, and object rendering.
+//
+// AUTHOR: Brian Battersby
+// INSTITUTION: Southern New Hampshire University (SNHU)
+// COURSE: CS-330 Computational Graphics and Visualization
+//
+// INITIAL VERSION: November 1, 2023
+// LAST REVISED: December 1, 2024
+//
+// RESPONSIBILITIES:
+// - Load, bind, and manage textures in OpenGL.
+// - Define materials and lighting properties for 3D objects.
+// - Manage transformations and shader configurations.
+// - Render complex 3D scenes using basic meshes.
+//
+// NOTE: This implementation leverages external libraries like `stb_image` for 
+// texture loading and GLM for matrix and vector operations.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneManager.h"
+#include "GLRenderBackend.h"
+#include "DebugManager.h"
+#include "MemoryManager.h"
+#ifndef STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#endif
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/transform.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	const char* g_ModelName = "model";
+	const char* g_ColorValueName = "objectColor";
+	const char* g_TextureValueName = "objectTexture";
+	const char* g_UseTextureName = "bUseTexture";
+	const char* g_UseLightingName = "bUseLighting";
+	const char* g_ViewName = "view";
+	const char* g_ProjectionName = "projection";
+	const char* g_UseReflectionName = "bUseReflection";
+
+	// shader names edits give the lights by, the fill light and
+	// lamp of the rooms keep the names they had in the shader
+	const std::string g_DirectionalLightPrefix = "directionalLight.";
+	const std::string g_FillLightPrefix = "pointLights[0].";
+	const std::string g_LampLightPrefix = "spotLight.";
+
+	// distance between the centers of neighboring rooms, leaving
+	// room for the walls of both rooms between them
+	const float g_RoomSpacing = 40.5f;
+	const float g_RoomHalfSize = g_RoomSpacing / 2.0f;
+	// rooms closer than this walking distance are loaded, and
+	// rooms farther than the unload distance are released
+	const float g_RoomLoadDistance = 60.0f;
+	const float g_RoomUnloadDistance = 100.0f;
+	// number of loaded rooms moved into the scene per frame
+	const int g_RoomCommitsPerFrame = 1;
+
+	// clock hands in degrees per second, wrapping once around the
+	// dial, and ticking once a minute or once a second
+	const float g_ClockHandRates[3] = { -30.0f / 3600.0f, -0.1f, -6.0f };
+	const float g_ClockHandPeriods[3] = { 43200.0f, 3600.0f, 60.0f };
+	const float g_ClockHandSteps[3] = { 60.0f, 60.0f, 1.0f };
+	// animated objects whose spatial bounds are refreshed per frame,
+	// since rebuilding their triangles costs more than moving them
+	const int g_AnimatedBoundsPerFrame = 8;
+
+	// dust lit by the desk lamp, spawned in the cone of its
+	// spotlight from the lamp head
+	const glm::vec3 g_DustLampPosition = glm::vec3(-2.2f, 6.5f, 2.5f);
+	const glm::vec3 g_DustLampDirection = glm::vec3(-0.7f, -1.5f, 1.0f);
+	const float g_DustConeLength = 7.0f;
+	const float g_DustInnerAngle = 12.5f;
+	const float g_DustOuterAngle = 35.5f;
+	const glm::vec3 g_DustColor = glm::vec3(1.0f, 0.9f, 0.7f);
+	const float g_DustSize = 0.015f;
+	const float g_DustLifetime = 12.0f;
+	const int g_DefaultDustParticles = 16384;
+	// longest step the particles are moved in one frame
+	const float g_MaxParticleStep = 0.1f;
+
+	struct SCENE_TEXTURE_FILE
+	{
+		const char* filename;
+		const char* tag;
+	};
+
+	// texture image files of the scene, in texture slot order
+	const SCENE_TEXTURE_FILE g_SceneTextures[] =
+	{
+		{ "textures/Wood_table.png", "desk" },
+		{ "textures/lamp_body.jpg", "bronze" },
+		{ "textures/metal_head.jpg", "crome" },
+		{ "textures/rubber_holds.jpg", "rubber" },
+		{ "textures/book_cover.jpg", "cover" },
+		{ "textures/book_fabric.jpg", "fabric" },
+		{ "textures/fabric_black.jpg", "fabricB" },
+		{ "textures/clock_face.jpg", "clockF" },
+		{ "textures/ceiling.jpg", "ceilingT" },
+		{ "textures/planks.jpg", "planksW" },
+		{ "textures/marble.jpg", "marble_floor" }
+	};
+	const int g_SceneTextureCount = sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]);
+
+	struct SCENE_PATTERN
+	{
+		const char* tag;
+		ProceduralTextureManager::PATTERN pattern;
+	};
+
+	// patterns standing in for the wood and marble texture files
+	const SCENE_PATTERN g_ScenePatterns[] =
+	{
+		{ "desk", { ProceduralTextureManager::WOOD_PATTERN,
+			glm::vec3(0.62f, 0.42f, 0.24f), glm::vec3(0.36f, 0.21f, 0.11f), 2, 8, 4, 0.6f, 6, 11 } },
+		{ "planksW", { ProceduralTextureManager::WOOD_PATTERN,
+			glm::vec3(0.72f, 0.55f, 0.36f), glm::vec3(0.45f, 0.30f, 0.17f), 2, 6, 4, 0.5f, 10, 23 } },
+		{ "marble_floor", { ProceduralTextureManager::MARBLE_PATTERN,
+			glm::vec3(0.90f, 0.90f, 0.88f), glm::vec3(0.35f, 0.35f, 0.38f), 4, 4, 5, 1.5f, 2, 37 } }
+	};
+	const int g_ScenePatternCount = sizeof(g_ScenePatterns) / sizeof(g_ScenePatterns[0]);
+	const char* g_UseProceduralTextureName = "bUseProceduralTexture";
+	const int g_DefaultProceduralTextureSize = 1024;
+	// 8 bit levels a texel may change by when its texture is stored
+	// smaller, enough for the chroma noise of grey photographs but
+	// too little for 16 bit color
+	const int g_DefaultTextureFormatTolerance = 3;
+
+	// find the pattern standing in for a texture, by its index,
+	// which is also its index in the render backend, or -1 when it
+	// has none
+	int FindScenePatternIndex(const std::string& tag)
+	{
+		for (int i = 0; i < g_ScenePatternCount; i++)
+		{
+			if (tag.compare(g_ScenePatterns[i].tag) == 0)
+			{
+				return(i);
+			}
+		}
+		return(-1);
+	}
+
+	// find the pattern standing in for a texture, NULL when it has none
+	const ProceduralTextureManager::PATTERN* FindScenePattern(const std::string& tag)
+	{
+		int index = FindScenePatternIndex(tag);
+		return((index >= 0) ? &g_ScenePatterns[index].pattern : NULL);
+	}
+	// number of basic shape meshes loaded by LoadSceneMesh()
+	const int g_SceneMeshCount = 6;
+	// names of the meshes in the memory accounts, in loading order
+	const char* g_SceneMeshNames[g_SceneMeshCount] =
+	{
+		"plane", "box", "cone", "cylinder", "sphere", "tapered cylinder"
+	};
+	// page cache slots across and down for virtual textures, 15 by
+	// 15 pages of 136 texels take 16.6 MB
+	const int g_VirtualCacheSlots = 15;
+	const char* g_UseVirtualTextureName = "bUseVirtualTexture";
+
+	// textures of objects without a material are filtered between
+	// their two nearest mipmaps
+	const SamplerManager::SAMPLER_DESC g_DefaultSampler =
+		{ SamplerManager::FILTER_TRILINEAR, 1.0f, false, 0.0f };
+	// time budget that lets PrepareScene() finish in one call
+	const double g_PrepareWholeSceneBudget = 1.0e9;
+	// objects whose tag starts with one of these words followed
+	// by a space are drawn together as one occlusion assembly
+	const char* g_OcclusionAssemblies[] = { "lamp", "book", "clock" };
+	const int g_OcclusionAssemblyCount = sizeof(g_OcclusionAssemblies) / sizeof(g_OcclusionAssemblies[0]);
+
+	// world space bounds of a scene object, from the unit sized
+	// shape it is drawn with
+	SpatialManager::AABB GetObjectBounds(const SceneManager::SCENE_OBJECT& object)
+	{
+		glm::vec3 shapeMin = glm::vec3(-1.0f);
+		glm::vec3 shapeMax = glm::vec3(1.0f);
+		switch (object.mesh)
+		{
+		case SceneManager::BOX_MESH:
+			shapeMin = glm::vec3(-0.5f);
+			shapeMax = glm::vec3(0.5f);
+			break;
+		case SceneManager::PLANE_MESH:
+			shapeMin.y = 0.0f;
+			shapeMax.y = 0.0f;
+			break;
+		case SceneManager::CONE_MESH:
+		case SceneManager::CYLINDER_MESH:
+		case SceneManager::TAPERED_CYLINDER_MESH:
+			shapeMin.y = 0.0f;
+			break;
+		case SceneManager::SPHERE_MESH:
+			break;
+		}
+
+		SpatialManager::AABB bounds;
+		bounds.min = glm::vec3(FLT_MAX);
+		bounds.max = glm::vec3(-FLT_MAX);
+		for (int i = 0; i < 8; i++)
+		{
+			glm::vec3 corner = glm::vec3(
+				(i & 1) ? shapeMax.x : shapeMin.x,
+				(i & 2) ? shapeMax.y : shapeMin.y,
+				(i & 4) ? shapeMax.z : shapeMin.z);
+			corner = glm::vec3(object.model * glm::vec4(corner, 1.0f));
+			bounds.min = glm::min(bounds.min, corner);
+			bounds.max = glm::max(bounds.max, corner);
+		}
+		return(bounds);
+	}
+}
+
+/***********************************************************
+ *  SceneManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneManager::SceneManager(ShaderManager *pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+	m_pRenderBackend = new GLRenderBackend(pShaderManager, g_DefaultSampler);
+	// the patterns keep their index in the render backend
+	for (int i = 0; i < g_ScenePatternCount; i++)
+	{
+		m_pRenderBackend->CreatePattern(ProceduralTextureManager::GetBackendPattern(g_ScenePatterns[i].pattern));
+	}
+	m_basicMeshes = new ShapeMeshes();
+	m_basicMeshes->DrawPlaneMesh();
+	m_loadedTextures = 0;
+	m_pVirtualTextures = NULL;
+	m_proceduralMode = PROCEDURAL_OFF;
+	m_proceduralTextureSize = g_DefaultProceduralTextureSize;
+	m_textureFormatTolerance = g_DefaultTextureFormatTolerance;
+	m_pReflectionManager = NULL;
+	m_pLightManager = new LightManager();
+	m_lastLightTime = -1.0;
+	DefineRoomLights();
+	m_pOcclusionManager = NULL;
+	m_pProfileManager = NULL;
+	m_pSpatialManager = new SpatialManager();
+	m_pPortalManager = new PortalManager();
+	m_pAnimationManager = new AnimationManager();
+	m_nextAnimatedBounds = 0;
+	m_pParticleManager = new ParticleManager();
+	m_bParticlesInitialized = false;
+	m_dustParticlesPerLamp = g_DefaultDustParticles;
+	m_bAllowComputeParticles = true;
+	m_lastParticleTime = -1.0;
+	m_buildingWidth = 1;
+	m_buildingDepth = 1;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_cameraPosition = glm::vec3(0.0f);
+	m_bCameraViewSet = false;
+	m_nextTextureUpload = 0;
+	m_nextMeshLoad = 0;
+	m_bSceneReady = false;
+	m_objectMemoryBytes = 0;
+	m_materialMemoryBytes = 0;
+}
+
+/***********************************************************
+ *  ~SceneManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneManager::~SceneManager()
+{
+	// wait for rooms and images still being built on worker threads
+	for (ROOM& room : m_rooms)
+	{
+		if (room.pendingContents.valid())
+		{
+			room.pendingContents.wait();
+		}
+	}
+	for (std::future<TEXTURE_IMAGE>& pending : m_pendingTextures)
+	{
+		if (pending.valid())
+		{
+			TEXTURE_IMAGE image = pending.get();
+			FreeTextureImage(image);
+		}
+	}
+
+	m_pShaderManager = NULL;
+	delete m_pRenderBackend;
+	m_pRenderBackend = NULL;
+	delete m_basicMeshes;
+	m_basicMeshes = NULL;
+	delete m_pSpatialManager;
+	m_pSpatialManager = NULL;
+	delete m_pPortalManager;
+	m_pPortalManager = NULL;
+	delete m_pAnimationManager;
+	m_pAnimationManager = NULL;
+	delete m_pParticleManager;
+	m_pParticleManager = NULL;
+	delete m_pLightManager;
+	m_pLightManager = NULL;
+	if (NULL != m_pVirtualTextures)
+	{
+		delete m_pVirtualTextures;
+		m_pVirtualTextures = NULL;
+	}
+	if (NULL != m_pReflectionManager)
+	{
+		delete m_pReflectionManager;
+		m_pReflectionManager = NULL;
+	}
+	if (NULL != m_pOcclusionManager)
+	{
+		delete m_pOcclusionManager;
+		m_pOcclusionManager = NULL;
+	}
+	if (NULL != m_pProfileManager)
+	{
+		delete m_pProfileManager;
+		m_pProfileManager = NULL;
+	}
+	DestroyGLTextures();
+
+	for (GLuint buffer : m_meshBuffers)
+	{
+		MemoryManager::ReleaseBuffer(buffer);
+	}
+	MemoryManager::Release("Scene", "objects", MemoryManager::CPU_MEMORY, m_objectMemoryBytes);
+	MemoryManager::Release("Scene", "materials", MemoryManager::CPU_MEMORY, m_materialMemoryBytes);
+}
+
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for loading textures from image files,
+ *  configuring the texture mapping parameters in OpenGL,
+ *  generating the mipmaps, and loading the read texture into
+ *  the next available texture slot in memory.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+{
+	TEXTURE_IMAGE image;
+	image.filename = filename;
+	image.tag = tag;
+	image.bGenerated = false;
+	image.formatTolerance = m_textureFormatTolerance;
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	// try to parse the image data from the specified image file
+	if (DecodeTextureImage(image) == false)
+	{
+		// Error loading the image
+		return false;
+	}
+
+	return(UploadGLTexture(image));
+}
+
+/***********************************************************
+ *  DecodeTextureImage()
+ *
+ *  This method is used for reading the pixels of an image
+ *  file into memory.  It makes no OpenGL calls, so images
+ *  can be decoded on worker threads.
+ ***********************************************************/
+bool SceneManager::DecodeTextureImage(TEXTURE_IMAGE& image)
+{
+	image.width = 0;
+	image.height = 0;
+	image.colorChannels = 0;
+	image.pixels = stbi_load(
+		image.filename.c_str(),
+		&image.width,
+		&image.height,
+		&image.colorChannels,
+		0);
+
+	// if the image was successfully read from the image file
+	if (image.pixels)
+	{
+		MemoryManager::Allocate("Textures", image.filename, MemoryManager::CPU_MEMORY,
+			(size_t)image.width * image.height * image.colorChannels);
+		std::cout << "Successfully loaded image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels << std::endl;
+		ReduceTextureImage(image);
+		return true;
+	}
+
+	std::cout << "Could not load image:" << image.filename << std::endl;
+	return false;
+}
+
+/***********************************************************
+ *  UploadGLTexture()
+ *
+ *  This method is used for creating an OpenGL texture from
+ *  a decoded image.  The texture bound before the upload is
+ *  restored, so another scene can keep drawing in between.
+ ***********************************************************/
+bool SceneManager::UploadGLTexture(TEXTURE_IMAGE& image)
+{
+	GLTexture texture;
+	GLint previousTexture = 0;
+	bool bReturn = true;
+
+	if (m_loadedTextures >= 16)
+	{
+		std::cout << "No texture slot left for image:" << image.filename << std::endl;
+		FreeTextureImage(image);
+		return false;
+	}
+
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	texture.Create("Textures");
+	glBindTexture(GL_TEXTURE_2D, texture.Get());
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters, which the sampler of the
+	// material drawn with overrides
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// upload the pixels packed for the format picked, rows of one
+	// and two byte texels are not padded to four bytes
+	const TextureFormatManager::TEXTURE_LAYOUT& layout = image.layout;
+	if ((image.colorChannels >= 1) && (image.colorChannels <= 4))
+	{
+		GLint previousAlignment = 4;
+		GLint swizzle[4];
+		glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, TextureFormatManager::GetInternalFormat(layout.format),
+			layout.width, layout.height, 0, TextureFormatManager::GetPixelFormat(layout.format),
+			TextureFormatManager::GetPixelType(layout.format), image.pixels);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+
+		// grey formats are read back as RGB, so the shader
+		// samples every format the same way
+		TextureFormatManager::GetSwizzle(layout.format, swizzle);
+		glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+	}
+	else
+	{
+		std::cout << "Not implemented to handle image with " << image.colorChannels << " channels" << std::endl;
+		bReturn = false;
+	}
+
+	if (bReturn)
+	{
+		// generate the texture mipmaps for mapping textures to lower resolutions
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		// register the loaded texture and associate it with the special tag string
+		MemoryManager::TrackTexture(texture.Get(), "Textures", image.filename, layout.storedBytes);
+		m_textureIDs[m_loadedTextures].texture = std::move(texture);
+		m_textureIDs[m_loadedTextures].tag = image.tag;
+		m_loadedTextures++;
+
+		if (layout.storedBytes < layout.decodedBytes)
+		{
+			std::cout << "INFO: Texture '" << image.tag << "' stored as "
+				<< TextureFormatManager::GetFormatName(layout.format)
+				<< (layout.bConstant ? "" : (layout.bGrayscale ? ", grey" : ""))
+				<< (layout.bOpaque && !layout.bConstant ? ", opaque" : "")
+				<< ", " << (layout.storedBytes / 1024) << " KB instead of " << (layout.decodedBytes / 1024)
+				<< " KB, saving " << ((layout.decodedBytes - layout.storedBytes) / 1024)
+				<< " KB with texels changed by at most " << layout.largestChange << " levels" << std::endl;
+		}
+	}
+
+	// free the image data from local memory
+	FreeTextureImage(image);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	return(bReturn);
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots.  There are up to 16 slots.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		// bind textures on corresponding texture units
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].texture.Get());
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots, once the GPU is done with
+ *  the frames drawn with them.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	while (m_loadedTextures > 0)
+	{
+		m_loadedTextures--;
+		m_textureIDs[m_loadedTextures].texture.Reset();
+		m_textureIDs[m_loadedTextures].tag.clear();
+	}
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(std::string tag)
+{
+	int textureID = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureID = m_textureIDs[index].texture.Get();
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(std::string tag)
+{
+	int textureSlot = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureSlot = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for getting a material from the previously
+ *  defined materials list that is associated with the passed in tag.
+ ***********************************************************/
+bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+{
+	if (m_objectMaterials.size() == 0)
+	{
+		return(false);
+	}
+
+	int index = 0;
+	bool bFound = false;
+	while ((index < m_objectMaterials.size()) && (bFound == false))
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			bFound = true;
+			material.diffuseColor = m_objectMaterials[index].diffuseColor;
+			material.specularColor = m_objectMaterials[index].specularColor;
+			material.shininess = m_objectMaterials[index].shininess;
+			material.sampler = m_objectMaterials[index].sampler;
+		}
+		else
+		{
+			index++;
+		}
+	}
+
+	return(bFound);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a defined
+ *  material, which is also its index in the render backend.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(std::string tag)
+{
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  BuildTransformation()
+ *
+ *  This method is used for building the model matrix from
+ *  the passed in transformation values.
+ ***********************************************************/
+glm::mat4 SceneManager::BuildTransformation(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	// variables for this method
+	glm::mat4 modelView;
+	glm::mat4 scale;
+	glm::mat4 rotationX;
+	glm::mat4 rotationY;
+	glm::mat4 rotationZ;
+	glm::mat4 translation;
+
+	// set the scale value in the transform buffer
+	scale = glm::scale(scaleXYZ);
+	// set the rotation values in the transform buffer
+	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
+	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
+	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
+	// set the translation value in the transform buffer
+	translation = glm::translate(positionXYZ);
+
+	modelView = translation * rotationZ * rotationY * rotationX * scale;
+
+	return(modelView);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transform buffer
+ *  using the passed in transformation values.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	glm::mat4 modelView = BuildTransformation(
+		scaleXYZ,
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees,
+		positionXYZ);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+	}
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  into the shader for the next draw command
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	// variables for this method
+	glm::vec4 currentColor;
+
+	currentColor.r = redColorValue;
+	currentColor.g = greenColorValue;
+	currentColor.b = blueColorValue;
+	currentColor.a = alphaValue;
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue(g_UseTextureName, false);
+		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+	}
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	std::string textureTag)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setIntValue(g_UseTextureName, true);
+
+		int textureID = -1;
+		textureID = FindTextureSlot(textureTag);
+		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+	}
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values into the shader.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+	}
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values
+ *  into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	std::string materialTag)
+{
+	if (m_objectMaterials.size() > 0)
+	{
+		OBJECT_MATERIAL material;
+		bool bReturn = false;
+
+		bReturn = FindMaterial(materialTag, material);
+		if (bReturn == true)
+		{
+			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
+			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
+			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+		}
+	}
+}
+
+/***********************************************************
+ *  MakeTexturedObject()
+ *
+ *  This method is used for describing an object that is
+ *  drawn with a texture and material.
+ ***********************************************************/
+SceneManager::SCENE_OBJECT SceneManager::MakeTexturedObject(
+	std::string tag,
+	MESH_TYPE mesh,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	std::string textureTag,
+	std::string materialTag,
+	glm::vec2 UVscale,
+	bool bCollidable)
+{
+	SCENE_OBJECT object;
+	object.tag = tag;
+	object.mesh = mesh;
+	object.model = BuildTransformation(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	object.bUseTexture = true;
+	object.textureTag = textureTag;
+	object.materialTag = materialTag;
+	object.color = glm::vec4(1.0f);
+	object.UVscale = UVscale;
+	object.bCollidable = bCollidable;
+	object.spatialID = -1;
+	object.room = -1;
+	object.bActive = true;
+	object.bMirror = false;
+	object.assembly = -1;
+	object.materialIndex = -1;
+	object.textureSource = RenderBackend::TEXTURE_UNIT;
+	object.texture = -1;
+
+	return(object);
+}
+
+/***********************************************************
+ *  MakeColoredObject()
+ *
+ *  This method is used for describing an object that is
+ *  drawn with a solid color and material.
+ ***********************************************************/
+SceneManager::SCENE_OBJECT SceneManager::MakeColoredObject(
+	std::string tag,
+	MESH_TYPE mesh,
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ,
+	glm::vec4 color,
+	std::string materialTag,
+	bool bCollidable)
+{
+	SCENE_OBJECT object;
+	object.tag = tag;
+	object.mesh = mesh;
+	object.model = BuildTransformation(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
+	object.bUseTexture = false;
+	object.materialTag = materialTag;
+	object.color = color;
+	object.UVscale = glm::vec2(1.0f, 1.0f);
+	object.bCollidable = bCollidable;
+	object.spatialID = -1;
+	object.room = -1;
+	object.bActive = true;
+	object.bMirror = false;
+	object.assembly = -1;
+	object.materialIndex = -1;
+	object.textureSource = RenderBackend::TEXTURE_UNIT;
+	object.texture = -1;
+
+	return(object);
+}
+
+/***********************************************************
+ *  AddSceneObject()
+ *
+ *  This method is used for adding an object to the scene
+ *  and registering its triangles with the spatial query
+ *  tree.  Slots left by unloaded rooms are reused.
+ *  Returns the index of the object.
+ ***********************************************************/
+int SceneManager::AddSceneObject(
+	const SCENE_OBJECT& object,
+	const std::vector<SpatialManager::TRIANGLE>& triangles)
+{
+	int objectIndex = -1;
+
+	if (m_freeObjects.empty() == false)
+	{
+		objectIndex = m_freeObjects.back();
+		m_freeObjects.pop_back();
+		m_sceneObjects[objectIndex] = object;
+	}
+	else
+	{
+		objectIndex = (int)m_sceneObjects.size();
+		m_sceneObjects.push_back(object);
+	}
+
+	m_sceneObjects[objectIndex].bActive = true;
+	ResolveObjectIndices(m_sceneObjects[objectIndex]);
+	m_sceneObjects[objectIndex].spatialID = m_pSpatialManager->AddObject(
+		object.tag,
+		objectIndex,
+		triangles,
+		object.bCollidable);
+
+	return(objectIndex);
+}
+
+/***********************************************************
+ *  RemoveSceneObject()
+ *
+ *  This method is used for removing an object from the
+ *  scene and the spatial query tree.
+ ***********************************************************/
+void SceneManager::RemoveSceneObject(int objectIndex)
+{
+	if (objectIndex < 0 || objectIndex >= (int)m_sceneObjects.size() ||
+		m_sceneObjects[objectIndex].bActive == false)
+	{
+		return;
+	}
+
+	m_pSpatialManager->RemoveObject(m_sceneObjects[objectIndex].spatialID);
+	m_sceneObjects[objectIndex].spatialID = -1;
+	m_sceneObjects[objectIndex].bActive = false;
+	m_freeObjects.push_back(objectIndex);
+}
+
+/***********************************************************
+ *  ResolveObjectIndices()
+ *
+ *  This method is used for finding the material of an
+ *  object, and where its texture is drawn from, by their
+ *  tags, once when it is added or edited rather than at
+ *  every draw.  Wood and marble drawn by the shader come
+ *  first, then virtual textures, then the loaded textures.
+ ***********************************************************/
+void SceneManager::ResolveObjectIndices(SCENE_OBJECT& object)
+{
+	object.materialIndex = FindMaterialIndex(object.materialTag);
+	object.textureSource = RenderBackend::TEXTURE_UNIT;
+	object.texture = -1;
+	if (object.bUseTexture == false)
+	{
+		return;
+	}
+
+	if (m_proceduralMode == PROCEDURAL_SHADER)
+	{
+		int pattern = FindScenePatternIndex(object.textureTag);
+		if (pattern >= 0)
+		{
+			object.textureSource = RenderBackend::TEXTURE_PATTERN;
+			object.texture = pattern;
+			return;
+		}
+	}
+	if (NULL != m_pVirtualTextures)
+	{
+		int virtualTexture = m_pVirtualTextures->FindTexture(object.textureTag);
+		if (virtualTexture >= 0)
+		{
+			object.textureSource = RenderBackend::TEXTURE_VIRTUAL;
+			object.texture = virtualTexture;
+			return;
+		}
+	}
+	object.texture = FindTextureSlot(object.textureTag);
+}
+
+/***********************************************************
+ *  SetObjectModel()
+ *
+ *  This method is used for moving a scene object and
+ *  updating its triangles in the spatial query tree.
+ ***********************************************************/
+void SceneManager::SetObjectModel(int objectIndex, const glm::mat4& model)
+{
+	if (objectIndex < 0 || objectIndex >= (int)m_sceneObjects.size())
+	{
+		return;
+	}
+
+	SCENE_OBJECT& object = m_sceneObjects[objectIndex];
+	object.model = model;
+
+	std::vector<SpatialManager::TRIANGLE> triangles;
+	BuildObjectTriangles(object, triangles);
+	m_pSpatialManager->UpdateObject(object.spatialID, triangles);
+
+	if (object.assembly >= 0)
+	{
+		UpdateAssemblyBounds(object.room, object.assembly);
+	}
+}
+
+/***********************************************************
+ *  UpdateAssemblyBounds()
+ *
+ *  This method is used for fitting the occlusion box of an
+ *  assembly around the objects of a room drawn with it.
+ ***********************************************************/
+void SceneManager::UpdateAssemblyBounds(int roomIndex, int assembly)
+{
+	if ((NULL == m_pOcclusionManager) || (roomIndex < 0) || (roomIndex >= (int)m_rooms.size()))
+	{
+		return;
+	}
+
+	SpatialManager::AABB bounds;
+	bounds.min = glm::vec3(FLT_MAX);
+	bounds.max = glm::vec3(-FLT_MAX);
+	bool bAnyObject = false;
+	for (int objectIndex : m_rooms[roomIndex].objects)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[objectIndex];
+		if (object.bActive && (object.assembly == assembly))
+		{
+			SpatialManager::AABB objectBounds = GetObjectBounds(object);
+			bounds.min = glm::min(bounds.min, objectBounds.min);
+			bounds.max = glm::max(bounds.max, objectBounds.max);
+			bAnyObject = true;
+		}
+	}
+
+	if (bAnyObject)
+	{
+		m_pOcclusionManager->SetAssemblyBounds(assembly, bounds);
+	}
+}
+
+/***********************************************************
+ *  BuildObjectTriangles()
+ *
+ *  This method is used for building the world space
+ *  triangles of a scene object.  The shapes match the unit
+ *  sized meshes drawn by the basic shapes object, with the
+ *  round shapes tessellated for collision purposes.
+ ***********************************************************/
+void SceneManager::BuildObjectTriangles(
+	const SCENE_OBJECT& object,
+	std::vector<SpatialManager::TRIANGLE>& triangles)
+{
+	const int slices = 24;
+	const int stacks = 12;
+	// profile of round shapes as (radius, height) pairs
+	std::vector<glm::vec2> profile;
+	bool bBottomCap = false;
+	bool bTopCap = false;
+
+	triangles.clear();
+
+	switch (object.mesh)
+	{
+	case BOX_MESH:
+	{
+		glm::vec3 corners[8];
+		for (int i = 0; i < 8; i++)
+		{
+			corners[i] = glm::vec3(
+				(i & 1) ? 0.5f : -0.5f,
+				(i & 2) ? 0.5f : -0.5f,
+				(i & 4) ? 0.5f : -0.5f);
+		}
+		const int faces[6][4] = {
+			{ 0, 2, 3, 1 }, { 4, 5, 7, 6 },
+			{ 0, 1, 5, 4 }, { 2, 6, 7, 3 },
+			{ 0, 4, 6, 2 }, { 1, 3, 7, 5 } };
+		for (int f = 0; f < 6; f++)
+		{
+			triangles.push_back({ corners[faces[f][0]], corners[faces[f][1]], corners[faces[f][2]] });
+			triangles.push_back({ corners[faces[f][0]], corners[faces[f][2]], corners[faces[f][3]] });
+		}
+		break;
+	}
+	case PLANE_MESH:
+		triangles.push_back({ glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, 1.0f) });
+		triangles.push_back({ glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 0.0f, 1.0f), glm::vec3(-1.0f, 0.0f, 1.0f) });
+		break;
+	case CYLINDER_MESH:
+		profile = { glm::vec2(1.0f, 0.0f), glm::vec2(1.0f, 1.0f) };
+		bBottomCap = bTopCap = true;
+		break;
+	case TAPERED_CYLINDER_MESH:
+		profile = { glm::vec2(1.0f, 0.0f), glm::vec2(0.5f, 1.0f) };
+		bBottomCap = bTopCap = true;
+		break;
+	case CONE_MESH:
+		profile = { glm::vec2(1.0f, 0.0f), glm::vec2(0.0f, 1.0f) };
+		bBottomCap = true;
+		break;
+	case SPHERE_MESH:
+		for (int i = 0; i <= stacks; i++)
+		{
+			float angle = glm::radians(180.0f * (float)i / (float)stacks);
+			profile.push_back(glm::vec2(sinf(angle), -cosf(angle)));
+		}
+		break;
+	}
+
+	// sweep the profile of round shapes around the Y axis
+	for (int j = 0; j < slices; j++)
+	{
+		float angle0 = glm::radians(360.0f * (float)j / (float)slices);
+		float angle1 = glm::radians(360.0f * (float)(j + 1) / (float)slices);
+		glm::vec3 direction0 = glm::vec3(cosf(angle0), 0.0f, sinf(angle0));
+		glm::vec3 direction1 = glm::vec3(cosf(angle1), 0.0f, sinf(angle1));
+
+		for (int i = 0; i + 1 < (int)profile.size(); i++)
+		{
+			glm::vec3 a = direction0 * profile[i].x + glm::vec3(0.0f, profile[i].y, 0.0f);
+			glm::vec3 b = direction1 * profile[i].x + glm::vec3(0.0f, profile[i].y, 0.0f);
+			glm::vec3 c = direction1 * profile[i + 1].x + glm::vec3(0.0f, profile[i + 1].y, 0.0f);
+			glm::vec3 d = direction0 * profile[i + 1].x + glm::vec3(0.0f, profile[i + 1].y, 0.0f);
+			triangles.push_back({ a, b, c });
+			triangles.push_back({ a, c, d });
+		}
+		if (bBottomCap)
+		{
+			glm::vec2 bottom = profile.front();
+			glm::vec3 center = glm::vec3(0.0f, bottom.y, 0.0f);
+			triangles.push_back({ center, direction1 * bottom.x + center, direction0 * bottom.x + center });
+		}
+		if (bTopCap)
+		{
+			glm::vec2 top = profile.back();
+			glm::vec3 center = glm::vec3(0.0f, top.y, 0.0f);
+			triangles.push_back({ center, direction0 * top.x + center, direction1 * top.x + center });
+		}
+	}
+
+	// move the triangles into world space
+	for (SpatialManager::TRIANGLE& triangle : triangles)
+	{
+		triangle.v0 = glm::vec3(object.model * glm::vec4(triangle.v0, 1.0f));
+		triangle.v1 = glm::vec3(object.model * glm::vec4(triangle.v1, 1.0f));
+		triangle.v2 = glm::vec3(object.model * glm::vec4(triangle.v2, 1.0f));
+	}
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing one of the basic shapes.
+ ***********************************************************/
+void SceneManager::DrawMesh(MESH_TYPE mesh)
+{
+	switch (mesh)
+	{
+	case BOX_MESH:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case CONE_MESH:
+		m_basicMeshes->DrawConeMesh();
+		break;
+	case CYLINDER_MESH:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case PLANE_MESH:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case SPHERE_MESH:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	case TAPERED_CYLINDER_MESH:
+		m_basicMeshes->DrawTaperedCylinderMesh();
+		break;
+	}
+}
+
+/***********************************************************
+ *  DrawSceneObject()
+ *
+ *  This method is used for setting the transformation,
+ *  texture or color, and material of a scene object into
+ *  the shader and drawing its mesh.
+ ***********************************************************/
+void SceneManager::DrawSceneObject(const SCENE_OBJECT& object)
+{
+	DEBUG_SCOPE(object.tag.c_str());
+
+	RenderBackend::DRAW_DATA draw;
+	draw.model = object.model;
+	draw.color = object.color;
+	draw.UVscale = object.UVscale;
+	draw.bUseTexture = object.bUseTexture;
+	draw.textureSource = object.textureSource;
+	draw.texture = object.texture;
+	draw.material = object.materialIndex;
+	// mirror objects show the reflection drawn before the rooms
+	draw.bReflect = object.bMirror && (NULL != m_pReflectionManager) && m_pReflectionManager->IsReady();
+	m_pRenderBackend->SetDrawData(draw);
+
+	DrawMesh(object.mesh);
+}
+
+/***********************************************************
+ *  DrawProfiledObject()
+ *
+ *  This method is used for drawing an object of the scene
+ *  pass, inside a timer query when the profile manager
+ *  times it this frame.
+ ***********************************************************/
+void SceneManager::DrawProfiledObject(const SCENE_OBJECT& object)
+{
+	if (NULL == m_pProfileManager)
+	{
+		DrawSceneObject(object);
+		return;
+	}
+
+	int sample = m_pProfileManager->BeginDraw(object.tag, object.materialTag);
+	DrawSceneObject(object);
+	m_pProfileManager->EndDraw(sample);
+}
+
+/***********************************************************
+ *  GetSpatialManager()
+ *
+ *  This method is used for getting the spatial query tree
+ *  built over the scene objects.
+ ***********************************************************/
+SpatialManager* SceneManager::GetSpatialManager()
+{
+	return(m_pSpatialManager);
+}
+
+/***********************************************************
+ *  FindRoomObject()
+ *
+ *  This method is used for finding an object of a loaded
+ *  room by its tag.  Returns the object index, or -1 when
+ *  the room is not loaded or has no such object.
+ ***********************************************************/
+int SceneManager::FindRoomObject(int roomIndex, const std::string& tag)
+{
+	if ((roomIndex < 0) || (roomIndex >= (int)m_rooms.size()) || (m_rooms[roomIndex].state != ROOM_LOADED))
+	{
+		return(-1);
+	}
+
+	for (int objectIndex : m_rooms[roomIndex].objects)
+	{
+		if (m_sceneObjects[objectIndex].tag.compare(tag) == 0)
+		{
+			return(objectIndex);
+		}
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  ApplySceneEdit()
+ *
+ *  This method is used for applying a live edit between
+ *  frames.  Only the edited object and its node in the
+ *  spatial query tree, the edited material, or the edited
+ *  light value are touched.  Returns false with the reason
+ *  when the edit cannot be applied.
+ ***********************************************************/
+bool SceneManager::ApplySceneEdit(const SCENE_EDIT& edit, std::string& error)
+{
+	DEBUG_SCOPE("SceneEdit");
+
+	bool bApplied = false;
+	switch (edit.type)
+	{
+	case EDIT_ADD_OBJECT:
+	case EDIT_REMOVE_OBJECT:
+	case EDIT_MODIFY_OBJECT:
+		bApplied = ApplyObjectEdit(edit, error);
+		break;
+	case EDIT_SET_MATERIAL:
+		ApplyMaterialEdit(edit);
+		bApplied = true;
+		break;
+	case EDIT_SET_LIGHT:
+	{
+		if (!ApplyLightEdit(edit, error))
+		{
+			break;
+		}
+		// the light values are set again whenever the scene is
+		// activated, so the edit is kept to be set over them
+		bool bReplaced = false;
+		for (SCENE_EDIT& lightEdit : m_lightEdits)
+		{
+			if (lightEdit.tag.compare(edit.tag) == 0)
+			{
+				lightEdit = edit;
+				bReplaced = true;
+			}
+		}
+		if (!bReplaced)
+		{
+			m_lightEdits.push_back(edit);
+		}
+		bApplied = true;
+		break;
+	}
+	}
+
+	// the floor reflects the edited scene
+	if (bApplied && (NULL != m_pReflectionManager))
+	{
+		m_pReflectionManager->Invalidate();
+	}
+	return(bApplied);
+}
+
+/***********************************************************
+ *  ApplyObjectEdit()
+ *
+ *  This method is used for adding, removing or changing an
+ *  object of a loaded room.  Moving an object refits its
+ *  node in the spatial query tree, and other changes only
+ *  change the values it is drawn with.
+ ***********************************************************/
+bool SceneManager::ApplyObjectEdit(const SCENE_EDIT& edit, std::string& error)
+{
+	if ((edit.room < 0) || (edit.room >= (int)m_rooms.size()) || (m_rooms[edit.room].state != ROOM_LOADED))
+	{
+		error = "room " + std::to_string(edit.room) + " is not loaded";
+		return(false);
+	}
+
+	ROOM& room = m_rooms[edit.room];
+	int objectIndex = FindRoomObject(edit.room, edit.tag);
+	if ((edit.type == EDIT_ADD_OBJECT) && (objectIndex >= 0))
+	{
+		error = "room " + std::to_string(edit.room) + " already has an object '" + edit.tag + "'";
+		return(false);
+	}
+	if ((edit.type != EDIT_ADD_OBJECT) && (objectIndex < 0))
+	{
+		error = "room " + std::to_string(edit.room) + " has no object '" + edit.tag + "'";
+		return(false);
+	}
+	if ((edit.fields & EDIT_FIELD_MATERIAL) && (FindMaterialIndex(edit.materialTag) < 0))
+	{
+		error = "no material '" + edit.materialTag + "'";
+		return(false);
+	}
+	if ((edit.fields & EDIT_FIELD_TEXTURE) && (FindTextureSlot(edit.textureTag) < 0) &&
+		!((NULL != m_pVirtualTextures) && (m_pVirtualTextures->FindTexture(edit.textureTag) >= 0)) &&
+		!((m_proceduralMode == PROCEDURAL_SHADER) && (NULL != FindScenePattern(edit.textureTag))))
+	{
+		error = "no texture '" + edit.textureTag + "'";
+		return(false);
+	}
+
+	// animated objects are moved by their animation every frame
+	int animatedIndex = -1;
+	for (int i = 0; i < (int)m_animatedObjects.size(); i++)
+	{
+		if (m_animatedObjects[i].objectIndex == objectIndex)
+		{
+			animatedIndex = i;
+		}
+	}
+	if ((edit.type == EDIT_MODIFY_OBJECT) && (edit.fields & EDIT_FIELD_TRANSFORM) && (animatedIndex >= 0))
+	{
+		error = "object '" + edit.tag + "' is moved by its animation";
+		return(false);
+	}
+
+	if (edit.type == EDIT_ADD_OBJECT)
+	{
+		SCENE_OBJECT object;
+		if (edit.fields & EDIT_FIELD_TEXTURE)
+		{
+			object = MakeTexturedObject(edit.tag, edit.mesh, edit.scaleXYZ,
+				edit.rotationXYZ.x, edit.rotationXYZ.y, edit.rotationXYZ.z, edit.positionXYZ,
+				edit.textureTag, edit.materialTag, edit.UVscale);
+		}
+		else
+		{
+			object = MakeColoredObject(edit.tag, edit.mesh, edit.scaleXYZ,
+				edit.rotationXYZ.x, edit.rotationXYZ.y, edit.rotationXYZ.z, edit.positionXYZ,
+				edit.color, edit.materialTag);
+		}
+		object.room = edit.room;
+
+		std::vector<SpatialManager::TRIANGLE> triangles;
+		BuildObjectTriangles(object, triangles);
+		room.objects.push_back(AddSceneObject(object, triangles));
+		UpdateMemoryAccounts();
+	}
+	else if (edit.type == EDIT_REMOVE_OBJECT)
+	{
+		if (animatedIndex >= 0)
+		{
+			m_pAnimationManager->RemoveTransform(m_animatedObjects[animatedIndex].transform);
+			m_pAnimationManager->RemoveChannel(m_animatedObjects[animatedIndex].channel);
+			m_animatedObjects.erase(m_animatedObjects.begin() + animatedIndex);
+		}
+		int assembly = m_sceneObjects[objectIndex].assembly;
+		RemoveSceneObject(objectIndex);
+		room.objects.erase(std::find(room.objects.begin(), room.objects.end(), objectIndex));
+		if (assembly >= 0)
+		{
+			UpdateAssemblyBounds(edit.room, assembly);
+		}
+	}
+	else
+	{
+		SCENE_OBJECT& object = m_sceneObjects[objectIndex];
+		if (edit.fields & EDIT_FIELD_COLOR)
+		{
+			object.color = edit.color;
+			object.bUseTexture = false;
+		}
+		if (edit.fields & EDIT_FIELD_TEXTURE)
+		{
+			object.textureTag = edit.textureTag;
+			object.UVscale = edit.UVscale;
+			object.bUseTexture = true;
+		}
+		if (edit.fields & EDIT_FIELD_MATERIAL)
+		{
+			object.materialTag = edit.materialTag;
+		}
+		if (edit.fields & (EDIT_FIELD_COLOR | EDIT_FIELD_TEXTURE | EDIT_FIELD_MATERIAL))
+		{
+			ResolveObjectIndices(object);
+		}
+		if (edit.fields & EDIT_FIELD_TRANSFORM)
+		{
+			SetObjectModel(objectIndex, BuildTransformation(edit.scaleXYZ,
+				edit.rotationXYZ.x, edit.rotationXYZ.y, edit.rotationXYZ.z, edit.positionXYZ));
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ApplyMaterialEdit()
+ *
+ *  This method is used for changing the values of a
+ *  material, or defining a new one.  The render backend
+ *  writes the values again at the next draw using it.
+ ***********************************************************/
+void SceneManager::ApplyMaterialEdit(const SCENE_EDIT& edit)
+{
+	RenderBackend::MATERIAL backendMaterial;
+	backendMaterial.diffuseColor = edit.diffuseColor;
+	backendMaterial.specularColor = edit.specularColor;
+	backendMaterial.shininess = edit.shininess;
+
+	int index = FindMaterialIndex(edit.tag);
+	if (index >= 0)
+	{
+		m_objectMaterials[index].diffuseColor = edit.diffuseColor;
+		m_objectMaterials[index].specularColor = edit.specularColor;
+		m_objectMaterials[index].shininess = edit.shininess;
+		backendMaterial.sampler = m_objectMaterials[index].sampler;
+		m_pRenderBackend->UpdateMaterial(index, backendMaterial);
+	}
+	else
+	{
+		OBJECT_MATERIAL material;
+		material.tag = edit.tag;
+		material.diffuseColor = edit.diffuseColor;
+		material.specularColor = edit.specularColor;
+		material.shininess = edit.shininess;
+		material.sampler = g_DefaultSampler;
+		m_objectMaterials.push_back(material);
+		backendMaterial.sampler = material.sampler;
+		index = m_pRenderBackend->CreateMaterial(backendMaterial);
+		UpdateMemoryAccounts();
+
+		// objects named the material before it was defined
+		for (SCENE_OBJECT& object : m_sceneObjects)
+		{
+			if (object.bActive && (object.materialIndex < 0) && (object.materialTag.compare(edit.tag) == 0))
+			{
+				object.materialIndex = index;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ApplyLightEdit()
+ *
+ *  This method is used for setting an edited light value.
+ *  The directional light is set into the shader, and the
+ *  fill light and lamp are changed in every room.  Returns
+ *  false with the reason for a light the rooms do not have.
+ ***********************************************************/
+bool SceneManager::ApplyLightEdit(const SCENE_EDIT& edit, std::string& error)
+{
+	if (edit.tag.compare(0, g_DirectionalLightPrefix.size(), g_DirectionalLightPrefix) == 0)
+	{
+		switch (edit.lightType)
+		{
+		case LIGHT_BOOL:
+			m_pShaderManager->setBoolValue(edit.tag, edit.lightValue.x != 0.0f);
+			break;
+		case LIGHT_FLOAT:
+			m_pShaderManager->setFloatValue(edit.tag, edit.lightValue.x);
+			break;
+		case LIGHT_VEC3:
+			m_pShaderManager->setVec3Value(edit.tag, edit.lightValue);
+			break;
+		}
+		return(true);
+	}
+
+	LightManager::LIGHT_SOURCE* pLight = NULL;
+	std::string name;
+	if (edit.tag.compare(0, g_FillLightPrefix.size(), g_FillLightPrefix) == 0)
+	{
+		pLight = &m_roomFillLight;
+		name = edit.tag.substr(g_FillLightPrefix.size());
+	}
+	else if (edit.tag.compare(0, g_LampLightPrefix.size(), g_LampLightPrefix) == 0)
+	{
+		pLight = &m_roomLampLight;
+		name = edit.tag.substr(g_LampLightPrefix.size());
+	}
+
+	if ((NULL == pLight) || !LightManager::SetLightValue(*pLight, name, edit.lightValue))
+	{
+		error = "'" + edit.tag + "' is not a light value of the rooms";
+		return(false);
+	}
+	UpdateRoomLights();
+	return(true);
+}
+
+/***********************************************************
+ *  UpdateRoomLights()
+ *
+ *  This method is used for setting the fill light and lamp
+ *  values into the lights of every loaded room.
+ ***********************************************************/
+void SceneManager::UpdateRoomLights()
+{
+	for (const ROOM& room : m_rooms)
+	{
+		LightManager::LIGHT_SOURCE light = m_roomFillLight;
+		light.position += room.origin;
+		m_pLightManager->SetLight(room.fillLight, light);
+
+		light = m_roomLampLight;
+		light.position += room.origin;
+		m_pLightManager->SetLight(room.lampLight, light);
+	}
+}
+
+/***********************************************************
+ *  UpdateLights()
+ *
+ *  This method is used for choosing the room lights shaded
+ *  for the camera view, moving their fades by the animation
+ *  time passed, and setting them into the shader.  The
+ *  reflection is drawn again while the lighting changes.
+ ***********************************************************/
+void SceneManager::UpdateLights()
+{
+	DEBUG_SCOPE("Lights");
+
+	double time = m_pAnimationManager->GetTime();
+	float deltaSeconds = (m_lastLightTime < 0.0) ? 0.0f : (float)(time - m_lastLightTime);
+	m_lastLightTime = time;
+
+	bool bChanged = m_pLightManager->Update(m_projection * m_view, m_cameraPosition, m_bCameraViewSet, deltaSeconds);
+	m_pLightManager->Apply(m_pShaderManager);
+	if (bChanged && (NULL != m_pReflectionManager))
+	{
+		m_pReflectionManager->Invalidate();
+	}
+}
+
+/**************************************************************/
+/*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
+/*** preparing and rendering their own 3D replicated scenes.***/
+/*** Please refer to the code in the OpenGL sample project  ***/
+/*** for assistance.                                        ***/
+/**************************************************************/
+
+void SceneManager::LoadSceneTextures()
+{
+	bool bReturn = false;
+
+	std::cout << "[DEBUG] Calling CreateGLTexture()..." << std::endl;
+	for (int i = 0; i < g_SceneTextureCount; i++)
+	{
+		bReturn = CreateGLTexture(
+			g_SceneTextures[i].filename,
+			g_SceneTextures[i].tag);
+		if (!bReturn) {
+			std::cout << "Failed to load '" << g_SceneTextures[i].tag << "' texture!" << std::endl;
+		}
+	}
+	BindGLTextures();
+}
+void SceneManager::SetupSceneLights()
+{
+	// allows the shader to use lighting
+	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	// sets the position of the camera
+	m_pShaderManager->setVec3Value("viewPosition", glm::vec3(0.0f, -10.0f, 10.0f));
+
+	// Enable the directional light
+	m_pShaderManager->setBoolValue("directionalLight.bActive", true);
+
+	// sets the directional light color and direction
+	m_pShaderManager->setVec3Value("directionalLight.direction", glm::vec3(-0.3f, -1.0f, -0.3));
+	// sets the color of the light
+	m_pShaderManager->setVec3Value("directionalLight.ambient", glm::vec3(0.2f)); // Dim ambient light
+	// sets the main color of the light
+	m_pShaderManager->setVec3Value("directionalLight.diffuse", glm::vec3(0.6f));
+	// bright highlights
+	m_pShaderManager->setVec3Value("directionalLight.specular", glm::vec3(1.0f)); //shiny spot
+
+	// the point and spot lights of the rooms are chosen for each
+	// frame by the light manager, which sets them all again
+	m_pLightManager->Invalidate();
+}
+/***********************************************************
+ *  DefineRoomLights()
+ *
+ *  This method is used for defining the fill light and the
+ *  lamp every room has, placed within the room.
+ ***********************************************************/
+void SceneManager::DefineRoomLights()
+{
+	// bluish fill light in the back corner of the room
+	m_roomFillLight.type = LightManager::LIGHT_POINT;
+	m_roomFillLight.bEnabled = true;
+	m_roomFillLight.position = glm::vec3(-5.0f, 6.5f, -5.0f);
+	m_roomFillLight.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+	m_roomFillLight.cutOff = -1.0f;
+	m_roomFillLight.outerCutOff = -1.0f;
+	m_roomFillLight.ambient = glm::vec3(0.05f, 0.05f, 0.5f);
+	m_roomFillLight.diffuse = glm::vec3(0.2f, 0.2f, 0.2f);
+	m_roomFillLight.specular = glm::vec3(0.4f, 0.3f, 0.3f);
+	// falls off gently over the room, and is gone a room away
+	m_roomFillLight.constant = 1.0f;
+	m_roomFillLight.linear = 0.045f;
+	m_roomFillLight.quadratic = 0.0075f;
+
+	// Turn on spotlight
+	m_roomLampLight.type = LightManager::LIGHT_SPOT;
+	m_roomLampLight.bEnabled = true;
+
+	// light at the tip of lamp head
+	m_roomLampLight.position = glm::vec3(-2.2f, 6.5f, 2.5f);
+
+	// Pointed in the direction lamp head is facing
+	m_roomLampLight.direction = glm::vec3(-0.7f, -1.5f, 1.0f);
+
+	// Spotlight cutoff
+	m_roomLampLight.cutOff = glm::cos(glm::radians(12.5f));
+	m_roomLampLight.outerCutOff = glm::cos(glm::radians(35.5f));
+
+	// Light color values
+	m_roomLampLight.ambient = glm::vec3(0.001f);
+	m_roomLampLight.diffuse = glm::vec3(4.0f, 4.4f, 4.0f);   // warm light
+	m_roomLampLight.specular = glm::vec3(3.0f);
+
+	// controls how far the light goes
+	m_roomLampLight.constant = 1.0f;
+	m_roomLampLight.linear = 0.09f;
+	m_roomLampLight.quadratic = 0.032f;
+}
+/***********************************************************
+ *  DefineObjectMaterials()
+ *
+ *  This method is used for configuring the various material
+ *  settings for all of the objects within the 3D scene.
+ ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	// define the materials for objects in the scene
+	SceneManager::OBJECT_MATERIAL material;
+
+	// Desk
+	material.tag = "desk";
+	material.diffuseColor = glm::vec3(0.8f, 0.5f, 0.2f);
+	material.specularColor = glm::vec3(0.5f);
+	material.shininess = 32.0f;
+	// the desk top is mostly seen at an angle
+	material.sampler = SamplerManager::MakeDesc(SamplerManager::FILTER_TRILINEAR, 4.0f);
+	m_objectMaterials.push_back(material);
+	// Lamp
+	material.tag = "lamp";
+	material.diffuseColor = glm::vec3(0.8f);
+	material.specularColor = glm::vec3(0.5f);
+	material.shininess = 64.0f;
+	material.sampler = g_DefaultSampler;
+	m_objectMaterials.push_back(material);
+	// Lamp Head
+	material.tag = "lamp_head";
+	material.diffuseColor = glm::vec3(0.5f);
+	material.specularColor = glm::vec3(0.8f);
+	material.shininess = 32.0f;
+	material.sampler = g_DefaultSampler;
+	m_objectMaterials.push_back(material);
+	// Lamp Base
+	material.tag = "lamp_base";
+	material.diffuseColor = glm::vec3(0.7f);
+	material.specularColor = glm::vec3(0.4f);
+	material.shininess = 16.0f;
+	material.sampler = g_DefaultSampler;
+	m_objectMaterials.push_back(material);
+	// hinges
+	material.tag = "rubber";
+	material.diffuseColor = glm::vec3(0.6f);
+	material.specularColor = glm::vec3(0.3f);
+	material.shininess = 16.0f;
+	material.sampler = g_DefaultSampler;
+	m_objectMaterials.push_back(material);
+	// book cover
+	material.tag = "cover";
+	material.diffuseColor = glm::vec3(0.5f);              
+	material.specularColor = glm::vec3(0.1f, 0.1f, 0.2f);   // low reflection
+	material.shininess = 1.0f;                             
+	material.sampler = g_DefaultSampler;
+	m_objectMaterials.push_back(material);
+	//book fabric
+	material.tag = "fabric";
+	material.diffuseColor = glm::vec3(0.5f);
+	material.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);   // low reflection
+	material.shininess = 1.0f;                             
+	material.sampler = g_DefaultSampler;
+	m_objectMaterials.push_back(material);
+
+	material.tag = "fabricB";
+	material.diffuseColor = glm::vec3(1.0f);
+	material.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);   // low reflection
+	material.shininess = 0.4f;                             // wide, soft highlight
+	material.sampler = g_DefaultSampler;
+	m_objectMaterials.push_back(material);
+	// clock face
+	material.tag = "clockF";
+	material.diffuseColor = glm::vec3(1.0f);
+	material.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);   // low reflection
+	material.shininess = 0.4f;                             // wide, soft highlight
+	// the face is drawn once, so its edge does not wrap
+	material.sampler = SamplerManager::MakeDesc(SamplerManager::FILTER_TRILINEAR, 1.0f, true);
+	m_objectMaterials.push_back(material);
+	// floor
+	material.tag = "marbleF";
+	material.diffuseColor = glm::vec3(0.8f, 0.5f, 0.2f);
+	material.specularColor = glm::vec3(1.0f);
+	material.shininess = 64.0f;
+	// the floor and walls run away from the camera at shallow
+	// angles, where plain mipmapping blurs them
+	material.sampler = SamplerManager::MakeDesc(SamplerManager::FILTER_TRILINEAR, 16.0f);
+	m_objectMaterials.push_back(material);
+	// walls
+	material.tag = "planksW";
+	material.diffuseColor = glm::vec3(0.8f, 0.5f, 0.2f);
+	material.specularColor = glm::vec3(0.5f);
+	material.shininess = 0.5f;
+	material.sampler = SamplerManager::MakeDesc(SamplerManager::FILTER_TRILINEAR, 8.0f);
+	m_objectMaterials.push_back(material);
+	// ceiling
+	material.tag = "ceilingT";
+	material.diffuseColor = glm::vec3(0.8f, 0.5f, 0.2f);
+	material.specularColor = glm::vec3(0.5f);
+	material.shininess = 5.0f;
+	material.sampler = SamplerManager::MakeDesc(SamplerManager::FILTER_TRILINEAR, 8.0f);
+	m_objectMaterials.push_back(material);
+
+	// the render backend keeps the materials by the same index
+	for (const OBJECT_MATERIAL& objectMaterial : m_objectMaterials)
+	{
+		RenderBackend::MATERIAL backendMaterial;
+		backendMaterial.diffuseColor = objectMaterial.diffuseColor;
+		backendMaterial.specularColor = objectMaterial.specularColor;
+		backendMaterial.shininess = objectMaterial.shininess;
+		backendMaterial.sampler = objectMaterial.sampler;
+		m_pRenderBackend->CreateMaterial(backendMaterial);
+	}
+}
+
+/***********************************************************
+ *  LoadSceneMesh()
+ *
+ *  This method is used for loading one of the basic shape
+ *  meshes into OpenGL memory.  Only one instance of a mesh
+ *  is needed no matter how many times it is drawn.
+ ***********************************************************/
+void SceneManager::LoadSceneMesh(int meshIndex)
+{
+	switch (meshIndex)
+	{
+	case 0:
+		m_basicMeshes->LoadPlaneMesh();
+		break;
+	case 1:
+		m_basicMeshes->LoadBoxMesh();
+		break;
+	case 2:
+		m_basicMeshes->LoadConeMesh();
+		break;
+	case 3:
+		m_basicMeshes->LoadCylinderMesh();
+		break;
+	case 4:
+		m_basicMeshes->LoadSphereMesh();
+		break;
+	case 5:
+		m_basicMeshes->LoadTaperedCylinderMesh();
+		break;
+	}
+
+	TrackMeshMemory(g_SceneMeshNames[meshIndex]);
+}
+
+/***********************************************************
+ *  TrackMeshMemory()
+ *
+ *  This method is used for charging the buffers of a mesh
+ *  just loaded to the memory accounts.  ShapeMeshes leaves
+ *  the vertex array of the mesh bound, so the buffers are
+ *  found through it.
+ ***********************************************************/
+void SceneManager::TrackMeshMemory(const char* meshName)
+{
+	GLint vertexArray = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArray);
+	if (vertexArray == 0)
+	{
+		return;
+	}
+
+	GLint buffers[2] = { 0, 0 };
+	glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffers[0]);
+	glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &buffers[1]);
+	for (int i = 0; i < 2; i++)
+	{
+		GLuint buffer = (GLuint)buffers[i];
+		if ((buffer == 0) ||
+			(std::find(m_meshBuffers.begin(), m_meshBuffers.end(), buffer) != m_meshBuffers.end()))
+		{
+			continue;
+		}
+
+		GLint size = 0;
+		glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+		glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+		MemoryManager::TrackBuffer(buffer, "Meshes", meshName, (size_t)size);
+		m_meshBuffers.push_back(buffer);
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+/***********************************************************
+ *  UpdateMemoryAccounts()
+ *
+ *  This method is used for charging the scene object and
+ *  material arrays to the memory accounts at their current
+ *  size.
+ ***********************************************************/
+void SceneManager::UpdateMemoryAccounts()
+{
+	size_t objectMemoryBytes = m_sceneObjects.capacity() * sizeof(SCENE_OBJECT);
+	size_t materialMemoryBytes = m_objectMaterials.capacity() * sizeof(OBJECT_MATERIAL);
+
+	MemoryManager::Release("Scene", "objects", MemoryManager::CPU_MEMORY, m_objectMemoryBytes);
+	MemoryManager::Allocate("Scene", "objects", MemoryManager::CPU_MEMORY, objectMemoryBytes);
+	MemoryManager::Release("Scene", "materials", MemoryManager::CPU_MEMORY, m_materialMemoryBytes);
+	MemoryManager::Allocate("Scene", "materials", MemoryManager::CPU_MEMORY, materialMemoryBytes);
+	m_objectMemoryBytes = objectMemoryBytes;
+	m_materialMemoryBytes = materialMemoryBytes;
+}
+
+/***********************************************************
+ *  FreeTextureImage()
+ *
+ *  This method is used for freeing the pixels of a decoded
+ *  image and returning them to the memory accounts.
+ ***********************************************************/
+void SceneManager::FreeTextureImage(TEXTURE_IMAGE& image)
+{
+	if (image.pixels != NULL)
+	{
+		MemoryManager::Release("Textures", image.filename, MemoryManager::CPU_MEMORY,
+			(size_t)image.width * image.height * image.colorChannels);
+		if (image.bGenerated)
+		{
+			delete[] image.pixels;
+		}
+		else
+		{
+			stbi_image_free(image.pixels);
+		}
+		image.pixels = NULL;
+	}
+}
+
+/***********************************************************
+ *  ReduceTextureImage()
+ *
+ *  This method is used for picking the smallest format that
+ *  holds the pixels of an image within its tolerance, and
+ *  packing them for it.  It makes no OpenGL calls, so it
+ *  runs on the decoding threads.
+ ***********************************************************/
+void SceneManager::ReduceTextureImage(TEXTURE_IMAGE& image)
+{
+	image.layout = TextureFormatManager::Reduce(
+		image.pixels,
+		image.width,
+		image.height,
+		image.colorChannels,
+		image.formatTolerance);
+}
+
+/***********************************************************
+ *  PrepareScene()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void SceneManager::PrepareScene()
+{
+	// prepare the whole scene before returning, still decoding
+	// the texture files in parallel
+	BeginPrepareScene();
+	while (ContinuePrepareScene(g_PrepareWholeSceneBudget) == false)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ActivateScene();
+}
+
+/***********************************************************
+ *  BeginPrepareScene()
+ *
+ *  This method is used for starting the preparation of the
+ *  scene.  Texture files are decoded and the first room is
+ *  built on worker threads, while the OpenGL work is left
+ *  to ContinuePrepareScene() on the rendering thread.
+ ***********************************************************/
+void SceneManager::BeginPrepareScene()
+{
+	m_bSceneReady = false;
+	m_nextMeshLoad = 0;
+	m_nextTextureUpload = 0;
+
+	// materials and the room layout need no OpenGL calls
+	DefineObjectMaterials();
+	DefineBuilding();
+	UpdateMemoryAccounts();
+
+	// the flip setting is shared by all threads, so it is set
+	// here before any decoding starts
+	stbi_set_flip_vertically_on_load(true);
+	m_pendingTextures.clear();
+	bool bVirtualTextures = (NULL != m_pVirtualTextures);
+	for (int i = 0; i < g_SceneTextureCount; i++)
+	{
+		TEXTURE_IMAGE image;
+		image.filename = g_SceneTextures[i].filename;
+		image.tag = g_SceneTextures[i].tag;
+		image.pixels = NULL;
+		image.bGenerated = false;
+		image.formatTolerance = m_textureFormatTolerance;
+
+		const ProceduralTextureManager::PATTERN* pPattern =
+			(m_proceduralMode == PROCEDURAL_OFF) ? NULL : FindScenePattern(image.tag);
+		if ((NULL != pPattern) && (m_proceduralMode == PROCEDURAL_SHADER))
+		{
+			continue;
+		}
+		if (NULL != pPattern)
+		{
+			// baked patterns read no file, and are not worth cutting
+			// into pages since they are made at the size asked for
+			ProceduralTextureManager::PATTERN pattern = *pPattern;
+			int textureSize = m_proceduralTextureSize;
+			image.filename = std::string("procedural ") + image.tag;
+			m_pendingTextures.push_back(std::async(std::launch::async, [image, pattern, textureSize]() mutable
+				{
+					image.width = textureSize;
+					image.height = textureSize;
+					image.colorChannels = 4;
+					image.pixels = new unsigned char[(size_t)textureSize * textureSize * 4];
+					image.bGenerated = true;
+					MemoryManager::Allocate("Textures", image.filename, MemoryManager::CPU_MEMORY,
+						(size_t)textureSize * textureSize * 4);
+					ProceduralTextureManager::Generate(pattern, textureSize, textureSize, image.pixels);
+					ReduceTextureImage(image);
+					return(image);
+				}));
+			continue;
+		}
+
+		m_pendingTextures.push_back(std::async(std::launch::async, [image, bVirtualTextures]() mutable
+			{
+				// virtual textures are cut into pages once, and read
+				// a page at a time while the scene is drawn
+				if (bVirtualTextures)
+				{
+					std::string tiledFilename = VirtualTextureManager::GetTiledFilename(image.filename);
+					if (VirtualTextureManager::BuildTiledFile(image.filename, tiledFilename))
+					{
+						image.tiledFilename = tiledFilename;
+					}
+				}
+				else
+				{
+					DecodeTextureImage(image);
+				}
+				return(image);
+			}));
+	}
+
+	// the first room is needed before the scene can be shown,
+	// the other rooms are streamed in once it is active
+	ROOM& room = m_rooms[0];
+	room.state = ROOM_LOADING;
+	room.pendingContents = std::async(std::launch::async, &SceneManager::BuildRoomContents, this, 0);
+}
+
+/***********************************************************
+ *  ContinuePrepareScene()
+ *
+ *  This method is used for doing the OpenGL part of the
+ *  scene preparation, a step at a time, until the passed
+ *  time budget is used up.  At least one step is done per
+ *  call.  Returns true once the scene is ready to be shown.
+ ***********************************************************/
+bool SceneManager::ContinuePrepareScene(double budgetMilliseconds)
+{
+	DEBUG_SCOPE("PrepareScene");
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	bool bWaiting = false;
+
+	while ((m_bSceneReady == false) && (bWaiting == false))
+	{
+		if (m_nextMeshLoad < g_SceneMeshCount)
+		{
+			LoadSceneMesh(m_nextMeshLoad);
+			m_nextMeshLoad++;
+		}
+		else if (m_bParticlesInitialized == false)
+		{
+			// without the particle shaders the scene is drawn without dust
+			if (m_pParticleManager->Initialize(m_bAllowComputeParticles) == false)
+			{
+				std::cout << "Could not prepare the particle shaders, dust is not drawn" << std::endl;
+			}
+			m_bParticlesInitialized = true;
+		}
+		else if ((NULL != m_pReflectionManager) && (m_pReflectionManager->IsInitialized() == false))
+		{
+			m_pReflectionManager->Initialize();
+		}
+		else if ((NULL != m_pOcclusionManager) && (m_pOcclusionManager->IsInitialized() == false))
+		{
+			// without the box program every object is drawn
+			if (m_pOcclusionManager->Initialize() == false)
+			{
+				std::cout << "Could not prepare the occlusion queries, every object is drawn" << std::endl;
+				delete m_pOcclusionManager;
+				m_pOcclusionManager = NULL;
+			}
+		}
+		else if ((NULL != m_pProfileManager) && (m_pProfileManager->IsInitialized() == false))
+		{
+			m_pProfileManager->Initialize();
+		}
+		else if ((NULL != m_pVirtualTextures) && (m_pVirtualTextures->IsInitialized() == false))
+		{
+			// without the page cache the images are decoded whole
+			if (m_pVirtualTextures->Initialize(g_VirtualCacheSlots) == false)
+			{
+				std::cout << "Could not create the virtual texture cache, textures are loaded whole" << std::endl;
+				delete m_pVirtualTextures;
+				m_pVirtualTextures = NULL;
+			}
+		}
+		else if (m_nextTextureUpload < (int)m_pendingTextures.size())
+		{
+			// textures are uploaded in order, so they keep their slots
+			std::future<TEXTURE_IMAGE>& pending = m_pendingTextures[m_nextTextureUpload];
+			if (pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				bWaiting = true;
+			}
+			else
+			{
+				TEXTURE_IMAGE image = pending.get();
+				bool bLoaded = false;
+				if (!image.tiledFilename.empty() && (NULL != m_pVirtualTextures))
+				{
+					// the render backend keeps the virtual textures by
+					// the same index
+					int virtualTexture = m_pVirtualTextures->AddTexture(image.tiledFilename, image.tag);
+					RenderBackend::VIRTUAL_TEXTURE backendTexture;
+					if ((virtualTexture >= 0) && m_pVirtualTextures->GetBackendTexture(virtualTexture, backendTexture))
+					{
+						m_pRenderBackend->CreateVirtualTexture(backendTexture);
+						bLoaded = true;
+					}
+				}
+				else
+				{
+					if (!image.tiledFilename.empty())
+					{
+						DecodeTextureImage(image);
+					}
+					bLoaded = (image.pixels != NULL) && UploadGLTexture(image);
+				}
+				if (bLoaded == false)
+				{
+					std::cout << "Failed to load '" << image.tag << "' texture!" << std::endl;
+				}
+				m_nextTextureUpload++;
+			}
+		}
+		else if (m_rooms[0].state == ROOM_LOADING)
+		{
+			if (m_rooms[0].pendingContents.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				bWaiting = true;
+			}
+			else
+			{
+				ROOM_CONTENTS contents = m_rooms[0].pendingContents.get();
+				CommitRoomContents(0, contents);
+			}
+		}
+		else
+		{
+			m_pendingTextures.clear();
+			m_bSceneReady = true;
+			int virtualTextures = (NULL != m_pVirtualTextures) ? m_pVirtualTextures->GetTextureCount() : 0;
+			std::cout << "INFO: Scene prepared with " << m_loadedTextures + virtualTextures << " textures and "
+				<< m_rooms.size() << " rooms" << std::endl;
+		}
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		if (elapsed.count() >= budgetMilliseconds)
+		{
+			break;
+		}
+	}
+
+	return(m_bSceneReady);
+}
+
+/***********************************************************
+ *  ActivateScene()
+ *
+ *  This method is used for making this scene the one that
+ *  is drawn.  The shader and the texture slots are shared by
+ *  all scenes, so the lights and textures are set again.
+ ***********************************************************/
+void SceneManager::ActivateScene()
+{
+	m_pRenderBackend->BeginPass();
+	SetupSceneLights();
+	std::string error;
+	for (const SCENE_EDIT& lightEdit : m_lightEdits)
+	{
+		ApplyLightEdit(lightEdit, error);
+	}
+	BindGLTextures();
+	if (NULL != m_pVirtualTextures)
+	{
+		m_pVirtualTextures->BindCache(m_pShaderManager);
+	}
+	else
+	{
+		m_pShaderManager->setBoolValue(g_UseVirtualTextureName, false);
+	}
+	m_pShaderManager->setBoolValue(g_UseProceduralTextureName, false);
+	m_pShaderManager->setBoolValue(g_UseReflectionName, false);
+	if (NULL != m_pReflectionManager)
+	{
+		m_pReflectionManager->Invalidate();
+	}
+}
+
+/***********************************************************
+ *  ReleaseScene()
+ *
+ *  This method is used for freeing the resources of a scene
+ *  that is no longer drawn, a room or a texture at a time,
+ *  until the passed time budget is used up.  Returns true
+ *  once the scene can be deleted without a pause.
+ ***********************************************************/
+bool SceneManager::ReleaseScene(double budgetMilliseconds)
+{
+	DEBUG_SCOPE("ReleaseScene");
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	// work still running on worker threads must finish first,
+	// and is checked without waiting for it
+	for (int i = m_nextTextureUpload; i < (int)m_pendingTextures.size(); i++)
+	{
+		if (m_pendingTextures[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			return(false);
+		}
+	}
+	for (ROOM& room : m_rooms)
+	{
+		if ((room.state == ROOM_LOADING) &&
+			(room.pendingContents.wait_for(std::chrono::seconds(0)) != std::future_status::ready))
+		{
+			return(false);
+		}
+	}
+	for (int i = m_nextTextureUpload; i < (int)m_pendingTextures.size(); i++)
+	{
+		TEXTURE_IMAGE image = m_pendingTextures[i].get();
+		FreeTextureImage(image);
+	}
+	m_pendingTextures.clear();
+	m_nextTextureUpload = 0;
+	for (ROOM& room : m_rooms)
+	{
+		if (room.state == ROOM_LOADING)
+		{
+			room.pendingContents.get();
+			room.state = ROOM_UNLOADED;
+		}
+	}
+
+	bool bReleased = false;
+	while (bReleased == false)
+	{
+		int roomIndex = 0;
+		while ((roomIndex < (int)m_rooms.size()) && (m_rooms[roomIndex].state != ROOM_LOADED))
+		{
+			roomIndex++;
+		}
+
+		if (roomIndex < (int)m_rooms.size())
+		{
+			UnloadRoom(roomIndex);
+		}
+		else if (m_loadedTextures > 0)
+		{
+			m_loadedTextures--;
+			m_textureIDs[m_loadedTextures].texture.Reset();
+		}
+		else if ((NULL != m_pVirtualTextures) && m_pVirtualTextures->IsInitialized())
+		{
+			m_pVirtualTextures->Release();
+		}
+		else if ((NULL != m_pReflectionManager) && m_pReflectionManager->IsInitialized())
+		{
+			m_pReflectionManager->Release();
+		}
+		else if ((NULL != m_pOcclusionManager) && m_pOcclusionManager->IsInitialized())
+		{
+			m_pOcclusionManager->Release();
+		}
+		else if ((NULL != m_pProfileManager) && m_pProfileManager->IsInitialized())
+		{
+			// prints the objects ranked by their cost
+			m_pProfileManager->Release();
+		}
+		else
+		{
+			bReleased = true;
+		}
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		if (elapsed.count() >= budgetMilliseconds)
+		{
+			break;
+		}
+	}
+
+	return(bReleased);
+}
+
+/***********************************************************
+ *  AddWallObjects()
+ *
+ *  This method is used for adding a wall to a room.  When
+ *  the wall has a doorway, it is built from the pieces on
+ *  either side of the opening and the lintel above it.
+ ***********************************************************/
+void SceneManager::AddWallObjects(
+	ROOM_CONTENTS& contents,
+	std::string tag,
+	glm::vec3 wallMin,
+	glm::vec3 wallMax,
+	bool bDoorway,
+	glm::vec3 openingMin,
+	glm::vec3 openingMax)
+{
+	std::vector<glm::vec3> pieceMins;
+	std::vector<glm::vec3> pieceMaxs;
+
+	if (bDoorway == false)
+	{
+		pieceMins.push_back(wallMin);
+		pieceMaxs.push_back(wallMax);
+	}
+	else
+	{
+		// the opening runs along the longer side of the wall
+		int axis = ((wallMax.x - wallMin.x) > (wallMax.z - wallMin.z)) ? 0 : 2;
+		glm::vec3 pieceMin = wallMin;
+		glm::vec3 pieceMax = wallMax;
+
+		// beside the opening
+		pieceMax[axis] = openingMin[axis];
+		pieceMins.push_back(pieceMin);
+		pieceMaxs.push_back(pieceMax);
+
+		pieceMin = wallMin;
+		pieceMax = wallMax;
+		pieceMin[axis] = openingMax[axis];
+		pieceMins.push_back(pieceMin);
+		pieceMaxs.push_back(pieceMax);
+
+		// above the opening
+		pieceMin = wallMin;
+		pieceMax = wallMax;
+		pieceMin[axis] = openingMin[axis];
+		pieceMax[axis] = openingMax[axis];
+		pieceMin.y = openingMax.y;
+		pieceMins.push_back(pieceMin);
+		pieceMaxs.push_back(pieceMax);
+	}
+
+	for (int i = 0; i < (int)pieceMins.size(); i++)
+	{
+		contents.objects.push_back(MakeTexturedObject(tag, BOX_MESH,
+			pieceMaxs[i] - pieceMins[i], 0.0f, 0.0f, 0.0f, (pieceMins[i] + pieceMaxs[i]) * 0.5f,
+			"planksW", "planksW", glm::vec2(1.0f, 1.0f)));
+	}
+}
+
+/***********************************************************
+ *  DefineBuilding()
+ *
+ *  This method is used for laying out the rooms of the
+ *  building in a grid.  Rooms join their neighbors through
+ *  a doorway at the door in the back wall and through
+ *  openings in the side walls.  Each room is a cell of the
+ *  portal graph, with cells created in room order.
+ ***********************************************************/
+void SceneManager::DefineBuilding()
+{
+	m_rooms.clear();
+	m_pPortalManager->Clear();
+	m_rooms.resize(m_buildingWidth * m_buildingDepth);
+
+	for (int j = 0; j < m_buildingDepth; j++)
+	{
+		for (int i = 0; i < m_buildingWidth; i++)
+		{
+			int roomIndex = j * m_buildingWidth + i;
+			ROOM& room = m_rooms[roomIndex];
+
+			// the building grows to the right and away from the
+			// camera, so the first room stays where it always was
+			room.origin = glm::vec3(i * g_RoomSpacing, 0.0f, -j * g_RoomSpacing);
+			room.bNorthDoorway = (j + 1 < m_buildingDepth);
+			room.bWestDoorway = (i > 0);
+			room.bEastDoorway = (i + 1 < m_buildingWidth);
+			room.state = ROOM_UNLOADED;
+			room.dustEmitter = -1;
+			room.fillLight = -1;
+			room.lampLight = -1;
+
+			SpatialManager::AABB bounds;
+			bounds.min = room.origin + glm::vec3(-g_RoomHalfSize, -5.15f, -g_RoomHalfSize);
+			bounds.max = room.origin + glm::vec3(g_RoomHalfSize, 15.15f, g_RoomHalfSize);
+			room.cell = m_pPortalManager->AddCell(bounds);
+		}
+	}
+
+	for (int roomIndex = 0; roomIndex < (int)m_rooms.size(); roomIndex++)
+	{
+		const ROOM& room = m_rooms[roomIndex];
+		glm::vec3 corners[4];
+
+		// doorway where the door stands in the back wall
+		if (room.bNorthDoorway)
+		{
+			float z = room.origin.z - 20.0f;
+			corners[0] = glm::vec3(room.origin.x + 2.5f, -5.0f, z);
+			corners[1] = glm::vec3(room.origin.x + 11.5f, -5.0f, z);
+			corners[2] = glm::vec3(room.origin.x + 11.5f, 10.5f, z);
+			corners[3] = glm::vec3(room.origin.x + 2.5f, 10.5f, z);
+			m_pPortalManager->AddPortal(room.cell, m_rooms[roomIndex + m_buildingWidth].cell, corners);
+		}
+		// opening through the right wall
+		if (room.bEastDoorway)
+		{
+			float x = room.origin.x + g_RoomHalfSize;
+			corners[0] = glm::vec3(x, -5.0f, room.origin.z - 11.5f);
+			corners[1] = glm::vec3(x, -5.0f, room.origin.z - 2.5f);
+			corners[2] = glm::vec3(x, 10.5f, room.origin.z - 2.5f);
+			corners[3] = glm::vec3(x, 10.5f, room.origin.z - 11.5f);
+			m_pPortalManager->AddPortal(room.cell, m_rooms[roomIndex + 1].cell, corners);
+		}
+	}
+
+	std::cout << "INFO: Building has " << m_rooms.size() << " rooms joined by "
+		<< m_pPortalManager->GetPortalCount() << " portals" << std::endl;
+}
+
+/***********************************************************
+ *  BuildRoomContents()
+ *
+ *  This method is used for describing the objects of one
+ *  room, in the order they are drawn, along with their
+ *  triangles.  It only reads the room layout, so it can run
+ *  on a worker thread while the scene keeps rendering.
+ ***********************************************************/
+SceneManager::ROOM_CONTENTS SceneManager::BuildRoomContents(int roomIndex)
+{
+	const ROOM& room = m_rooms[roomIndex];
+	const glm::vec3 origin = room.origin;
+	ROOM_CONTENTS contents;
+
+	/****************************************************************/
+	/***                                                          ***/
+	/***                        Desk setup                        ***/
+	/***                                                          ***/
+	/****************************************************************/
+
+	// desk top, with the texture tiled 4x4
+	contents.objects.push_back(MakeTexturedObject("desk top", BOX_MESH,
+		glm::vec3(25.0f, 0.5f, 12.0f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(0.0f, -0.3f, 2.0f),
+		"desk", "desk", glm::vec2(4.0f, 4.0f)));
+	// desk part 2
+	contents.objects.push_back(MakeTexturedObject("desk base", BOX_MESH,
+		glm::vec3(20.0f, 0.3f, 11.0f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(0.0f, -0.3f, 2.0f),
+		"desk", "desk", glm::vec2(4.0f, 4.0f)));
+
+	glm::vec3 legScale = glm::vec3(0.5f, 5.0f, 0.5f);  // thin, tall leg
+	float deskHeight = -0.3f;
+	float legOffsetX = 9.0f;
+	float legOffsetZ = 3.5f;
+	float legY = deskHeight - (legScale.y / 2.1f);
+	glm::vec4 legColor = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);  // dark metal or wood
+
+	// desk legs
+	contents.objects.push_back(MakeColoredObject("desk leg front left", BOX_MESH, legScale, 0.0f, 0.0f, 0.0f,
+		origin + glm::vec3(-legOffsetX, legY, legOffsetZ), legColor, "desk"));
+	contents.objects.push_back(MakeColoredObject("desk leg front right", BOX_MESH, legScale, 0.0f, 0.0f, 0.0f,
+		origin + glm::vec3(legOffsetX, legY, legOffsetZ), legColor, "desk"));
+	contents.objects.push_back(MakeColoredObject("desk leg back left", BOX_MESH, legScale, 0.0f, 0.0f, 0.0f,
+		origin + glm::vec3(-legOffsetX, legY, -legOffsetZ), legColor, "desk"));
+	contents.objects.push_back(MakeColoredObject("desk leg back right", BOX_MESH, legScale, 0.0f, 0.0f, 0.0f,
+		origin + glm::vec3(legOffsetX, legY, -legOffsetZ), legColor, "desk"));
+
+	/****************************************************************/
+	/***                                                          ***/
+	/***                        Lamp setup                        ***/
+	/***                                                          ***/
+	/****************************************************************/
+
+	// lamp base, wide and flat
+	contents.objects.push_back(MakeTexturedObject("lamp base", CYLINDER_MESH,
+		glm::vec3(2.5f, 0.8f, 2.5f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(0.0f, 0.05f, 0.0f),
+		"bronze", "lamp_base", glm::vec2(4.0f, 4.0f)));
+	// bottom vertical stand, on top of the base
+	contents.objects.push_back(MakeTexturedObject("lamp bottom stand", CYLINDER_MESH,
+		glm::vec3(0.3f, 6.6f, 0.3f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(0.0f, 0.7f, 0.0f),
+		"bronze", "lamp", glm::vec2(4.0f, 4.0f)));
+	// top vertical stand, on top of the bottom hinge
+	contents.objects.push_back(MakeTexturedObject("lamp top stand", CYLINDER_MESH,
+		glm::vec3(0.3f, 2.0f, 0.3f), 75.0f, -45.0f, 0.0f, origin + glm::vec3(0.0f, 7.5f, 0.0f),
+		"bronze", "lamp", glm::vec2(4.0f, 4.0f)));
+	// bottom hinge
+	contents.objects.push_back(MakeTexturedObject("lamp bottom hinge", SPHERE_MESH,
+		glm::vec3(0.5f, 0.5f, 0.5f), 0.0f, 45.0f, 0.0f, origin + glm::vec3(0.0f, 7.5f, 0.0f),
+		"rubber", "rubber", glm::vec2(4.0f, 4.0f)));
+	// top hinge
+	contents.objects.push_back(MakeTexturedObject("lamp top hinge", SPHERE_MESH,
+		glm::vec3(0.5f, 0.5f, 0.5f), 0.0f, 45.0f, 0.0f, origin + glm::vec3(-1.5f, 8.1f, 1.5f),
+		"rubber", "rubber", glm::vec2(4.0f, 4.0f)));
+	// lamp head, tilted out and to the side
+	contents.objects.push_back(MakeTexturedObject("lamp head", CONE_MESH,
+		glm::vec3(1.5f, 2.0f, 1.5f), 35.0f, 145.0f, 0.0f, origin + glm::vec3(-2.2f, 6.5f, 2.5f),
+		"crome", "lamp_head", glm::vec2(4.0f, 4.0f)));
+
+	/****************************************************************/
+	/***                                                          ***/
+	/***                        Book setup                        ***/
+	/***                                                          ***/
+	/****************************************************************/
+
+	glm::vec4 coverColor = glm::vec4(0.1f, 0.1f, 0.1f, 1.0f);
+
+	// bottom cover
+	contents.objects.push_back(MakeColoredObject("book bottom cover", BOX_MESH,
+		glm::vec3(4.7f, 0.2f, 3.8f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(-3.0f, 0.1f, 6.0f),
+		coverColor, "fabricB"));
+	// book pages, cream paper
+	for (int i = 0; i < 8; ++i)
+	{
+		contents.objects.push_back(MakeColoredObject("book page", BOX_MESH,
+			glm::vec3(4.65f, 0.04f, 3.7f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(-3.03f, 0.21f + i * 0.045f, 6.0f),
+			glm::vec4(1.0f, 1.0f, 0.9f, 1.0f), "fabricB"));
+	}
+	// top cover, slightly higher
+	contents.objects.push_back(MakeColoredObject("book top cover", BOX_MESH,
+		glm::vec3(4.7f, 0.2f, 3.8f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(-3.0f, 0.64f, 6.0f),
+		coverColor, "fabricB"));
+	// page crease strip along the left edge, same height as the pages
+	contents.objects.push_back(MakeColoredObject("book crease", BOX_MESH,
+		glm::vec3(0.2f, 0.74f, 3.8f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(-5.45f, 0.370f, 6.0f),
+		coverColor, "fabricB"));
+	// cover photo
+	contents.objects.push_back(MakeTexturedObject("book cover photo", PLANE_MESH,
+		glm::vec3(1.90f, 0.01f, 2.35f), 0.0f, 90.0f, 0.0f, origin + glm::vec3(-3.0f, 0.742f, 6.0f),
+		"cover", "fabricB", glm::vec2(1.0f, 1.0f), false));
+
+	/****************************************************************/
+	/***                                                          ***/
+	/***                        Room                              ***/
+	/***                                                          ***/
+	/****************************************************************/
+
+	// doorways through the walls to the neighboring rooms
+	AddWallObjects(contents, "back wall",
+		origin + glm::vec3(-20.0f, -5.0f, -20.25f), origin + glm::vec3(20.0f, 15.0f, -19.75f),
+		room.bNorthDoorway,
+		origin + glm::vec3(2.5f, -5.0f, -20.25f), origin + glm::vec3(11.5f, 10.5f, -19.75f));
+	AddWallObjects(contents, "left wall",
+		origin + glm::vec3(-20.25f, -5.0f, -20.0f), origin + glm::vec3(-19.75f, 15.0f, 20.0f),
+		room.bWestDoorway,
+		origin + glm::vec3(-20.25f, -5.0f, -11.5f), origin + glm::vec3(-19.75f, 10.5f, -2.5f));
+	AddWallObjects(contents, "right wall",
+		origin + glm::vec3(19.75f, -5.0f, -20.0f), origin + glm::vec3(20.25f, 15.0f, 20.0f),
+		room.bEastDoorway,
+		origin + glm::vec3(19.75f, -5.0f, -11.5f), origin + glm::vec3(20.25f, 10.5f, -2.5f));
+
+	// rooms of a larger building meet without a gap under the doorways
+	float floorSize = (m_rooms.size() > 1) ? g_RoomSpacing : 40.0f;
+	SCENE_OBJECT floor = MakeTexturedObject("floor", BOX_MESH,
+		glm::vec3(floorSize, 0.3f, floorSize), 0.0f, 0.0f, 0.0f, origin + glm::vec3(0.0f, -5.0f, 0.0f),
+		"marble_floor", "marbleF", glm::vec2(1.0f, 1.0f));
+	// the polished marble reflects the room
+	floor.bMirror = true;
+	contents.objects.push_back(floor);
+	// door, dark wood, swung open when it leads to another room
+	if (room.bNorthDoorway)
+	{
+		contents.objects.push_back(MakeColoredObject("door", BOX_MESH,
+			glm::vec3(9.0f, 16.0f, 0.2f), 0.0f, 90.0f, 0.0f, origin + glm::vec3(11.4f, 2.5f, -15.25f),
+			glm::vec4(0.3f, 0.2f, 0.1f, 1.0f), "marbleF"));
+	}
+	else
+	{
+		contents.objects.push_back(MakeColoredObject("door", BOX_MESH,
+			glm::vec3(9.0f, 16.0f, 0.2f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(7.0f, 2.5f, -19.75f),
+			glm::vec4(0.3f, 0.2f, 0.1f, 1.0f), "marbleF"));
+	}
+	contents.objects.push_back(MakeTexturedObject("ceiling", BOX_MESH,
+		glm::vec3(floorSize, 0.3f, floorSize), 0.0f, 0.0f, 0.0f, origin + glm::vec3(0.0f, 15.0f, 0.0f),
+		"ceilingT", "ceilingT", glm::vec2(1.0f, 1.0f)));
+
+	/****************************************************************/
+	/***                                                          ***/
+	/***                        Clock setup                       ***/
+	/***                                                          ***/
+	/****************************************************************/
+
+	glm::vec4 clockColor = glm::vec4(0.3f, 0.3f, 0.3f, 1.0f);  // dark gray
+
+	// clock face, placed on the desk
+	contents.objects.push_back(MakeTexturedObject("clock face", CYLINDER_MESH,
+		glm::vec3(1.0f, 0.1f, 1.0f), 90.0f, 180.0f, 180.0f, origin + glm::vec3(6.0f, 1.0f, 2.0f),
+		"clockF", "clockF", glm::vec2(1.0f, 1.0f)));
+	// clock base
+	contents.objects.push_back(MakeColoredObject("clock base", BOX_MESH,
+		glm::vec3(0.4f, 1.0f, 0.4f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(6.0f, 0.3f, 1.7f),
+		clockColor, "clockF"));
+	// clock stand, rotated to look like a wedge behind the clock
+	contents.objects.push_back(MakeColoredObject("clock stand", SPHERE_MESH,
+		glm::vec3(0.4f), 90.0f, 0.0f, 0.0f, origin + glm::vec3(6.0f, 1.0f, 1.65f),
+		clockColor, "clockF"));
+
+	// clock hands, moved to the current time every frame
+	contents.clockHands[0] = (int)contents.objects.size();
+	contents.objects.push_back(MakeColoredObject("clock hour hand", BOX_MESH,
+		glm::vec3(0.4f, 0.03f, 0.01f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(6.0f, 1.05f, 2.008f),
+		glm::vec4(0.2f, 0.2f, 0.2f, 1.0f), "clockF", false));
+	contents.clockHands[1] = (int)contents.objects.size();
+	contents.objects.push_back(MakeColoredObject("clock minute hand", BOX_MESH,
+		glm::vec3(0.7f, 0.03f, 0.01f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(6.0f, 1.05f, 2.01f),
+		glm::vec4(0.1f, 0.1f, 0.1f, 1.0f), "clockF", false));  // darker gray
+	contents.clockHands[2] = (int)contents.objects.size();
+	contents.objects.push_back(MakeColoredObject("clock second hand", BOX_MESH,
+		glm::vec3(0.8f, 0.02f, 0.01f), 0.0f, 0.0f, 0.0f, origin + glm::vec3(6.0f, 1.05f, 2.015f),
+		glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), "clockF", false));
+
+	// build the collision and picking triangles here as well,
+	// since this is the costly part of loading a room
+	contents.triangles.resize(contents.objects.size());
+	for (int i = 0; i < (int)contents.objects.size(); i++)
+	{
+		contents.objects[i].room = roomIndex;
+		BuildObjectTriangles(contents.objects[i], contents.triangles[i]);
+	}
+
+	return(contents);
+}
+
+/***********************************************************
+ *  CommitRoomContents()
+ *
+ *  This method is used for moving the built objects of a
+ *  room into the scene and the spatial query tree.
+ ***********************************************************/
+void SceneManager::CommitRoomContents(int roomIndex, ROOM_CONTENTS& contents)
+{
+	ROOM& room = m_rooms[roomIndex];
+
+	room.objects.clear();
+	for (int i = 0; i < (int)contents.objects.size(); i++)
+	{
+		room.objects.push_back(AddSceneObject(contents.objects[i], contents.triangles[i]));
+	}
+
+	// the clock hands turn about the center of the dial, with the
+	// hand placed so one end is at the center
+	for (int h = 0; h < 3; h++)
+	{
+		ANIMATED_OBJECT animated;
+		animated.objectIndex = room.objects[contents.clockHands[h]];
+		animated.room = roomIndex;
+		animated.channel = m_pAnimationManager->AddLinearChannel(
+			0.0f, g_ClockHandRates[h], g_ClockHandPeriods[h], g_ClockHandSteps[h]);
+
+		const glm::mat4& model = m_sceneObjects[animated.objectIndex].model;
+		glm::vec3 pivot = glm::vec3(model[3]);
+		float halfLength = glm::length(glm::vec3(model[0])) * 0.5f;
+		glm::mat4 baseModel = glm::translate(glm::vec3(halfLength, 0.0f, 0.0f)) * model;
+		animated.transform = m_pAnimationManager->AddTransform(
+			baseModel, pivot, glm::vec3(0.0f, 0.0f, 1.0f), animated.channel);
+		m_animatedObjects.push_back(animated);
+	}
+
+	// dust floats in the light of the lamp
+	room.dustEmitter = -1;
+	if (m_dustParticlesPerLamp > 0)
+	{
+		ParticleManager::EMITTER emitter;
+		emitter.position = room.origin + g_DustLampPosition;
+		emitter.direction = g_DustLampDirection;
+		emitter.length = g_DustConeLength;
+		emitter.spawnAngleDegrees = g_DustOuterAngle;
+		emitter.innerAngleDegrees = g_DustInnerAngle;
+		emitter.outerAngleDegrees = g_DustOuterAngle;
+		emitter.color = g_DustColor;
+		emitter.size = g_DustSize;
+		emitter.lifetimeSeconds = g_DustLifetime;
+		emitter.particleCount = m_dustParticlesPerLamp;
+		room.dustEmitter = m_pParticleManager->AddEmitter(emitter);
+	}
+
+	// the fill light and lamp of the room compete for the light
+	// slots of the shader with those of the other rooms
+	LightManager::LIGHT_SOURCE light = m_roomFillLight;
+	light.position += room.origin;
+	room.fillLight = m_pLightManager->AddLight(light);
+	light = m_roomLampLight;
+	light.position += room.origin;
+	room.lampLight = m_pLightManager->AddLight(light);
+
+	// the lamp, book and clock are each drawn as one assembly, and
+	// skipped together while their box is hidden.  The clock hands
+	// turn within the dial, so they stay inside the box
+	room.assemblies.clear();
+	if (NULL != m_pOcclusionManager)
+	{
+		for (int a = 0; a < g_OcclusionAssemblyCount; a++)
+		{
+			std::string prefix = std::string(g_OcclusionAssemblies[a]) + " ";
+			std::vector<int> members;
+			for (int objectIndex : room.objects)
+			{
+				if (m_sceneObjects[objectIndex].tag.compare(0, prefix.size(), prefix) == 0)
+				{
+					members.push_back(objectIndex);
+				}
+			}
+			if (members.empty())
+			{
+				continue;
+			}
+
+			int assembly = m_pOcclusionManager->AddAssembly(GetObjectBounds(m_sceneObjects[members[0]]));
+			for (int objectIndex : members)
+			{
+				m_sceneObjects[objectIndex].assembly = assembly;
+			}
+			room.assemblies.push_back(assembly);
+			UpdateAssemblyBounds(roomIndex, assembly);
+		}
+	}
+
+	room.state = ROOM_LOADED;
+	UpdateMemoryAccounts();
+	if (NULL != m_pReflectionManager)
+	{
+		m_pReflectionManager->Invalidate();
+	}
+
+	if (m_rooms.size() > 1)
+	{
+		std::cout << "INFO: Room " << roomIndex << " loaded with " << room.objects.size() << " objects" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  UnloadRoom()
+ *
+ *  This method is used for removing the objects of a room
+ *  from the scene, freeing their slots for other rooms.
+ ***********************************************************/
+void SceneManager::UnloadRoom(int roomIndex)
+{
+	ROOM& room = m_rooms[roomIndex];
+
+	for (int objectIndex : room.objects)
+	{
+		RemoveSceneObject(objectIndex);
+	}
+	room.objects.clear();
+
+	for (int i = (int)m_animatedObjects.size() - 1; i >= 0; i--)
+	{
+		if (m_animatedObjects[i].room == roomIndex)
+		{
+			m_pAnimationManager->RemoveTransform(m_animatedObjects[i].transform);
+			m_pAnimationManager->RemoveChannel(m_animatedObjects[i].channel);
+			m_animatedObjects.erase(m_animatedObjects.begin() + i);
+		}
+	}
+	m_pParticleManager->RemoveEmitter(room.dustEmitter);
+	room.dustEmitter = -1;
+	m_pLightManager->RemoveLight(room.fillLight);
+	m_pLightManager->RemoveLight(room.lampLight);
+	room.fillLight = -1;
+	room.lampLight = -1;
+	if (NULL != m_pOcclusionManager)
+	{
+		for (int assembly : room.assemblies)
+		{
+			m_pOcclusionManager->RemoveAssembly(assembly);
+		}
+	}
+	room.assemblies.clear();
+	room.state = ROOM_UNLOADED;
+	UpdateMemoryAccounts();
+	if (NULL != m_pReflectionManager)
+	{
+		m_pReflectionManager->Invalidate();
+	}
+
+	std::cout << "INFO: Room " << roomIndex << " unloaded" << std::endl;
+}
+
+/***********************************************************
+ *  UpdateRoomStreaming()
+ *
+ *  This method is used for loading the rooms close to the
+ *  camera and unloading the far ones.  Distances are walked
+ *  through the portals, so a room behind a wall counts as
+ *  far.  Room contents are built on worker threads and only
+ *  a limited number are moved into the scene each frame.
+ ***********************************************************/
+void SceneManager::UpdateRoomStreaming()
+{
+	std::vector<float> distances;
+	glm::vec3 eye = m_bCameraViewSet ? m_cameraPosition : m_rooms[0].origin;
+	m_pPortalManager->FindCellDistances(eye, distances);
+
+	int commitBudget = g_RoomCommitsPerFrame;
+	for (int roomIndex = 0; roomIndex < (int)m_rooms.size(); roomIndex++)
+	{
+		ROOM& room = m_rooms[roomIndex];
+		float distance = distances[room.cell];
+
+		if ((room.state == ROOM_UNLOADED) && (distance <= g_RoomLoadDistance))
+		{
+			room.state = ROOM_LOADING;
+			room.pendingContents = std::async(std::launch::async, &SceneManager::BuildRoomContents, this, roomIndex);
+		}
+		else if ((room.state == ROOM_LOADING) && (commitBudget > 0) &&
+			(room.pendingContents.wait_for(std::chrono::seconds(0)) == std::future_status::ready))
+		{
+			ROOM_CONTENTS contents = room.pendingContents.get();
+			CommitRoomContents(roomIndex, contents);
+			commitBudget--;
+		}
+		else if ((room.state == ROOM_LOADED) && (distance > g_RoomUnloadDistance))
+		{
+			UnloadRoom(roomIndex);
+		}
+	}
+}
+
+/***********************************************************
+ *  FinishRoomStreaming()
+ *
+ *  This method is used for waiting until all the rooms
+ *  within the load distance of the camera are loaded, for
+ *  frames that must come out the same on every run.
+ ***********************************************************/
+void SceneManager::FinishRoomStreaming()
+{
+	UpdateRoomStreaming();
+
+	for (int roomIndex = 0; roomIndex < (int)m_rooms.size(); roomIndex++)
+	{
+		ROOM& room = m_rooms[roomIndex];
+		if (room.state == ROOM_LOADING)
+		{
+			ROOM_CONTENTS contents = room.pendingContents.get();
+			CommitRoomContents(roomIndex, contents);
+		}
+	}
+}
+
+/***********************************************************
+ *  UpdateAnimation()
+ *
+ *  This method is used for evaluating the animation at the
+ *  current time and moving the animated objects.  Their
+ *  spatial bounds are refreshed a few objects per frame.
+ ***********************************************************/
+void SceneManager::UpdateAnimation()
+{
+	m_pAnimationManager->Update();
+
+	for (const ANIMATED_OBJECT& animated : m_animatedObjects)
+	{
+		m_sceneObjects[animated.objectIndex].model = m_pAnimationManager->GetTransform(animated.transform);
+	}
+
+	int refreshCount = std::min(g_AnimatedBoundsPerFrame, (int)m_animatedObjects.size());
+	for (int i = 0; i < refreshCount; i++)
+	{
+		m_nextAnimatedBounds = (m_nextAnimatedBounds + 1) % (int)m_animatedObjects.size();
+		int objectIndex = m_animatedObjects[m_nextAnimatedBounds].objectIndex;
+		SetObjectModel(objectIndex, m_sceneObjects[objectIndex].model);
+	}
+}
+
+/***********************************************************
+ *  SetAnimationTimeSource()
+ *
+ *  This method is used for replacing the clock that drives
+ *  the animation.
+ ***********************************************************/
+void SceneManager::SetAnimationTimeSource(AnimationManager::TIME_SOURCE timeSource)
+{
+	m_pAnimationManager->SetTimeSource(timeSource);
+}
+
+/***********************************************************
+ *  SetBuildingSize()
+ *
+ *  This method is used for setting how many rooms across and
+ *  deep the building has.  It must be called before the
+ *  scene is prepared.
+ ***********************************************************/
+void SceneManager::SetBuildingSize(int width, int depth)
+{
+	m_buildingWidth = std::max(width, 1);
+	m_buildingDepth = std::max(depth, 1);
+}
+
+/***********************************************************
+ *  SetCameraView()
+ *
+ *  This method is used for passing the camera view of the
+ *  current frame, used to find the visible rooms and the
+ *  rooms to stream in.
+ ***********************************************************/
+void SceneManager::SetCameraView(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	glm::vec3 cameraPosition)
+{
+	m_view = view;
+	m_projection = projection;
+	m_cameraPosition = cameraPosition;
+	m_bCameraViewSet = true;
+}
+
+/***********************************************************
+ *  RenderScene()
+ *
+ *  This method is used for rendering the 3D scene by 
+ *  transforming and drawing the basic 3D shapes
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	DEBUG_SCOPE("RenderScene");
+
+	// stream rooms in and out around the camera
+	UpdateRoomStreaming();
+	// move the animated objects before drawing
+	UpdateAnimation();
+	// bring in the virtual texture pages asked for by earlier frames
+	if (NULL != m_pVirtualTextures)
+	{
+		m_pVirtualTextures->Update();
+	}
+
+	// other code sets the scene shader between frames
+	m_pRenderBackend->BeginPass();
+	// shade the lights that add the most to the view
+	UpdateLights();
+
+	// find the rooms that can be seen through the doorways
+	std::vector<bool> visibleCells(m_rooms.size(), true);
+	if (m_bCameraViewSet)
+	{
+		std::vector<int> cells;
+		m_pPortalManager->FindVisibleCells(m_projection * m_view, m_cameraPosition, cells);
+		visibleCells.assign(m_rooms.size(), false);
+		for (int cell : cells)
+		{
+			visibleCells[cell] = true;
+		}
+	}
+
+	m_visibleRooms.clear();
+	for (int roomIndex = 0; roomIndex < (int)m_rooms.size(); roomIndex++)
+	{
+		const ROOM& room = m_rooms[roomIndex];
+		if ((room.state == ROOM_LOADED) && visibleCells[room.cell])
+		{
+			m_visibleRooms.push_back(roomIndex);
+		}
+	}
+
+	// the floor reflects the rooms, so they are drawn mirrored first
+	if ((NULL != m_pReflectionManager) && m_bCameraViewSet)
+	{
+		RenderReflection();
+	}
+
+	// draw the objects of the visible rooms, timing a few of them
+	if (NULL != m_pProfileManager)
+	{
+		m_pProfileManager->BeginFrame();
+	}
+	if ((NULL != m_pOcclusionManager) && m_pOcclusionManager->IsInitialized() && m_bCameraViewSet)
+	{
+		RenderOccludedRooms();
+	}
+	else
+	{
+		for (int roomIndex : m_visibleRooms)
+		{
+			for (int objectIndex : m_rooms[roomIndex].objects)
+			{
+				DrawProfiledObject(m_sceneObjects[objectIndex]);
+			}
+		}
+	}
+
+	// draw the visible rooms again into the small feedback target,
+	// which finds the virtual texture pages they need
+	if ((NULL != m_pVirtualTextures) && m_pVirtualTextures->BeginFeedback(m_pShaderManager))
+	{
+		DEBUG_SCOPE("VirtualTextureFeedback");
+		for (int roomIndex : m_visibleRooms)
+		{
+			for (int objectIndex : m_rooms[roomIndex].objects)
+			{
+				DrawSceneObject(m_sceneObjects[objectIndex]);
+			}
+		}
+		m_pVirtualTextures->EndFeedback(m_pShaderManager);
+	}
+
+	// the dust is drawn last, over the objects behind it
+	if (m_bCameraViewSet)
+	{
+		RenderParticles();
+	}
+}
+
+/***********************************************************
+ *  RenderParticles()
+ *
+ *  This method is used for moving the particles by the
+ *  animation time passed since the last frame and drawing
+ *  them, then switching back to the scene shader.
+ ***********************************************************/
+void SceneManager::RenderParticles()
+{
+	DEBUG_SCOPE("Particles");
+
+	double time = m_pAnimationManager->GetTime();
+	float deltaSeconds = (m_lastParticleTime < 0.0) ? 0.0f : (float)(time - m_lastParticleTime);
+	deltaSeconds = std::min(std::max(deltaSeconds, 0.0f), g_MaxParticleStep);
+	m_lastParticleTime = time;
+
+	m_pParticleManager->Update(deltaSeconds);
+	m_pParticleManager->Render(m_view, m_projection);
+	m_pShaderManager->use();
+}
+
+/***********************************************************
+ *  RenderOccludedRooms()
+ *
+ *  This method is used for drawing the visible rooms with
+ *  the lamp, book and clock of each room last, each under
+ *  the answer of its occlusion query, and then drawing the
+ *  boxes of the assemblies due a query against the depth
+ *  of the rooms.
+ ***********************************************************/
+void SceneManager::RenderOccludedRooms()
+{
+	DEBUG_SCOPE("OccludedRooms");
+
+	m_pOcclusionManager->BeginFrame(m_cameraPosition);
+
+	// the walls and furniture go first, so they hide the assemblies
+	for (int roomIndex : m_visibleRooms)
+	{
+		for (int objectIndex : m_rooms[roomIndex].objects)
+		{
+			if (m_sceneObjects[objectIndex].assembly < 0)
+			{
+				DrawProfiledObject(m_sceneObjects[objectIndex]);
+			}
+		}
+	}
+
+	for (int roomIndex : m_visibleRooms)
+	{
+		const ROOM& room = m_rooms[roomIndex];
+		for (int assembly : room.assemblies)
+		{
+			m_pOcclusionManager->BeginAssembly(assembly);
+			for (int objectIndex : room.objects)
+			{
+				if (m_sceneObjects[objectIndex].assembly == assembly)
+				{
+					DrawProfiledObject(m_sceneObjects[objectIndex]);
+				}
+			}
+			m_pOcclusionManager->EndAssembly(assembly);
+		}
+	}
+
+	m_pOcclusionManager->IssueQueries(m_projection * m_view);
+}
+
+/***********************************************************
+ *  RenderReflection()
+ *
+ *  This method is used for drawing the visible rooms from
+ *  the camera mirrored under the floor, when the reflection
+ *  manager finds the camera has moved.  Every floor is at
+ *  the same height, so the first one in view is the mirror.
+ ***********************************************************/
+void SceneManager::RenderReflection()
+{
+	DEBUG_SCOPE("Reflection");
+
+	const SCENE_OBJECT* pMirror = NULL;
+	for (int roomIndex : m_visibleRooms)
+	{
+		for (int objectIndex : m_rooms[roomIndex].objects)
+		{
+			if (m_sceneObjects[objectIndex].bMirror)
+			{
+				pMirror = &m_sceneObjects[objectIndex];
+				break;
+			}
+		}
+		if (NULL != pMirror)
+		{
+			break;
+		}
+	}
+	if (NULL == pMirror)
+	{
+		return;
+	}
+
+	float planeHeight = GetObjectBounds(*pMirror).max.y;
+	if (m_pReflectionManager->BeginUpdate(m_view, m_projection, m_cameraPosition, planeHeight))
+	{
+		m_pShaderManager->setMat4Value(g_ViewName, m_pReflectionManager->GetView());
+		m_pShaderManager->setMat4Value(g_ProjectionName, m_pReflectionManager->GetProjection());
+		m_pShaderManager->setVec3Value("viewPosition", m_pReflectionManager->GetCameraPosition());
+
+		for (int roomIndex : m_visibleRooms)
+		{
+			for (int objectIndex : m_rooms[roomIndex].objects)
+			{
+				const SCENE_OBJECT& object = m_sceneObjects[objectIndex];
+				if (!object.bMirror && m_pReflectionManager->IsObjectVisible(GetObjectBounds(object)))
+				{
+					DrawSceneObject(object);
+				}
+			}
+		}
+
+		m_pReflectionManager->EndUpdate();
+		m_pShaderManager->setMat4Value(g_ViewName, m_view);
+		m_pShaderManager->setMat4Value(g_ProjectionName, m_projection);
+		m_pShaderManager->setVec3Value("viewPosition", m_cameraPosition);
+	}
+	m_pReflectionManager->BindShaderReflection(m_pShaderManager);
+	// the reflection values were set by name between the passes
+	m_pRenderBackend->BeginPass();
+}
+
+/***********************************************************
+ *  SetDustParticles()
+ *
+ *  This method is used for setting the number of dust
+ *  particles in each lamp's light, and whether they may be
+ *  moved by a compute shader, before PrepareScene.  Zero
+ *  particles leaves the dust out.
+ ***********************************************************/
+void SceneManager::SetDustParticles(int particleCount, bool bAllowCompute)
+{
+	m_dustParticlesPerLamp = std::max(particleCount, 0);
+	m_bAllowComputeParticles = bAllowCompute;
+}
+
+/***********************************************************
+ *  SetVirtualTextures()
+ *
+ *  This method is used for choosing, before PrepareScene,
+ *  whether the scene textures are cut into pages and
+ *  streamed into a page cache that keeps the same size
+ *  however many textures there are.
+ ***********************************************************/
+void SceneManager::SetVirtualTextures(bool bEnable)
+{
+	if (bEnable && (NULL == m_pVirtualTextures))
+	{
+		m_pVirtualTextures = new VirtualTextureManager();
+	}
+	else if (!bEnable && (NULL != m_pVirtualTextures))
+	{
+		delete m_pVirtualTextures;
+		m_pVirtualTextures = NULL;
+	}
+}
+
+/***********************************************************
+ *  SetProceduralTextures()
+ *
+ *  This method is used for choosing, before PrepareScene,
+ *  whether the wood and marble textures are decoded from
+ *  their files, baked from their patterns at a size, or
+ *  drawn from their patterns by the shader.
+ ***********************************************************/
+void SceneManager::SetProceduralTextures(PROCEDURAL_MODE mode, int textureSize)
+{
+	m_proceduralMode = mode;
+	if (textureSize > 0)
+	{
+		m_proceduralTextureSize = textureSize;
+	}
+}
+
+/***********************************************************
+ *  SetTextureFormatTolerance()
+ *
+ *  This method is used for setting, before PrepareScene, how
+ *  many 8 bit levels a texel may change by when its texture
+ *  is stored in a smaller format.  Below zero the textures
+ *  are stored as decoded.
+ ***********************************************************/
+void SceneManager::SetTextureFormatTolerance(int tolerance)
+{
+	m_textureFormatTolerance = tolerance;
+}
+
+/***********************************************************
+ *  SetReflections()
+ *
+ *  This method is used for choosing, before PrepareScene,
+ *  whether the scene is reflected in the marble floor, the
+ *  fraction of the frame size the reflection is drawn at,
+ *  and whether it is kept while the camera stands still.
+ ***********************************************************/
+void SceneManager::SetReflections(bool bEnable, float resolutionScale, bool bThrottle)
+{
+	if (bEnable && (NULL == m_pReflectionManager))
+	{
+		m_pReflectionManager = new ReflectionManager();
+	}
+	else if (!bEnable && (NULL != m_pReflectionManager))
+	{
+		delete m_pReflectionManager;
+		m_pReflectionManager = NULL;
+	}
+
+	if (NULL != m_pReflectionManager)
+	{
+		m_pReflectionManager->SetResolutionScale(resolutionScale);
+		m_pReflectionManager->SetThrottle(bThrottle);
+	}
+}
+
+/***********************************************************
+ *  SetLightBudget()
+ *
+ *  This method is used for setting how many of the room
+ *  lights are shaded at once, and how long they take to
+ *  fade in and out as the view changes which ones matter.
+ ***********************************************************/
+void SceneManager::SetLightBudget(int lightCount, float fadeSeconds)
+{
+	m_pLightManager->SetBudget(lightCount);
+	m_pLightManager->SetFadeSeconds(fadeSeconds);
+}
+
+/***********************************************************
+ *  SetOcclusionQueries()
+ *
+ *  This method is used for choosing, before PrepareScene,
+ *  whether the lamps, books and clocks hidden behind the
+ *  walls are skipped with occlusion queries.
+ ***********************************************************/
+void SceneManager::SetOcclusionQueries(bool bEnable)
+{
+	if (bEnable && (NULL == m_pOcclusionManager))
+	{
+		m_pOcclusionManager = new OcclusionManager();
+	}
+	else if (!bEnable && (NULL != m_pOcclusionManager))
+	{
+		delete m_pOcclusionManager;
+		m_pOcclusionManager = NULL;
+	}
+}
+
+/***********************************************************
+ *  SetObjectProfiling()
+ *
+ *  This method is used for choosing, before PrepareScene,
+ *  whether a number of the scene draws are timed each frame
+ *  to rank the objects and materials by their GPU cost.
+ ***********************************************************/
+void SceneManager::SetObjectProfiling(bool bEnable, int samplesPerFrame)
+{
+	if (bEnable && (NULL == m_pProfileManager))
+	{
+		m_pProfileManager = new ProfileManager();
+	}
+	else if (!bEnable && (NULL != m_pProfileManager))
+	{
+		delete m_pProfileManager;
+		m_pProfileManager = NULL;
+	}
+
+	if (NULL != m_pProfileManager)
+	{
+		m_pProfileManager->SetSamplesPerFrame(samplesPerFrame);
+	}
 }
\ No newline at end of file
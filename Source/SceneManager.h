@@ -1,110 +1,546 @@
-///////////////////////////////////////////////////////////////////////////////
-// scenemanager.h
-// ============
-// manage the preparing and rendering of 3D scenes - textures, materials, lighting
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
-
-#include <string>
-#include <vector>
-
-/***********************************************************
- *  SceneManager
- *
- *  This class contains the code for preparing and rendering
- *  3D scenes, including the shader settings.
- ***********************************************************/
-class SceneManager
-{
-public:
-	// constructor
-	SceneManager(ShaderManager *pShaderManager);
-	// destructor
-	~SceneManager();
-
-	struct TEXTURE_INFO
-	{
-		std::string tag;
-		uint32_t ID;
-	};
-
-	struct OBJECT_MATERIAL
-	{
-		glm::vec3 diffuseColor;
-		glm::vec3 specularColor;
-		float shininess;
-		std::string tag;
-	};
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
-	// total number of loaded textures
-	int m_loadedTextures;
-	// loaded textures info
-	TEXTURE_INFO m_textureIDs[16];
-	// defined object materials
-	std::vector<OBJECT_MATERIAL> m_objectMaterials;
-
-	// load texture images and convert to OpenGL texture data
-	bool CreateGLTexture(const char* filename, std::string tag);
-	// bind loaded OpenGL textures to slots in memory
-	void BindGLTextures();
-	// free the loaded OpenGL textures
-	void DestroyGLTextures();
-	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
-	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
-
-	// set the transformation values 
-	// into the transform buffer
-	void SetTransformations(
-		glm::vec3 scaleXYZ,
-		float XrotationDegrees,
-		float YrotationDegrees,
-		float ZrotationDegrees,
-		glm::vec3 positionXYZ);
-
-	// set the color values into the shader
-	void SetShaderColor(
-		float redColorValue,
-		float greenColorValue,
-		float blueColorValue,
-		float alphaValue);
-
-	// set the texture data into the shader
-	void SetShaderTexture(
-		std::string textureTag);
-
-	// set the UV scale for the texture mapping
-	void SetTextureUVScale(
-		float u, float v);
-
-	// set the object material into the shader
-	void SetShaderMaterial(
-		std::string materialTag);
-
-public:
-
-	// The following methods are for the students to 
-	// customize for their own 3D scene
-	//loasd and setup the scene lights
-	void SetupSceneLights();
-
-	void PrepareScene();
-	void RenderScene();
-	
-	// loads textures from image files
-	void LoadSceneTextures();
+///////////////////////////////////////////////////////////////////////////////
+// scenemanager.h
+// ============
+// manage the preparing and rendering of 3D scenes - textures, materials, lighting
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+#include "AnimationManager.h"
+#include "GLResourceManager.h"
+#include "LightManager.h"
+#include "OcclusionManager.h"
+#include "ParticleManager.h"
+#include "PortalManager.h"
+#include "ProfileManager.h"
+#include "ProceduralTextureManager.h"
+#include "ReflectionManager.h"
+#include "RenderBackend.h"
+#include "SamplerManager.h"
+#include "SpatialManager.h"
+#include "TextureFormatManager.h"
+#include "VirtualTextureManager.h"
+
+#include <future>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneManager
+ *
+ *  This class contains the code for preparing and rendering
+ *  3D scenes, including the shader settings.
+ ***********************************************************/
+class SceneManager
+{
+public:
+	// constructor
+	SceneManager(ShaderManager *pShaderManager);
+	// destructor
+	~SceneManager();
+
+	struct TEXTURE_INFO
+	{
+		std::string tag;
+		GLTexture texture;
+	};
+
+	// image decoded from a file, waiting to be uploaded to OpenGL
+	struct TEXTURE_IMAGE
+	{
+		std::string filename;
+		std::string tag;
+		int width;
+		int height;
+		int colorChannels;
+		unsigned char* pixels;
+		// tiled file of a virtual texture, which is not decoded
+		std::string tiledFilename;
+		// pixels baked from a procedural pattern instead of decoded
+		bool bGenerated;
+		// largest change in 8 bit levels allowed when the pixels are
+		// stored in a smaller format, below zero keeps them as decoded
+		int formatTolerance;
+		// format picked for the pixels, which are packed for it
+		TextureFormatManager::TEXTURE_LAYOUT layout;
+	};
+
+	struct OBJECT_MATERIAL
+	{
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		std::string tag;
+		// how textures drawn with the material are filtered
+		SamplerManager::SAMPLER_DESC sampler;
+	};
+
+	// basic shapes that scene objects are drawn with
+	enum MESH_TYPE
+	{
+		BOX_MESH,
+		CONE_MESH,
+		CYLINDER_MESH,
+		PLANE_MESH,
+		SPHERE_MESH,
+		TAPERED_CYLINDER_MESH
+	};
+
+	struct SCENE_OBJECT
+	{
+		std::string tag;
+		MESH_TYPE mesh;
+		glm::mat4 model;
+		bool bUseTexture;
+		std::string textureTag;
+		std::string materialTag;
+		glm::vec4 color;
+		glm::vec2 UVscale;
+		// the camera cannot pass through collidable objects
+		bool bCollidable;
+		// object ID in the spatial query tree
+		int spatialID;
+		// room the object belongs to, and whether its slot is in use
+		int room;
+		bool bActive;
+		// the scene is reflected in mirror objects
+		bool bMirror;
+		// assembly the object is drawn with in the occlusion
+		// manager, -1 when it is drawn on its own
+		int assembly;
+		// the material and texture in the render backend, found
+		// from the tags when the object is added or edited
+		int materialIndex;
+		RenderBackend::TEXTURE_SOURCE textureSource;
+		int texture;
+	};
+
+	// objects of one room, built away from the render thread
+	struct ROOM_CONTENTS
+	{
+		std::vector<SCENE_OBJECT> objects;
+		std::vector<std::vector<SpatialManager::TRIANGLE>> triangles;
+		// positions of the hour, minute and second hands in objects
+		int clockHands[3];
+	};
+
+	enum ROOM_STATE
+	{
+		ROOM_UNLOADED,
+		ROOM_LOADING,
+		ROOM_LOADED
+	};
+
+	struct ROOM
+	{
+		glm::vec3 origin;
+		// cell of the room in the portal graph
+		int cell;
+		// doorways through the back, left and right walls
+		bool bNorthDoorway;
+		bool bWestDoorway;
+		bool bEastDoorway;
+		ROOM_STATE state;
+		// contents being built while the room is loading
+		std::future<ROOM_CONTENTS> pendingContents;
+		// scene objects of the room while it is loaded
+		std::vector<int> objects;
+		// particle emitter of the lamp, -1 when there is none
+		int dustEmitter;
+		// fill light and lamp light in the light manager, -1
+		// while the room is not loaded
+		int fillLight;
+		int lampLight;
+		// the lamp, book and clock of the room in the occlusion
+		// manager, empty while the room is not loaded
+		std::vector<int> assemblies;
+	};
+
+	// where the wood and marble textures come from
+	enum PROCEDURAL_MODE
+	{
+		// decoded from their image files
+		PROCEDURAL_OFF,
+		// baked from their patterns while the scene is prepared
+		PROCEDURAL_BAKED,
+		// drawn from their patterns by the shader, with no texture
+		PROCEDURAL_SHADER
+	};
+
+	// scene object moved by an animation transform
+	struct ANIMATED_OBJECT
+	{
+		int objectIndex;
+		int room;
+		int transform;
+		int channel;
+	};
+
+	// kinds of live edits of a running scene
+	enum SCENE_EDIT_TYPE
+	{
+		EDIT_ADD_OBJECT,
+		EDIT_REMOVE_OBJECT,
+		EDIT_MODIFY_OBJECT,
+		EDIT_SET_MATERIAL,
+		EDIT_SET_LIGHT
+	};
+
+	// values of an object changed by a modify edit
+	enum SCENE_EDIT_FIELD
+	{
+		EDIT_FIELD_TRANSFORM = 1,
+		EDIT_FIELD_COLOR = 2,
+		EDIT_FIELD_TEXTURE = 4,
+		EDIT_FIELD_MATERIAL = 8
+	};
+
+	// types of the light values a light edit sets
+	enum LIGHT_VALUE_TYPE
+	{
+		LIGHT_BOOL,
+		LIGHT_FLOAT,
+		LIGHT_VEC3
+	};
+
+	// one live edit, with only the values its type uses filled in
+	struct SCENE_EDIT
+	{
+		SCENE_EDIT_TYPE type;
+		// object tag within a room, material tag, or the shader
+		// name of a light value such as spotLight.diffuse, where
+		// pointLights[0] and spotLight are the fill light and lamp
+		// of every room, placed within the room
+		int room;
+		std::string tag;
+		// fields changed by a modify edit, all for an add edit
+		int fields;
+		MESH_TYPE mesh;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationXYZ;
+		glm::vec3 positionXYZ;
+		glm::vec4 color;
+		std::string textureTag;
+		glm::vec2 UVscale;
+		std::string materialTag;
+		// material values
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		// light value
+		LIGHT_VALUE_TYPE lightType;
+		glm::vec3 lightValue;
+	};
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// pointer to basic shapes object
+	ShapeMeshes* m_basicMeshes;
+	// total number of loaded textures
+	int m_loadedTextures;
+	// loaded textures info
+	TEXTURE_INFO m_textureIDs[16];
+	// textures streamed a page at a time, NULL unless enabled
+	VirtualTextureManager* m_pVirtualTextures;
+	// procedural wood and marble, and the size they are baked at
+	PROCEDURAL_MODE m_proceduralMode;
+	int m_proceduralTextureSize;
+	// largest change allowed when textures are stored smaller
+	int m_textureFormatTolerance;
+	// reflection of the scene in the floor, NULL unless enabled
+	ReflectionManager* m_pReflectionManager;
+	// light values changed by live edits, set again over the
+	// scene lights whenever the scene is activated
+	std::vector<SCENE_EDIT> m_lightEdits;
+	// the lights of the loaded rooms, shaded within a budget
+	LightManager* m_pLightManager;
+	// the fill light and lamp light of a room, placed within it
+	LightManager::LIGHT_SOURCE m_roomFillLight;
+	LightManager::LIGHT_SOURCE m_roomLampLight;
+	// animation time the light fades were last moved to
+	double m_lastLightTime;
+	// hidden lamps, books and clocks skipped with occlusion
+	// queries, NULL unless enabled
+	OcclusionManager* m_pOcclusionManager;
+	// a share of the draws timed each frame to rank the objects
+	// by GPU cost, NULL unless enabled
+	ProfileManager* m_pProfileManager;
+	// defined object materials, and the same materials in the
+	// render backend by their index
+	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// per object values are set through the render backend
+	RenderBackend* m_pRenderBackend;
+	// objects placed in the scene, in drawing order
+	std::vector<SCENE_OBJECT> m_sceneObjects;
+	// unused object slots left by unloaded rooms
+	std::vector<int> m_freeObjects;
+	// spatial query tree over the scene objects
+	SpatialManager* m_pSpatialManager;
+	// rooms of the building and the portals between them
+	std::vector<ROOM> m_rooms;
+	PortalManager* m_pPortalManager;
+	// animation channels and the objects they move
+	AnimationManager* m_pAnimationManager;
+	std::vector<ANIMATED_OBJECT> m_animatedObjects;
+	// next animated object whose spatial bounds are refreshed
+	int m_nextAnimatedBounds;
+	// dust in the light of the lamps
+	ParticleManager* m_pParticleManager;
+	bool m_bParticlesInitialized;
+	int m_dustParticlesPerLamp;
+	bool m_bAllowComputeParticles;
+	// animation time the particles were last moved to
+	double m_lastParticleTime;
+	int m_buildingWidth;
+	int m_buildingDepth;
+	// rooms seen by the camera in the current frame
+	std::vector<int> m_visibleRooms;
+	// camera view used for visibility and streaming
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	glm::vec3 m_cameraPosition;
+	bool m_bCameraViewSet;
+	// texture images being decoded on worker threads
+	std::vector<std::future<TEXTURE_IMAGE>> m_pendingTextures;
+	// progress of the preparation spread over several frames
+	int m_nextTextureUpload;
+	int m_nextMeshLoad;
+	bool m_bSceneReady;
+	// memory charged to the memory accounts
+	std::vector<GLuint> m_meshBuffers;
+	size_t m_objectMemoryBytes;
+	size_t m_materialMemoryBytes;
+
+	// load texture images and convert to OpenGL texture data
+	bool CreateGLTexture(const char* filename, std::string tag);
+	// decode an image file into memory, safe to call from worker threads
+	static bool DecodeTextureImage(TEXTURE_IMAGE& image);
+	// create an OpenGL texture from a decoded image and free the image
+	bool UploadGLTexture(TEXTURE_IMAGE& image);
+	// free the pixels of a decoded image
+	static void FreeTextureImage(TEXTURE_IMAGE& image);
+	// pick the format of decoded or baked pixels and pack them for it
+	static void ReduceTextureImage(TEXTURE_IMAGE& image);
+	// bind loaded OpenGL textures to slots in memory
+	void BindGLTextures();
+	// free the loaded OpenGL textures
+	void DestroyGLTextures();
+	// find a loaded texture by tag
+	int FindTextureID(std::string tag);
+	int FindTextureSlot(std::string tag);
+	// find a defined material by tag
+	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	int FindMaterialIndex(std::string tag);
+
+	// build the model matrix from the transformation values
+	glm::mat4 BuildTransformation(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the transformation values 
+	// into the transform buffer
+	void SetTransformations(
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ);
+
+	// set the color values into the shader
+	void SetShaderColor(
+		float redColorValue,
+		float greenColorValue,
+		float blueColorValue,
+		float alphaValue);
+
+	// set the texture data into the shader
+	void SetShaderTexture(
+		std::string textureTag);
+
+	// set the UV scale for the texture mapping
+	void SetTextureUVScale(
+		float u, float v);
+
+	// set the object material into the shader
+	void SetShaderMaterial(
+		std::string materialTag);
+
+	// build the description of a textured or colored object
+	SCENE_OBJECT MakeTexturedObject(
+		std::string tag,
+		MESH_TYPE mesh,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		std::string textureTag,
+		std::string materialTag,
+		glm::vec2 UVscale,
+		bool bCollidable = true);
+	SCENE_OBJECT MakeColoredObject(
+		std::string tag,
+		MESH_TYPE mesh,
+		glm::vec3 scaleXYZ,
+		float XrotationDegrees,
+		float YrotationDegrees,
+		float ZrotationDegrees,
+		glm::vec3 positionXYZ,
+		glm::vec4 color,
+		std::string materialTag,
+		bool bCollidable = true);
+	// add and remove objects in the scene and the spatial query tree
+	int AddSceneObject(
+		const SCENE_OBJECT& object,
+		const std::vector<SpatialManager::TRIANGLE>& triangles);
+	void RemoveSceneObject(int objectIndex);
+	// find the backend material and texture of an object from
+	// its tags
+	void ResolveObjectIndices(SCENE_OBJECT& object);
+	// move a scene object and update its spatial bounds
+	void SetObjectModel(int objectIndex, const glm::mat4& model);
+	// fit the occlusion box of an assembly to its objects
+	void UpdateAssemblyBounds(int roomIndex, int assembly);
+	// build the world space triangles of a scene object
+	void BuildObjectTriangles(
+		const SCENE_OBJECT& object,
+		std::vector<SpatialManager::TRIANGLE>& triangles);
+
+	// define the materials used by the scene objects
+	void DefineObjectMaterials();
+	// load one of the basic shape meshes into OpenGL memory
+	void LoadSceneMesh(int meshIndex);
+
+	// draw a basic shape mesh
+	void DrawMesh(MESH_TYPE mesh);
+	// set the shader values for an object and draw it
+	void DrawSceneObject(const SCENE_OBJECT& object);
+	// draw an object of the scene pass, timed when it is its turn
+	void DrawProfiledObject(const SCENE_OBJECT& object);
+
+	// add a wall box, leaving a doorway opening when asked
+	void AddWallObjects(
+		ROOM_CONTENTS& contents,
+		std::string tag,
+		glm::vec3 wallMin,
+		glm::vec3 wallMax,
+		bool bDoorway,
+		glm::vec3 openingMin,
+		glm::vec3 openingMax);
+	// create the rooms of the building and the portals between them
+	void DefineBuilding();
+	// build the objects of a room, safe to call from worker threads
+	ROOM_CONTENTS BuildRoomContents(int roomIndex);
+	// move built room contents into the scene
+	void CommitRoomContents(int roomIndex, ROOM_CONTENTS& contents);
+	// remove the objects of a room from the scene
+	void UnloadRoom(int roomIndex);
+	// load and unload rooms by their distance from the camera
+	void UpdateRoomStreaming();
+	// charge mesh buffers and scene arrays to the memory accounts
+	void TrackMeshMemory(const char* meshName);
+	void UpdateMemoryAccounts();
+	// move and draw the particles
+	void RenderParticles();
+	// draw the visible rooms into the reflection of the floor
+	void RenderReflection();
+	// draw the visible rooms with their assemblies last, skipping
+	// the ones found hidden, and query the assemblies again
+	void RenderOccludedRooms();
+	// find an object of a loaded room by its tag, -1 when none
+	int FindRoomObject(int roomIndex, const std::string& tag);
+	// apply the parts of a live edit
+	bool ApplyObjectEdit(const SCENE_EDIT& edit, std::string& error);
+	void ApplyMaterialEdit(const SCENE_EDIT& edit);
+	bool ApplyLightEdit(const SCENE_EDIT& edit, std::string& error);
+	// set the room light values into the lights of the loaded rooms
+	void UpdateRoomLights();
+	// choose the lights shaded for the view and set them into the shader
+	void UpdateLights();
+
+public:
+	// load every room near the camera before the next frame, so
+	// the frame does not depend on how fast rooms were built
+	void FinishRoomStreaming();
+
+	// The following methods are for the students to 
+	// customize for their own 3D scene
+	//loasd and setup the scene lights
+	void SetupSceneLights();
+	// define the fill light and lamp light of every room
+	void DefineRoomLights();
+
+	void PrepareScene();
+	void RenderScene();
+
+	// start preparing the scene, decoding files on worker threads
+	void BeginPrepareScene();
+	// continue preparing the scene within a time budget, true when ready
+	bool ContinuePrepareScene(double budgetMilliseconds);
+	// use this scene's lights and textures for the following frames
+	void ActivateScene();
+	// release the scene resources within a time budget, true when done
+	bool ReleaseScene(double budgetMilliseconds);
+	
+	// loads textures from image files
+	void LoadSceneTextures();
+	// moves the animated objects to the current animation time
+	void UpdateAnimation();
+	// replace the clock driving the animation, such as with a frame
+	// clock so rendered frames repeat exactly
+	void SetAnimationTimeSource(AnimationManager::TIME_SOURCE timeSource);
+	// set the number of dust particles in each lamp's light, and
+	// whether they are moved on the GPU when it can
+	void SetDustParticles(int particleCount, bool bAllowCompute);
+	// stream the scene textures a page at a time into a page cache
+	// of fixed size, before PrepareScene
+	void SetVirtualTextures(bool bEnable);
+	// make the wood and marble from their patterns instead of their
+	// image files, before PrepareScene
+	void SetProceduralTextures(PROCEDURAL_MODE mode, int textureSize);
+	// store textures in smaller formats when no channel changes by
+	// more than a number of 8 bit levels, or as decoded when below
+	// zero, before PrepareScene
+	void SetTextureFormatTolerance(int tolerance);
+	// reflect the scene in the floor at a fraction of the frame
+	// size, kept while the camera stands still when throttled,
+	// before PrepareScene
+	void SetReflections(bool bEnable, float resolutionScale, bool bThrottle);
+	// shade at most a number of the room lights at once, folding
+	// the rest into the ambient light, with lights fading in and
+	// out over a time, or switched at once when zero
+	void SetLightBudget(int lightCount, float fadeSeconds);
+	// skip drawing the lamps, books and clocks hidden behind the
+	// walls with occlusion queries, before PrepareScene
+	void SetOcclusionQueries(bool bEnable);
+	// time a number of the scene draws each frame and print the
+	// objects and materials ranked by GPU cost when the scene is
+	// released, before PrepareScene
+	void SetObjectProfiling(bool bEnable, int samplesPerFrame);
+
+	// set the number of rooms across and deep, before PrepareScene
+	void SetBuildingSize(int width, int depth);
+	// set the camera view used for room visibility and streaming
+	void SetCameraView(
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		glm::vec3 cameraPosition);
+
+	// spatial query tree for picking and camera collision
+	SpatialManager* GetSpatialManager();
+
+	// change the running scene between frames, touching only the
+	// object, material or light edited.  Edited objects go back to
+	// how they were built when their room is unloaded.  Returns
+	// false with the reason when the edit cannot be applied
+	bool ApplySceneEdit(const SCENE_EDIT& edit, std::string& error);
 };
\ No newline at end of file
@@ -0,0 +1,543 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderbenchmark.cpp
+// ============
+// measure the scene shader - the cost of each variant and light setup
+//
+//  Every measurement is taken after a few warm up frames, so shader
+//  compiles and buffer uploads are not counted.  The GPU time of a frame is
+//  the median of its timer queries; the wall time includes waiting for the
+//  GPU to finish, which is all a software renderer reports.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderBenchmark.h"
+#include "ProceduralTextureManager.h"
+#include "RenderTarget.h"
+#include "SamplerManager.h"
+#include "ShapeMeshes.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// one path through the scene fragment shader
+	struct SHADER_VARIANT
+	{
+		const char* name;
+		bool bLighting;
+		bool bTexture;
+		int pointLights;
+		int spotLights;
+		// the texture is drawn from the marble pattern
+		bool bProcedural;
+	};
+
+	const SHADER_VARIANT g_Variants[] =
+	{
+		{ "unlit color", false, false, 0, 0, false },
+		{ "unlit textured", false, true, 0, 0, false },
+		{ "lit color, directional", true, false, 0, 0, false },
+		{ "lit textured, directional", true, true, 0, 0, false },
+		{ "lit textured, 1 point", true, true, 1, 0, false },
+		{ "lit textured, 3 points", true, true, 3, 0, false },
+		{ "lit textured, 5 points", true, true, 5, 0, false },
+		{ "lit textured, 5 points, spot", true, true, 5, 1, false },
+		{ "lit textured, 5 points, 4 spots", true, true, 5, 4, false },
+		{ "unlit procedural", false, true, 0, 0, true },
+		{ "lit procedural, 5 points, spot", true, true, 5, 1, true }
+	};
+
+	// marble like the floor of the scene
+	const ProceduralTextureManager::PATTERN g_BenchmarkPattern =
+	{
+		ProceduralTextureManager::MARBLE_PATTERN,
+		glm::vec3(0.90f, 0.90f, 0.88f), glm::vec3(0.35f, 0.35f, 0.38f), 4, 4, 5, 1.5f, 2, 37
+	};
+	const int g_VariantCount = sizeof(g_Variants) / sizeof(g_Variants[0]);
+
+	struct RESOLUTION
+	{
+		int width;
+		int height;
+	};
+
+	const RESOLUTION g_Resolutions[] =
+	{
+		{ 640, 360 },
+		{ 1280, 720 },
+		{ 1920, 1080 },
+		{ 3840, 2160 }
+	};
+	const int g_ResolutionCount = sizeof(g_Resolutions) / sizeof(g_Resolutions[0]);
+
+	// what is drawn for each measurement
+	enum WORKLOAD
+	{
+		// layers of a quad over the whole screen, so the cost is
+		// nearly all fragment shading
+		WORKLOAD_FULLSCREEN,
+		// a floor and a field of spheres with depth testing, like
+		// the objects of a room
+		WORKLOAD_GEOMETRY,
+		// a long floor between two walls seen from standing height,
+		// so most of the texture is minified at shallow angles
+		WORKLOAD_SURFACES,
+		WORKLOAD_COUNT
+	};
+
+	const char* g_WorkloadNames[WORKLOAD_COUNT] =
+	{
+		"full screen",
+		"geometry",
+		"floor and walls"
+	};
+
+	const int g_FullscreenLayers = 8;
+	const int g_SphereRows = 12;
+	const float g_SphereSpacing = 1.5f;
+	const int g_WarmupFrames = 5;
+	const int g_MeasuredFrames = 30;
+	const int g_CheckerSize = 512;
+	// the sampler comparison uses a texture the size of the scene's
+	// floor and wall images, so the level read changes the bandwidth
+	const int g_SurfaceTextureSize = 2048;
+	const float g_SurfaceLength = 20.0f;
+	const float g_SurfaceWidth = 4.0f;
+	const float g_SurfaceHeight = 3.0f;
+
+	// ways of filtering the floor and walls that are compared
+	struct SAMPLER_POLICY
+	{
+		const char* name;
+		SamplerManager::FILTER_MODE filter;
+		float anisotropy;
+	};
+
+	const SAMPLER_POLICY g_SamplerPolicies[] =
+	{
+		{ "linear, no mipmaps", SamplerManager::FILTER_LINEAR, 1.0f },
+		{ "bilinear mipmaps", SamplerManager::FILTER_BILINEAR, 1.0f },
+		{ "trilinear", SamplerManager::FILTER_TRILINEAR, 1.0f },
+		{ "trilinear, anisotropic 4x", SamplerManager::FILTER_TRILINEAR, 4.0f },
+		{ "trilinear, anisotropic 16x", SamplerManager::FILTER_TRILINEAR, 16.0f }
+	};
+	const int g_SamplerPolicyCount = sizeof(g_SamplerPolicies) / sizeof(g_SamplerPolicies[0]);
+	// the variant the floor and walls are drawn with
+	const int g_SamplerVariant = 3;
+
+	// light slots of the scene shader
+	const int g_TotalPointLights = 5;
+	const int g_TotalSpotLights = 4;
+	const glm::vec3 g_PointLightPositions[g_TotalPointLights] =
+	{
+		glm::vec3(-6.0f, 4.0f, -6.0f),
+		glm::vec3(6.0f, 4.0f, -6.0f),
+		glm::vec3(0.0f, 5.0f, 0.0f),
+		glm::vec3(-6.0f, 4.0f, 6.0f),
+		glm::vec3(6.0f, 4.0f, 6.0f)
+	};
+
+	// time of one measurement, in milliseconds per frame
+	struct MEASUREMENT
+	{
+		double gpuMilliseconds;
+		double wallMilliseconds;
+	};
+
+	// make a mipmapped checker texture, so the textured variants
+	// sample a real image without reading any files
+	GLuint CreateCheckerTexture(int size)
+	{
+		std::vector<unsigned char> pixels((size_t)size * size * 4);
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				unsigned char value = (((x / 32) + (y / 32)) % 2 == 0) ? 220 : 60;
+				unsigned char* pPixel = &pixels[((size_t)y * size + x) * 4];
+				pPixel[0] = value;
+				pPixel[1] = (unsigned char)(value * 3 / 4);
+				pPixel[2] = (unsigned char)(value / 2);
+				pPixel[3] = 255;
+			}
+		}
+
+		GLuint texture = 0;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		glGenerateMipmap(GL_TEXTURE_2D);
+		return(texture);
+	}
+
+	// set the shader uniforms that choose the variant
+	void SetVariant(ShaderManager* pShaderManager, const SHADER_VARIANT& variant)
+	{
+		pShaderManager->setBoolValue("bUseLighting", variant.bLighting);
+		pShaderManager->setBoolValue("bUseTexture", variant.bTexture);
+		if (variant.bProcedural)
+		{
+			ProceduralTextureManager::SetShaderPattern(pShaderManager, g_BenchmarkPattern);
+		}
+		else
+		{
+			pShaderManager->setBoolValue("bUseProceduralTexture", false);
+		}
+		pShaderManager->setVec4Value("objectColor", glm::vec4(0.7f, 0.6f, 0.5f, 1.0f));
+		pShaderManager->setIntValue("objectTexture", 0);
+		pShaderManager->setVec2Value("UVscale", glm::vec2(4.0f, 4.0f));
+		pShaderManager->setVec3Value("material.diffuseColor", glm::vec3(0.8f, 0.5f, 0.2f));
+		pShaderManager->setVec3Value("material.specularColor", glm::vec3(0.5f));
+		pShaderManager->setFloatValue("material.shininess", 16.0f);
+
+		pShaderManager->setBoolValue("directionalLight.bActive", variant.bLighting);
+		pShaderManager->setVec3Value("directionalLight.direction", glm::vec3(-0.3f, -1.0f, -0.4f));
+		pShaderManager->setVec3Value("directionalLight.ambient", glm::vec3(0.1f));
+		pShaderManager->setVec3Value("directionalLight.diffuse", glm::vec3(0.6f));
+		pShaderManager->setVec3Value("directionalLight.specular", glm::vec3(0.5f));
+
+		for (int i = 0; i < g_TotalPointLights; i++)
+		{
+			std::string name = "pointLights[" + std::to_string(i) + "].";
+			pShaderManager->setBoolValue(name + "bActive", i < variant.pointLights);
+			pShaderManager->setVec3Value(name + "position", g_PointLightPositions[i]);
+			pShaderManager->setFloatValue(name + "constant", 1.0f);
+			pShaderManager->setFloatValue(name + "linear", 0.0f);
+			pShaderManager->setFloatValue(name + "quadratic", 0.0f);
+			pShaderManager->setVec3Value(name + "ambient", glm::vec3(0.02f));
+			pShaderManager->setVec3Value(name + "diffuse", glm::vec3(0.4f));
+			pShaderManager->setVec3Value(name + "specular", glm::vec3(0.3f));
+		}
+
+		// the spots stand side by side, all aimed at the middle
+		for (int i = 0; i < g_TotalSpotLights; i++)
+		{
+			std::string name = "spotLights[" + std::to_string(i) + "].";
+			pShaderManager->setBoolValue(name + "bActive", i < variant.spotLights);
+			pShaderManager->setVec3Value(name + "position", glm::vec3(-2.2f + 1.5f * i, 6.5f, 2.5f));
+			pShaderManager->setVec3Value(name + "direction", glm::vec3(-0.7f, -1.5f, 1.0f));
+			pShaderManager->setFloatValue(name + "cutOff", glm::cos(glm::radians(12.5f)));
+			pShaderManager->setFloatValue(name + "outerCutOff", glm::cos(glm::radians(35.5f)));
+			pShaderManager->setFloatValue(name + "constant", 1.0f);
+			pShaderManager->setFloatValue(name + "linear", 0.09f);
+			pShaderManager->setFloatValue(name + "quadratic", 0.032f);
+			pShaderManager->setVec3Value(name + "ambient", glm::vec3(0.001f));
+			pShaderManager->setVec3Value(name + "diffuse", glm::vec3(4.0f, 4.4f, 4.0f));
+			pShaderManager->setVec3Value(name + "specular", glm::vec3(3.0f));
+		}
+		pShaderManager->setVec3Value("foldedAmbient", glm::vec3(0.0f));
+	}
+
+	// draw one frame of a workload
+	void DrawWorkload(ShaderManager* pShaderManager, ShapeMeshes& meshes, WORKLOAD workload, float aspect)
+	{
+		if (workload == WORKLOAD_FULLSCREEN)
+		{
+			// looking straight down at the plane, which is stretched
+			// past the edges of the screen
+			glDisable(GL_DEPTH_TEST);
+			glClear(GL_COLOR_BUFFER_BIT);
+			pShaderManager->setMat4Value("view", glm::lookAt(
+				glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
+			pShaderManager->setMat4Value("projection", glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 10.0f));
+			pShaderManager->setVec3Value("viewPosition", glm::vec3(0.0f, 1.0f, 0.0f));
+			pShaderManager->setMat4Value("model", glm::scale(glm::vec3(1.1f, 1.0f, 1.1f)));
+			for (int layer = 0; layer < g_FullscreenLayers; layer++)
+			{
+				meshes.DrawPlaneMesh();
+			}
+			return;
+		}
+
+		if (workload == WORKLOAD_SURFACES)
+		{
+			// looking down the length of the floor, with the walls
+			// on either side
+			glEnable(GL_DEPTH_TEST);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			glm::vec3 eye = glm::vec3(0.0f, 1.7f, 0.0f);
+			pShaderManager->setMat4Value("view", glm::lookAt(
+				eye, glm::vec3(0.0f, 1.2f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+			pShaderManager->setMat4Value("projection", glm::perspective(glm::radians(60.0f), aspect, 0.1f, 100.0f));
+			pShaderManager->setVec3Value("viewPosition", eye);
+			pShaderManager->setVec2Value("UVscale", glm::vec2(2.0f, 10.0f));
+
+			pShaderManager->setMat4Value("model",
+				glm::translate(glm::vec3(0.0f, 0.0f, -g_SurfaceLength)) *
+				glm::scale(glm::vec3(g_SurfaceWidth, 1.0f, g_SurfaceLength)));
+			meshes.DrawPlaneMesh();
+			for (int side = -1; side <= 1; side += 2)
+			{
+				pShaderManager->setMat4Value("model",
+					glm::translate(glm::vec3(side * g_SurfaceWidth, g_SurfaceHeight, -g_SurfaceLength)) *
+					glm::rotate(glm::radians(side * 90.0f), glm::vec3(0.0f, 0.0f, 1.0f)) *
+					glm::scale(glm::vec3(g_SurfaceHeight, 1.0f, g_SurfaceLength)));
+				meshes.DrawPlaneMesh();
+			}
+			return;
+		}
+
+		glEnable(GL_DEPTH_TEST);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glm::vec3 eye = glm::vec3(0.0f, 8.0f, 14.0f);
+		pShaderManager->setMat4Value("view", glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+		pShaderManager->setMat4Value("projection", glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f));
+		pShaderManager->setVec3Value("viewPosition", eye);
+
+		pShaderManager->setMat4Value("model", glm::scale(glm::vec3(12.0f, 1.0f, 12.0f)));
+		meshes.DrawPlaneMesh();
+
+		float start = -0.5f * (g_SphereRows - 1) * g_SphereSpacing;
+		for (int row = 0; row < g_SphereRows; row++)
+		{
+			for (int column = 0; column < g_SphereRows; column++)
+			{
+				glm::vec3 position = glm::vec3(start + column * g_SphereSpacing, 0.6f, start + row * g_SphereSpacing);
+				pShaderManager->setMat4Value("model", glm::translate(position) * glm::scale(glm::vec3(0.6f)));
+				meshes.DrawSphereMesh();
+			}
+		}
+	}
+
+	// draw a workload for the measured frames and time them
+	MEASUREMENT MeasureWorkload(
+		ShaderManager* pShaderManager,
+		ShapeMeshes& meshes,
+		WORKLOAD workload,
+		float aspect,
+		GLuint* pQueries)
+	{
+		for (int frame = 0; frame < g_WarmupFrames; frame++)
+		{
+			DrawWorkload(pShaderManager, meshes, workload, aspect);
+		}
+		glFinish();
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < g_MeasuredFrames; frame++)
+		{
+			glBeginQuery(GL_TIME_ELAPSED, pQueries[frame]);
+			DrawWorkload(pShaderManager, meshes, workload, aspect);
+			glEndQuery(GL_TIME_ELAPSED);
+		}
+		glFinish();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		std::vector<double> gpuMilliseconds(g_MeasuredFrames);
+		for (int frame = 0; frame < g_MeasuredFrames; frame++)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(pQueries[frame], GL_QUERY_RESULT, &nanoseconds);
+			gpuMilliseconds[frame] = nanoseconds / 1.0e6;
+		}
+		std::nth_element(gpuMilliseconds.begin(), gpuMilliseconds.begin() + g_MeasuredFrames / 2, gpuMilliseconds.end());
+
+		MEASUREMENT measurement;
+		measurement.gpuMilliseconds = gpuMilliseconds[g_MeasuredFrames / 2];
+		measurement.wallMilliseconds = elapsed.count() / g_MeasuredFrames;
+		return(measurement);
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for timing every shader variant for
+ *  every workload and resolution, then printing the cost
+ *  matrix.  Returns non-zero when it could not run.
+ ***********************************************************/
+int ShaderBenchmark::Run(ShaderManager* pShaderManager, const std::string& csvFilename)
+{
+	if (NULL == pShaderManager)
+	{
+		return(1);
+	}
+
+	ShapeMeshes meshes;
+	meshes.LoadPlaneMesh();
+	meshes.LoadSphereMesh();
+	GLuint texture = CreateCheckerTexture(g_CheckerSize);
+	GLuint queries[g_MeasuredFrames];
+	glGenQueries(g_MeasuredFrames, queries);
+	RenderTarget renderTarget;
+
+	pShaderManager->use();
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+
+	// results by workload, variant and resolution
+	std::vector<MEASUREMENT> results(WORKLOAD_COUNT * g_VariantCount * g_ResolutionCount);
+	bool bGPUTimes = false;
+	std::cout << "INFO: Timing " << g_VariantCount << " shader variants at "
+		<< g_ResolutionCount << " resolutions" << std::endl;
+	for (int r = 0; r < g_ResolutionCount; r++)
+	{
+		const RESOLUTION& resolution = g_Resolutions[r];
+		renderTarget.Resize(resolution.width, resolution.height);
+		renderTarget.Bind();
+		float aspect = (float)resolution.width / resolution.height;
+
+		for (int w = 0; w < WORKLOAD_COUNT; w++)
+		{
+			for (int v = 0; v < g_VariantCount; v++)
+			{
+				SetVariant(pShaderManager, g_Variants[v]);
+				MEASUREMENT& measurement = results[(w * g_VariantCount + v) * g_ResolutionCount + r];
+				measurement = MeasureWorkload(pShaderManager, meshes, (WORKLOAD)w, aspect, queries);
+				bGPUTimes = bGPUTimes || (measurement.gpuMilliseconds > 0.0);
+			}
+		}
+		renderTarget.Unbind();
+	}
+
+	// the floor and walls again with a large texture, for each way
+	// of filtering it
+	GLuint surfaceTexture = CreateCheckerTexture(g_SurfaceTextureSize);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, surfaceTexture);
+	std::vector<MEASUREMENT> samplerResults(g_SamplerPolicyCount * g_ResolutionCount);
+	std::cout << "INFO: Timing " << g_SamplerPolicyCount << " samplers on the floor and walls, anisotropy up to "
+		<< SamplerManager::GetMaxAnisotropy() << "x" << std::endl;
+	for (int r = 0; r < g_ResolutionCount; r++)
+	{
+		const RESOLUTION& resolution = g_Resolutions[r];
+		renderTarget.Resize(resolution.width, resolution.height);
+		renderTarget.Bind();
+		float aspect = (float)resolution.width / resolution.height;
+
+		SetVariant(pShaderManager, g_Variants[g_SamplerVariant]);
+		for (int p = 0; p < g_SamplerPolicyCount; p++)
+		{
+			const SAMPLER_POLICY& policy = g_SamplerPolicies[p];
+			SamplerManager::BindSampler(0, SamplerManager::GetSampler(
+				SamplerManager::MakeDesc(policy.filter, policy.anisotropy)));
+			samplerResults[p * g_ResolutionCount + r] =
+				MeasureWorkload(pShaderManager, meshes, WORKLOAD_SURFACES, aspect, queries);
+		}
+		renderTarget.Unbind();
+	}
+	SamplerManager::BindSampler(0, 0);
+
+	glDeleteQueries(g_MeasuredFrames, queries);
+	glDeleteTextures(1, &texture);
+	glDeleteTextures(1, &surfaceTexture);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glEnable(GL_DEPTH_TEST);
+
+	// software renderers without timer queries report zero, so the
+	// wall clock is shown instead
+	if (!bGPUTimes)
+	{
+		std::cout << "INFO: GPU timer queries returned no times, showing wall clock times" << std::endl;
+	}
+	for (int w = 0; w < WORKLOAD_COUNT; w++)
+	{
+		std::cout << "INFO: Shader cost, " << g_WorkloadNames[w]
+			<< ((w == WORKLOAD_FULLSCREEN) ? " x" + std::to_string(g_FullscreenLayers) : std::string(""))
+			<< ", " << (bGPUTimes ? "GPU" : "wall") << " milliseconds per frame" << std::endl;
+		std::cout << "    " << std::left << std::setw(32) << "variant" << std::right;
+		for (int r = 0; r < g_ResolutionCount; r++)
+		{
+			std::cout << std::setw(11)
+				<< (std::to_string(g_Resolutions[r].width) + "x" + std::to_string(g_Resolutions[r].height));
+		}
+		std::cout << std::endl;
+
+		for (int v = 0; v < g_VariantCount; v++)
+		{
+			std::cout << "    " << std::left << std::setw(32) << g_Variants[v].name << std::right
+				<< std::fixed << std::setprecision(3);
+			for (int r = 0; r < g_ResolutionCount; r++)
+			{
+				const MEASUREMENT& measurement = results[(w * g_VariantCount + v) * g_ResolutionCount + r];
+				std::cout << std::setw(11) << (bGPUTimes ? measurement.gpuMilliseconds : measurement.wallMilliseconds);
+			}
+			std::cout << std::endl;
+		}
+		std::cout.unsetf(std::ios::floatfield);
+	}
+
+	// the time saved over reading the first level only is mostly
+	// texture bandwidth, since the shading is the same
+	std::cout << "INFO: Sampler cost, " << g_WorkloadNames[WORKLOAD_SURFACES] << " with a "
+		<< g_SurfaceTextureSize << " texture, " << (bGPUTimes ? "GPU" : "wall")
+		<< " milliseconds per frame and change from no mipmaps" << std::endl;
+	std::cout << "    " << std::left << std::setw(32) << "sampler" << std::right;
+	for (int r = 0; r < g_ResolutionCount; r++)
+	{
+		std::cout << std::setw(19)
+			<< (std::to_string(g_Resolutions[r].width) + "x" + std::to_string(g_Resolutions[r].height));
+	}
+	std::cout << std::endl;
+	for (int p = 0; p < g_SamplerPolicyCount; p++)
+	{
+		std::cout << "    " << std::left << std::setw(32) << g_SamplerPolicies[p].name << std::right;
+		for (int r = 0; r < g_ResolutionCount; r++)
+		{
+			const MEASUREMENT& measurement = samplerResults[p * g_ResolutionCount + r];
+			const MEASUREMENT& baseline = samplerResults[r];
+			double milliseconds = bGPUTimes ? measurement.gpuMilliseconds : measurement.wallMilliseconds;
+			double baselineMilliseconds = bGPUTimes ? baseline.gpuMilliseconds : baseline.wallMilliseconds;
+			double change = (baselineMilliseconds > 0.0) ? (milliseconds / baselineMilliseconds - 1.0) * 100.0 : 0.0;
+			std::cout << std::fixed << std::setprecision(3) << std::setw(11) << milliseconds
+				<< std::showpos << std::setprecision(1) << std::setw(7) << change << "%" << std::noshowpos;
+		}
+		std::cout << std::endl;
+	}
+	std::cout.unsetf(std::ios::floatfield);
+
+	if (!csvFilename.empty())
+	{
+		std::ofstream file(csvFilename.c_str());
+		if (!file.is_open())
+		{
+			std::cout << "Could not write shader benchmark results to " << csvFilename << std::endl;
+			return(1);
+		}
+
+		file << "workload,variant,width,height,gpu_ms,wall_ms,gpu_ns_per_pixel\n";
+		for (int w = 0; w < WORKLOAD_COUNT; w++)
+		{
+			for (int v = 0; v < g_VariantCount; v++)
+			{
+				for (int r = 0; r < g_ResolutionCount; r++)
+				{
+					const MEASUREMENT& measurement = results[(w * g_VariantCount + v) * g_ResolutionCount + r];
+					double pixels = (double)g_Resolutions[r].width * g_Resolutions[r].height;
+					file << g_WorkloadNames[w] << ",\"" << g_Variants[v].name << "\","
+						<< g_Resolutions[r].width << "," << g_Resolutions[r].height << ","
+						<< measurement.gpuMilliseconds << "," << measurement.wallMilliseconds << ","
+						<< measurement.gpuMilliseconds * 1.0e6 / pixels << "\n";
+				}
+			}
+		}
+		for (int p = 0; p < g_SamplerPolicyCount; p++)
+		{
+			for (int r = 0; r < g_ResolutionCount; r++)
+			{
+				const MEASUREMENT& measurement = samplerResults[p * g_ResolutionCount + r];
+				double pixels = (double)g_Resolutions[r].width * g_Resolutions[r].height;
+				file << g_WorkloadNames[WORKLOAD_SURFACES] << " sampler,\"" << g_SamplerPolicies[p].name << "\","
+					<< g_Resolutions[r].width << "," << g_Resolutions[r].height << ","
+					<< measurement.gpuMilliseconds << "," << measurement.wallMilliseconds << ","
+					<< measurement.gpuMilliseconds * 1.0e6 / pixels << "\n";
+			}
+		}
+		std::cout << "INFO: Shader benchmark results written to " << csvFilename << std::endl;
+	}
+
+	return(0);
+}
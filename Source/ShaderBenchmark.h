@@ -0,0 +1,33 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderbenchmark.h
+// ============
+// measure the scene shader - the cost of each variant and light setup
+//
+//  The scene shader takes different paths for lit and unlit objects,
+//  textured and plain ones, and for each active light.  Each path is drawn
+//  offscreen at several resolutions, over the whole screen, as a field of
+//  objects and as a floor between walls, and timed with GPU timer queries
+//  and the wall clock.  The floor and walls are also timed with each way of
+//  filtering their texture.  The result is printed as a cost matrix, and can
+//  be written as CSV to compare runs.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <string>
+
+/***********************************************************
+ *  ShaderBenchmark
+ *
+ *  This class contains the code for timing the variants of
+ *  the scene shader.
+ ***********************************************************/
+class ShaderBenchmark
+{
+public:
+	// time every variant with the scene shader already loaded,
+	// writing the results to a CSV file when one is named
+	static int Run(ShaderManager* pShaderManager, const std::string& csvFilename);
+};
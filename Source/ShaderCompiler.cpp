@@ -0,0 +1,455 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadercompiler.cpp
+// ============
+// compile shader programs - without waiting for the driver
+//
+//  Asking for a compile or link status makes the driver finish that work
+//  first, so the status is only read once the driver says it is done.
+//  Without GL_KHR_parallel_shader_compile there is no way to ask, and one
+//  program is finished per frame so the wait is spread out.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderCompiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// the fallback program takes the same vertex layout and
+	// transform uniforms as the scene shader, and shades the
+	// object color from a fixed light
+	const char* g_FallbackVertexShader =
+		"#version 330 core\n"
+		"layout (location = 0) in vec3 inVertexPosition;\n"
+		"layout (location = 1) in vec3 inVertexNormal;\n"
+		"out vec3 fragmentVertexNormal;\n"
+		"uniform mat4 model;\n"
+		"uniform mat4 view;\n"
+		"uniform mat4 projection;\n"
+		"void main()\n"
+		"{\n"
+		"   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0);\n"
+		"   fragmentVertexNormal = mat3(model) * inVertexNormal;\n"
+		"}\n";
+
+	// virtual texture feedback drawn with the fallback program
+	// asks for no pages
+	const char* g_FallbackFragmentShader =
+		"#version 330 core\n"
+		"in vec3 fragmentVertexNormal;\n"
+		"out vec4 fragmentColor;\n"
+		"uniform vec4 objectColor = vec4(1.0);\n"
+		"uniform bool bVirtualFeedback = false;\n"
+		"void main()\n"
+		"{\n"
+		"   if (bVirtualFeedback)\n"
+		"   {\n"
+		"      fragmentColor = vec4(0.0);\n"
+		"      return;\n"
+		"   }\n"
+		"   vec3 normal = normalize(fragmentVertexNormal);\n"
+		"   float light = 0.4 + 0.6 * max(dot(normal, normalize(vec3(0.3, 1.0, 0.3))), 0.0);\n"
+		"   fragmentColor = vec4(objectColor.rgb * light, objectColor.a);\n"
+		"}\n";
+}
+
+/***********************************************************
+ *  ShaderCompiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderCompiler::ShaderCompiler()
+{
+	m_bInitialized = false;
+	m_bParallelCompile = false;
+}
+
+/***********************************************************
+ *  ~ShaderCompiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderCompiler::~ShaderCompiler()
+{
+	Release();
+}
+
+/***********************************************************
+ *  ReadShaderFile()
+ *
+ *  This method is used for reading the text of a shader
+ *  file.
+ ***********************************************************/
+bool ShaderCompiler::ReadShaderFile(const char* filename, std::string& text)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open shader file " << filename << std::endl;
+		return(false);
+	}
+	std::stringstream source;
+	source << file.rdbuf();
+	text = source.str();
+	return(true);
+}
+
+/***********************************************************
+ *  AddDefines()
+ *
+ *  This method is used for putting the #define lines of a
+ *  variant into shader source.  They must follow the
+ *  #version line, which has to come first.
+ ***********************************************************/
+std::string ShaderCompiler::AddDefines(const std::string& source, const std::string& defines)
+{
+	if (defines.empty())
+	{
+		return(source);
+	}
+
+	size_t insert = 0;
+	size_t version = source.find("#version");
+	if (version != std::string::npos)
+	{
+		size_t lineEnd = source.find('\n', version);
+		insert = (lineEnd == std::string::npos) ? source.size() : lineEnd + 1;
+	}
+
+	std::string text = source.substr(0, insert);
+	if (!text.empty() && (text.back() != '\n'))
+	{
+		text += '\n';
+	}
+	text += defines;
+	if (defines.back() != '\n')
+	{
+		text += '\n';
+	}
+	text += source.substr(insert);
+	return(text);
+}
+
+/***********************************************************
+ *  StartShader()
+ *
+ *  This method is used for handing shader source to the
+ *  driver.  The status is not read, so the call returns
+ *  while the driver may still be compiling.
+ ***********************************************************/
+GLuint ShaderCompiler::StartShader(GLenum type, const std::string& source)
+{
+	const char* pText = source.c_str();
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &pText, NULL);
+	glCompileShader(shader);
+	return(shader);
+}
+
+/***********************************************************
+ *  PrintShaderLog()
+ *
+ *  This method is used for printing why a shader did not
+ *  compile.
+ ***********************************************************/
+void ShaderCompiler::PrintShaderLog(GLuint shader, const std::string& name, const char* stage)
+{
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		std::cout << "Could not compile " << stage << " shader of " << name << "\n" << log << std::endl;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for compiling the fallback program,
+ *  which is small enough to wait for, and letting the
+ *  driver compile on as many threads as it likes.
+ ***********************************************************/
+bool ShaderCompiler::Initialize()
+{
+	if (m_bInitialized)
+	{
+		return(true);
+	}
+
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		m_bParallelCompile = true;
+	}
+	else if (GLEW_ARB_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		m_bParallelCompile = true;
+	}
+
+	GLuint vertexShader = StartShader(GL_VERTEX_SHADER, g_FallbackVertexShader);
+	GLuint fragmentShader = StartShader(GL_FRAGMENT_SHADER, g_FallbackFragmentShader);
+	m_fallbackProgram.Create("ShaderCompiler");
+	glAttachShader(m_fallbackProgram.Get(), vertexShader);
+	glAttachShader(m_fallbackProgram.Get(), fragmentShader);
+	glLinkProgram(m_fallbackProgram.Get());
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(m_fallbackProgram.Get(), GL_LINK_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		PrintShaderLog(vertexShader, "fallback program", "vertex");
+		PrintShaderLog(fragmentShader, "fallback program", "fragment");
+		m_fallbackProgram.Reset();
+	}
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	if (!m_fallbackProgram.IsValid())
+	{
+		return(false);
+	}
+
+	std::cout << "INFO: Shader programs compile "
+		<< (m_bParallelCompile ? "in parallel" : "one per frame") << std::endl;
+
+	m_bInitialized = true;
+	return(true);
+}
+
+/***********************************************************
+ *  IsParallelCompile()
+ *
+ *  This method is used for checking whether the driver
+ *  compiles programs on its own threads.
+ ***********************************************************/
+bool ShaderCompiler::IsParallelCompile() const
+{
+	return(m_bParallelCompile);
+}
+
+/***********************************************************
+ *  AddProgram()
+ *
+ *  This method is used for starting the compile and link of
+ *  a program.  Linking is asked for straight away, since
+ *  the driver waits for the shaders itself.  Returns -1
+ *  when a shader file could not be read.
+ ***********************************************************/
+int ShaderCompiler::AddProgram(
+	const std::string& name,
+	const char* vertexFilename,
+	const char* fragmentFilename,
+	const std::string& defines)
+{
+	std::string vertexSource;
+	std::string fragmentSource;
+	if (!ReadShaderFile(vertexFilename, vertexSource) ||
+		!ReadShaderFile(fragmentFilename, fragmentSource))
+	{
+		return(-1);
+	}
+
+	PROGRAM program;
+	program.name = name;
+	program.vertexShader = StartShader(GL_VERTEX_SHADER, AddDefines(vertexSource, defines));
+	program.fragmentShader = StartShader(GL_FRAGMENT_SHADER, AddDefines(fragmentSource, defines));
+	program.program.Create("ShaderCompiler");
+	glAttachShader(program.program.Get(), program.vertexShader);
+	glAttachShader(program.program.Get(), program.fragmentShader);
+	glLinkProgram(program.program.Get());
+	program.state = PROGRAM_COMPILING;
+	program.start = std::chrono::steady_clock::now();
+
+	m_programs.push_back(std::move(program));
+	return((int)m_programs.size() - 1);
+}
+
+/***********************************************************
+ *  IsProgramComplete()
+ *
+ *  This method is used for asking the driver whether a
+ *  program has finished linking, which never blocks.
+ *  Without parallel compiling it cannot be asked, and
+ *  every program counts as complete.
+ ***********************************************************/
+bool ShaderCompiler::IsProgramComplete(const PROGRAM& program) const
+{
+	if (!m_bParallelCompile)
+	{
+		return(true);
+	}
+
+	GLint complete = GL_FALSE;
+	glGetProgramiv(program.program.Get(), GL_COMPLETION_STATUS_KHR, &complete);
+	return(complete == GL_TRUE);
+}
+
+/***********************************************************
+ *  FinishProgram()
+ *
+ *  This method is used for reading the link status of a
+ *  program and freeing its shaders.  A program that did not
+ *  link is freed, and the fallback program is kept for it.
+ ***********************************************************/
+void ShaderCompiler::FinishProgram(PROGRAM& program)
+{
+	GLint status = GL_FALSE;
+	glGetProgramiv(program.program.Get(), GL_LINK_STATUS, &status);
+	if (status == GL_TRUE)
+	{
+		program.state = PROGRAM_READY;
+		double milliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - program.start).count();
+		std::cout << "INFO: Shader program " << program.name << " ready after "
+			<< (int)milliseconds << " ms" << std::endl;
+	}
+	else
+	{
+		PrintShaderLog(program.vertexShader, program.name, "vertex");
+		PrintShaderLog(program.fragmentShader, program.name, "fragment");
+		char log[1024];
+		glGetProgramInfoLog(program.program.Get(), sizeof(log), NULL, log);
+		std::cout << "Could not link shader program " << program.name << "\n" << log << std::endl;
+		program.program.Reset();
+		program.state = PROGRAM_FAILED;
+	}
+
+	if (program.program.IsValid())
+	{
+		glDetachShader(program.program.Get(), program.vertexShader);
+		glDetachShader(program.program.Get(), program.fragmentShader);
+	}
+	glDeleteShader(program.vertexShader);
+	glDeleteShader(program.fragmentShader);
+	program.vertexShader = 0;
+	program.fragmentShader = 0;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for finishing the programs the
+ *  driver is done with.  Without parallel compiling the
+ *  first program waiting is finished, one per frame.
+ ***********************************************************/
+void ShaderCompiler::Update()
+{
+	for (PROGRAM& program : m_programs)
+	{
+		if (program.state != PROGRAM_COMPILING)
+		{
+			continue;
+		}
+		if (!IsProgramComplete(program))
+		{
+			continue;
+		}
+		FinishProgram(program);
+		if (!m_bParallelCompile)
+		{
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  WaitForPrograms()
+ *
+ *  This method is used for finishing every program being
+ *  compiled, for uses that cannot draw with the fallback.
+ ***********************************************************/
+void ShaderCompiler::WaitForPrograms()
+{
+	for (PROGRAM& program : m_programs)
+	{
+		if (program.state == PROGRAM_COMPILING)
+		{
+			FinishProgram(program);
+		}
+	}
+}
+
+/***********************************************************
+ *  GetProgramState()
+ *
+ *  This method is used for getting whether a program is
+ *  still compiling, ready or failed.
+ ***********************************************************/
+ShaderCompiler::PROGRAM_STATE ShaderCompiler::GetProgramState(int index) const
+{
+	if ((index < 0) || (index >= (int)m_programs.size()))
+	{
+		return(PROGRAM_FAILED);
+	}
+	return(m_programs[index].state);
+}
+
+/***********************************************************
+ *  GetCompilingCount()
+ *
+ *  This method is used for getting the number of programs
+ *  still being compiled.
+ ***********************************************************/
+int ShaderCompiler::GetCompilingCount() const
+{
+	int count = 0;
+	for (const PROGRAM& program : m_programs)
+	{
+		if (program.state == PROGRAM_COMPILING)
+		{
+			count++;
+		}
+	}
+	return(count);
+}
+
+/***********************************************************
+ *  GetProgram()
+ *
+ *  This method is used for getting the program to draw
+ *  with, which is the fallback program until the program
+ *  asked for has linked.
+ ***********************************************************/
+GLuint ShaderCompiler::GetProgram(int index) const
+{
+	if (GetProgramState(index) != PROGRAM_READY)
+	{
+		return(m_fallbackProgram.Get());
+	}
+	return(m_programs[index].program.Get());
+}
+
+/***********************************************************
+ *  GetFallbackProgram()
+ *
+ *  This method is used for getting the flat shaded program
+ *  drawn with until the others are ready.
+ ***********************************************************/
+GLuint ShaderCompiler::GetFallbackProgram() const
+{
+	return(m_fallbackProgram.Get());
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for freeing the programs and the
+ *  shaders of those still compiling.
+ ***********************************************************/
+void ShaderCompiler::Release()
+{
+	for (PROGRAM& program : m_programs)
+	{
+		glDeleteShader(program.vertexShader);
+		glDeleteShader(program.fragmentShader);
+	}
+	m_programs.clear();
+	m_fallbackProgram.Reset();
+	m_bInitialized = false;
+	m_bParallelCompile = false;
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadercompiler.h
+// ============
+// compile shader programs - without waiting for the driver
+//
+//  Every compile and link is issued as soon as a program is added, so the
+//  driver can work on all of them at once, on its own threads when
+//  GL_KHR_parallel_shader_compile is available.  Programs are polled once
+//  per frame and a small flat shaded program stands in for each one until
+//  it has linked.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceManager.h"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ShaderCompiler
+ *
+ *  This class contains the code for compiling and linking
+ *  shader programs in the background and handing out the
+ *  fallback program until they are ready.
+ ***********************************************************/
+class ShaderCompiler
+{
+public:
+	// constructor
+	ShaderCompiler();
+	// destructor
+	~ShaderCompiler();
+
+	enum PROGRAM_STATE
+	{
+		PROGRAM_COMPILING,
+		PROGRAM_READY,
+		PROGRAM_FAILED
+	};
+
+private:
+	// a program and the shaders it is linked from
+	struct PROGRAM
+	{
+		std::string name;
+		GLProgram program;
+		GLuint vertexShader;
+		GLuint fragmentShader;
+		PROGRAM_STATE state;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	bool m_bInitialized;
+	// the driver reports when a program is done without blocking
+	bool m_bParallelCompile;
+	GLProgram m_fallbackProgram;
+	std::vector<PROGRAM> m_programs;
+
+	static bool ReadShaderFile(const char* filename, std::string& text);
+	// put the defines of a variant after the version line
+	static std::string AddDefines(const std::string& source, const std::string& defines);
+	// start compiling a shader, without checking the result
+	static GLuint StartShader(GLenum type, const std::string& source);
+	static void PrintShaderLog(GLuint shader, const std::string& name, const char* stage);
+
+	// true when asking for the link status will not block
+	bool IsProgramComplete(const PROGRAM& program) const;
+	// check the link status and free the shaders
+	void FinishProgram(PROGRAM& program);
+
+public:
+	// compile the fallback program and turn on parallel compiling
+	bool Initialize();
+	bool IsParallelCompile() const;
+
+	// start compiling a program from a vertex and a fragment shader
+	// file, with optional #define lines for a variant, returning its
+	// index
+	int AddProgram(
+		const std::string& name,
+		const char* vertexFilename,
+		const char* fragmentFilename,
+		const std::string& defines = "");
+
+	// check the programs being compiled, once per frame
+	void Update();
+	// block until every program is ready or has failed
+	void WaitForPrograms();
+
+	PROGRAM_STATE GetProgramState(int index) const;
+	int GetCompilingCount() const;
+	// the linked program, or the fallback program until it is ready
+	GLuint GetProgram(int index) const;
+	GLuint GetFallbackProgram() const;
+
+	// free the programs
+	void Release();
+};
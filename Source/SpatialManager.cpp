@@ -0,0 +1,1503 @@
+///////////////////////////////////////////////////////////////////////////////
+// spatialmanager.cpp
+// ============
+// manage spatial queries against the 3D scene - picking, collision, proximity
+//
+//  The tree follows the usual dynamic AABB tree layout: leaves store fattened
+//  object bounds so small movements do not touch the tree, inner nodes are
+//  chosen by a surface area cost and rebalanced with AVL style rotations.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SpatialManager.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <thread>
+
+// declaration of global variables
+namespace
+{
+	// extra space added around leaf bounds so moving objects
+	// only need to be reinserted after leaving their fat box
+	const float g_FatMargin = 0.1f;
+	// depth of the traversal stacks kept without allocating,
+	// deeper trees carry on in a heap array
+	const int g_StackSize = 256;
+	// number of queries a thread claims from a batch at a time
+	const int g_MinBatchSize = 256;
+	// distance kept between a moved sphere and what it touched
+	const float g_SkinWidth = 0.01f;
+	// number of slide iterations when moving a sphere
+	const int g_MaxSlideIterations = 3;
+
+	// nodes still to visit in a traversal, in a fixed array for
+	// the usual depths and spilling to the heap past it, so no
+	// node is ever skipped however unbalanced the tree gets
+	struct NODE_STACK
+	{
+		int nodes[g_StackSize];
+		std::vector<int> overflow;
+		int count;
+
+		NODE_STACK()
+		{
+			count = 0;
+		}
+
+		void Push(int node)
+		{
+			if (count < g_StackSize)
+			{
+				nodes[count] = node;
+			}
+			else
+			{
+				overflow.push_back(node);
+			}
+			count++;
+		}
+
+		int Pop()
+		{
+			count--;
+			if (count < g_StackSize)
+			{
+				return(nodes[count]);
+			}
+			int node = overflow.back();
+			overflow.pop_back();
+			return(node);
+		}
+
+		bool IsEmpty() const
+		{
+			return(count == 0);
+		}
+	};
+
+	SpatialManager::AABB Union(const SpatialManager::AABB& a, const SpatialManager::AABB& b)
+	{
+		SpatialManager::AABB box;
+		box.min = glm::min(a.min, b.min);
+		box.max = glm::max(a.max, b.max);
+		return(box);
+	}
+
+	float SurfaceArea(const SpatialManager::AABB& box)
+	{
+		glm::vec3 size = box.max - box.min;
+		return(2.0f * (size.x * size.y + size.y * size.z + size.z * size.x));
+	}
+
+	bool Contains(const SpatialManager::AABB& outer, const SpatialManager::AABB& inner)
+	{
+		return(outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z &&
+			outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z);
+	}
+
+	bool Overlaps(const SpatialManager::AABB& a, const SpatialManager::AABB& b)
+	{
+		return(a.min.x <= b.max.x && a.max.x >= b.min.x &&
+			a.min.y <= b.max.y && a.max.y >= b.min.y &&
+			a.min.z <= b.max.z && a.max.z >= b.min.z);
+	}
+
+	bool OverlapsSphere(const SpatialManager::AABB& box, glm::vec3 center, float radius)
+	{
+		glm::vec3 closest = glm::clamp(center, box.min, box.max);
+		glm::vec3 offset = center - closest;
+		return(glm::dot(offset, offset) <= radius * radius);
+	}
+
+	// slab test of a ray against a box, with the ray direction
+	// passed as its reciprocal
+	bool RayBox(
+		glm::vec3 origin,
+		glm::vec3 inverseDirection,
+		const SpatialManager::AABB& box,
+		float maxDistance,
+		float& entryDistance)
+	{
+		glm::vec3 t1 = (box.min - origin) * inverseDirection;
+		glm::vec3 t2 = (box.max - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t1, t2);
+		glm::vec3 tFar = glm::max(t1, t2);
+		float tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+		entryDistance = tEnter;
+		return(tEnter <= tExit);
+	}
+
+	// two sided ray and triangle intersection (Moller-Trumbore)
+	bool RayTriangle(
+		glm::vec3 origin,
+		glm::vec3 direction,
+		const SpatialManager::TRIANGLE& triangle,
+		float& distance)
+	{
+		glm::vec3 edge1 = triangle.v1 - triangle.v0;
+		glm::vec3 edge2 = triangle.v2 - triangle.v0;
+		glm::vec3 p = glm::cross(direction, edge2);
+		float determinant = glm::dot(edge1, p);
+		if (std::fabs(determinant) < 1e-8f)
+		{
+			return(false);
+		}
+
+		float inverseDeterminant = 1.0f / determinant;
+		glm::vec3 s = origin - triangle.v0;
+		float u = glm::dot(s, p) * inverseDeterminant;
+		if (u < 0.0f || u > 1.0f)
+		{
+			return(false);
+		}
+		glm::vec3 q = glm::cross(s, edge1);
+		float v = glm::dot(direction, q) * inverseDeterminant;
+		if (v < 0.0f || u + v > 1.0f)
+		{
+			return(false);
+		}
+
+		distance = glm::dot(edge2, q) * inverseDeterminant;
+		return(distance >= 0.0f);
+	}
+
+	bool PointInTriangle(glm::vec3 point, const SpatialManager::TRIANGLE& triangle, glm::vec3 normal)
+	{
+		glm::vec3 c0 = glm::cross(triangle.v1 - triangle.v0, point - triangle.v0);
+		glm::vec3 c1 = glm::cross(triangle.v2 - triangle.v1, point - triangle.v1);
+		glm::vec3 c2 = glm::cross(triangle.v0 - triangle.v2, point - triangle.v2);
+		return(glm::dot(c0, normal) >= 0.0f && glm::dot(c1, normal) >= 0.0f && glm::dot(c2, normal) >= 0.0f);
+	}
+
+	glm::vec3 ClosestPointOnSegment(glm::vec3 point, glm::vec3 a, glm::vec3 b)
+	{
+		glm::vec3 ab = b - a;
+		float lengthSquared = glm::dot(ab, ab);
+		if (lengthSquared <= 0.0f)
+		{
+			return(a);
+		}
+		float t = glm::clamp(glm::dot(point - a, ab) / lengthSquared, 0.0f, 1.0f);
+		return(a + ab * t);
+	}
+
+	// earliest entering time of a ray against a sphere, t is
+	// measured in units of the (unnormalized) direction
+	bool RaySphere(glm::vec3 origin, glm::vec3 direction, glm::vec3 center, float radius, float& t)
+	{
+		glm::vec3 oc = origin - center;
+		float a = glm::dot(direction, direction);
+		float b = glm::dot(oc, direction);
+		float c = glm::dot(oc, oc) - radius * radius;
+		// starting inside or moving away is not an entering hit
+		if (c < 0.0f || b > 0.0f)
+		{
+			return(false);
+		}
+		float h = b * b - a * c;
+		if (h < 0.0f)
+		{
+			return(false);
+		}
+		t = (-b - std::sqrt(h)) / a;
+		return(true);
+	}
+
+	// earliest entering time of a ray against the side of a
+	// cylinder around segment ab, end caps are handled as spheres
+	bool RayCylinder(glm::vec3 origin, glm::vec3 direction, glm::vec3 a, glm::vec3 b, float radius, float& t)
+	{
+		glm::vec3 ba = b - a;
+		glm::vec3 oc = origin - a;
+		float baba = glm::dot(ba, ba);
+		float bard = glm::dot(ba, direction);
+		float baoc = glm::dot(ba, oc);
+		float k2 = baba * glm::dot(direction, direction) - bard * bard;
+		float k1 = baba * glm::dot(oc, direction) - baoc * bard;
+		float k0 = baba * glm::dot(oc, oc) - baoc * baoc - radius * radius * baba;
+		if (std::fabs(k2) < 1e-8f || k0 < 0.0f || k1 > 0.0f)
+		{
+			return(false);
+		}
+		float h = k1 * k1 - k2 * k0;
+		if (h < 0.0f)
+		{
+			return(false);
+		}
+		t = (-k1 - std::sqrt(h)) / k2;
+		float y = baoc + t * bard;
+		return(y > 0.0f && y < baba);
+	}
+
+	// earliest time a sphere moving along direction touches a
+	// triangle, with the contact normal pointing at the sphere
+	bool SweepSphereTriangle(
+		glm::vec3 start,
+		glm::vec3 direction,
+		float radius,
+		const SpatialManager::TRIANGLE& triangle,
+		float maxFraction,
+		float& fraction,
+		glm::vec3& normal)
+	{
+		glm::vec3 faceNormal = glm::cross(triangle.v1 - triangle.v0, triangle.v2 - triangle.v0);
+		float normalLength = glm::length(faceNormal);
+		if (normalLength < 1e-8f)
+		{
+			return(false);
+		}
+		faceNormal = faceNormal / normalLength;
+
+		// triangles are two sided, so face the sphere
+		float startDistance = glm::dot(start - triangle.v0, faceNormal);
+		if (startDistance < 0.0f)
+		{
+			faceNormal = -faceNormal;
+			startDistance = -startDistance;
+		}
+
+		float approach = glm::dot(direction, faceNormal);
+		bool bHit = false;
+		fraction = maxFraction;
+
+		// contact with the face of the triangle
+		if (approach < 0.0f)
+		{
+			float t = (radius - startDistance) / approach;
+			if (startDistance < radius)
+			{
+				// already touching the plane, only count it when
+				// the touch point is inside the triangle
+				t = 0.0f;
+			}
+			if (t >= 0.0f && t <= fraction)
+			{
+				glm::vec3 contact = start + direction * t - faceNormal * std::min(startDistance, radius);
+				if (PointInTriangle(contact, triangle, faceNormal))
+				{
+					fraction = t;
+					normal = faceNormal;
+					bHit = true;
+				}
+			}
+		}
+
+		// contact with the edges and corners of the triangle
+		const glm::vec3* vertices[3] = { &triangle.v0, &triangle.v1, &triangle.v2 };
+		for (int i = 0; i < 3; i++)
+		{
+			glm::vec3 a = *vertices[i];
+			glm::vec3 b = *vertices[(i + 1) % 3];
+			float t = 0.0f;
+
+			if (RayCylinder(start, direction, a, b, radius, t) && t >= 0.0f && t < fraction)
+			{
+				glm::vec3 center = start + direction * t;
+				fraction = t;
+				normal = glm::normalize(center - ClosestPointOnSegment(center, a, b));
+				bHit = true;
+			}
+			if (RaySphere(start, direction, a, radius, t) && t >= 0.0f && t < fraction)
+			{
+				fraction = t;
+				normal = glm::normalize(start + direction * t - a);
+				bHit = true;
+			}
+		}
+
+		return(bHit);
+	}
+
+	void AppendBoxTriangles(glm::vec3 min, glm::vec3 max, std::vector<SpatialManager::TRIANGLE>& triangles)
+	{
+		glm::vec3 corners[8];
+		for (int i = 0; i < 8; i++)
+		{
+			corners[i] = glm::vec3(
+				(i & 1) ? max.x : min.x,
+				(i & 2) ? max.y : min.y,
+				(i & 4) ? max.z : min.z);
+		}
+		const int faces[6][4] = {
+			{ 0, 2, 3, 1 }, { 4, 5, 7, 6 },
+			{ 0, 1, 5, 4 }, { 2, 6, 7, 3 },
+			{ 0, 4, 6, 2 }, { 1, 3, 7, 5 } };
+		for (int f = 0; f < 6; f++)
+		{
+			triangles.push_back({ corners[faces[f][0]], corners[faces[f][1]], corners[faces[f][2]] });
+			triangles.push_back({ corners[faces[f][0]], corners[faces[f][2]], corners[faces[f][3]] });
+		}
+	}
+
+	double ElapsedMicroseconds(std::chrono::high_resolution_clock::time_point start)
+	{
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start;
+		return(elapsed.count());
+	}
+}
+
+/***********************************************************
+ *  SpatialManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SpatialManager::SpatialManager()
+{
+	m_root = -1;
+	m_freeNode = -1;
+
+	m_pBatchFunction = NULL;
+	m_batchCount = 0;
+	m_nextBatchRange = 0;
+	m_batchGeneration = 0;
+	m_busyWorkers = 0;
+	m_bStopWorkers = false;
+
+	// the thread asking for a batch works on it too
+	int workerCount = (int)std::thread::hardware_concurrency() - 1;
+	for (int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&SpatialManager::WorkerLoop, this));
+	}
+}
+
+/***********************************************************
+ *  ~SpatialManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SpatialManager::~SpatialManager()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_batchMutex);
+		m_bStopWorkers = true;
+	}
+	m_batchStart.notify_all();
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+	m_workers.clear();
+
+	Clear();
+}
+
+/***********************************************************
+ *  RunBatch()
+ *
+ *  This method is used for running a function over a range
+ *  of indices.  When there is more than one range of work,
+ *  the worker threads are woken to share it, and this
+ *  returns once they have all finished.
+ ***********************************************************/
+void SpatialManager::RunBatch(int count, const std::function<void(int)>& function) const
+{
+	if (m_workers.empty() || (count <= g_MinBatchSize))
+	{
+		for (int i = 0; i < count; i++)
+		{
+			function(i);
+		}
+		return;
+	}
+
+	std::lock_guard<std::mutex> batchLock(m_batchRunMutex);
+	{
+		std::lock_guard<std::mutex> lock(m_batchMutex);
+		m_pBatchFunction = &function;
+		m_batchCount = count;
+		m_nextBatchRange = 0;
+		m_busyWorkers = (int)m_workers.size();
+		m_batchGeneration++;
+	}
+	m_batchStart.notify_all();
+
+	RunBatchRanges();
+
+	// every worker has to be done with the batch before the
+	// next one can change it
+	std::unique_lock<std::mutex> lock(m_batchMutex);
+	m_batchFinish.wait(lock, [this]() { return(m_busyWorkers == 0); });
+	m_pBatchFunction = NULL;
+}
+
+/***********************************************************
+ *  RunBatchRanges()
+ *
+ *  This method is used for claiming ranges of the current
+ *  batch and running them, until every range is claimed.
+ ***********************************************************/
+void SpatialManager::RunBatchRanges() const
+{
+	while (true)
+	{
+		int begin = m_nextBatchRange.fetch_add(1) * g_MinBatchSize;
+		if (begin >= m_batchCount)
+		{
+			return;
+		}
+		int end = std::min(m_batchCount, begin + g_MinBatchSize);
+		for (int i = begin; i < end; i++)
+		{
+			(*m_pBatchFunction)(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is used for running a worker thread, which
+ *  waits for a batch, helps run it, and waits again until
+ *  the manager is destroyed.
+ ***********************************************************/
+void SpatialManager::WorkerLoop()
+{
+	int generation = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_batchMutex);
+			m_batchStart.wait(lock, [this, generation]()
+				{
+					return(m_bStopWorkers || (m_batchGeneration != generation));
+				});
+			if (m_bStopWorkers)
+			{
+				return;
+			}
+			generation = m_batchGeneration;
+		}
+
+		RunBatchRanges();
+
+		std::lock_guard<std::mutex> lock(m_batchMutex);
+		m_busyWorkers--;
+		if (m_busyWorkers == 0)
+		{
+			m_batchFinish.notify_one();
+		}
+	}
+}
+
+/***********************************************************
+ *  AllocateNode()
+ *
+ *  This method is used for taking a node from the free list,
+ *  growing the node pool when the free list is empty.
+ ***********************************************************/
+int SpatialManager::AllocateNode()
+{
+	int node = m_freeNode;
+
+	if (node == -1)
+	{
+		node = (int)m_nodes.size();
+		m_nodes.push_back(TREE_NODE());
+	}
+	else
+	{
+		m_freeNode = m_nodes[node].parent;
+	}
+
+	m_nodes[node].parent = -1;
+	m_nodes[node].child1 = -1;
+	m_nodes[node].child2 = -1;
+	m_nodes[node].height = 0;
+	m_nodes[node].objectID = -1;
+
+	return(node);
+}
+
+/***********************************************************
+ *  FreeNode()
+ *
+ *  This method is used for returning a node to the free list.
+ ***********************************************************/
+void SpatialManager::FreeNode(int node)
+{
+	m_nodes[node].parent = m_freeNode;
+	m_nodes[node].height = -1;
+	m_freeNode = node;
+}
+
+/***********************************************************
+ *  InsertLeaf()
+ *
+ *  This method is used for inserting a leaf next to the
+ *  sibling that gives the lowest surface area cost, then
+ *  refitting and rebalancing the ancestors.
+ ***********************************************************/
+void SpatialManager::InsertLeaf(int leaf)
+{
+	if (m_root == -1)
+	{
+		m_root = leaf;
+		m_nodes[leaf].parent = -1;
+		return;
+	}
+
+	// find the best sibling for the new leaf
+	AABB leafBox = m_nodes[leaf].box;
+	int index = m_root;
+	while (m_nodes[index].child1 != -1)
+	{
+		int child1 = m_nodes[index].child1;
+		int child2 = m_nodes[index].child2;
+
+		float area = SurfaceArea(m_nodes[index].box);
+		float combinedArea = SurfaceArea(Union(m_nodes[index].box, leafBox));
+
+		// cost of creating a new parent for this node and the leaf
+		float cost = 2.0f * combinedArea;
+		// minimum cost of pushing the leaf further down the tree
+		float inheritanceCost = 2.0f * (combinedArea - area);
+
+		float cost1 = SurfaceArea(Union(leafBox, m_nodes[child1].box)) + inheritanceCost;
+		if (m_nodes[child1].child1 != -1)
+		{
+			cost1 -= SurfaceArea(m_nodes[child1].box);
+		}
+		float cost2 = SurfaceArea(Union(leafBox, m_nodes[child2].box)) + inheritanceCost;
+		if (m_nodes[child2].child1 != -1)
+		{
+			cost2 -= SurfaceArea(m_nodes[child2].box);
+		}
+
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+		index = (cost1 < cost2) ? child1 : child2;
+	}
+
+	// create a new parent for the sibling and the leaf
+	int sibling = index;
+	int oldParent = m_nodes[sibling].parent;
+	int newParent = AllocateNode();
+	m_nodes[newParent].parent = oldParent;
+	m_nodes[newParent].box = Union(leafBox, m_nodes[sibling].box);
+	m_nodes[newParent].height = m_nodes[sibling].height + 1;
+	m_nodes[newParent].child1 = sibling;
+	m_nodes[newParent].child2 = leaf;
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+
+	if (oldParent != -1)
+	{
+		if (m_nodes[oldParent].child1 == sibling)
+			m_nodes[oldParent].child1 = newParent;
+		else
+			m_nodes[oldParent].child2 = newParent;
+	}
+	else
+	{
+		m_root = newParent;
+	}
+
+	// walk back up the tree fixing heights and bounds
+	index = m_nodes[leaf].parent;
+	while (index != -1)
+	{
+		index = Balance(index);
+
+		int child1 = m_nodes[index].child1;
+		int child2 = m_nodes[index].child2;
+		m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+		m_nodes[index].box = Union(m_nodes[child1].box, m_nodes[child2].box);
+
+		index = m_nodes[index].parent;
+	}
+}
+
+/***********************************************************
+ *  RemoveLeaf()
+ *
+ *  This method is used for removing a leaf from the tree,
+ *  replacing its parent with its sibling.
+ ***********************************************************/
+void SpatialManager::RemoveLeaf(int leaf)
+{
+	if (leaf == m_root)
+	{
+		m_root = -1;
+		return;
+	}
+
+	int parent = m_nodes[leaf].parent;
+	int grandParent = m_nodes[parent].parent;
+	int sibling = (m_nodes[parent].child1 == leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+	if (grandParent != -1)
+	{
+		// connect the sibling to the grand parent
+		if (m_nodes[grandParent].child1 == parent)
+			m_nodes[grandParent].child1 = sibling;
+		else
+			m_nodes[grandParent].child2 = sibling;
+		m_nodes[sibling].parent = grandParent;
+		FreeNode(parent);
+
+		// fix the ancestors
+		int index = grandParent;
+		while (index != -1)
+		{
+			index = Balance(index);
+
+			int child1 = m_nodes[index].child1;
+			int child2 = m_nodes[index].child2;
+			m_nodes[index].box = Union(m_nodes[child1].box, m_nodes[child2].box);
+			m_nodes[index].height = 1 + std::max(m_nodes[child1].height, m_nodes[child2].height);
+
+			index = m_nodes[index].parent;
+		}
+	}
+	else
+	{
+		m_root = sibling;
+		m_nodes[sibling].parent = -1;
+		FreeNode(parent);
+	}
+}
+
+/***********************************************************
+ *  Balance()
+ *
+ *  This method is used for rotating the subtree at node A
+ *  when its children differ in height by more than one.
+ *  Returns the node that now sits at A's position.
+ ***********************************************************/
+int SpatialManager::Balance(int iA)
+{
+	TREE_NODE& A = m_nodes[iA];
+	if (A.child1 == -1 || A.height < 2)
+	{
+		return(iA);
+	}
+
+	int iB = A.child1;
+	int iC = A.child2;
+	TREE_NODE& B = m_nodes[iB];
+	TREE_NODE& C = m_nodes[iC];
+
+	int balance = C.height - B.height;
+
+	// rotate C up
+	if (balance > 1)
+	{
+		int iF = C.child1;
+		int iG = C.child2;
+		TREE_NODE& F = m_nodes[iF];
+		TREE_NODE& G = m_nodes[iG];
+
+		// swap A and C
+		C.child1 = iA;
+		C.parent = A.parent;
+		A.parent = iC;
+
+		// A's old parent should point to C
+		if (C.parent != -1)
+		{
+			if (m_nodes[C.parent].child1 == iA)
+				m_nodes[C.parent].child1 = iC;
+			else
+				m_nodes[C.parent].child2 = iC;
+		}
+		else
+		{
+			m_root = iC;
+		}
+
+		// rotate
+		if (F.height > G.height)
+		{
+			C.child2 = iF;
+			A.child2 = iG;
+			G.parent = iA;
+			A.box = Union(B.box, G.box);
+			C.box = Union(A.box, F.box);
+			A.height = 1 + std::max(B.height, G.height);
+			C.height = 1 + std::max(A.height, F.height);
+		}
+		else
+		{
+			C.child2 = iG;
+			A.child2 = iF;
+			F.parent = iA;
+			A.box = Union(B.box, F.box);
+			C.box = Union(A.box, G.box);
+			A.height = 1 + std::max(B.height, F.height);
+			C.height = 1 + std::max(A.height, G.height);
+		}
+
+		return(iC);
+	}
+
+	// rotate B up
+	if (balance < -1)
+	{
+		int iD = B.child1;
+		int iE = B.child2;
+		TREE_NODE& D = m_nodes[iD];
+		TREE_NODE& E = m_nodes[iE];
+
+		// swap A and B
+		B.child1 = iA;
+		B.parent = A.parent;
+		A.parent = iB;
+
+		// A's old parent should point to B
+		if (B.parent != -1)
+		{
+			if (m_nodes[B.parent].child1 == iA)
+				m_nodes[B.parent].child1 = iB;
+			else
+				m_nodes[B.parent].child2 = iB;
+		}
+		else
+		{
+			m_root = iB;
+		}
+
+		// rotate
+		if (D.height > E.height)
+		{
+			B.child2 = iD;
+			A.child1 = iE;
+			E.parent = iA;
+			A.box = Union(C.box, E.box);
+			B.box = Union(A.box, D.box);
+			A.height = 1 + std::max(C.height, E.height);
+			B.height = 1 + std::max(A.height, D.height);
+		}
+		else
+		{
+			B.child2 = iE;
+			A.child1 = iD;
+			D.parent = iA;
+			A.box = Union(C.box, D.box);
+			B.box = Union(A.box, E.box);
+			A.height = 1 + std::max(C.height, D.height);
+			B.height = 1 + std::max(A.height, E.height);
+		}
+
+		return(iB);
+	}
+
+	return(iA);
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for registering an object and its
+ *  world space triangles with the tree.
+ ***********************************************************/
+int SpatialManager::AddObject(
+	std::string tag,
+	int userID,
+	const std::vector<TRIANGLE>& triangles,
+	bool bCollidable)
+{
+	int objectID = -1;
+
+	if (m_freeObjects.empty() == false)
+	{
+		objectID = m_freeObjects.back();
+		m_freeObjects.pop_back();
+	}
+	else
+	{
+		objectID = (int)m_objects.size();
+		m_objects.push_back(SPATIAL_OBJECT());
+	}
+
+	SPATIAL_OBJECT& object = m_objects[objectID];
+	object.tag = tag;
+	object.userID = userID;
+	object.bCollidable = bCollidable;
+	object.bActive = true;
+	object.node = -1;
+
+	UpdateObject(objectID, triangles);
+
+	return(objectID);
+}
+
+/***********************************************************
+ *  UpdateObject()
+ *
+ *  This method is used for replacing the triangles of an
+ *  object.  The tree is only touched when the new bounds
+ *  leave the fattened bounds of the leaf.
+ ***********************************************************/
+void SpatialManager::UpdateObject(int objectID, const std::vector<TRIANGLE>& triangles)
+{
+	if (objectID < 0 || objectID >= (int)m_objects.size() || m_objects[objectID].bActive == false)
+	{
+		return;
+	}
+
+	SPATIAL_OBJECT& object = m_objects[objectID];
+	object.triangles = triangles;
+
+	AABB bounds;
+	bounds.min = glm::vec3(0.0f);
+	bounds.max = glm::vec3(0.0f);
+	if (triangles.empty() == false)
+	{
+		bounds.min = bounds.max = triangles[0].v0;
+		for (const TRIANGLE& triangle : triangles)
+		{
+			bounds.min = glm::min(bounds.min, glm::min(triangle.v0, glm::min(triangle.v1, triangle.v2)));
+			bounds.max = glm::max(bounds.max, glm::max(triangle.v0, glm::max(triangle.v1, triangle.v2)));
+		}
+	}
+	object.bounds = bounds;
+
+	if (object.node != -1)
+	{
+		if (Contains(m_nodes[object.node].box, bounds))
+		{
+			return;
+		}
+		RemoveLeaf(object.node);
+	}
+	else
+	{
+		object.node = AllocateNode();
+		m_nodes[object.node].objectID = objectID;
+	}
+
+	m_nodes[object.node].box.min = bounds.min - glm::vec3(g_FatMargin);
+	m_nodes[object.node].box.max = bounds.max + glm::vec3(g_FatMargin);
+	InsertLeaf(object.node);
+}
+
+/***********************************************************
+ *  RemoveObject()
+ *
+ *  This method is used for removing an object from the tree
+ *  and releasing its slot for reuse.
+ ***********************************************************/
+void SpatialManager::RemoveObject(int objectID)
+{
+	if (objectID < 0 || objectID >= (int)m_objects.size() || m_objects[objectID].bActive == false)
+	{
+		return;
+	}
+
+	SPATIAL_OBJECT& object = m_objects[objectID];
+	RemoveLeaf(object.node);
+	FreeNode(object.node);
+	object.node = -1;
+	object.bActive = false;
+	object.triangles.clear();
+	m_freeObjects.push_back(objectID);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all objects.
+ ***********************************************************/
+void SpatialManager::Clear()
+{
+	m_nodes.clear();
+	m_objects.clear();
+	m_freeObjects.clear();
+	m_root = -1;
+	m_freeNode = -1;
+}
+
+/***********************************************************
+ *  GetObjectTag()
+ *
+ *  This method is used for getting the tag of an object.
+ ***********************************************************/
+std::string SpatialManager::GetObjectTag(int objectID) const
+{
+	if (objectID < 0 || objectID >= (int)m_objects.size())
+	{
+		return("");
+	}
+	return(m_objects[objectID].tag);
+}
+
+/***********************************************************
+ *  GetObjectUserID()
+ *
+ *  This method is used for getting the user ID of an object.
+ ***********************************************************/
+int SpatialManager::GetObjectUserID(int objectID) const
+{
+	if (objectID < 0 || objectID >= (int)m_objects.size())
+	{
+		return(-1);
+	}
+	return(m_objects[objectID].userID);
+}
+
+/***********************************************************
+ *  GetObjectCount()
+ *
+ *  This method is used for getting the number of objects.
+ ***********************************************************/
+int SpatialManager::GetObjectCount() const
+{
+	return((int)(m_objects.size() - m_freeObjects.size()));
+}
+
+/***********************************************************
+ *  GetTreeHeight()
+ *
+ *  This method is used for getting the height of the tree.
+ ***********************************************************/
+int SpatialManager::GetTreeHeight() const
+{
+	if (m_root == -1)
+	{
+		return(0);
+	}
+	return(m_nodes[m_root].height);
+}
+
+/***********************************************************
+ *  RayCastObject()
+ *
+ *  This method is used for finding the closest triangle of
+ *  an object hit by a ray.  Objects without triangles are
+ *  tested against their bounds.
+ ***********************************************************/
+bool SpatialManager::RayCastObject(
+	const SPATIAL_OBJECT& object,
+	const RAY& ray,
+	float maxDistance,
+	RAY_HIT& hit) const
+{
+	bool bHit = false;
+	float closest = maxDistance;
+
+	if (object.triangles.empty())
+	{
+		glm::vec3 inverseDirection = 1.0f / ray.direction;
+		float distance = 0.0f;
+		if (RayBox(ray.origin, inverseDirection, object.bounds, closest, distance))
+		{
+			hit.distance = distance;
+			hit.normal = -ray.direction;
+			bHit = true;
+		}
+	}
+	else
+	{
+		for (const TRIANGLE& triangle : object.triangles)
+		{
+			float distance = 0.0f;
+			if (RayTriangle(ray.origin, ray.direction, triangle, distance) && distance < closest)
+			{
+				closest = distance;
+				hit.distance = distance;
+				hit.normal = glm::normalize(glm::cross(triangle.v1 - triangle.v0, triangle.v2 - triangle.v0));
+				bHit = true;
+			}
+		}
+		// report the side of the triangle facing the ray
+		if (bHit && glm::dot(hit.normal, ray.direction) > 0.0f)
+		{
+			hit.normal = -hit.normal;
+		}
+	}
+
+	if (bHit)
+	{
+		hit.point = ray.origin + ray.direction * hit.distance;
+	}
+
+	return(bHit);
+}
+
+/***********************************************************
+ *  RayCast()
+ *
+ *  This method is used for finding the closest object hit
+ *  by a ray, returning false when nothing is hit.
+ ***********************************************************/
+bool SpatialManager::RayCast(const RAY& ray, RAY_HIT& hit) const
+{
+	hit.objectID = -1;
+	if (m_root == -1)
+	{
+		return(false);
+	}
+
+	RAY unitRay = ray;
+	unitRay.direction = glm::normalize(ray.direction);
+	glm::vec3 inverseDirection = 1.0f / unitRay.direction;
+	float closest = ray.maxDistance;
+
+	NODE_STACK stack;
+	stack.Push(m_root);
+
+	while (!stack.IsEmpty())
+	{
+		const TREE_NODE& node = m_nodes[stack.Pop()];
+
+		float entry = 0.0f;
+		if (!RayBox(unitRay.origin, inverseDirection, node.box, closest, entry))
+		{
+			continue;
+		}
+
+		if (node.child1 == -1)
+		{
+			RAY_HIT objectHit;
+			if (RayCastObject(m_objects[node.objectID], unitRay, closest, objectHit))
+			{
+				closest = objectHit.distance;
+				hit = objectHit;
+				hit.objectID = node.objectID;
+			}
+		}
+		else
+		{
+			// visit the nearer child first so farther boxes get culled
+			float entry1 = 0.0f;
+			float entry2 = 0.0f;
+			bool bHit1 = RayBox(unitRay.origin, inverseDirection, m_nodes[node.child1].box, closest, entry1);
+			bool bHit2 = RayBox(unitRay.origin, inverseDirection, m_nodes[node.child2].box, closest, entry2);
+			if (bHit1 && bHit2)
+			{
+				stack.Push((entry1 < entry2) ? node.child2 : node.child1);
+				stack.Push((entry1 < entry2) ? node.child1 : node.child2);
+			}
+			else if (bHit1)
+			{
+				stack.Push(node.child1);
+			}
+			else if (bHit2)
+			{
+				stack.Push(node.child2);
+			}
+		}
+	}
+
+	return(hit.objectID != -1);
+}
+
+/***********************************************************
+ *  RayCastBatch()
+ *
+ *  This method is used for casting many rays at once.  Each
+ *  result has an object ID of -1 when its ray hit nothing.
+ ***********************************************************/
+void SpatialManager::RayCastBatch(
+	const std::vector<RAY>& rays,
+	std::vector<RAY_HIT>& hits) const
+{
+	hits.resize(rays.size());
+	RunBatch((int)rays.size(), [this, &rays, &hits](int i)
+		{
+			RayCast(rays[i], hits[i]);
+		});
+}
+
+/***********************************************************
+ *  QuerySphere()
+ *
+ *  This method is used for finding all objects whose bounds
+ *  overlap a sphere.  Returns the number of objects found.
+ ***********************************************************/
+int SpatialManager::QuerySphere(glm::vec3 center, float radius, std::vector<int>& results) const
+{
+	results.clear();
+	if (m_root == -1)
+	{
+		return(0);
+	}
+
+	NODE_STACK stack;
+	stack.Push(m_root);
+
+	while (!stack.IsEmpty())
+	{
+		const TREE_NODE& node = m_nodes[stack.Pop()];
+		if (!OverlapsSphere(node.box, center, radius))
+		{
+			continue;
+		}
+
+		if (node.child1 == -1)
+		{
+			if (OverlapsSphere(m_objects[node.objectID].bounds, center, radius))
+			{
+				results.push_back(node.objectID);
+			}
+		}
+		else
+		{
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+
+	return((int)results.size());
+}
+
+/***********************************************************
+ *  QueryBox()
+ *
+ *  This method is used for finding all objects whose bounds
+ *  overlap a box.  Returns the number of objects found.
+ ***********************************************************/
+int SpatialManager::QueryBox(const AABB& box, std::vector<int>& results) const
+{
+	results.clear();
+	if (m_root == -1)
+	{
+		return(0);
+	}
+
+	NODE_STACK stack;
+	stack.Push(m_root);
+
+	while (!stack.IsEmpty())
+	{
+		const TREE_NODE& node = m_nodes[stack.Pop()];
+		if (!Overlaps(node.box, box))
+		{
+			continue;
+		}
+
+		if (node.child1 == -1)
+		{
+			if (Overlaps(m_objects[node.objectID].bounds, box))
+			{
+				results.push_back(node.objectID);
+			}
+		}
+		else
+		{
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+
+	return((int)results.size());
+}
+
+/***********************************************************
+ *  SweepObject()
+ *
+ *  This method is used for finding the earliest contact of
+ *  a moving sphere with the triangles of an object.
+ ***********************************************************/
+bool SpatialManager::SweepObject(
+	const SPATIAL_OBJECT& object,
+	const SWEEP& sweep,
+	float maxFraction,
+	SWEEP_HIT& hit) const
+{
+	bool bHit = false;
+	float closest = maxFraction;
+	glm::vec3 direction = sweep.end - sweep.start;
+
+	for (const TRIANGLE& triangle : object.triangles)
+	{
+		float fraction = 0.0f;
+		glm::vec3 normal;
+		if (SweepSphereTriangle(sweep.start, direction, sweep.radius, triangle, closest, fraction, normal) &&
+			fraction < closest)
+		{
+			closest = fraction;
+			hit.fraction = fraction;
+			hit.normal = normal;
+			bHit = true;
+		}
+	}
+
+	return(bHit);
+}
+
+/***********************************************************
+ *  SweepSphere()
+ *
+ *  This method is used for finding the first collidable
+ *  object touched by a sphere moving from start to end.
+ ***********************************************************/
+bool SpatialManager::SweepSphere(const SWEEP& sweep, SWEEP_HIT& hit) const
+{
+	hit.objectID = -1;
+	hit.fraction = 1.0f;
+
+	glm::vec3 direction = sweep.end - sweep.start;
+	if (m_root == -1 || glm::dot(direction, direction) < 1e-12f)
+	{
+		return(false);
+	}
+
+	glm::vec3 inverseDirection = 1.0f / direction;
+	glm::vec3 inflate = glm::vec3(sweep.radius);
+	float closest = 1.0f;
+
+	NODE_STACK stack;
+	stack.Push(m_root);
+
+	while (!stack.IsEmpty())
+	{
+		const TREE_NODE& node = m_nodes[stack.Pop()];
+
+		// the sphere touches the box when its center touches
+		// the box grown by the radius
+		AABB grown;
+		grown.min = node.box.min - inflate;
+		grown.max = node.box.max + inflate;
+		float entry = 0.0f;
+		if (!RayBox(sweep.start, inverseDirection, grown, closest, entry))
+		{
+			continue;
+		}
+
+		if (node.child1 == -1)
+		{
+			const SPATIAL_OBJECT& object = m_objects[node.objectID];
+			SWEEP_HIT objectHit;
+			if (object.bCollidable && SweepObject(object, sweep, closest, objectHit))
+			{
+				closest = objectHit.fraction;
+				hit = objectHit;
+				hit.objectID = node.objectID;
+			}
+		}
+		else
+		{
+			stack.Push(node.child1);
+			stack.Push(node.child2);
+		}
+	}
+
+	return(hit.objectID != -1);
+}
+
+/***********************************************************
+ *  SweepSphereBatch()
+ *
+ *  This method is used for sweeping many spheres at once.
+ ***********************************************************/
+void SpatialManager::SweepSphereBatch(
+	const std::vector<SWEEP>& sweeps,
+	std::vector<SWEEP_HIT>& hits) const
+{
+	hits.resize(sweeps.size());
+	RunBatch((int)sweeps.size(), [this, &sweeps, &hits](int i)
+		{
+			SweepSphere(sweeps[i], hits[i]);
+		});
+}
+
+/***********************************************************
+ *  MoveSphere()
+ *
+ *  This method is used for moving a sphere toward a target
+ *  position.  When the sphere touches something, the rest
+ *  of the motion slides along the touched surface.
+ ***********************************************************/
+glm::vec3 SpatialManager::MoveSphere(glm::vec3 start, glm::vec3 target, float radius) const
+{
+	glm::vec3 position = start;
+	glm::vec3 motion = target - start;
+
+	for (int i = 0; i < g_MaxSlideIterations; i++)
+	{
+		float distance = glm::length(motion);
+		if (distance < 1e-5f)
+		{
+			break;
+		}
+
+		SWEEP sweep;
+		sweep.start = position;
+		sweep.end = position + motion;
+		sweep.radius = radius;
+
+		SWEEP_HIT hit;
+		if (!SweepSphere(sweep, hit))
+		{
+			position += motion;
+			break;
+		}
+
+		// stop just short of the contact
+		float travel = std::max(hit.fraction * distance - g_SkinWidth, 0.0f);
+		position += motion * (travel / distance);
+
+		// slide the remaining motion along the contact plane
+		glm::vec3 remaining = motion * (1.0f - travel / distance);
+		motion = remaining - hit.normal * glm::dot(remaining, hit.normal);
+	}
+
+	return(position);
+}
+
+/***********************************************************
+ *  ScreenPointToRay()
+ *
+ *  This method is used for building the world space ray
+ *  that passes through a pixel of the display window.
+ ***********************************************************/
+SpatialManager::RAY SpatialManager::ScreenPointToRay(
+	float screenX,
+	float screenY,
+	int windowWidth,
+	int windowHeight,
+	const glm::mat4& view,
+	const glm::mat4& projection)
+{
+	float ndcX = (2.0f * screenX) / (float)windowWidth - 1.0f;
+	float ndcY = 1.0f - (2.0f * screenY) / (float)windowHeight;
+
+	glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+	glm::vec3 nearPosition = glm::vec3(nearPoint) / nearPoint.w;
+	glm::vec3 farPosition = glm::vec3(farPoint) / farPoint.w;
+
+	RAY ray;
+	ray.origin = nearPosition;
+	ray.direction = glm::normalize(farPosition - nearPosition);
+	ray.maxDistance = glm::length(farPosition - nearPosition);
+
+	return(ray);
+}
+
+/***********************************************************
+ *  RunBenchmark()
+ *
+ *  This method is used for measuring the query throughput
+ *  on a generated scene of randomly placed boxes.  Results
+ *  are written to the console.
+ ***********************************************************/
+void SpatialManager::RunBenchmark(int objectCount, int queryCount)
+{
+	SpatialManager spatial;
+	std::mt19937 random(330);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> size(0.2f, 3.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	// build the generated scene
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	std::vector<TRIANGLE> triangles;
+	for (int i = 0; i < objectCount; i++)
+	{
+		glm::vec3 center(position(random), position(random), position(random));
+		glm::vec3 halfSize(size(random), size(random), size(random));
+		triangles.clear();
+		AppendBoxTriangles(center - halfSize, center + halfSize, triangles);
+		spatial.AddObject("box", i, triangles, true);
+	}
+	double buildTime = ElapsedMicroseconds(start);
+
+	std::cout << "INFO: Spatial benchmark - " << objectCount << " objects, " << queryCount << " queries" << std::endl;
+	std::cout << "INFO:   build            " << buildTime / 1000.0 << " ms, tree height " << spatial.GetTreeHeight() << std::endl;
+
+	// generate the queries
+	std::vector<RAY> rays(queryCount);
+	std::vector<SWEEP> sweeps(queryCount);
+	std::vector<glm::vec3> centers(queryCount);
+	for (int i = 0; i < queryCount; i++)
+	{
+		glm::vec3 origin(position(random), position(random), position(random));
+		glm::vec3 direction(unit(random), unit(random), unit(random));
+		if (glm::dot(direction, direction) < 1e-4f)
+		{
+			direction = glm::vec3(0.0f, 0.0f, 1.0f);
+		}
+		direction = glm::normalize(direction);
+
+		rays[i].origin = origin;
+		rays[i].direction = direction;
+		rays[i].maxDistance = 400.0f;
+		sweeps[i].start = origin;
+		sweeps[i].end = origin + direction * 5.0f;
+		sweeps[i].radius = 0.5f;
+		centers[i] = origin;
+	}
+
+	// report one line of throughput for a timed query loop
+	auto report = [queryCount](const char* name, double microseconds, int hitCount)
+		{
+			std::cout << "INFO:   " << name
+				<< microseconds / 1000.0 << " ms, "
+				<< (microseconds * 1000.0) / queryCount << " ns/query, "
+				<< (queryCount / microseconds) * 1e6 << " queries/s, "
+				<< hitCount << " hits" << std::endl;
+		};
+
+	int hitCount = 0;
+	RAY_HIT rayHit;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		hitCount += spatial.RayCast(rays[i], rayHit) ? 1 : 0;
+	}
+	report("ray cast         ", ElapsedMicroseconds(start), hitCount);
+
+	std::vector<RAY_HIT> rayHits;
+	start = std::chrono::high_resolution_clock::now();
+	spatial.RayCastBatch(rays, rayHits);
+	double batchTime = ElapsedMicroseconds(start);
+	hitCount = 0;
+	for (const RAY_HIT& hit : rayHits)
+	{
+		hitCount += (hit.objectID != -1) ? 1 : 0;
+	}
+	report("ray cast batch   ", batchTime, hitCount);
+
+	std::vector<int> results;
+	hitCount = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		hitCount += spatial.QuerySphere(centers[i], 2.0f, results);
+	}
+	report("sphere overlap   ", ElapsedMicroseconds(start), hitCount);
+
+	hitCount = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		AABB box;
+		box.min = centers[i] - glm::vec3(2.0f);
+		box.max = centers[i] + glm::vec3(2.0f);
+		hitCount += spatial.QueryBox(box, results);
+	}
+	report("box overlap      ", ElapsedMicroseconds(start), hitCount);
+
+	hitCount = 0;
+	SWEEP_HIT sweepHit;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < queryCount; i++)
+	{
+		hitCount += spatial.SweepSphere(sweeps[i], sweepHit) ? 1 : 0;
+	}
+	report("sphere sweep     ", ElapsedMicroseconds(start), hitCount);
+
+	std::vector<SWEEP_HIT> sweepHits;
+	start = std::chrono::high_resolution_clock::now();
+	spatial.SweepSphereBatch(sweeps, sweepHits);
+	batchTime = ElapsedMicroseconds(start);
+	hitCount = 0;
+	for (const SWEEP_HIT& hit : sweepHits)
+	{
+		hitCount += (hit.objectID != -1) ? 1 : 0;
+	}
+	report("sphere sweep batch ", batchTime, hitCount);
+}
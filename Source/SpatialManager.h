@@ -0,0 +1,211 @@
+///////////////////////////////////////////////////////////////////////////////
+// spatialmanager.h
+// ============
+// manage spatial queries against the 3D scene - picking, collision, proximity
+//
+//  Scene objects are stored as leaves of a dynamic AABB tree, each leaf
+//  holding the world space triangles of the object for exact narrow phase
+//  tests.  Queries are read-only and may be issued from several threads.
+//  Batches of queries are shared out to worker threads that live as long
+//  as the manager, so a batch does not pay to start threads.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  SpatialManager
+ *
+ *  This class contains the code for building and querying
+ *  the bounding volume hierarchy over the scene objects.
+ ***********************************************************/
+class SpatialManager
+{
+public:
+	// constructor
+	SpatialManager();
+	// destructor
+	~SpatialManager();
+
+	struct AABB
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+
+	struct TRIANGLE
+	{
+		glm::vec3 v0;
+		glm::vec3 v1;
+		glm::vec3 v2;
+	};
+
+	struct RAY
+	{
+		glm::vec3 origin;
+		glm::vec3 direction;
+		float maxDistance;
+	};
+
+	struct RAY_HIT
+	{
+		int objectID;
+		float distance;
+		glm::vec3 point;
+		glm::vec3 normal;
+	};
+
+	struct SWEEP_HIT
+	{
+		int objectID;
+		// fraction of the sweep travelled before contact
+		float fraction;
+		glm::vec3 normal;
+	};
+
+	struct SWEEP
+	{
+		glm::vec3 start;
+		glm::vec3 end;
+		float radius;
+	};
+
+private:
+	struct TREE_NODE
+	{
+		// fattened bounds of the node
+		AABB box;
+		// parent node, or next free node while unused
+		int parent;
+		int child1;
+		int child2;
+		// leaf height is 0, unused nodes are -1
+		int height;
+		// object stored in a leaf node
+		int objectID;
+	};
+
+	struct SPATIAL_OBJECT
+	{
+		std::string tag;
+		int userID;
+		int node;
+		AABB bounds;
+		std::vector<TRIANGLE> triangles;
+		bool bCollidable;
+		bool bActive;
+	};
+
+	// nodes of the dynamic AABB tree
+	std::vector<TREE_NODE> m_nodes;
+	// root node of the tree, -1 when empty
+	int m_root;
+	// head of the free node list
+	int m_freeNode;
+	// objects registered with the tree
+	std::vector<SPATIAL_OBJECT> m_objects;
+	// unused object slots available for reuse
+	std::vector<int> m_freeObjects;
+
+	// worker threads that run batches of queries alongside the
+	// thread asking for them
+	std::vector<std::thread> m_workers;
+	// one batch runs at a time, when several threads ask at once
+	mutable std::mutex m_batchRunMutex;
+	mutable std::mutex m_batchMutex;
+	// wakes the workers for a new batch, and the asking thread
+	// once they are all done with it
+	mutable std::condition_variable m_batchStart;
+	mutable std::condition_variable m_batchFinish;
+	// the batch being run, its queries claimed a range at a time
+	mutable const std::function<void(int)>* m_pBatchFunction;
+	mutable int m_batchCount;
+	mutable std::atomic<int> m_nextBatchRange;
+	mutable int m_batchGeneration;
+	mutable int m_busyWorkers;
+	bool m_bStopWorkers;
+
+	// allocate and free tree nodes
+	int AllocateNode();
+	void FreeNode(int node);
+	// insert and remove leaves from the tree
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	// rotate the subtree at the passed node to keep the tree balanced
+	int Balance(int node);
+
+	// run a function over a range of indices, shared with the
+	// worker threads when there is enough work
+	void RunBatch(int count, const std::function<void(int)>& function) const;
+	// claim and run ranges of the current batch until none are left
+	void RunBatchRanges() const;
+	// worker thread loop
+	void WorkerLoop();
+
+	// narrow phase tests against the triangles of an object
+	bool RayCastObject(const SPATIAL_OBJECT& object, const RAY& ray, float maxDistance, RAY_HIT& hit) const;
+	bool SweepObject(const SPATIAL_OBJECT& object, const SWEEP& sweep, float maxFraction, SWEEP_HIT& hit) const;
+
+public:
+	// add an object with its world space triangles, returns its ID
+	int AddObject(
+		std::string tag,
+		int userID,
+		const std::vector<TRIANGLE>& triangles,
+		bool bCollidable);
+	// replace the triangles of an object that has moved
+	void UpdateObject(int objectID, const std::vector<TRIANGLE>& triangles);
+	// remove an object from the tree
+	void RemoveObject(int objectID);
+	// remove all objects from the tree
+	void Clear();
+
+	// get the tag and user ID of a registered object
+	std::string GetObjectTag(int objectID) const;
+	int GetObjectUserID(int objectID) const;
+	// get the number of active objects
+	int GetObjectCount() const;
+	// get the height of the tree, useful for checking balance
+	int GetTreeHeight() const;
+
+	// find the closest object hit by a ray
+	bool RayCast(const RAY& ray, RAY_HIT& hit) const;
+	// find the closest hits of many rays, spread across threads
+	void RayCastBatch(
+		const std::vector<RAY>& rays,
+		std::vector<RAY_HIT>& hits) const;
+
+	// find the objects whose bounds overlap a sphere or a box
+	int QuerySphere(glm::vec3 center, float radius, std::vector<int>& results) const;
+	int QueryBox(const AABB& box, std::vector<int>& results) const;
+
+	// find the first collidable object touched by a moving sphere
+	bool SweepSphere(const SWEEP& sweep, SWEEP_HIT& hit) const;
+	// sweep many spheres, spread across threads
+	void SweepSphereBatch(
+		const std::vector<SWEEP>& sweeps,
+		std::vector<SWEEP_HIT>& hits) const;
+	// move a sphere toward a target, sliding along what it touches
+	glm::vec3 MoveSphere(glm::vec3 start, glm::vec3 target, float radius) const;
+
+	// build a world space ray through a window pixel
+	static RAY ScreenPointToRay(
+		float screenX,
+		float screenY,
+		int windowWidth,
+		int windowHeight,
+		const glm::mat4& view,
+		const glm::mat4& projection);
+
+	// measure query throughput on a generated scene
+	static void RunBenchmark(int objectCount, int queryCount);
+};
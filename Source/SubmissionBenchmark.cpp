@@ -0,0 +1,410 @@
+///////////////////////////////////////////////////////////////////////////////
+// submissionbenchmark.cpp
+// ============
+// measure draw submission - the CPU cost of setting up each object
+//
+//  The CPU time of a frame is taken from the first uniform set to the
+//  return of the last draw call, and the GPU is waited for before the next
+//  frame starts, so the driver never holds frames back and the two are not
+//  mixed up.  The median of the measured frames is reported.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SubmissionBenchmark.h"
+#include "GLRenderBackend.h"
+#include "RenderTarget.h"
+#include "ShapeMeshes.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// an object of the field, like a scene object
+	struct BENCHMARK_OBJECT
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		glm::vec2 UVscale;
+		bool bUseTexture;
+		int material;
+	};
+
+	// ways the draws are submitted
+	enum SUBMISSION_PATH
+	{
+		// every value set by name through the shader manager, as
+		// the scene drew its objects before the render backend
+		PATH_UNIFORMS_BY_NAME,
+		PATH_RENDER_BACKEND,
+		PATH_COUNT
+	};
+
+	const char* g_PathNames[PATH_COUNT] =
+	{
+		"uniforms by name",
+		"render backend"
+	};
+
+	// orders the objects are drawn in
+	enum DRAW_ORDER
+	{
+		// colors, textures and materials change from one object to
+		// the next, like objects placed room by room
+		ORDER_SCENE,
+		// objects sharing a material and texture are drawn together
+		ORDER_SORTED,
+		ORDER_COUNT
+	};
+
+	const char* g_OrderNames[ORDER_COUNT] =
+	{
+		"scene order",
+		"sorted by state"
+	};
+
+	const int g_ObjectRows = 64;
+	const int g_MaterialCount = 12;
+	const int g_WarmupFrames = 5;
+	const int g_MeasuredFrames = 30;
+	const int g_TargetWidth = 1280;
+	const int g_TargetHeight = 720;
+	const int g_TextureSize = 256;
+	// values the shader manager sets for each colored draw, and
+	// the one more a textured draw sets
+	const int g_NamedValuesPerDraw = 6;
+
+	// time of one measurement, in milliseconds per frame
+	struct MEASUREMENT
+	{
+		double cpuMilliseconds;
+		double frameMilliseconds;
+		// values written to the GPU per draw
+		double valuesPerDraw;
+	};
+
+	// small hash for repeatable object values
+	uint32_t HashIndex(uint32_t value)
+	{
+		value ^= value >> 16;
+		value *= 0x7feb352d;
+		value ^= value >> 15;
+		value *= 0x846ca68b;
+		value ^= value >> 16;
+		return(value);
+	}
+
+	// lay out the field of objects in front of the camera
+	void BuildObjects(std::vector<BENCHMARK_OBJECT>& objects)
+	{
+		float spacing = 0.5f;
+		float start = -0.5f * (g_ObjectRows - 1) * spacing;
+		for (int row = 0; row < g_ObjectRows; row++)
+		{
+			for (int column = 0; column < g_ObjectRows; column++)
+			{
+				uint32_t hash = HashIndex((uint32_t)(row * g_ObjectRows + column));
+				BENCHMARK_OBJECT object;
+				object.model = glm::translate(glm::vec3(start + column * spacing, start + row * spacing, -25.0f)) *
+					glm::scale(glm::vec3(0.3f));
+				object.color = glm::vec4(
+					(hash & 0xFF) / 255.0f, ((hash >> 8) & 0xFF) / 255.0f, ((hash >> 16) & 0xFF) / 255.0f, 1.0f);
+				object.bUseTexture = (hash & 0x1000000) != 0;
+				object.UVscale = glm::vec2((float)(1 + ((hash >> 25) & 3)));
+				object.material = (int)((hash >> 27) % g_MaterialCount);
+				objects.push_back(object);
+			}
+		}
+	}
+
+	// make the materials, shared by the two paths
+	void BuildMaterials(std::vector<RenderBackend::MATERIAL>& materials)
+	{
+		for (int i = 0; i < g_MaterialCount; i++)
+		{
+			RenderBackend::MATERIAL material;
+			material.diffuseColor = glm::vec3(0.3f + 0.05f * i, 0.5f, 0.8f - 0.05f * i);
+			material.specularColor = glm::vec3(0.1f * (i % 5));
+			material.shininess = (float)(1 << (i % 7));
+			material.sampler = SamplerManager::MakeDesc(SamplerManager::FILTER_TRILINEAR, (float)(1 << (i % 4)));
+			materials.push_back(material);
+		}
+	}
+
+	// make a plain checker texture on unit 0
+	GLuint CreateTexture()
+	{
+		std::vector<unsigned char> pixels((size_t)g_TextureSize * g_TextureSize * 4);
+		for (int y = 0; y < g_TextureSize; y++)
+		{
+			for (int x = 0; x < g_TextureSize; x++)
+			{
+				unsigned char value = (((x / 16) + (y / 16)) % 2 == 0) ? 200 : 80;
+				unsigned char* pPixel = &pixels[((size_t)y * g_TextureSize + x) * 4];
+				pPixel[0] = value;
+				pPixel[1] = value;
+				pPixel[2] = value;
+				pPixel[3] = 255;
+			}
+		}
+
+		GLuint texture = 0;
+		glGenTextures(1, &texture);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, g_TextureSize, g_TextureSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+		glGenerateMipmap(GL_TEXTURE_2D);
+		return(texture);
+	}
+
+	// set the values that stay the same for the whole frame
+	void SetFrameValues(ShaderManager* pShaderManager)
+	{
+		glm::vec3 eye = glm::vec3(0.0f, 0.0f, 0.0f);
+		pShaderManager->setMat4Value("view", glm::lookAt(eye, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+		pShaderManager->setMat4Value("projection", glm::perspective(
+			glm::radians(45.0f), (float)g_TargetWidth / g_TargetHeight, 0.1f, 100.0f));
+		pShaderManager->setVec3Value("viewPosition", eye);
+		pShaderManager->setBoolValue("bUseLighting", true);
+		pShaderManager->setBoolValue("bUseVirtualTexture", false);
+		pShaderManager->setBoolValue("bUseProceduralTexture", false);
+		pShaderManager->setBoolValue("bUseReflection", false);
+		pShaderManager->setBoolValue("directionalLight.bActive", true);
+		pShaderManager->setVec3Value("directionalLight.direction", glm::vec3(-0.3f, -1.0f, -0.4f));
+		pShaderManager->setVec3Value("directionalLight.ambient", glm::vec3(0.2f));
+		pShaderManager->setVec3Value("directionalLight.diffuse", glm::vec3(0.6f));
+		pShaderManager->setVec3Value("directionalLight.specular", glm::vec3(0.5f));
+	}
+
+	// draw the objects one way, returning the CPU time taken
+	double DrawObjects(
+		ShaderManager* pShaderManager,
+		RenderBackend& backend,
+		ShapeMeshes& meshes,
+		const std::vector<BENCHMARK_OBJECT>& objects,
+		const std::vector<RenderBackend::MATERIAL>& materials,
+		SUBMISSION_PATH path)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		if (path == PATH_UNIFORMS_BY_NAME)
+		{
+			for (const BENCHMARK_OBJECT& object : objects)
+			{
+				const RenderBackend::MATERIAL& material = materials[object.material];
+				pShaderManager->setMat4Value("model", object.model);
+				if (object.bUseTexture)
+				{
+					pShaderManager->setIntValue("bUseTexture", true);
+					pShaderManager->setSampler2DValue("objectTexture", 0);
+					pShaderManager->setVec2Value("UVscale", object.UVscale);
+					SamplerManager::BindSampler(0, SamplerManager::GetSampler(material.sampler));
+				}
+				else
+				{
+					pShaderManager->setIntValue("bUseTexture", false);
+					pShaderManager->setVec4Value("objectColor", object.color);
+				}
+				pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
+				pShaderManager->setVec3Value("material.specularColor", material.specularColor);
+				pShaderManager->setFloatValue("material.shininess", material.shininess);
+				meshes.DrawBoxMesh();
+			}
+		}
+		else
+		{
+			backend.BeginPass();
+			RenderBackend::DRAW_DATA draw;
+			for (const BENCHMARK_OBJECT& object : objects)
+			{
+				draw.model = object.model;
+				draw.color = object.color;
+				draw.UVscale = object.UVscale;
+				draw.bUseTexture = object.bUseTexture;
+				draw.textureSource = RenderBackend::TEXTURE_UNIT;
+				draw.texture = 0;
+				draw.material = object.material;
+				draw.bReflect = false;
+				backend.SetDrawData(draw);
+				meshes.DrawBoxMesh();
+			}
+		}
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		return(elapsed.count());
+	}
+
+	// draw the objects for the measured frames and time them
+	MEASUREMENT MeasurePath(
+		ShaderManager* pShaderManager,
+		RenderBackend& backend,
+		ShapeMeshes& meshes,
+		const std::vector<BENCHMARK_OBJECT>& objects,
+		const std::vector<RenderBackend::MATERIAL>& materials,
+		SUBMISSION_PATH path)
+	{
+		for (int frame = 0; frame < g_WarmupFrames; frame++)
+		{
+			DrawObjects(pShaderManager, backend, meshes, objects, materials, path);
+		}
+		glFinish();
+
+		backend.ResetStatistics();
+		std::vector<double> cpuMilliseconds(g_MeasuredFrames);
+		std::vector<double> frameMilliseconds(g_MeasuredFrames);
+		for (int frame = 0; frame < g_MeasuredFrames; frame++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			cpuMilliseconds[frame] = DrawObjects(pShaderManager, backend, meshes, objects, materials, path);
+			glFinish();
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			frameMilliseconds[frame] = elapsed.count();
+		}
+		std::nth_element(cpuMilliseconds.begin(), cpuMilliseconds.begin() + g_MeasuredFrames / 2, cpuMilliseconds.end());
+		std::nth_element(frameMilliseconds.begin(), frameMilliseconds.begin() + g_MeasuredFrames / 2, frameMilliseconds.end());
+
+		MEASUREMENT measurement;
+		measurement.cpuMilliseconds = cpuMilliseconds[g_MeasuredFrames / 2];
+		measurement.frameMilliseconds = frameMilliseconds[g_MeasuredFrames / 2];
+		if (path == PATH_UNIFORMS_BY_NAME)
+		{
+			int texturedDraws = 0;
+			for (const BENCHMARK_OBJECT& object : objects)
+			{
+				texturedDraws += object.bUseTexture ? 1 : 0;
+			}
+			measurement.valuesPerDraw = g_NamedValuesPerDraw + (double)texturedDraws / objects.size();
+		}
+		else
+		{
+			RenderBackend::STATISTICS statistics = backend.GetStatistics();
+			measurement.valuesPerDraw = (statistics.draws > 0) ?
+				(double)statistics.stateChanges / statistics.draws : 0.0;
+		}
+		return(measurement);
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for timing each way of submitting
+ *  the draws, in each order, and printing the results.
+ *  Returns non-zero when it could not run.
+ ***********************************************************/
+int SubmissionBenchmark::Run(ShaderManager* pShaderManager, const std::string& csvFilename)
+{
+	if (NULL == pShaderManager)
+	{
+		return(1);
+	}
+
+	ShapeMeshes meshes;
+	meshes.LoadBoxMesh();
+	GLuint texture = CreateTexture();
+	RenderTarget renderTarget;
+	if (!renderTarget.Resize(g_TargetWidth, g_TargetHeight))
+	{
+		glDeleteTextures(1, &texture);
+		return(1);
+	}
+
+	std::vector<BENCHMARK_OBJECT> objects;
+	BuildObjects(objects);
+	std::vector<RenderBackend::MATERIAL> materials;
+	BuildMaterials(materials);
+	GLRenderBackend backend(pShaderManager, SamplerManager::MakeDesc(SamplerManager::FILTER_TRILINEAR));
+	for (const RenderBackend::MATERIAL& material : materials)
+	{
+		backend.CreateMaterial(material);
+	}
+
+	pShaderManager->use();
+	renderTarget.Bind();
+	glEnable(GL_DEPTH_TEST);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	SetFrameValues(pShaderManager);
+
+	std::cout << "INFO: Timing the submission of " << objects.size() << " draws through the "
+		<< backend.GetName() << " backend" << std::endl;
+	MEASUREMENT results[ORDER_COUNT][PATH_COUNT];
+	for (int order = 0; order < ORDER_COUNT; order++)
+	{
+		if (order == ORDER_SORTED)
+		{
+			std::stable_sort(objects.begin(), objects.end(),
+				[](const BENCHMARK_OBJECT& first, const BENCHMARK_OBJECT& second)
+				{
+					if (first.material != second.material)
+					{
+						return(first.material < second.material);
+					}
+					return(first.bUseTexture && !second.bUseTexture);
+				});
+		}
+		for (int path = 0; path < PATH_COUNT; path++)
+		{
+			results[order][path] = MeasurePath(
+				pShaderManager, backend, meshes, objects, materials, (SUBMISSION_PATH)path);
+		}
+	}
+
+	renderTarget.Unbind();
+	SamplerManager::BindSampler(0, 0);
+	glDeleteTextures(1, &texture);
+
+	std::cout << "INFO: Draw submission, milliseconds per frame of " << objects.size() << " draws" << std::endl;
+	std::cout << "    " << std::left << std::setw(20) << "path" << std::setw(18) << "order" << std::right
+		<< std::setw(10) << "CPU ms" << std::setw(14) << "CPU us/draw" << std::setw(12) << "frame ms"
+		<< std::setw(14) << "values/draw" << std::endl;
+	for (int order = 0; order < ORDER_COUNT; order++)
+	{
+		for (int path = 0; path < PATH_COUNT; path++)
+		{
+			const MEASUREMENT& measurement = results[order][path];
+			std::cout << "    " << std::left << std::setw(20) << g_PathNames[path] << std::setw(18)
+				<< g_OrderNames[order] << std::right << std::fixed << std::setprecision(3)
+				<< std::setw(10) << measurement.cpuMilliseconds
+				<< std::setw(14) << measurement.cpuMilliseconds * 1000.0 / objects.size()
+				<< std::setw(12) << measurement.frameMilliseconds
+				<< std::setprecision(2) << std::setw(14) << measurement.valuesPerDraw << std::endl;
+		}
+	}
+	std::cout.unsetf(std::ios::floatfield);
+
+	if (!csvFilename.empty())
+	{
+		std::ofstream file(csvFilename.c_str());
+		if (!file.is_open())
+		{
+			std::cout << "Could not write submission benchmark results to " << csvFilename << std::endl;
+			return(1);
+		}
+
+		file << "path,order,draws,cpu_ms,cpu_us_per_draw,frame_ms,values_per_draw\n";
+		for (int order = 0; order < ORDER_COUNT; order++)
+		{
+			for (int path = 0; path < PATH_COUNT; path++)
+			{
+				const MEASUREMENT& measurement = results[order][path];
+				file << g_PathNames[path] << "," << g_OrderNames[order] << "," << objects.size() << ","
+					<< measurement.cpuMilliseconds << "," << measurement.cpuMilliseconds * 1000.0 / objects.size() << ","
+					<< measurement.frameMilliseconds << "," << measurement.valuesPerDraw << "\n";
+			}
+		}
+		std::cout << "INFO: Submission benchmark results written to " << csvFilename << std::endl;
+	}
+
+	return(0);
+}
@@ -0,0 +1,32 @@
+///////////////////////////////////////////////////////////////////////////////
+// submissionbenchmark.h
+// ============
+// measure draw submission - the CPU cost of setting up each object
+//
+//  A field of objects with a mix of colors, textures and materials is drawn
+//  offscreen, once setting the shader values by name the way the scene used
+//  to and once through the render backend.  The time spent on the CPU
+//  issuing the draws is measured separately from the time the GPU takes,
+//  in scene order and sorted by state, and printed per frame and per draw.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+
+#include <string>
+
+/***********************************************************
+ *  SubmissionBenchmark
+ *
+ *  This class contains the code for timing the CPU side of
+ *  drawing scene objects.
+ ***********************************************************/
+class SubmissionBenchmark
+{
+public:
+	// time each way of submitting the draws with the scene shader
+	// already loaded, writing the results to a CSV file when one
+	// is named
+	static int Run(ShaderManager* pShaderManager, const std::string& csvFilename);
+};
@@ -0,0 +1,355 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureformatmanager.cpp
+// ============
+// pick the smallest texture format that holds an image - channel reduction
+//
+//  One pass over the pixels measures how far they are from grey, from
+//  opaque, from a single color and from 16 bit color, as the largest change
+//  any channel of any texel would see.  The smallest format within the
+//  tolerance is picked, and a second pass packs the texels in place, which
+//  works because every format takes no more bytes a texel than the image.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureFormatManager.h"
+#include "MemoryManager.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// decoded formats by channel count
+	const TextureFormatManager::TEXTURE_FORMAT g_DecodedFormats[] =
+	{
+		TextureFormatManager::FORMAT_RGBA8,
+		TextureFormatManager::FORMAT_R8,
+		TextureFormatManager::FORMAT_RG8,
+		TextureFormatManager::FORMAT_RGB8,
+		TextureFormatManager::FORMAT_RGBA8
+	};
+
+	// grey level of a texel, rounded
+	int GetGrey(const unsigned char* pTexel)
+	{
+		return((pTexel[0] + pTexel[1] + pTexel[2] + 1) / 3);
+	}
+
+	// a channel rounded to a number of bits and back to 8 bits
+	int RoundToBits(int value, int maxValue)
+	{
+		int stored = (value * maxValue + 127) / 255;
+		return((stored * 255 + maxValue / 2) / maxValue);
+	}
+
+	uint16_t PackRGB565(const unsigned char* pTexel)
+	{
+		int red = (pTexel[0] * 31 + 127) / 255;
+		int green = (pTexel[1] * 63 + 127) / 255;
+		int blue = (pTexel[2] * 31 + 127) / 255;
+		return((uint16_t)((red << 11) | (green << 5) | blue));
+	}
+}
+
+/***********************************************************
+ *  Reduce()
+ *
+ *  This method is used for picking the smallest format that
+ *  holds the passed 8 bit pixels with no channel changing by
+ *  more than the tolerance, and packing the pixels in place
+ *  for it.  Images of one or two channels are read back as
+ *  grey, as the decoder meant.
+ ***********************************************************/
+TextureFormatManager::TEXTURE_LAYOUT TextureFormatManager::Reduce(
+	unsigned char* pPixels,
+	int width,
+	int height,
+	int channels,
+	int tolerance)
+{
+	TEXTURE_LAYOUT layout;
+	TEXTURE_FORMAT decodedFormat = g_DecodedFormats[std::min(std::max(channels, 0), 4)];
+	size_t texels = (size_t)width * height;
+
+	layout.format = decodedFormat;
+	layout.width = width;
+	layout.height = height;
+	layout.bGrayscale = (channels <= 2);
+	layout.bOpaque = (channels == 1) || (channels == 3);
+	layout.bConstant = false;
+	layout.largestChange = 0;
+	layout.decodedBytes = MemoryManager::GetTextureBytes(width, height, GetBytesPerTexel(decodedFormat), true);
+	layout.storedBytes = layout.decodedBytes;
+
+	if ((tolerance < 0) || (NULL == pPixels) || (texels <= 1) || (channels < 1) || (channels > 4))
+	{
+		return(layout);
+	}
+
+	// measure the largest change each reduction would make
+	int alphaChannel = ((channels == 2) || (channels == 4)) ? channels - 1 : -1;
+	int colorChannels = (channels >= 3) ? 3 : 1;
+	int greyChange = 0;
+	int alphaChange = 0;
+	int colorChange = 0;
+	int lowest[4] = { 255, 255, 255, 255 };
+	int highest[4] = { 0, 0, 0, 0 };
+	const unsigned char* pTexel = pPixels;
+	for (size_t i = 0; i < texels; i++, pTexel += channels)
+	{
+		for (int c = 0; c < channels; c++)
+		{
+			lowest[c] = std::min(lowest[c], (int)pTexel[c]);
+			highest[c] = std::max(highest[c], (int)pTexel[c]);
+		}
+		if (alphaChannel >= 0)
+		{
+			alphaChange = std::max(alphaChange, 255 - pTexel[alphaChannel]);
+		}
+		if (colorChannels == 3)
+		{
+			int grey = GetGrey(pTexel);
+			for (int c = 0; c < 3; c++)
+			{
+				greyChange = std::max(greyChange, std::abs(pTexel[c] - grey));
+			}
+			colorChange = std::max(colorChange, std::abs(pTexel[0] - RoundToBits(pTexel[0], 31)));
+			colorChange = std::max(colorChange, std::abs(pTexel[1] - RoundToBits(pTexel[1], 63)));
+			colorChange = std::max(colorChange, std::abs(pTexel[2] - RoundToBits(pTexel[2], 31)));
+		}
+	}
+
+	// a single color is stored as the middle of each channel range
+	unsigned char constant[4] = { 0, 0, 0, 255 };
+	int constantChange = 0;
+	for (int c = 0; c < channels; c++)
+	{
+		int middle = (lowest[c] + highest[c] + 1) / 2;
+		constantChange = std::max(constantChange, std::max(highest[c] - middle, middle - lowest[c]));
+		if (c < colorChannels)
+		{
+			constant[c] = (unsigned char)middle;
+		}
+		else
+		{
+			constant[3] = (unsigned char)middle;
+		}
+	}
+	if (colorChannels == 1)
+	{
+		constant[1] = constant[0];
+		constant[2] = constant[0];
+	}
+
+	layout.bGrayscale = layout.bGrayscale || (greyChange <= tolerance);
+	layout.bOpaque = layout.bOpaque || (alphaChange <= tolerance);
+	layout.bConstant = (constantChange <= tolerance) && (texels * channels >= 4);
+
+	if (layout.bConstant)
+	{
+		layout.format = FORMAT_CONSTANT;
+		layout.largestChange = constantChange;
+		layout.width = 1;
+		layout.height = 1;
+		memcpy(pPixels, constant, 4);
+	}
+	else
+	{
+		if (layout.bGrayscale && layout.bOpaque)
+		{
+			layout.format = FORMAT_R8;
+		}
+		else if (layout.bGrayscale)
+		{
+			layout.format = FORMAT_RG8;
+		}
+		else if (layout.bOpaque && (colorChange <= tolerance))
+		{
+			layout.format = FORMAT_RGB565;
+		}
+		else if (layout.bOpaque)
+		{
+			layout.format = FORMAT_RGB8;
+		}
+		else
+		{
+			layout.format = FORMAT_RGBA8;
+		}
+
+		if (layout.format != decodedFormat)
+		{
+			layout.largestChange = std::max(
+				(layout.bGrayscale && (colorChannels == 3)) ? greyChange : 0,
+				(layout.bOpaque && (alphaChannel >= 0)) ? alphaChange : 0);
+			if (layout.format == FORMAT_RGB565)
+			{
+				layout.largestChange = std::max(layout.largestChange, colorChange);
+			}
+
+			// every format takes no more bytes a texel than the
+			// image, so the texels are packed front to back in place
+			unsigned char* pPacked = pPixels;
+			pTexel = pPixels;
+			for (size_t i = 0; i < texels; i++, pTexel += channels)
+			{
+				unsigned char texel[4];
+				memcpy(texel, pTexel, channels);
+				int grey = (colorChannels == 3) ? GetGrey(texel) : texel[0];
+				unsigned char alpha = (alphaChannel >= 0) ? texel[alphaChannel] : 255;
+
+				switch (layout.format)
+				{
+				case FORMAT_R8:
+					*pPacked++ = (unsigned char)grey;
+					break;
+				case FORMAT_RG8:
+					*pPacked++ = (unsigned char)grey;
+					*pPacked++ = alpha;
+					break;
+				case FORMAT_RGB565:
+				{
+					uint16_t packed = PackRGB565(texel);
+					memcpy(pPacked, &packed, sizeof(packed));
+					pPacked += sizeof(packed);
+					break;
+				}
+				default:
+					*pPacked++ = texel[0];
+					*pPacked++ = texel[1];
+					*pPacked++ = texel[2];
+					break;
+				}
+			}
+		}
+	}
+
+	layout.storedBytes = MemoryManager::GetTextureBytes(layout.width, layout.height,
+		GetBytesPerTexel(layout.format), true);
+
+	return(layout);
+}
+
+/***********************************************************
+ *  GetInternalFormat()
+ *
+ *  This method is used for getting the format OpenGL stores
+ *  a texture in.
+ ***********************************************************/
+GLenum TextureFormatManager::GetInternalFormat(TEXTURE_FORMAT format)
+{
+	switch (format)
+	{
+	case FORMAT_RGB8:
+		return(GL_RGB8);
+	case FORMAT_RG8:
+		return(GL_RG8);
+	case FORMAT_R8:
+		return(GL_R8);
+	case FORMAT_RGB565:
+		return(GL_RGB565);
+	default:
+		return(GL_RGBA8);
+	}
+}
+
+/***********************************************************
+ *  GetPixelFormat()
+ *
+ *  This method is used for getting the channels of the
+ *  packed pixels uploaded.
+ ***********************************************************/
+GLenum TextureFormatManager::GetPixelFormat(TEXTURE_FORMAT format)
+{
+	switch (format)
+	{
+	case FORMAT_RGB8:
+	case FORMAT_RGB565:
+		return(GL_RGB);
+	case FORMAT_RG8:
+		return(GL_RG);
+	case FORMAT_R8:
+		return(GL_RED);
+	default:
+		return(GL_RGBA);
+	}
+}
+
+/***********************************************************
+ *  GetPixelType()
+ *
+ *  This method is used for getting the data type of the
+ *  packed pixels uploaded.
+ ***********************************************************/
+GLenum TextureFormatManager::GetPixelType(TEXTURE_FORMAT format)
+{
+	return((format == FORMAT_RGB565) ? GL_UNSIGNED_SHORT_5_6_5 : GL_UNSIGNED_BYTE);
+}
+
+/***********************************************************
+ *  GetSwizzle()
+ *
+ *  This method is used for getting the texture swizzle that
+ *  reads grey formats back as RGB, so the shader samples
+ *  every format the same way.
+ ***********************************************************/
+void TextureFormatManager::GetSwizzle(TEXTURE_FORMAT format, GLint swizzle[4])
+{
+	swizzle[0] = GL_RED;
+	swizzle[1] = GL_GREEN;
+	swizzle[2] = GL_BLUE;
+	swizzle[3] = GL_ALPHA;
+
+	if ((format == FORMAT_R8) || (format == FORMAT_RG8))
+	{
+		swizzle[1] = GL_RED;
+		swizzle[2] = GL_RED;
+		swizzle[3] = (format == FORMAT_RG8) ? GL_GREEN : GL_ONE;
+	}
+}
+
+/***********************************************************
+ *  GetBytesPerTexel()
+ *
+ *  This method is used for getting the bytes a driver keeps
+ *  per texel of a format, with RGB padded to four bytes.
+ ***********************************************************/
+int TextureFormatManager::GetBytesPerTexel(TEXTURE_FORMAT format)
+{
+	switch (format)
+	{
+	case FORMAT_RG8:
+	case FORMAT_RGB565:
+		return(2);
+	case FORMAT_R8:
+		return(1);
+	default:
+		return(4);
+	}
+}
+
+/***********************************************************
+ *  GetFormatName()
+ *
+ *  This method is used for getting the name of a format for
+ *  the console.
+ ***********************************************************/
+const char* TextureFormatManager::GetFormatName(TEXTURE_FORMAT format)
+{
+	switch (format)
+	{
+	case FORMAT_RGB8:
+		return("RGB8");
+	case FORMAT_RG8:
+		return("RG8");
+	case FORMAT_R8:
+		return("R8");
+	case FORMAT_RGB565:
+		return("RGB565");
+	case FORMAT_CONSTANT:
+		return("constant color");
+	default:
+		return("RGBA8");
+	}
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureformatmanager.h
+// ============
+// pick the smallest texture format that holds an image - channel reduction
+//
+//  Decoded images are always 8 bit RGB or RGBA, but many need less: grey
+//  images are stored in one channel, an alpha channel that is opaque
+//  everywhere is dropped, images of a single color become one texel, and
+//  others may fit 16 bits a texel.  A smaller format is only chosen when no
+//  texel changes by more than a tolerance, and the shader reads the stored
+//  channels back through the texture swizzle, so it needs no changes.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+/***********************************************************
+ *  TextureFormatManager
+ *
+ *  This class contains the code for analysing the pixels of
+ *  an image and packing them for the format picked.  It
+ *  holds no OpenGL objects, so everything is static and the
+ *  analysis can run on the decoding threads.
+ ***********************************************************/
+class TextureFormatManager
+{
+public:
+	enum TEXTURE_FORMAT
+	{
+		// as decoded, 4 bytes a texel once the driver pads RGB
+		FORMAT_RGBA8,
+		FORMAT_RGB8,
+		// grey with alpha, read back as RRRG
+		FORMAT_RG8,
+		// grey, read back as RRR1
+		FORMAT_R8,
+		// color in 16 bits, when it rounds within the tolerance
+		FORMAT_RGB565,
+		// a single texel of the average color
+		FORMAT_CONSTANT
+	};
+
+	// format chosen for an image, and what it was chosen from
+	struct TEXTURE_LAYOUT
+	{
+		TEXTURE_FORMAT format;
+		int width;
+		int height;
+		bool bGrayscale;
+		bool bOpaque;
+		bool bConstant;
+		// largest change of any channel in 8 bit levels
+		int largestChange;
+		// bytes stored with and without the reduction
+		size_t storedBytes;
+		size_t decodedBytes;
+	};
+
+	// pick a format for 8 bit pixels and pack them in place for
+	// it, no texel changing by more than a tolerance in 8 bit
+	// levels, or keep the decoded format with a tolerance below 0
+	static TEXTURE_LAYOUT Reduce(unsigned char* pPixels, int width, int height, int channels, int tolerance);
+
+	// OpenGL upload parameters of a format
+	static GLenum GetInternalFormat(TEXTURE_FORMAT format);
+	static GLenum GetPixelFormat(TEXTURE_FORMAT format);
+	static GLenum GetPixelType(TEXTURE_FORMAT format);
+	// how the shader reads the stored channels back
+	static void GetSwizzle(TEXTURE_FORMAT format, GLint swizzle[4]);
+	// bytes the driver keeps per texel
+	static int GetBytesPerTexel(TEXTURE_FORMAT format);
+	static const char* GetFormatName(TEXTURE_FORMAT format);
+};
@@ -1,278 +1,548 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.cpp
-// ============
-// manage the viewing of 3D objects within the viewport - camera, projection
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#include "ViewManager.h"
-
-// GLM Math Header inclusions
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/glm.hpp>
-#include <glm/gtx/transform.hpp>
-#include <glm/gtc/type_ptr.hpp>    
-
-// declaration of the global variables and defines
-namespace
-{
-	// Variables for window width and height
-	const int WINDOW_WIDTH = 1000;
-	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
-
-	// camera object used for viewing and interacting with
-	// the 3D scene
-	Camera* g_pCamera = nullptr;
-
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
-
-	// time between current frame and last frame
-	float gDeltaTime = 0.0f; 
-	float gLastFrame = 0.0f;
-
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
-}
-
-/***********************************************************
- *  ViewManager()
- *
- *  The constructor for the class
- ***********************************************************/
-ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
-{
-	// initialize the member variables
-	m_pShaderManager = pShaderManager;
-	m_pWindow = NULL;
-	g_pCamera = new Camera();
-	// default camera view parameters
-	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
-	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	g_pCamera->Zoom = 80;
-	g_pCamera->MovementSpeed = 20;
-}
-
-/***********************************************************
- *  ~ViewManager()
- *
- *  The destructor for the class
- ***********************************************************/
-ViewManager::~ViewManager()
-{
-	// free up allocated memory
-	m_pShaderManager = NULL;
-	m_pWindow = NULL;
-	if (NULL != g_pCamera)
-	{
-		delete g_pCamera;
-		g_pCamera = NULL;
-	}
-}
-
-/***********************************************************
- *  CreateDisplayWindow()
- *
- *  This method is used to create the main display window.
- ***********************************************************/
-GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
-{
-	GLFWwindow* window = nullptr;
-
-	// try to create the displayed OpenGL window
-	window = glfwCreateWindow(
-		WINDOW_WIDTH,
-		WINDOW_HEIGHT,
-		windowTitle,
-		NULL, NULL);
-	if (window == NULL)
-	{
-		std::cout << "Failed to create GLFW window" << std::endl;
-		glfwTerminate();
-		return NULL;
-	}
-	glfwMakeContextCurrent(window);
-
-	// tell GLFW to capture all mouse events
-	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-	// this callback is used to receive mouse moving events
-	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
-
-	// check if the camera object is valid
-	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
-
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	m_pWindow = window;
-
-	return(window);
-}
-
-/***********************************************************
- *  Mouse_Position_Callback()
- *
- *  This method is automatically called from GLFW whenever
- *  the mouse is moved within the active GLFW display window.
- ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
-{
-	// when the first mouse move event is received, this needs to be recorded so that
-	// all subsequent mouse moves can correctly calculate the X position offset and Y
-	// position offset for proper operation
-	if (gFirstMouse)
-	{
-		gLastX = xMousePos;
-		gLastY = yMousePos;
-		gFirstMouse = false;
-	}
-
-	// calculate the X offset and Y offset values for moving the 3D camera accordingly
-	float xOffset = xMousePos - gLastX;
-	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
-
-	// set the current positions into the last position variables
-	gLastX = xMousePos;
-	gLastY = yMousePos;
-
-	// move the 3D camera according to the calculated offsets
-	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
-}
-
-/***********************************************************
- *  ProcessKeyboardEvents()
- *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
- ***********************************************************/
-void ViewManager::ProcessKeyboardEvents()
-{
-	// close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-	{
-		glfwSetWindowShouldClose(m_pWindow, true);
-	}
-
-	// process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
-	}
-
-	// process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
-	}
-	// process camera up and down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
-	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
-	}
-	// Toggle view projection
-	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
-	{
-		bOrthographicProjection = false;
-
-		// Resets camera (perspective view)
-		g_pCamera->Position = glm::vec3(0.5f, 5.5f, 10.0f);
-		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Zoom = 80.0f;
-	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
-	{
-		bOrthographicProjection = true;
-
-		// Resets camera (orthographic view) 
-		g_pCamera->Position = glm::vec3(0.0f, 0.0f, 10.0f);
-		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Zoom = 45.0f;
-	}
-}
-
-/***********************************************************
- *  PrepareSceneView()
- *
- *  This method is used for preparing the 3D scene by loading
- *  the shapes, textures in memory to support the 3D scene 
- *  rendering
- ***********************************************************/
-void ViewManager::PrepareSceneView()
-{
-	glm::mat4 view;
-	glm::mat4 projection;
-
-	// per-frame timing
-	float currentFrame = glfwGetTime();
-	gDeltaTime = currentFrame - gLastFrame;
-	gLastFrame = currentFrame;
-
-	// process any keyboard events that may be waiting in the 
-	// event queue
-	ProcessKeyboardEvents();
-
-	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
-
-	if (bOrthographicProjection)
-	{
-		// Orthographic view (no depth perspective)
-		projection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.1f, 100.0f);
-
-		//Lock the camera to a fixed orthographic viewpoint
-		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
-		g_pCamera->Position = glm::vec3(0.0f, 0.0f, 10.0f);
-	}
-	else
-	{
-		// define the current projection matrix
-		projection = glm::perspective(glm::radians(g_pCamera->Zoom),
-			(GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
-	}
-
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
-	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-	}
-}
-void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset)
-{
-	// Adjust camera movement speed using scroll wheel
-	g_pCamera->MovementSpeed += static_cast<float>(yoffset);
-	// Limit camera speed to good normal values
-	if (g_pCamera->MovementSpeed < 1.0f)
-		g_pCamera->MovementSpeed = 1.0f;
-	if (g_pCamera->MovementSpeed > 50.0f)
-		g_pCamera->MovementSpeed = 50.0f;
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.cpp
+// ============
+// manage the viewing of 3D objects within the viewport - camera, projection
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ViewManager.h"
+
+// GLM Math Header inclusions
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>    
+
+// declaration of the global variables and defines
+namespace
+{
+	// Variables for window width and height
+	const int WINDOW_WIDTH = 1000;
+	const int WINDOW_HEIGHT = 800;
+	const char* g_ViewName = "view";
+	const char* g_ProjectionName = "projection";
+
+	// camera object used for viewing and interacting with
+	// the 3D scene
+	Camera* g_pCamera = nullptr;
+
+	// these variables are used for mouse movement processing
+	float gLastX = WINDOW_WIDTH / 2.0f;
+	float gLastY = WINDOW_HEIGHT / 2.0f;
+	bool gFirstMouse = true;
+
+	// time between current frame and last frame
+	float gDeltaTime = 0.0f; 
+	float gLastFrame = 0.0f;
+
+	// the following variable is false when orthographic projection
+	// is off and true when it is on
+	bool bOrthographicProjection = false;
+
+	// radius of the sphere that keeps the camera out of objects
+	const float CAMERA_RADIUS = 0.5f;
+	// the following variable is true while the pick button is held
+	bool bPickButtonDown = false;
+	// the following variables are true while their key is held
+	bool bSwitchSceneKeyDown = false;
+	bool bScreenshotKeyDown = false;
+	bool bRecordKeyDown = false;
+
+	// check for a key going down since the last check
+	bool KeyPressedOnce(bool bPressed, bool& bKeyDown)
+	{
+		bool bPressedOnce = bPressed && !bKeyDown;
+		bKeyDown = bPressed;
+		return(bPressedOnce);
+	}
+}
+
+/***********************************************************
+ *  ViewManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ViewManager::ViewManager(
+	ShaderManager *pShaderManager)
+{
+	// initialize the member variables
+	m_pShaderManager = pShaderManager;
+	m_pWindow = NULL;
+	m_pSpatialManager = NULL;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_bSceneSwitchRequested = false;
+	m_bScreenshotRequested = false;
+	m_bRecordToggleRequested = false;
+	g_pCamera = new Camera();
+	// default camera view parameters
+	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
+	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
+	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+	g_pCamera->Zoom = 80;
+	g_pCamera->MovementSpeed = 20;
+}
+
+/***********************************************************
+ *  ~ViewManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ViewManager::~ViewManager()
+{
+	// free up allocated memory
+	m_pShaderManager = NULL;
+	m_pWindow = NULL;
+	m_pSpatialManager = NULL;
+	if (NULL != g_pCamera)
+	{
+		delete g_pCamera;
+		g_pCamera = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateDisplayWindow()
+ *
+ *  This method is used to create the main display window.
+ ***********************************************************/
+GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
+{
+	GLFWwindow* window = nullptr;
+
+	// try to create the displayed OpenGL window
+	window = glfwCreateWindow(
+		WINDOW_WIDTH,
+		WINDOW_HEIGHT,
+		windowTitle,
+		NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return NULL;
+	}
+	glfwMakeContextCurrent(window);
+
+	// tell GLFW to capture all mouse events
+	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+	// this callback is used to receive mouse moving events
+	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+
+	// check if the camera object is valid
+	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Callback);
+
+	// enable blending for supporting tranparent rendering
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	m_pWindow = window;
+
+	return(window);
+}
+
+/***********************************************************
+ *  Mouse_Position_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the mouse is moved within the active GLFW display window.
+ ***********************************************************/
+void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+{
+	// when the first mouse move event is received, this needs to be recorded so that
+	// all subsequent mouse moves can correctly calculate the X position offset and Y
+	// position offset for proper operation
+	if (gFirstMouse)
+	{
+		gLastX = xMousePos;
+		gLastY = yMousePos;
+		gFirstMouse = false;
+	}
+
+	// calculate the X offset and Y offset values for moving the 3D camera accordingly
+	float xOffset = xMousePos - gLastX;
+	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
+
+	// set the current positions into the last position variables
+	gLastX = xMousePos;
+	gLastY = yMousePos;
+
+	// move the 3D camera according to the calculated offsets
+	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+}
+
+/***********************************************************
+ *  IsKeyDown()
+ *
+ *  This method is used for checking whether a key is held
+ *  down in the window or on a connected remote viewer.
+ ***********************************************************/
+bool ViewManager::IsKeyDown(int key) const
+{
+	if (glfwGetKey(m_pWindow, key) == GLFW_PRESS)
+	{
+		return(true);
+	}
+	return(m_remoteKeys.count(key) > 0);
+}
+
+/***********************************************************
+ *  ProcessKeyboardEvents()
+ *
+ *  This method is called to process any keyboard events
+ *  that may be waiting in the event queue.
+ ***********************************************************/
+void ViewManager::ProcessKeyboardEvents()
+{
+	// close the window if the escape key has been pressed
+	if (IsKeyDown(GLFW_KEY_ESCAPE))
+	{
+		glfwSetWindowShouldClose(m_pWindow, true);
+	}
+
+	// remember where the camera was before it moves
+	glm::vec3 previousPosition = g_pCamera->Position;
+
+	// process camera zooming in and out
+	if (IsKeyDown(GLFW_KEY_W))
+	{
+		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+	}
+	if (IsKeyDown(GLFW_KEY_S))
+	{
+		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+	}
+
+	// process camera panning left and right
+	if (IsKeyDown(GLFW_KEY_A))
+	{
+		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+	}
+	if (IsKeyDown(GLFW_KEY_D))
+	{
+		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+	}
+	// process camera up and down
+	if (IsKeyDown(GLFW_KEY_Q))
+	{
+		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
+	}
+	if (IsKeyDown(GLFW_KEY_E))
+	{
+		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+	}
+
+	// keep the camera from passing through the scene objects,
+	// sliding along walls and furniture instead
+	if ((NULL != m_pSpatialManager) && (false == bOrthographicProjection))
+	{
+		g_pCamera->Position = m_pSpatialManager->MoveSphere(
+			previousPosition,
+			g_pCamera->Position,
+			CAMERA_RADIUS);
+	}
+
+	// Toggle view projection
+	if (IsKeyDown(GLFW_KEY_P))
+	{
+		bOrthographicProjection = false;
+
+		// Resets camera (perspective view)
+		g_pCamera->Position = glm::vec3(0.5f, 5.5f, 10.0f);
+		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
+		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		g_pCamera->Zoom = 80.0f;
+	}
+	if (IsKeyDown(GLFW_KEY_O))
+	{
+		bOrthographicProjection = true;
+
+		// Resets camera (orthographic view) 
+		g_pCamera->Position = glm::vec3(0.0f, 0.0f, 10.0f);
+		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
+		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
+		g_pCamera->Zoom = 45.0f;
+	}
+
+	// request the next scene once per press of the key
+	if (KeyPressedOnce(IsKeyDown(GLFW_KEY_N), bSwitchSceneKeyDown))
+	{
+		m_bSceneSwitchRequested = true;
+	}
+	// capture a screenshot, or start and stop recording video
+	if (KeyPressedOnce(IsKeyDown(GLFW_KEY_F12), bScreenshotKeyDown))
+	{
+		m_bScreenshotRequested = true;
+	}
+	if (KeyPressedOnce(IsKeyDown(GLFW_KEY_F10), bRecordKeyDown))
+	{
+		m_bRecordToggleRequested = true;
+	}
+}
+
+/***********************************************************
+ *  PrepareSceneView()
+ *
+ *  This method is used for preparing the 3D scene by loading
+ *  the shapes, textures in memory to support the 3D scene 
+ *  rendering
+ ***********************************************************/
+void ViewManager::PrepareSceneView()
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+
+	// per-frame timing
+	float currentFrame = glfwGetTime();
+	gDeltaTime = currentFrame - gLastFrame;
+	gLastFrame = currentFrame;
+
+	// process any keyboard events that may be waiting in the 
+	// event queue
+	ProcessKeyboardEvents();
+
+	// get the current view matrix from the camera
+	view = g_pCamera->GetViewMatrix();
+
+	if (bOrthographicProjection)
+	{
+		// Orthographic view (no depth perspective)
+		projection = glm::ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.1f, 100.0f);
+
+		//Lock the camera to a fixed orthographic viewpoint
+		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
+		g_pCamera->Position = glm::vec3(0.0f, 0.0f, 10.0f);
+	}
+	else
+	{
+		// define the current projection matrix
+		projection = glm::perspective(glm::radians(g_pCamera->Zoom),
+			(GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+	}
+
+	// if the shader manager object is valid
+	if (NULL != m_pShaderManager)
+	{
+		// set the view matrix into the shader for proper rendering
+		m_pShaderManager->setMat4Value(g_ViewName, view);
+		// set the view matrix into the shader for proper rendering
+		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
+		// set the view position of the camera into the shader for proper rendering
+		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+	}
+
+	// keep the matrices of this frame for the other managers
+	m_view = view;
+	m_projection = projection;
+
+	// pick objects with the matrices used for this frame
+	ProcessPickEvents(view, projection);
+}
+
+/***********************************************************
+ *  ProcessPickEvents()
+ *
+ *  This method is used for reporting the scene object under
+ *  the center of the window when the left mouse button is
+ *  clicked.  The cursor is captured by the camera, so the
+ *  window center acts as the crosshair.
+ ***********************************************************/
+void ViewManager::ProcessPickEvents(const glm::mat4& view, const glm::mat4& projection)
+{
+	if (NULL == m_pSpatialManager)
+	{
+		return;
+	}
+
+	bool bButtonDown = (glfwGetMouseButton(m_pWindow, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS);
+
+	// only pick once for each click
+	if (bButtonDown && (false == bPickButtonDown))
+	{
+		SpatialManager::RAY ray = SpatialManager::ScreenPointToRay(
+			WINDOW_WIDTH / 2.0f,
+			WINDOW_HEIGHT / 2.0f,
+			WINDOW_WIDTH,
+			WINDOW_HEIGHT,
+			view,
+			projection);
+
+		SpatialManager::RAY_HIT hit;
+		if (m_pSpatialManager->RayCast(ray, hit))
+		{
+			std::cout << "INFO: Picked '" << m_pSpatialManager->GetObjectTag(hit.objectID)
+				<< "' at distance " << hit.distance << std::endl;
+		}
+		else
+		{
+			std::cout << "INFO: Picked nothing" << std::endl;
+		}
+	}
+	bPickButtonDown = bButtonDown;
+}
+
+/***********************************************************
+ *  SetSpatialManager()
+ *
+ *  This method is used for setting the spatial queries used
+ *  for camera collision and object picking.
+ ***********************************************************/
+void ViewManager::SetSpatialManager(SpatialManager* pSpatialManager)
+{
+	m_pSpatialManager = pSpatialManager;
+}
+void ViewManager::Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+	// Adjust camera movement speed using scroll wheel
+	g_pCamera->MovementSpeed += static_cast<float>(yoffset);
+	// Limit camera speed to good normal values
+	if (g_pCamera->MovementSpeed < 1.0f)
+		g_pCamera->MovementSpeed = 1.0f;
+	if (g_pCamera->MovementSpeed > 50.0f)
+		g_pCamera->MovementSpeed = 50.0f;
+}
+
+/***********************************************************
+ *  GetViewMatrix()
+ *
+ *  This method is used for getting the view matrix used for
+ *  the current frame.
+ ***********************************************************/
+glm::mat4 ViewManager::GetViewMatrix() const
+{
+	return(m_view);
+}
+
+/***********************************************************
+ *  GetProjectionMatrix()
+ *
+ *  This method is used for getting the projection matrix
+ *  used for the current frame.
+ ***********************************************************/
+glm::mat4 ViewManager::GetProjectionMatrix() const
+{
+	return(m_projection);
+}
+
+/***********************************************************
+ *  GetCameraPosition()
+ *
+ *  This method is used for getting the world position of
+ *  the camera.
+ ***********************************************************/
+glm::vec3 ViewManager::GetCameraPosition() const
+{
+	return(g_pCamera->Position);
+}
+
+/***********************************************************
+ *  ConsumeSceneSwitchRequest()
+ *
+ *  This method is used for checking whether the switch
+ *  scene key was pressed since the last check.
+ ***********************************************************/
+bool ViewManager::ConsumeSceneSwitchRequest()
+{
+	bool bRequested = m_bSceneSwitchRequested;
+	m_bSceneSwitchRequested = false;
+	return(bRequested);
+}
+
+/***********************************************************
+ *  ConsumeScreenshotRequest()
+ *
+ *  This method is used for checking whether the screenshot
+ *  key was pressed since the last check.
+ ***********************************************************/
+bool ViewManager::ConsumeScreenshotRequest()
+{
+	bool bRequested = m_bScreenshotRequested;
+	m_bScreenshotRequested = false;
+	return(bRequested);
+}
+
+/***********************************************************
+ *  ConsumeRecordToggleRequest()
+ *
+ *  This method is used for checking whether the record key
+ *  was pressed since the last check.
+ ***********************************************************/
+bool ViewManager::ConsumeRecordToggleRequest()
+{
+	bool bRequested = m_bRecordToggleRequested;
+	m_bRecordToggleRequested = false;
+	return(bRequested);
+}
+
+/***********************************************************
+ *  SetRemoteKey()
+ *
+ *  This method is used for recording a key pressed or
+ *  released on a remote viewer.
+ ***********************************************************/
+void ViewManager::SetRemoteKey(int key, bool bPressed)
+{
+	if (bPressed)
+	{
+		m_remoteKeys.insert(key);
+	}
+	else
+	{
+		m_remoteKeys.erase(key);
+	}
+}
+
+/***********************************************************
+ *  ProcessRemoteMouseMovement()
+ *
+ *  This method is used for turning the camera by a mouse
+ *  movement made on a remote viewer.
+ ***********************************************************/
+void ViewManager::ProcessRemoteMouseMovement(float xOffset, float yOffset)
+{
+	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+}
+
+/***********************************************************
+ *  ProcessRemoteScroll()
+ *
+ *  This method is used for applying a scroll wheel movement
+ *  made on a remote viewer.
+ ***********************************************************/
+void ViewManager::ProcessRemoteScroll(float yOffset)
+{
+	Mouse_Scroll_Callback(m_pWindow, 0.0, yOffset);
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for placing the camera on a scripted
+ *  path.  The yaw and pitch are updated too, so the mouse
+ *  turns the camera from where it was placed.
+ ***********************************************************/
+void ViewManager::SetCameraPose(glm::vec3 position, glm::vec3 target)
+{
+	glm::vec3 front = glm::normalize(target - position);
+
+	g_pCamera->Position = position;
+	g_pCamera->Front = front;
+	g_pCamera->Yaw = glm::degrees(atan2f(front.z, front.x));
+	g_pCamera->Pitch = glm::degrees(asinf(front.y));
+	g_pCamera->Right = glm::normalize(glm::cross(front, g_pCamera->WorldUp));
+	g_pCamera->Up = glm::normalize(glm::cross(g_pCamera->Right, front));
+}
+
+/***********************************************************
+ *  ClearRemoteInput()
+ *
+ *  This method is used for releasing the keys held by a
+ *  remote viewer.
+ ***********************************************************/
+void ViewManager::ClearRemoteInput()
+{
+	m_remoteKeys.clear();
 }
\ No newline at end of file
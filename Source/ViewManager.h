@@ -1,47 +1,91 @@
-///////////////////////////////////////////////////////////////////////////////
-// viewmanager.h
-// ============
-// manage the viewing of 3D objects within the viewport - camera, projection
-//
-//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
-//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
-///////////////////////////////////////////////////////////////////////////////
-
-#pragma once
-
-#include "ShaderManager.h"
-#include "camera.h"
-
-// GLFW library
-#include "GLFW/glfw3.h" 
-
-class ViewManager
-{
-public:
-	// constructor
-	ViewManager(
-		ShaderManager* pShaderManager);
-	// destructor
-	~ViewManager();
-
-	// mouse position callback for mouse interaction with the 3D scene
-	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
-	// mouse button callback for mouse button events
-	static void Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset);
-
-private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// active OpenGL display window
-	GLFWwindow* m_pWindow;
-
-	// process keyboard events for interaction with the 3D scene
-	void ProcessKeyboardEvents();
-
-public:
-	// create the initial OpenGL display window
-	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
-	
-	// prepare the conversion from 3D object display to 2D scene display
-	void PrepareSceneView();
+///////////////////////////////////////////////////////////////////////////////
+// viewmanager.h
+// ============
+// manage the viewing of 3D objects within the viewport - camera, projection
+//
+//  AUTHOR: Brian Battersby - SNHU Instructor / Computer Science
+//	Created for CS-330-Computational Graphics and Visualization, Nov. 1st, 2023
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "ShaderManager.h"
+#include "SpatialManager.h"
+#include "camera.h"
+
+// GLFW library
+#include "GLFW/glfw3.h" 
+
+#include <set>
+
+class ViewManager
+{
+public:
+	// constructor
+	ViewManager(
+		ShaderManager* pShaderManager);
+	// destructor
+	~ViewManager();
+
+	// mouse position callback for mouse interaction with the 3D scene
+	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+	// mouse button callback for mouse button events
+	static void Mouse_Scroll_Callback(GLFWwindow* window, double xoffset, double yoffset);
+
+private:
+	// pointer to shader manager object
+	ShaderManager* m_pShaderManager;
+	// active OpenGL display window
+	GLFWwindow* m_pWindow;
+	// spatial queries for camera collision and picking
+	SpatialManager* m_pSpatialManager;
+	// view and projection matrices of the current frame
+	glm::mat4 m_view;
+	glm::mat4 m_projection;
+	// true once the switch scene key has been pressed
+	bool m_bSceneSwitchRequested;
+	// true once the screenshot or record key has been pressed
+	bool m_bScreenshotRequested;
+	bool m_bRecordToggleRequested;
+	// keys held down on a remote viewer
+	std::set<int> m_remoteKeys;
+
+	// check whether a key is held, locally or on a remote viewer
+	bool IsKeyDown(int key) const;
+
+	// process keyboard events for interaction with the 3D scene
+	void ProcessKeyboardEvents();
+	// pick the scene object under the crosshair on mouse click
+	void ProcessPickEvents(const glm::mat4& view, const glm::mat4& projection);
+
+public:
+	// create the initial OpenGL display window
+	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
+	
+	// prepare the conversion from 3D object display to 2D scene display
+	void PrepareSceneView();
+
+	// set the spatial queries used for camera collision and picking
+	void SetSpatialManager(SpatialManager* pSpatialManager);
+
+	// get the view, projection and camera position of the current frame
+	glm::mat4 GetViewMatrix() const;
+	glm::mat4 GetProjectionMatrix() const;
+	glm::vec3 GetCameraPosition() const;
+	// place the camera at a position, looking at a target point
+	void SetCameraPose(glm::vec3 position, glm::vec3 target);
+
+	// check for a request to switch to the next scene, clearing it
+	bool ConsumeSceneSwitchRequest();
+	// check for a request to save a screenshot, clearing it
+	bool ConsumeScreenshotRequest();
+	// check for a request to start or stop recording, clearing it
+	bool ConsumeRecordToggleRequest();
+
+	// apply input events received from a remote viewer
+	void SetRemoteKey(int key, bool bPressed);
+	void ProcessRemoteMouseMovement(float xOffset, float yOffset);
+	void ProcessRemoteScroll(float yOffset);
+	// release the keys held by a remote viewer that went away
+	void ClearRemoteInput();
 };
\ No newline at end of file
@@ -0,0 +1,1128 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualtexturemanager.cpp
+// ============
+// manage virtual textures - pages streamed into a fixed size page cache
+//
+//  A tiled file holds every page of every mip level with its border, one
+//  after the other, so a page is read with one seek.  Pages are loaded
+//  coarsest first and stand in for the finer pages under them, and the
+//  least recently seen page is replaced when the cache is full.
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VirtualTextureManager.h"
+#include "MemoryManager.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+// declaration of global variables
+namespace
+{
+	// header at the start of a tiled file
+	struct TILED_FILE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		// size of the image file the pages were cut from, so a
+		// changed image is cut again
+		uint32_t sourceBytes;
+		uint32_t width;
+		uint32_t height;
+		uint32_t levels;
+		uint32_t pageSize;
+		uint32_t pageBorder;
+	};
+
+	const char g_TiledFileMagic[4] = { 'V', 'T', 'E', 'X' };
+	const uint32_t g_TiledFileVersion = 1;
+
+	// texels across a cache slot, and the bytes of a page in it
+	const int g_SlotSize = VirtualTextureManager::PAGE_SIZE + 2 * VirtualTextureManager::PAGE_BORDER;
+	const size_t g_PageBytes = (size_t)g_SlotSize * g_SlotSize * 4;
+
+	// the feedback pass is drawn at a fraction of the frame size,
+	// every few frames, into one of a few readback buffers
+	const int g_FeedbackScale = 8;
+	const int g_FeedbackFrameInterval = 2;
+	const int g_FeedbackBuffers = 2;
+	// pages read at once, and copied into the cache per frame
+	const int g_MaxPageLoads = 16;
+	const int g_MaxUploadsPerFrame = 8;
+	// page coordinates and texture numbers are written as bytes
+	const int g_MaxFeedbackValue = 255;
+	const double g_ReportSeconds = 5.0;
+
+	// size of a file in bytes, -1 when it cannot be opened
+	long GetFileBytes(const std::string& filename)
+	{
+		FILE* pFile = fopen(filename.c_str(), "rb");
+		if (NULL == pFile)
+		{
+			return(-1);
+		}
+		fseek(pFile, 0, SEEK_END);
+		long bytes = ftell(pFile);
+		fclose(pFile);
+		return(bytes);
+	}
+
+	// read the header of a tiled file, false when it is missing or
+	// was made differently
+	bool ReadTiledHeader(const std::string& filename, TILED_FILE_HEADER& header)
+	{
+		FILE* pFile = fopen(filename.c_str(), "rb");
+		if (NULL == pFile)
+		{
+			return(false);
+		}
+		bool bRead = (fread(&header, sizeof(header), 1, pFile) == 1);
+		fclose(pFile);
+
+		return(bRead &&
+			(memcmp(header.magic, g_TiledFileMagic, sizeof(g_TiledFileMagic)) == 0) &&
+			(header.version == g_TiledFileVersion) &&
+			(header.pageSize == VirtualTextureManager::PAGE_SIZE) &&
+			(header.pageBorder == VirtualTextureManager::PAGE_BORDER));
+	}
+
+	// the power of two closest to a size, at least one page
+	int RoundToPowerOfTwo(int size)
+	{
+		int rounded = VirtualTextureManager::PAGE_SIZE;
+		while (rounded * 3 / 2 < size)
+		{
+			rounded *= 2;
+		}
+		return(rounded);
+	}
+
+	int WrapCoordinate(int value, int size)
+	{
+		int wrapped = value % size;
+		return((wrapped < 0) ? wrapped + size : wrapped);
+	}
+
+	// scale an RGBA image with bilinear filtering, wrapping at the
+	// edges like the repeating textures of the scene
+	void ResampleImage(
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		int newWidth,
+		int newHeight,
+		std::vector<unsigned char>& resampled)
+	{
+		resampled.resize((size_t)newWidth * newHeight * 4);
+		if ((width == newWidth) && (height == newHeight))
+		{
+			memcpy(resampled.data(), pPixels, resampled.size());
+			return;
+		}
+
+		for (int y = 0; y < newHeight; y++)
+		{
+			float sourceY = (y + 0.5f) * height / newHeight - 0.5f;
+			int y0 = (int)std::floor(sourceY);
+			float fy = sourceY - y0;
+			int rows[2] = { WrapCoordinate(y0, height), WrapCoordinate(y0 + 1, height) };
+			for (int x = 0; x < newWidth; x++)
+			{
+				float sourceX = (x + 0.5f) * width / newWidth - 0.5f;
+				int x0 = (int)std::floor(sourceX);
+				float fx = sourceX - x0;
+				int columns[2] = { WrapCoordinate(x0, width), WrapCoordinate(x0 + 1, width) };
+				for (int c = 0; c < 4; c++)
+				{
+					float top = pPixels[((size_t)rows[0] * width + columns[0]) * 4 + c] * (1.0f - fx) +
+						pPixels[((size_t)rows[0] * width + columns[1]) * 4 + c] * fx;
+					float bottom = pPixels[((size_t)rows[1] * width + columns[0]) * 4 + c] * (1.0f - fx) +
+						pPixels[((size_t)rows[1] * width + columns[1]) * 4 + c] * fx;
+					resampled[((size_t)y * newWidth + x) * 4 + c] = (unsigned char)(top * (1.0f - fy) + bottom * fy + 0.5f);
+				}
+			}
+		}
+	}
+
+	// halve an RGBA image with a box filter for the next mip level
+	void HalveImage(
+		const std::vector<unsigned char>& pixels,
+		int width,
+		int height,
+		std::vector<unsigned char>& halved)
+	{
+		int newWidth = std::max(width / 2, 1);
+		int newHeight = std::max(height / 2, 1);
+		halved.resize((size_t)newWidth * newHeight * 4);
+		for (int y = 0; y < newHeight; y++)
+		{
+			int rows[2] = { std::min(y * 2, height - 1), std::min(y * 2 + 1, height - 1) };
+			for (int x = 0; x < newWidth; x++)
+			{
+				int columns[2] = { std::min(x * 2, width - 1), std::min(x * 2 + 1, width - 1) };
+				for (int c = 0; c < 4; c++)
+				{
+					int sum =
+						pixels[((size_t)rows[0] * width + columns[0]) * 4 + c] +
+						pixels[((size_t)rows[0] * width + columns[1]) * 4 + c] +
+						pixels[((size_t)rows[1] * width + columns[0]) * 4 + c] +
+						pixels[((size_t)rows[1] * width + columns[1]) * 4 + c];
+					halved[((size_t)y * newWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	// copy a page and its border out of a mip level, wrapping at
+	// the edges of the level
+	void CopyPage(
+		const std::vector<unsigned char>& pixels,
+		int width,
+		int height,
+		int pageX,
+		int pageY,
+		std::vector<unsigned char>& page)
+	{
+		page.resize(g_PageBytes);
+		int startX = pageX * VirtualTextureManager::PAGE_SIZE - VirtualTextureManager::PAGE_BORDER;
+		int startY = pageY * VirtualTextureManager::PAGE_SIZE - VirtualTextureManager::PAGE_BORDER;
+		for (int y = 0; y < g_SlotSize; y++)
+		{
+			int sourceY = WrapCoordinate(startY + y, height);
+			for (int x = 0; x < g_SlotSize; x++)
+			{
+				int sourceX = WrapCoordinate(startX + x, width);
+				memcpy(&page[((size_t)y * g_SlotSize + x) * 4],
+					&pixels[((size_t)sourceY * width + sourceX) * 4], 4);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  VirtualTextureManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VirtualTextureManager::VirtualTextureManager()
+{
+	m_bInitialized = false;
+	m_cacheSlots = 0;
+	m_frameNumber = 0;
+	m_lastFeedbackFrame = 0;
+	m_nextFeedbackSlot = 0;
+	m_savedFramebuffer = 0;
+	m_savedViewport[0] = 0;
+	m_savedViewport[1] = 0;
+	m_savedViewport[2] = 0;
+	m_savedViewport[3] = 0;
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_pagesLoaded = 0;
+	m_pagesEvicted = 0;
+	m_pagesDropped = 0;
+	m_feedbackReads = 0;
+}
+
+/***********************************************************
+ *  ~VirtualTextureManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VirtualTextureManager::~VirtualTextureManager()
+{
+	Release();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the page cache texture
+ *  and the feedback readback buffers.  The cache keeps the
+ *  same size however many textures are added.
+ ***********************************************************/
+bool VirtualTextureManager::Initialize(int cacheSlots)
+{
+	if (m_bInitialized)
+	{
+		return(true);
+	}
+
+	GLint maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	m_cacheSlots = std::min(cacheSlots, (int)maxTextureSize / g_SlotSize);
+	if (m_cacheSlots < 2)
+	{
+		std::cout << "Textures of " << maxTextureSize << " texels are too small for a page cache" << std::endl;
+		return(false);
+	}
+
+	int cacheTexels = m_cacheSlots * g_SlotSize;
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	m_cacheTexture.Create("VirtualTextures");
+	glBindTexture(GL_TEXTURE_2D, m_cacheTexture.Get());
+	// pages are filtered within their borders, so the cache has
+	// no mipmaps and is never wrapped
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, cacheTexels, cacheTexels, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	MemoryManager::TrackTexture(m_cacheTexture.Get(), "VirtualTextures", "page cache",
+		MemoryManager::GetTextureBytes(cacheTexels, cacheTexels, 4, false));
+
+	CACHE_SLOT freeSlot;
+	freeSlot.page = 0;
+	freeSlot.bUsed = false;
+	freeSlot.bPinned = false;
+	freeSlot.lastUsedFrame = 0;
+	m_slots.assign((size_t)m_cacheSlots * m_cacheSlots, freeSlot);
+
+	m_feedbackSlots.resize(g_FeedbackBuffers);
+	for (FEEDBACK_SLOT& slot : m_feedbackSlots)
+	{
+		slot.buffer.Create("VirtualTextures");
+		slot.fence = 0;
+		slot.width = 0;
+		slot.height = 0;
+	}
+	m_nextFeedbackSlot = 0;
+
+	std::cout << "INFO: Virtual texture page cache of " << m_cacheSlots * m_cacheSlots << " pages, "
+		<< cacheTexels << "x" << cacheTexels << " texels" << std::endl;
+	m_bInitialized = true;
+	return(true);
+}
+
+/***********************************************************
+ *  IsInitialized()
+ *
+ *  This method is used for checking whether the page cache
+ *  has been created.
+ ***********************************************************/
+bool VirtualTextureManager::IsInitialized() const
+{
+	return(m_bInitialized);
+}
+
+/***********************************************************
+ *  MakePageKey()
+ *
+ *  This method is used for packing the texture, mip level
+ *  and position of a page into one key.
+ ***********************************************************/
+uint64_t VirtualTextureManager::MakePageKey(int texture, int level, int x, int y)
+{
+	return(((uint64_t)texture << 40) | ((uint64_t)level << 32) | ((uint64_t)y << 16) | (uint64_t)x);
+}
+
+/***********************************************************
+ *  SplitPageKey()
+ *
+ *  This method is used for getting the texture, mip level
+ *  and position back out of a page key.
+ ***********************************************************/
+void VirtualTextureManager::SplitPageKey(uint64_t page, int& texture, int& level, int& x, int& y)
+{
+	texture = (int)(page >> 40);
+	level = (int)((page >> 32) & 0xFF);
+	y = (int)((page >> 16) & 0xFFFF);
+	x = (int)(page & 0xFFFF);
+}
+
+/***********************************************************
+ *  GetLevelPages()
+ *
+ *  This method is used for getting the pages across one
+ *  side of a mip level.  Sizes are powers of two of at
+ *  least one page, so the page grid halves with each level
+ *  like the mip levels of the indirection texture.
+ ***********************************************************/
+int VirtualTextureManager::GetLevelPages(int size, int level)
+{
+	return(std::max((size / PAGE_SIZE) >> level, 1));
+}
+
+/***********************************************************
+ *  GetPageOffset()
+ *
+ *  This method is used for finding a page in the tiled
+ *  file of a texture.
+ ***********************************************************/
+size_t VirtualTextureManager::GetPageOffset(const VIRTUAL_TEXTURE& texture, int level, int x, int y) const
+{
+	size_t pageIndex = (size_t)texture.firstPage[level] + (size_t)y * GetLevelPages(texture.width, level) + x;
+	return(sizeof(TILED_FILE_HEADER) + pageIndex * g_PageBytes);
+}
+
+/***********************************************************
+ *  ReadPage()
+ *
+ *  This method is used for reading the pixels of one page
+ *  from a tiled file.  Each call opens the file itself, so
+ *  any number of worker threads can read at once.  Returns
+ *  no pixels when the page could not be read.
+ ***********************************************************/
+std::vector<unsigned char> VirtualTextureManager::ReadPage(std::string filename, size_t offset)
+{
+	std::vector<unsigned char> pixels;
+	FILE* pFile = fopen(filename.c_str(), "rb");
+	if (NULL == pFile)
+	{
+		return(pixels);
+	}
+
+	pixels.resize(g_PageBytes);
+	if ((fseek(pFile, (long)offset, SEEK_SET) != 0) ||
+		(fread(pixels.data(), 1, pixels.size(), pFile) != pixels.size()))
+	{
+		pixels.clear();
+	}
+	fclose(pFile);
+	return(pixels);
+}
+
+/***********************************************************
+ *  GetTiledFilename()
+ *
+ *  This method is used for naming the tiled file of an
+ *  image, next to the image itself.
+ ***********************************************************/
+std::string VirtualTextureManager::GetTiledFilename(const std::string& imageFilename)
+{
+	size_t extension = imageFilename.find_last_of('.');
+	size_t directory = imageFilename.find_last_of("/\\");
+	if ((extension == std::string::npos) || ((directory != std::string::npos) && (extension < directory)))
+	{
+		return(imageFilename + ".vtex");
+	}
+	return(imageFilename.substr(0, extension) + ".vtex");
+}
+
+/***********************************************************
+ *  BuildTiledFile()
+ *
+ *  This method is used for cutting an image into the pages
+ *  of every mip level and writing them to its tiled file.
+ *  The image is scaled to powers of two first.  A file left
+ *  by an earlier run for the same image is used as it is.
+ *  The image is flipped as set with stbi for the scene.
+ ***********************************************************/
+bool VirtualTextureManager::BuildTiledFile(const std::string& imageFilename, const std::string& tiledFilename)
+{
+	long sourceBytes = GetFileBytes(imageFilename);
+	if (sourceBytes < 0)
+	{
+		std::cout << "Could not load image:" << imageFilename << std::endl;
+		return(false);
+	}
+
+	TILED_FILE_HEADER header;
+	if (ReadTiledHeader(tiledFilename, header) && (header.sourceBytes == (uint32_t)sourceBytes))
+	{
+		return(true);
+	}
+
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+	unsigned char* pPixels = stbi_load(imageFilename.c_str(), &width, &height, &colorChannels, 4);
+	if (NULL == pPixels)
+	{
+		std::cout << "Could not load image:" << imageFilename << std::endl;
+		return(false);
+	}
+
+	int levelWidth = RoundToPowerOfTwo(width);
+	int levelHeight = RoundToPowerOfTwo(height);
+	std::vector<unsigned char> levelPixels;
+	ResampleImage(pPixels, width, height, levelWidth, levelHeight, levelPixels);
+	stbi_image_free(pPixels);
+
+	memcpy(header.magic, g_TiledFileMagic, sizeof(g_TiledFileMagic));
+	header.version = g_TiledFileVersion;
+	header.sourceBytes = (uint32_t)sourceBytes;
+	header.width = levelWidth;
+	header.height = levelHeight;
+	header.levels = 1;
+	while (std::max(levelWidth, levelHeight) >> header.levels >= PAGE_SIZE)
+	{
+		header.levels++;
+	}
+	header.pageSize = PAGE_SIZE;
+	header.pageBorder = PAGE_BORDER;
+
+	// other processes may be cutting the same image, so each writes
+	// its own file and the finished one is renamed into place
+	std::string temporaryFilename = tiledFilename + "." +
+		std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".tmp";
+	FILE* pFile = fopen(temporaryFilename.c_str(), "wb");
+	if (NULL == pFile)
+	{
+		std::cout << "Could not write tiled texture " << temporaryFilename << std::endl;
+		return(false);
+	}
+
+	bool bWritten = (fwrite(&header, sizeof(header), 1, pFile) == 1);
+	std::vector<unsigned char> page;
+	std::vector<unsigned char> nextLevel;
+	for (int level = 0; bWritten && (level < (int)header.levels); level++)
+	{
+		for (int y = 0; bWritten && (y < GetLevelPages(header.height, level)); y++)
+		{
+			for (int x = 0; bWritten && (x < GetLevelPages(header.width, level)); x++)
+			{
+				CopyPage(levelPixels, levelWidth, levelHeight, x, y, page);
+				bWritten = (fwrite(page.data(), 1, page.size(), pFile) == page.size());
+			}
+		}
+
+		HalveImage(levelPixels, levelWidth, levelHeight, nextLevel);
+		levelPixels.swap(nextLevel);
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+	bWritten = (fclose(pFile) == 0) && bWritten;
+
+	if (bWritten && (rename(temporaryFilename.c_str(), tiledFilename.c_str()) == 0))
+	{
+		std::cout << "INFO: Cut " << imageFilename << " into " << header.width << "x" << header.height
+			<< " texels and " << header.levels << " levels of pages" << std::endl;
+		return(true);
+	}
+
+	// renaming fails where the file exists, because another process
+	// finished first
+	remove(temporaryFilename.c_str());
+	if (ReadTiledHeader(tiledFilename, header) && (header.sourceBytes == (uint32_t)sourceBytes))
+	{
+		return(true);
+	}
+	std::cout << "Could not write tiled texture " << tiledFilename << std::endl;
+	return(false);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding a texture from its tiled
+ *  file.  The single page of the coarsest level is read
+ *  right away and kept, so every part of the texture has a
+ *  page to show before finer pages arrive.  Returns -1 when
+ *  the texture could not be added.
+ ***********************************************************/
+int VirtualTextureManager::AddTexture(const std::string& tiledFilename, const std::string& tag)
+{
+	TILED_FILE_HEADER header;
+	if (!m_bInitialized || (ReadTiledHeader(tiledFilename, header) == false))
+	{
+		std::cout << "Could not read tiled texture " << tiledFilename << std::endl;
+		return(-1);
+	}
+	if (((int)header.width / PAGE_SIZE > g_MaxFeedbackValue + 1) ||
+		((int)header.height / PAGE_SIZE > g_MaxFeedbackValue + 1) ||
+		((int)m_textures.size() >= g_MaxFeedbackValue))
+	{
+		std::cout << "Tiled texture " << tiledFilename << " does not fit the page feedback" << std::endl;
+		return(-1);
+	}
+
+	int textureIndex = (int)m_textures.size();
+	VIRTUAL_TEXTURE texture;
+	texture.tag = tag;
+	texture.filename = tiledFilename;
+	texture.width = header.width;
+	texture.height = header.height;
+	texture.levels = header.levels;
+	texture.firstPage.resize(texture.levels);
+	texture.indirection.resize(texture.levels);
+	int pageCount = 0;
+	for (int level = 0; level < texture.levels; level++)
+	{
+		int levelPages = GetLevelPages(texture.width, level) * GetLevelPages(texture.height, level);
+		texture.firstPage[level] = pageCount;
+		texture.indirection[level].assign((size_t)levelPages * 4, 0);
+		pageCount += levelPages;
+	}
+	texture.bIndirectionChanged = true;
+
+	std::vector<unsigned char> pixels = ReadPage(tiledFilename, GetPageOffset(texture, texture.levels - 1, 0, 0));
+	int slot = AllocateSlot();
+	if (pixels.empty() || (slot < 0))
+	{
+		std::cout << "Could not read the first page of tiled texture " << tiledFilename << std::endl;
+		return(-1);
+	}
+
+	// the indirection is read with texelFetch, one entry per page
+	// and a mip level per page level
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	texture.indirectionTexture.Create("VirtualTextures");
+	glBindTexture(GL_TEXTURE_2D, texture.indirectionTexture.Get());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.levels - 1);
+	for (int level = 0; level < texture.levels; level++)
+	{
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8,
+			GetLevelPages(texture.width, level), GetLevelPages(texture.height, level),
+			0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	}
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	MemoryManager::TrackTexture(texture.indirectionTexture.Get(), "VirtualTextures", tiledFilename,
+		MemoryManager::GetTextureBytes(GetLevelPages(texture.width, 0), GetLevelPages(texture.height, 0), 4, true));
+
+	m_textures.push_back(std::move(texture));
+	UploadPage(MakePageKey(textureIndex, m_textures[textureIndex].levels - 1, 0, 0), slot, pixels, true);
+	UpdateIndirection(m_textures[textureIndex], textureIndex);
+
+	return(textureIndex);
+}
+
+/***********************************************************
+ *  FindTexture()
+ *
+ *  This method is used for getting the index of a virtual
+ *  texture by its tag, -1 when there is none.
+ ***********************************************************/
+int VirtualTextureManager::FindTexture(const std::string& tag) const
+{
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		if (m_textures[i].tag == tag)
+		{
+			return(i);
+		}
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  GetTextureCount()
+ *
+ *  This method is used for getting the number of virtual
+ *  textures added.
+ ***********************************************************/
+int VirtualTextureManager::GetTextureCount() const
+{
+	return((int)m_textures.size());
+}
+
+/***********************************************************
+ *  AllocateSlot()
+ *
+ *  This method is used for finding a cache slot for a new
+ *  page.  When none is free, the page seen longest ago is
+ *  replaced, but never a page seen in the latest feedback.
+ *  Returns -1 when every page is still needed.
+ ***********************************************************/
+int VirtualTextureManager::AllocateSlot()
+{
+	int oldestSlot = -1;
+	for (int i = 0; i < (int)m_slots.size(); i++)
+	{
+		const CACHE_SLOT& slot = m_slots[i];
+		if (!slot.bUsed)
+		{
+			return(i);
+		}
+		if (!slot.bPinned && ((oldestSlot < 0) || (slot.lastUsedFrame < m_slots[oldestSlot].lastUsedFrame)))
+		{
+			oldestSlot = i;
+		}
+	}
+
+	if ((oldestSlot < 0) || (m_slots[oldestSlot].lastUsedFrame >= m_lastFeedbackFrame))
+	{
+		return(-1);
+	}
+
+	int texture = 0;
+	int level = 0;
+	int x = 0;
+	int y = 0;
+	SplitPageKey(m_slots[oldestSlot].page, texture, level, x, y);
+	m_residentPages.erase(m_slots[oldestSlot].page);
+	m_textures[texture].bIndirectionChanged = true;
+	m_slots[oldestSlot].bUsed = false;
+	m_pagesEvicted++;
+	return(oldestSlot);
+}
+
+/***********************************************************
+ *  UploadPage()
+ *
+ *  This method is used for copying the pixels of a page
+ *  into a cache slot.  The indirection is written once per
+ *  frame for all the pages that arrived.
+ ***********************************************************/
+void VirtualTextureManager::UploadPage(uint64_t page, int slot, const std::vector<unsigned char>& pixels, bool bPinned)
+{
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glBindTexture(GL_TEXTURE_2D, m_cacheTexture.Get());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0,
+		(slot % m_cacheSlots) * g_SlotSize, (slot / m_cacheSlots) * g_SlotSize,
+		g_SlotSize, g_SlotSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+
+	CACHE_SLOT& cacheSlot = m_slots[slot];
+	cacheSlot.page = page;
+	cacheSlot.bUsed = true;
+	cacheSlot.bPinned = bPinned;
+	cacheSlot.lastUsedFrame = m_frameNumber;
+	m_residentPages[page] = slot;
+
+	int texture = 0;
+	int level = 0;
+	int x = 0;
+	int y = 0;
+	SplitPageKey(page, texture, level, x, y);
+	m_textures[texture].bIndirectionChanged = true;
+}
+
+/***********************************************************
+ *  UpdateIndirection()
+ *
+ *  This method is used for writing the indirection entries
+ *  of a texture, coarsest level first.  A page in the cache
+ *  points at its own slot, and a missing page copies the
+ *  entry of the page above it, which is the closest coarser
+ *  page in the cache.
+ ***********************************************************/
+void VirtualTextureManager::UpdateIndirection(VIRTUAL_TEXTURE& texture, int textureIndex)
+{
+	GLint previousTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	glBindTexture(GL_TEXTURE_2D, texture.indirectionTexture.Get());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	for (int level = texture.levels - 1; level >= 0; level--)
+	{
+		int pagesX = GetLevelPages(texture.width, level);
+		int pagesY = GetLevelPages(texture.height, level);
+		std::vector<unsigned char>& entries = texture.indirection[level];
+		for (int y = 0; y < pagesY; y++)
+		{
+			for (int x = 0; x < pagesX; x++)
+			{
+				unsigned char* pEntry = &entries[((size_t)y * pagesX + x) * 4];
+				std::unordered_map<uint64_t, int>::const_iterator resident =
+					m_residentPages.find(MakePageKey(textureIndex, level, x, y));
+				if (resident != m_residentPages.end())
+				{
+					pEntry[0] = (unsigned char)(resident->second % m_cacheSlots);
+					pEntry[1] = (unsigned char)(resident->second / m_cacheSlots);
+					pEntry[2] = (unsigned char)level;
+					pEntry[3] = 255;
+				}
+				else if (level + 1 < texture.levels)
+				{
+					int parentPagesX = GetLevelPages(texture.width, level + 1);
+					int parentPagesY = GetLevelPages(texture.height, level + 1);
+					int parentX = std::min(x / 2, parentPagesX - 1);
+					int parentY = std::min(y / 2, parentPagesY - 1);
+					memcpy(pEntry, &texture.indirection[level + 1][((size_t)parentY * parentPagesX + parentX) * 4], 4);
+				}
+				else
+				{
+					memset(pEntry, 0, 4);
+				}
+			}
+		}
+		glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, pagesX, pagesY, GL_RGBA, GL_UNSIGNED_BYTE, entries.data());
+	}
+
+	glBindTexture(GL_TEXTURE_2D, previousTexture);
+	texture.bIndirectionChanged = false;
+}
+
+/***********************************************************
+ *  BindCache()
+ *
+ *  This method is used for binding the page cache and
+ *  setting the shader values shared by the virtual
+ *  textures.  The units are shared by all scenes, so this
+ *  is done when the scene is activated.
+ ***********************************************************/
+void VirtualTextureManager::BindCache(ShaderManager* pShaderManager)
+{
+	if (!m_bInitialized || (NULL == pShaderManager))
+	{
+		return;
+	}
+
+	glActiveTexture(GL_TEXTURE0 + CACHE_TEXTURE_UNIT);
+	glBindTexture(GL_TEXTURE_2D, m_cacheTexture.Get());
+	glActiveTexture(GL_TEXTURE0);
+
+	pShaderManager->setSampler2DValue("vtCache", CACHE_TEXTURE_UNIT);
+	pShaderManager->setSampler2DValue("vtIndirection", INDIRECTION_TEXTURE_UNIT);
+	pShaderManager->setFloatValue("vtCacheTexels", (float)(m_cacheSlots * g_SlotSize));
+	// the feedback is drawn smaller, which makes the texels under
+	// each pixel look that many levels coarser
+	pShaderManager->setFloatValue("vtFeedbackBias", -std::log2((float)g_FeedbackScale));
+	pShaderManager->setBoolValue("bVirtualFeedback", false);
+}
+
+/***********************************************************
+ *  GetBackendTexture()
+ *
+ *  This method is used for getting the values the render
+ *  backend sets for drawing an object with a virtual
+ *  texture, and the indirection texture it binds.
+ ***********************************************************/
+bool VirtualTextureManager::GetBackendTexture(int textureIndex, RenderBackend::VIRTUAL_TEXTURE& backendTexture) const
+{
+	if ((textureIndex < 0) || (textureIndex >= (int)m_textures.size()))
+	{
+		return(false);
+	}
+
+	const VIRTUAL_TEXTURE& texture = m_textures[textureIndex];
+	backendTexture.cacheIndex = textureIndex;
+	backendTexture.size = glm::vec2((float)texture.width, (float)texture.height);
+	backendTexture.maxLevel = (float)(texture.levels - 1);
+	backendTexture.indirectionTexture = texture.indirectionTexture.Get();
+	backendTexture.indirectionUnit = INDIRECTION_TEXTURE_UNIT;
+	return(true);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for reading the finished feedback,
+ *  starting the page reads it asks for, copying the pages
+ *  that were read into the cache and writing the changed
+ *  indirection entries.
+ ***********************************************************/
+void VirtualTextureManager::Update()
+{
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	m_frameNumber++;
+	CollectFeedback();
+	FinishPageLoads(g_MaxUploadsPerFrame);
+
+	for (int i = 0; i < (int)m_textures.size(); i++)
+	{
+		if (m_textures[i].bIndirectionChanged)
+		{
+			UpdateIndirection(m_textures[i], i);
+		}
+	}
+
+	ReportStatistics();
+}
+
+/***********************************************************
+ *  CollectFeedback()
+ *
+ *  This method is used for reading the feedback the GPU has
+ *  finished, without waiting for any.  The pages it names
+ *  are marked as seen, and the missing ones, with the
+ *  missing pages above them, are requested.
+ ***********************************************************/
+void VirtualTextureManager::CollectFeedback()
+{
+	for (int i = 0; i < (int)m_feedbackSlots.size(); i++)
+	{
+		FEEDBACK_SLOT& slot = m_feedbackSlots[(m_nextFeedbackSlot + i) % m_feedbackSlots.size()];
+		if (slot.fence == 0)
+		{
+			continue;
+		}
+		GLenum status = glClientWaitSync(slot.fence, 0, 0);
+		if ((status != GL_ALREADY_SIGNALED) && (status != GL_CONDITION_SATISFIED))
+		{
+			continue;
+		}
+		glDeleteSync(slot.fence);
+		slot.fence = 0;
+
+		m_feedbackPixels.resize((size_t)slot.width * slot.height * 4);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.Get());
+		void* pMapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_feedbackPixels.size(), GL_MAP_READ_BIT);
+		if (NULL != pMapped)
+		{
+			memcpy(m_feedbackPixels.data(), pMapped, m_feedbackPixels.size());
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		if (NULL == pMapped)
+		{
+			continue;
+		}
+		m_feedbackReads++;
+		m_lastFeedbackFrame = m_frameNumber;
+
+		std::unordered_set<uint64_t> seenPages;
+		std::vector<uint64_t> missingPages;
+		for (size_t pixel = 0; pixel < m_feedbackPixels.size(); pixel += 4)
+		{
+			const unsigned char* pValue = &m_feedbackPixels[pixel];
+			int textureIndex = (int)pValue[3] - 1;
+			if ((textureIndex < 0) || (textureIndex >= (int)m_textures.size()))
+			{
+				continue;
+			}
+			const VIRTUAL_TEXTURE& texture = m_textures[textureIndex];
+			int x = pValue[0];
+			int y = pValue[1];
+			int level = std::min((int)pValue[2], texture.levels - 1);
+
+			// the page and the pages above it, which stand in for it
+			for (; level < texture.levels; level++)
+			{
+				x = std::min(x, GetLevelPages(texture.width, level) - 1);
+				y = std::min(y, GetLevelPages(texture.height, level) - 1);
+				uint64_t page = MakePageKey(textureIndex, level, x, y);
+				if (seenPages.insert(page).second == false)
+				{
+					break;
+				}
+
+				std::unordered_map<uint64_t, int>::const_iterator resident = m_residentPages.find(page);
+				if (resident != m_residentPages.end())
+				{
+					m_slots[resident->second].lastUsedFrame = m_frameNumber;
+				}
+				else
+				{
+					missingPages.push_back(page);
+				}
+				x /= 2;
+				y /= 2;
+			}
+		}
+		RequestPages(missingPages);
+	}
+}
+
+/***********************************************************
+ *  RequestPages()
+ *
+ *  This method is used for starting the reads of missing
+ *  pages on worker threads, coarsest level first, since
+ *  those stand in for the most of the texture.  Pages left
+ *  over are asked for again by the next feedback.
+ ***********************************************************/
+void VirtualTextureManager::RequestPages(const std::vector<uint64_t>& pages)
+{
+	std::vector<uint64_t> sortedPages = pages;
+	std::sort(sortedPages.begin(), sortedPages.end(), [](uint64_t first, uint64_t second)
+		{
+			return(((first >> 32) & 0xFF) > ((second >> 32) & 0xFF));
+		});
+
+	for (uint64_t page : sortedPages)
+	{
+		if ((int)m_pageLoads.size() >= g_MaxPageLoads)
+		{
+			break;
+		}
+
+		bool bLoading = false;
+		for (const PAGE_LOAD& load : m_pageLoads)
+		{
+			bLoading = bLoading || (load.page == page);
+		}
+		if (bLoading)
+		{
+			continue;
+		}
+
+		int texture = 0;
+		int level = 0;
+		int x = 0;
+		int y = 0;
+		SplitPageKey(page, texture, level, x, y);
+		PAGE_LOAD load;
+		load.page = page;
+		load.pixels = std::async(std::launch::async, &VirtualTextureManager::ReadPage,
+			m_textures[texture].filename, GetPageOffset(m_textures[texture], level, x, y));
+		m_pageLoads.push_back(std::move(load));
+	}
+}
+
+/***********************************************************
+ *  FinishPageLoads()
+ *
+ *  This method is used for copying pages read by the
+ *  workers into the cache, up to a number per frame so a
+ *  burst of pages does not stall one frame.
+ ***********************************************************/
+void VirtualTextureManager::FinishPageLoads(int maxUploads)
+{
+	int uploads = 0;
+	size_t i = 0;
+	while ((i < m_pageLoads.size()) && (uploads < maxUploads))
+	{
+		PAGE_LOAD& load = m_pageLoads[i];
+		if (load.pixels.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			i++;
+			continue;
+		}
+
+		std::vector<unsigned char> pixels = load.pixels.get();
+		int slot = pixels.empty() ? -1 : AllocateSlot();
+		if (slot >= 0)
+		{
+			UploadPage(load.page, slot, pixels, false);
+			m_pagesLoaded++;
+			uploads++;
+		}
+		else
+		{
+			m_pagesDropped++;
+		}
+		m_pageLoads.erase(m_pageLoads.begin() + i);
+	}
+}
+
+/***********************************************************
+ *  BeginFeedback()
+ *
+ *  This method is used for starting the feedback pass into
+ *  a small target, every few frames while a readback
+ *  buffer is free.  The objects drawn until EndFeedback()
+ *  write the page under each pixel instead of a color.
+ ***********************************************************/
+bool VirtualTextureManager::BeginFeedback(ShaderManager* pShaderManager)
+{
+	if (!m_bInitialized || (NULL == pShaderManager) || (m_textures.empty()) ||
+		((m_frameNumber % g_FeedbackFrameInterval) != 0) ||
+		(m_feedbackSlots[m_nextFeedbackSlot].fence != 0))
+	{
+		return(false);
+	}
+
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_savedFramebuffer);
+	glGetIntegerv(GL_VIEWPORT, m_savedViewport);
+	int width = std::max(m_savedViewport[2] / g_FeedbackScale, 1);
+	int height = std::max(m_savedViewport[3] / g_FeedbackScale, 1);
+	m_feedbackTarget.Resize(width, height);
+	m_feedbackTarget.Bind();
+
+	// an empty pixel names no texture
+	GLfloat clearColor[4];
+	glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+	glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+	pShaderManager->setBoolValue("bVirtualFeedback", true);
+	return(true);
+}
+
+/***********************************************************
+ *  EndFeedback()
+ *
+ *  This method is used for copying the feedback into a
+ *  readback buffer on the GPU and drawing into the frame
+ *  again.  The copy is read once its fence has passed.
+ ***********************************************************/
+void VirtualTextureManager::EndFeedback(ShaderManager* pShaderManager)
+{
+	pShaderManager->setBoolValue("bVirtualFeedback", false);
+
+	FEEDBACK_SLOT& slot = m_feedbackSlots[m_nextFeedbackSlot];
+	int width = m_feedbackTarget.GetWidth();
+	int height = m_feedbackTarget.GetHeight();
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.Get());
+	if ((width != slot.width) || (height != slot.height))
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, NULL, GL_STREAM_READ);
+		MemoryManager::TrackBuffer(slot.buffer.Get(), "VirtualTextures", "feedback readback", (size_t)width * height * 4);
+		slot.width = width;
+		slot.height = height;
+	}
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_nextFeedbackSlot = (m_nextFeedbackSlot + 1) % (int)m_feedbackSlots.size();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, m_savedFramebuffer);
+	glViewport(m_savedViewport[0], m_savedViewport[1], m_savedViewport[2], m_savedViewport[3]);
+}
+
+/***********************************************************
+ *  ReportStatistics()
+ *
+ *  This method is used for printing the cache use and the
+ *  pages streamed every few seconds.
+ ***********************************************************/
+void VirtualTextureManager::ReportStatistics()
+{
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_statisticsStart;
+	if (elapsed.count() < g_ReportSeconds)
+	{
+		return;
+	}
+
+	std::cout << "INFO: Virtual textures - " << m_residentPages.size() << " of " << m_slots.size()
+		<< " cache pages in use, " << m_pagesLoaded << " loaded, " << m_pagesEvicted << " replaced, "
+		<< m_pagesDropped << " dropped, " << m_feedbackReads << " feedback reads" << std::endl;
+
+	m_statisticsStart = std::chrono::steady_clock::now();
+	m_pagesLoaded = 0;
+	m_pagesEvicted = 0;
+	m_pagesDropped = 0;
+	m_feedbackReads = 0;
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for waiting for the pages still
+ *  being read and freeing the cache, the indirection
+ *  textures and the readback buffers.
+ ***********************************************************/
+void VirtualTextureManager::Release()
+{
+	for (PAGE_LOAD& load : m_pageLoads)
+	{
+		if (load.pixels.valid())
+		{
+			load.pixels.wait();
+		}
+	}
+	m_pageLoads.clear();
+
+	if (!m_bInitialized)
+	{
+		return;
+	}
+
+	m_textures.clear();
+	m_residentPages.clear();
+	m_slots.clear();
+
+	m_cacheTexture.Reset();
+
+	for (FEEDBACK_SLOT& slot : m_feedbackSlots)
+	{
+		if (slot.fence != 0)
+		{
+			glDeleteSync(slot.fence);
+		}
+	}
+	m_feedbackSlots.clear();
+
+	m_bInitialized = false;
+}
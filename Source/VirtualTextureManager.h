@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////
+// virtualtexturemanager.h
+// ============
+// manage virtual textures - pages streamed into a fixed size page cache
+//
+//  Each texture is cut into square pages for every mip level and kept in a
+//  tiled file next to its image.  Only the pages the camera needs are read,
+//  on worker threads, into one cache texture whose size never changes.  A
+//  small indirection texture per virtual texture tells the shader where each
+//  page is, or which coarser page stands in for it until it arrives.  The
+//  pages needed are found by drawing the scene again at a low resolution,
+//  writing the page under each pixel, and reading that back a frame later.
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLResourceManager.h"
+#include "RenderBackend.h"
+#include "RenderTarget.h"
+#include "ShaderManager.h"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  VirtualTextureManager
+ *
+ *  This class contains the code for the page cache, the
+ *  virtual textures drawn from it and the feedback pass
+ *  that decides which pages are loaded.
+ ***********************************************************/
+class VirtualTextureManager
+{
+public:
+	// constructor
+	VirtualTextureManager();
+	// destructor
+	~VirtualTextureManager();
+
+	// texels across a page, without the border, and the border
+	// copied from the neighboring pages so filtering never reads
+	// another page, these match the fragment shader
+	static const int PAGE_SIZE = 128;
+	static const int PAGE_BORDER = 4;
+	// texture units of the page cache and the indirection texture
+	static const int CACHE_TEXTURE_UNIT = 14;
+	static const int INDIRECTION_TEXTURE_UNIT = 15;
+
+private:
+	// a virtual texture and where its pages are
+	struct VIRTUAL_TEXTURE
+	{
+		std::string tag;
+		std::string filename;
+		// size of the first mip level, powers of two
+		int width;
+		int height;
+		int levels;
+		// first page of each level in the tiled file
+		std::vector<int> firstPage;
+		// indirection entries of each level, RGBA
+		std::vector<std::vector<unsigned char>> indirection;
+		GLTexture indirectionTexture;
+		bool bIndirectionChanged;
+	};
+
+	// a slot of the page cache and the page in it
+	struct CACHE_SLOT
+	{
+		uint64_t page;
+		bool bUsed;
+		// the coarsest level of each texture stays in the cache
+		bool bPinned;
+		uint32_t lastUsedFrame;
+	};
+
+	// a page being read on a worker thread
+	struct PAGE_LOAD
+	{
+		uint64_t page;
+		std::future<std::vector<unsigned char>> pixels;
+	};
+
+	// feedback readback waiting for the GPU
+	struct FEEDBACK_SLOT
+	{
+		GLBuffer buffer;
+		GLsync fence;
+		int width;
+		int height;
+	};
+
+	bool m_bInitialized;
+	std::vector<VIRTUAL_TEXTURE> m_textures;
+	GLTexture m_cacheTexture;
+	// slots across and down the cache
+	int m_cacheSlots;
+	std::vector<CACHE_SLOT> m_slots;
+	// resident pages by page key, and the slot holding each one
+	std::unordered_map<uint64_t, int> m_residentPages;
+	std::vector<PAGE_LOAD> m_pageLoads;
+	uint32_t m_frameNumber;
+	// frame the latest feedback was read in, its pages are kept
+	uint32_t m_lastFeedbackFrame;
+
+	// low resolution pass writing the page under each pixel
+	RenderTarget m_feedbackTarget;
+	std::vector<FEEDBACK_SLOT> m_feedbackSlots;
+	int m_nextFeedbackSlot;
+	GLint m_savedFramebuffer;
+	GLint m_savedViewport[4];
+	std::vector<unsigned char> m_feedbackPixels;
+
+	// statistics, reported every few seconds
+	std::chrono::steady_clock::time_point m_statisticsStart;
+	int m_pagesLoaded;
+	int m_pagesEvicted;
+	int m_pagesDropped;
+	int m_feedbackReads;
+
+	// page keys and the place of a page in the tiled file
+	static uint64_t MakePageKey(int texture, int level, int x, int y);
+	static void SplitPageKey(uint64_t page, int& texture, int& level, int& x, int& y);
+	static int GetLevelPages(int size, int level);
+	size_t GetPageOffset(const VIRTUAL_TEXTURE& texture, int level, int x, int y) const;
+	// read one page from a tiled file, safe to call from worker threads
+	static std::vector<unsigned char> ReadPage(std::string filename, size_t offset);
+
+	// find a free slot or the least recently used one
+	int AllocateSlot();
+	// copy a page into a slot and point the indirection at it
+	void UploadPage(uint64_t page, int slot, const std::vector<unsigned char>& pixels, bool bPinned);
+	// write the changed indirection entries of a texture
+	void UpdateIndirection(VIRTUAL_TEXTURE& texture, int textureIndex);
+
+	// read the finished feedback and queue the pages it names
+	void CollectFeedback();
+	void RequestPages(const std::vector<uint64_t>& pages);
+	// copy the pages read by the workers into the cache
+	void FinishPageLoads(int maxUploads);
+	void ReportStatistics();
+
+public:
+	// create the page cache with a number of slots across and down
+	bool Initialize(int cacheSlots);
+	bool IsInitialized() const;
+
+	// cut an image into the tiled file, done once per image, safe to
+	// call from worker threads
+	static bool BuildTiledFile(const std::string& imageFilename, const std::string& tiledFilename);
+	static std::string GetTiledFilename(const std::string& imageFilename);
+	// add a texture from its tiled file, returning its index
+	int AddTexture(const std::string& tiledFilename, const std::string& tag);
+	int FindTexture(const std::string& tag) const;
+	int GetTextureCount() const;
+
+	// bind the page cache for the following frames
+	void BindCache(ShaderManager* pShaderManager);
+	// the values the render backend draws a virtual texture with,
+	// false when there is no such texture
+	bool GetBackendTexture(int textureIndex, RenderBackend::VIRTUAL_TEXTURE& backendTexture) const;
+
+	// load and upload pages named by earlier feedback, once per frame
+	void Update();
+	// draw the feedback pass between these calls, true when a
+	// feedback pass is wanted this frame
+	bool BeginFeedback(ShaderManager* pShaderManager);
+	void EndFeedback(ShaderManager* pShaderManager);
+
+	// wait for the page loads and free the OpenGL objects
+	void Release();
+};
@@ -0,0 +1,91 @@
+#version 430 core
+// halves the bloom image, keeping only the bright parts of the
+// scene on the first step
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (rgba16f, binding = 0) uniform writeonly image2D targetImage;
+
+uniform sampler2D sourceTexture;
+uniform float sourceLevel;
+uniform vec2 sourceTexelSize;
+uniform vec2 targetSize;
+// the first step reads the scene, and keeps what is brighter than
+// the threshold, fading in over the knee
+uniform bool bPrefilter;
+uniform float threshold;
+uniform float knee;
+
+vec3 Sample(vec2 coordinate, vec2 offset)
+{
+    return textureLod(sourceTexture, coordinate + offset * sourceTexelSize, sourceLevel).rgb;
+}
+
+// weight that keeps a single very bright pixel from flickering
+float KarisWeight(vec3 color)
+{
+    return 1.0 / (1.0 + max(color.r, max(color.g, color.b)));
+}
+
+vec3 Prefilter(vec3 color)
+{
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 0.0001);
+    float contribution = max(soft, brightness - threshold) / max(brightness, 0.0001);
+    return color * contribution;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(vec2(pixel), targetSize)))
+    {
+        return;
+    }
+    vec2 coordinate = (vec2(pixel) + 0.5) / targetSize;
+
+    // thirteen taps in four overlapping boxes around the pixel
+    vec3 a = Sample(coordinate, vec2(-2.0, 2.0));
+    vec3 b = Sample(coordinate, vec2(0.0, 2.0));
+    vec3 c = Sample(coordinate, vec2(2.0, 2.0));
+    vec3 d = Sample(coordinate, vec2(-2.0, 0.0));
+    vec3 e = Sample(coordinate, vec2(0.0, 0.0));
+    vec3 f = Sample(coordinate, vec2(2.0, 0.0));
+    vec3 g = Sample(coordinate, vec2(-2.0, -2.0));
+    vec3 h = Sample(coordinate, vec2(0.0, -2.0));
+    vec3 i = Sample(coordinate, vec2(2.0, -2.0));
+    vec3 j = Sample(coordinate, vec2(-1.0, 1.0));
+    vec3 k = Sample(coordinate, vec2(1.0, 1.0));
+    vec3 l = Sample(coordinate, vec2(-1.0, -1.0));
+    vec3 m = Sample(coordinate, vec2(1.0, -1.0));
+
+    vec3 result;
+    if (bPrefilter)
+    {
+        vec3 boxes[5];
+        boxes[0] = (j + k + l + m) * 0.25;
+        boxes[1] = (a + b + d + e) * 0.25;
+        boxes[2] = (b + c + e + f) * 0.25;
+        boxes[3] = (d + e + g + h) * 0.25;
+        boxes[4] = (e + f + h + i) * 0.25;
+        float weights[5] = float[5](0.5, 0.125, 0.125, 0.125, 0.125);
+        vec3 sum = vec3(0.0);
+        float weightSum = 0.0;
+        for (int box = 0; box < 5; box++)
+        {
+            float weight = weights[box] * KarisWeight(boxes[box]);
+            sum += boxes[box] * weight;
+            weightSum += weight;
+        }
+        result = Prefilter(sum / weightSum);
+    }
+    else
+    {
+        result = e * 0.125;
+        result += (a + c + g + i) * 0.03125;
+        result += (b + d + f + h) * 0.0625;
+        result += (j + k + l + m) * 0.125;
+    }
+
+    imageStore(targetImage, pixel, vec4(result, 1.0));
+}
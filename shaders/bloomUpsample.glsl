@@ -0,0 +1,38 @@
+#version 430 core
+// adds the next smaller bloom image, blurred, to this one
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (rgba16f, binding = 0) uniform image2D targetImage;
+
+uniform sampler2D sourceTexture;
+uniform float sourceLevel;
+uniform vec2 sourceTexelSize;
+uniform vec2 targetSize;
+// spread of the blur in source texels
+uniform float radius;
+
+vec3 Sample(vec2 coordinate, vec2 offset)
+{
+    return textureLod(sourceTexture, coordinate + offset * sourceTexelSize * radius, sourceLevel).rgb;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(vec2(pixel), targetSize)))
+    {
+        return;
+    }
+    vec2 coordinate = (vec2(pixel) + 0.5) / targetSize;
+
+    // three by three tent filter
+    vec3 result = Sample(coordinate, vec2(0.0, 0.0)) * 4.0;
+    result += (Sample(coordinate, vec2(-1.0, 0.0)) + Sample(coordinate, vec2(1.0, 0.0)) +
+        Sample(coordinate, vec2(0.0, -1.0)) + Sample(coordinate, vec2(0.0, 1.0))) * 2.0;
+    result += Sample(coordinate, vec2(-1.0, -1.0)) + Sample(coordinate, vec2(1.0, -1.0)) +
+        Sample(coordinate, vec2(-1.0, 1.0)) + Sample(coordinate, vec2(1.0, 1.0));
+    result /= 16.0;
+
+    vec3 current = imageLoad(targetImage, pixel).rgb;
+    imageStore(targetImage, pixel, vec4(current + result, 1.0));
+}
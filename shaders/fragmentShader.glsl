@@ -1,228 +1,500 @@
-#version 330 core
-out vec4 fragmentColor;
-
-in vec3 fragmentPosition;
-in vec3 fragmentVertexNormal;
-in vec2 fragmentTextureCoordinate;
-
-struct Material {
-    vec3 diffuseColor;
-    vec3 specularColor;
-    float shininess;
-}; 
-
-struct DirectionalLight {
-    vec3 direction;
-	
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    bool bActive;
-};
-
-struct PointLight {
-    vec3 position;
-    
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    bool bActive;
-};
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-  
-    float constant;
-    float linear;
-    float quadratic;
-  
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;       
-
-    bool bActive;
-};
-
-#define TOTAL_POINT_LIGHTS 5
-
-uniform bool bUseTexture=false;
-uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
-uniform vec3 viewPosition;
-uniform DirectionalLight directionalLight;
-uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
-uniform SpotLight spotLight;
-uniform Material material;
-uniform sampler2D objectTexture;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
-
-// the scaled texture coordinate to use in calculations
-vec2 fragmentTextureCoordinateScaled = fragmentTextureCoordinate * UVscale;
-
-// function prototypes
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-
-void main()
-{   
-    if(bUseLighting == true)
-    {
-        vec3 phongResult = vec3(0.0f);
-        // properties
-        vec3 norm = normalize(fragmentVertexNormal);
-        vec3 viewDir = normalize(viewPosition - fragmentPosition);
-    
-        // == =====================================================
-        // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
-        // For each phase, a calculate function is defined that calculates the corresponding color
-        // per light source. In the main() function we take all the calculated colors and sum them 
-        // up for this fragment's final color.
-        // == =====================================================
-        // phase 1: directional lighting
-        if(directionalLight.bActive == true)
-        {
-            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir);
-        }
-        // phase 2: point lights
-        for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
-        {
-	    if(pointLights[i].bActive == true)
-            {
-                phongResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir);   
-            }
-        } 
-        // phase 3: spot light
-        if(spotLight.bActive == true)
-        {
-            phongResult += CalcSpotLight(spotLight, norm, fragmentPosition, viewDir);    
-        }
-    
-        if(bUseTexture == true)
-        {
-            fragmentColor = vec4(phongResult, (texture(objectTexture, fragmentTextureCoordinateScaled)).a);
-        }
-        else
-        {
-            fragmentColor = vec4(phongResult, objectColor.a);
-        }
-    }
-    else
-    {
-        if(bUseTexture == true)
-        {
-            fragmentColor = texture(objectTexture, fragmentTextureCoordinateScaled);
-        }
-        else
-        {
-            fragmentColor = objectColor;
-        }
-    }
-}
-
-// calculates the color when using a directional light.
-vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
-{
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular = vec3(0.0f);
-
-    vec3 lightDirection = normalize(-light.direction);
-    // diffuse shading
-    float diff = max(dot(normal, lightDirection), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDirection, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // combine results
-    if(bUseTexture == true)
-    {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * spec * material.specularColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-    }
-    else
-    {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * spec * material.specularColor * vec3(objectColor);
-    }
-    
-    return (ambient + diffuse + specular);
-}
-
-// calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular= vec3(0.0f);
-
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    // Calculate specular component
-    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-   
-    // combine results
-    if(bUseTexture == true)
-    {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * specularComponent * material.specularColor;
-    }
-    else
-    {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * specularComponent * material.specularColor;
-    }
-    
-    return (ambient + diffuse + specular);
-}
-
-// calculates the color when using a spot light.
-vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 ambient = vec3(0.0f);
-    vec3 diffuse = vec3(0.0f);
-    vec3 specular = vec3(0.0f);
-
-    vec3 lightDir = normalize(light.position - fragPos);
-    // diffuse shading
-    float diff = max(dot(normal, lightDir), 0.0);
-    // specular shading
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    // attenuation
-    float distance = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
-    // spotlight intensity
-    float theta = dot(lightDir, normalize(-light.direction)); 
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
-    // combine results
-    if(bUseTexture == true)
-    {
-        ambient = light.ambient * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-        specular = light.specular * spec * material.specularColor * vec3(texture(objectTexture, fragmentTextureCoordinateScaled));
-    }
-    else
-    {
-        ambient = light.ambient * vec3(objectColor);
-        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
-        specular = light.specular * spec * material.specularColor * vec3(objectColor);
-    }
-    
-    ambient *= attenuation * intensity;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
-    return (ambient + diffuse + specular);
-}
+#version 330 core
+out vec4 fragmentColor;
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+
+struct Material {
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+}; 
+
+struct DirectionalLight {
+    vec3 direction;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct PointLight {
+    vec3 position;
+
+    float constant;
+    float linear;
+    float quadratic;
+    
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+  
+    float constant;
+    float linear;
+    float quadratic;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;       
+
+    bool bActive;
+};
+
+// the light slots filled by LightManager each frame, with the
+// lights left over folded into one ambient color
+#define TOTAL_POINT_LIGHTS 5
+#define TOTAL_SPOT_LIGHTS 4
+
+uniform bool bUseTexture=false;
+uniform bool bUseLighting=false;
+uniform vec4 objectColor = vec4(1.0f);
+uniform vec3 viewPosition;
+uniform DirectionalLight directionalLight;
+uniform PointLight pointLights[TOTAL_POINT_LIGHTS];
+uniform SpotLight spotLights[TOTAL_SPOT_LIGHTS];
+uniform vec3 foldedAmbient = vec3(0.0f);
+uniform Material material;
+uniform sampler2D objectTexture;
+uniform vec2 UVscale = vec2(1.0f, 1.0f);
+
+// virtual textures are read from pages in a shared cache, through an
+// indirection texture with one entry per page and a mip level per page
+// level, the page sizes match VirtualTextureManager
+#define VIRTUAL_PAGE_SIZE 128.0
+#define VIRTUAL_PAGE_BORDER 4.0
+uniform bool bUseVirtualTexture = false;
+uniform bool bVirtualFeedback = false;
+uniform sampler2D vtCache;
+uniform sampler2D vtIndirection;
+uniform float vtCacheTexels;
+uniform vec2 vtTextureSize;
+uniform float vtMaxLevel;
+uniform float vtTextureIndex;
+uniform float vtFeedbackBias;
+
+// wood and marble drawn from noise instead of a texture, the same
+// functions as ProceduralTextureManager
+#define PROCEDURAL_WOOD 0
+#define PROCEDURAL_MARBLE 1
+#define PROCEDURAL_MAX_OCTAVES 8
+struct ProceduralTexture {
+    int type;
+    vec3 lightColor;
+    vec3 darkColor;
+    vec2 frequency;
+    int octaves;
+    float turbulence;
+    float bands;
+    int seed;
+};
+uniform bool bUseProceduralTexture = false;
+uniform ProceduralTexture procedural;
+
+// the scene drawn from the camera mirrored under the floor, the
+// projection of the mirrored camera finds each pixel in it
+uniform bool bUseReflection = false;
+uniform sampler2D reflectionTexture;
+uniform mat4 reflectionViewProjection;
+uniform float reflectionStrength;
+uniform float reflectionDistortion;
+
+// the scaled texture coordinate to use in calculations
+vec2 fragmentTextureCoordinateScaled = fragmentTextureCoordinate * UVscale;
+// the texture color, read once for all the lights
+vec4 objectTextureColor = vec4(1.0f);
+
+// function prototypes
+vec4 SampleObjectTexture();
+float VirtualTextureLevel();
+vec4 VirtualTextureFeedback();
+vec4 SampleProceduralTexture();
+vec3 AddReflection(vec3 color);
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+
+void main()
+{   
+    // the feedback pass writes the virtual texture page under each pixel
+    if(bVirtualFeedback == true)
+    {
+        fragmentColor = VirtualTextureFeedback();
+        return;
+    }
+
+    if(bUseTexture == true)
+    {
+        objectTextureColor = SampleObjectTexture();
+    }
+
+    if(bUseLighting == true)
+    {
+        vec3 phongResult = vec3(0.0f);
+        // properties
+        vec3 norm = normalize(fragmentVertexNormal);
+        vec3 viewDir = normalize(viewPosition - fragmentPosition);
+    
+        // == =====================================================
+        // Our lighting is set up in 3 phases: directional, point lights and an optional flashlight
+        // For each phase, a calculate function is defined that calculates the corresponding color
+        // per light source. In the main() function we take all the calculated colors and sum them 
+        // up for this fragment's final color.
+        // == =====================================================
+        // phase 1: directional lighting
+        if(directionalLight.bActive == true)
+        {
+            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir);
+        }
+        // phase 2: point lights
+        for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+        {
+	    if(pointLights[i].bActive == true)
+            {
+                phongResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir);   
+            }
+        } 
+        // phase 3: spot lights
+        for(int i = 0; i < TOTAL_SPOT_LIGHTS; i++)
+        {
+            if(spotLights[i].bActive == true)
+            {
+                phongResult += CalcSpotLight(spotLights[i], norm, fragmentPosition, viewDir);
+            }
+        }
+        // phase 4: the lights too minor to shade, as flat ambient
+        if(bUseTexture == true)
+        {
+            phongResult += foldedAmbient * vec3(objectTextureColor);
+        }
+        else
+        {
+            phongResult += foldedAmbient * vec3(objectColor);
+        }
+    
+        if(bUseTexture == true)
+        {
+            fragmentColor = vec4(phongResult, objectTextureColor.a);
+        }
+        else
+        {
+            fragmentColor = vec4(phongResult, objectColor.a);
+        }
+    }
+    else
+    {
+        if(bUseTexture == true)
+        {
+            fragmentColor = objectTextureColor;
+        }
+        else
+        {
+            fragmentColor = objectColor;
+        }
+    }
+
+    if(bUseReflection == true)
+    {
+        fragmentColor.rgb = AddReflection(fragmentColor.rgb);
+    }
+}
+
+// blends the reflection over the surface, more of it at grazing
+// angles.  The slope of the surface pattern bends the lookup, as if
+// the polish followed the veins.
+vec3 AddReflection(vec3 color)
+{
+    vec4 clip = reflectionViewProjection * vec4(fragmentPosition, 1.0);
+    vec2 coordinate = clip.xy / clip.w * 0.5 + 0.5;
+    float shade = dot(objectTextureColor.rgb, vec3(0.299, 0.587, 0.114));
+    coordinate += vec2(dFdx(shade), dFdy(shade)) * reflectionDistortion;
+    vec3 reflection = texture(reflectionTexture, clamp(coordinate, 0.0, 1.0)).rgb;
+
+    vec3 viewDir = normalize(viewPosition - fragmentPosition);
+    float facing = max(dot(normalize(fragmentVertexNormal), viewDir), 0.0);
+    float reflectance = reflectionStrength + (1.0 - reflectionStrength) * pow(1.0 - facing, 5.0);
+    // polished stone is no mirror, even at grazing angles
+    reflectance = min(reflectance, 0.6);
+    return mix(color, reflection, reflectance * material.specularColor);
+}
+
+// reads the object texture, or the pages of a virtual texture.
+vec4 SampleObjectTexture()
+{
+    if(bUseProceduralTexture == true)
+    {
+        return SampleProceduralTexture();
+    }
+    if(bUseVirtualTexture == false)
+    {
+        return texture(objectTexture, fragmentTextureCoordinateScaled);
+    }
+
+    int level = int(clamp(floor(VirtualTextureLevel()), 0.0, vtMaxLevel));
+    vec2 wrapped = fract(fragmentTextureCoordinateScaled);
+    vec2 levelPages = max(floor(vtTextureSize / (VIRTUAL_PAGE_SIZE * exp2(float(level)))), vec2(1.0));
+    ivec2 page = min(ivec2(wrapped * levelPages), ivec2(levelPages) - 1);
+
+    // the entry names the cache slot of the page, or of the coarser
+    // page standing in for it, and the level of that page
+    vec4 entry = floor(texelFetch(vtIndirection, page, level) * 255.0 + 0.5);
+    vec2 levelTexels = max(vtTextureSize / exp2(entry.b), vec2(1.0));
+    vec2 texel = wrapped * levelTexels;
+    vec2 pageTexel = texel - floor(texel / VIRTUAL_PAGE_SIZE) * VIRTUAL_PAGE_SIZE;
+    vec2 cacheTexel = entry.rg * (VIRTUAL_PAGE_SIZE + 2.0 * VIRTUAL_PAGE_BORDER) + VIRTUAL_PAGE_BORDER + pageTexel;
+    return textureLod(vtCache, cacheTexel / vtCacheTexels, 0.0);
+}
+
+// calculates the mip level of the virtual texture from the texels
+// covered by the fragment.
+float VirtualTextureLevel()
+{
+    vec2 texels = fragmentTextureCoordinateScaled * vtTextureSize;
+    vec2 dx = dFdx(texels);
+    vec2 dy = dFdy(texels);
+    return 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1.0e-8));
+}
+
+// calculates the virtual texture page of the fragment, with the
+// texture numbered from one so zero is no page.
+vec4 VirtualTextureFeedback()
+{
+    if((bUseTexture == false) || (bUseVirtualTexture == false))
+    {
+        return vec4(0.0f);
+    }
+
+    float level = clamp(floor(VirtualTextureLevel() + vtFeedbackBias), 0.0, vtMaxLevel);
+    vec2 levelPages = max(floor(vtTextureSize / (VIRTUAL_PAGE_SIZE * exp2(level))), vec2(1.0));
+    vec2 page = min(floor(fract(fragmentTextureCoordinateScaled) * levelPages), levelPages - 1.0);
+    return vec4(page, level, vtTextureIndex + 1.0) / 255.0;
+}
+
+// the integer hash of the procedural patterns.
+uint ProceduralHash(uint x)
+{
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return x;
+}
+
+uint LatticeHash(ivec2 cell, uint seed)
+{
+    return ProceduralHash(uint(cell.x) ^ ProceduralHash(uint(cell.y) ^ seed));
+}
+
+// wraps a lattice cell into the period the pattern repeats at.
+ivec2 WrapCell(ivec2 cell, ivec2 period)
+{
+    return cell - period * ivec2(floor(vec2(cell) / vec2(period)));
+}
+
+vec2 Fade(vec2 t)
+{
+    return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+}
+
+// one of four diagonal gradients, picked by the hash.
+float LatticeGradient(uint hash, vec2 offset)
+{
+    return (((hash & 1u) != 0u) ? -offset.x : offset.x) + (((hash & 2u) != 0u) ? -offset.y : offset.y);
+}
+
+float GradientNoise(vec2 p, ivec2 period, uint seed)
+{
+    vec2 cell = floor(p);
+    vec2 offset = p - cell;
+    ivec2 c0 = WrapCell(ivec2(cell), period);
+    ivec2 c1 = WrapCell(c0 + 1, period);
+    float n00 = LatticeGradient(LatticeHash(c0, seed), offset);
+    float n10 = LatticeGradient(LatticeHash(ivec2(c1.x, c0.y), seed), offset - vec2(1.0, 0.0));
+    float n01 = LatticeGradient(LatticeHash(ivec2(c0.x, c1.y), seed), offset - vec2(0.0, 1.0));
+    float n11 = LatticeGradient(LatticeHash(c1, seed), offset - vec2(1.0, 1.0));
+    vec2 fade = Fade(offset);
+    return mix(mix(n00, n10, fade.x), mix(n01, n11, fade.x), fade.y);
+}
+
+float ValueNoise(vec2 p, ivec2 period, uint seed)
+{
+    vec2 cell = floor(p);
+    ivec2 c0 = WrapCell(ivec2(cell), period);
+    ivec2 c1 = WrapCell(c0 + 1, period);
+    float v00 = float(LatticeHash(c0, seed) >> 8u) / 16777216.0;
+    float v10 = float(LatticeHash(ivec2(c1.x, c0.y), seed) >> 8u) / 16777216.0;
+    float v01 = float(LatticeHash(ivec2(c0.x, c1.y), seed) >> 8u) / 16777216.0;
+    float v11 = float(LatticeHash(c1, seed) >> 8u) / 16777216.0;
+    vec2 fade = Fade(p - cell);
+    return mix(mix(v00, v10, fade.x), mix(v01, v11, fade.x), fade.y);
+}
+
+// calculates the wood or marble color of the fragment.  Noise finer
+// than a pixel is left at its average of zero, so distant surfaces do
+// not shimmer.
+vec4 SampleProceduralTexture()
+{
+    vec2 uv = fragmentTextureCoordinateScaled;
+    float footprint = max(length(dFdx(uv)), length(dFdy(uv)));
+    uint seed = uint(procedural.seed);
+
+    float noise = 0.0;
+    float total = 0.0;
+    float amplitude = 1.0;
+    ivec2 frequency = ivec2(procedural.frequency);
+    for(int i = 0; i < PROCEDURAL_MAX_OCTAVES; i++)
+    {
+        if(i >= procedural.octaves)
+        {
+            break;
+        }
+        if(footprint * float(max(frequency.x, frequency.y)) < 0.5)
+        {
+            noise += amplitude * GradientNoise(uv * vec2(frequency), frequency, seed + uint(i));
+        }
+        total += amplitude;
+        amplitude *= 0.5;
+        frequency *= 2;
+    }
+    noise = (total > 0.0) ? noise / total : 0.0;
+
+    float shade = 0.0;
+    if(procedural.type == PROCEDURAL_WOOD)
+    {
+        float ring = 1.0 - abs(2.0 * fract(uv.y * procedural.bands + procedural.turbulence * noise) - 1.0);
+        float profile = ring * ring * (3.0 - 2.0 * ring);
+        ivec2 grainPeriod = ivec2(procedural.frequency) * ivec2(2, 16);
+        float grain = 0.5;
+        if(footprint * float(grainPeriod.y) < 0.5)
+        {
+            grain = ValueNoise(uv * vec2(grainPeriod), grainPeriod, seed + 101u);
+        }
+        shade = 0.75 * profile + 0.25 * grain;
+    }
+    else
+    {
+        float vein = 1.0 - abs(2.0 * fract(uv.x * procedural.bands + procedural.turbulence * noise) - 1.0);
+        vein *= vein;
+        vein *= vein;
+        vein *= vein;
+        shade = (1.0 - vein) * (0.85 + 0.15 * noise);
+    }
+    return vec4(mix(procedural.darkColor, procedural.lightColor, clamp(shade, 0.0, 1.0)), 1.0);
+}
+
+// calculates the color when using a directional light.
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
+{
+    vec3 ambient = vec3(0.0f);
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular = vec3(0.0f);
+
+    vec3 lightDirection = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDirection), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDirection, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // combine results
+    if(bUseTexture == true)
+    {
+        ambient = light.ambient * vec3(objectTextureColor);
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectTextureColor);
+        specular = light.specular * spec * material.specularColor * vec3(objectTextureColor);
+    }
+    else
+    {
+        ambient = light.ambient * vec3(objectColor);
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
+        specular = light.specular * spec * material.specularColor * vec3(objectColor);
+    }
+    
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 ambient = vec3(0.0f);
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular= vec3(0.0f);
+
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    // Calculate specular component
+    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+   
+    // combine results
+    if(bUseTexture == true)
+    {
+        ambient = light.ambient * vec3(objectTextureColor);
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectTextureColor);
+        specular = light.specular * specularComponent * material.specularColor;
+    }
+    else
+    {
+        ambient = light.ambient * vec3(objectColor);
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
+        specular = light.specular * specularComponent * material.specularColor;
+    }
+    
+    return (ambient + diffuse + specular) * attenuation;
+}
+
+// calculates the color when using a spot light.
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{
+    vec3 ambient = vec3(0.0f);
+    vec3 diffuse = vec3(0.0f);
+    vec3 specular = vec3(0.0f);
+
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction)); 
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // combine results
+    if(bUseTexture == true)
+    {
+        ambient = light.ambient * vec3(objectTextureColor);
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectTextureColor);
+        specular = light.specular * spec * material.specularColor * vec3(objectTextureColor);
+    }
+    else
+    {
+        ambient = light.ambient * vec3(objectColor);
+        diffuse = light.diffuse * diff * material.diffuseColor * vec3(objectColor);
+        specular = light.specular * spec * material.specularColor * vec3(objectColor);
+    }
+    
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + diffuse + specular);
+}
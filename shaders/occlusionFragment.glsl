@@ -0,0 +1,6 @@
+#version 330 core
+// nothing is written, the query only counts the samples that pass
+// the depth test
+void main()
+{
+}
@@ -0,0 +1,21 @@
+#version 330 core
+// the twelve triangles of a box, made from the vertex number and
+// placed over the bounds of an assembly
+uniform mat4 viewProjection;
+uniform vec3 boxCenter;
+uniform vec3 boxSize;
+
+const int corners[36] = int[36](
+    0, 2, 1,  1, 2, 3,
+    4, 5, 6,  5, 7, 6,
+    0, 1, 4,  1, 5, 4,
+    2, 6, 3,  3, 6, 7,
+    0, 4, 2,  2, 4, 6,
+    1, 3, 5,  3, 7, 5);
+
+void main()
+{
+    int corner = corners[gl_VertexID];
+    vec3 unitCorner = vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1) - 0.5;
+    gl_Position = viewProjection * vec4(boxCenter + unitCorner * boxSize, 1.0);
+}
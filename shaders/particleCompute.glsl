@@ -0,0 +1,111 @@
+#version 430 core
+// moves the particles one step, reading one state buffer and
+// writing the other
+layout (local_size_x = 256) in;
+
+struct Particle
+{
+    vec4 positionLife;
+    vec4 velocityEmitter;
+};
+
+layout (std430, binding = 0) readonly buffer InputParticles
+{
+    Particle inputParticles[];
+};
+
+layout (std430, binding = 1) writeonly buffer OutputParticles
+{
+    Particle outputParticles[];
+};
+
+#define TOTAL_EMITTERS 64
+
+// the emitters, in the same block as the draw shader
+layout (std140) uniform Emitters
+{
+    // xyz position of the emitter cone apex, w cone length
+    vec4 emitterPositionLength[TOTAL_EMITTERS];
+    // xyz cone direction, w tangent of the spawn cone angle
+    vec4 emitterDirectionSpread[TOTAL_EMITTERS];
+    // x particle lifetime in seconds, y 1 when the emitter is in use
+    vec4 emitterSpawn[TOTAL_EMITTERS];
+    // xyz position of the emitter cone apex, w particle size
+    vec4 emitterPositionSize[TOTAL_EMITTERS];
+    // xyz cone direction, w cosine of the outer light cone
+    vec4 emitterDirectionCone[TOTAL_EMITTERS];
+    // rgb color, a particle lifetime in seconds
+    vec4 emitterColorLifetime[TOTAL_EMITTERS];
+    // x cosine of the inner light cone, y 1 when the emitter is in use
+    vec4 emitterLight[TOTAL_EMITTERS];
+};
+
+uniform uint particleCount;
+uniform uint frameNumber;
+uniform float deltaTime;
+// random push and drag applied to every particle
+uniform float jitter;
+uniform float damping;
+
+// the same integer hash as the CPU update
+uint Hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+float Random(inout uint state)
+{
+    state = Hash(state);
+    return float(state >> 8) * (1.0 / 16777216.0);
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= particleCount)
+    {
+        return;
+    }
+
+    Particle particle = inputParticles[index];
+    int emitter = int(particle.velocityEmitter.w);
+    uint state = Hash(index * 1973U + frameNumber * 9277U);
+
+    vec3 position = particle.positionLife.xyz;
+    vec3 velocity = particle.velocityEmitter.xyz;
+    float life = particle.positionLife.w - deltaTime;
+
+    if (emitterSpawn[emitter].y == 0.0)
+    {
+        life = -1.0;
+    }
+    else if (life <= 0.0)
+    {
+        // spawn somewhere inside the cone, spread through its volume
+        vec3 axis = emitterDirectionSpread[emitter].xyz;
+        vec3 side = normalize(abs(axis.y) < 0.99 ? cross(axis, vec3(0.0, 1.0, 0.0)) : cross(axis, vec3(1.0, 0.0, 0.0)));
+        vec3 other = cross(axis, side);
+        float along = emitterPositionLength[emitter].w * pow(Random(state), 1.0 / 3.0);
+        float radius = along * emitterDirectionSpread[emitter].w * sqrt(Random(state));
+        float angle = Random(state) * 6.2831853;
+        position = emitterPositionLength[emitter].xyz + axis * along + (side * cos(angle) + other * sin(angle)) * radius;
+        velocity = vec3(0.0);
+        life = emitterSpawn[emitter].x * (0.5 + 0.5 * Random(state));
+    }
+    else
+    {
+        // drift with a small random push and a slow settle
+        vec3 push = vec3(Random(state), Random(state), Random(state)) - 0.5;
+        velocity += (push * jitter - velocity * damping) * deltaTime;
+        velocity.y -= 0.002 * deltaTime;
+        position += velocity * deltaTime;
+    }
+
+    outputParticles[index].positionLife = vec4(position, life);
+    outputParticles[index].velocityEmitter = vec4(velocity, particle.velocityEmitter.w);
+}
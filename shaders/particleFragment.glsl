@@ -0,0 +1,18 @@
+#version 330 core
+out vec4 fragmentColor;
+
+in vec2 spriteCoordinate;
+in vec4 spriteColor;
+
+void main()
+{
+    // round, soft edged sprite, added to the scene behind it
+    float distanceSquared = dot(spriteCoordinate, spriteCoordinate);
+    if (distanceSquared > 1.0)
+    {
+        discard;
+    }
+    float falloff = 1.0 - distanceSquared;
+    float alpha = spriteColor.a * falloff * falloff;
+    fragmentColor = vec4(spriteColor.rgb * alpha, alpha);
+}
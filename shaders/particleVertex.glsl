@@ -0,0 +1,57 @@
+#version 330 core
+// one instance per particle, drawn as a camera facing quad
+layout (location = 0) in vec4 inPositionLife;
+layout (location = 1) in vec4 inVelocityEmitter;
+
+out vec2 spriteCoordinate;
+out vec4 spriteColor;
+
+#define TOTAL_EMITTERS 64
+
+// the emitters, in the same block as the compute shader
+layout (std140) uniform Emitters
+{
+   // xyz position of the emitter cone apex, w cone length
+   vec4 emitterPositionLength[TOTAL_EMITTERS];
+   // xyz cone direction, w tangent of the spawn cone angle
+   vec4 emitterDirectionSpread[TOTAL_EMITTERS];
+   // x particle lifetime in seconds, y 1 when the emitter is in use
+   vec4 emitterSpawn[TOTAL_EMITTERS];
+   // xyz position of the emitter cone apex, w particle size
+   vec4 emitterPositionSize[TOTAL_EMITTERS];
+   // xyz cone direction, w cosine of the outer light cone
+   vec4 emitterDirectionCone[TOTAL_EMITTERS];
+   // rgb color, a particle lifetime in seconds
+   vec4 emitterColorLifetime[TOTAL_EMITTERS];
+   // x cosine of the inner light cone, y 1 when the emitter is in use
+   vec4 emitterLight[TOTAL_EMITTERS];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+   int emitter = int(inVelocityEmitter.w);
+   float life = inPositionLife.w;
+   float lifetime = emitterColorLifetime[emitter].w;
+
+   // corners of the triangle strip from the vertex number
+   vec2 corner = vec2(float(gl_VertexID & 1) * 2.0 - 1.0, float(gl_VertexID >> 1) * 2.0 - 1.0);
+
+   // particles fade in after spawning and out before dying, and
+   // are lit by how far inside the light cone they are
+   float fade = clamp(life * 2.0, 0.0, 1.0) * clamp((lifetime - life) * 2.0, 0.0, 1.0);
+   vec3 toParticle = normalize(inPositionLife.xyz - emitterPositionSize[emitter].xyz + vec3(0.0, 1e-5, 0.0));
+   float light = smoothstep(emitterDirectionCone[emitter].w, emitterLight[emitter].x,
+      dot(toParticle, emitterDirectionCone[emitter].xyz));
+
+   float size = emitterPositionSize[emitter].w * emitterLight[emitter].y * step(0.0, life);
+   vec3 cameraRight = vec3(view[0][0], view[1][0], view[2][0]);
+   vec3 cameraUp = vec3(view[0][1], view[1][1], view[2][1]);
+   vec3 position = inPositionLife.xyz + (cameraRight * corner.x + cameraUp * corner.y) * size;
+
+   gl_Position = projection * view * vec4(position, 1.0);
+   spriteCoordinate = corner;
+   spriteColor = vec4(emitterColorLifetime[emitter].rgb, fade * light);
+}
@@ -0,0 +1,47 @@
+#version 330 core
+// adds the bloom to the scene, maps it from HDR to the screen and
+// grades the colors, all in the one pass that writes the frame
+in vec2 screenCoordinate;
+
+out vec4 fragmentColor;
+
+uniform sampler2D sceneTexture;
+uniform sampler2D bloomTexture;
+uniform bool bUseBloom = false;
+uniform float bloomStrength;
+uniform float exposure;
+// scale of each channel before tone mapping, for the white balance
+uniform vec3 colorBalance;
+uniform float contrast;
+uniform float saturation;
+// raises the darkest colors
+uniform vec3 lift;
+
+// fitted curve of the ACES filmic tone mapping
+vec3 ToneMap(vec3 color)
+{
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+    return clamp((color * (a * color + b)) / (color * (c * color + d) + e), 0.0, 1.0);
+}
+
+void main()
+{
+    vec3 color = texture(sceneTexture, screenCoordinate).rgb;
+    if (bUseBloom)
+    {
+        color += texture(bloomTexture, screenCoordinate).rgb * bloomStrength;
+    }
+
+    color = ToneMap(color * exposure * colorBalance);
+
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    color = mix(vec3(luminance), color, saturation);
+    color = (color - 0.5) * contrast + 0.5;
+    color = color + lift * (1.0 - color);
+
+    fragmentColor = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
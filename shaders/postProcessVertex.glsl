@@ -0,0 +1,10 @@
+#version 330 core
+// one triangle covering the screen, made from the vertex number
+out vec2 screenCoordinate;
+
+void main()
+{
+    vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    screenCoordinate = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}